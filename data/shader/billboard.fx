@@ -46,6 +46,31 @@ struct VSInput
 	float2 m_TexCoord       : TEXCOORD;
 };
 
+// The vertices of a static batch are already moved to the billboard position,
+// which is stored in each vertex, because the batch has more than one of them.
+struct VSBatchedInput
+{
+	float3 m_WSPosition		: POSITION;			// World Space Position of the unrotated billboard
+	float3 m_OSTangent		: TANGENT;
+	float3 m_OSBinormal		: BINORMAL;
+	float3 m_OSNormal		: NORMAL;
+	float2 m_TexCoord       : TEXCOORD;
+	float3 m_WSOrigin		: ORIGIN;			// World Space Position of the billboard
+};
+
+// A static batch of billboards sharing an atlas stores the rect of each sprite
+// in its vertices, so one material draws all of them.
+struct VSAtlasInput
+{
+	float3 m_WSPosition		: POSITION;
+	float3 m_OSTangent		: TANGENT;
+	float3 m_OSBinormal		: BINORMAL;
+	float3 m_OSNormal		: NORMAL;
+	float2 m_TexCoord       : TEXCOORD;
+	float3 m_WSOrigin		: ORIGIN;
+	float4 m_AtlasRect		: ATLAS;			// Offset and size of the sprite in the atlas
+};
+
 struct PSInput
 {
 	float4 m_CSPosition		: SV_POSITION;		// Clip Space Position
@@ -58,19 +83,11 @@ struct PSInput
 };
 
 // -----------------------------------------------------------------------------
-// Vertex Shader
+// Billboards are 2D elements incrusted in a 3D world
+// Whats different with billboards is that they are positionned at a specific location, but their orientation is automatically computed so that it always faces the camera.
 // -----------------------------------------------------------------------------
-PSInput VSShader(VSInput _Input)
+float3x3 GetBillboardRotation(float3 _WSBillboardPosition)
 {
-
-	PSInput Output = (PSInput)0;
-
-	// -------------------------------------------------------------------------------
-	// Billboards are 2D elements incrusted in a 3D world
-	// Whats different with billboards is that they are positionned at a specific location, but their orientation is automatically computed so that it always faces the camera.
-	// -------------------------------------------------------------------------------
-
-
 	// The y-basis vector corresponds to { 0.0f, 1.0f, 0.0f }, since the billboard rotates only around the y-axis.
 
 	float3  yBasisVector = { 0.0f, 1.0f, 0.0f };
@@ -78,7 +95,7 @@ PSInput VSShader(VSInput _Input)
 
 	//The z-basis vector is facing the eye (Camera) .
 
-	float3  zBasisVector = g_WSBillboardPosition - g_WSEyePosition;
+	float3  zBasisVector = _WSBillboardPosition - g_WSEyePosition;
 
 	zBasisVector.y = 0.0f;
 	zBasisVector = normalize(zBasisVector);
@@ -90,10 +107,23 @@ PSInput VSShader(VSInput _Input)
 	// Create a matrix from the three vectors to multiply them for the camera rotation
 	float3x3 rotationMatrix = { xBasisVector, yBasisVector , zBasisVector };
 
+	return rotationMatrix;
+}
+
+// -----------------------------------------------------------------------------
+// Vertex Shader
+// -----------------------------------------------------------------------------
+PSInput GetBillboardVertex(VSInput _Input, float3 _WSBillboardPosition)
+{
+
+	PSInput Output = (PSInput)0;
+
+	float3x3 rotationMatrix = GetBillboardRotation(_WSBillboardPosition);
+
 	// -------------------------------------------------------------------------------
 	// Get the world space position.
 	// -------------------------------------------------------------------------------
-	float3 WSPosition = g_WSBillboardPosition + mul(_Input.m_OSPosition, rotationMatrix);
+	float3 WSPosition = _WSBillboardPosition + mul(_Input.m_OSPosition, rotationMatrix);
 
 
 
@@ -128,6 +158,74 @@ PSInput VSShader(VSInput _Input)
 	return Output;
 }
 
+PSInput VSShader(VSInput _Input)
+{
+	return GetBillboardVertex(_Input, g_WSBillboardPosition);
+}
+
+// -----------------------------------------------------------------------------
+// Vertex Shader of a static batch. The offset to the billboard position is the
+// position of the single billboard, so it is rotated the same way.
+// -----------------------------------------------------------------------------
+VSInput GetBillboardInput(VSBatchedInput _Input)
+{
+	VSInput Input;
+
+	Input.m_OSPosition = _Input.m_WSPosition - _Input.m_WSOrigin;
+	Input.m_OSTangent = _Input.m_OSTangent;
+	Input.m_OSBinormal = _Input.m_OSBinormal;
+	Input.m_OSNormal = _Input.m_OSNormal;
+	Input.m_TexCoord = _Input.m_TexCoord;
+
+	return Input;
+}
+
+PSInput VSBatchedShader(VSBatchedInput _Input)
+{
+	return GetBillboardVertex(GetBillboardInput(_Input), _Input.m_WSOrigin);
+}
+
+// -----------------------------------------------------------------------------
+// Vertex Shader of a static batch sharing an atlas. The texture coordinate of
+// the sprite is mapped into its rect, the padding around it keeps the filter
+// inside.
+// -----------------------------------------------------------------------------
+PSInput VSAtlasShader(VSAtlasInput _Input)
+{
+	VSInput Input;
+
+	Input.m_OSPosition = _Input.m_WSPosition - _Input.m_WSOrigin;
+	Input.m_OSTangent = _Input.m_OSTangent;
+	Input.m_OSBinormal = _Input.m_OSBinormal;
+	Input.m_OSNormal = _Input.m_OSNormal;
+	Input.m_TexCoord = _Input.m_AtlasRect.xy + _Input.m_TexCoord * _Input.m_AtlasRect.zw;
+
+	return GetBillboardVertex(Input, _Input.m_WSOrigin);
+}
+
+// -----------------------------------------------------------------------------
+// Vertex Shader of the depth pre-pass. Only the position is transformed, which
+// has to be done exactly like in 'VSShader' to pass the equal depth test.
+// -----------------------------------------------------------------------------
+float4 VSDepthShader(float3 _OSPosition : POSITION) : SV_POSITION
+{
+	float3x3 rotationMatrix = GetBillboardRotation(g_WSBillboardPosition);
+
+	float3 WSPosition = g_WSBillboardPosition + mul(_OSPosition, rotationMatrix);
+
+	return mul(float4(WSPosition, 1.0f), g_ViewProjectionMatrix);
+}
+
+// Depth pre-pass of a static batch, transformed exactly like in 'VSBatchedShader'
+float4 VSBatchedDepthShader(float3 _WSPosition : POSITION, float3 _WSOrigin : ORIGIN) : SV_POSITION
+{
+	float3x3 rotationMatrix = GetBillboardRotation(_WSOrigin);
+
+	float3 WSPosition = _WSOrigin + mul(_WSPosition - _WSOrigin, rotationMatrix);
+
+	return mul(float4(WSPosition, 1.0f), g_ViewProjectionMatrix);
+}
+
 // -----------------------------------------------------------------------------
 // Pixel Shader
 // -----------------------------------------------------------------------------
@@ -0,0 +1,52 @@
+
+// -----------------------------------------------------------------------------
+// Define the constant buffer. Only the first two matrices are used, so any
+// vertex constant buffer beginning with view projection and world matrix such
+// as the one of 'textured.fx' can be bound to this shader.
+// -----------------------------------------------------------------------------
+cbuffer VSBuffer : register(b0)                 // Register the constant buffer on slot 0
+{
+    float4x4 g_ViewProjectionMatrix;
+    float4x4 g_WorldMatrix;
+};
+
+// -----------------------------------------------------------------------------
+// Define input and output data of the vertex shader. The position is the only
+// vertex attribute consumed, all other attributes of the layout are ignored.
+// -----------------------------------------------------------------------------
+struct VSInput
+{
+    float3 m_Position : POSITION;
+};
+
+struct PSInput
+{
+    float4 m_Position : SV_POSITION;
+};
+
+// -----------------------------------------------------------------------------
+// Vertex Shader. Note that the transformation has to be exactly the same as in
+// the expensive material, otherwise the equal depth test fails.
+// -----------------------------------------------------------------------------
+PSInput VSDepthShader(VSInput _Input)
+{
+    float4 WSPosition;
+
+    PSInput Output    = (PSInput) 0;
+
+    WSPosition        = mul(float4(_Input.m_Position, 1.0f), g_WorldMatrix);
+    Output.m_Position = mul(WSPosition, g_ViewProjectionMatrix);
+
+    return Output;
+}
+
+// -----------------------------------------------------------------------------
+// Pixel Shader. YoshiX neither offers a color write mask nor a way to unbind
+// the color target of the back buffer, so the shader returns a transparent
+// color instead, which leaves the color target as it is with alpha blending.
+// Only the depth buffer is filled.
+// -----------------------------------------------------------------------------
+float4 PSDepthShader(PSInput _Input) : SV_TARGET
+{
+    return float4(0.0f, 0.0f, 0.0f, 0.0f);
+}
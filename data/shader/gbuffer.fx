@@ -0,0 +1,124 @@
+
+// -----------------------------------------------------------------------------
+// Define the constant buffers. The layout matches the buffers of
+// 'post_effect.cpp', the two wasted components of the near and far distance
+// carry the normal encoding and the material index.
+// -----------------------------------------------------------------------------
+cbuffer VSBuffer : register(b0)                 // Register the constant buffer on slot 0
+{
+    float4x4 g_ViewProjectionMatrix;
+    float4x4 g_WorldMatrix;
+    float4x4 g_ScreenMatrix;
+};
+
+cbuffer PSBuffer : register(b0)                 // Register the constant buffer in the pixel constant buffer state on slot 0
+{
+    float4 g_NearFar;                           // Near and far distance, normal encoding (1 = RG8, 2 = RG16), and material index.
+};
+
+// -----------------------------------------------------------------------------
+// Texture variables.
+// -----------------------------------------------------------------------------
+Texture2D g_ColorMap : register(t0);            // Register the color map on texture slot 0
+
+// -----------------------------------------------------------------------------
+// Sampler variables.
+// -----------------------------------------------------------------------------
+sampler g_ColorMapSampler : register(s0);       // Register the sampler on sampler slot 0
+
+// -----------------------------------------------------------------------------
+// Define input and output data of the vertex shader.
+// -----------------------------------------------------------------------------
+struct VSInput
+{
+    float3 m_Position : POSITION;
+    float3 m_Normal   : NORMAL;
+    float2 m_TexCoord : TEXCOORD;
+};
+
+struct PSInput
+{
+    float4 m_Position : SV_POSITION;
+    float3 m_Normal   : TEXCOORD0;
+    float2 m_TexCoord : TEXCOORD1;
+};
+
+// -----------------------------------------------------------------------------
+// Both GBuffer targets are written in one pass. The first one holds the color
+// and the material index, the second one the octahedral normal.
+// -----------------------------------------------------------------------------
+struct PSOutput
+{
+    float4 m_MaterialColor : SV_Target0;
+    float4 m_Normal        : SV_Target1;
+};
+
+// -----------------------------------------------------------------------------
+// Octahedral normal encoding, the same as 'EncodeOctahedral' in
+// 'gbuffer_layout.cpp'. The 16 bit variant stores the high bytes in RG and the
+// low bytes in BA, because YoshiX creates all color targets with 8 bits per
+// channel.
+// -----------------------------------------------------------------------------
+float2 GetSign(float2 _Value)
+{
+    return float2(_Value.x >= 0.0f ? 1.0f : -1.0f, _Value.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+float2 EncodeOctahedral(float3 _Normal)
+{
+    float2 Encoded = _Normal.xy / (abs(_Normal.x) + abs(_Normal.y) + abs(_Normal.z));
+
+    if (_Normal.z < 0.0f)
+    {
+        Encoded = (1.0f - abs(Encoded.yx)) * GetSign(Encoded);
+    }
+
+    return Encoded * 0.5f + 0.5f;
+}
+
+float4 PackNormal(float3 _Normal)
+{
+    float2 Encoded = EncodeOctahedral(_Normal);
+
+    if (g_NearFar.z < 1.5f)
+    {
+        return float4(Encoded, 0.0f, 0.0f);
+    }
+
+    float2 Value = round(saturate(Encoded) * 65535.0f);
+    float2 High  = floor(Value / 256.0f);
+    float2 Low   = Value - High * 256.0f;
+
+    return float4(High / 255.0f, Low / 255.0f);
+}
+
+// -----------------------------------------------------------------------------
+// Vertex Shader
+// -----------------------------------------------------------------------------
+PSInput VSGBufferShader(VSInput _Input)
+{
+    float4 WSPosition;
+
+    PSInput Output    = (PSInput) 0;
+
+    WSPosition        = mul(float4(_Input.m_Position, 1.0f), g_WorldMatrix);
+
+    Output.m_Position = mul(WSPosition, g_ViewProjectionMatrix);
+    Output.m_Normal   = mul(_Input.m_Normal, (float3x3) g_WorldMatrix);
+    Output.m_TexCoord = _Input.m_TexCoord;
+
+    return Output;
+}
+
+// -----------------------------------------------------------------------------
+// Pixel Shader
+// -----------------------------------------------------------------------------
+PSOutput PSGBufferShader(PSInput _Input)
+{
+    PSOutput Output = (PSOutput) 0;
+
+    Output.m_MaterialColor = float4(g_ColorMap.Sample(g_ColorMapSampler, _Input.m_TexCoord).rgb, g_NearFar.w / 255.0f);
+    Output.m_Normal        = PackNormal(normalize(_Input.m_Normal));
+
+    return Output;
+}
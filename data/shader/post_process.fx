@@ -0,0 +1,247 @@
+
+// -----------------------------------------------------------------------------
+// Define the constant buffers.
+// -----------------------------------------------------------------------------
+cbuffer VSBuffer : register(b0)                 // Register the constant buffer on slot 0
+{
+    float4x4 g_ScreenMatrix;                    // Projects a rectangular mesh onto a complete render target.
+    float4   g_QuadScale;                       // Scale of the quad in x and y, which is 1 for full resolution passes.
+};
+
+cbuffer PSBuffer : register(b0)                 // Register the constant buffer in the pixel constant buffer state on slot 0
+{
+    float4 g_NearFar;                           // Near and far distance, and the normal encoding (0 = xyz, 1 = octahedral RG8, 2 = octahedral RG16).
+    float4 g_TargetSize;                        // Width, height, and their reciprocals of the full resolution targets.
+    float4 g_EffectScale;                       // Resolution scale of the current effect, 1, 0.5, or 0.25, and the size of the scene in pixels in yz.
+};
+
+// -----------------------------------------------------------------------------
+// Texture variables. The encoding of the GBuffer normals is given in g_NearFar.z.
+// -----------------------------------------------------------------------------
+Texture2D g_DepthMap  : register(t0);           // The depth target of the GBuffer.
+Texture2D g_ColorMap  : register(t1);           // The scene color or the result of the previous effect.
+Texture2D g_NormalMap : register(t2);           // The normal target of the GBuffer.
+Texture2D g_EffectMap : register(t3);           // The effect term, only bound in the composite pass.
+
+// -----------------------------------------------------------------------------
+// Define input and output data of the vertex shader.
+// -----------------------------------------------------------------------------
+struct VSInput
+{
+    float3 m_Position : POSITION;
+};
+
+struct PSInput
+{
+    float4 m_Position : SV_POSITION;
+    float2 m_TexCoord : TEXCOORD0;              // Full resolution texture coordinate of the pixel.
+};
+
+// -----------------------------------------------------------------------------
+// Vertex Shader. A reduced effect is rendered into the upper left part of the
+// target only, but the texture coordinates still address the whole scene.
+// -----------------------------------------------------------------------------
+PSInput VSPostShader(VSInput _Input)
+{
+    PSInput Output = (PSInput) 0;
+
+    Output.m_Position = mul(float4(_Input.m_Position.xy * g_QuadScale.xy, _Input.m_Position.z, 1.0f), g_ScreenMatrix);
+    Output.m_TexCoord = _Input.m_Position.xy;
+
+    return Output;
+}
+
+// -----------------------------------------------------------------------------
+// Helper functions to read the GBuffer at full resolution pixels. With dynamic
+// resolution the scene covers the upper left part of the GBuffer only.
+// -----------------------------------------------------------------------------
+int2 GetSceneSize()
+{
+    return int2(g_EffectScale.yz);
+}
+
+int2 GetPixel(float2 _TexCoord)
+{
+    return clamp(int2(_TexCoord * g_EffectScale.yz), int2(0, 0), GetSceneSize() - 1);
+}
+
+float GetLinearDepth(int2 _Pixel)
+{
+    float Depth = g_DepthMap.Load(int3(_Pixel, 0)).r;
+
+    return g_NearFar.x * g_NearFar.y / (g_NearFar.y - Depth * (g_NearFar.y - g_NearFar.x));
+}
+
+float3 DecodeOctahedral(float2 _Encoded)
+{
+    float2 Encoded = _Encoded * 2.0f - 1.0f;
+    float3 Normal  = float3(Encoded, 1.0f - abs(Encoded.x) - abs(Encoded.y));
+
+    if (Normal.z < 0.0f)
+    {
+        Normal.xy = (1.0f - abs(Encoded.yx)) * float2(Encoded.x >= 0.0f ? 1.0f : -1.0f, Encoded.y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    return normalize(Normal);
+}
+
+float3 GetNormal(int2 _Pixel)
+{
+    float4 Texel = g_NormalMap.Load(int3(_Pixel, 0));
+
+    if (g_NearFar.z < 0.5f)
+    {
+        return normalize(Texel.xyz * 2.0f - 1.0f);
+    }
+
+    if (g_NearFar.z < 1.5f)
+    {
+        return DecodeOctahedral(Texel.xy);
+    }
+
+    float2 Value = round(Texel.xy * 255.0f) * 256.0f + round(Texel.zw * 255.0f);
+
+    return DecodeOctahedral(Value / 65535.0f);
+}
+
+// -----------------------------------------------------------------------------
+// Effect shaders. Each one returns a color and a blend weight in alpha, which
+// is blended over the scene color in the composite pass. The sample distance
+// grows with lower resolution, so the effect keeps its size on the screen.
+// -----------------------------------------------------------------------------
+float4 PSEdgeDetection(PSInput _Input) : SV_Target
+{
+    int2   Pixel  = GetPixel(_Input.m_TexCoord);
+    int    Step   = int(1.0f / g_EffectScale.x);
+    int2   Size   = GetSceneSize() - 1;
+
+    float  Depth  = GetLinearDepth(Pixel);
+    float3 Normal = GetNormal(Pixel);
+
+    int2 Offsets[4] = { int2(Step, 0), int2(-Step, 0), int2(0, Step), int2(0, -Step) };
+
+    float Edge = 0.0f;
+
+    [unroll] for (int IndexOfOffset = 0; IndexOfOffset < 4; ++ IndexOfOffset)
+    {
+        int2 Neighbor = clamp(Pixel + Offsets[IndexOfOffset], int2(0, 0), Size);
+
+        Edge += abs(GetLinearDepth(Neighbor) - Depth) / Depth;
+        Edge += 1.0f - saturate(dot(GetNormal(Neighbor), Normal));
+    }
+
+    return float4(0.0f, 0.0f, 0.0f, saturate(Edge * 2.0f));
+}
+
+// -----------------------------------------------------------------------------
+
+float4 PSFog(PSInput _Input) : SV_Target
+{
+    float Depth = GetLinearDepth(GetPixel(_Input.m_TexCoord));
+
+    float Fog = saturate((Depth - g_NearFar.x) / (g_NearFar.y - g_NearFar.x));
+
+    return float4(0.5f, 0.6f, 0.7f, Fog * Fog);
+}
+
+// -----------------------------------------------------------------------------
+
+float4 PSAmbientOcclusion(PSInput _Input) : SV_Target
+{
+    int2  Pixel  = GetPixel(_Input.m_TexCoord);
+    int   Step   = int(4.0f / g_EffectScale.x);
+    int2  Size   = GetSceneSize() - 1;
+    float Depth  = GetLinearDepth(Pixel);
+
+    int2 Offsets[8] =
+    {
+        int2( 1, 0), int2(-1,  0), int2(0, 1), int2( 0, -1),
+        int2( 1, 1), int2(-1, -1), int2(1, -1), int2(-1, 1),
+    };
+
+    float Occlusion = 0.0f;
+
+    [unroll] for (int IndexOfOffset = 0; IndexOfOffset < 8; ++ IndexOfOffset)
+    {
+        int2  Neighbor   = clamp(Pixel + Offsets[IndexOfOffset] * Step, int2(0, 0), Size);
+        float Difference = Depth - GetLinearDepth(Neighbor);
+
+        // -----------------------------------------------------------------------------
+        // Only nearby occluders in front of the pixel darken it.
+        // -----------------------------------------------------------------------------
+        Occlusion += (Difference > 0.02f && Difference < 1.0f) ? 1.0f : 0.0f;
+    }
+
+    return float4(0.0f, 0.0f, 0.0f, Occlusion / 8.0f * 0.5f);
+}
+
+// -----------------------------------------------------------------------------
+// Composite Shader. Full resolution effects are read directly. Reduced effects
+// are upsampled from the four nearest low resolution pixels. The bilinear
+// weights are multiplied with the depth and normal similarity between the
+// full resolution pixel and the GBuffer pixel each low resolution sample was
+// calculated for. So samples from the other side of a silhouette are ignored.
+// -----------------------------------------------------------------------------
+float4 PSCompositeShader(PSInput _Input) : SV_Target
+{
+    int2   Pixel = GetPixel(_Input.m_TexCoord);
+    float4 Color = g_ColorMap.Load(int3(Pixel, 0));
+    float4 Term;
+
+    if (g_EffectScale.x >= 1.0f)
+    {
+        Term = g_EffectMap.Load(int3(Pixel, 0));
+    }
+    else
+    {
+        float  Scale       = g_EffectScale.x;
+        float  Depth       = GetLinearDepth(Pixel);
+        float3 Normal      = GetNormal(Pixel);
+        int2   LowSize     = int2(ceil(g_EffectScale.yz * Scale));
+        float2 LowPosition = (float2(Pixel) + 0.5f) * Scale - 0.5f;
+        int2   Base        = int2(floor(LowPosition));
+        float2 Fraction    = LowPosition - float2(Base);
+
+        float4 Sum       = 0.0f;
+        float  WeightSum = 0.0f;
+
+        [unroll] for (int Y = 0; Y < 2; ++ Y)
+        {
+            [unroll] for (int X = 0; X < 2; ++ X)
+            {
+                int2 LowPixel  = clamp(Base + int2(X, Y), int2(0, 0), LowSize - 1);
+                int2 FullPixel = min(int2((float2(LowPixel) + 0.5f) / Scale), GetSceneSize() - 1);
+
+                float Bilinear     = (X == 0 ? 1.0f - Fraction.x : Fraction.x) * (Y == 0 ? 1.0f - Fraction.y : Fraction.y);
+                float DepthWeight  = 1.0f / (0.001f + abs(Depth - GetLinearDepth(FullPixel)));
+                float NormalWeight = pow(saturate(dot(Normal, GetNormal(FullPixel))), 16.0f);
+                float Weight       = Bilinear * (DepthWeight * NormalWeight + 0.0001f);
+
+                Sum       += g_EffectMap.Load(int3(LowPixel, 0)) * Weight;
+                WeightSum += Weight;
+            }
+        }
+
+        Term = Sum / max(WeightSum, 0.000001f);
+    }
+
+    return float4(lerp(Color.rgb, Term.rgb, Term.a), Color.a);
+}
+
+// -----------------------------------------------------------------------------
+// Upsampling Shader. Scales the scene of dynamic resolution from the upper left
+// part of the color output of the last effect to the whole frame buffer with
+// bilinear filtering.
+// -----------------------------------------------------------------------------
+float4 PSUpsampleShader(PSInput _Input) : SV_Target
+{
+    int2   Size     = GetSceneSize() - 1;
+    float2 Position = _Input.m_TexCoord * g_EffectScale.yz - 0.5f;
+    int2   Base     = int2(floor(Position));
+    float2 Fraction = Position - float2(Base);
+
+    float4 Top    = lerp(g_ColorMap.Load(int3(clamp(Base + int2(0, 0), int2(0, 0), Size), 0)), g_ColorMap.Load(int3(clamp(Base + int2(1, 0), int2(0, 0), Size), 0)), Fraction.x);
+    float4 Bottom = lerp(g_ColorMap.Load(int3(clamp(Base + int2(0, 1), int2(0, 0), Size), 0)), g_ColorMap.Load(int3(clamp(Base + int2(1, 1), int2(0, 0), Size), 0)), Fraction.x);
+
+    return lerp(Top, Bottom, Fraction.y);
+}
@@ -0,0 +1,143 @@
+
+#include "texture_atlas.h"
+#include "texture_file.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Packs pairs of color and normal maps of billboards into atlas pages, so all
+// billboards sharing a page are drawn with one material:
+//
+//     atlas <name> <color> <normal> [<color> <normal> ...]
+//
+// Writes the pages '<name>_<page>_color.dds' and '<name>_<page>_normal.dds'
+// with 5 mip levels and '<name>.txt' with one line per sprite: its color map,
+// its page, and its UV rect, which goes into the vertices of the static batch,
+// see 'SStaticVertexLayout::m_HasAtlasRect'. The sprites get 8 texels of
+// padding and are aligned to 16 texels, so even the smallest mip level does
+// not mix two of them. The rect of a sprite is taken from its color map, the
+// normal map is scaled to it. The billboard example draws its walls from the
+// atlas '..\data\images\walls' if it exists.
+// -----------------------------------------------------------------------------
+
+int main(int _NumberOfArguments, char** _ppArguments)
+{
+    if (_NumberOfArguments < 4 || (_NumberOfArguments - 2) % 2 != 0)
+    {
+        std::cout << "usage: atlas <name> <color> <normal> [<color> <normal> ...]" << std::endl;
+
+        return 1;
+    }
+
+    const char* pName = _ppArguments[1];
+
+    int NumberOfSprites = (_NumberOfArguments - 2) / 2;
+
+    std::vector<STextureImage> ColorMaps (NumberOfSprites);
+    std::vector<STextureImage> NormalMaps(NumberOfSprites);
+
+    SAtlasSettings Settings = { 4096, 8, 5 };
+
+    CAtlasPacker Packer;
+
+    Packer.SetSettings(Settings);
+
+    size_t NumberOfSpriteTexels = 0;
+
+    for (int IndexOfSprite = 0; IndexOfSprite < NumberOfSprites; ++ IndexOfSprite)
+    {
+        const char* pColorPath  = _ppArguments[2 + IndexOfSprite * 2];
+        const char* pNormalPath = _ppArguments[3 + IndexOfSprite * 2];
+
+        if (ReadTexture(pColorPath, ColorMaps[IndexOfSprite]) == false)
+        {
+            std::cout << pColorPath << ": not a readable PNG or DDS file" << std::endl;
+
+            return 1;
+        }
+
+        if (ReadTexture(pNormalPath, NormalMaps[IndexOfSprite]) == false)
+        {
+            std::cout << pNormalPath << ": not a readable PNG or DDS file" << std::endl;
+
+            return 1;
+        }
+
+        Packer.AddSprite(ColorMaps[IndexOfSprite].m_Width, ColorMaps[IndexOfSprite].m_Height);
+
+        NumberOfSpriteTexels += static_cast<size_t>(ColorMaps[IndexOfSprite].m_Width) * ColorMaps[IndexOfSprite].m_Height;
+    }
+
+    if (Packer.Pack() == false)
+    {
+        std::cout << "a sprite is larger than " << Settings.m_MaximumSize << "x" << Settings.m_MaximumSize << " texels" << std::endl;
+
+        return 1;
+    }
+
+    for (int IndexOfPage = 0; IndexOfPage < Packer.GetNumberOfPages(); ++ IndexOfPage)
+    {
+        const SAtlasPage& rPage = Packer.GetPage(IndexOfPage);
+
+        STextureImage ColorPage  = { rPage.m_Width, rPage.m_Height, std::vector<unsigned char>(static_cast<size_t>(rPage.m_Width) * rPage.m_Height * 4, 0) };
+        STextureImage NormalPage = ColorPage;
+
+        // Texels outside of all cells get a normal facing the viewer
+        for (size_t IndexOfTexel = 0; IndexOfTexel < NormalPage.m_Pixels.size(); IndexOfTexel += 4)
+        {
+            NormalPage.m_Pixels[IndexOfTexel + 0] = 128;
+            NormalPage.m_Pixels[IndexOfTexel + 1] = 128;
+            NormalPage.m_Pixels[IndexOfTexel + 2] = 255;
+            NormalPage.m_Pixels[IndexOfTexel + 3] = 255;
+        }
+
+        for (int IndexOfSprite = 0; IndexOfSprite < NumberOfSprites; ++ IndexOfSprite)
+        {
+            const SAtlasRect& rRect = Packer.GetRect(IndexOfSprite);
+
+            if (rRect.m_Page != IndexOfPage) continue;
+
+            CopySprite(ColorMaps [IndexOfSprite], rRect, ColorPage );
+            CopySprite(NormalMaps[IndexOfSprite], rRect, NormalPage);
+        }
+
+        std::string Prefix = std::string(pName) + "_" + std::to_string(IndexOfPage);
+
+        if (WriteDds((Prefix + "_color.dds").c_str(), ColorPage, Settings.m_NumberOfMipLevels) == false || WriteDds((Prefix + "_normal.dds").c_str(), NormalPage, Settings.m_NumberOfMipLevels) == false)
+        {
+            std::cout << Prefix << ": the pages could not be written" << std::endl;
+
+            return 1;
+        }
+
+        std::cout << Prefix << ": " << rPage.m_Width << "x" << rPage.m_Height << " texels" << std::endl;
+    }
+
+    std::vector<SAtlasSprite> Sprites(NumberOfSprites);
+
+    for (int IndexOfSprite = 0; IndexOfSprite < NumberOfSprites; ++ IndexOfSprite)
+    {
+        const SAtlasRect& rRect = Packer.GetRect(IndexOfSprite);
+
+        Sprites[IndexOfSprite].m_Path = _ppArguments[2 + IndexOfSprite * 2];
+        Sprites[IndexOfSprite].m_Page = rRect.m_Page;
+
+        std::copy(rRect.m_UVRect, rRect.m_UVRect + 4, Sprites[IndexOfSprite].m_UVRect);
+    }
+
+    if (WriteAtlasDescription((std::string(pName) + ".txt").c_str(), Sprites) == false)
+    {
+        std::cout << pName << ".txt: the description could not be written" << std::endl;
+
+        return 1;
+    }
+
+    std::cout << NumberOfSprites << " sprites with " << NumberOfSpriteTexels << " texels on " << Packer.GetNumberOfPages() << " pages, "
+              << std::fixed << std::setprecision(1) << 100.0f * Packer.GetEfficiency() << "% used" << std::endl;
+
+    return 0;
+}
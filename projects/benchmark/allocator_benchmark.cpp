@@ -0,0 +1,265 @@
+
+#include "benchmark.h"
+
+#include "allocation_counter.h"
+#include "frame_arena.h"
+#include "handle_pool.h"
+#include "scene_store.h"
+
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+    const int s_NumberOfObjects     = 4096;                             // Capacity of the pool and live objects of the churn.
+    const int s_NumberOfOperations  = 1000000;
+    const int s_NumberOfFrameArrays = 2000;                             // Temporary arrays of one simulated frame.
+    const int s_NumberOfEntities    = 10000;
+    const int s_NumberOfWarmUps     = 10;
+    const int s_NumberOfFrames      = 100;
+    const int s_NumberOfRuns        = 8;
+
+    // -----------------------------------------------------------------------------
+    // Stands in for the data of one render object, e.g. a mesh with its bounds.
+    // -----------------------------------------------------------------------------
+    struct SObject
+    {
+        gfx::BHandle m_pMesh;
+        float        m_Position[3];
+        float        m_Radius;
+        int          m_SortGroup;
+    };
+
+    struct SObjectTag;
+
+    typedef CHandlePool<SObjectTag, SObject> CObjectPool;
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetViewProjectionMatrix(float* _pMatrix)
+    {
+        float Near = 0.1f;
+        float Far  = 1000.0f;
+
+        float Matrix[16] =
+        {
+            1.3f, 0.0f, 0.0f                      , 0.0f,
+            0.0f, 1.7f, 0.0f                      , 0.0f,
+            0.0f, 0.0f, Far / (Far - Near)        , 1.0f,
+            0.0f, 0.0f, -Near * Far / (Far - Near), 0.0f,
+        };
+
+        for (int Index = 0; Index < 16; ++ Index) _pMatrix[Index] = Matrix[Index];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, double _Time, double _NumberOfAllocations)
+    {
+        std::cout << std::left << std::setw(40) << _pName << std::right << std::setw(12) << _Time << std::setw(16) << _NumberOfAllocations << std::endl;
+    }
+} // namespace
+
+void RunAllocatorBenchmark()
+{
+    std::cout << std::endl;
+    std::cout << "Allocators (" << s_NumberOfOperations << " operations, " << s_NumberOfObjects << " live objects)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(40) << "Case" << std::right << std::setw(12) << "ms" << std::setw(16) << "Allocations" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    // -----------------------------------------------------------------------------
+    // Churn: free a random object and create a new one in its place, then read
+    // a random object. Note that new and delete go through the counting
+    // operators, which add one relaxed atomic increment per allocation.
+    // -----------------------------------------------------------------------------
+    std::vector<SObject*> Pointers(s_NumberOfObjects);
+
+    for (SObject*& rpObject : Pointers) rpObject = new SObject();
+
+    unsigned int State = 4711;
+    float        Sum   = 0.0f;
+
+    unsigned long long NumberOfAllocations = GetNumberOfAllocations();
+
+    double NewTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        for (int IndexOfOperation = 0; IndexOfOperation < s_NumberOfOperations; ++ IndexOfOperation)
+        {
+            SObject*& rpObject = Pointers[GetRandom(State) % s_NumberOfObjects];
+
+            delete rpObject;
+
+            rpObject = new SObject();
+
+            rpObject->m_Radius = static_cast<float>(IndexOfOperation);
+
+            Sum += Pointers[GetRandom(State) % s_NumberOfObjects]->m_Radius;
+        }
+    });
+
+    PrintRow("new / delete", NewTime, static_cast<double>(GetNumberOfAllocations() - NumberOfAllocations) / (s_NumberOfRuns + 1));
+
+    for (SObject* pObject : Pointers) delete pObject;
+
+    CObjectPool Pool(s_NumberOfObjects);
+
+    std::vector<CObjectPool::SHandle> Handles(s_NumberOfObjects);
+
+    for (CObjectPool::SHandle& rHandle : Handles) rHandle = Pool.Allocate(SObject());
+
+    NumberOfAllocations = GetNumberOfAllocations();
+
+    double PoolTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        for (int IndexOfOperation = 0; IndexOfOperation < s_NumberOfOperations; ++ IndexOfOperation)
+        {
+            CObjectPool::SHandle& rHandle = Handles[GetRandom(State) % s_NumberOfObjects];
+
+            Pool.Free(rHandle);
+
+            SObject Object = SObject();
+
+            Object.m_Radius = static_cast<float>(IndexOfOperation);
+
+            rHandle = Pool.Allocate(Object);
+
+            Sum += Pool.Get(Handles[GetRandom(State) % s_NumberOfObjects]).m_Radius;
+        }
+    });
+
+    PrintRow("Handle pool", PoolTime, static_cast<double>(GetNumberOfAllocations() - NumberOfAllocations) / (s_NumberOfRuns + 1));
+
+    // -----------------------------------------------------------------------------
+    // Temporary arrays of one frame: malloc and free each one, or take them from
+    // the arena and reset it once.
+    // -----------------------------------------------------------------------------
+    std::vector<size_t> Sizes(s_NumberOfFrameArrays);
+    std::vector<void*>  Arrays(s_NumberOfFrameArrays);
+
+    size_t FrameSize = 0;
+
+    for (size_t& rSize : Sizes)
+    {
+        rSize      = 16 + GetRandom(State) % 4096;
+        FrameSize += rSize + 16;
+    }
+
+    double MallocTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        for (int IndexOfArray = 0; IndexOfArray < s_NumberOfFrameArrays; ++ IndexOfArray)
+        {
+            Arrays[IndexOfArray] = malloc(Sizes[IndexOfArray]);
+
+            static_cast<char*>(Arrays[IndexOfArray])[0] = 1;
+        }
+
+        for (void* pArray : Arrays) free(pArray);
+    });
+
+    PrintRow("Frame arrays, malloc / free", MallocTime, s_NumberOfFrameArrays);
+
+    CFrameArena Arena(FrameSize);
+
+    NumberOfAllocations = GetNumberOfAllocations();
+
+    double ArenaTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        Arena.Reset();
+
+        for (int IndexOfArray = 0; IndexOfArray < s_NumberOfFrameArrays; ++ IndexOfArray)
+        {
+            Arrays[IndexOfArray] = Arena.Allocate(Sizes[IndexOfArray]);
+
+            static_cast<char*>(Arrays[IndexOfArray])[0] = 1;
+        }
+    });
+
+    PrintRow("Frame arrays, arena", ArenaTime, static_cast<double>(GetNumberOfAllocations() - NumberOfAllocations) / (s_NumberOfRuns + 1));
+
+    // -----------------------------------------------------------------------------
+    // The steady state of a frame: cull and sort the scene into the arena and
+    // look up the objects of the draws through their handles. After the warm up
+    // frames not a single heap allocation may happen.
+    // -----------------------------------------------------------------------------
+    CSceneStore Scene;
+
+    Scene.Reserve(s_NumberOfEntities);
+
+    std::vector<CObjectPool::SHandle> EntityObjects(s_NumberOfEntities);
+
+    for (int IndexOfEntity = 0; IndexOfEntity < s_NumberOfEntities; ++ IndexOfEntity)
+    {
+        float Position[3] =
+        {
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+        };
+
+        Scene.Create(nullptr, IndexOfEntity % 4, Position, 1.0f);
+    }
+
+    CObjectPool EntityPool(s_NumberOfEntities);
+
+    for (CObjectPool::SHandle& rHandle : EntityObjects) rHandle = EntityPool.Allocate(SObject());
+
+    CFrameArena FrameArena(s_NumberOfEntities * (sizeof(int) + sizeof(SSceneDraw)) + 64);
+
+    float ViewProjectionMatrix[16];
+    float EyePosition[3] = { 0.0f, 0.0f, 0.0f };
+
+    GetViewProjectionMatrix(ViewProjectionMatrix);
+
+    int NumberOfDraws = 0;
+
+    auto RunFrame = [&]()
+    {
+        FrameArena.Reset();
+
+        int*        pVisible = FrameArena.AllocateArray<int>(Scene.GetNumberOfEntities());
+        SSceneDraw* pDraws   = FrameArena.AllocateArray<SSceneDraw>(Scene.GetNumberOfEntities());
+
+        NumberOfDraws = Scene.Cull(ViewProjectionMatrix, pVisible);
+
+        Scene.Sort(pVisible, NumberOfDraws, EyePosition, SSortOrder::FrontToBack, pDraws);
+
+        for (int IndexOfDraw = 0; IndexOfDraw < NumberOfDraws; ++ IndexOfDraw)
+        {
+            Sum += EntityPool.Get(EntityObjects[pDraws[IndexOfDraw].m_IndexOfEntity]).m_Radius;
+        }
+    };
+
+    for (int IndexOfFrame = 0; IndexOfFrame < s_NumberOfWarmUps; ++ IndexOfFrame) RunFrame();
+
+    NumberOfAllocations = GetNumberOfAllocations();
+
+    CStopwatch Stopwatch;
+
+    for (int IndexOfFrame = 0; IndexOfFrame < s_NumberOfFrames; ++ IndexOfFrame) RunFrame();
+
+    double FrameTime = Stopwatch.GetElapsedMilliseconds() / s_NumberOfFrames;
+
+    unsigned long long FrameAllocations = GetNumberOfAllocations() - NumberOfAllocations;
+
+    PrintRow("Frame, cull + sort + lookups", FrameTime, static_cast<double>(FrameAllocations) / s_NumberOfFrames);
+
+    std::cout << "Steady state: " << FrameAllocations << " heap allocations in " << s_NumberOfFrames << " frames of " << NumberOfDraws << " draws, "
+              << FrameArena.GetPeakSize() << " arena bytes, " << FrameArena.GetNumberOfFailedAllocations() << " failed arena allocations" << std::endl;
+
+    // -----------------------------------------------------------------------------
+    // Keeps the compiler from removing the loops.
+    // -----------------------------------------------------------------------------
+    if (Sum == 1.0f) std::cout << Sum << std::endl;
+}
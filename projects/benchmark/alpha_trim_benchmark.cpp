@@ -0,0 +1,147 @@
+
+#include "benchmark.h"
+
+#include "alpha_trim.h"
+#include "depth_rasterizer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    const int s_Width  = 960;                                           // The billboard fills the viewport.
+    const int s_Height = 720;
+
+    // -----------------------------------------------------------------------------
+    // Counts the fragments of the billboard and those which sample a texel with
+    // an alpha of 0, which are blended without changing the pixel.
+    // -----------------------------------------------------------------------------
+    struct SFragmentCounter
+    {
+        const SAlphaMask* m_pMask;
+        long long         m_NumberOfFragments;
+        long long         m_NumberOfTransparentFragments;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    float CountFragment(int _X, int _Y, float _Depth, void* _pUserData)
+    {
+        SFragmentCounter& rCounter = *static_cast<SFragmentCounter*>(_pUserData);
+
+        const SAlphaMask& rMask = *rCounter.m_pMask;
+
+        int TexelX = (2 * _X + 1) * rMask.m_Width  / (2 * s_Width);
+        int TexelY = (2 * _Y + 1) * rMask.m_Height / (2 * s_Height);
+
+        ++ rCounter.m_NumberOfFragments;
+
+        if (rMask.m_Alpha[static_cast<size_t>(TexelY) * rMask.m_Width + TexelX] == 0) ++ rCounter.m_NumberOfTransparentFragments;
+
+        return _Depth;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Draws the billboard polygon over the whole viewport, so the texture
+    // coordinate of a pixel is its position in the viewport.
+    // -----------------------------------------------------------------------------
+    SFragmentCounter Rasterize(CDepthRasterizer& _rRasterizer, const SAlphaMask& _rMask, const STrimmedPolygon& _rPolygon)
+    {
+        static const float s_IdentityMatrix[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+        float Vertices[STrimmedPolygon::s_MaximumNumberOfVertices][3];
+        int   Indices [STrimmedPolygon::s_MaximumNumberOfVertices - 2][3];
+
+        for (int IndexOfVertex = 0; IndexOfVertex < _rPolygon.m_NumberOfVertices; ++ IndexOfVertex)
+        {
+            Vertices[IndexOfVertex][0] = _rPolygon.m_TexCoords[IndexOfVertex][0] * 2.0f - 1.0f;
+            Vertices[IndexOfVertex][1] = 1.0f - _rPolygon.m_TexCoords[IndexOfVertex][1] * 2.0f;
+            Vertices[IndexOfVertex][2] = 0.0f;
+        }
+
+        for (int IndexOfTriangle = 0; IndexOfTriangle < _rPolygon.m_NumberOfVertices - 2; ++ IndexOfTriangle)
+        {
+            Indices[IndexOfTriangle][0] = 0;
+            Indices[IndexOfTriangle][1] = IndexOfTriangle + 1;
+            Indices[IndexOfTriangle][2] = IndexOfTriangle + 2;
+        }
+
+        SFragmentCounter Counter = { &_rMask, 0, 0 };
+
+        SRasterState State = { gfx::SDepthTest::Off, false, &CountFragment, &Counter };
+
+        _rRasterizer.BeginFrame();
+        _rRasterizer.DrawTriangles(&Vertices[0][0], 3, &Indices[0][0], (_rPolygon.m_NumberOfVertices - 2) * 3, s_IdentityMatrix, State);
+
+        return Counter;
+    }
+} // namespace
+
+void RunAlphaTrimBenchmark()
+{
+    const char* pPath = "..\\data\\images\\tree_colored.png";
+
+    std::cout << std::endl;
+    std::cout << "Alpha trimmed billboards (tree_colored.png at " << s_Width << "x" << s_Height << " pixels)" << std::endl;
+
+    SAlphaMask Mask;
+
+    double ReadTime = MeasureMilliseconds(1, [&]()
+    {
+        ReadPngAlpha(pPath, Mask);
+    });
+
+    if (Mask.m_Alpha.empty())
+    {
+        std::cout << pPath << " not found, run the benchmark from the bin directory" << std::endl;
+
+        return;
+    }
+
+    STrimSettings Settings = { 0, 1.0f, 16, 8 };
+
+    STrimmedPolygon Polygons[STrimmedPolygon::s_MaximumNumberOfVertices + 1];
+    double          TrimTimes[STrimmedPolygon::s_MaximumNumberOfVertices + 1];
+
+    for (int NumberOfVertices = 4; NumberOfVertices <= STrimmedPolygon::s_MaximumNumberOfVertices; ++ NumberOfVertices)
+    {
+        Settings.m_MaximumNumberOfVertices = NumberOfVertices;
+
+        TrimTimes[NumberOfVertices] = MeasureMilliseconds(1, [&]()
+        {
+            GetTrimmedPolygon(Mask, Settings, Polygons[NumberOfVertices]);
+        });
+    }
+
+    CDepthRasterizer Rasterizer;
+
+    Rasterizer.SetViewport(s_Width, s_Height);
+    Rasterizer.SetDepthRange(0.1f, 100.0f, SDepthMode::Standard);
+
+    STrimmedPolygon Quad = { 4, { { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, 0.0f } }, 1.0f };
+
+    SFragmentCounter QuadCounter = Rasterize(Rasterizer, Mask, Quad);
+
+    std::cout << "Read in " << std::fixed << std::setprecision(2) << ReadTime << " ms" << std::endl;
+    std::cout << std::endl;
+
+    // Every fragment of the blended billboards is blended, the transparent ones without any effect
+    std::cout << std::left << std::setw(20) << "Polygon" << std::right << std::setw(10) << "Area" << std::setw(16) << "Fragments" << std::setw(12) << "Saved"
+              << std::setw(20) << "Transparent blends" << std::setw(12) << "Saved" << std::setw(12) << "Trim ms" << std::endl;
+
+    std::cout << std::left << std::setw(20) << "Quad" << std::right << std::setw(9) << std::setprecision(1) << 100.0f * Quad.m_Area << "%" << std::setw(16) << QuadCounter.m_NumberOfFragments << std::setw(12) << ""
+              << std::setw(20) << QuadCounter.m_NumberOfTransparentFragments << std::setw(12) << "" << std::setw(12) << "" << std::endl;
+
+    for (int NumberOfVertices = 4; NumberOfVertices <= STrimmedPolygon::s_MaximumNumberOfVertices; ++ NumberOfVertices)
+    {
+        const STrimmedPolygon& rPolygon = Polygons[NumberOfVertices];
+
+        SFragmentCounter Counter = Rasterize(Rasterizer, Mask, rPolygon);
+
+        std::cout << std::left << std::setw(20) << (std::to_string(rPolygon.m_NumberOfVertices) + " vertices") << std::right << std::setw(9) << 100.0f * rPolygon.m_Area << "%"
+                  << std::setw(16) << Counter.m_NumberOfFragments << std::setw(11) << 100.0 * (1.0 - static_cast<double>(Counter.m_NumberOfFragments) / QuadCounter.m_NumberOfFragments) << "%"
+                  << std::setw(20) << Counter.m_NumberOfTransparentFragments << std::setw(11) << 100.0 * (1.0 - static_cast<double>(Counter.m_NumberOfTransparentFragments) / QuadCounter.m_NumberOfTransparentFragments) << "%"
+                  << std::setw(12) << std::setprecision(2) << TrimTimes[NumberOfVertices] << std::setprecision(1) << std::endl;
+    }
+}
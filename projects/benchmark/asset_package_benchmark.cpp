@@ -0,0 +1,216 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "benchmark.h"
+
+#include "asset_package.h"
+#include "mesh_importer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int s_NumberOfMeshes   = 32;
+    const int s_GridSize         = 128;                                 // Vertices per side of each generated mesh.
+    const int s_TextureSize      = 256 * 1024;                          // Bytes of each generated texture.
+    const int s_NumberOfRuns     = 4;
+
+    const char* s_pPackagePath   = "benchmark_assets.yxp";
+
+    // -----------------------------------------------------------------------------
+
+    std::string GetMeshPath(int _IndexOfMesh)
+    {
+        return "benchmark_asset_" + std::to_string(_IndexOfMesh) + ".obj";
+    }
+
+    // -----------------------------------------------------------------------------
+
+    std::string GetTexturePath(int _IndexOfMesh)
+    {
+        return "benchmark_asset_" + std::to_string(_IndexOfMesh) + ".dds";
+    }
+
+    // -----------------------------------------------------------------------------
+    // Writes a wavy grid as OBJ file, which is what an exporter would produce.
+    // -----------------------------------------------------------------------------
+    void WriteGrid(const std::string& _rPath, int _Seed)
+    {
+        FILE* pFile = fopen(_rPath.c_str(), "w");
+
+        if (pFile == nullptr) return;
+
+        for (int Y = 0; Y < s_GridSize; ++ Y)
+        {
+            for (int X = 0; X < s_GridSize; ++ X)
+            {
+                fprintf(pFile, "v %f %f %f\n", static_cast<float>(X), static_cast<float>((X * 7 + Y * 13 + _Seed) % 17) * 0.05f, static_cast<float>(Y));
+                fprintf(pFile, "vt %f %f\n", static_cast<float>(X) / (s_GridSize - 1), static_cast<float>(Y) / (s_GridSize - 1));
+                fprintf(pFile, "vn 0.000000 1.000000 0.000000\n");
+            }
+        }
+
+        for (int Y = 0; Y + 1 < s_GridSize; ++ Y)
+        {
+            for (int X = 0; X + 1 < s_GridSize; ++ X)
+            {
+                int A = Y * s_GridSize + X + 1;
+                int B = A + 1;
+                int C = A + s_GridSize + 1;
+                int D = A + s_GridSize;
+
+                fprintf(pFile, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", A, A, A, B, B, B, C, C, C, D, D, D);
+            }
+        }
+
+        fclose(pFile);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool ReadFile(const std::string& _rPath, std::vector<char>& _rData)
+    {
+        FILE* pFile = fopen(_rPath.c_str(), "rb");
+
+        if (pFile == nullptr) return false;
+
+        fseek(pFile, 0, SEEK_END);
+
+        _rData.resize(static_cast<size_t>(ftell(pFile)));
+
+        fseek(pFile, 0, SEEK_SET);
+
+        size_t NumberOfBytes = fread(_rData.data(), 1, _rData.size(), pFile);
+
+        fclose(pFile);
+
+        return NumberOfBytes == _rData.size();
+    }
+} // namespace
+
+void RunAssetPackageBenchmark()
+{
+    // -----------------------------------------------------------------------------
+    // Create the loose files and pack them.
+    // -----------------------------------------------------------------------------
+    std::vector<char> Texture(s_TextureSize, 0x5A);
+
+    CAssetPackageWriter Writer;
+
+    for (int IndexOfMesh = 0; IndexOfMesh < s_NumberOfMeshes; ++ IndexOfMesh)
+    {
+        WriteGrid(GetMeshPath(IndexOfMesh), IndexOfMesh);
+
+        FILE* pFile = fopen(GetTexturePath(IndexOfMesh).c_str(), "wb");
+
+        if (pFile != nullptr)
+        {
+            fwrite(Texture.data(), 1, Texture.size(), pFile);
+            fclose(pFile);
+        }
+
+        SImportedMesh Mesh;
+
+        ImportObj(GetMeshPath(IndexOfMesh).c_str(), Mesh);
+
+        Writer.AddMesh(GetMeshPath(IndexOfMesh).c_str(), Mesh.m_Vertices.data(), static_cast<int>(Mesh.m_Vertices.size()) / Mesh.m_NumberOfFloatsPerVertex, Mesh.m_NumberOfFloatsPerVertex, Mesh.m_Indices.data(), static_cast<int>(Mesh.m_Indices.size()), -1);
+        Writer.AddTexture(GetTexturePath(IndexOfMesh).c_str(), GetTexturePath(IndexOfMesh).c_str(), SPackageTextureFormat::DDS, Texture.data(), static_cast<int>(Texture.size()));
+    }
+
+    Writer.Write(s_pPackagePath);
+
+    // -----------------------------------------------------------------------------
+    // The loose path parses every OBJ file and reads every texture file. The
+    // package path maps one file and hands out pointers, optionally touching
+    // every byte to include the page faults.
+    // -----------------------------------------------------------------------------
+    long long LooseBytes = 0;
+
+    double LooseTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        LooseBytes = 0;
+
+        for (int IndexOfMesh = 0; IndexOfMesh < s_NumberOfMeshes; ++ IndexOfMesh)
+        {
+            SImportedMesh     Mesh;
+            std::vector<char> Data;
+
+            ImportObj(GetMeshPath(IndexOfMesh).c_str(), Mesh);
+            ReadFile (GetTexturePath(IndexOfMesh), Data);
+
+            LooseBytes += static_cast<long long>(Mesh.m_Vertices.size() * sizeof(float) + Mesh.m_Indices.size() * sizeof(int) + Data.size());
+        }
+    });
+
+    double MappedTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        CAssetPackage Package;
+
+        Package.Open(s_pPackagePath);
+
+        for (int IndexOfMesh = 0; IndexOfMesh < Package.GetNumberOfMeshes(); ++ IndexOfMesh)
+        {
+            gfx::SMeshInfo MeshInfo;
+
+            Package.GetMeshInfo(IndexOfMesh, nullptr, MeshInfo);
+        }
+    });
+
+    unsigned int Checksum = 0;
+
+    double TouchedTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        CAssetPackage Package;
+
+        Package.Open(s_pPackagePath);
+
+        for (int IndexOfMesh = 0; IndexOfMesh < Package.GetNumberOfMeshes(); ++ IndexOfMesh)
+        {
+            const SPackageMesh& rMesh     = Package.GetMesh(IndexOfMesh);
+            const float*        pVertices = Package.GetVertices(IndexOfMesh);
+            const int*          pIndices  = Package.GetIndices(IndexOfMesh);
+
+            for (unsigned int IndexOfFloat = 0; IndexOfFloat < rMesh.m_NumberOfVertices * rMesh.m_NumberOfFloatsPerVertex; IndexOfFloat += 16)
+            {
+                Checksum += static_cast<unsigned int>(pVertices[IndexOfFloat]);
+            }
+
+            for (unsigned int IndexOfIndex = 0; IndexOfIndex < rMesh.m_NumberOfIndices; IndexOfIndex += 16)
+            {
+                Checksum += static_cast<unsigned int>(pIndices[IndexOfIndex]);
+            }
+        }
+
+        for (int IndexOfTexture = 0; IndexOfTexture < Package.GetNumberOfTextures(); ++ IndexOfTexture)
+        {
+            const char* pData = static_cast<const char*>(Package.GetTextureData(IndexOfTexture));
+
+            for (unsigned int IndexOfByte = 0; IndexOfByte < Package.GetTexture(IndexOfTexture).m_DataSize; IndexOfByte += 4096)
+            {
+                Checksum += static_cast<unsigned char>(pData[IndexOfByte]);
+            }
+        }
+    });
+
+    std::cout << std::endl;
+    std::cout << "Asset package (" << s_NumberOfMeshes << " meshes with " << 2 * (s_GridSize - 1) * (s_GridSize - 1) << " triangles and "
+              << s_TextureSize / 1024 << " KB textures, " << LooseBytes / (1024 * 1024) << " MB of data)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(36) << "Path" << std::right << std::setw(12) << "ms" << std::setw(12) << "Speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(36) << "Loose OBJ and texture files"   << std::right << std::setw(12) << LooseTime   << std::setw(12) << 1.0                      << std::endl;
+    std::cout << std::left << std::setw(36) << "Package, mapped"               << std::right << std::setw(12) << MappedTime  << std::setw(12) << LooseTime / MappedTime  << std::endl;
+    std::cout << std::left << std::setw(36) << "Package, mapped and touched"   << std::right << std::setw(12) << TouchedTime << std::setw(12) << LooseTime / TouchedTime << std::endl;
+
+    for (int IndexOfMesh = 0; IndexOfMesh < s_NumberOfMeshes; ++ IndexOfMesh)
+    {
+        remove(GetMeshPath(IndexOfMesh).c_str());
+        remove(GetTexturePath(IndexOfMesh).c_str());
+    }
+
+    remove(s_pPackagePath);
+}
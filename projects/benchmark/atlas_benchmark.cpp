@@ -0,0 +1,207 @@
+
+#include "benchmark.h"
+
+#include "static_batch.h"
+#include "texture_atlas.h"
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const int   s_NumberOfSprites   = 1000;                             // Billboard varieties, each with its own color and normal map.
+    const int   s_NumberOfInstances = 10000;
+    const float s_SceneSize         = 400.0f;
+    const float s_CellSize          = 50.0f;
+    const int   s_NumberOfRuns      = 10;
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    struct SPackResult
+    {
+        double m_Time;
+        int    m_NumberOfPages;
+        float  m_Efficiency;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    SPackResult Pack(CAtlasPacker& _rPacker, const SAtlasSettings& _rSettings, const std::vector<int>& _rSizes)
+    {
+        SPackResult Result;
+
+        Result.m_Time = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            _rPacker.Clear();
+            _rPacker.SetSettings(_rSettings);
+
+            for (size_t IndexOfSprite = 0; IndexOfSprite < _rSizes.size(); IndexOfSprite += 2) _rPacker.AddSprite(_rSizes[IndexOfSprite], _rSizes[IndexOfSprite + 1]);
+
+            _rPacker.Pack();
+        });
+
+        Result.m_NumberOfPages = _rPacker.GetNumberOfPages();
+        Result.m_Efficiency    = _rPacker.GetEfficiency();
+
+        return Result;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The batches are sorted by material, so each new material of a batch is one
+    // switch of textures and shaders.
+    // -----------------------------------------------------------------------------
+    int GetNumberOfMaterialSwitches(const CStaticBatcher& _rBatcher)
+    {
+        gfx::BHandle pMaterial = nullptr;
+
+        int NumberOfSwitches = 0;
+
+        for (int IndexOfBatch = 0; IndexOfBatch < _rBatcher.GetNumberOfBatches(); ++ IndexOfBatch)
+        {
+            if (_rBatcher.GetBatch(IndexOfBatch).m_pMaterial != pMaterial) ++ NumberOfSwitches;
+
+            pMaterial = _rBatcher.GetBatch(IndexOfBatch).m_pMaterial;
+        }
+
+        return NumberOfSwitches;
+    }
+} // namespace
+
+void RunAtlasBenchmark()
+{
+    // -----------------------------------------------------------------------------
+    // Sprites between 64 and 512 texels on each side, most of them small like
+    // the textures of plants and props.
+    // -----------------------------------------------------------------------------
+    unsigned int State = 42;
+
+    std::vector<int> Sizes;
+
+    for (int IndexOfSprite = 0; IndexOfSprite < s_NumberOfSprites; ++ IndexOfSprite)
+    {
+        int Scale = 64 << (GetRandom(State) % 3 + GetRandom(State) % 3) / 2;
+
+        Sizes.push_back(Scale + static_cast<int>(GetRandom(State) % Scale));
+        Sizes.push_back(Scale + static_cast<int>(GetRandom(State) % Scale));
+    }
+
+    // -----------------------------------------------------------------------------
+    // Padding only is enough for the first mip level. The mip safe settings align
+    // the sprites to 16 texels, so 5 mip levels never mix two of them.
+    // -----------------------------------------------------------------------------
+    SAtlasSettings PaddingSettings = { 4096, 2, 1 };
+    SAtlasSettings MipSettings     = { 4096, 8, 5 };
+
+    CAtlasPacker Packer;
+
+    SPackResult PaddingResult = Pack(Packer, PaddingSettings, Sizes);
+    SPackResult MipResult     = Pack(Packer, MipSettings    , Sizes);
+
+    // -----------------------------------------------------------------------------
+    // Billboards of random varieties spread over the scene, each one a quad with
+    // position and texture coordinates. Without an atlas each variety is its own
+    // material, with the atlas all varieties on a page share one and the UV rect
+    // of the sprite goes into the vertices.
+    // -----------------------------------------------------------------------------
+    static const float s_QuadVertices[] =
+    {
+        -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+         1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+         1.0f, 2.0f, 0.0f, 1.0f, 0.0f,
+        -1.0f, 2.0f, 0.0f, 0.0f, 0.0f,
+    };
+
+    static const int s_QuadIndices[] = { 0, 1, 2, 0, 2, 3 };
+
+    SStaticMesh Quad = { s_QuadVertices, 4, s_QuadIndices, 6 };
+
+    SStaticVertexLayout SpriteLayout = { 5, 0, 0, { 0, 0, 0, 0 }, true, false };
+    SStaticVertexLayout AtlasLayout  = { 5, 0, 0, { 0, 0, 0, 0 }, true, true  };
+
+    std::vector<int>   Varieties(s_NumberOfInstances);
+    std::vector<float> WorldMatrices(s_NumberOfInstances * 16, 0.0f);
+
+    for (int IndexOfInstance = 0; IndexOfInstance < s_NumberOfInstances; ++ IndexOfInstance)
+    {
+        float* pMatrix = &WorldMatrices[IndexOfInstance * 16];
+
+        pMatrix[0]  = 1.0f;
+        pMatrix[5]  = 1.0f;
+        pMatrix[10] = 1.0f;
+        pMatrix[12] = static_cast<float>(GetRandom(State) % 10000) / 10000.0f * s_SceneSize;
+        pMatrix[14] = static_cast<float>(GetRandom(State) % 10000) / 10000.0f * s_SceneSize;
+        pMatrix[15] = 1.0f;
+
+        Varieties[IndexOfInstance] = static_cast<int>(GetRandom(State) % s_NumberOfSprites);
+    }
+
+    CStaticBatcher SpriteBatcher;
+    CStaticBatcher AtlasBatcher;
+
+    double SpriteTime = MeasureMilliseconds(1, [&]()
+    {
+        SpriteBatcher.Clear();
+        SpriteBatcher.SetLayout(SpriteLayout);
+        SpriteBatcher.SetCellSize(s_CellSize);
+
+        for (int IndexOfInstance = 0; IndexOfInstance < s_NumberOfInstances; ++ IndexOfInstance)
+        {
+            gfx::BHandle pMaterial = reinterpret_cast<gfx::BHandle>(static_cast<size_t>(Varieties[IndexOfInstance] + 1));
+
+            SpriteBatcher.AddInstance(pMaterial, Quad, &WorldMatrices[IndexOfInstance * 16]);
+        }
+
+        SpriteBatcher.Build();
+    });
+
+    double AtlasTime = MeasureMilliseconds(1, [&]()
+    {
+        AtlasBatcher.Clear();
+        AtlasBatcher.SetLayout(AtlasLayout);
+        AtlasBatcher.SetCellSize(s_CellSize);
+
+        for (int IndexOfInstance = 0; IndexOfInstance < s_NumberOfInstances; ++ IndexOfInstance)
+        {
+            const SAtlasRect& rRect = Packer.GetRect(Varieties[IndexOfInstance]);
+
+            gfx::BHandle pMaterial = reinterpret_cast<gfx::BHandle>(static_cast<size_t>(rRect.m_Page + 1));
+
+            AtlasBatcher.AddInstance(pMaterial, Quad, &WorldMatrices[IndexOfInstance * 16], rRect.m_UVRect);
+        }
+
+        AtlasBatcher.Build();
+    });
+
+    int SpriteSwitches = GetNumberOfMaterialSwitches(SpriteBatcher);
+    int AtlasSwitches  = GetNumberOfMaterialSwitches(AtlasBatcher);
+
+    std::cout << std::endl;
+    std::cout << "Texture atlas (" << s_NumberOfSprites << " sprites, " << s_NumberOfInstances << " billboards in cells of " << s_CellSize << " units)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(36) << "Packing" << std::right << std::setw(12) << "Pages" << std::setw(12) << "Used" << std::setw(12) << "ms" << std::endl;
+    std::cout << std::fixed;
+
+    std::cout << std::left << std::setw(36) << "Padding 2, 1 mip level" << std::right << std::setw(12) << PaddingResult.m_NumberOfPages << std::setw(11) << std::setprecision(1) << 100.0f * PaddingResult.m_Efficiency << "%"
+              << std::setw(12) << std::setprecision(2) << PaddingResult.m_Time << std::endl;
+    std::cout << std::left << std::setw(36) << "Padding 8, 5 mip levels" << std::right << std::setw(12) << MipResult.m_NumberOfPages << std::setw(11) << std::setprecision(1) << 100.0f * MipResult.m_Efficiency << "%"
+              << std::setw(12) << std::setprecision(2) << MipResult.m_Time << std::endl;
+
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(36) << "Static batches" << std::right << std::setw(12) << "Draws" << std::setw(12) << "Materials" << std::setw(12) << "Build ms" << std::endl;
+    std::cout << std::left << std::setw(36) << "Per instance" << std::right << std::setw(12) << s_NumberOfInstances << std::setw(12) << s_NumberOfSprites << std::setw(12) << "" << std::endl;
+    std::cout << std::left << std::setw(36) << "One material per sprite" << std::right << std::setw(12) << SpriteBatcher.GetNumberOfBatches() << std::setw(12) << SpriteSwitches << std::setw(12) << SpriteTime << std::endl;
+    std::cout << std::left << std::setw(36) << "One material per atlas page" << std::right << std::setw(12) << AtlasBatcher.GetNumberOfBatches() << std::setw(12) << AtlasSwitches << std::setw(12) << AtlasTime << std::endl;
+
+    std::cout << std::setprecision(1) << "Draws saved by the atlas: " << SpriteBatcher.GetNumberOfBatches() - AtlasBatcher.GetNumberOfBatches() << " ("
+              << 100.0 * (1.0 - static_cast<double>(AtlasBatcher.GetNumberOfBatches()) / SpriteBatcher.GetNumberOfBatches()) << "%), material switches saved: " << SpriteSwitches - AtlasSwitches << std::endl;
+}
@@ -0,0 +1,30 @@
+
+#include "benchmark.h"
+
+#include <iostream>
+
+void main()
+{
+    std::cout << "Benchmarks of the example modules" << std::endl;
+    std::cout << "---------------------------------" << std::endl;
+
+    RunImageFilterBenchmark();
+    RunGBufferBenchmark();
+    RunAssetPackageBenchmark();
+    RunMeshImporterBenchmark();
+    RunSceneStoreBenchmark();
+    RunTransformHierarchyBenchmark();
+    RunAllocatorBenchmark();
+    RunFixedStepBenchmark();
+    RunFramePipelineBenchmark();
+    RunJobSystemBenchmark();
+    RunStaticBatchBenchmark();
+    RunMeshletBenchmark();
+    RunAlphaTrimBenchmark();
+    RunAtlasBenchmark();
+    RunParticleBenchmark();
+    RunTerrainBenchmark();
+    RunTemporalCacheBenchmark();
+    RunDynamicResolutionBenchmark();
+    RunLogBenchmark();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "frame_statistics.h"
+
+// -----------------------------------------------------------------------------
+// Runs the function the given number of times and returns the average time of
+// one run in milliseconds. The first run is a warm up and is not measured.
+// -----------------------------------------------------------------------------
+template<typename TFunction>
+double MeasureMilliseconds(int _NumberOfRuns, const TFunction& _rFunction)
+{
+    _rFunction();
+
+    CStopwatch Stopwatch;
+
+    for (int IndexOfRun = 0; IndexOfRun < _NumberOfRuns; ++ IndexOfRun)
+    {
+        _rFunction();
+    }
+
+    return Stopwatch.GetElapsedMilliseconds() / static_cast<double>(_NumberOfRuns);
+}
+
+// -----------------------------------------------------------------------------
+// The benchmarks of the single modules. Each one prints its own table.
+// -----------------------------------------------------------------------------
+void RunImageFilterBenchmark();
+void RunGBufferBenchmark();
+void RunAssetPackageBenchmark();
+void RunMeshImporterBenchmark();
+void RunSceneStoreBenchmark();
+void RunTransformHierarchyBenchmark();
+void RunAllocatorBenchmark();
+void RunFixedStepBenchmark();
+void RunFramePipelineBenchmark();
+void RunJobSystemBenchmark();
+void RunStaticBatchBenchmark();
+void RunMeshletBenchmark();
+void RunAlphaTrimBenchmark();
+void RunAtlasBenchmark();
+void RunParticleBenchmark();
+void RunTerrainBenchmark();
+void RunTemporalCacheBenchmark();
+void RunDynamicResolutionBenchmark();
+void RunLogBenchmark();
@@ -0,0 +1,214 @@
+
+#include "benchmark.h"
+
+#include "camera.h"
+#include "dynamic_resolution.h"
+#include "offscreen_renderer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+namespace
+{
+    const int   s_Width          = 320;                                 // The size of the regression images, the software renderer is slow.
+    const int   s_Height         = 240;
+    const int   s_FramesPerPhase = 60;
+    const float s_Size           = 0.5f;                                // Half the edge length of a billboard.
+
+    // -----------------------------------------------------------------------------
+    // Billboards per frame in each phase of the run, like a camera turning from
+    // an empty part of the scene to the forest and back.
+    // -----------------------------------------------------------------------------
+    const int   s_Loads[]        = { 100, 400, 1000, 400, 100 };
+
+    // -----------------------------------------------------------------------------
+
+    struct SController
+    {
+        const char* m_pName;
+        float       m_Smoothing;
+        float       m_ProportionalGain;
+        float       m_IntegralGain;
+        float       m_DerivativeGain;
+    };
+
+    const SController s_Controllers[] =
+    {
+        { "Fixed"             , 1.0f , 0.0f, 0.0f , 0.0f  },            // Never changes the scale.
+        { "I, unsmoothed"     , 1.0f , 0.0f, 0.5f , 0.0f  },
+        { "PI, unsmoothed"    , 1.0f , 0.6f, 0.3f , 0.0f  },
+        { "PID, smoothed"     , 0.25f, 0.3f, 0.08f, 0.05f },            // The defaults of the controller.
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct SScene
+    {
+        COffscreenRenderer Renderer;
+        CCamera            Camera;
+        std::vector<float> Positions;                                   // Three floats per billboard.
+        int                Width;                                       // Current viewport of the renderer.
+        int                Height;
+    };
+
+    // -----------------------------------------------------------------------------
+    // Draws the first billboards of the scene into a viewport of the scaled
+    // size and returns the time in milliseconds.
+    // -----------------------------------------------------------------------------
+    double RenderFrame(SScene& _rScene, int _NumberOfBillboards, int _Width, int _Height)
+    {
+        const float TreeColor[4] = { 0.1f, 0.7f, 0.2f, 0.8f };
+        const float SkyColor [4] = { 0.4f, 0.6f, 0.9f, 1.0f };
+        const float Normal   [3] = { 0.0f, 0.0f, -1.0f };
+
+        int Indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+        CStopwatch Stopwatch;
+
+        if (_Width != _rScene.Width || _Height != _rScene.Height)
+        {
+            _rScene.Renderer.SetViewport(_Width, _Height);
+
+            _rScene.Width  = _Width;
+            _rScene.Height = _Height;
+        }
+
+        const float* pViewProjectionMatrix = _rScene.Camera.GetSnapshot().m_ViewProjectionMatrix;
+
+        _rScene.Renderer.BeginFrame(SkyColor);
+
+        for (int IndexOfBillboard = 0; IndexOfBillboard < _NumberOfBillboards; ++ IndexOfBillboard)
+        {
+            const float* pPosition = &_rScene.Positions[IndexOfBillboard * 3];
+
+            float Corners[4][3] =
+            {
+                { pPosition[0] - s_Size, pPosition[1] - s_Size, pPosition[2] },
+                { pPosition[0] + s_Size, pPosition[1] - s_Size, pPosition[2] },
+                { pPosition[0] + s_Size, pPosition[1] + s_Size, pPosition[2] },
+                { pPosition[0] - s_Size, pPosition[1] + s_Size, pPosition[2] },
+            };
+
+            _rScene.Renderer.DrawTriangles(&Corners[0][0], 3, Indices, 6, pViewProjectionMatrix, TreeColor, Normal);
+        }
+
+        _rScene.Renderer.EndFrame();
+
+        return Stopwatch.GetElapsedMilliseconds();
+    }
+
+    // -----------------------------------------------------------------------------
+    // Runs all phases with the controller deciding the scale of each frame.
+    // -----------------------------------------------------------------------------
+    void Run(SScene& _rScene, CDynamicResolution& _rController)
+    {
+        for (int Load : s_Loads)
+        {
+            for (int IndexOfFrame = 0; IndexOfFrame < s_FramesPerPhase; ++ IndexOfFrame)
+            {
+                int Width;
+                int Height;
+
+                _rController.GetScaledSize(s_Width, s_Height, Width, Height);
+
+                _rController.Update(RenderFrame(_rScene, Load, Width, Height));
+            }
+        }
+    }
+} // namespace
+
+void RunDynamicResolutionBenchmark()
+{
+    SScene Scene;
+
+    Scene.Width  = 0;
+    Scene.Height = 0;
+
+    Scene.Renderer.SetDepthRange(0.1f, 100.0f, SDepthMode::Standard);
+
+    Scene.Camera.SetPerspective(60.0f, static_cast<float>(s_Width) / static_cast<float>(s_Height), 0.1f, 100.0f);
+
+    float Eye[3] = { 0.0f, 0.0f, -8.0f };
+    float At [3] = { 0.0f, 0.0f,  0.0f };
+    float Up [3] = { 0.0f, 1.0f,  0.0f };
+
+    Scene.Camera.SetLookAt(Eye, At, Up);
+
+    // -----------------------------------------------------------------------------
+    // Billboards spread over the view, sorted back to front for blending.
+    // -----------------------------------------------------------------------------
+    unsigned int Random = 4711;
+
+    int MaximumLoad = 0;
+
+    for (int Load : s_Loads) MaximumLoad = Load > MaximumLoad ? Load : MaximumLoad;
+
+    for (int IndexOfBillboard = 0; IndexOfBillboard < MaximumLoad; ++ IndexOfBillboard)
+    {
+        float Values[3];
+
+        for (float& rValue : Values)
+        {
+            Random = Random * 1664525u + 1013904223u;
+
+            rValue = static_cast<float>(Random >> 8) / 16777216.0f;
+        }
+
+        float Depth = 10.0f - 9.0f * static_cast<float>(IndexOfBillboard) / MaximumLoad;
+
+        Scene.Positions.push_back((Values[0] * 2.0f - 1.0f) * Depth * 0.6f);
+        Scene.Positions.push_back((Values[1] * 2.0f - 1.0f) * Depth * 0.4f);
+        Scene.Positions.push_back(Depth - 8.0f + 0.5f * Values[2]);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The budget is the full resolution time of the middle load, so the high
+    // load needs a lower resolution and the low load fits at full resolution.
+    // -----------------------------------------------------------------------------
+    double Budget = 0.0;
+
+    for (int IndexOfRun = 0; IndexOfRun < 11; ++ IndexOfRun)
+    {
+        double Time = RenderFrame(Scene, s_Loads[1], s_Width, s_Height);
+
+        if (IndexOfRun > 0) Budget += Time / 10.0;
+    }
+
+    int NumberOfFrames = s_FramesPerPhase * static_cast<int>(sizeof(s_Loads) / sizeof(s_Loads[0]));
+
+    std::cout << std::endl;
+    std::cout << "Dynamic resolution (" << s_Width << " x " << s_Height << " pixels of software rendered billboards, " << NumberOfFrames << " frames with 100 to 1000 billboards, "
+              << std::fixed << std::setprecision(3) << Budget << " ms budget with 5% tolerance)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(18) << "Controller" << std::right << std::setw(10) << "Avg ms" << std::setw(10) << "Max ms" << std::setw(12) << "In budget %"
+              << std::setw(10) << "Avg scale" << std::setw(10) << "Min scale" << std::setw(10) << "Changes" << std::setw(10) << "Reversals" << std::endl;
+
+    for (const SController& rController : s_Controllers)
+    {
+        CDynamicResolution Controller;
+
+        SDynamicResolutionSettings Settings = Controller.GetSettings();
+
+        Settings.m_FrameTimeBudget  = static_cast<float>(Budget);
+        Settings.m_MinimumScale     = 0.25f;
+        Settings.m_Smoothing        = rController.m_Smoothing;
+        Settings.m_ProportionalGain = rController.m_ProportionalGain;
+        Settings.m_IntegralGain     = rController.m_IntegralGain;
+        Settings.m_DerivativeGain   = rController.m_DerivativeGain;
+
+        Controller.SetSettings(Settings);
+        Controller.ResetStatistics();
+
+        Run(Scene, Controller);
+
+        SDynamicResolutionStatistics Statistics;
+
+        Controller.GetStatistics(Statistics);
+
+        std::cout << std::left << std::setw(18) << rController.m_pName << std::right << std::setw(10) << Statistics.m_TotalFrameTime / Statistics.m_NumberOfFrames << std::setw(10) << Statistics.m_MaximumFrameTime
+                  << std::setw(12) << 100.0 * Statistics.m_NumberOfFramesInBudget / Statistics.m_NumberOfFrames << std::setw(10) << Statistics.m_TotalScale / Statistics.m_NumberOfFrames
+                  << std::setw(10) << Statistics.m_MinimumScale << std::setw(10) << Statistics.m_NumberOfScaleChanges << std::setw(10) << Statistics.m_NumberOfReversals << std::endl;
+    }
+}
@@ -0,0 +1,258 @@
+
+#include "benchmark.h"
+
+#include "fixed_step.h"
+#include "scene_store.h"
+#include "transform_hierarchy.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int    s_NumberOfRoots    = 200;
+    const int    s_NumberOfChildren = 20;                               // Children of each root.
+    const int    s_NumberOfEntities = 100000;
+    const double s_Duration         = 500.0;                            // Milliseconds each case runs.
+    const float  s_Speed            = 90.0f;                            // Degrees per second the roots rotate.
+
+    // -----------------------------------------------------------------------------
+    // The simulation: rotates all roots of the hierarchy by the time of the step.
+    // The state is the angle only, the hierarchy belongs to the simulation.
+    // -----------------------------------------------------------------------------
+    struct SSimulation
+    {
+        CTransformHierarchy m_Hierarchy;
+        std::vector<int>    m_Roots;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void Step(float& _rAngle, float _StepTime, void* _pUserData)
+    {
+        SSimulation& rSimulation = *static_cast<SSimulation*>(_pUserData);
+
+        _rAngle += s_Speed * _StepTime;
+
+        float Axis[3] = { 0.0f, 1.0f, 0.0f };
+        float Rotation[4];
+
+        GetRotationQuaternion(Axis, _rAngle, Rotation);
+
+        for (int IndexOfRoot : rSimulation.m_Roots) rSimulation.m_Hierarchy.SetLocalRotation(IndexOfRoot, Rotation);
+
+        rSimulation.m_Hierarchy.Update();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetViewProjectionMatrix(float* _pMatrix)
+    {
+        float Near = 0.1f;
+        float Far  = 1000.0f;
+
+        float Matrix[16] =
+        {
+            1.3f, 0.0f, 0.0f                      , 0.0f,
+            0.0f, 1.7f, 0.0f                      , 0.0f,
+            0.0f, 0.0f, Far / (Far - Near)        , 1.0f,
+            0.0f, 0.0f, -Near * Far / (Far - Near), 0.0f,
+        };
+
+        for (int Index = 0; Index < 16; ++ Index) _pMatrix[Index] = Matrix[Index];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, float _StepsPerSecond, double _Steps, double _Frames, double _Overlap, double _Angle)
+    {
+        std::cout << std::left << std::setw(28) << _pName << std::right << std::setw(10) << _StepsPerSecond << std::setw(12) << _Steps << std::setw(12) << _Frames << std::setw(12) << _Overlap << std::setw(12) << _Angle << std::endl;
+    }
+} // namespace
+
+void RunFixedStepBenchmark()
+{
+    SSimulation Simulation;
+
+    STransform Identity = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+
+    for (int IndexOfRoot = 0; IndexOfRoot < s_NumberOfRoots; ++ IndexOfRoot)
+    {
+        int IndexOfNode = Simulation.m_Hierarchy.AddNode(-1, Identity);
+
+        Simulation.m_Roots.push_back(IndexOfNode);
+
+        for (int IndexOfChild = 0; IndexOfChild < s_NumberOfChildren; ++ IndexOfChild) Simulation.m_Hierarchy.AddNode(IndexOfNode, Identity);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The render work of a frame: cull and sort the scene.
+    // -----------------------------------------------------------------------------
+    CSceneStore Scene;
+
+    unsigned int State = 4711;
+
+    for (int IndexOfEntity = 0; IndexOfEntity < s_NumberOfEntities; ++ IndexOfEntity)
+    {
+        float Position[3] =
+        {
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+        };
+
+        Scene.Create(nullptr, IndexOfEntity % 4, Position, 1.0f);
+    }
+
+    float ViewProjectionMatrix[16];
+    float EyePosition[3] = { 0.0f, 0.0f, 0.0f };
+
+    GetViewProjectionMatrix(ViewProjectionMatrix);
+
+    std::vector<int>        Visible;
+    std::vector<SSceneDraw> Draws;
+
+    auto Render = [&](float _Angle)
+    {
+        EyePosition[0] = _Angle * 1.0e-6f;
+
+        Scene.Cull(ViewProjectionMatrix, Visible);
+        Scene.Sort(Visible, EyePosition, SSortOrder::FrontToBack, Draws);
+    };
+
+    std::cout << std::endl;
+    std::cout << "Fixed step loop (" << s_NumberOfRoots * (s_NumberOfChildren + 1) << " nodes simulated, " << s_NumberOfEntities << " entities rendered, " << s_Duration << " ms per case)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(28) << "Case" << std::right << std::setw(10) << "Rate" << std::setw(12) << "Steps/s" << std::setw(12) << "Frames/s" << std::setw(12) << "Overlap %" << std::setw(12) << "Angle" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    // -----------------------------------------------------------------------------
+    // Coupled: one step with the time of the last frame, then the frame, in
+    // sequence on one thread. The steps per second are the frames per second.
+    // -----------------------------------------------------------------------------
+    {
+        float Angle = 0.0f;
+        int   NumberOfFrames = 0;
+
+        CStopwatch Stopwatch;
+
+        double LastTime = 0.0;
+
+        while (Stopwatch.GetElapsedMilliseconds() < s_Duration)
+        {
+            double Time = Stopwatch.GetElapsedMilliseconds();
+
+            Step(Angle, static_cast<float>((Time - LastTime) / 1000.0), &Simulation);
+
+            LastTime = Time;
+
+            Render(Angle);
+
+            NumberOfFrames += 1;
+        }
+
+        double Seconds = Stopwatch.GetElapsedMilliseconds() / 1000.0;
+
+        PrintRow("Coupled, variable step", 0.0f, NumberOfFrames / Seconds, NumberOfFrames / Seconds, 0.0, Angle);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Decoupled: the simulation runs at a fixed rate on its own thread, the
+    // frames blend the last two states as fast as they can.
+    // -----------------------------------------------------------------------------
+    const float StepRates[] = { 30.0f, 60.0f, 120.0f, 240.0f };
+
+    for (float StepsPerSecond : StepRates)
+    {
+        TFixedStepLoop<float> Loop;
+
+        Loop.Start(0.0f, StepsPerSecond, &Step, &Simulation);
+
+        float Angle = 0.0f;
+
+        CStopwatch Stopwatch;
+
+        while (Stopwatch.GetElapsedMilliseconds() < s_Duration)
+        {
+            float Previous;
+            float Current;
+
+            float Blend = Loop.BeginFrame(Previous, Current);
+
+            Angle = Previous + (Current - Previous) * Blend;
+
+            Render(Angle);
+
+            Loop.EndFrame();
+        }
+
+        Loop.Stop();
+
+        SFixedStepStatistics Statistics = Loop.GetStatistics();
+
+        double Seconds = Statistics.m_ElapsedTime / 1000.0;
+        double Overlap = Statistics.m_StepTime > 0.0 ? 100.0 * Statistics.m_OverlapTime / Statistics.m_StepTime : 0.0;
+
+        PrintRow("Decoupled, fixed step", StepsPerSecond, Statistics.m_NumberOfSteps / Seconds, Statistics.m_NumberOfFrames / Seconds, Overlap, Angle);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Frame rate independence: the same simulation with fast and with slow
+    // frames. The simulated angle only depends on the elapsed time, so both
+    // should be close to speed times duration, less the one step the blended
+    // state lags behind.
+    // -----------------------------------------------------------------------------
+    const int FrameTimes[] = { 0, 5, 33 };
+
+    for (int FrameTime : FrameTimes)
+    {
+        TFixedStepLoop<float> Loop;
+
+        Loop.Start(0.0f, 60.0f, &Step, &Simulation);
+
+        float Angle = 0.0f;
+
+        CStopwatch Stopwatch;
+
+        while (Stopwatch.GetElapsedMilliseconds() < s_Duration)
+        {
+            float Previous;
+            float Current;
+
+            float Blend = Loop.BeginFrame(Previous, Current);
+
+            Angle = Previous + (Current - Previous) * Blend;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(FrameTime));
+
+            Loop.EndFrame();
+        }
+
+        Loop.Stop();
+
+        SFixedStepStatistics Statistics = Loop.GetStatistics();
+
+        double Seconds = Statistics.m_ElapsedTime / 1000.0;
+
+        char Name[64];
+
+        snprintf(Name, sizeof(Name), "Independence, %d ms frames", FrameTime);
+
+        PrintRow(Name, 60.0f, Statistics.m_NumberOfSteps / Seconds, Statistics.m_NumberOfFrames / Seconds, 0.0, Angle);
+    }
+
+    std::cout << "Expected angle after " << s_Duration << " ms: " << s_Speed * s_Duration / 1000.0 << " degrees" << std::endl;
+}
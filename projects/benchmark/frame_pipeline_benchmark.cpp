@@ -0,0 +1,171 @@
+
+#include "benchmark.h"
+
+#include "frame_pipeline.h"
+#include "scene_store.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int    s_NumberOfEntities = 200000;
+    const int    s_NumberOfFrames   = 200;
+
+    // -----------------------------------------------------------------------------
+    // The frame data of one slot: the sorted draws of the frame.
+    // -----------------------------------------------------------------------------
+    struct SSlot
+    {
+        std::vector<int>        m_Visible;
+        std::vector<SSceneDraw> m_Draws;
+        int                     m_NumberOfDraws;
+    };
+
+    struct SScene
+    {
+        CSceneStore m_Store;
+        float       m_ViewProjectionMatrix[16];
+        float       m_EyePosition[3];
+        SSlot       m_Slots[CFramePipeline::s_MaximumNumberOfFramesInFlight];
+    };
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetViewProjectionMatrix(float* _pMatrix)
+    {
+        float Near = 0.1f;
+        float Far  = 1000.0f;
+
+        float Matrix[16] =
+        {
+            1.3f, 0.0f, 0.0f                      , 0.0f,
+            0.0f, 1.7f, 0.0f                      , 0.0f,
+            0.0f, 0.0f, Far / (Far - Near)        , 1.0f,
+            0.0f, 0.0f, -Near * Far / (Far - Near), 0.0f,
+        };
+
+        for (int Index = 0; Index < 16; ++ Index) _pMatrix[Index] = Matrix[Index];
+    }
+
+    // -----------------------------------------------------------------------------
+    // The CPU part of a frame: cull and sort the scene into the slot.
+    // -----------------------------------------------------------------------------
+    void BuildFrame(int _IndexOfSlot, void* _pUserData)
+    {
+        SScene& rScene = *static_cast<SScene*>(_pUserData);
+        SSlot&  rSlot  = rScene.m_Slots[_IndexOfSlot];
+
+        rSlot.m_NumberOfDraws = rScene.m_Store.Cull(rScene.m_ViewProjectionMatrix, rSlot.m_Visible.data());
+
+        rScene.m_Store.Sort(rSlot.m_Visible.data(), rSlot.m_NumberOfDraws, rScene.m_EyePosition, SSortOrder::FrontToBack, rSlot.m_Draws.data());
+    }
+
+    // -----------------------------------------------------------------------------
+    // Stands in for the submission and the rasterization of a frame. The GPU
+    // works beside the CPU, so the frame waits for it like 'Present' does.
+    // -----------------------------------------------------------------------------
+    int RenderFrame(const SSlot& _rSlot, double _RenderTime)
+    {
+        int Sum = 0;
+
+        for (int IndexOfDraw = 0; IndexOfDraw < _rSlot.m_NumberOfDraws; IndexOfDraw += 64) Sum += _rSlot.m_Draws[IndexOfDraw].m_IndexOfEntity;
+
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(_RenderTime * 1000.0)));
+
+        return Sum;
+    }
+} // namespace
+
+void RunFramePipelineBenchmark()
+{
+    SScene Scene;
+
+    unsigned int State = 4711;
+
+    for (int IndexOfEntity = 0; IndexOfEntity < s_NumberOfEntities; ++ IndexOfEntity)
+    {
+        float Position[3] =
+        {
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+            static_cast<float>(GetRandom(State) % 2000) * 0.1f - 100.0f,
+        };
+
+        Scene.m_Store.Create(nullptr, IndexOfEntity % 4, Position, 1.0f);
+    }
+
+    GetViewProjectionMatrix(Scene.m_ViewProjectionMatrix);
+
+    Scene.m_EyePosition[0] = 0.0f;
+    Scene.m_EyePosition[1] = 0.0f;
+    Scene.m_EyePosition[2] = 0.0f;
+
+    for (SSlot& rSlot : Scene.m_Slots)
+    {
+        rSlot.m_Visible.resize(s_NumberOfEntities);
+        rSlot.m_Draws  .resize(s_NumberOfEntities);
+
+        rSlot.m_NumberOfDraws = 0;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The render time is set to the build time, where pipelining gains most.
+    // -----------------------------------------------------------------------------
+    double BuildTime = MeasureMilliseconds(8, [&]() { BuildFrame(0, &Scene); });
+
+    std::cout << std::endl;
+    std::cout << "Frame pipeline (" << s_NumberOfEntities << " entities, " << s_NumberOfFrames << " frames, " << BuildTime << " ms build, " << BuildTime << " ms render)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(20) << "Frames in flight" << std::right << std::setw(12) << "Frames/s" << std::setw(12) << "Gain" << std::setw(14) << "Latency ms" << std::setw(16) << "Render wait ms" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    double SerialFramesPerSecond = 0.0;
+    int    Sum                   = 0;
+
+    for (int NumberOfFramesInFlight = 1; NumberOfFramesInFlight <= CFramePipeline::s_MaximumNumberOfFramesInFlight; ++ NumberOfFramesInFlight)
+    {
+        CFramePipeline Pipeline;
+
+        Pipeline.Start(NumberOfFramesInFlight, &BuildFrame, &Scene);
+
+        for (int IndexOfFrame = 0; IndexOfFrame < s_NumberOfFrames; ++ IndexOfFrame)
+        {
+            int IndexOfSlot = Pipeline.BeginFrame();
+
+            Sum += RenderFrame(Scene.m_Slots[IndexOfSlot], BuildTime);
+
+            Pipeline.EndFrame();
+        }
+
+        SFramePipelineStatistics Statistics = Pipeline.GetStatistics();
+
+        Pipeline.Stop();
+
+        double FramesPerSecond = 1000.0 * Statistics.m_NumberOfFrames / Statistics.m_ElapsedTime;
+
+        if (NumberOfFramesInFlight == 1) SerialFramesPerSecond = FramesPerSecond;
+
+        std::cout << std::left << std::setw(20) << NumberOfFramesInFlight << std::right << std::setw(12) << FramesPerSecond
+                  << std::setw(12) << FramesPerSecond / SerialFramesPerSecond
+                  << std::setw(14) << Statistics.m_Latency / Statistics.m_NumberOfFrames
+                  << std::setw(16) << Statistics.m_RenderWaitTime / Statistics.m_NumberOfFrames << std::endl;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Keeps the compiler from removing the loops.
+    // -----------------------------------------------------------------------------
+    if (Sum == 1) std::cout << Sum << std::endl;
+}
@@ -0,0 +1,144 @@
+
+#include "benchmark.h"
+
+#include "gbuffer_layout.h"
+
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct SLayout
+    {
+        const char*                m_pName;
+        SGBufferLayout::ELayout    m_Layout;
+        SNormalEncoding::EEncoding m_Encoding;
+    };
+
+    const SLayout s_Layouts[] =
+    {
+        { "standard xyz", SGBufferLayout::Standard, SNormalEncoding::Float3         },
+        { "compact RG16", SGBufferLayout::Compact , SNormalEncoding::OctahedralRG16 },
+        { "compact RG8" , SGBufferLayout::Compact , SNormalEncoding::OctahedralRG8  },
+    };
+
+    const int s_Resolutions[][2] =
+    {
+        {  800,  600 },
+        { 1920, 1080 },
+        { 3840, 2160 },
+    };
+
+    const int s_NumberOfNormals = 1 << 20;
+
+    // -----------------------------------------------------------------------------
+    // Evenly distributed unit vectors on a Fibonacci spiral.
+    // -----------------------------------------------------------------------------
+    void CreateNormals(std::vector<float>& _rNormals)
+    {
+        _rNormals.resize(s_NumberOfNormals * 3);
+
+        for (int IndexOfNormal = 0; IndexOfNormal < s_NumberOfNormals; ++ IndexOfNormal)
+        {
+            float Z     = 1.0f - 2.0f * (static_cast<float>(IndexOfNormal) + 0.5f) / static_cast<float>(s_NumberOfNormals);
+            float R     = sqrtf(1.0f - Z * Z);
+            float Angle = 2.39996323f * static_cast<float>(IndexOfNormal);
+
+            _rNormals[IndexOfNormal * 3 + 0] = R * cosf(Angle);
+            _rNormals[IndexOfNormal * 3 + 1] = R * sinf(Angle);
+            _rNormals[IndexOfNormal * 3 + 2] = Z;
+        }
+    }
+} // namespace
+
+void RunGBufferBenchmark()
+{
+    std::cout << std::endl;
+    std::cout << "GBuffer layouts (4 bytes depth, YoshiX color targets with four 8 bit channels)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left  << std::setw(16) << "Layout" << std::setw(12) << "Resolution"
+              << std::right << std::setw(10) << "Passes" << std::setw(12) << "Bytes/px" << std::setw(12) << "Alloc MB"
+              << std::setw(12) << "Fill MB" << std::setw(12) << "Post B/tap"
+              << std::endl;
+
+    for (const int* pResolution : s_Resolutions)
+    {
+        for (const SLayout& rLayout : s_Layouts)
+        {
+            SGBufferCost Cost;
+
+            GetGBufferCost(rLayout.m_Layout, rLayout.m_Encoding, pResolution[0], pResolution[1], Cost);
+
+            double Pixels = static_cast<double>(pResolution[0]) * pResolution[1];
+
+            std::cout << std::left  << std::setw(16) << rLayout.m_pName
+                      << std::setw(12) << (std::to_string(pResolution[0]) + "x" + std::to_string(pResolution[1]))
+                      << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(10) << Cost.m_NumberOfGeometryPasses
+                      << std::setw(12) << Cost.m_BytesPerPixel
+                      << std::setw(12) << Cost.m_Memory / (1024.0 * 1024.0)
+                      << std::setw(12) << Pixels * Cost.m_GeometryBytesPerPixel / (1024.0 * 1024.0)
+                      << std::setw(12) << Cost.m_PostBytesPerSample
+                      << std::endl;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Precision and speed of the normal encodings.
+    // -----------------------------------------------------------------------------
+    std::vector<float>        Normals;
+    std::vector<unsigned int> Packed(s_NumberOfNormals);
+
+    CreateNormals(Normals);
+
+    std::cout << std::endl;
+    std::cout << std::left  << std::setw(16) << "Encoding"
+              << std::right << std::setw(14) << "Max error deg" << std::setw(14) << "Avg error deg" << std::setw(12) << "Pack ns" << std::setw(12) << "Unpack ns"
+              << std::endl;
+
+    for (const SLayout& rLayout : s_Layouts)
+    {
+        double PackTime = MeasureMilliseconds(4, [&]()
+        {
+            for (int IndexOfNormal = 0; IndexOfNormal < s_NumberOfNormals; ++ IndexOfNormal)
+            {
+                Packed[IndexOfNormal] = PackNormal(&Normals[IndexOfNormal * 3], rLayout.m_Encoding);
+            }
+        });
+
+        double MaximumError = 0.0;
+        double TotalError   = 0.0;
+
+        double UnpackTime = MeasureMilliseconds(4, [&]()
+        {
+            MaximumError = 0.0;
+            TotalError   = 0.0;
+
+            for (int IndexOfNormal = 0; IndexOfNormal < s_NumberOfNormals; ++ IndexOfNormal)
+            {
+                float        Normal[3];
+                const float* pReference = &Normals[IndexOfNormal * 3];
+
+                UnpackNormal(Packed[IndexOfNormal], rLayout.m_Encoding, Normal);
+
+                double Cosine = Normal[0] * pReference[0] + Normal[1] * pReference[1] + Normal[2] * pReference[2];
+                double Error  = acos(Cosine > 1.0 ? 1.0 : Cosine) * 180.0 / 3.14159265358979;
+
+                MaximumError  = Error > MaximumError ? Error : MaximumError;
+                TotalError   += Error;
+            }
+        });
+
+        std::cout << std::left  << std::setw(16) << rLayout.m_pName
+                  << std::right << std::fixed << std::setprecision(4)
+                  << std::setw(14) << MaximumError
+                  << std::setw(14) << TotalError / s_NumberOfNormals
+                  << std::setprecision(2)
+                  << std::setw(12) << PackTime   * 1000000.0 / s_NumberOfNormals
+                  << std::setw(12) << UnpackTime * 1000000.0 / s_NumberOfNormals
+                  << std::endl;
+    }
+}
@@ -0,0 +1,107 @@
+
+#include "benchmark.h"
+
+#include "image_filter.h"
+
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // The resolutions of the color targets the filters are measured with.
+    // -----------------------------------------------------------------------------
+    struct SResolution
+    {
+        const char* m_pName;
+        int         m_Width;
+        int         m_Height;
+    };
+
+    const SResolution s_Resolutions[] =
+    {
+        { "640x480"  ,  640,  480 },
+        { "1280x720" , 1280,  720 },
+        { "1920x1080", 1920, 1080 },
+        { "3840x2160", 3840, 2160 },
+    };
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pFilter, const SResolution& _rResolution, double _Scalar, double _Simd, double _Threaded)
+    {
+        double Pixels = static_cast<double>(_rResolution.m_Width) * _rResolution.m_Height;
+
+        std::cout << std::left  << std::setw(16) << _pFilter
+                  << std::setw(12) << _rResolution.m_pName
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << _Scalar
+                  << std::setw(12) << _Simd
+                  << std::setw(12) << _Threaded
+                  << std::setw(12) << Pixels / (_Threaded * 1000.0)
+                  << std::endl;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Measures one filter single threaded without SIMD, single threaded with SIMD
+    // and with SIMD on all cores.
+    // -----------------------------------------------------------------------------
+    template<typename TFunction>
+    void MeasureFilter(const char* _pFilter, const SResolution& _rResolution, const TFunction& _rFunction)
+    {
+        int NumberOfRuns = _rResolution.m_Width >= 3840 ? 4 : 16;
+
+        filter::SetNumberOfThreads(1);
+        filter::SetSimdEnabled(false);
+
+        double Scalar = MeasureMilliseconds(NumberOfRuns, _rFunction);
+
+        filter::SetSimdEnabled(true);
+
+        double Simd = MeasureMilliseconds(NumberOfRuns, _rFunction);
+
+        filter::SetNumberOfThreads(0);
+
+        double Threaded = MeasureMilliseconds(NumberOfRuns, _rFunction);
+
+        PrintRow(_pFilter, _rResolution, Scalar, Simd, Threaded);
+    }
+} // namespace
+
+void RunImageFilterBenchmark()
+{
+    std::cout << std::endl;
+    std::cout << "Image filters (" << filter::GetNumberOfThreads() << " threads, AVX2 " << (filter::IsSimdSupported() ? "supported" : "not supported") << ")" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left  << std::setw(16) << "Filter" << std::setw(12) << "Resolution"
+              << std::right << std::setw(12) << "Scalar ms" << std::setw(12) << "SIMD ms" << std::setw(12) << "Threads ms" << std::setw(12) << "MPixel/s"
+              << std::endl;
+
+    for (const SResolution& rResolution : s_Resolutions)
+    {
+        filter::CImage Color    (rResolution.m_Width, rResolution.m_Height, 4);
+        filter::CImage Result   (rResolution.m_Width, rResolution.m_Height, 4);
+        filter::CImage Luminance(rResolution.m_Width, rResolution.m_Height, 1);
+
+        filter::SImage ColorView     = Color    .GetView();
+        filter::SImage ResultView    = Result   .GetView();
+        filter::SImage LuminanceView = Luminance.GetView();
+
+        for (unsigned int IndexOfFloat = 0; IndexOfFloat < static_cast<unsigned int>(rResolution.m_Width * rResolution.m_Height * 4); ++ IndexOfFloat)
+        {
+            ColorView.m_pPixels[IndexOfFloat] = static_cast<float>((IndexOfFloat * 7919u) % 1024u) / 512.0f;
+        }
+
+        MeasureFilter("Box blur r=8"  , rResolution, [&]() { filter::BoxBlur              (ColorView, ResultView, 8); });
+        MeasureFilter("Box blur r=32" , rResolution, [&]() { filter::BoxBlur              (ColorView, ResultView, 32); });
+        MeasureFilter("Gaussian s=4"  , rResolution, [&]() { filter::RecursiveGaussianBlur(ColorView, ResultView, 4.0f); });
+        MeasureFilter("Gaussian s=16" , rResolution, [&]() { filter::RecursiveGaussianBlur(ColorView, ResultView, 16.0f); });
+        MeasureFilter("Bloom"         , rResolution, [&]() { filter::Bloom                (ColorView, ResultView, 1.0f, 8.0f, 0.5f); });
+        MeasureFilter("Edge detection", rResolution, [&]() { filter::DetectEdges          (ColorView, LuminanceView); });
+        MeasureFilter("Tone mapping"  , rResolution, [&]() { filter::ToneMap              (ColorView, ResultView, 1.0f); });
+    }
+
+    filter::SetNumberOfThreads(0);
+    filter::SetSimdEnabled(true);
+}
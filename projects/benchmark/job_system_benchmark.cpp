@@ -0,0 +1,179 @@
+
+#include "benchmark.h"
+
+#include "job_system.h"
+#include "scene_store.h"
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int s_NumberOfEntities = 1000000;
+    const int s_NumberOfRoots    = 2000;
+    const int s_NumberOfChildren = 49;                                  // Children of each root.
+    const int s_NumberOfJobs     = 100000;                              // Empty jobs to measure the overhead.
+    const int s_NumberOfRuns     = 8;
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetViewProjectionMatrix(float* _pMatrix)
+    {
+        float Near = 0.1f;
+        float Far  = 1000.0f;
+
+        float Matrix[16] =
+        {
+            1.3f, 0.0f, 0.0f                      , 0.0f,
+            0.0f, 1.7f, 0.0f                      , 0.0f,
+            0.0f, 0.0f, Far / (Far - Near)        , 1.0f,
+            0.0f, 0.0f, -Near * Far / (Far - Near), 0.0f,
+        };
+
+        for (int Index = 0; Index < 16; ++ Index) _pMatrix[Index] = Matrix[Index];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, int _NumberOfThreads, double _Time, double _SerialTime, unsigned long long _NumberOfStolenJobs)
+    {
+        std::cout << std::left << std::setw(32) << _pName << std::right << std::setw(8) << _NumberOfThreads << std::setw(12) << _Time << std::setw(12) << _SerialTime / _Time << std::setw(14) << _NumberOfStolenJobs << std::endl;
+    }
+} // namespace
+
+void RunJobSystemBenchmark()
+{
+    int MaximumNumberOfThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    std::vector<int> ThreadCounts;
+
+    for (int Threads = 1; Threads < MaximumNumberOfThreads; Threads *= 2) ThreadCounts.push_back(Threads);
+
+    ThreadCounts.push_back(MaximumNumberOfThreads);
+
+    // -----------------------------------------------------------------------------
+    // The scene for the culling: entities spread randomly around the camera.
+    // -----------------------------------------------------------------------------
+    CSceneStore Scene;
+
+    Scene.Reserve(s_NumberOfEntities);
+
+    unsigned int State = 4711;
+
+    for (int IndexOfEntity = 0; IndexOfEntity < s_NumberOfEntities; ++ IndexOfEntity)
+    {
+        float Position[3] =
+        {
+            static_cast<float>(GetRandom(State) % 100000) / 50.0f - 1000.0f,
+            static_cast<float>(GetRandom(State) % 100000) / 50.0f - 1000.0f,
+            static_cast<float>(GetRandom(State) % 100000) / 50.0f - 1000.0f,
+        };
+
+        Scene.Create(nullptr, 0, Position, 1.0f);
+    }
+
+    float ViewProjectionMatrix[16];
+
+    GetViewProjectionMatrix(ViewProjectionMatrix);
+
+    std::vector<int> Visible(s_NumberOfEntities);
+
+    // -----------------------------------------------------------------------------
+    // The hierarchy for the transforms: many small trees of the same size.
+    // -----------------------------------------------------------------------------
+    CTransformHierarchy Hierarchy;
+
+    STransform Transform = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+
+    for (int IndexOfRoot = 0; IndexOfRoot < s_NumberOfRoots; ++ IndexOfRoot)
+    {
+        int Root = Hierarchy.AddNode(-1, Transform);
+
+        for (int IndexOfChild = 0; IndexOfChild < s_NumberOfChildren; ++ IndexOfChild) Hierarchy.AddNode(Root, Transform);
+    }
+
+    int NumberOfNodes = Hierarchy.GetNumberOfNodes();
+
+    std::cout << std::endl;
+    std::cout << "Job system (" << s_NumberOfEntities << " entities culled, " << NumberOfNodes << " nodes transformed, " << s_NumberOfJobs << " empty jobs)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(32) << "Workload" << std::right << std::setw(8) << "Threads" << std::setw(12) << "ms" << std::setw(12) << "Speedup" << std::setw(14) << "Stolen jobs" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    int    SerialNumberOfVisible = Scene.Cull(ViewProjectionMatrix, Visible.data());
+    double SerialCullTime        = MeasureMilliseconds(s_NumberOfRuns, [&]() { Scene.Cull(ViewProjectionMatrix, Visible.data()); });
+
+    PrintRow("Cull, serial", 1, SerialCullTime, SerialCullTime, 0);
+
+    double SerialTransformTime = 0.0;
+    double SerialJobTime       = 0.0;
+    bool   IsEqual             = true;
+
+    for (int Threads : ThreadCounts)
+    {
+        // -----------------------------------------------------------------------------
+        // The calling thread works as well, so one thread less is started.
+        // -----------------------------------------------------------------------------
+        CJobSystem JobSystem(Threads - 1);
+
+        int NumberOfVisible = 0;
+
+        double CullTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            NumberOfVisible = Scene.Cull(ViewProjectionMatrix, Visible.data(), JobSystem);
+        });
+
+        IsEqual = IsEqual && NumberOfVisible == SerialNumberOfVisible;
+
+        PrintRow("Cull, blocks as jobs", Threads, CullTime, SerialCullTime, JobSystem.GetStatistics().m_NumberOfStolenJobs);
+
+        SJobSystemStatistics Statistics = JobSystem.GetStatistics();
+
+        Hierarchy.SetJobSystem(&JobSystem);
+        Hierarchy.SetNumberOfThreads(0);
+
+        double TransformTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            for (int Node = 0; Node < NumberOfNodes; ++ Node) Hierarchy.SetLocalTransform(Node, Transform);
+
+            Hierarchy.Update();
+        });
+
+        if (Threads == 1) SerialTransformTime = TransformTime;
+
+        PrintRow("Transforms, subtrees as jobs", Threads, TransformTime, SerialTransformTime, JobSystem.GetStatistics().m_NumberOfStolenJobs - Statistics.m_NumberOfStolenJobs);
+
+        Statistics = JobSystem.GetStatistics();
+
+        // -----------------------------------------------------------------------------
+        // Empty jobs, one per index: the cost of splitting, pushing, and stealing.
+        // -----------------------------------------------------------------------------
+        std::vector<int> Values(s_NumberOfJobs, 0);
+
+        double JobTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            JobSystem.ParallelFor(s_NumberOfJobs, 1, [&](int _Index) { Values[_Index] += 1; });
+        });
+
+        if (Threads == 1) SerialJobTime = JobTime;
+
+        PrintRow("Empty jobs, ns per job", Threads, 1.0e6 * JobTime / s_NumberOfJobs, 1.0e6 * SerialJobTime / s_NumberOfJobs, JobSystem.GetStatistics().m_NumberOfStolenJobs - Statistics.m_NumberOfStolenJobs);
+    }
+
+    Hierarchy.SetJobSystem(nullptr);
+
+    std::cout << "Parallel culling " << (IsEqual ? "matches" : "DOES NOT match") << " the serial culling (" << SerialNumberOfVisible << " visible)" << std::endl;
+}
@@ -0,0 +1,214 @@
+
+#include "benchmark.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const char* const s_pPath               = "log_benchmark.txt";
+    const int         s_NumberOfMessages    = 16384;                    // Per thread, all threads together fit into the queue.
+    const int         s_MaximumThreads      = 4;
+
+    // -----------------------------------------------------------------------------
+    // The times of single calls in nanoseconds, each call is measured on its own,
+    // so the tail shows the calls which stall, e.g. when a flush hits the disk.
+    // The time includes the two reads of the clock.
+    // -----------------------------------------------------------------------------
+    struct SResult
+    {
+        std::vector<double> m_Times;
+        double              m_DrainTime;                                // Milliseconds until the last message is in the file.
+        unsigned long long  m_NumberOfDroppedMessages;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    typedef std::chrono::high_resolution_clock CClock;
+
+    double GetNanoseconds(CClock::time_point _Start, CClock::time_point _End)
+    {
+        return std::chrono::duration<double, std::nano>(_End - _Start).count();
+    }
+
+    // -----------------------------------------------------------------------------
+    // The message of a frame, similar to the statistics of the example.
+    // -----------------------------------------------------------------------------
+    template<typename TFunction>
+    void WriteMessages(std::vector<double>& _rTimes, int _IndexOfThread, const TFunction& _rWrite)
+    {
+        _rTimes.resize(s_NumberOfMessages);
+
+        for (int IndexOfMessage = 0; IndexOfMessage < s_NumberOfMessages; ++ IndexOfMessage)
+        {
+            double FrameTime = 16.6 + 0.001 * IndexOfMessage;
+
+            CClock::time_point Start = CClock::now();
+
+            _rWrite(IndexOfMessage, FrameTime, static_cast<unsigned>(_IndexOfThread * 100 + 42), _IndexOfThread % 2 == 0 ? "moving" : "still");
+
+            CClock::time_point End = CClock::now();
+
+            _rTimes[IndexOfMessage] = GetNanoseconds(Start, End);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The stream formats on the calling thread, with 'std::endl' it also writes
+    // and flushes each message.
+    // -----------------------------------------------------------------------------
+    SResult RunStream(bool _IsFlushing)
+    {
+        SResult Result;
+
+        std::ofstream Stream(s_pPath);
+
+        CClock::time_point Start = CClock::now();
+
+        WriteMessages(Result.m_Times, 0, [&] (int _Frame, double _FrameTime, unsigned _DrawCalls, const char* _pCamera)
+        {
+            Stream << "Frame " << _Frame << " took " << _FrameTime << " ms, " << _DrawCalls << " draw calls, camera " << _pCamera;
+
+            if (_IsFlushing)
+            {
+                Stream << std::endl;
+            }
+            else
+            {
+                Stream << '\n';
+            }
+        });
+
+        Stream.flush();
+
+        Result.m_DrainTime               = GetNanoseconds(Start, CClock::now()) / 1000000.0;
+        Result.m_NumberOfDroppedMessages = 0;
+
+        return Result;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The log copies the arguments into its queue, any number of threads write
+    // at the same time.
+    // -----------------------------------------------------------------------------
+    SResult RunLog(int _NumberOfThreads)
+    {
+        SResult Result;
+
+        std::ofstream Stream(s_pPath);
+
+        CLog Log(Stream, s_NumberOfMessages * s_MaximumThreads);
+
+        std::vector<std::vector<double>> Times(_NumberOfThreads);
+        std::vector<std::thread>         Threads;
+
+        CClock::time_point Start = CClock::now();
+
+        for (int IndexOfThread = 0; IndexOfThread < _NumberOfThreads; ++ IndexOfThread)
+        {
+            Threads.emplace_back([&, IndexOfThread]
+            {
+                WriteMessages(Times[IndexOfThread], IndexOfThread, [&] (int _Frame, double _FrameTime, unsigned _DrawCalls, const char* _pCamera)
+                {
+                    Log.Write("Frame {} took {} ms, {} draw calls, camera {}", _Frame, _FrameTime, _DrawCalls, _pCamera);
+                });
+            });
+        }
+
+        for (std::thread& rThread : Threads) rThread.join();
+
+        Log.Flush();
+
+        Result.m_DrainTime = GetNanoseconds(Start, CClock::now()) / 1000000.0;
+
+        for (const std::vector<double>& rTimes : Times) Result.m_Times.insert(Result.m_Times.end(), rTimes.begin(), rTimes.end());
+
+        SLogStatistics Statistics;
+
+        Log.GetStatistics(Statistics);
+
+        Result.m_NumberOfDroppedMessages = Statistics.m_NumberOfDroppedMessages;
+
+        return Result;
+    }
+
+    // -----------------------------------------------------------------------------
+    // A category which is filtered at compile time, the call is not there at all.
+    // -----------------------------------------------------------------------------
+    SResult RunDisabled()
+    {
+        SResult Result;
+
+        CClock::time_point Start = CClock::now();
+
+        WriteMessages(Result.m_Times, 0, [&] (int _Frame, double _FrameTime, unsigned _DrawCalls, const char* _pCamera)
+        {
+            LOG(Benchmark, Debug, "Frame {} took {} ms, {} draw calls, camera {}", _Frame, _FrameTime, _DrawCalls, _pCamera);
+        });
+
+        Result.m_DrainTime               = GetNanoseconds(Start, CClock::now()) / 1000000.0;
+        Result.m_NumberOfDroppedMessages = 0;
+
+        return Result;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintResult(const char* _pName, int _NumberOfThreads, SResult& _rResult)
+    {
+        std::vector<double>& rTimes = _rResult.m_Times;
+
+        std::sort(rTimes.begin(), rTimes.end());
+
+        double Total = 0.0;
+
+        for (double Time : rTimes) Total += Time;
+
+        size_t NumberOfTimes = rTimes.size();
+
+        std::cout << std::left << std::setw(22) << _pName << std::right << std::setw(8) << _NumberOfThreads
+                  << std::setw(10) << Total / NumberOfTimes << std::setw(10) << rTimes[NumberOfTimes / 2]
+                  << std::setw(10) << rTimes[NumberOfTimes * 999 / 1000] << std::setw(10) << rTimes[NumberOfTimes - 1] / 1000.0
+                  << std::setw(10) << _rResult.m_DrainTime << std::setw(10) << _rResult.m_NumberOfDroppedMessages << std::endl;
+    }
+} // namespace
+
+void RunLogBenchmark()
+{
+    std::cout << std::endl;
+    std::cout << "Logging (" << s_NumberOfMessages << " messages with 4 arguments per thread into a file, times per call including the clock)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(22) << "Method" << std::right << std::setw(8) << "Threads" << std::setw(10) << "Avg ns" << std::setw(10) << "Median ns"
+              << std::setw(10) << "99.9% ns" << std::setw(10) << "Max us" << std::setw(10) << "Total ms" << std::setw(10) << "Dropped" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    SResult Result = RunStream(true);
+
+    PrintResult("Stream, std::endl", 1, Result);
+
+    Result = RunStream(false);
+
+    PrintResult("Stream, '\\n'", 1, Result);
+
+    for (int NumberOfThreads = 1; NumberOfThreads <= s_MaximumThreads; NumberOfThreads *= 2)
+    {
+        Result = RunLog(NumberOfThreads);
+
+        PrintResult("Async log", NumberOfThreads, Result);
+    }
+
+    Result = RunDisabled();
+
+    PrintResult("Disabled category", 1, Result);
+
+    remove(s_pPath);
+}
@@ -0,0 +1,214 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "benchmark.h"
+
+#include "mesh_importer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int s_GridSize     = 1025;                                    // Vertices per side, about two million triangles.
+    const int s_NumberOfRuns = 2;
+
+    const char* s_pObjPath   = "benchmark_mesh.obj";
+    const char* s_pGlbPath   = "benchmark_mesh.glb";
+
+    // -----------------------------------------------------------------------------
+
+    float GetHeight(int _X, int _Y)
+    {
+        return static_cast<float>((_X * 7 + _Y * 13) % 17) * 0.05f;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The OBJ file uses shared position, texture coordinate, and normal indices
+    // like most exporters, so every corner has to be deduplicated.
+    // -----------------------------------------------------------------------------
+    void WriteObj()
+    {
+        FILE* pFile = fopen(s_pObjPath, "w");
+
+        if (pFile == nullptr) return;
+
+        fprintf(pFile, "usemtl ground\n");
+
+        for (int Y = 0; Y < s_GridSize; ++ Y)
+        {
+            for (int X = 0; X < s_GridSize; ++ X)
+            {
+                fprintf(pFile, "v %f %f %f\n", static_cast<float>(X), GetHeight(X, Y), static_cast<float>(Y));
+                fprintf(pFile, "vt %f %f\n", static_cast<float>(X) / (s_GridSize - 1), static_cast<float>(Y) / (s_GridSize - 1));
+                fprintf(pFile, "vn 0.000000 1.000000 0.000000\n");
+            }
+        }
+
+        for (int Y = 0; Y + 1 < s_GridSize; ++ Y)
+        {
+            for (int X = 0; X + 1 < s_GridSize; ++ X)
+            {
+                int A = Y * s_GridSize + X + 1;
+                int B = A + 1;
+                int C = A + s_GridSize + 1;
+                int D = A + s_GridSize;
+
+                fprintf(pFile, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", A, A, A, B, B, B, C, C, C, D, D, D);
+            }
+        }
+
+        fclose(pFile);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The same grid as binary glTF with one buffer holding positions, normals,
+    // texture coordinates, and 32 bit indices.
+    // -----------------------------------------------------------------------------
+    void WriteGlb()
+    {
+        int NumberOfVertices = s_GridSize * s_GridSize;
+        int NumberOfIndices  = (s_GridSize - 1) * (s_GridSize - 1) * 6;
+
+        std::vector<float>        Positions;
+        std::vector<float>        Normals;
+        std::vector<float>        TexCoords;
+        std::vector<unsigned int> Indices;
+
+        Positions.reserve(NumberOfVertices * 3);
+        Normals  .reserve(NumberOfVertices * 3);
+        TexCoords.reserve(NumberOfVertices * 2);
+        Indices  .reserve(NumberOfIndices);
+
+        for (int Y = 0; Y < s_GridSize; ++ Y)
+        {
+            for (int X = 0; X < s_GridSize; ++ X)
+            {
+                Positions.push_back(static_cast<float>(X));
+                Positions.push_back(GetHeight(X, Y));
+                Positions.push_back(static_cast<float>(Y));
+
+                Normals.push_back(0.0f);
+                Normals.push_back(1.0f);
+                Normals.push_back(0.0f);
+
+                TexCoords.push_back(static_cast<float>(X) / (s_GridSize - 1));
+                TexCoords.push_back(static_cast<float>(Y) / (s_GridSize - 1));
+            }
+        }
+
+        for (int Y = 0; Y + 1 < s_GridSize; ++ Y)
+        {
+            for (int X = 0; X + 1 < s_GridSize; ++ X)
+            {
+                unsigned int A = Y * s_GridSize + X;
+                unsigned int B = A + 1;
+                unsigned int C = A + s_GridSize + 1;
+                unsigned int D = A + s_GridSize;
+
+                unsigned int Quad[6] = { A, B, C, A, C, D };
+
+                Indices.insert(Indices.end(), Quad, Quad + 6);
+            }
+        }
+
+        size_t PositionsSize = Positions.size() * sizeof(float);
+        size_t NormalsSize   = Normals  .size() * sizeof(float);
+        size_t TexCoordsSize = TexCoords.size() * sizeof(float);
+        size_t IndicesSize   = Indices  .size() * sizeof(unsigned int);
+        size_t BinarySize    = PositionsSize + NormalsSize + TexCoordsSize + IndicesSize;
+
+        char Json[2048];
+
+        snprintf(Json, sizeof(Json),
+            "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":%zu}],"
+            "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},"
+            "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],"
+            "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%d,\"type\":\"VEC3\"},{\"bufferView\":1,\"componentType\":5126,\"count\":%d,\"type\":\"VEC3\"},"
+            "{\"bufferView\":2,\"componentType\":5126,\"count\":%d,\"type\":\"VEC2\"},{\"bufferView\":3,\"componentType\":5125,\"count\":%d,\"type\":\"SCALAR\"}],"
+            "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}]}",
+            BinarySize, PositionsSize, PositionsSize, NormalsSize, PositionsSize + NormalsSize, TexCoordsSize, PositionsSize + NormalsSize + TexCoordsSize, IndicesSize,
+            NumberOfVertices, NumberOfVertices, NumberOfVertices, NumberOfIndices);
+
+        std::string JsonChunk(Json);
+
+        while (JsonChunk.size() % 4 != 0) JsonChunk += ' ';
+
+        unsigned int Header     [3] = { 0x46546C67, 2, static_cast<unsigned int>(12 + 8 + JsonChunk.size() + 8 + BinarySize) };
+        unsigned int JsonHeader [2] = { static_cast<unsigned int>(JsonChunk.size()), 0x4E4F534A };
+        unsigned int BinaryHeader[2] = { static_cast<unsigned int>(BinarySize), 0x004E4942 };
+
+        FILE* pFile = fopen(s_pGlbPath, "wb");
+
+        if (pFile == nullptr) return;
+
+        fwrite(Header      , sizeof(Header)      , 1, pFile);
+        fwrite(JsonHeader  , sizeof(JsonHeader)  , 1, pFile);
+        fwrite(JsonChunk.data(), 1, JsonChunk.size(), pFile);
+        fwrite(BinaryHeader, sizeof(BinaryHeader), 1, pFile);
+        fwrite(Positions.data(), 1, PositionsSize, pFile);
+        fwrite(Normals  .data(), 1, NormalsSize  , pFile);
+        fwrite(TexCoords.data(), 1, TexCoordsSize, pFile);
+        fwrite(Indices  .data(), 1, IndicesSize  , pFile);
+
+        fclose(pFile);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, const char* _pPath, int _NumberOfThreads, SVertexLayout::ELayout _Layout)
+    {
+        SetNumberOfImportThreads(_NumberOfThreads);
+
+        SImportedMesh Mesh;
+
+        bool IsImported = false;
+
+        double Time = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            IsImported = ImportMesh(_pPath, Mesh, _Layout);
+        });
+
+        if (IsImported == false)
+        {
+            std::cout << std::left << std::setw(36) << _pName << "import failed" << std::endl;
+
+            return;
+        }
+
+        double Megabytes = static_cast<double>(Mesh.m_NumberOfBytes) / (1024.0 * 1024.0);
+        double Triangles = static_cast<double>(Mesh.m_Indices.size() / 3) / 1.0e6;
+
+        std::cout << std::left << std::setw(36) << _pName << std::right << std::setw(8) << _NumberOfThreads << std::setw(12) << Time << std::setw(12) << Megabytes / Time * 1000.0 << std::setw(12) << Triangles / Time * 1000.0 << std::endl;
+    }
+} // namespace
+
+void RunMeshImporterBenchmark()
+{
+    WriteObj();
+    WriteGlb();
+
+    int NumberOfThreads = GetNumberOfImportThreads();
+
+    std::cout << std::endl;
+    std::cout << "Mesh importer (" << 2 * (s_GridSize - 1) * (s_GridSize - 1) << " triangles)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(36) << "File" << std::right << std::setw(8) << "Threads" << std::setw(12) << "ms" << std::setw(12) << "MB/s" << std::setw(12) << "MTris/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    PrintRow("OBJ"                 , s_pObjPath, 1              , SVertexLayout::PositionNormalTexCoord);
+    PrintRow("OBJ"                 , s_pObjPath, NumberOfThreads, SVertexLayout::PositionNormalTexCoord);
+    PrintRow("OBJ with tangents"   , s_pObjPath, 1              , SVertexLayout::NormalMapping);
+    PrintRow("OBJ with tangents"   , s_pObjPath, NumberOfThreads, SVertexLayout::NormalMapping);
+    PrintRow("GLB"                 , s_pGlbPath, 1              , SVertexLayout::PositionNormalTexCoord);
+    PrintRow("GLB"                 , s_pGlbPath, NumberOfThreads, SVertexLayout::PositionNormalTexCoord);
+    PrintRow("GLB with tangents"   , s_pGlbPath, NumberOfThreads, SVertexLayout::NormalMapping);
+
+    SetNumberOfImportThreads(0);
+
+    remove(s_pObjPath);
+    remove(s_pGlbPath);
+}
@@ -0,0 +1,193 @@
+
+#include "benchmark.h"
+
+#include "camera.h"
+#include "depth_rasterizer.h"
+#include "meshlet.h"
+
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+namespace
+{
+    const int   s_Width        = 1280;
+    const int   s_Height       = 720;
+    const float s_Radius       = 10.0f;
+    const int   s_NumberOfRuns = 8;
+
+    // -----------------------------------------------------------------------------
+    // A sphere of positions around the origin with the given number of segments
+    // around and from pole to pole, front faces counter-clockwise from outside.
+    // -----------------------------------------------------------------------------
+    void GetSphere(int _NumberOfSegments, int _NumberOfRings, std::vector<float>& _rVertices, std::vector<int>& _rIndices)
+    {
+        _rVertices.clear();
+        _rIndices .clear();
+
+        for (int Ring = 0; Ring <= _NumberOfRings; ++ Ring)
+        {
+            float Theta = 3.14159265f * Ring / _NumberOfRings;
+
+            for (int Segment = 0; Segment <= _NumberOfSegments; ++ Segment)
+            {
+                float Phi = 2.0f * 3.14159265f * Segment / _NumberOfSegments;
+
+                _rVertices.push_back(s_Radius * sinf(Theta) * cosf(Phi));
+                _rVertices.push_back(s_Radius * cosf(Theta));
+                _rVertices.push_back(s_Radius * sinf(Theta) * sinf(Phi));
+            }
+        }
+
+        for (int Ring = 0; Ring < _NumberOfRings; ++ Ring)
+        {
+            for (int Segment = 0; Segment < _NumberOfSegments; ++ Segment)
+            {
+                int A = Ring * (_NumberOfSegments + 1) + Segment;
+                int B = A + _NumberOfSegments + 1;
+
+                int Quad[6] = { A, A + 1, B + 1, A, B + 1, B };
+
+                _rIndices.insert(_rIndices.end(), Quad, Quad + 6);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // A camera looking along z with the sphere in the lower left corner of the
+    // view, so a part of it is outside of the frustum and the back is hidden.
+    // -----------------------------------------------------------------------------
+    void GetViewProjectionMatrix(const float* _pEyePosition, float* _pMatrix)
+    {
+        float Near   = 0.1f;
+        float Far    = 100.0f;
+        float YScale = 1.0f / tanf(0.5f * 60.0f * 3.14159265f / 180.0f);
+        float XScale = YScale / (static_cast<float>(s_Width) / static_cast<float>(s_Height));
+
+        float Matrix[16] =
+        {
+            XScale                  , 0.0f                    , 0.0f                                                  , 0.0f,
+            0.0f                    , YScale                  , 0.0f                                                  , 0.0f,
+            0.0f                    , 0.0f                    , Far / (Far - Near)                                    , 1.0f,
+            -_pEyePosition[0] * XScale, -_pEyePosition[1] * YScale, -_pEyePosition[2] * Far / (Far - Near) - Near * Far / (Far - Near), -_pEyePosition[2],
+        };
+
+        for (int Index = 0; Index < 16; ++ Index) _pMatrix[Index] = Matrix[Index];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void RunMesh(int _NumberOfSegments, int _NumberOfRings)
+    {
+        std::vector<float> Vertices;
+        std::vector<int>   Indices;
+
+        GetSphere(_NumberOfSegments, _NumberOfRings, Vertices, Indices);
+
+        int NumberOfVertices = static_cast<int>(Vertices.size()) / 3;
+        int NumberOfIndices  = static_cast<int>(Indices.size());
+
+        CMeshletMesh Mesh;
+
+        double BuildTime = MeasureMilliseconds(2, [&]()
+        {
+            Mesh.Build(Vertices.data(), 3, NumberOfVertices, Indices.data(), NumberOfIndices);
+        });
+
+        float EyePosition[3] = { 10.0f, 4.0f, -21.0f };
+
+        float ViewProjectionMatrix[16];
+        float FrustumPlanes[6][4];
+
+        GetViewProjectionMatrix(EyePosition, ViewProjectionMatrix);
+        GetFrustumPlanes(ViewProjectionMatrix, FrustumPlanes);
+
+        std::vector<int> Visible(Mesh.GetNumberOfMeshlets());
+        std::vector<int> VisibleIndices(NumberOfIndices);
+
+        SMeshletStatistics Statistics = {};
+
+        int NumberOfVisible        = 0;
+        int NumberOfVisibleIndices = 0;
+
+        double CullTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            NumberOfVisible        = Mesh.Cull(FrustumPlanes, EyePosition, Visible.data(), nullptr);
+            NumberOfVisibleIndices = Mesh.GetIndices(Visible.data(), NumberOfVisible, VisibleIndices.data());
+        });
+
+        Mesh.Cull(FrustumPlanes, EyePosition, Visible.data(), &Statistics);
+
+        // -----------------------------------------------------------------------------
+        // The whole mesh and the triangles of the visible meshlets drawn into the
+        // software depth buffer, which rasterizes both faces of a triangle.
+        // -----------------------------------------------------------------------------
+        CDepthRasterizer Rasterizer;
+
+        Rasterizer.SetViewport(s_Width, s_Height);
+        Rasterizer.SetDepthRange(0.1f, 100.0f, SDepthMode::Standard);
+
+        SRasterState State = { gfx::SDepthTest::Lesser, false, nullptr, nullptr };
+
+        double FullDrawTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            Rasterizer.BeginFrame();
+            Rasterizer.DrawTriangles(Vertices.data(), 3, Indices.data(), NumberOfIndices, ViewProjectionMatrix, State);
+        });
+
+        double CulledDrawTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            NumberOfVisible        = Mesh.Cull(FrustumPlanes, EyePosition, Visible.data(), nullptr);
+            NumberOfVisibleIndices = Mesh.GetIndices(Visible.data(), NumberOfVisible, VisibleIndices.data());
+
+            Rasterizer.BeginFrame();
+            Rasterizer.DrawTriangles(Vertices.data(), 3, VisibleIndices.data(), NumberOfVisibleIndices, ViewProjectionMatrix, State);
+        });
+
+        int NumberOfTriangles = NumberOfIndices / 3;
+
+        size_t LongIndexMemory  = static_cast<size_t>(NumberOfIndices) * sizeof(int);
+        size_t ShortIndexMemory = static_cast<size_t>(NumberOfIndices) * sizeof(unsigned short);
+
+        std::cout << std::endl;
+        std::cout << "Sphere with " << NumberOfTriangles << " triangles and " << NumberOfVertices << " vertices: " << Mesh.GetNumberOfMeshlets() << " meshlets, "
+                  << std::setprecision(1) << static_cast<double>(NumberOfTriangles) / Mesh.GetNumberOfMeshlets() << " triangles per meshlet, built in "
+                  << std::setprecision(2) << BuildTime << " ms" << std::endl;
+        std::cout << std::endl;
+
+        std::cout << std::left << std::setw(40) << "Index memory" << std::right << std::setw(14) << "KB" << std::setw(12) << "Saved" << std::endl;
+        std::cout << std::left << std::setw(40) << "32 bit index list" << std::right << std::setw(14) << LongIndexMemory / 1024.0 << std::setw(12) << "" << std::endl;
+
+        if (Mesh.HasShortIndices())
+        {
+            std::cout << std::left << std::setw(40) << "16 bit index list" << std::right << std::setw(14) << ShortIndexMemory / 1024.0 << std::setw(11) << 100.0 * (1.0 - static_cast<double>(ShortIndexMemory) / LongIndexMemory) << "%" << std::endl;
+        }
+
+        std::cout << std::left << std::setw(40) << (Mesh.HasShortIndices() ? "Meshlets, 16 bit vertex references" : "Meshlets, 32 bit vertex references") << std::right << std::setw(14) << Mesh.GetIndexMemory() / 1024.0
+                  << std::setw(11) << 100.0 * (1.0 - static_cast<double>(Mesh.GetIndexMemory()) / LongIndexMemory) << "%" << std::endl;
+        std::cout << std::endl;
+
+        std::cout << std::left << std::setw(40) << "Culling" << std::right << std::setw(14) << "Meshlets" << std::setw(12) << "Triangles" << std::endl;
+        std::cout << std::left << std::setw(40) << "Outside of the frustum" << std::right << std::setw(14) << Statistics.m_NumberOfFrustumCulledMeshlets << std::setw(12) << Statistics.m_NumberOfFrustumRejectedTriangles << std::endl;
+        std::cout << std::left << std::setw(40) << "Facing away (normal cone)" << std::right << std::setw(14) << Statistics.m_NumberOfConeCulledMeshlets << std::setw(12) << Statistics.m_NumberOfConeRejectedTriangles << std::endl;
+        std::cout << std::left << std::setw(40) << "Drawn" << std::right << std::setw(14) << NumberOfVisible << std::setw(12) << NumberOfVisibleIndices / 3 << std::endl;
+        std::cout << std::endl;
+
+        std::cout << std::left << std::setw(40) << "Time" << std::right << std::setw(14) << "ms" << std::endl;
+        std::cout << std::left << std::setw(40) << "Cull and write the indices" << std::right << std::setw(14) << CullTime << std::endl;
+        std::cout << std::left << std::setw(40) << "Rasterize the whole mesh" << std::right << std::setw(14) << FullDrawTime << std::endl;
+        std::cout << std::left << std::setw(40) << "Cull and rasterize the visible meshlets" << std::right << std::setw(14) << CulledDrawTime << std::endl;
+    }
+} // namespace
+
+void RunMeshletBenchmark()
+{
+    std::cout << std::endl;
+    std::cout << "Meshlets (up to " << CMeshletMesh::s_MaximumNumberOfVertices << " vertices and " << CMeshletMesh::s_MaximumNumberOfTriangles << " triangles, "
+              << s_Width << "x" << s_Height << " software depth buffer)" << std::endl;
+    std::cout << std::fixed;
+
+    RunMesh(256, 128);
+    RunMesh(1024, 512);
+}
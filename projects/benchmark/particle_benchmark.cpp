@@ -0,0 +1,156 @@
+#include "benchmark.h"
+
+#include "camera.h"
+#include "job_system.h"
+#include "particle_system.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int   s_NumberOfParticles = 1000000;
+    const float s_StepTime          = 1.0f / 60.0f;
+    const int   s_NumberOfRuns      = 8;
+
+    // -----------------------------------------------------------------------------
+
+    struct SResult
+    {
+        double m_UpdateTime;
+        double m_SortTime;
+        double m_ExpandTime;
+        double m_YawExpandTime;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, int _NumberOfThreads, const SResult& _rResult)
+    {
+        double FrameTime = _rResult.m_UpdateTime + _rResult.m_SortTime + _rResult.m_ExpandTime;
+
+        std::cout << std::left << std::setw(24) << _pName << std::right << std::setw(8) << _NumberOfThreads << std::setw(10) << _rResult.m_UpdateTime << std::setw(10) << _rResult.m_SortTime
+                  << std::setw(10) << _rResult.m_ExpandTime << std::setw(12) << _rResult.m_YawExpandTime << std::setw(10) << FrameTime << std::setw(14) << s_NumberOfParticles / (FrameTime * 1000.0) << std::endl;
+    }
+} // namespace
+
+void RunParticleBenchmark()
+{
+    int MaximumNumberOfThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    // -----------------------------------------------------------------------------
+    // A fountain in front of the camera. It is filled in one long step, then it
+    // emits as many particles per second as die, so it stays at about one
+    // million particles.
+    // -----------------------------------------------------------------------------
+    SParticleEmitterSettings Settings = { { 0.0f, 0.0f, 0.0f }, 0.5f, { 0.0f, 8.0f, 0.0f }, 3.0f, 9.81f, 2.0f, 4.0f, 0.02f, 0.1f, 0.0f, SParticleFacing::Camera };
+
+    CParticleEmitter Emitter;
+
+    Settings.m_EmissionRate = static_cast<float>(s_NumberOfParticles);
+
+    Emitter.SetMaximumNumberOfParticles(s_NumberOfParticles);
+    Emitter.SetSettings(Settings);
+    Emitter.Update(1.0f);
+
+    Settings.m_EmissionRate = static_cast<float>(s_NumberOfParticles) / (0.5f * (Settings.m_MinimumLifetime + Settings.m_MaximumLifetime));
+
+    Emitter.SetSettings(Settings);
+
+    CCamera Camera;
+
+    float Eye[3] = { 0.0f,  2.0f, -12.0f };
+    float At [3] = { 0.0f,  2.0f,   0.0f };
+    float Up [3] = { 0.0f,  1.0f,   0.0f };
+
+    Camera.SetPerspective(60.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    Camera.SetLookAt(Eye, At, Up);
+
+    const SCameraSnapshot& rCamera = Camera.GetSnapshot();
+
+    std::cout << std::endl;
+    std::cout << "Particles (" << Emitter.GetNumberOfParticles() << " particles, SoA update, radix sort back to front, quads of " << 4 * CParticleEmitter::s_NumberOfFloatsPerVertex * sizeof(float) << " bytes)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(24) << "Submission" << std::right << std::setw(8) << "Threads" << std::setw(10) << "Update" << std::setw(10) << "Sort" << std::setw(10) << "Expand"
+              << std::setw(12) << "Yaw expand" << std::setw(10) << "Frame" << std::setw(14) << "M particles/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    // -----------------------------------------------------------------------------
+    // The frame time is update, sort, and expansion facing the camera. The
+    // expansion turned around y only costs a square root per particle more.
+    // -----------------------------------------------------------------------------
+    SResult Serial;
+
+    Serial.m_UpdateTime = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Update(s_StepTime); });
+    Serial.m_SortTime   = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Sort(rCamera); });
+    Serial.m_ExpandTime = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Expand(rCamera); });
+
+    Settings.m_Facing = SParticleFacing::Yaw;
+
+    Emitter.SetSettings(Settings);
+
+    Serial.m_YawExpandTime = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Expand(rCamera); });
+
+    PrintRow("Serial", 1, Serial);
+
+    int Threads = 1;
+
+    while (true)
+    {
+        // The calling thread works as well, so one thread less is started
+        CJobSystem JobSystem(Threads - 1);
+
+        SResult Result;
+
+        Settings.m_Facing = SParticleFacing::Camera;
+
+        Emitter.SetSettings(Settings);
+
+        Result.m_UpdateTime = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Update(s_StepTime, JobSystem); });
+        Result.m_SortTime   = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Sort(rCamera, JobSystem); });
+        Result.m_ExpandTime = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Expand(rCamera, JobSystem); });
+
+        Settings.m_Facing = SParticleFacing::Yaw;
+
+        Emitter.SetSettings(Settings);
+
+        Result.m_YawExpandTime = MeasureMilliseconds(s_NumberOfRuns, [&]() { Emitter.Expand(rCamera, JobSystem); });
+
+        PrintRow("Blocks as jobs", Threads, Result);
+
+        if (Threads == MaximumNumberOfThreads) break;
+
+        Threads = std::min(Threads * 2, MaximumNumberOfThreads);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The depth of the quad centers along the view direction has to fall.
+    // -----------------------------------------------------------------------------
+    gfx::SMeshInfo MeshInfo;
+
+    Emitter.GetMeshInfo(nullptr, MeshInfo);
+
+    const float* pForward = &rCamera.m_InverseViewMatrix[8];
+
+    float LastDepth = 3.402823466e+38f;
+    bool  IsInOrder = true;
+
+    for (int IndexOfQuad = 0; IndexOfQuad < MeshInfo.m_NumberOfVertices / 4; ++ IndexOfQuad)
+    {
+        const float* pFirst = MeshInfo.m_pVertices + IndexOfQuad * 4 * CParticleEmitter::s_NumberOfFloatsPerVertex;
+        const float* pThird = pFirst + 2 * CParticleEmitter::s_NumberOfFloatsPerVertex;
+
+        float Depth = 0.0f;
+
+        for (int Axis = 0; Axis < 3; ++ Axis) Depth += 0.5f * (pFirst[Axis] + pThird[Axis]) * pForward[Axis];
+
+        IsInOrder = IsInOrder && Depth <= LastDepth + 1.0e-3f;
+
+        LastDepth = Depth;
+    }
+
+    std::cout << MeshInfo.m_NumberOfVertices / 4 << " quads in one mesh of " << MeshInfo.m_NumberOfIndices << " indices, " << (IsInOrder ? "sorted" : "NOT sorted") << " back to front" << std::endl;
+}
@@ -0,0 +1,224 @@
+
+#include "benchmark.h"
+
+#include "scene_store.h"
+
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+namespace
+{
+    const int s_NumberOfEntities = 1000000;
+    const int s_NumberOfChurns   = 10000;                               // Entities destroyed and created again per run.
+    const int s_NumberOfRuns     = 8;
+
+    // -----------------------------------------------------------------------------
+    // One object the way the examples store them today: handles, a world matrix,
+    // and the bounds next to each other.
+    // -----------------------------------------------------------------------------
+    struct SObject
+    {
+        gfx::BHandle m_pMesh;
+        gfx::BHandle m_pMaterial;
+        float        m_WorldMatrix[16];
+        float        m_Position[3];
+        float        m_Radius;
+        int          m_SortGroup;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+    // A camera at the origin looking along z with a 60 degree field of view.
+    // Row vectors like YoshiX, the view matrix is the identity.
+    // -----------------------------------------------------------------------------
+    void GetViewProjectionMatrix(float* _pMatrix)
+    {
+        float Near   = 0.1f;
+        float Far    = 1000.0f;
+        float YScale = 1.0f / tanf(0.5f * 60.0f * 3.14159265f / 180.0f);
+        float XScale = YScale / (4.0f / 3.0f);
+
+        float Matrix[16] =
+        {
+            XScale, 0.0f  , 0.0f                       , 0.0f,
+            0.0f  , YScale, 0.0f                       , 0.0f,
+            0.0f  , 0.0f  , Far / (Far - Near)         , 1.0f,
+            0.0f  , 0.0f  , -Near * Far / (Far - Near) , 0.0f,
+        };
+
+        for (int Index = 0; Index < 16; ++ Index) _pMatrix[Index] = Matrix[Index];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, double _Time)
+    {
+        std::cout << std::left << std::setw(36) << _pName << std::right << std::setw(12) << _Time << std::setw(16) << s_NumberOfEntities / _Time / 1000.0 << std::endl;
+    }
+} // namespace
+
+void RunSceneStoreBenchmark()
+{
+    // -----------------------------------------------------------------------------
+    // Entities spread randomly in a cube of 1000 units around the camera, about
+    // one sixth of them is in the view frustum.
+    // -----------------------------------------------------------------------------
+    std::vector<float> Positions(s_NumberOfEntities * 3);
+
+    unsigned int State = 12345;
+
+    for (float& rValue : Positions) rValue = static_cast<float>(GetRandom(State) % 100000) / 50.0f - 1000.0f;
+
+    float ViewProjectionMatrix[16];
+
+    GetViewProjectionMatrix(ViewProjectionMatrix);
+
+    float EyePosition[3] = { 0.0f, 0.0f, 0.0f };
+
+    CSceneStore Store;
+
+    std::vector<SEntity> Entities(s_NumberOfEntities);
+
+    double CreateTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        Store.Clear();
+        Store.Reserve(s_NumberOfEntities);
+
+        for (int IndexOfEntity = 0; IndexOfEntity < s_NumberOfEntities; ++ IndexOfEntity)
+        {
+            Entities[IndexOfEntity] = Store.Create(nullptr, IndexOfEntity & 15, &Positions[IndexOfEntity * 3], 1.0f);
+        }
+    });
+
+    // -----------------------------------------------------------------------------
+    // A system moving all entities over the dense arrays, and the same through
+    // the handles in creation order, which is random after the churn.
+    // -----------------------------------------------------------------------------
+    double DenseUpdateTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        float* pX = Store.GetPositionsX();
+        float* pZ = Store.GetPositionsZ();
+
+        int NumberOfEntities = Store.GetNumberOfEntities();
+
+        for (int IndexOfEntity = 0; IndexOfEntity < NumberOfEntities; ++ IndexOfEntity)
+        {
+            pX[IndexOfEntity] += 0.001f;
+            pZ[IndexOfEntity] -= 0.001f;
+        }
+    });
+
+    double ChurnTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        for (int IndexOfChurn = 0; IndexOfChurn < s_NumberOfChurns; ++ IndexOfChurn)
+        {
+            int IndexOfEntity = static_cast<int>(GetRandom(State) % s_NumberOfEntities);
+
+            Store.Destroy(Entities[IndexOfEntity]);
+
+            Entities[IndexOfEntity] = Store.Create(nullptr, IndexOfEntity & 15, &Positions[IndexOfEntity * 3], 1.0f);
+        }
+    });
+
+    double HandleUpdateTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        for (int IndexOfEntity = 0; IndexOfEntity < s_NumberOfEntities; ++ IndexOfEntity)
+        {
+            Store.SetPosition(Entities[IndexOfEntity], &Positions[IndexOfEntity * 3]);
+        }
+    });
+
+    // -----------------------------------------------------------------------------
+    // Culling over the dense arrays compared to the same test over an array of
+    // fat objects, then culling with sorting as it feeds the draw loop.
+    // -----------------------------------------------------------------------------
+    std::vector<int>        Visible;
+    std::vector<SSceneDraw> Draws;
+
+    Visible.reserve(s_NumberOfEntities);
+    Draws  .reserve(s_NumberOfEntities);
+
+    double CullTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        Visible.clear();
+
+        Store.Cull(ViewProjectionMatrix, Visible);
+    });
+
+    std::vector<SObject> Objects(s_NumberOfEntities);
+
+    for (int IndexOfEntity = 0; IndexOfEntity < s_NumberOfEntities; ++ IndexOfEntity)
+    {
+        SObject& rObject = Objects[IndexOfEntity];
+
+        rObject.m_pMesh     = nullptr;
+        rObject.m_pMaterial = nullptr;
+        rObject.m_Radius    = 1.0f;
+        rObject.m_SortGroup = IndexOfEntity & 15;
+
+        for (int Index = 0; Index < 16; ++ Index) rObject.m_WorldMatrix[Index] = Index % 5 == 0 ? 1.0f : 0.0f;
+        for (int Index = 0; Index < 3 ; ++ Index) rObject.m_Position[Index]    = Positions[IndexOfEntity * 3 + Index];
+    }
+
+    int NumberOfVisibleObjects = 0;
+
+    double ObjectCullTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        const float* M = ViewProjectionMatrix;
+
+        NumberOfVisibleObjects = 0;
+
+        for (const SObject& rObject : Objects)
+        {
+            // -----------------------------------------------------------------------------
+            // Clip space test of the bounding sphere center with the radius as margin,
+            // the usual per object code.
+            // -----------------------------------------------------------------------------
+            const float* P = rObject.m_Position;
+
+            float X = P[0] * M[0] + P[1] * M[4] + P[2] * M[ 8] + M[12];
+            float Y = P[0] * M[1] + P[1] * M[5] + P[2] * M[ 9] + M[13];
+            float Z = P[0] * M[2] + P[1] * M[6] + P[2] * M[10] + M[14];
+            float W = P[0] * M[3] + P[1] * M[7] + P[2] * M[11] + M[15];
+
+            float Margin = rObject.m_Radius * 2.0f;
+
+            if (X >= -W - Margin && X <= W + Margin && Y >= -W - Margin && Y <= W + Margin && Z >= -Margin && Z <= W + Margin) ++ NumberOfVisibleObjects;
+        }
+    });
+
+    double CullAndSortTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        Visible.clear();
+        Draws  .clear();
+
+        Store.Cull(ViewProjectionMatrix, Visible);
+        Store.Sort(Visible, EyePosition, SSortOrder::FrontToBack, Draws);
+    });
+
+    std::cout << std::endl;
+    std::cout << "Scene store (" << s_NumberOfEntities << " entities, " << Visible.size() << " visible, " << sizeof(SObject) << " bytes per object compared to "
+              << 5 * sizeof(float) + sizeof(gfx::BHandle) + sizeof(int) << " bytes per entity)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(36) << "Operation" << std::right << std::setw(12) << "ms" << std::setw(16) << "M entities/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    PrintRow("Create"                         , CreateTime);
+    PrintRow("Update, dense arrays"           , DenseUpdateTime);
+    PrintRow("Update, through handles"        , HandleUpdateTime);
+    PrintRow("Cull, dense arrays"             , CullTime);
+    PrintRow("Cull, array of objects"         , ObjectCullTime);
+    PrintRow("Cull and sort, dense arrays"    , CullAndSortTime);
+
+    std::cout << std::left << std::setw(36) << "Destroy and create" << std::right << std::setw(12) << ChurnTime << std::setw(16) << s_NumberOfChurns / ChurnTime / 1000.0 << std::endl;
+}
@@ -0,0 +1,347 @@
+
+#include "benchmark.h"
+
+#include "camera.h"
+#include "static_batch.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    const int   s_NumberOfProps     = 10000;
+    const int   s_NumberOfMaterials = 8;
+    const float s_SceneSize         = 400.0f;                           // Edge length of the square with the props.
+    const float s_CellSize          = 50.0f;
+    const int   s_NumberOfRuns      = 100;
+
+    // -----------------------------------------------------------------------------
+    // One prop the way a renderer without batching keeps it: material, world
+    // matrix, and bounding sphere.
+    // -----------------------------------------------------------------------------
+    struct SProp
+    {
+        gfx::BHandle m_pMaterial;
+        float        m_WorldMatrix[16];
+        float        m_Position[3];
+        float        m_Radius;
+    };
+
+    // -----------------------------------------------------------------------------
+    // The constants of one draw as in the examples: world matrix and world view
+    // projection matrix.
+    // -----------------------------------------------------------------------------
+    struct SDrawConstants
+    {
+        float m_WorldMatrix[16];
+        float m_WorldViewProjectionMatrix[16];
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct SResult
+    {
+        double m_Time;
+        int    m_NumberOfDraws;
+        int    m_NumberOfMaterialSwitches;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void MultiplyMatrix(const float* _pLeft, const float* _pRight, float* _pResult)
+    {
+        for (int Row = 0; Row < 4; ++ Row)
+        {
+            for (int Column = 0; Column < 4; ++ Column)
+            {
+                float Sum = 0.0f;
+
+                for (int Index = 0; Index < 4; ++ Index) Sum += _pLeft[Row * 4 + Index] * _pRight[Index * 4 + Column];
+
+                _pResult[Row * 4 + Column] = Sum;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // A box with 24 vertices (position, normal, texture coordinates) and 36
+    // indices, one size unit in each direction.
+    // -----------------------------------------------------------------------------
+    void GetBox(std::vector<float>& _rVertices, std::vector<int>& _rIndices)
+    {
+        for (int Axis = 0; Axis < 3; ++ Axis)
+        {
+            for (int Sign = -1; Sign <= 1; Sign += 2)
+            {
+                int FirstVertex = static_cast<int>(_rVertices.size()) / 8;
+
+                int U = (Axis + 1) % 3;
+                int V = (Axis + 2) % 3;
+
+                for (int Corner = 0; Corner < 4; ++ Corner)
+                {
+                    float Vertex[8] = {};
+
+                    Vertex[Axis]     = static_cast<float>(Sign);
+                    Vertex[U]        = Corner == 1 || Corner == 2 ? 1.0f : -1.0f;
+                    Vertex[V]        = Corner >= 2 ? 1.0f : -1.0f;
+                    Vertex[3 + Axis] = static_cast<float>(Sign);
+                    Vertex[6]        = Corner == 1 || Corner == 2 ? 1.0f : 0.0f;
+                    Vertex[7]        = Corner >= 2 ? 1.0f : 0.0f;
+
+                    _rVertices.insert(_rVertices.end(), Vertex, Vertex + 8);
+                }
+
+                int Quad[6] = { 0, 1, 2, 0, 2, 3 };
+
+                for (int Index : Quad) _rIndices.push_back(FirstVertex + Index);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // A camera 10 units above the ground at the border of the scene looking
+    // along z over it. Row vectors like YoshiX.
+    // -----------------------------------------------------------------------------
+    void GetViewProjectionMatrix(float* _pMatrix)
+    {
+        float Near   = 0.1f;
+        float Far    = 1000.0f;
+        float YScale = 1.0f / tanf(0.5f * 60.0f * 3.14159265f / 180.0f);
+        float XScale = YScale / (16.0f / 9.0f);
+
+        float ViewMatrix[16] =
+        {
+            1.0f, 0.0f  , 0.0f                       , 0.0f,
+            0.0f, 1.0f  , 0.0f                       , 0.0f,
+            0.0f, 0.0f  , 1.0f                       , 0.0f,
+            0.0f, -10.0f, 0.5f * s_SceneSize + 20.0f , 1.0f,
+        };
+
+        float ProjectionMatrix[16] =
+        {
+            XScale, 0.0f  , 0.0f                       , 0.0f,
+            0.0f  , YScale, 0.0f                       , 0.0f,
+            0.0f  , 0.0f  , Far / (Far - Near)         , 1.0f,
+            0.0f  , 0.0f  , -Near * Far / (Far - Near) , 0.0f,
+        };
+
+        MultiplyMatrix(ViewMatrix, ProjectionMatrix, _pMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsVisible(const float (*_pPlanes)[4], const float* _pCenter, float _Radius)
+    {
+        for (int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+        {
+            const float* pPlane = _pPlanes[IndexOfPlane];
+
+            if (pPlane[0] * _pCenter[0] + pPlane[1] * _pCenter[1] + pPlane[2] * _pCenter[2] + pPlane[3] < -_Radius) return false;
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, const SResult& _rResult)
+    {
+        std::cout << std::left << std::setw(36) << _pName << std::right << std::setw(12) << _rResult.m_NumberOfDraws << std::setw(12) << _rResult.m_NumberOfMaterialSwitches
+                  << std::setw(16) << _rResult.m_NumberOfDraws * sizeof(SDrawConstants) << std::setw(12) << _rResult.m_Time << std::endl;
+    }
+} // namespace
+
+void RunStaticBatchBenchmark()
+{
+    // -----------------------------------------------------------------------------
+    // Boxes of random size and rotation around y spread over a square in front
+    // of the camera. The props are sorted by material, like a renderer without
+    // batching would submit them.
+    // -----------------------------------------------------------------------------
+    std::vector<float> BoxVertices;
+    std::vector<int>   BoxIndices;
+
+    GetBox(BoxVertices, BoxIndices);
+
+    SStaticMesh BoxMesh = { BoxVertices.data(), static_cast<int>(BoxVertices.size()) / 8, BoxIndices.data(), static_cast<int>(BoxIndices.size()) };
+
+    std::vector<SProp> Props(s_NumberOfProps);
+
+    unsigned int State = 4711;
+
+    for (SProp& rProp : Props)
+    {
+        float Scale = 0.5f + static_cast<float>(GetRandom(State) % 1000) / 1000.0f;
+        float Angle = static_cast<float>(GetRandom(State) % 6283) / 1000.0f;
+        float X     = static_cast<float>(GetRandom(State) % 100000) / 100000.0f * s_SceneSize - 0.5f * s_SceneSize;
+        float Z     = static_cast<float>(GetRandom(State) % 100000) / 100000.0f * s_SceneSize - 0.5f * s_SceneSize;
+
+        float WorldMatrix[16] =
+        {
+            cosf(Angle) * Scale , 0.0f , -sinf(Angle) * Scale, 0.0f,
+            0.0f                , Scale, 0.0f                , 0.0f,
+            sinf(Angle) * Scale , 0.0f , cosf(Angle) * Scale , 0.0f,
+            X                   , Scale, Z                   , 1.0f,
+        };
+
+        rProp.m_pMaterial   = reinterpret_cast<gfx::BHandle>(static_cast<size_t>(GetRandom(State) % s_NumberOfMaterials + 1));
+        rProp.m_Position[0] = X;
+        rProp.m_Position[1] = Scale;
+        rProp.m_Position[2] = Z;
+        rProp.m_Radius      = Scale * sqrtf(3.0f);
+
+        memcpy(rProp.m_WorldMatrix, WorldMatrix, sizeof(WorldMatrix));
+    }
+
+    std::stable_sort(Props.begin(), Props.end(), [](const SProp& _rLeft, const SProp& _rRight)
+    {
+        return _rLeft.m_pMaterial < _rRight.m_pMaterial;
+    });
+
+    SStaticVertexLayout Layout = { 8, 0, 1, { 3, 0, 0, 0 }, false, false };
+
+    CStaticBatcher Batcher;
+
+    double BuildTime = MeasureMilliseconds(4, [&]()
+    {
+        Batcher.Clear();
+        Batcher.SetLayout(Layout);
+        Batcher.SetCellSize(s_CellSize);
+
+        for (const SProp& rProp : Props) Batcher.AddInstance(rProp.m_pMaterial, BoxMesh, rProp.m_WorldMatrix);
+
+        Batcher.Build();
+    });
+
+    float ViewProjectionMatrix[16];
+    float FrustumPlanes[6][4];
+
+    GetViewProjectionMatrix(ViewProjectionMatrix);
+    GetFrustumPlanes(ViewProjectionMatrix, FrustumPlanes);
+
+    // -----------------------------------------------------------------------------
+    // The CPU work of a frame up to the draw call: culling, the constants of each
+    // draw written into a staging buffer, and counting the draws and material
+    // switches. The cost of the draw calls in the driver comes on top of it and
+    // grows with the number of draws.
+    // -----------------------------------------------------------------------------
+    std::vector<SDrawConstants> Staging(s_NumberOfProps);
+    std::vector<SStaticDraw>    Draws(s_NumberOfProps);
+
+    SResult PerInstance = {};
+    SResult Ranges      = {};
+    SResult Meshes      = {};
+
+    PerInstance.m_Time = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        gfx::BHandle pMaterial = nullptr;
+
+        PerInstance.m_NumberOfDraws            = 0;
+        PerInstance.m_NumberOfMaterialSwitches = 0;
+
+        for (const SProp& rProp : Props)
+        {
+            if (IsVisible(FrustumPlanes, rProp.m_Position, rProp.m_Radius) == false) continue;
+
+            SDrawConstants& rConstants = Staging[PerInstance.m_NumberOfDraws ++];
+
+            memcpy(rConstants.m_WorldMatrix, rProp.m_WorldMatrix, sizeof(rConstants.m_WorldMatrix));
+
+            MultiplyMatrix(rProp.m_WorldMatrix, ViewProjectionMatrix, rConstants.m_WorldViewProjectionMatrix);
+
+            if (rProp.m_pMaterial != pMaterial) ++ PerInstance.m_NumberOfMaterialSwitches;
+
+            pMaterial = rProp.m_pMaterial;
+        }
+    });
+
+    // -----------------------------------------------------------------------------
+    // The batches are in world space, so all of their draws share the same
+    // constants. They are written per draw anyway, like a renderer binding them
+    // for each draw would do.
+    // -----------------------------------------------------------------------------
+    const float IdentityMatrix[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+    Ranges.m_Time = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        gfx::BHandle pMaterial = nullptr;
+
+        Ranges.m_NumberOfDraws            = Batcher.Cull(FrustumPlanes, Draws.data());
+        Ranges.m_NumberOfMaterialSwitches = 0;
+
+        for (int IndexOfDraw = 0; IndexOfDraw < Ranges.m_NumberOfDraws; ++ IndexOfDraw)
+        {
+            const SStaticBatch& rBatch = Batcher.GetBatch(Draws[IndexOfDraw].m_IndexOfBatch);
+
+            SDrawConstants& rConstants = Staging[IndexOfDraw];
+
+            memcpy(rConstants.m_WorldMatrix              , IdentityMatrix      , sizeof(rConstants.m_WorldMatrix));
+            memcpy(rConstants.m_WorldViewProjectionMatrix, ViewProjectionMatrix, sizeof(rConstants.m_WorldViewProjectionMatrix));
+
+            if (rBatch.m_pMaterial != pMaterial) ++ Ranges.m_NumberOfMaterialSwitches;
+
+            pMaterial = rBatch.m_pMaterial;
+        }
+    });
+
+    // -----------------------------------------------------------------------------
+    // YoshiX draws complete meshes, so each batch with a visible range is one
+    // draw. The draws of a batch follow each other in the culling result.
+    // -----------------------------------------------------------------------------
+    Meshes.m_Time = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        gfx::BHandle pMaterial = nullptr;
+
+        int NumberOfDraws = Batcher.Cull(FrustumPlanes, Draws.data());
+        int IndexOfBatch  = -1;
+
+        Meshes.m_NumberOfDraws            = 0;
+        Meshes.m_NumberOfMaterialSwitches = 0;
+
+        for (int IndexOfDraw = 0; IndexOfDraw < NumberOfDraws; ++ IndexOfDraw)
+        {
+            if (Draws[IndexOfDraw].m_IndexOfBatch == IndexOfBatch) continue;
+
+            IndexOfBatch = Draws[IndexOfDraw].m_IndexOfBatch;
+
+            const SStaticBatch& rBatch = Batcher.GetBatch(IndexOfBatch);
+
+            SDrawConstants& rConstants = Staging[Meshes.m_NumberOfDraws ++];
+
+            memcpy(rConstants.m_WorldMatrix              , IdentityMatrix      , sizeof(rConstants.m_WorldMatrix));
+            memcpy(rConstants.m_WorldViewProjectionMatrix, ViewProjectionMatrix, sizeof(rConstants.m_WorldViewProjectionMatrix));
+
+            if (rBatch.m_pMaterial != pMaterial) ++ Meshes.m_NumberOfMaterialSwitches;
+
+            pMaterial = rBatch.m_pMaterial;
+        }
+    });
+
+    std::cout << std::endl;
+    std::cout << "Static batching (" << s_NumberOfProps << " props with " << BoxMesh.m_NumberOfVertices << " vertices, " << s_NumberOfMaterials << " materials, "
+              << Batcher.GetNumberOfBatches() << " batches in cells of " << s_CellSize << " units, built in " << std::fixed << std::setprecision(2) << BuildTime << " ms)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(36) << "Submission" << std::right << std::setw(12) << "Draws" << std::setw(12) << "Materials" << std::setw(16) << "Constant bytes" << std::setw(12) << "CPU ms" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+
+    PrintRow("Per instance"                   , PerInstance);
+    PrintRow("Static batches, visible ranges" , Ranges);
+    PrintRow("Static batches, complete meshes", Meshes);
+
+    std::cout << std::setprecision(1) << "Draw calls reduced by " << PerInstance.m_NumberOfDraws / static_cast<double>(std::max(Ranges.m_NumberOfDraws, 1)) << "x with ranges and by "
+              << PerInstance.m_NumberOfDraws / static_cast<double>(std::max(Meshes.m_NumberOfDraws, 1)) << "x with complete meshes" << std::endl;
+}
@@ -0,0 +1,322 @@
+
+#include "benchmark.h"
+
+#include "camera.h"
+#include "job_system.h"
+#include "offscreen_renderer.h"
+#include "temporal_cache.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <thread>
+
+namespace
+{
+    const int   s_Width          = 800;                                 // The window of 'billboard.cpp'.
+    const int   s_Height         = 600;
+    const int   s_NumberOfFrames = 120;
+    const int   s_NumberOfLights = 8;
+
+    // -----------------------------------------------------------------------------
+    // Radians per frame of the camera circling the scene. 0.02 is the speed of
+    // 'billboard.cpp' at 60 frames per second, 0.04 the step of one key press it
+    // had before the fixed step loop.
+    // -----------------------------------------------------------------------------
+    const float s_Steps[] = { 0.0f, 0.005f, 0.02f, 0.04f };
+
+    // -----------------------------------------------------------------------------
+
+    struct SScene
+    {
+        COffscreenRenderer Renderer;
+        CCamera            Camera;
+        float              LightPositions[s_NumberOfLights][3];
+        float              LightColors   [s_NumberOfLights][3];
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct SResult
+    {
+        double                   m_FrameTime;                           // Average milliseconds of the resolve.
+        double                   m_Error;                               // Average difference of a channel to the full shading.
+        STemporalCacheStatistics m_Statistics;
+    };
+
+    // -----------------------------------------------------------------------------
+    // A few point lights with diffuse and specular terms, the albedo is the flat
+    // color of the offscreen renderer. Expensive enough per pixel to stand in
+    // for the lighting of a deferred renderer.
+    // -----------------------------------------------------------------------------
+    void ShadePixel(int _X, int _Y, float _Depth, const float* _pNormal, float* _pColor, void* _pUserData)
+    {
+        SScene& rScene = *static_cast<SScene*>(_pUserData);
+
+        const float* pAlbedo = rScene.Renderer.GetColorTarget().m_pPixels + (static_cast<size_t>(_Y) * s_Width + _X) * 4;
+
+        if (_Depth == 1.0f)
+        {
+            std::copy(pAlbedo, pAlbedo + 4, _pColor);
+
+            return;
+        }
+
+        const SCameraSnapshot& rCamera = rScene.Camera.GetSnapshot();
+
+        const float* pMatrix = rCamera.m_InverseViewProjectionMatrix;
+
+        float NDC[3] = { (_X + 0.5f) / s_Width * 2.0f - 1.0f, 1.0f - (_Y + 0.5f) / s_Height * 2.0f, _Depth };
+        float W      = NDC[0] * pMatrix[3] + NDC[1] * pMatrix[7] + NDC[2] * pMatrix[11] + pMatrix[15];
+
+        float Position[3];
+
+        for (int Axis = 0; Axis < 3; ++ Axis) Position[Axis] = (NDC[0] * pMatrix[Axis] + NDC[1] * pMatrix[4 + Axis] + NDC[2] * pMatrix[8 + Axis] + pMatrix[12 + Axis]) / W;
+
+        float View[3] = { rCamera.m_EyePosition[0] - Position[0], rCamera.m_EyePosition[1] - Position[1], rCamera.m_EyePosition[2] - Position[2] };
+        float Length  = sqrtf(View[0] * View[0] + View[1] * View[1] + View[2] * View[2]);
+
+        for (int Axis = 0; Axis < 3; ++ Axis) View[Axis] /= Length;
+
+        float Light[3] = { 0.1f, 0.1f, 0.1f };
+
+        for (int IndexOfLight = 0; IndexOfLight < s_NumberOfLights; ++ IndexOfLight)
+        {
+            float Direction[3];
+
+            for (int Axis = 0; Axis < 3; ++ Axis) Direction[Axis] = rScene.LightPositions[IndexOfLight][Axis] - Position[Axis];
+
+            float SquaredDistance = Direction[0] * Direction[0] + Direction[1] * Direction[1] + Direction[2] * Direction[2];
+            float Distance        = sqrtf(SquaredDistance);
+
+            for (int Axis = 0; Axis < 3; ++ Axis) Direction[Axis] /= Distance;
+
+            float Diffuse = std::max(Direction[0] * _pNormal[0] + Direction[1] * _pNormal[1] + Direction[2] * _pNormal[2], 0.0f);
+
+            float Half[3]    = { Direction[0] + View[0], Direction[1] + View[1], Direction[2] + View[2] };
+            float HalfLength = sqrtf(Half[0] * Half[0] + Half[1] * Half[1] + Half[2] * Half[2]);
+
+            float Specular = HalfLength > 0.0f ? powf(std::max((Half[0] * _pNormal[0] + Half[1] * _pNormal[1] + Half[2] * _pNormal[2]) / HalfLength, 0.0f), 32.0f) : 0.0f;
+
+            float Attenuation = 4.0f / (1.0f + SquaredDistance);
+
+            for (int Axis = 0; Axis < 3; ++ Axis) Light[Axis] += (Diffuse + Specular) * Attenuation * rScene.LightColors[IndexOfLight][Axis];
+        }
+
+        for (int Axis = 0; Axis < 3; ++ Axis) _pColor[Axis] = pAlbedo[Axis] * Light[Axis];
+
+        _pColor[3] = pAlbedo[3];
+    }
+
+    // -----------------------------------------------------------------------------
+    // Same rotation as 'CApplication::GetBillboardCorners' in 'billboard.cpp'.
+    // -----------------------------------------------------------------------------
+    void DrawBillboard(COffscreenRenderer& _rRenderer, const float* _pPosition, const float* _pEye, const float* _pViewProjectionMatrix, const float* _pColor)
+    {
+        float ZBasis[3] = { _pPosition[0] - _pEye[0], 0.0f, _pPosition[2] - _pEye[2] };
+        float Length    = sqrtf(ZBasis[0] * ZBasis[0] + ZBasis[2] * ZBasis[2]);
+
+        ZBasis[0] /= Length;
+        ZBasis[2] /= Length;
+
+        float Corners[4][3];
+        float Offsets[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+        for (int IndexOfCorner = 0; IndexOfCorner < 4; ++ IndexOfCorner)
+        {
+            Corners[IndexOfCorner][0] = _pPosition[0] + Offsets[IndexOfCorner][0] * ZBasis[2];
+            Corners[IndexOfCorner][1] = _pPosition[1] + Offsets[IndexOfCorner][1];
+            Corners[IndexOfCorner][2] = _pPosition[2] - Offsets[IndexOfCorner][0] * ZBasis[0];
+        }
+
+        float Normal[3] = { -ZBasis[0], 0.0f, -ZBasis[2] };
+
+        int Indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+        _rRenderer.DrawTriangles(&Corners[0][0], 3, Indices, 6, _pViewProjectionMatrix, _pColor, Normal);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The scene of 'billboard.cpp' with its ground, walls, and trees.
+    // -----------------------------------------------------------------------------
+    void RenderScene(SScene& _rScene, float _Angle)
+    {
+        const float GroundColor[4] = { 0.3f, 0.45f, 0.2f, 1.0f };
+        const float WallColor  [4] = { 1.6f, 1.4f , 1.2f, 1.0f };
+        const float TreeColor  [4] = { 0.1f, 0.7f , 0.2f, 0.8f };
+        const float SkyColor   [4] = { 0.4f, 0.6f , 0.9f, 1.0f };
+
+        float WallPositions[3][3] = { { -2.0f, 0.0f, 3.0f }, { 0.0f, 0.0f, 3.0f }, { 2.0f, 0.0f, 3.0f } };
+        float TreePositions[5][3] = { { -2.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 1.0f }, { 2.0f, 0.0f, 1.0f }, { -1.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, -1.0f } };
+
+        float GroundCorners[4][3] = { { -4.0f, -1.0f, -4.0f }, { 4.0f, -1.0f, -4.0f }, { 4.0f, -1.0f, 4.0f }, { -4.0f, -1.0f, 4.0f } };
+        float GroundNormal [3]    = { 0.0f, 1.0f, 0.0f };
+
+        int QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+        float Eye[3] = { 8.0f * cosf(_Angle), 0.0f, 8.0f * sinf(_Angle) };
+        float At [3] = { 0.0f, 0.0f, 0.0f };
+        float Up [3] = { 0.0f, 1.0f, 0.0f };
+
+        _rScene.Camera.SetLookAt(Eye, At, Up);
+
+        const float* pViewProjectionMatrix = _rScene.Camera.GetSnapshot().m_ViewProjectionMatrix;
+
+        _rScene.Renderer.BeginFrame(SkyColor);
+
+        _rScene.Renderer.DrawTriangles(&GroundCorners[0][0], 3, QuadIndices, 6, pViewProjectionMatrix, GroundColor, GroundNormal);
+
+        for (int IndexOfWall = 0; IndexOfWall < 3; ++ IndexOfWall) DrawBillboard(_rScene.Renderer, WallPositions[IndexOfWall], Eye, pViewProjectionMatrix, WallColor);
+
+        // -----------------------------------------------------------------------------
+        // Back to front for blending, the trees in the back row are farther away
+        // for the angles of the benchmark.
+        // -----------------------------------------------------------------------------
+        for (int IndexOfTree = 0; IndexOfTree < 5; ++ IndexOfTree) DrawBillboard(_rScene.Renderer, TreePositions[IndexOfTree], Eye, pViewProjectionMatrix, TreeColor);
+
+        _rScene.Renderer.EndFrame();
+    }
+
+    // -----------------------------------------------------------------------------
+    // Circles the camera with the step per frame. Each frame is resolved with
+    // the cache and, for the error, shaded completely by a second cache which
+    // is invalidated every frame. With the job system both run as jobs.
+    // -----------------------------------------------------------------------------
+    SResult Run(SScene& _rScene, float _Step, CJobSystem* _pJobSystem, SResult& _rFullResult)
+    {
+        CTemporalCache Cache;
+        CTemporalCache FullCache;
+
+        Cache    .SetViewport(s_Width, s_Height);
+        FullCache.SetViewport(s_Width, s_Height);
+
+        SResult Result = {};
+
+        double FullTime = 0.0;
+        double Error    = 0.0;
+
+        for (int IndexOfFrame = 0; IndexOfFrame < s_NumberOfFrames; ++ IndexOfFrame)
+        {
+            RenderScene(_rScene, 4.7f + _Step * IndexOfFrame);
+
+            const SCameraSnapshot& rCamera = _rScene.Camera.GetSnapshot();
+
+            filter::SImage DepthTarget  = _rScene.Renderer.GetDepthTarget();
+            filter::SImage NormalTarget = _rScene.Renderer.GetNormalTarget();
+
+            CStopwatch Stopwatch;
+
+            if (_pJobSystem != nullptr)
+            {
+                Cache.Resolve(rCamera, DepthTarget, NormalTarget, &ShadePixel, &_rScene, *_pJobSystem);
+            }
+            else
+            {
+                Cache.Resolve(rCamera, DepthTarget, NormalTarget, &ShadePixel, &_rScene);
+            }
+
+            Result.m_FrameTime += Stopwatch.GetElapsedMilliseconds();
+
+            FullCache.Invalidate();
+
+            Stopwatch.Start();
+
+            if (_pJobSystem != nullptr)
+            {
+                FullCache.Resolve(rCamera, DepthTarget, NormalTarget, &ShadePixel, &_rScene, *_pJobSystem);
+            }
+            else
+            {
+                FullCache.Resolve(rCamera, DepthTarget, NormalTarget, &ShadePixel, &_rScene);
+            }
+
+            FullTime += Stopwatch.GetElapsedMilliseconds();
+
+            const float* pCached = Cache    .GetColorTarget().m_pPixels;
+            const float* pFull   = FullCache.GetColorTarget().m_pPixels;
+
+            double FrameError = 0.0;
+
+            for (int Index = 0; Index < s_Width * s_Height * 4; ++ Index) FrameError += fabsf(pCached[Index] - pFull[Index]);
+
+            Error += FrameError / (s_Width * s_Height * 4);
+        }
+
+        Result.m_FrameTime /= s_NumberOfFrames;
+        Result.m_Error      = Error / s_NumberOfFrames;
+
+        Cache.GetStatistics(Result.m_Statistics);
+
+        _rFullResult.m_FrameTime = FullTime / s_NumberOfFrames;
+        _rFullResult.m_Error     = 0.0;
+
+        FullCache.GetStatistics(_rFullResult.m_Statistics);
+
+        return Result;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(float _Step, int _NumberOfThreads, const SResult& _rFull, const SResult& _rCached)
+    {
+        const STemporalCacheStatistics& rStatistics = _rCached.m_Statistics;
+
+        double Pixels = static_cast<double>(std::max(rStatistics.m_NumberOfPixels, 1LL));
+
+        std::cout << std::setw(8) << _Step << std::setw(8) << _NumberOfThreads << std::setw(10) << _rFull.m_FrameTime << std::setw(10) << _rCached.m_FrameTime
+                  << std::setw(10) << 100.0 * rStatistics.m_NumberOfReusedPixels / Pixels << std::setw(10) << 100.0 * rStatistics.m_NumberOfDisoccludedPixels / Pixels
+                  << std::setw(10) << 100.0 * rStatistics.m_NumberOfInvalidatedPixels / Pixels << std::setw(10) << rStatistics.m_ReprojectionTime / rStatistics.m_NumberOfFrames
+                  << std::setw(10) << rStatistics.m_SavedTime / rStatistics.m_NumberOfFrames << std::setw(10) << _rFull.m_FrameTime - _rCached.m_FrameTime << std::setw(10) << _rCached.m_Error << std::endl;
+    }
+} // namespace
+
+void RunTemporalCacheBenchmark()
+{
+    int MaximumNumberOfThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    SScene Scene;
+
+    Scene.Renderer.SetViewport(s_Width, s_Height);
+    Scene.Renderer.SetDepthRange(0.1f, 100.0f, SDepthMode::Standard);
+
+    Scene.Camera.SetPerspective(60.0f, static_cast<float>(s_Width) / static_cast<float>(s_Height), 0.1f, 100.0f);
+
+    for (int IndexOfLight = 0; IndexOfLight < s_NumberOfLights; ++ IndexOfLight)
+    {
+        float Angle = 6.2831853f * IndexOfLight / s_NumberOfLights;
+
+        Scene.LightPositions[IndexOfLight][0] = 3.0f * cosf(Angle);
+        Scene.LightPositions[IndexOfLight][1] = 0.5f + 0.25f * (IndexOfLight % 3);
+        Scene.LightPositions[IndexOfLight][2] = 3.0f * sinf(Angle);
+
+        Scene.LightColors[IndexOfLight][0] = 0.5f + 0.5f * cosf(Angle);
+        Scene.LightColors[IndexOfLight][1] = 0.5f + 0.5f * cosf(Angle + 2.0f);
+        Scene.LightColors[IndexOfLight][2] = 0.5f + 0.5f * cosf(Angle + 4.0f);
+    }
+
+    std::cout << std::endl;
+    std::cout << "Temporal cache (" << s_Width << " x " << s_Height << " pixels, " << s_NumberOfLights << " point lights, " << s_NumberOfFrames << " frames circling the billboard scene, times in ms per frame)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::setw(8) << "Step" << std::setw(8) << "Threads" << std::setw(10) << "Full" << std::setw(10) << "Cached" << std::setw(10) << "Reused %" << std::setw(10) << "Disocc. %"
+              << std::setw(10) << "Inval. %" << std::setw(10) << "Reproj." << std::setw(10) << "Est. save" << std::setw(10) << "Saved" << std::setw(10) << "Error" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (float Step : s_Steps)
+    {
+        SResult Full;
+        SResult Cached = Run(Scene, Step, nullptr, Full);
+
+        PrintRow(Step, 1, Full, Cached);
+    }
+
+    if (MaximumNumberOfThreads > 1)
+    {
+        CJobSystem JobSystem(MaximumNumberOfThreads - 1);
+
+        SResult Full;
+        SResult Cached = Run(Scene, 0.02f, &JobSystem, Full);
+
+        PrintRow(0.02f, MaximumNumberOfThreads, Full, Cached);
+    }
+}
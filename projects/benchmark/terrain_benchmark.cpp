@@ -0,0 +1,170 @@
+
+#include "benchmark.h"
+
+#include "camera.h"
+#include "job_system.h"
+#include "terrain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const char* s_pTerrainPath     = "benchmark_terrain.ter";
+    const int   s_TileSize         = 257;
+    const int   s_NumberOfTiles    = 8;                                 // Per side, 2048 x 2048 units with one sample per unit.
+    const float s_HeightScale      = 300.0f / 65535.0f;
+    const float s_FlightSpeed      = 150.0f;                            // Units per second.
+    const float s_StepTime         = 1.0f / 60.0f;
+    const int   s_NumberOfFrames   = 300;
+
+    // -----------------------------------------------------------------------------
+
+    struct SResult
+    {
+        double             m_UpdateTime;                                // Average milliseconds per update.
+        double             m_AverageSelectedChunks;
+        STerrainStatistics m_Peak;                                      // Largest resident set of the flight.
+        STerrainStatistics m_Last;
+    };
+
+    // -----------------------------------------------------------------------------
+    // Flies straight over the terrain, looking a bit down and keeping a height
+    // above the ground, and updates the terrain once per frame. The frames are
+    // paced like a game at 60 Hz, so the jobs have the time between the updates
+    // and the latency is measured against real frames.
+    // -----------------------------------------------------------------------------
+    SResult Fly(CTerrain& _rTerrain)
+    {
+        CCamera Camera;
+
+        Camera.SetPerspective(60.0f, 16.0f / 9.0f, 0.5f, 2000.0f);
+
+        _rTerrain.SetViewport(1920, 1080);
+        _rTerrain.ResetStatistics();
+
+        SResult Result = {};
+
+        double UpdateTime     = 0.0;
+        double SelectedChunks = 0.0;
+
+        for (int IndexOfFrame = 0; IndexOfFrame < s_NumberOfFrames; ++ IndexOfFrame)
+        {
+            float Distance = IndexOfFrame * s_FlightSpeed * s_StepTime;
+
+            float Eye[3] = { -800.0f + Distance, 0.0f, -600.0f + 0.5f * Distance };
+            float At [3] = { Eye[0] + 100.0f, 0.0f, Eye[2] + 50.0f };
+            float Up [3] = { 0.0f, 1.0f, 0.0f };
+
+            Eye[1] = _rTerrain.GetHeight(Eye[0], Eye[2]) + 40.0f;
+            At [1] = Eye[1] - 30.0f;
+
+            Camera.SetLookAt(Eye, At, Up);
+
+            CStopwatch Stopwatch;
+
+            _rTerrain.Update(Camera.GetSnapshot());
+
+            double FrameTime = Stopwatch.GetElapsedMilliseconds();
+
+            UpdateTime += FrameTime;
+
+            STerrainStatistics Statistics;
+
+            _rTerrain.GetStatistics(Statistics);
+
+            SelectedChunks += Statistics.m_NumberOfSelectedChunks;
+
+            if (Statistics.m_TileBytes + Statistics.m_ChunkBytes > Result.m_Peak.m_TileBytes + Result.m_Peak.m_ChunkBytes) Result.m_Peak = Statistics;
+
+            Result.m_Last = Statistics;
+
+            if (FrameTime < 1000.0 * s_StepTime) std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(1000.0 * (1000.0 * s_StepTime - FrameTime))));
+        }
+
+        Result.m_UpdateTime            = UpdateTime     / s_NumberOfFrames;
+        Result.m_AverageSelectedChunks = SelectedChunks / s_NumberOfFrames;
+
+        return Result;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, int _NumberOfThreads, const SResult& _rResult)
+    {
+        std::cout << std::left << std::setw(16) << _pName << std::right << std::setw(8) << _NumberOfThreads << std::setw(10) << _rResult.m_UpdateTime << std::setw(10) << _rResult.m_AverageSelectedChunks
+                  << std::setw(8) << _rResult.m_Last.m_NumberOfBuiltChunks << std::setw(10) << _rResult.m_Last.m_AverageBuildTime << std::setw(10) << _rResult.m_Last.m_AverageLatency << std::setw(10) << _rResult.m_Last.m_MaximumLatency
+                  << std::setw(8) << _rResult.m_Peak.m_NumberOfResidentTiles << std::setw(10) << _rResult.m_Peak.m_TileBytes / (1024.0 * 1024.0) << std::setw(10) << _rResult.m_Peak.m_ChunkBytes / (1024.0 * 1024.0) << std::endl;
+    }
+} // namespace
+
+void RunTerrainBenchmark()
+{
+    int MaximumNumberOfThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    int Width = s_NumberOfTiles * (s_TileSize - 1) + 1;
+
+    std::vector<unsigned short> Samples;
+
+    GenerateTerrainSamples(Width, Width, 4711, Samples);
+
+    STerrainHeader Header = { 0, 0, s_TileSize, s_NumberOfTiles, s_NumberOfTiles, 1.0f, s_HeightScale, 0.0f };
+
+    if (WriteTerrainFile(s_pTerrainPath, Header, Samples.data()) == false)
+    {
+        std::cout << std::endl << "Terrain: " << s_pTerrainPath << " could not be written" << std::endl;
+
+        remove(s_pTerrainPath);
+
+        return;
+    }
+
+    STerrainSettings Settings = { 32, 2.0f, 600.0f, 1.0f, 8.0f, 16, 120 };
+
+    size_t FileSize = sizeof(STerrainHeader) + static_cast<size_t>(s_NumberOfTiles) * s_NumberOfTiles * s_TileSize * s_TileSize * sizeof(unsigned short);
+
+    std::cout << std::endl;
+    std::cout << "Terrain (" << Width - 1 << " x " << Width - 1 << " units in " << s_NumberOfTiles * s_NumberOfTiles << " tiles, " << FileSize / (1024 * 1024) << " MB mapped, chunks of "
+              << Settings.m_ChunkSize << " quads, " << Settings.m_MaximumScreenError << " pixels error, " << s_NumberOfFrames << " frames of flight)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(16) << "Builds" << std::right << std::setw(8) << "Threads" << std::setw(10) << "Update" << std::setw(10) << "Chunks" << std::setw(8) << "Built"
+              << std::setw(10) << "Build ms" << std::setw(10) << "Latency" << std::setw(10) << "Max lat." << std::setw(8) << "Tiles" << std::setw(10) << "Tile MB" << std::setw(10) << "Mesh MB" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    int Threads = 1;
+
+    while (true)
+    {
+        // Without workers the terrain builds the chunks right away in 'Update'
+        CJobSystem JobSystem(Threads - 1);
+
+        CTerrain Terrain;
+
+        Terrain.SetSettings(Settings);
+        Terrain.SetJobSystem(&JobSystem);
+
+        if (Terrain.Open(s_pTerrainPath) == false)
+        {
+            std::cout << s_pTerrainPath << " could not be opened" << std::endl;
+
+            break;
+        }
+
+        SResult Result = Fly(Terrain);
+
+        PrintRow(Threads == 1 ? "In the update" : "As jobs", Threads, Result);
+
+        Terrain.Close();
+
+        if (Threads == MaximumNumberOfThreads) break;
+
+        Threads = std::min(Threads * 2, MaximumNumberOfThreads);
+    }
+
+    remove(s_pTerrainPath);
+}
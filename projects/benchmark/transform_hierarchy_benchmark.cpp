@@ -0,0 +1,266 @@
+
+#include "benchmark.h"
+
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+namespace
+{
+    const int s_NumberOfRoots          = 1000;
+    const int s_NumberOfChildren       = 9;                             // Children of each root, each child has as many grandchildren plus one.
+    const int s_NumberOfRuns           = 16;
+    const int s_NumberOfDeepChainNodes = 100000;                        // One child per node.
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRandom(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return _rState >> 8;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The straightforward version as reference: every node every frame, scalar
+    // matrix products, in index order.
+    // -----------------------------------------------------------------------------
+    void MulMatrixScalar(const float* _pLeft, const float* _pRight, float* _pResult)
+    {
+        for (int Row = 0; Row < 4; ++ Row)
+        {
+            for (int Column = 0; Column < 4; ++ Column)
+            {
+                float Sum = 0.0f;
+
+                for (int Index = 0; Index < 4; ++ Index) Sum += _pLeft[Row * 4 + Index] * _pRight[Index * 4 + Column];
+
+                _pResult[Row * 4 + Column] = Sum;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetLocalMatrixScalar(const STransform& _rTransform, float* _pMatrix)
+    {
+        const float* Q = _rTransform.m_Rotation;
+
+        float Rotation[16] =
+        {
+            1.0f - 2.0f * (Q[1] * Q[1] + Q[2] * Q[2]), 2.0f * (Q[0] * Q[1] + Q[3] * Q[2]), 2.0f * (Q[0] * Q[2] - Q[3] * Q[1]), 0.0f,
+            2.0f * (Q[0] * Q[1] - Q[3] * Q[2]), 1.0f - 2.0f * (Q[0] * Q[0] + Q[2] * Q[2]), 2.0f * (Q[1] * Q[2] + Q[3] * Q[0]), 0.0f,
+            2.0f * (Q[0] * Q[2] + Q[3] * Q[1]), 2.0f * (Q[1] * Q[2] - Q[3] * Q[0]), 1.0f - 2.0f * (Q[0] * Q[0] + Q[1] * Q[1]), 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f,
+        };
+
+        float Scale[16] =
+        {
+            _rTransform.m_Scale[0], 0.0f, 0.0f, 0.0f,
+            0.0f, _rTransform.m_Scale[1], 0.0f, 0.0f,
+            0.0f, 0.0f, _rTransform.m_Scale[2], 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f,
+        };
+
+        MulMatrixScalar(Scale, Rotation, _pMatrix);
+
+        _pMatrix[12] = _rTransform.m_Translation[0];
+        _pMatrix[13] = _rTransform.m_Translation[1];
+        _pMatrix[14] = _rTransform.m_Translation[2];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void UpdateReference(const CTransformHierarchy& _rHierarchy, std::vector<float>& _rWorldMatrices)
+    {
+        int NumberOfNodes = _rHierarchy.GetNumberOfNodes();
+
+        _rWorldMatrices.resize(static_cast<size_t>(NumberOfNodes) * 16);
+
+        for (int Node = 0; Node < NumberOfNodes; ++ Node)
+        {
+            float* pWorldMatrix = &_rWorldMatrices[static_cast<size_t>(Node) * 16];
+            int    Parent       = _rHierarchy.GetParent(Node);
+
+            if (Parent < 0)
+            {
+                GetLocalMatrixScalar(_rHierarchy.GetLocalTransform(Node), pWorldMatrix);
+            }
+            else
+            {
+                float LocalMatrix[16];
+
+                GetLocalMatrixScalar(_rHierarchy.GetLocalTransform(Node), LocalMatrix);
+
+                MulMatrixScalar(LocalMatrix, &_rWorldMatrices[static_cast<size_t>(Parent) * 16], pWorldMatrix);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PrintRow(const char* _pName, int _NumberOfThreads, double _Time, int _NumberOfUpdatedNodes)
+    {
+        std::cout << std::left << std::setw(36) << _pName << std::right << std::setw(8) << _NumberOfThreads << std::setw(12) << _Time << std::setw(16) << _NumberOfUpdatedNodes << std::endl;
+    }
+} // namespace
+
+void RunTransformHierarchyBenchmark()
+{
+    // -----------------------------------------------------------------------------
+    // A forest of small hierarchies, e.g. characters with their attachments. The
+    // grandchildren are added after all children, so the creation order is not
+    // the depth first order.
+    // -----------------------------------------------------------------------------
+    CTransformHierarchy Hierarchy;
+
+    unsigned int State = 4711;
+
+    auto GetTransform = [&]()
+    {
+        float Axis[3] = { 0.0f, 1.0f, 0.0f };
+
+        STransform Transform;
+
+        Transform.m_Translation[0] = static_cast<float>(GetRandom(State) % 1000) * 0.01f;
+        Transform.m_Translation[1] = static_cast<float>(GetRandom(State) % 1000) * 0.01f;
+        Transform.m_Translation[2] = static_cast<float>(GetRandom(State) % 1000) * 0.01f;
+        Transform.m_Scale[0]       = 1.0f;
+        Transform.m_Scale[1]       = 1.0f;
+        Transform.m_Scale[2]       = 1.0f;
+
+        GetRotationQuaternion(Axis, static_cast<float>(GetRandom(State) % 360), Transform.m_Rotation);
+
+        return Transform;
+    };
+
+    std::vector<int> Children;
+
+    for (int IndexOfRoot = 0; IndexOfRoot < s_NumberOfRoots; ++ IndexOfRoot)
+    {
+        int Root = Hierarchy.AddNode(-1, GetTransform());
+
+        for (int IndexOfChild = 0; IndexOfChild < s_NumberOfChildren; ++ IndexOfChild)
+        {
+            Children.push_back(Hierarchy.AddNode(Root, GetTransform()));
+        }
+    }
+
+    for (int Child : Children)
+    {
+        for (int IndexOfGrandchild = 0; IndexOfGrandchild <= s_NumberOfChildren; ++ IndexOfGrandchild)
+        {
+            Hierarchy.AddNode(Child, GetTransform());
+        }
+    }
+
+    int NumberOfNodes  = Hierarchy.GetNumberOfNodes();
+    int NumberOfChurns = NumberOfNodes / 100;
+
+    std::vector<float> ReferenceMatrices;
+
+    double ReferenceTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+    {
+        UpdateReference(Hierarchy, ReferenceMatrices);
+    });
+
+    std::cout << std::endl;
+    std::cout << "Transform hierarchy (" << NumberOfNodes << " nodes, " << NumberOfChurns << " changed per frame)" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(36) << "Update" << std::right << std::setw(8) << "Threads" << std::setw(12) << "ms" << std::setw(16) << "Updated nodes" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    PrintRow("All nodes, scalar, no dirty flags", 1, ReferenceTime, NumberOfNodes);
+
+    int NumberOfThreads = Hierarchy.GetNumberOfThreads();
+
+    float MaximumError = 0.0f;
+
+    for (int Threads = 1; Threads <= NumberOfThreads; Threads = Threads < NumberOfThreads ? std::min(Threads * 2, NumberOfThreads) : Threads + 1)
+    {
+        Hierarchy.SetNumberOfThreads(Threads);
+
+        double AllTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            for (int Node = 0; Node < NumberOfNodes; ++ Node) Hierarchy.SetLocalTransform(Node, Hierarchy.GetLocalTransform(Node));
+
+            Hierarchy.Update();
+        });
+
+        PrintRow("All nodes changed", Threads, AllTime, Hierarchy.GetStatistics().m_NumberOfUpdatedNodes);
+
+        int UpdatedNodes = 0;
+
+        double ChurnTime = MeasureMilliseconds(s_NumberOfRuns, [&]()
+        {
+            float Axis[3] = { 0.0f, 1.0f, 0.0f };
+            float Rotation[4];
+
+            for (int IndexOfChurn = 0; IndexOfChurn < NumberOfChurns; ++ IndexOfChurn)
+            {
+                int Node = static_cast<int>(GetRandom(State) % NumberOfNodes);
+
+                Hierarchy.SetLocalRotation(Node, GetRotationQuaternion(Axis, static_cast<float>(GetRandom(State) % 360), Rotation));
+            }
+
+            Hierarchy.Update();
+
+            UpdatedNodes = Hierarchy.GetStatistics().m_NumberOfUpdatedNodes;
+        });
+
+        PrintRow("1% of the nodes changed", Threads, ChurnTime, UpdatedNodes);
+
+        UpdateReference(Hierarchy, ReferenceMatrices);
+
+        for (int Node = 0; Node < NumberOfNodes; ++ Node)
+        {
+            for (int Index = 0; Index < 16; ++ Index)
+            {
+                MaximumError = std::max(MaximumError, fabsf(Hierarchy.GetWorldMatrix(Node)[Index] - ReferenceMatrices[static_cast<size_t>(Node) * 16 + Index]));
+            }
+        }
+    }
+
+    std::cout << "Largest difference to the reference: " << MaximumError << std::endl;
+
+    // -----------------------------------------------------------------------------
+    // A single chain as deep as the whole hierarchy, e.g. a long rope. Building
+    // the order and the tasks must not recurse per level, otherwise the default
+    // stack of 1 MB overflows long before the last node.
+    // -----------------------------------------------------------------------------
+    CTransformHierarchy Chain;
+
+    int Parent = -1;
+
+    for (int IndexOfNode = 0; IndexOfNode < s_NumberOfDeepChainNodes; ++ IndexOfNode)
+    {
+        STransform Transform = { { 0.001f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+
+        Parent = Chain.AddNode(Parent, Transform);
+    }
+
+    CStopwatch Stopwatch;
+
+    Chain.Update();
+
+    double ChainTime = Stopwatch.GetElapsedMilliseconds();
+
+    UpdateReference(Chain, ReferenceMatrices);
+
+    float ChainError = 0.0f;
+
+    for (int Node = 0; Node < s_NumberOfDeepChainNodes; ++ Node)
+    {
+        for (int Index = 0; Index < 16; ++ Index)
+        {
+            ChainError = std::max(ChainError, fabsf(Chain.GetWorldMatrix(Node)[Index] - ReferenceMatrices[static_cast<size_t>(Node) * 16 + Index]));
+        }
+    }
+
+    std::cout << std::endl;
+    std::cout << "Deep chain (" << s_NumberOfDeepChainNodes << " nodes): first update " << ChainTime << " ms, largest difference to the reference " << ChainError << std::endl;
+}
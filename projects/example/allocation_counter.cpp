@@ -0,0 +1,114 @@
+
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace
+{
+    std::atomic<unsigned long long> s_NumberOfAllocations(0);
+    std::atomic<unsigned long long> s_NumberOfAllocatedBytes(0);
+
+    // -----------------------------------------------------------------------------
+
+    void* AllocateCounted(size_t _NumberOfBytes)
+    {
+        s_NumberOfAllocations   .fetch_add(1             , std::memory_order_relaxed);
+        s_NumberOfAllocatedBytes.fetch_add(_NumberOfBytes, std::memory_order_relaxed);
+
+        return malloc(_NumberOfBytes != 0 ? _NumberOfBytes : 1);
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+unsigned long long GetNumberOfAllocations()
+{
+    return s_NumberOfAllocations.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long GetNumberOfAllocatedBytes()
+{
+    return s_NumberOfAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+void* operator new(size_t _NumberOfBytes)
+{
+    void* pMemory = AllocateCounted(_NumberOfBytes);
+
+    if (pMemory == nullptr) throw std::bad_alloc();
+
+    return pMemory;
+}
+
+// -----------------------------------------------------------------------------
+
+void* operator new[](size_t _NumberOfBytes)
+{
+    void* pMemory = AllocateCounted(_NumberOfBytes);
+
+    if (pMemory == nullptr) throw std::bad_alloc();
+
+    return pMemory;
+}
+
+// -----------------------------------------------------------------------------
+
+void* operator new(size_t _NumberOfBytes, const std::nothrow_t&) noexcept
+{
+    return AllocateCounted(_NumberOfBytes);
+}
+
+// -----------------------------------------------------------------------------
+
+void* operator new[](size_t _NumberOfBytes, const std::nothrow_t&) noexcept
+{
+    return AllocateCounted(_NumberOfBytes);
+}
+
+// -----------------------------------------------------------------------------
+
+void operator delete(void* _pMemory) noexcept
+{
+    free(_pMemory);
+}
+
+// -----------------------------------------------------------------------------
+
+void operator delete[](void* _pMemory) noexcept
+{
+    free(_pMemory);
+}
+
+// -----------------------------------------------------------------------------
+
+void operator delete(void* _pMemory, size_t) noexcept
+{
+    free(_pMemory);
+}
+
+// -----------------------------------------------------------------------------
+
+void operator delete[](void* _pMemory, size_t) noexcept
+{
+    free(_pMemory);
+}
+
+// -----------------------------------------------------------------------------
+
+void operator delete(void* _pMemory, const std::nothrow_t&) noexcept
+{
+    free(_pMemory);
+}
+
+// -----------------------------------------------------------------------------
+
+void operator delete[](void* _pMemory, const std::nothrow_t&) noexcept
+{
+    free(_pMemory);
+}
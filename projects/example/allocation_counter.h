@@ -0,0 +1,12 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// Counts the heap allocations of the whole program. Linking allocation_counter
+// .cpp replaces the global operators new and delete by versions which forward
+// to malloc and free and increase a counter. Comparing the counter before and
+// after a frame shows whether the steady state allocates. Only the plain and
+// array operators are counted, not the over-aligned ones, and allocations with
+// malloc directly are not seen either.
+// -----------------------------------------------------------------------------
+unsigned long long GetNumberOfAllocations();
+unsigned long long GetNumberOfAllocatedBytes();
@@ -0,0 +1,295 @@
+
+#include "alpha_trim.h"
+
+#include "texture_file.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Points of the polygon are in texture space with y pointing up, so the
+    // usual counter-clockwise math applies.
+    // -----------------------------------------------------------------------------
+    struct SPoint
+    {
+        float m_X;
+        float m_Y;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    float GetCross(const SPoint& _rOrigin, const SPoint& _rA, const SPoint& _rB)
+    {
+        return (_rA.m_X - _rOrigin.m_X) * (_rB.m_Y - _rOrigin.m_Y) - (_rA.m_Y - _rOrigin.m_Y) * (_rB.m_X - _rOrigin.m_X);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Andrew's monotone chain, counter-clockwise without collinear points.
+    // -----------------------------------------------------------------------------
+    void GetConvexHull(std::vector<SPoint>& _rPoints, std::vector<SPoint>& _rHull)
+    {
+        std::sort(_rPoints.begin(), _rPoints.end(), [](const SPoint& _rLeft, const SPoint& _rRight)
+        {
+            return _rLeft.m_X < _rRight.m_X || (_rLeft.m_X == _rRight.m_X && _rLeft.m_Y < _rRight.m_Y);
+        });
+
+        _rHull.assign(_rPoints.size() * 2, SPoint());
+
+        size_t NumberOfPoints = 0;
+
+        for (size_t Index = 0; Index < _rPoints.size(); ++ Index)
+        {
+            while (NumberOfPoints >= 2 && GetCross(_rHull[NumberOfPoints - 2], _rHull[NumberOfPoints - 1], _rPoints[Index]) <= 0.0f) -- NumberOfPoints;
+
+            _rHull[NumberOfPoints ++] = _rPoints[Index];
+        }
+
+        for (size_t Index = _rPoints.size() - 1, Lower = NumberOfPoints + 1; Index > 0; -- Index)
+        {
+            while (NumberOfPoints >= Lower && GetCross(_rHull[NumberOfPoints - 2], _rHull[NumberOfPoints - 1], _rPoints[Index - 1]) <= 0.0f) -- NumberOfPoints;
+
+            _rHull[NumberOfPoints ++] = _rPoints[Index - 1];
+        }
+
+        _rHull.resize(NumberOfPoints - 1);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetArea(const std::vector<SPoint>& _rPolygon)
+    {
+        float Area = 0.0f;
+
+        for (size_t Index = 0; Index < _rPolygon.size(); ++ Index)
+        {
+            const SPoint& rA = _rPolygon[Index];
+            const SPoint& rB = _rPolygon[(Index + 1) % _rPolygon.size()];
+
+            Area += rA.m_X * rB.m_Y - rB.m_X * rA.m_Y;
+        }
+
+        return 0.5f * Area;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Marks the texels above the threshold, which belong to a group of at least
+    // the minimum number of texels connected by edges or corners.
+    // -----------------------------------------------------------------------------
+    void GetVisibleTexels(const SAlphaMask& _rMask, const STrimSettings& _rSettings, std::vector<unsigned char>& _rVisible)
+    {
+        int Width  = _rMask.m_Width;
+        int Height = _rMask.m_Height;
+
+        _rVisible.assign(_rMask.m_Alpha.size(), 0);
+
+        for (size_t Index = 0; Index < _rMask.m_Alpha.size(); ++ Index) _rVisible[Index] = _rMask.m_Alpha[Index] > _rSettings.m_AlphaThreshold ? 1 : 0;
+
+        if (_rSettings.m_MinimumNumberOfTexels <= 1) return;
+
+        // 1 is visible and not visited yet, 2 is visited
+        std::vector<int> Stack;
+        std::vector<int> Group;
+
+        for (int Start = 0; Start < Width * Height; ++ Start)
+        {
+            if (_rVisible[Start] != 1) continue;
+
+            Group.clear();
+            Stack.push_back(Start);
+
+            _rVisible[Start] = 2;
+
+            while (Stack.empty() == false)
+            {
+                int Texel = Stack.back();
+
+                Stack.pop_back();
+                Group.push_back(Texel);
+
+                int X = Texel % Width;
+                int Y = Texel / Width;
+
+                for (int NeighbourY = std::max(Y - 1, 0); NeighbourY <= std::min(Y + 1, Height - 1); ++ NeighbourY)
+                {
+                    for (int NeighbourX = std::max(X - 1, 0); NeighbourX <= std::min(X + 1, Width - 1); ++ NeighbourX)
+                    {
+                        int Neighbour = NeighbourY * Width + NeighbourX;
+
+                        if (_rVisible[Neighbour] != 1) continue;
+
+                        _rVisible[Neighbour] = 2;
+
+                        Stack.push_back(Neighbour);
+                    }
+                }
+            }
+
+            if (static_cast<int>(Group.size()) < _rSettings.m_MinimumNumberOfTexels)
+            {
+                for (int Texel : Group) _rVisible[Texel] = 0;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetQuad(STrimmedPolygon& _rPolygon)
+    {
+        static const float s_TexCoords[4][2] = { { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, 0.0f } };
+
+        _rPolygon.m_NumberOfVertices = 4;
+        _rPolygon.m_Area             = 1.0f;
+
+        memcpy(_rPolygon.m_TexCoords, s_TexCoords, sizeof(s_TexCoords));
+    }
+} // namespace
+
+bool ReadPngAlpha(const char* _pPath, SAlphaMask& _rMask)
+{
+    STextureImage Image;
+
+    if (ReadPng(_pPath, Image) == false) return false;
+
+    _rMask.m_Width  = Image.m_Width;
+    _rMask.m_Height = Image.m_Height;
+    _rMask.m_Alpha.resize(static_cast<size_t>(Image.m_Width) * Image.m_Height);
+
+    for (size_t Index = 0; Index < _rMask.m_Alpha.size(); ++ Index) _rMask.m_Alpha[Index] = Image.m_Pixels[Index * 4 + 3];
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void GetTrimmedPolygon(const SAlphaMask& _rMask, const STrimSettings& _rSettings, STrimmedPolygon& _rPolygon)
+{
+    int MaximumNumberOfVertices = std::min(std::max(_rSettings.m_MaximumNumberOfVertices, 4), STrimmedPolygon::s_MaximumNumberOfVertices);
+
+    SetQuad(_rPolygon);
+
+    if (_rMask.m_Width <= 0 || _rMask.m_Height <= 0) return;
+
+    std::vector<unsigned char> Visible;
+
+    GetVisibleTexels(_rMask, _rSettings, Visible);
+
+    // -----------------------------------------------------------------------------
+    // The hull of all visible texels is the hull of the outer corners of the
+    // leftmost and rightmost visible texel of each row.
+    // -----------------------------------------------------------------------------
+    float Width  = static_cast<float>(_rMask.m_Width);
+    float Height = static_cast<float>(_rMask.m_Height);
+
+    std::vector<SPoint> Points;
+
+    for (int Y = 0; Y < _rMask.m_Height; ++ Y)
+    {
+        const unsigned char* pRow = &Visible[static_cast<size_t>(Y) * _rMask.m_Width];
+
+        int Left  = 0;
+        int Right = _rMask.m_Width - 1;
+
+        while (Left <= Right && pRow[Left ] == 0) ++ Left;
+        while (Right > Left  && pRow[Right] == 0) -- Right;
+
+        if (Left > Right) continue;
+
+        float Padding = _rSettings.m_Padding;
+
+        float X0 = std::max(static_cast<float>(Left     ) - Padding, 0.0f) / Width;
+        float X1 = std::min(static_cast<float>(Right + 1) + Padding, Width ) / Width;
+        float Y0 = 1.0f - std::min(static_cast<float>(Y + 1) + Padding, Height) / Height;
+        float Y1 = 1.0f - std::max(static_cast<float>(Y    ) - Padding, 0.0f  ) / Height;
+
+        Points.push_back({ X0, Y0 });
+        Points.push_back({ X0, Y1 });
+        Points.push_back({ X1, Y0 });
+        Points.push_back({ X1, Y1 });
+    }
+
+    if (Points.empty()) return;
+
+    std::vector<SPoint> Polygon;
+
+    GetConvexHull(Points, Polygon);
+
+    // -----------------------------------------------------------------------------
+    // Remove the edge 'B C' whose neighbours 'A B' and 'D C' meet at a point P
+    // beyond B and C with the least area of the triangle 'B P C' added.
+    // -----------------------------------------------------------------------------
+    while (static_cast<int>(Polygon.size()) > MaximumNumberOfVertices)
+    {
+        size_t NumberOfPoints = Polygon.size();
+        size_t BestEdge       = NumberOfPoints;
+        float  BestArea       = 3.402823466e+38f;
+        SPoint BestPoint      = {};
+
+        for (size_t Index = 0; Index < NumberOfPoints; ++ Index)
+        {
+            const SPoint& rA = Polygon[(Index + NumberOfPoints - 1) % NumberOfPoints];
+            const SPoint& rB = Polygon[Index];
+            const SPoint& rC = Polygon[(Index + 1) % NumberOfPoints];
+            const SPoint& rD = Polygon[(Index + 2) % NumberOfPoints];
+
+            float DirectionAB[2] = { rB.m_X - rA.m_X, rB.m_Y - rA.m_Y };
+            float DirectionDC[2] = { rC.m_X - rD.m_X, rC.m_Y - rD.m_Y };
+            float DirectionBC[2] = { rC.m_X - rB.m_X, rC.m_Y - rB.m_Y };
+
+            float Denominator = DirectionAB[0] * DirectionDC[1] - DirectionAB[1] * DirectionDC[0];
+
+            if (fabsf(Denominator) < 1.0e-12f) continue;
+
+            float T = (DirectionBC[0] * DirectionDC[1] - DirectionBC[1] * DirectionDC[0]) / Denominator;
+            float S = (DirectionBC[0] * DirectionAB[1] - DirectionBC[1] * DirectionAB[0]) / Denominator;
+
+            if (T < 0.0f || S < 0.0f) continue;
+
+            SPoint P = { rB.m_X + T * DirectionAB[0], rB.m_Y + T * DirectionAB[1] };
+
+            if (P.m_X < -1.0e-6f || P.m_X > 1.0f + 1.0e-6f || P.m_Y < -1.0e-6f || P.m_Y > 1.0f + 1.0e-6f) continue;
+
+            float Area = 0.5f * fabsf(GetCross(rB, rC, P));
+
+            if (Area < BestArea)
+            {
+                BestEdge  = Index;
+                BestArea  = Area;
+                BestPoint = { std::min(std::max(P.m_X, 0.0f), 1.0f), std::min(std::max(P.m_Y, 0.0f), 1.0f) };
+            }
+        }
+
+        // The polygon cannot be cut down inside the texture, its bounding box can
+        if (BestEdge == NumberOfPoints)
+        {
+            SPoint Minimum = Polygon[0];
+            SPoint Maximum = Polygon[0];
+
+            for (const SPoint& rPoint : Polygon)
+            {
+                Minimum = { std::min(Minimum.m_X, rPoint.m_X), std::min(Minimum.m_Y, rPoint.m_Y) };
+                Maximum = { std::max(Maximum.m_X, rPoint.m_X), std::max(Maximum.m_Y, rPoint.m_Y) };
+            }
+
+            Polygon = { Minimum, { Maximum.m_X, Minimum.m_Y }, Maximum, { Minimum.m_X, Maximum.m_Y } };
+
+            break;
+        }
+
+        Polygon[BestEdge] = BestPoint;
+
+        Polygon.erase(Polygon.begin() + (BestEdge + 1) % NumberOfPoints);
+    }
+
+    _rPolygon.m_NumberOfVertices = static_cast<int>(Polygon.size());
+    _rPolygon.m_Area             = GetArea(Polygon);
+
+    for (size_t Index = 0; Index < Polygon.size(); ++ Index)
+    {
+        _rPolygon.m_TexCoords[Index][0] = Polygon[Index].m_X;
+        _rPolygon.m_TexCoords[Index][1] = 1.0f - Polygon[Index].m_Y;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// The alpha channel of a texture, one byte per texel row by row from the top.
+// -----------------------------------------------------------------------------
+struct SAlphaMask
+{
+    int                        m_Width;
+    int                        m_Height;
+    std::vector<unsigned char> m_Alpha;
+};
+
+// -----------------------------------------------------------------------------
+// A convex polygon enclosing the visible texels of a texture. The texture
+// coordinates run counter-clockwise in the orientation of the billboard quad,
+// i.e. with v pointing down the vertex 'u, v' is at '2u - 1, 1 - 2v'.
+// -----------------------------------------------------------------------------
+struct STrimmedPolygon
+{
+    static const int s_MaximumNumberOfVertices = 8;
+
+    int   m_NumberOfVertices;
+    float m_TexCoords[s_MaximumNumberOfVertices][2];
+    float m_Area;                                                       // Fraction of the texture covered by the polygon.
+};
+
+// -----------------------------------------------------------------------------
+// Reads the alpha channel of a non-interlaced PNG file with 8 bits per channel.
+// Images without alpha channel are read as opaque. Returns false for other
+// formats, e.g. palette images.
+// -----------------------------------------------------------------------------
+bool ReadPngAlpha(const char* _pPath, SAlphaMask& _rMask);
+
+// -----------------------------------------------------------------------------
+
+struct STrimSettings
+{
+    int   m_AlphaThreshold;                                             // Texels with a larger alpha are visible.
+    float m_Padding;                                                    // Texels added around the visible ones, which texture filtering still reaches.
+    int   m_MinimumNumberOfTexels;                                      // Smaller groups of connected visible texels are dust and ignored.
+    int   m_MaximumNumberOfVertices;                                    // 4 up to 8.
+};
+
+// -----------------------------------------------------------------------------
+// Computes a convex polygon enclosing all visible texels. The convex hull of
+// the texels is cut down edge by edge, each time removing the edge whose
+// neighbours meet with the least area added. The polygon stays inside the
+// texture, if it cannot be cut down to the number of vertices this way, it is
+// the bounding box of the texels. Without visible texels it is the full quad.
+// -----------------------------------------------------------------------------
+void GetTrimmedPolygon(const SAlphaMask& _rMask, const STrimSettings& _rSettings, STrimmedPolygon& _rPolygon);
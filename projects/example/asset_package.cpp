@@ -0,0 +1,484 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "asset_package.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace gfx;
+
+namespace
+{
+    unsigned int Align(unsigned int _Offset)
+    {
+        return (_Offset + SPackageHeader::s_Alignment - 1) & ~(SPackageHeader::s_Alignment - 1);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CopyName(char* _pDestination, size_t _Size, const char* _pSource)
+    {
+        memset(_pDestination, 0, _Size);
+
+        if (_pSource != nullptr) strncpy(_pDestination, _pSource, _Size - 1);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The sizes are computed in 64 bits by the callers: a count of the file
+    // times the size of an element cannot overflow them, the product of two
+    // counts is only formed after one of them has been limited.
+    // -----------------------------------------------------------------------------
+    bool IsInside(unsigned long long _Offset, unsigned long long _Size, size_t _FileSize)
+    {
+        return _Offset <= _FileSize && _Size <= _FileSize - _Offset && (_Offset % SPackageHeader::s_Alignment) == 0;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsCount(unsigned int _Count)
+    {
+        return _Count <= static_cast<unsigned int>(INT_MAX);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsIndex(int _Index, unsigned int _Count)
+    {
+        return _Index >= 0 && static_cast<unsigned int>(_Index) < _Count;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template<size_t TSize>
+    bool IsTerminated(const char (&_rText)[TSize])
+    {
+        return memchr(_rText, 0, TSize) != nullptr;
+    }
+} // namespace
+
+CAssetPackage::CAssetPackage()
+    : m_pData(nullptr)
+    , m_Size (0)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CAssetPackage::~CAssetPackage()
+{
+    Close();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CAssetPackage::Open(const char* _pPath)
+{
+    Close();
+
+    if (m_File.Open(_pPath) == false || m_File.GetSize() < sizeof(SPackageHeader))
+    {
+        Close();
+
+        return false;
+    }
+
+    m_pData = m_File.GetData();
+    m_Size  = m_File.GetSize();
+
+    if (Validate() == false)
+    {
+        Close();
+
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CAssetPackage::Close()
+{
+    m_File.Close();
+
+    m_pData = nullptr;
+    m_Size  = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CAssetPackage::IsOpen() const
+{
+    return m_pData != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackage::GetNumberOfMeshes() const
+{
+    return static_cast<int>(reinterpret_cast<const SPackageHeader*>(m_pData)->m_NumberOfMeshes);
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackage::GetNumberOfTextures() const
+{
+    return static_cast<int>(reinterpret_cast<const SPackageHeader*>(m_pData)->m_NumberOfTextures);
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackage::GetNumberOfMaterials() const
+{
+    return static_cast<int>(reinterpret_cast<const SPackageHeader*>(m_pData)->m_NumberOfMaterials);
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackage::GetNumberOfInstances() const
+{
+    return static_cast<int>(reinterpret_cast<const SPackageHeader*>(m_pData)->m_NumberOfInstances);
+}
+
+// -----------------------------------------------------------------------------
+
+const SPackageMesh& CAssetPackage::GetMesh(int _Index) const
+{
+    const SPackageHeader* pHeader = reinterpret_cast<const SPackageHeader*>(m_pData);
+
+    return reinterpret_cast<const SPackageMesh*>(m_pData + pHeader->m_MeshTableOffset)[_Index];
+}
+
+// -----------------------------------------------------------------------------
+
+const SPackageTexture& CAssetPackage::GetTexture(int _Index) const
+{
+    const SPackageHeader* pHeader = reinterpret_cast<const SPackageHeader*>(m_pData);
+
+    return reinterpret_cast<const SPackageTexture*>(m_pData + pHeader->m_TextureTableOffset)[_Index];
+}
+
+// -----------------------------------------------------------------------------
+
+const SPackageMaterial& CAssetPackage::GetMaterial(int _Index) const
+{
+    const SPackageHeader* pHeader = reinterpret_cast<const SPackageHeader*>(m_pData);
+
+    return reinterpret_cast<const SPackageMaterial*>(m_pData + pHeader->m_MaterialTableOffset)[_Index];
+}
+
+// -----------------------------------------------------------------------------
+
+const SPackageInstance& CAssetPackage::GetInstance(int _Index) const
+{
+    const SPackageHeader* pHeader = reinterpret_cast<const SPackageHeader*>(m_pData);
+
+    return reinterpret_cast<const SPackageInstance*>(m_pData + pHeader->m_InstanceTableOffset)[_Index];
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackage::FindMesh(const char* _pName) const
+{
+    for (int IndexOfMesh = 0; IndexOfMesh < GetNumberOfMeshes(); ++ IndexOfMesh)
+    {
+        if (strncmp(GetMesh(IndexOfMesh).m_Name, _pName, sizeof(SPackageMesh::m_Name)) == 0) return IndexOfMesh;
+    }
+
+    return -1;
+}
+
+// -----------------------------------------------------------------------------
+
+const float* CAssetPackage::GetVertices(int _IndexOfMesh) const
+{
+    return reinterpret_cast<const float*>(m_pData + GetMesh(_IndexOfMesh).m_VerticesOffset);
+}
+
+// -----------------------------------------------------------------------------
+
+const int* CAssetPackage::GetIndices(int _IndexOfMesh) const
+{
+    return reinterpret_cast<const int*>(m_pData + GetMesh(_IndexOfMesh).m_IndicesOffset);
+}
+
+// -----------------------------------------------------------------------------
+
+const void* CAssetPackage::GetTextureData(int _IndexOfTexture) const
+{
+    return m_pData + GetTexture(_IndexOfTexture).m_DataOffset;
+}
+
+// -----------------------------------------------------------------------------
+
+void CAssetPackage::GetMeshInfo(int _IndexOfMesh, BHandle _pMaterial, SMeshInfo& _rMeshInfo) const
+{
+    const SPackageMesh& rMesh = GetMesh(_IndexOfMesh);
+
+    _rMeshInfo.m_pVertices        = const_cast<float*>(GetVertices(_IndexOfMesh));
+    _rMeshInfo.m_NumberOfVertices = static_cast<int>(rMesh.m_NumberOfVertices);
+    _rMeshInfo.m_pIndices         = const_cast<int*>(GetIndices(_IndexOfMesh));
+    _rMeshInfo.m_NumberOfIndices  = static_cast<int>(rMesh.m_NumberOfIndices);
+    _rMeshInfo.m_pMaterial        = _pMaterial;
+}
+
+// -----------------------------------------------------------------------------
+
+void CAssetPackage::GetMaterialInfo(int _IndexOfMaterial, BHandle _pVertexShader, BHandle _pPixelShader, const BHandle* _pTextures, SMaterialInfo& _rMaterialInfo) const
+{
+    const SPackageMaterial& rMaterial = GetMaterial(_IndexOfMaterial);
+
+    _rMaterialInfo.m_NumberOfTextures = rMaterial.m_NumberOfTextures;
+
+    for (int IndexOfTexture = 0; IndexOfTexture < rMaterial.m_NumberOfTextures; ++ IndexOfTexture)
+    {
+        _rMaterialInfo.m_pTextures[IndexOfTexture] = _pTextures[rMaterial.m_IndicesOfTextures[IndexOfTexture]];
+    }
+
+    _rMaterialInfo.m_pVertexShader         = _pVertexShader;
+    _rMaterialInfo.m_pPixelShader          = _pPixelShader;
+    _rMaterialInfo.m_NumberOfInputElements = rMaterial.m_NumberOfInputElements;
+
+    for (int IndexOfElement = 0; IndexOfElement < rMaterial.m_NumberOfInputElements; ++ IndexOfElement)
+    {
+        _rMaterialInfo.m_InputElements[IndexOfElement].m_pName = rMaterial.m_InputElements[IndexOfElement].m_Name;
+        _rMaterialInfo.m_InputElements[IndexOfElement].m_Type  = static_cast<SInputElement::EType>(rMaterial.m_InputElements[IndexOfElement].m_Type);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CAssetPackage::Validate() const
+{
+    const SPackageHeader* pHeader = reinterpret_cast<const SPackageHeader*>(m_pData);
+
+    if (pHeader->m_Magic != SPackageHeader::s_Magic || pHeader->m_Version != SPackageHeader::s_Version) return false;
+
+    if (pHeader->m_Size != m_Size) return false;
+
+    // -----------------------------------------------------------------------------
+    // The getters return the counts as int.
+    // -----------------------------------------------------------------------------
+    if (!IsCount(pHeader->m_NumberOfMeshes) || !IsCount(pHeader->m_NumberOfTextures) || !IsCount(pHeader->m_NumberOfMaterials) || !IsCount(pHeader->m_NumberOfInstances)) return false;
+
+    if (IsInside(pHeader->m_MeshTableOffset    , static_cast<unsigned long long>(pHeader->m_NumberOfMeshes)    * sizeof(SPackageMesh)    , m_Size) == false) return false;
+    if (IsInside(pHeader->m_TextureTableOffset , static_cast<unsigned long long>(pHeader->m_NumberOfTextures)  * sizeof(SPackageTexture) , m_Size) == false) return false;
+    if (IsInside(pHeader->m_MaterialTableOffset, static_cast<unsigned long long>(pHeader->m_NumberOfMaterials) * sizeof(SPackageMaterial), m_Size) == false) return false;
+    if (IsInside(pHeader->m_InstanceTableOffset, static_cast<unsigned long long>(pHeader->m_NumberOfInstances) * sizeof(SPackageInstance), m_Size) == false) return false;
+
+    // -----------------------------------------------------------------------------
+    // Check the blobs, the counts, and the indices once on opening, so the
+    // getters do not have to. The floats per vertex are limited to the 16 input
+    // elements of YoshiX with four floats each before they are multiplied.
+    // -----------------------------------------------------------------------------
+    for (int IndexOfMesh = 0; IndexOfMesh < GetNumberOfMeshes(); ++ IndexOfMesh)
+    {
+        const SPackageMesh& rMesh = GetMesh(IndexOfMesh);
+
+        if (!IsTerminated(rMesh.m_Name)) return false;
+
+        if (!IsCount(rMesh.m_NumberOfVertices) || !IsCount(rMesh.m_NumberOfIndices) || rMesh.m_NumberOfFloatsPerVertex > 64) return false;
+
+        unsigned long long NumberOfFloats = static_cast<unsigned long long>(rMesh.m_NumberOfVertices) * rMesh.m_NumberOfFloatsPerVertex;
+
+        if (IsInside(rMesh.m_VerticesOffset, NumberOfFloats * sizeof(float)                                            , m_Size) == false) return false;
+        if (IsInside(rMesh.m_IndicesOffset , static_cast<unsigned long long>(rMesh.m_NumberOfIndices) * sizeof(int), m_Size) == false) return false;
+
+        if (rMesh.m_IndexOfMaterial != -1 && !IsIndex(rMesh.m_IndexOfMaterial, pHeader->m_NumberOfMaterials)) return false;
+    }
+
+    for (int IndexOfTexture = 0; IndexOfTexture < GetNumberOfTextures(); ++ IndexOfTexture)
+    {
+        const SPackageTexture& rTexture = GetTexture(IndexOfTexture);
+
+        if (!IsTerminated(rTexture.m_Name) || !IsTerminated(rTexture.m_Path)) return false;
+
+        if (rTexture.m_Format > SPackageTextureFormat::PNG) return false;
+
+        if (IsInside(rTexture.m_DataOffset, rTexture.m_DataSize, m_Size) == false) return false;
+    }
+
+    for (int IndexOfMaterial = 0; IndexOfMaterial < GetNumberOfMaterials(); ++ IndexOfMaterial)
+    {
+        const SPackageMaterial& rMaterial = GetMaterial(IndexOfMaterial);
+
+        if (!IsTerminated(rMaterial.m_Name) || !IsTerminated(rMaterial.m_ShaderPath) || !IsTerminated(rMaterial.m_VertexShader) || !IsTerminated(rMaterial.m_PixelShader)) return false;
+
+        if (rMaterial.m_NumberOfTextures      < 0 || rMaterial.m_NumberOfTextures      > SPackageMaterial::s_MaxNumberOfTextures     ) return false;
+        if (rMaterial.m_NumberOfInputElements < 0 || rMaterial.m_NumberOfInputElements > SPackageMaterial::s_MaxNumberOfInputElements) return false;
+
+        for (int IndexOfTexture = 0; IndexOfTexture < rMaterial.m_NumberOfTextures; ++ IndexOfTexture)
+        {
+            if (!IsIndex(rMaterial.m_IndicesOfTextures[IndexOfTexture], pHeader->m_NumberOfTextures)) return false;
+        }
+
+        for (int IndexOfElement = 0; IndexOfElement < rMaterial.m_NumberOfInputElements; ++ IndexOfElement)
+        {
+            const SPackageInputElement& rElement = rMaterial.m_InputElements[IndexOfElement];
+
+            if (!IsTerminated(rElement.m_Name) || rElement.m_Type < SInputElement::SInt1 || rElement.m_Type > SInputElement::Float4) return false;
+        }
+    }
+
+    for (int IndexOfInstance = 0; IndexOfInstance < GetNumberOfInstances(); ++ IndexOfInstance)
+    {
+        if (!IsIndex(GetInstance(IndexOfInstance).m_IndexOfMesh, pHeader->m_NumberOfMeshes)) return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackageWriter::AddMesh(const char* _pName, const float* _pVertices, int _NumberOfVertices, int _NumberOfFloatsPerVertex, const int* _pIndices, int _NumberOfIndices, int _IndexOfMaterial)
+{
+    SMeshData Data;
+
+    memset(&Data.m_Mesh, 0, sizeof(Data.m_Mesh));
+
+    CopyName(Data.m_Mesh.m_Name, sizeof(Data.m_Mesh.m_Name), _pName);
+
+    Data.m_Mesh.m_NumberOfVertices        = static_cast<unsigned int>(_NumberOfVertices);
+    Data.m_Mesh.m_NumberOfFloatsPerVertex = static_cast<unsigned int>(_NumberOfFloatsPerVertex);
+    Data.m_Mesh.m_NumberOfIndices         = static_cast<unsigned int>(_NumberOfIndices);
+    Data.m_Mesh.m_IndexOfMaterial         = _IndexOfMaterial;
+
+    Data.m_Vertices.assign(_pVertices, _pVertices + _NumberOfVertices * _NumberOfFloatsPerVertex);
+    Data.m_Indices .assign(_pIndices , _pIndices  + _NumberOfIndices);
+
+    m_Meshes.push_back(Data);
+
+    return static_cast<int>(m_Meshes.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackageWriter::AddTexture(const char* _pName, const char* _pPath, SPackageTextureFormat::EFormat _Format, const void* _pData, int _DataSize)
+{
+    STextureData Data;
+
+    memset(&Data.m_Texture, 0, sizeof(Data.m_Texture));
+
+    CopyName(Data.m_Texture.m_Name, sizeof(Data.m_Texture.m_Name), _pName);
+    CopyName(Data.m_Texture.m_Path, sizeof(Data.m_Texture.m_Path), _pPath);
+
+    Data.m_Texture.m_Format   = static_cast<unsigned int>(_Format);
+    Data.m_Texture.m_DataSize = static_cast<unsigned int>(_DataSize);
+
+    Data.m_Data.assign(static_cast<const char*>(_pData), static_cast<const char*>(_pData) + _DataSize);
+
+    m_Textures.push_back(Data);
+
+    return static_cast<int>(m_Textures.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackageWriter::AddMaterial(const SPackageMaterial& _rMaterial)
+{
+    m_Materials.push_back(_rMaterial);
+
+    return static_cast<int>(m_Materials.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+int CAssetPackageWriter::AddInstance(int _IndexOfMesh, const float* _pWorldMatrix)
+{
+    SPackageInstance Instance;
+
+    Instance.m_IndexOfMesh = _IndexOfMesh;
+
+    memcpy(Instance.m_WorldMatrix, _pWorldMatrix, sizeof(Instance.m_WorldMatrix));
+
+    m_Instances.push_back(Instance);
+
+    return static_cast<int>(m_Instances.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CAssetPackageWriter::Write(const char* _pPath) const
+{
+    // -----------------------------------------------------------------------------
+    // Lay out the file first, then copy everything into one buffer and write it
+    // with a single call.
+    // -----------------------------------------------------------------------------
+    SPackageHeader Header;
+
+    memset(&Header, 0, sizeof(Header));
+
+    Header.m_Magic             = SPackageHeader::s_Magic;
+    Header.m_Version           = SPackageHeader::s_Version;
+    Header.m_NumberOfMeshes    = static_cast<unsigned int>(m_Meshes   .size());
+    Header.m_NumberOfTextures  = static_cast<unsigned int>(m_Textures .size());
+    Header.m_NumberOfMaterials = static_cast<unsigned int>(m_Materials.size());
+    Header.m_NumberOfInstances = static_cast<unsigned int>(m_Instances.size());
+
+    unsigned int Offset = Align(sizeof(Header));
+
+    Header.m_MeshTableOffset     = Offset; Offset = Align(Offset + Header.m_NumberOfMeshes    * sizeof(SPackageMesh));
+    Header.m_TextureTableOffset  = Offset; Offset = Align(Offset + Header.m_NumberOfTextures  * sizeof(SPackageTexture));
+    Header.m_MaterialTableOffset = Offset; Offset = Align(Offset + Header.m_NumberOfMaterials * sizeof(SPackageMaterial));
+    Header.m_InstanceTableOffset = Offset; Offset = Align(Offset + Header.m_NumberOfInstances * sizeof(SPackageInstance));
+
+    std::vector<SPackageMesh>    Meshes;
+    std::vector<SPackageTexture> Textures;
+
+    for (const SMeshData& rData : m_Meshes)
+    {
+        SPackageMesh Mesh = rData.m_Mesh;
+
+        Mesh.m_VerticesOffset = Offset; Offset = Align(Offset + static_cast<unsigned int>(rData.m_Vertices.size() * sizeof(float)));
+        Mesh.m_IndicesOffset  = Offset; Offset = Align(Offset + static_cast<unsigned int>(rData.m_Indices .size() * sizeof(int)));
+
+        Meshes.push_back(Mesh);
+    }
+
+    for (const STextureData& rData : m_Textures)
+    {
+        SPackageTexture Texture = rData.m_Texture;
+
+        Texture.m_DataOffset = Offset; Offset = Align(Offset + Texture.m_DataSize);
+
+        Textures.push_back(Texture);
+    }
+
+    Header.m_Size = Offset;
+
+    std::vector<char> Buffer(Offset, 0);
+
+    memcpy(&Buffer[0], &Header, sizeof(Header));
+
+    if (Meshes    .empty() == false) memcpy(&Buffer[Header.m_MeshTableOffset    ], Meshes     .data(), Meshes     .size() * sizeof(SPackageMesh));
+    if (Textures  .empty() == false) memcpy(&Buffer[Header.m_TextureTableOffset ], Textures   .data(), Textures   .size() * sizeof(SPackageTexture));
+    if (m_Materials.empty() == false) memcpy(&Buffer[Header.m_MaterialTableOffset], m_Materials.data(), m_Materials.size() * sizeof(SPackageMaterial));
+    if (m_Instances.empty() == false) memcpy(&Buffer[Header.m_InstanceTableOffset], m_Instances.data(), m_Instances.size() * sizeof(SPackageInstance));
+
+    for (size_t IndexOfMesh = 0; IndexOfMesh < Meshes.size(); ++ IndexOfMesh)
+    {
+        const SMeshData& rData = m_Meshes[IndexOfMesh];
+
+        if (rData.m_Vertices.empty() == false) memcpy(&Buffer[Meshes[IndexOfMesh].m_VerticesOffset], rData.m_Vertices.data(), rData.m_Vertices.size() * sizeof(float));
+        if (rData.m_Indices .empty() == false) memcpy(&Buffer[Meshes[IndexOfMesh].m_IndicesOffset ], rData.m_Indices .data(), rData.m_Indices .size() * sizeof(int));
+    }
+
+    for (size_t IndexOfTexture = 0; IndexOfTexture < Textures.size(); ++ IndexOfTexture)
+    {
+        const STextureData& rData = m_Textures[IndexOfTexture];
+
+        if (rData.m_Data.empty() == false) memcpy(&Buffer[Textures[IndexOfTexture].m_DataOffset], rData.m_Data.data(), rData.m_Data.size());
+    }
+
+    FILE* pFile = fopen(_pPath, "wb");
+
+    if (pFile == nullptr) return false;
+
+    bool IsWritten = fwrite(Buffer.data(), 1, Buffer.size(), pFile) == Buffer.size();
+
+    fclose(pFile);
+
+    return IsWritten;
+}
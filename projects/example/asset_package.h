@@ -0,0 +1,205 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "yoshix.h"
+
+#include <stddef.h>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Layout of a binary asset package. The file starts with the header, followed
+// by the mesh, texture, material, and instance tables and the data blobs. All
+// tables and blobs start at a multiple of 'SPackageHeader::s_Alignment', so
+// vertices and indices can be passed to 'CreateMesh' directly from the mapped
+// file. Offsets are measured from the start of the file. Increase the version
+// whenever one of the structures below changes.
+// -----------------------------------------------------------------------------
+struct SPackageHeader
+{
+    static const unsigned int s_Magic     = 0x4B505859;                 // "YXPK" in little endian.
+    static const unsigned int s_Version   = 1;
+    static const unsigned int s_Alignment = 64;
+
+    unsigned int m_Magic;                                               // Has to be 's_Magic'.
+    unsigned int m_Version;                                             // Has to be 's_Version'.
+    unsigned int m_Size;                                                // Size of the complete file in bytes.
+    unsigned int m_NumberOfMeshes;
+    unsigned int m_NumberOfTextures;
+    unsigned int m_NumberOfMaterials;
+    unsigned int m_NumberOfInstances;
+    unsigned int m_MeshTableOffset;
+    unsigned int m_TextureTableOffset;
+    unsigned int m_MaterialTableOffset;
+    unsigned int m_InstanceTableOffset;
+};
+
+// -----------------------------------------------------------------------------
+
+struct SPackageMesh
+{
+    char         m_Name[32];                                            // Zero terminated name, e.g. the file name without extension.
+    unsigned int m_VerticesOffset;                                      // Offset of the interleaved float vertices.
+    unsigned int m_NumberOfVertices;
+    unsigned int m_NumberOfFloatsPerVertex;
+    unsigned int m_IndicesOffset;                                       // Offset of the int indices, three per triangle.
+    unsigned int m_NumberOfIndices;
+    int          m_IndexOfMaterial;                                     // The material of the mesh or -1.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SPackageTextureFormat
+{
+    enum EFormat
+    {
+        DDS,                                                            ///< The blob is a complete DDS file.
+        PNG,                                                            ///< The blob is a complete PNG file.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// YoshiX only creates textures from files, so the path of the original file is
+// kept next to the blob.
+// -----------------------------------------------------------------------------
+struct SPackageTexture
+{
+    char         m_Name[32];
+    char         m_Path[128];                                           // Path of the texture file relative to the binaries.
+    unsigned int m_Format;                                              // One of 'SPackageTextureFormat::EFormat'.
+    unsigned int m_DataOffset;
+    unsigned int m_DataSize;
+};
+
+// -----------------------------------------------------------------------------
+
+struct SPackageInputElement
+{
+    char m_Name[16];                                                    // Semantic name, e.g. "POSITION".
+    int  m_Type;                                                        // One of 'gfx::SInputElement::EType'.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SPackageMaterial
+{
+    static const int s_MaxNumberOfTextures      = 4;
+    static const int s_MaxNumberOfInputElements = 8;
+
+    char                 m_Name[32];
+    char                 m_ShaderPath[64];                              // Path of the effect file relative to the binaries.
+    char                 m_VertexShader[32];                            // Name of the vertex shader function.
+    char                 m_PixelShader[32];                             // Name of the pixel shader function.
+    int                  m_NumberOfTextures;
+    int                  m_IndicesOfTextures[s_MaxNumberOfTextures];
+    int                  m_NumberOfInputElements;
+    SPackageInputElement m_InputElements[s_MaxNumberOfInputElements];
+};
+
+// -----------------------------------------------------------------------------
+
+struct SPackageInstance
+{
+    int   m_IndexOfMesh;
+    float m_WorldMatrix[16];
+};
+
+// -----------------------------------------------------------------------------
+// Read only view on a package. The file is mapped into memory, nothing is
+// parsed or copied. All returned pointers are valid until 'Close' is called.
+// -----------------------------------------------------------------------------
+class CAssetPackage
+{
+    public:
+
+        CAssetPackage();
+        ~CAssetPackage();
+
+    private:
+
+        CAssetPackage(const CAssetPackage&);
+        CAssetPackage& operator = (const CAssetPackage&);
+
+    public:
+
+        bool Open(const char* _pPath);
+        void Close();
+
+        bool IsOpen() const;
+
+    public:
+
+        int GetNumberOfMeshes() const;
+        int GetNumberOfTextures() const;
+        int GetNumberOfMaterials() const;
+        int GetNumberOfInstances() const;
+
+        const SPackageMesh&     GetMesh(int _Index) const;
+        const SPackageTexture&  GetTexture(int _Index) const;
+        const SPackageMaterial& GetMaterial(int _Index) const;
+        const SPackageInstance& GetInstance(int _Index) const;
+
+        int  FindMesh(const char* _pName) const;
+
+        const float* GetVertices(int _IndexOfMesh) const;
+        const int*   GetIndices(int _IndexOfMesh) const;
+        const void*  GetTextureData(int _IndexOfTexture) const;
+
+        // -----------------------------------------------------------------------------
+        // Fills the mesh info with pointers into the mapped file. 'CreateMesh' does
+        // not write to the vertices and indices, the casts only satisfy its interface.
+        // -----------------------------------------------------------------------------
+        void GetMeshInfo(int _IndexOfMesh, gfx::BHandle _pMaterial, gfx::SMeshInfo& _rMeshInfo) const;
+
+        // -----------------------------------------------------------------------------
+        // Fills the material info with shaders, textures, and input elements of the
+        // package material. Constant buffers are left to the caller.
+        // -----------------------------------------------------------------------------
+        void GetMaterialInfo(int _IndexOfMaterial, gfx::BHandle _pVertexShader, gfx::BHandle _pPixelShader, const gfx::BHandle* _pTextures, gfx::SMaterialInfo& _rMaterialInfo) const;
+
+    private:
+
+        bool Validate() const;
+
+    private:
+
+        CMappedFile m_File;
+        const char* m_pData;                                            // Start of the mapped file.
+        size_t      m_Size;                                             // Size of the mapped file in bytes.
+};
+
+// -----------------------------------------------------------------------------
+// Collects assets in memory and writes them as package. Used by the packer.
+// -----------------------------------------------------------------------------
+class CAssetPackageWriter
+{
+    public:
+
+        int  AddMesh(const char* _pName, const float* _pVertices, int _NumberOfVertices, int _NumberOfFloatsPerVertex, const int* _pIndices, int _NumberOfIndices, int _IndexOfMaterial);
+        int  AddTexture(const char* _pName, const char* _pPath, SPackageTextureFormat::EFormat _Format, const void* _pData, int _DataSize);
+        int  AddMaterial(const SPackageMaterial& _rMaterial);
+        int  AddInstance(int _IndexOfMesh, const float* _pWorldMatrix);
+
+        bool Write(const char* _pPath) const;
+
+    private:
+
+        struct SMeshData
+        {
+            SPackageMesh       m_Mesh;
+            std::vector<float> m_Vertices;
+            std::vector<int>   m_Indices;
+        };
+
+        struct STextureData
+        {
+            SPackageTexture   m_Texture;
+            std::vector<char> m_Data;
+        };
+
+    private:
+
+        std::vector<SMeshData>        m_Meshes;
+        std::vector<STextureData>     m_Textures;
+        std::vector<SPackageMaterial> m_Materials;
+        std::vector<SPackageInstance> m_Instances;
+};
@@ -1,8 +1,29 @@
 
 #include "yoshix.h"
 
+#include "allocation_counter.h"
+#include "alpha_trim.h"
+#include "billboard_scene.h"
+#include "camera.h"
+#include "depth_prepass.h"
+#include "depth_rasterizer.h"
+#include "fixed_step.h"
+#include "frame_arena.h"
+#include "frame_pipeline.h"
+#include "gfx_resources.h"
+#include "hot_reload.h"
+#include "log.h"
+#include "scene_store.h"
+#include "static_batch.h"
+#include "terrain.h"
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <atomic>
 #include <math.h>
-#include <iostream>
+#include <string.h>
+#include <string>
+#include <vector>
 
 // To change the text align
 enum Position { LEFT, CENTRE, RIGHT };
@@ -10,18 +31,22 @@ enum Position { LEFT, CENTRE, RIGHT };
 // The line lingth in the console
 int constexpr LINE_LENGTH = 119;
 std::string const HEADER(LINE_LENGTH, '=');
+std::string const SPACES(LINE_LENGTH, ' ');
 
-// Set the Text Align in console
-void Print(Position _Position, std::string _Text, int _Linelength)
+// Set the Text Align in console, the line is written by the thread of the log
+void Print(Position _Position, const char* _pText, int _Linelength)
 {
 	int spaces = 0;
+	int length = static_cast<int>(strlen(_pText));
 	switch (_Position)
 	{
-	case CENTRE: spaces = (_Linelength - _Text.size()) / 2; break;
-	case RIGHT: spaces = _Linelength - _Text.size(); break;
+	case CENTRE: spaces = (_Linelength - length) / 2; break;
+	case RIGHT: spaces = _Linelength - length; break;
 	}
-	if (spaces > 0) std::cout << std::string(spaces, ' ');
-	std::cout << _Text << '\n';
+	if (spaces < 0) spaces = 0;
+	if (spaces > LINE_LENGTH) spaces = LINE_LENGTH;
+	// The indent is the end of a line of spaces, so no string is built for it
+	LOG(Console, Info, "{}{}", SPACES.c_str() + LINE_LENGTH - spaces, _pText);
 }
 
 using namespace gfx;
@@ -56,6 +81,15 @@ struct SGroundBuffer
 	float m_ViewProjectionMatrix[16];
 	float m_WorldMatrix[16];
 };
+
+class CApplication;
+
+// One wall billboard rendered through the depth pre-pass
+struct SWallDraw
+{
+	CApplication* m_pApplication;
+	float m_Position[3];
+};
 // -----------------------------------------------------------------------------
 
 class CApplication : public IApplication
@@ -69,44 +103,134 @@ private:
 
 
 	float   m_FieldOfViewY;                  // Vertical view angle of the camera
-	float   m_ViewMatrix[16];                // The view matrix to transform a mesh from world space into view space.
-	float   m_ProjectionMatrix[16];          // The projection matrix to transform a mesh from view space into clip space.
+	CCamera m_Camera;                        // Set by the build thread, the projection only while the pipeline is stopped.
+
+	CGfxResources m_Resources;               // Owns the YoshiX objects below, the members only keep handles into its pools.
 
-	BHandle m_pVertexConstantBuffer;         // A pointer to a YoshiX constant buffer, which defines global data for a vertex shader.
-	BHandle m_pPixelConstantBuffer;		     // A pointer to a YoshiX constant buffer, which defines global data for a pixel shader.
+	SConstantBufferHandle m_VertexConstantBuffer;       // A handle of a YoshiX constant buffer, which defines global data for a vertex shader.
+	SConstantBufferHandle m_PixelConstantBuffer;        // A handle of a YoshiX constant buffer, which defines global data for a pixel shader.
 
-	BHandle m_pVertexShader;                 // A pointer to a YoshiX vertex shader, which processes each single vertex of the mesh.
-	BHandle m_pPixelShader;                  // A pointer to a YoshiX pixel shader, which computes the color of each pixel visible of the mesh on the screen.
+	SVertexShaderHandle m_VertexShader;                 // A handle of a YoshiX vertex shader, which processes each single vertex of the mesh.
+	SPixelShaderHandle m_PixelShader;                   // A handle of a YoshiX pixel shader, which computes the color of each pixel visible of the mesh on the screen.
 
-	BHandle m_pMaterial;                     // A pointer to a YoshiX material, spawning the surface of the mesh.
-	BHandle m_pMesh;                         // A pointer to a YoshiX mesh, which represents a single triangle.
+	SMaterialHandle m_Material;                         // A handle of a YoshiX material, spawning the surface of the mesh.
+	SMeshHandle m_Mesh;                                 // A handle of a YoshiX mesh, which represents a single triangle.
 
-	BHandle m_pColorTexture;                 //  A pointer to a texture that has a tree image to display.
-	BHandle m_pNormalTexture;			     //  A pointer to a texture that has a normal for a tree image.
+	STextureHandle m_ColorTexture;                      // A handle of a texture that has a tree image to display.
+	STextureHandle m_NormalTexture;                     // A handle of a texture that has a normal for a tree image.
 
-	BHandle m_pMaterialWall;                 // A pointer to a YoshiX material, spawning the surface of the mesh.
-	BHandle m_pMeshWall;                     // A pointer to a YoshiX mesh, which represents a single triangle.
+	SMaterialHandle m_MaterialWall;                     // A handle of a YoshiX material, spawning the surface of the mesh.
+	SMeshHandle m_MeshWall;                             // A handle of a YoshiX mesh, which represents a single triangle.
 
-	BHandle m_pColorTextureWall;             //  A pointer to a texture that has a wall image to display.
-	BHandle m_pNormalTextureWall;			 //  A pointer to a texture that has a normal for a wall image.
+	STextureHandle m_ColorTextureWall;                  // A handle of a texture that has a wall image to display.
+	STextureHandle m_NormalTextureWall;                 // A handle of a texture that has a normal for a wall image.
 
 	// Ground
-	BHandle m_pGroundVertexConstantBuffer;
-	BHandle m_pGroundVertexShader;
-	BHandle m_pGroundPixelShader;
-	BHandle m_pGroundMaterial;
-	BHandle m_pGroundMesh;
-	BHandle m_pGroundTexture;
+	SConstantBufferHandle m_GroundVertexConstantBuffer;
+	SVertexShaderHandle m_GroundVertexShader;
+	SPixelShaderHandle m_GroundPixelShader;
+	SMaterialHandle m_GroundMaterial;
+	SMeshHandle m_GroundMesh;
+	STextureHandle m_GroundTexture;
+
+	// Depth pre-pass of the opaque objects (ground and walls)
+	CDepthPrepass m_DepthPrepass;
+	SVertexShaderHandle m_DepthVertexShader;            // Position-only billboard vertex shader for the depth pass.
+	SMaterialHandle m_DepthMaterialWall;
+	SMeshHandle m_DepthMeshWall;
+	SMaterialHandle m_GroundDepthMaterial;
+	SMeshHandle m_GroundDepthMesh;
+	SWallDraw m_WallDraws[billboard_scene::s_NumberOfWalls];
+
+	// The terrain replaces the ground quad if its file exists. The chunks around
+	// the camera are built by jobs and drawn with the ground material.
+	CTerrain m_Terrain;
+	bool m_HasTerrain = false;
+
+	// The walls share one material, so they are merged into static batches with
+	// the wall positions in the vertices. Each batch is one draw instead of one
+	// draw per wall.
+	CStaticBatcher m_StaticWalls;
+	SVertexShaderHandle m_BatchedVertexShader;
+	SVertexShaderHandle m_BatchedDepthVertexShader;
+	SMaterialHandle m_BatchedMaterialWall;
+	SMaterialHandle m_BatchedDepthMaterialWall;
+	std::vector<SMeshHandle> m_WallBatchMeshes;
+	std::vector<SMeshHandle> m_WallBatchDepthMeshes;
+	bool m_IsBatching = true;
+
+	// If the atlas tool wrote an atlas with the wall, the batches of the walls are
+	// drawn from its page with the rect of the wall in the vertices
+	bool m_HasWallAtlas = false;
+	float m_WallAtlasRect[4];
+	STextureHandle m_ColorTextureWallAtlas;
+	STextureHandle m_NormalTextureWallAtlas;
+	SVertexShaderHandle m_AtlasVertexShader;
+	int m_NumberOfWallDrawCalls = 0;         // Draw calls of the walls in the last frame.
+
+	// Software depth buffer with the opaque objects to cull hidden trees
+	CDepthRasterizer m_DepthRasterizer;
+	bool m_IsReversedZ = true;
+
+	// The trees, culled against the view frustum and sorted back to front each frame
+	CSceneStore m_Trees;
+
+	unsigned long long m_NumberOfFrameAllocations = 0;   // Heap allocations of the last frame.
+
+	// Rebuilds the objects of changed shader and texture files in the data directory
+	CHotReload m_HotReload;
+
+	// The camera of the frame which is drawn, blended from the last two states of
+	// the camera simulation
+	const SCameraSnapshot* m_pFrameCamera = nullptr;
+
+	// The camera is simulated at a fixed rate on its own thread. The keys only set
+	// the direction of the movement, so the speed does not depend on the frame rate
+	// or on the key repeat rate.
+	struct SCameraState
+	{
+		float m_Angle;
+		float m_Radius;
+		float m_Height;
+	};
 
-	// Camera Position
-	float m_eyePosX = 0.0f;
-	float m_eyePosY = 0.0f;
-	float m_eyePosZ = 0.0f;
+	float m_Speed = 1.2f;                    // Radians or units per second while a key is held.
+	std::atomic<int> m_AngleDirection{ 0 };
+	std::atomic<int> m_RadiusDirection{ 0 };
+	std::atomic<int> m_HeightDirection{ 0 };
+	TFixedStepLoop<SCameraState> m_CameraLoop;
+
+	// The next frames are built on a worker thread while the current one is drawn:
+	// camera, software depth buffer, culling, and sorting of the trees. Each frame
+	// in flight has its own slot with the results and the memory of its lists, so
+	// the steady state of a frame does not allocate.
+	struct SFrame
+	{
+		SFrame() : m_Arena(64 * 1024) {}
+
+		SCameraSnapshot m_Camera;            // Copy of the camera, does not change while the frame is drawn.
+		float* m_pTreePositions;             // Three floats per visible tree, back to front.
+		int m_NumberOfTrees;
+		SStaticDraw* m_pWallDraws;           // The visible ranges of the wall batches.
+		int m_NumberOfWallDraws;
+		CFrameArena m_Arena;
+	};
 
+	// The arena of the last drawn frame as it was when the frame was drawn. Its
+	// slot is built again right after, so the arena itself may already belong to
+	// a newer frame.
+	struct SArenaStatistics
+	{
+		size_t m_UsedSize;
+		size_t m_Capacity;
+		size_t m_PeakSize;
+		int m_NumberOfFailedAllocations;
+	};
 
-	float m_Step = 0.04f;
-	float m_angle = 4.7f;
-	float radius = 8.0f;
+	SFrame m_Frames[CFramePipeline::s_MaximumNumberOfFramesInFlight];
+	SArenaStatistics m_LastFrameArena = {};
+	int m_NumberOfFramesInFlight = 3;
+	CFramePipeline m_FramePipeline;
 
 
 private:
@@ -125,6 +249,18 @@ private:
 	virtual bool InternOnFrame();
 	virtual bool InternOnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown);
 	virtual bool DrawObject(BHandle material, float pos[3]);
+	void UploadObject(float pos[3]);
+	void UploadGround();
+
+	void BuildFrame(SFrame& _rFrame);
+
+	static void UploadWallConstants(void* _pUserData);
+	static void UploadGroundConstants(void* _pUserData);
+	static void UploadBatchConstants(void* _pUserData);
+	static void CreateTerrainMesh(STerrainChunk& _rChunk, void* _pUserData);
+	static void ReleaseTerrainMesh(STerrainChunk& _rChunk, void* _pUserData);
+	static void StepCamera(SCameraState& _rState, float _StepTime, void* _pUserData);
+	static void BuildFrameData(int _IndexOfFrame, void* _pUserData);
 
 };
 
@@ -134,36 +270,69 @@ private:
 // -----------------------------------------------------------------------------
 
 CApplication::CApplication()
-	: m_FieldOfViewY(60.0f)        // Set the vertical view angle of the camera to 60 degrees.
-	, m_pVertexConstantBuffer(nullptr)
-	, m_pPixelConstantBuffer(nullptr)
-
-	, m_pVertexShader(nullptr)
-	, m_pPixelShader(nullptr)
-
-	, m_pColorTexture(nullptr)
-	, m_pNormalTexture(nullptr)
-	, m_pMaterial(nullptr)
-	, m_pMesh(nullptr)
-
-	, m_pColorTextureWall(nullptr)
-	, m_pNormalTextureWall(nullptr)
-	, m_pMaterialWall(nullptr)
-	, m_pMeshWall(nullptr)
-
-	, m_pGroundVertexConstantBuffer(nullptr)
-	, m_pGroundVertexShader(nullptr)
-	, m_pGroundPixelShader(nullptr)
-	, m_pGroundTexture(nullptr)
-	, m_pGroundMesh(nullptr)
-	, m_pGroundMaterial(nullptr)
+	: m_FieldOfViewY(billboard_scene::s_FieldOfViewY)        // Set the vertical view angle of the camera to 60 degrees.
+	, m_VertexConstantBuffer()
+	, m_PixelConstantBuffer()
+
+	, m_VertexShader()
+	, m_PixelShader()
+
+	, m_ColorTexture()
+	, m_NormalTexture()
+	, m_Material()
+	, m_Mesh()
+
+	, m_ColorTextureWall()
+	, m_NormalTextureWall()
+	, m_MaterialWall()
+	, m_MeshWall()
+
+	, m_GroundVertexConstantBuffer()
+	, m_GroundVertexShader()
+	, m_GroundPixelShader()
+	, m_GroundTexture()
+	, m_GroundMesh()
+	, m_GroundMaterial()
+
+	, m_DepthVertexShader()
+	, m_DepthMaterialWall()
+	, m_DepthMeshWall()
+	, m_GroundDepthMaterial()
+	, m_GroundDepthMesh()
+
+	, m_BatchedVertexShader()
+	, m_BatchedDepthVertexShader()
+	, m_BatchedMaterialWall()
+	, m_BatchedDepthMaterialWall()
+
+	, m_ColorTextureWallAtlas()
+	, m_NormalTextureWallAtlas()
+	, m_AtlasVertexShader()
 {
+	// The three walls behind the trees
+	for (int IndexOfWall = 0; IndexOfWall < billboard_scene::s_NumberOfWalls; ++IndexOfWall)
+	{
+		m_WallDraws[IndexOfWall].m_pApplication = this;
+		m_WallDraws[IndexOfWall].m_Position[0] = billboard_scene::s_WallPositions[IndexOfWall][0];
+		m_WallDraws[IndexOfWall].m_Position[1] = billboard_scene::s_WallPositions[IndexOfWall][1];
+		m_WallDraws[IndexOfWall].m_Position[2] = billboard_scene::s_WallPositions[IndexOfWall][2];
+	}
+
+	// Watch the shaders and images, changed files are loaded again while running
+	m_HotReload.Start("..\\data");
+
+	// Simulate the camera with 120 steps per second
+	SCameraState CameraState = { billboard_scene::s_CameraAngle, billboard_scene::s_CameraRadius, billboard_scene::s_CameraHeight };
+
+	m_CameraLoop.Start(CameraState, 120.0f, &StepCamera, this);
 }
 
 // -----------------------------------------------------------------------------
 
 CApplication::~CApplication()
 {
+	// The build thread uses the camera, the trees, and the software depth buffer
+	m_FramePipeline.Stop();
 }
 
 // -----------------------------------------------------------------------------
@@ -174,14 +343,52 @@ bool CApplication::InternOnCreateTextures()
 	// Load an image from the given path and create a YoshiX texture representing
 	// the image.
 	// -----------------------------------------------------------------------------
-	CreateTexture("..\\data\\images\\tree_colored.png", &m_pColorTexture);
-	CreateTexture("..\\data\\images\\tree_normal.png", &m_pNormalTexture);
+	m_ColorTexture = m_Resources.CreateTexture("..\\data\\images\\tree_colored.png");
+	m_NormalTexture = m_Resources.CreateTexture("..\\data\\images\\tree_normal.png");
+
+
+	m_GroundTexture = m_Resources.CreateTexture("..\\data\\images\\ground.dds");
+
+	m_ColorTextureWall = m_Resources.CreateTexture("..\\data\\images\\wall_color_map.dds");
+	m_NormalTextureWall = m_Resources.CreateTexture("..\\data\\images\\wall_normal_map.dds");
+
+	m_HotReload.AddTexture("..\\data\\images\\tree_colored.png", m_Resources.GetAddress(m_ColorTexture));
+	m_HotReload.AddTexture("..\\data\\images\\tree_normal.png", m_Resources.GetAddress(m_NormalTexture));
+	m_HotReload.AddTexture("..\\data\\images\\ground.dds", m_Resources.GetAddress(m_GroundTexture));
+	m_HotReload.AddTexture("..\\data\\images\\wall_color_map.dds", m_Resources.GetAddress(m_ColorTextureWall));
+	m_HotReload.AddTexture("..\\data\\images\\wall_normal_map.dds", m_Resources.GetAddress(m_NormalTextureWall));
+
+	// -----------------------------------------------------------------------------
+	// Use the atlas of the walls if it exists, it is written by the atlas tool:
+	//
+	//     atlas ..\data\images\walls ..\data\images\wall_color_map.dds ..\data\images\wall_normal_map.dds [...]
+	//
+	// Other sprites may share the page, they would be drawn with the same material.
+	// -----------------------------------------------------------------------------
+	std::vector<SAtlasSprite> AtlasSprites;
+
+	const SAtlasSprite* pWallSprite = nullptr;
+
+	if (ReadAtlasDescription("..\\data\\images\\walls.txt", AtlasSprites)) pWallSprite = FindAtlasSprite(AtlasSprites, "wall_color_map.dds");
 
+	m_HasWallAtlas = pWallSprite != nullptr;
+
+	if (m_HasWallAtlas)
+	{
+		std::string PagePath = "..\\data\\images\\walls_" + std::to_string(pWallSprite->m_Page);
+		std::string ColorPath = PagePath + "_color.dds";
+		std::string NormalPath = PagePath + "_normal.dds";
 
-	CreateTexture("..\\data\\images\\ground.dds", &m_pGroundTexture);
+		m_ColorTextureWallAtlas = m_Resources.CreateTexture(ColorPath.c_str());
+		m_NormalTextureWallAtlas = m_Resources.CreateTexture(NormalPath.c_str());
 
-	CreateTexture("..\\data\\images\\wall_color_map.dds", &m_pColorTextureWall);
-	CreateTexture("..\\data\\images\\wall_normal_map.dds", &m_pNormalTextureWall);
+		m_HotReload.AddTexture(ColorPath.c_str(), m_Resources.GetAddress(m_ColorTextureWallAtlas));
+		m_HotReload.AddTexture(NormalPath.c_str(), m_Resources.GetAddress(m_NormalTextureWallAtlas));
+
+		std::copy(pWallSprite->m_UVRect, pWallSprite->m_UVRect + 4, m_WallAtlasRect);
+
+		LOG(Assets, Info, "Walls drawn from the atlas page {} of {} sprites", pWallSprite->m_Page, static_cast<int>(AtlasSprites.size()));
+	}
 
 	return true;
 }
@@ -193,13 +400,25 @@ bool CApplication::InternOnReleaseTextures()
 	// -----------------------------------------------------------------------------
 	// Important to release the texture again when the application is shut down.
 	// -----------------------------------------------------------------------------
-	ReleaseTexture(m_pColorTexture);
-	ReleaseTexture(m_pNormalTexture);
+	m_Resources.Release(m_ColorTexture);
+	m_Resources.Release(m_NormalTexture);
+
+	m_Resources.Release(m_GroundTexture);
+
+	m_Resources.Release(m_ColorTextureWall);
+	m_Resources.Release(m_NormalTextureWall);
 
-	ReleaseTexture(m_pGroundTexture);
+	// The atlas pages only exist if the atlas was found, releasing an empty handle does nothing
+	m_Resources.Release(m_ColorTextureWallAtlas);
+	m_Resources.Release(m_NormalTextureWallAtlas);
 
-	ReleaseTexture(m_pColorTextureWall);
-	ReleaseTexture(m_pNormalTextureWall);
+	m_ColorTextureWallAtlas = STextureHandle();
+	m_NormalTextureWallAtlas = STextureHandle();
+
+	// The textures are released last, so everything still in the pools was forgotten above
+	int NumberOfLeaks = m_Resources.ReleaseAll();
+
+	if (NumberOfLeaks > 0) LOG(Assets, Warning, "{} YoshiX objects were not released", NumberOfLeaks);
 
 
 
@@ -215,10 +434,10 @@ bool CApplication::InternOnCreateConstantBuffers()
 	// constant buffer is a vertex or a pixel buffer is defined in the material info
 	// when creating the material.
 	// -----------------------------------------------------------------------------
-	CreateConstantBuffer(sizeof(SVertexBuffer), &m_pVertexConstantBuffer);
-	CreateConstantBuffer(sizeof(SPixelBuffer), &m_pPixelConstantBuffer);
+	m_VertexConstantBuffer = m_Resources.CreateConstantBuffer(sizeof(SVertexBuffer));
+	m_PixelConstantBuffer = m_Resources.CreateConstantBuffer(sizeof(SPixelBuffer));
 
-	CreateConstantBuffer(sizeof(SGroundBuffer), &m_pGroundVertexConstantBuffer);
+	m_GroundVertexConstantBuffer = m_Resources.CreateConstantBuffer(sizeof(SGroundBuffer));
 
 	return true;
 }
@@ -230,10 +449,10 @@ bool CApplication::InternOnReleaseConstantBuffers()
 	// -----------------------------------------------------------------------------
 	// Important to release the buffer again when the application is shut down.
 	// -----------------------------------------------------------------------------
-	ReleaseConstantBuffer(m_pVertexConstantBuffer);
-	ReleaseConstantBuffer(m_pPixelConstantBuffer);
+	m_Resources.Release(m_VertexConstantBuffer);
+	m_Resources.Release(m_PixelConstantBuffer);
 
-	ReleaseConstantBuffer(m_pGroundVertexConstantBuffer);
+	m_Resources.Release(m_GroundVertexConstantBuffer);
 
 	return true;
 }
@@ -245,12 +464,34 @@ bool CApplication::InternOnCreateShader()
 	// -----------------------------------------------------------------------------
 	// Load and compile the shader programs.
 	// -----------------------------------------------------------------------------
-	CreateVertexShader("..\\data\\shader\\billboard.fx", "VSShader", &m_pVertexShader);
-	CreatePixelShader("..\\data\\shader\\billboard.fx", "PSShader", &m_pPixelShader);
+	m_VertexShader = m_Resources.CreateVertexShader("..\\data\\shader\\billboard.fx", "VSShader");
+	m_PixelShader = m_Resources.CreatePixelShader("..\\data\\shader\\billboard.fx", "PSShader");
+
+
+	m_GroundVertexShader = m_Resources.CreateVertexShader("..\\data\\shader\\textured.fx", "VSShader");
+	m_GroundPixelShader = m_Resources.CreatePixelShader("..\\data\\shader\\textured.fx", "PSShader");
 
+	// The ground uses the generic depth shader, the walls need the billboard rotation
+	m_DepthPrepass.CreateShader();
+	m_DepthVertexShader = m_Resources.CreateVertexShader("..\\data\\shader\\billboard.fx", "VSDepthShader");
 
-	CreateVertexShader("..\\data\\shader\\textured.fx", "VSShader", &m_pGroundVertexShader);
-	CreatePixelShader("..\\data\\shader\\textured.fx", "PSShader", &m_pGroundPixelShader);
+	m_HotReload.AddVertexShader("..\\data\\shader\\billboard.fx", "VSShader", m_Resources.GetAddress(m_VertexShader));
+	m_HotReload.AddPixelShader("..\\data\\shader\\billboard.fx", "PSShader", m_Resources.GetAddress(m_PixelShader));
+	m_HotReload.AddVertexShader("..\\data\\shader\\textured.fx", "VSShader", m_Resources.GetAddress(m_GroundVertexShader));
+	m_HotReload.AddPixelShader("..\\data\\shader\\textured.fx", "PSShader", m_Resources.GetAddress(m_GroundPixelShader));
+	m_HotReload.AddVertexShader("..\\data\\shader\\billboard.fx", "VSDepthShader", m_Resources.GetAddress(m_DepthVertexShader));
+
+	// The static batches of the walls have the billboard position in the vertices
+	m_BatchedVertexShader = m_Resources.CreateVertexShader("..\\data\\shader\\billboard.fx", "VSBatchedShader");
+	m_BatchedDepthVertexShader = m_Resources.CreateVertexShader("..\\data\\shader\\billboard.fx", "VSBatchedDepthShader");
+
+	m_HotReload.AddVertexShader("..\\data\\shader\\billboard.fx", "VSBatchedShader", m_Resources.GetAddress(m_BatchedVertexShader));
+	m_HotReload.AddVertexShader("..\\data\\shader\\billboard.fx", "VSBatchedDepthShader", m_Resources.GetAddress(m_BatchedDepthVertexShader));
+
+	// The batches drawn from the atlas have the rect of the wall in the vertices as well
+	m_AtlasVertexShader = m_Resources.CreateVertexShader("..\\data\\shader\\billboard.fx", "VSAtlasShader");
+
+	m_HotReload.AddVertexShader("..\\data\\shader\\billboard.fx", "VSAtlasShader", m_Resources.GetAddress(m_AtlasVertexShader));
 
 	return true;
 }
@@ -262,11 +503,18 @@ bool CApplication::InternOnReleaseShader()
 	// -----------------------------------------------------------------------------
 	// Important to release the shader again when the application is shut down.
 	// -----------------------------------------------------------------------------
-	ReleaseVertexShader(m_pVertexShader);
-	ReleasePixelShader(m_pPixelShader);
+	m_Resources.Release(m_VertexShader);
+	m_Resources.Release(m_PixelShader);
+
+	m_Resources.Release(m_GroundVertexShader);
+	m_Resources.Release(m_GroundPixelShader);
 
-	ReleaseVertexShader(m_pGroundVertexShader);
-	ReleasePixelShader(m_pGroundPixelShader);
+	m_DepthPrepass.ReleaseShader();
+	m_Resources.Release(m_DepthVertexShader);
+
+	m_Resources.Release(m_BatchedVertexShader);
+	m_Resources.Release(m_BatchedDepthVertexShader);
+	m_Resources.Release(m_AtlasVertexShader);
 
 	return true;
 }
@@ -283,17 +531,17 @@ bool CApplication::InternOnCreateMaterials()
 	SMaterialInfo MaterialInfo;
 
 	MaterialInfo.m_NumberOfTextures = 2;                       // We sample one texture in the pixel shader.
-	MaterialInfo.m_pTextures[0] = m_pColorTexture;              // The handle to the texture.
-	MaterialInfo.m_pTextures[1] = m_pNormalTexture;
+	MaterialInfo.m_pTextures[0] = m_Resources.Get(m_ColorTexture);              // The handle to the texture.
+	MaterialInfo.m_pTextures[1] = m_Resources.Get(m_NormalTexture);
 
 	MaterialInfo.m_NumberOfVertexConstantBuffers = 1;                       // We need one vertex constant buffer to pass world matrix and view projection matrix to the vertex shader.
-	MaterialInfo.m_pVertexConstantBuffers[0] = m_pVertexConstantBuffer; // Pass the handle to the created vertex constant buffer.
+	MaterialInfo.m_pVertexConstantBuffers[0] = m_Resources.Get(m_VertexConstantBuffer); // Pass the handle to the created vertex constant buffer.
 
 	MaterialInfo.m_NumberOfPixelConstantBuffers = 1;                       // We do not need any global data in the pixel shader.
-	MaterialInfo.m_pPixelConstantBuffers[0] = m_pPixelConstantBuffer;
+	MaterialInfo.m_pPixelConstantBuffers[0] = m_Resources.Get(m_PixelConstantBuffer);
 
-	MaterialInfo.m_pVertexShader = m_pVertexShader;         // The handle to the vertex shader.
-	MaterialInfo.m_pPixelShader = m_pPixelShader;          // The handle to the pixel shader.
+	MaterialInfo.m_pVertexShader = m_Resources.Get(m_VertexShader);         // The handle to the vertex shader.
+	MaterialInfo.m_pPixelShader = m_Resources.Get(m_PixelShader);          // The handle to the pixel shader.
 
 	MaterialInfo.m_NumberOfInputElements = 5;                       // The vertex shader requests the position and the texture coordinates as arguments.
 	MaterialInfo.m_InputElements[0].m_pName = "POSITION";              // The semantic name of the first argument, which matches exactly the first identifier in the 'VSInput' struct.
@@ -307,7 +555,8 @@ bool CApplication::InternOnCreateMaterials()
 	MaterialInfo.m_InputElements[4].m_pName = "TEXCOORD";
 	MaterialInfo.m_InputElements[4].m_Type = SInputElement::Float2;   // The texture coordinates are a 2D vector with floating points.
 
-	CreateMaterial(MaterialInfo, &m_pMaterial);
+	m_Material = m_Resources.CreateMaterial(MaterialInfo);
+	m_HotReload.AddMaterial(MaterialInfo, m_Resources.GetAddress(m_Material));
 
 	// -----------------------------------------------------------------------------
 	// Create a material spawning the mesh. This material will be used for the
@@ -316,17 +565,17 @@ bool CApplication::InternOnCreateMaterials()
 	SMaterialInfo MaterialInfoWall;
 
 	MaterialInfoWall.m_NumberOfTextures = 2;                       // We sample one texture in the pixel shader.
-	MaterialInfoWall.m_pTextures[0] = m_pColorTextureWall;              // The handle to the texture.
-	MaterialInfoWall.m_pTextures[1] = m_pNormalTextureWall;
+	MaterialInfoWall.m_pTextures[0] = m_Resources.Get(m_ColorTextureWall);              // The handle to the texture.
+	MaterialInfoWall.m_pTextures[1] = m_Resources.Get(m_NormalTextureWall);
 
 	MaterialInfoWall.m_NumberOfVertexConstantBuffers = 1;                       // We need one vertex constant buffer to pass world matrix and view projection matrix to the vertex shader.
-	MaterialInfoWall.m_pVertexConstantBuffers[0] = m_pVertexConstantBuffer; // Pass the handle to the created vertex constant buffer.
+	MaterialInfoWall.m_pVertexConstantBuffers[0] = m_Resources.Get(m_VertexConstantBuffer); // Pass the handle to the created vertex constant buffer.
 
 	MaterialInfoWall.m_NumberOfPixelConstantBuffers = 1;                       // We do not need any global data in the pixel shader.
-	MaterialInfoWall.m_pPixelConstantBuffers[0] = m_pPixelConstantBuffer;
+	MaterialInfoWall.m_pPixelConstantBuffers[0] = m_Resources.Get(m_PixelConstantBuffer);
 
-	MaterialInfoWall.m_pVertexShader = m_pVertexShader;         // The handle to the vertex shader.
-	MaterialInfoWall.m_pPixelShader = m_pPixelShader;          // The handle to the pixel shader.
+	MaterialInfoWall.m_pVertexShader = m_Resources.Get(m_VertexShader);         // The handle to the vertex shader.
+	MaterialInfoWall.m_pPixelShader = m_Resources.Get(m_PixelShader);          // The handle to the pixel shader.
 
 	MaterialInfoWall.m_NumberOfInputElements = 5;                       // The vertex shader requests the position and the texture coordinates as arguments.
 	MaterialInfoWall.m_InputElements[0].m_pName = "POSITION";              // The semantic name of the first argument, which matches exactly the first identifier in the 'VSInput' struct.
@@ -340,7 +589,48 @@ bool CApplication::InternOnCreateMaterials()
 	MaterialInfoWall.m_InputElements[4].m_pName = "TEXCOORD";
 	MaterialInfoWall.m_InputElements[4].m_Type = SInputElement::Float2;   // The texture coordinates are a 2D vector with floating points.
 
-	CreateMaterial(MaterialInfoWall, &m_pMaterialWall);
+	m_MaterialWall = m_Resources.CreateMaterial(MaterialInfoWall);
+	m_HotReload.AddMaterial(MaterialInfoWall, m_Resources.GetAddress(m_MaterialWall));
+
+	// Position-only material for the depth pre-pass of the walls
+	SMaterialInfo DepthMaterialInfoWall;
+
+	m_DepthPrepass.GetDepthMaterialInfo(MaterialInfoWall, m_Resources.Get(m_DepthVertexShader), DepthMaterialInfoWall);
+
+	m_DepthMaterialWall = m_Resources.CreateMaterial(DepthMaterialInfoWall);
+	m_HotReload.AddMaterial(DepthMaterialInfoWall, m_Resources.GetAddress(m_DepthMaterialWall));
+
+	// The same material for the static batches of the walls, which have the
+	// position of their wall as sixth vertex element
+	SMaterialInfo BatchedMaterialInfoWall = MaterialInfoWall;
+
+	BatchedMaterialInfoWall.m_pVertexShader = m_Resources.Get(m_BatchedVertexShader);
+	BatchedMaterialInfoWall.m_NumberOfInputElements = 6;
+	BatchedMaterialInfoWall.m_InputElements[5].m_pName = "ORIGIN";
+	BatchedMaterialInfoWall.m_InputElements[5].m_Type = SInputElement::Float3;
+
+	// With the atlas the textures are its pages and the rect follows the position of the wall
+	if (m_HasWallAtlas)
+	{
+		BatchedMaterialInfoWall.m_pTextures[0] = m_Resources.Get(m_ColorTextureWallAtlas);
+		BatchedMaterialInfoWall.m_pTextures[1] = m_Resources.Get(m_NormalTextureWallAtlas);
+
+		BatchedMaterialInfoWall.m_pVertexShader = m_Resources.Get(m_AtlasVertexShader);
+		BatchedMaterialInfoWall.m_NumberOfInputElements = 7;
+		BatchedMaterialInfoWall.m_InputElements[6].m_pName = "ATLAS";
+		BatchedMaterialInfoWall.m_InputElements[6].m_Type = SInputElement::Float4;
+	}
+
+	m_BatchedMaterialWall = m_Resources.CreateMaterial(BatchedMaterialInfoWall);
+	m_HotReload.AddMaterial(BatchedMaterialInfoWall, m_Resources.GetAddress(m_BatchedMaterialWall));
+
+	SMaterialInfo BatchedDepthMaterialInfoWall;
+
+	m_DepthPrepass.GetDepthMaterialInfo(BatchedMaterialInfoWall, m_Resources.Get(m_BatchedDepthVertexShader), BatchedDepthMaterialInfoWall);
+
+	m_BatchedDepthMaterialWall = m_Resources.CreateMaterial(BatchedDepthMaterialInfoWall);
+	m_HotReload.AddMaterial(BatchedDepthMaterialInfoWall, m_Resources.GetAddress(m_BatchedDepthMaterialWall));
+
 	// -----------------------------------------------------------------------------
 	// Create a material spawning the mesh. This material will be used for the
 	// ground, which should just be textured objects.
@@ -348,14 +638,14 @@ bool CApplication::InternOnCreateMaterials()
 	SMaterialInfo MaterialGroundInfo;
 
 	MaterialGroundInfo.m_NumberOfTextures = 1;									// The material does not need textures, because the pixel shader just returns a constant color.
-	MaterialGroundInfo.m_pTextures[0] = m_pGroundTexture;
+	MaterialGroundInfo.m_pTextures[0] = m_Resources.Get(m_GroundTexture);
 
 	MaterialGroundInfo.m_NumberOfVertexConstantBuffers = 1;						// We need one vertex constant buffer to pass world matrix and view projection matrix to the vertex shader.
-	MaterialGroundInfo.m_pVertexConstantBuffers[0] = m_pGroundVertexConstantBuffer;     // Pass the handle to the created vertex constant buffer.					// We need one vertex constant buffer to pass world matrix and view projection matrix to the vertex shader.
+	MaterialGroundInfo.m_pVertexConstantBuffers[0] = m_Resources.Get(m_GroundVertexConstantBuffer);     // Pass the handle to the created vertex constant buffer.					// We need one vertex constant buffer to pass world matrix and view projection matrix to the vertex shader.
 	MaterialGroundInfo.m_NumberOfPixelConstantBuffers = 0;						// We do not need any global data in the pixel shader.
 
-	MaterialGroundInfo.m_pVertexShader = m_pGroundVertexShader;							// The handle to the vertex shader.
-	MaterialGroundInfo.m_pPixelShader = m_pGroundPixelShader;							// The handle to the pixel shader.
+	MaterialGroundInfo.m_pVertexShader = m_Resources.Get(m_GroundVertexShader);							// The handle to the vertex shader.
+	MaterialGroundInfo.m_pPixelShader = m_Resources.Get(m_GroundPixelShader);							// The handle to the pixel shader.
 
 	MaterialGroundInfo.m_NumberOfInputElements = 2;								// The vertex shader requests the position as only argument.
 	MaterialGroundInfo.m_InputElements[0].m_pName = "POSITION";					// The semantic name of the argument, which matches exactly the identifier in the 'VSInput' struct.
@@ -363,7 +653,15 @@ bool CApplication::InternOnCreateMaterials()
 	MaterialGroundInfo.m_InputElements[1].m_pName = "TEXCOORD";              // The semantic name of the second argument, which matches exactly the second identifier in the 'VSInput' struct.
 	MaterialGroundInfo.m_InputElements[1].m_Type = SInputElement::Float2;   // The texture coordinates are a 2D vector with floating points.
 
-	CreateMaterial(MaterialGroundInfo, &m_pGroundMaterial);
+	m_GroundMaterial = m_Resources.CreateMaterial(MaterialGroundInfo);
+	m_HotReload.AddMaterial(MaterialGroundInfo, m_Resources.GetAddress(m_GroundMaterial));
+
+	// The ground shader matches the generic depth shader, so no special one is needed
+	SMaterialInfo GroundDepthMaterialInfo;
+
+	m_DepthPrepass.GetDepthMaterialInfo(MaterialGroundInfo, nullptr, GroundDepthMaterialInfo);
+
+	m_GroundDepthMaterial = m_Resources.CreateMaterial(GroundDepthMaterialInfo);
 
 	return true;
 }
@@ -375,9 +673,13 @@ bool CApplication::InternOnReleaseMaterials()
 	// -----------------------------------------------------------------------------
 	// Important to release the material again when the application is shut down.
 	// -----------------------------------------------------------------------------
-	ReleaseMaterial(m_pMaterial);
-	ReleaseMaterial(m_pMaterialWall);
-	ReleaseMaterial(m_pGroundMaterial);
+	m_Resources.Release(m_Material);
+	m_Resources.Release(m_MaterialWall);
+	m_Resources.Release(m_GroundMaterial);
+	m_Resources.Release(m_DepthMaterialWall);
+	m_Resources.Release(m_GroundDepthMaterial);
+	m_Resources.Release(m_BatchedMaterialWall);
+	m_Resources.Release(m_BatchedDepthMaterialWall);
 	return true;
 }
 
@@ -429,16 +731,74 @@ bool CApplication::InternOnCreateMeshes()
 	// surface covering the mesh. Note that you pass the number of indices and not
 	// the number of triangles.
 	// -----------------------------------------------------------------------------
+	// -----------------------------------------------------------------------------
+	// Most of the tree texture is transparent, but each texel of the quad is
+	// rasterized and blended. The tree mesh is cut down to a polygon around the
+	// visible texels of the texture, a texel of padding keeps the texels reached
+	// by the bilinear filter. If the texture cannot be read the quad is used.
+	// -----------------------------------------------------------------------------
+	float TreeVertices[STrimmedPolygon::s_MaximumNumberOfVertices][14];
+	int TreeIndices[STrimmedPolygon::s_MaximumNumberOfVertices - 2][3];
+
+	SAlphaMask TreeMask;
+	STrimmedPolygon TreePolygon;
+
+	STrimSettings TreeSettings = { 0, 1.0f, 16, 8 };
+
 	SMeshInfo MeshInfo;
 
+	if (ReadPngAlpha("..\\data\\images\\tree_colored.png", TreeMask))
+	{
+		GetTrimmedPolygon(TreeMask, TreeSettings, TreePolygon);
+
+		for (int IndexOfVertex = 0; IndexOfVertex < TreePolygon.m_NumberOfVertices; ++IndexOfVertex)
+		{
+			float U = TreePolygon.m_TexCoords[IndexOfVertex][0];
+			float V = TreePolygon.m_TexCoords[IndexOfVertex][1];
+
+			// Same normal, tangent, and binormal as the quad, the position follows the texture coordinates
+			for (int IndexOfFloat = 0; IndexOfFloat < 14; ++IndexOfFloat) TreeVertices[IndexOfVertex][IndexOfFloat] = QuadVertices[0][IndexOfFloat];
+
+			TreeVertices[IndexOfVertex][0] = U * 2.0f - 1.0f;
+			TreeVertices[IndexOfVertex][1] = 1.0f - V * 2.0f;
+			TreeVertices[IndexOfVertex][12] = U;
+			TreeVertices[IndexOfVertex][13] = V;
+		}
+
+		// The polygon is convex and counter-clockwise, so a fan covers it
+		for (int IndexOfTriangle = 0; IndexOfTriangle < TreePolygon.m_NumberOfVertices - 2; ++IndexOfTriangle)
+		{
+			TreeIndices[IndexOfTriangle][0] = 0;
+			TreeIndices[IndexOfTriangle][1] = IndexOfTriangle + 1;
+			TreeIndices[IndexOfTriangle][2] = IndexOfTriangle + 2;
+		}
+
+		MeshInfo.m_pVertices = &TreeVertices[0][0];
+		MeshInfo.m_NumberOfVertices = TreePolygon.m_NumberOfVertices;
+		MeshInfo.m_pIndices = &TreeIndices[0][0];
+		MeshInfo.m_NumberOfIndices = (TreePolygon.m_NumberOfVertices - 2) * 3;
+
+		LOG(Assets, Info, "Tree billboard trimmed to {} vertices, {}% of the quad",
+			TreePolygon.m_NumberOfVertices, static_cast<int>(TreePolygon.m_Area * 100.0f + 0.5f));
+	}
+	else
+	{
+		MeshInfo.m_pVertices = &QuadVertices[0][0];      // Pointer to the first float of the first vertex.
+		MeshInfo.m_NumberOfVertices = 4;                        // The number of vertices.
+		MeshInfo.m_pIndices = &QuadIndices[0][0];       // Pointer to the first index.
+		MeshInfo.m_NumberOfIndices = 6;                        // The number of indices (has to be dividable by 3).
+	}
 
-	MeshInfo.m_pVertices = &QuadVertices[0][0];      // Pointer to the first float of the first vertex.
-	MeshInfo.m_NumberOfVertices = 4;                        // The number of vertices.
-	MeshInfo.m_pIndices = &QuadIndices[0][0];       // Pointer to the first index.
-	MeshInfo.m_NumberOfIndices = 6;                        // The number of indices (has to be dividable by 3).
-	MeshInfo.m_pMaterial = m_pMaterial;              // A handle to the material covering the mesh.
+	MeshInfo.m_pMaterial = m_Resources.Get(m_Material);              // A handle to the material covering the mesh.
 
-	CreateMesh(MeshInfo, &m_pMesh);
+	m_Mesh = m_Resources.CreateMesh(MeshInfo);
+	m_HotReload.AddMesh(MeshInfo, m_Resources.GetAddress(m_Mesh));
+
+	// The trees in front of the walls, all of them share the tree mesh
+	for (int IndexOfTree = 0; IndexOfTree < billboard_scene::s_NumberOfTrees; ++IndexOfTree)
+	{
+		m_Trees.Create(m_Resources.Get(m_Mesh), 0, billboard_scene::s_TreePositions[IndexOfTree], billboard_scene::s_BillboardRadius);
+	}
 
 	SMeshInfo WallMeshInfo;
 
@@ -446,33 +806,121 @@ bool CApplication::InternOnCreateMeshes()
 	WallMeshInfo.m_NumberOfVertices = 4;                        // The number of vertices.
 	WallMeshInfo.m_pIndices = &QuadIndices[0][0];       // Pointer to the first index.
 	WallMeshInfo.m_NumberOfIndices = 6;                        // The number of indices (has to be dividable by 3).
-	WallMeshInfo.m_pMaterial = m_pMaterialWall;              // A handle to the material covering the mesh.
+	WallMeshInfo.m_pMaterial = m_Resources.Get(m_MaterialWall);              // A handle to the material covering the mesh.
+
+	SMeshInfo DepthMeshInfoWall = WallMeshInfo;
+
+	DepthMeshInfoWall.m_pMaterial = m_Resources.Get(m_DepthMaterialWall);
 
-	CreateMesh(WallMeshInfo, &m_pMeshWall);
+	m_MeshWall = m_Resources.CreateMesh(WallMeshInfo);
+	m_DepthMeshWall = m_Resources.CreateMesh(DepthMeshInfoWall);
+
+	m_HotReload.AddMesh(WallMeshInfo, m_Resources.GetAddress(m_MeshWall));
+	m_HotReload.AddMesh(DepthMeshInfoWall, m_Resources.GetAddress(m_DepthMeshWall));
+
+	// -----------------------------------------------------------------------------
+	// Merge the walls into static batches. Each vertex gets the position of its
+	// wall, the vertex shader turns the wall around it like a single billboard.
+	// The scene is small, so all walls are in one cell. With the atlas each vertex
+	// gets the rect of the wall on the atlas page as well.
+	// -----------------------------------------------------------------------------
+	SStaticVertexLayout WallLayout = { 14, 0, 3, { 3, 6, 9, 0 }, true, m_HasWallAtlas };
+
+	SStaticMesh WallMesh = { &QuadVertices[0][0], 4, &QuadIndices[0][0], 6 };
+
+	m_StaticWalls.Clear();
+	m_StaticWalls.SetLayout(WallLayout);
+
+	for (SWallDraw& rWallDraw : m_WallDraws)
+	{
+		float WorldMatrix[16];
+
+		GetTranslationMatrix(rWallDraw.m_Position[0], rWallDraw.m_Position[1], rWallDraw.m_Position[2], WorldMatrix);
+
+		if (m_HasWallAtlas)
+		{
+			m_StaticWalls.AddInstance(m_Resources.Get(m_MaterialWall), WallMesh, WorldMatrix, m_WallAtlasRect);
+		}
+		else
+		{
+			m_StaticWalls.AddInstance(m_Resources.Get(m_MaterialWall), WallMesh, WorldMatrix);
+		}
+	}
+
+	m_StaticWalls.Build();
+
+	m_WallBatchMeshes.resize(m_StaticWalls.GetNumberOfBatches());
+	m_WallBatchDepthMeshes.resize(m_StaticWalls.GetNumberOfBatches());
+
+	for (int IndexOfBatch = 0; IndexOfBatch < m_StaticWalls.GetNumberOfBatches(); ++IndexOfBatch)
+	{
+		SMeshInfo BatchMeshInfo;
+		SMeshInfo BatchDepthMeshInfo;
+
+		m_StaticWalls.GetMeshInfo(IndexOfBatch, m_Resources.Get(m_BatchedMaterialWall), BatchMeshInfo);
+		m_StaticWalls.GetMeshInfo(IndexOfBatch, m_Resources.Get(m_BatchedDepthMaterialWall), BatchDepthMeshInfo);
+
+		m_WallBatchMeshes[IndexOfBatch] = m_Resources.CreateMesh(BatchMeshInfo);
+		m_WallBatchDepthMeshes[IndexOfBatch] = m_Resources.CreateMesh(BatchDepthMeshInfo);
+
+		m_HotReload.AddMesh(BatchMeshInfo, m_Resources.GetAddress(m_WallBatchMeshes[IndexOfBatch]));
+		m_HotReload.AddMesh(BatchDepthMeshInfo, m_Resources.GetAddress(m_WallBatchDepthMeshes[IndexOfBatch]));
+	}
 
 
 
 	// -----------------------------------------------------------------------------
-	// Build up the mesh for a simple ground with a texture laying on it.
+	// The terrain replaces the ground if its file exists, it is written by the
+	// heightmap tool. It is moved down so the ground under the scene is at the
+	// height of the quad. The meshes of the chunks are created in 'InternOnFrame'.
 	// -----------------------------------------------------------------------------
-	float GroundVertices[][5] =
+	STerrainSettings TerrainSettings = { 32, 2.0f, 150.0f, 0.5f, 8.0f, 8, 120 };
+
+	m_Terrain.SetSettings(TerrainSettings);
+	m_Terrain.SetCallbacks(&CreateTerrainMesh, &ReleaseTerrainMesh, this);
+
+	m_HasTerrain = m_Terrain.Open("..\\data\\terrain.ter");
+
+	if (m_HasTerrain)
 	{
-		{ -4.0f, -1.0f, -4.0f, 0.0f, 1.0f  },
-		{  4.0f, -1.0f, -4.0f, 1.0f, 1.0f  },
-		{  4.0f, -1.0f,  4.0f, 1.0f, 0.0f  },
-		{ -4.0f, -1.0f,  4.0f, 0.0f, 0.0f  },
-	};
+		float TerrainOrigin[3] = { 0.0f, -1.0f - m_Terrain.GetHeight(0.0f, 0.0f), 0.0f };
+
+		m_Terrain.SetOrigin(TerrainOrigin);
+	}
+	else
+	{
+		// -----------------------------------------------------------------------------
+		// Build up the mesh for a simple ground with a texture laying on it.
+		// -----------------------------------------------------------------------------
+		float GroundTexCoords[4][2] = { { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, 0.0f } };
+
+		float GroundVertices[4][5];
 
+		for (int IndexOfVertex = 0; IndexOfVertex < 4; ++IndexOfVertex)
+		{
+			GroundVertices[IndexOfVertex][0] = billboard_scene::s_GroundCorners[IndexOfVertex][0];
+			GroundVertices[IndexOfVertex][1] = billboard_scene::s_GroundCorners[IndexOfVertex][1];
+			GroundVertices[IndexOfVertex][2] = billboard_scene::s_GroundCorners[IndexOfVertex][2];
+			GroundVertices[IndexOfVertex][3] = GroundTexCoords[IndexOfVertex][0];
+			GroundVertices[IndexOfVertex][4] = GroundTexCoords[IndexOfVertex][1];
+		}
 
-	SMeshInfo GroundMeshInfo;
+		SMeshInfo GroundMeshInfo;
 
-	GroundMeshInfo.m_pVertices = &GroundVertices[0][0];                // Pointer to the first float of the first vertex.
-	GroundMeshInfo.m_NumberOfVertices = 4;                            // The number of vertices.
-	GroundMeshInfo.m_pIndices = &QuadIndices[0][0];					 // Pointer to the first index.
-	GroundMeshInfo.m_NumberOfIndices = 6;                           // The number of indices (has to be dividable by 3).
-	GroundMeshInfo.m_pMaterial = m_pGroundMaterial;                // A handle to the material covering the mesh.
+		GroundMeshInfo.m_pVertices = &GroundVertices[0][0];                // Pointer to the first float of the first vertex.
+		GroundMeshInfo.m_NumberOfVertices = 4;                            // The number of vertices.
+		GroundMeshInfo.m_pIndices = &QuadIndices[0][0];					 // Pointer to the first index.
+		GroundMeshInfo.m_NumberOfIndices = 6;                           // The number of indices (has to be dividable by 3).
+		GroundMeshInfo.m_pMaterial = m_Resources.Get(m_GroundMaterial);                // A handle to the material covering the mesh.
 
-	CreateMesh(GroundMeshInfo, &m_pGroundMesh);
+		SMeshInfo GroundDepthMeshInfo = GroundMeshInfo;
+
+		GroundDepthMeshInfo.m_pMaterial = m_Resources.Get(m_GroundDepthMaterial);
+
+		m_GroundMesh = m_Resources.CreateMesh(GroundMeshInfo);
+		m_GroundDepthMesh = m_Resources.CreateMesh(GroundDepthMeshInfo);
+		m_HotReload.AddMesh(GroundMeshInfo, m_Resources.GetAddress(m_GroundMesh));
+	}
 
 
 
@@ -485,10 +933,33 @@ bool CApplication::InternOnReleaseMeshes()
 {
 	// -----------------------------------------------------------------------------
 	// Important to release the mesh again when the application is shut down.
+	//
+	// The build thread reads the trees, the walls, and the software depth
+	// buffer, so it is stopped before any of them is cleared.
 	// -----------------------------------------------------------------------------
-	ReleaseMesh(m_pMesh);
-	ReleaseMesh(m_pMeshWall);
-	ReleaseMesh(m_pGroundMesh);
+	m_FramePipeline.Stop();
+
+	m_Trees.Clear();
+	m_HotReload.Clear();
+	m_Terrain.Close();
+
+	m_Resources.Release(m_Mesh);
+	m_Resources.Release(m_MeshWall);
+	m_Resources.Release(m_DepthMeshWall);
+
+	// The ground quad only exists without terrain, releasing an empty handle does nothing
+	m_Resources.Release(m_GroundMesh);
+	m_Resources.Release(m_GroundDepthMesh);
+
+	m_GroundMesh = SMeshHandle();
+	m_GroundDepthMesh = SMeshHandle();
+
+	for (SMeshHandle Mesh : m_WallBatchMeshes) m_Resources.Release(Mesh);
+	for (SMeshHandle Mesh : m_WallBatchDepthMeshes) m_Resources.Release(Mesh);
+
+	m_WallBatchMeshes.clear();
+	m_WallBatchDepthMeshes.clear();
+	m_StaticWalls.Clear();
 
 	return true;
 }
@@ -502,10 +973,23 @@ bool CApplication::InternOnResize(int _Width, int _Height)
 	// camera has the shape of a pyramid with the eye position at the top of the
 	// pyramid. The horizontal view angle is defined by the vertical view angle
 	// and the ratio between window width and window height. Note that we do not
-	// set the projection matrix to YoshiX. Instead we store the projection matrix
-	// as a member and upload it in the 'InternOnFrame' method in a constant buffer.
+	// set the projection matrix to YoshiX. Instead the camera keeps the projection
+	// matrix and it is uploaded in the 'InternOnFrame' method in a constant buffer.
+	//
+	// The build thread owns the camera and the software depth buffer, so the
+	// frames in flight are finished first and built again afterwards.
 	// -----------------------------------------------------------------------------
-	GetProjectionMatrix(m_FieldOfViewY, static_cast<float>(_Width) / static_cast<float>(_Height), 0.1f, 100.0f, m_ProjectionMatrix);
+	m_FramePipeline.Stop();
+
+	m_Camera.SetPerspective(m_FieldOfViewY, static_cast<float>(_Width) / static_cast<float>(_Height), billboard_scene::s_Near, billboard_scene::s_Far);
+
+	m_DepthPrepass.SetViewport(_Width, _Height);
+
+	m_DepthRasterizer.SetViewport(_Width, _Height);
+	m_Terrain.SetViewport(_Width, _Height);
+	m_DepthRasterizer.SetDepthRange(billboard_scene::s_Near, billboard_scene::s_Far, m_IsReversedZ ? SDepthMode::ReversedZ : SDepthMode::Standard);
+
+	m_FramePipeline.Start(m_NumberOfFramesInFlight, &BuildFrameData, this);
 
 	return true;
 }
@@ -514,20 +998,19 @@ bool CApplication::InternOnResize(int _Width, int _Height)
 
 bool CApplication::InternOnUpdate()
 {
-	float Eye[3];
-	float At[3];
-	float Up[3];
+	// The camera is set up by the build thread in 'BuildFrame'
 
-	// -----------------------------------------------------------------------------
-	// Define position and orientation of the camera in the world. The result is
-	// stored in the 'm_ViewMatrix' matrix and uploaded in the 'InternOnFrame'
-	// method.
-	// -----------------------------------------------------------------------------
-	Eye[0] = m_eyePosX;      At[0] = 0.0f;  Up[0] = 0.0f;
-	Eye[1] = m_eyePosY;		 At[1] = 0.0f;  Up[1] = 1.0f;
-	Eye[2] = m_eyePosZ;      At[2] = 0.0f;  Up[2] = 0.0f;
+	// Swap in the objects of changed shaders and textures before the frame uses them
+	if (m_HotReload.Update())
+	{
+		for (int IndexOfTree = 0; IndexOfTree < m_Trees.GetNumberOfEntities(); ++IndexOfTree)
+		{
+			m_Trees.SetMesh(m_Trees.GetEntity(IndexOfTree), m_Resources.Get(m_Mesh));
+		}
 
-	GetViewMatrix(Eye, At, Up, m_ViewMatrix);
+		// The chunks still use the old ground material, they are built again when needed
+		m_Terrain.ReleaseChunks();
+	}
 
 	return true;
 }
@@ -536,6 +1019,20 @@ bool CApplication::InternOnUpdate()
 
 
 bool CApplication::DrawObject(BHandle material, float pos[3]) {
+	UploadObject(pos);
+
+	// -----------------------------------------------------------------------------
+	// Draw the mesh. This will activate the shader, constant buffers, and textures
+	// of the material on the GPU and render the mesh to the current render targets.
+	// -----------------------------------------------------------------------------
+	DrawMesh(material);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::UploadObject(float pos[3]) {
 	// -----------------------------------------------------------------------------
 	// Upload the world matrix and the view projection matrix to the GPU. This has
 	// to be done before drawing the mesh, though not necessarily in this method.
@@ -549,14 +1046,15 @@ bool CApplication::DrawObject(BHandle material, float pos[3]) {
 	VertexBuffer.m_BillboardPosition[1] = pos[1];
 	VertexBuffer.m_BillboardPosition[2] = pos[2];
 
-	// Set the ViewProjectionMatrix in the vertex buffer 
-	MulMatrix(m_ViewMatrix, m_ProjectionMatrix, VertexBuffer.m_ViewProjectionMatrix);
+	// Set the ViewProjectionMatrix in the vertex buffer, it was multiplied once
+	// when the camera of the frame moved
+	for (int Index = 0; Index < 16; ++Index) VertexBuffer.m_ViewProjectionMatrix[Index] = m_pFrameCamera->m_ViewProjectionMatrix[Index];
 
 
 	// Set cameraPos in the vertex buffer (y should always be 0)
-	VertexBuffer.m_CameraPosition[0] = m_eyePosX;
-	VertexBuffer.m_CameraPosition[1] = m_eyePosY;
-	VertexBuffer.m_CameraPosition[2] = m_eyePosZ;
+	VertexBuffer.m_CameraPosition[0] = m_pFrameCamera->m_EyePosition[0];
+	VertexBuffer.m_CameraPosition[1] = m_pFrameCamera->m_EyePosition[1];
+	VertexBuffer.m_CameraPosition[2] = m_pFrameCamera->m_EyePosition[2];
 
 	// Set light in the vertex buffer
 	// ps: position of the light is fixed, so we can see the reflection
@@ -564,7 +1062,7 @@ bool CApplication::DrawObject(BHandle material, float pos[3]) {
 	VertexBuffer.m_WSLightPosition[1] = 5.0f;
 	VertexBuffer.m_WSLightPosition[2] = -20.0f;
 
-	UploadConstantBuffer(&VertexBuffer, m_pVertexConstantBuffer);
+	UploadConstantBuffer(&VertexBuffer, m_Resources.Get(m_VertexConstantBuffer));
 
 
 	SPixelBuffer PixelBuffer;
@@ -588,106 +1086,330 @@ bool CApplication::DrawObject(BHandle material, float pos[3]) {
 
 	PixelBuffer.m_SpecularExponent = 100.0f;
 
-	UploadConstantBuffer(&PixelBuffer, m_pPixelConstantBuffer);
-
+	UploadConstantBuffer(&PixelBuffer, m_Resources.Get(m_PixelConstantBuffer));
+}
 
+// -----------------------------------------------------------------------------
 
+void CApplication::UploadGround()
+{
 	// -----------------------------------------------------------------------------
-	// Draw the mesh. This will activate the shader, constant buffers, and textures
-	// of the material on the GPU and render the mesh to the current render targets.
+	// Upload the world matrix and the view projection matrix to the GPU. This has
+	// to be done before drawing the mesh, though not necessarily in this method.
 	// -----------------------------------------------------------------------------
-	DrawMesh(material);
+	SGroundBuffer GroundVertexBuffer;
 
-	return true;
-}
+	GetIdentityMatrix(GroundVertexBuffer.m_WorldMatrix);
 
+	for (int Index = 0; Index < 16; ++Index) GroundVertexBuffer.m_ViewProjectionMatrix[Index] = m_pFrameCamera->m_ViewProjectionMatrix[Index];
 
+	UploadConstantBuffer(&GroundVertexBuffer, m_Resources.Get(m_GroundVertexConstantBuffer));
+}
 
-bool CApplication::InternOnFrame()
+// -----------------------------------------------------------------------------
+
+void CApplication::BuildFrame(SFrame& _rFrame)
 {
+	float Eye[3];
+	float At[3];
+	float Up[3];
 
-	SetAlphaBlending(true);
+	_rFrame.m_Arena.Reset();
+
+	// Blend the last two camera states, the rotation of the camera around the
+	// midpoint 0,0,0 is calculated from the blended angle and radius
+	SCameraState Previous;
+	SCameraState Current;
+
+	float Blend = m_CameraLoop.BeginFrame(Previous, Current);
+
+	float Angle = Previous.m_Angle + (Current.m_Angle - Previous.m_Angle) * Blend;
+	float Radius = Previous.m_Radius + (Current.m_Radius - Previous.m_Radius) * Blend;
 
 	// -----------------------------------------------------------------------------
-		// Upload the world matrix and the view projection matrix to the GPU. This has
-		// to be done before drawing the mesh, though not necessarily in this method.
-		// -----------------------------------------------------------------------------
-	SGroundBuffer GroundVertexBuffer;
+	// Define position and orientation of the camera in the world. The camera only
+	// computes the matrices again if it moved, the snapshot is stored in the frame
+	// and uploaded when the frame is drawn in 'InternOnFrame'.
+	// -----------------------------------------------------------------------------
+	billboard_scene::GetEyePosition(Angle, Radius, Previous.m_Height + (Current.m_Height - Previous.m_Height) * Blend, Eye);
 
-	GetIdentityMatrix(GroundVertexBuffer.m_WorldMatrix);
+	At[0] = 0.0f;  Up[0] = 0.0f;
+	At[1] = 0.0f;  Up[1] = 1.0f;
+	At[2] = 0.0f;  Up[2] = 0.0f;
 
-	MulMatrix(m_ViewMatrix, m_ProjectionMatrix, GroundVertexBuffer.m_ViewProjectionMatrix);
+	m_Camera.SetLookAt(Eye, At, Up);
 
-	UploadConstantBuffer(&GroundVertexBuffer, m_pGroundVertexConstantBuffer);
+	_rFrame.m_Camera = m_Camera.GetSnapshot();
 
 	// -----------------------------------------------------------------------------
-	// Draw the mesh. This will activate the shader, constant buffers, and textures
-	// of the material on the GPU and render the mesh to the current render targets.
+	// Rasterize the opaque objects into the software depth buffer. The trees are
+	// tested against it before they are drawn.
 	// -----------------------------------------------------------------------------
+	SRasterState OccluderState = { SDepthTest::Lesser, false, nullptr, nullptr };
 
+	m_DepthRasterizer.BeginFrame();
 
-	DrawMesh(m_pGroundMesh);
+	// The hills of the terrain are not used as occluders, the trees stand on them
+	if (!m_HasTerrain) m_DepthRasterizer.DrawTriangles(&billboard_scene::s_GroundCorners[0][0], 3, billboard_scene::s_QuadIndices, 6, _rFrame.m_Camera.m_ViewProjectionMatrix, OccluderState);
 
-	// create some objects at different positions
+	for (SWallDraw& rWallDraw : m_WallDraws)
+	{
+		float WallCorners[4][3];
 
+		billboard_scene::GetBillboardCorners(rWallDraw.m_Position, _rFrame.m_Camera.m_EyePosition, WallCorners, nullptr);
 
-	float pos3[3] = { -2.0f, 0.0f, 3.0f };
-	DrawObject(m_pMeshWall, pos3);
+		m_DepthRasterizer.DrawTriangles(&WallCorners[0][0], 3, billboard_scene::s_QuadIndices, 6, _rFrame.m_Camera.m_ViewProjectionMatrix, OccluderState);
+	}
+
+	// The ranges of the walls in their batches which are in the view frustum
+	_rFrame.m_pWallDraws = _rFrame.m_Arena.AllocateArray<SStaticDraw>(m_StaticWalls.GetNumberOfInstances());
+	_rFrame.m_NumberOfWallDraws = 0;
 
-	float pos4[3] = { 0.0f, 0.0f, 3.0f };
-	DrawObject(m_pMeshWall, pos4);
+	if (_rFrame.m_pWallDraws != nullptr)
+	{
+		_rFrame.m_NumberOfWallDraws = m_StaticWalls.Cull(_rFrame.m_Camera.m_FrustumPlanes, _rFrame.m_pWallDraws);
+	}
 
+	// The trees are blended, so they are drawn from back to front. Trees outside
+	// of the view frustum are skipped before the occlusion test.
+	int* pVisibleTrees = _rFrame.m_Arena.AllocateArray<int>(m_Trees.GetNumberOfEntities());
+	SSceneDraw* pTreeDraws = _rFrame.m_Arena.AllocateArray<SSceneDraw>(m_Trees.GetNumberOfEntities());
 
-	float pos5[3] = { 2.0f, 0.0f, 3.0f };
-	DrawObject(m_pMeshWall, pos5);
+	_rFrame.m_pTreePositions = _rFrame.m_Arena.AllocateArray<float>(m_Trees.GetNumberOfEntities() * 3);
+	_rFrame.m_NumberOfTrees = 0;
 
+	int NumberOfVisibleTrees = 0;
 
+	if (pVisibleTrees != nullptr && pTreeDraws != nullptr && _rFrame.m_pTreePositions != nullptr)
+	{
+		NumberOfVisibleTrees = m_Trees.Cull(_rFrame.m_Camera.m_FrustumPlanes, pVisibleTrees);
 
-	// The sequence of rendered objects that determines 
-	// which object should be drawn first.
-	if (m_eyePosX > -1) {
+		m_Trees.Sort(pVisibleTrees, NumberOfVisibleTrees, _rFrame.m_Camera.m_EyePosition, SSortOrder::BackToFront, pTreeDraws);
+	}
 
-		float pos0[3] = { -2.0f, 0.0f, 1.0f };
-		DrawObject(m_pMesh, pos0);
+	for (int IndexOfDraw = 0; IndexOfDraw < NumberOfVisibleTrees; ++IndexOfDraw)
+	{
+		int IndexOfTree = pTreeDraws[IndexOfDraw].m_IndexOfEntity;
 
-		float pos1[3] = { 0.0f, 0.0f, 1.0f };
-		DrawObject(m_pMesh, pos1);
+		float TreePosition[3] =
+		{
+			m_Trees.GetPositionsX()[IndexOfTree],
+			m_Trees.GetPositionsY()[IndexOfTree],
+			m_Trees.GetPositionsZ()[IndexOfTree],
+		};
 
-		float pos2[3] = { 2.0f, 0.0f, 1.0f };
-		DrawObject(m_pMesh, pos2);
+		// Skip trees which are completely hidden behind the walls
+		if (m_DepthRasterizer.IsSphereVisible(TreePosition, billboard_scene::s_BillboardRadius, _rFrame.m_Camera.m_ViewProjectionMatrix, _rFrame.m_Camera.m_ProjectionMatrix) == false) continue;
 
-		float pos7[3] = { -1.0f, 0.0f, -1.0f };
-		DrawObject(m_pMesh, pos7);
+		float* pPosition = &_rFrame.m_pTreePositions[_rFrame.m_NumberOfTrees * 3];
 
-		float pos6[3] = { 1.0f, 0.0f, -1.0f };
-		DrawObject(m_pMesh, pos6);
+		pPosition[0] = TreePosition[0];
+		pPosition[1] = TreePosition[1];
+		pPosition[2] = TreePosition[2];
 
+		++_rFrame.m_NumberOfTrees;
 	}
-	else {
-		float pos2[3] = { 2.0f, 0.0f, 1.0f };
-		DrawObject(m_pMesh, pos2);
 
-		float pos1[3] = { 0.0f, 0.0f, 1.0f };
-		DrawObject(m_pMesh, pos1);
+	m_CameraLoop.EndFrame();
+}
+
+// -----------------------------------------------------------------------------
 
-		float pos0[3] = { -2.0f, 0.0f, 1.0f };
-		DrawObject(m_pMesh, pos0);
+void CApplication::UploadWallConstants(void* _pUserData)
+{
+	SWallDraw* pWallDraw = static_cast<SWallDraw*>(_pUserData);
 
-		float pos6[3] = { 1.0f, 0.0f, -1.0f };
-		DrawObject(m_pMesh, pos6);
+	pWallDraw->m_pApplication->UploadObject(pWallDraw->m_Position);
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::UploadGroundConstants(void* _pUserData)
+{
+	static_cast<CApplication*>(_pUserData)->UploadGround();
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::UploadBatchConstants(void* _pUserData)
+{
+	// The batched vertex shader takes the billboard positions from the vertices
+	float Origin[3] = { 0.0f, 0.0f, 0.0f };
+
+	static_cast<CApplication*>(_pUserData)->UploadObject(Origin);
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::CreateTerrainMesh(STerrainChunk& _rChunk, void* _pUserData)
+{
+	// Called by the terrain on the render thread, the vertices are in world space like the ground quad.
+	// The terrain owns the chunk meshes and releases them through the callback, so they are not pooled.
+	CApplication* pApplication = static_cast<CApplication*>(_pUserData);
+
+	SMeshInfo ChunkMeshInfo;
+
+	ChunkMeshInfo.m_pVertices = _rChunk.m_Vertices.data();
+	ChunkMeshInfo.m_NumberOfVertices = _rChunk.m_NumberOfVertices;
+	ChunkMeshInfo.m_pIndices = _rChunk.m_Indices.data();
+	ChunkMeshInfo.m_NumberOfIndices = _rChunk.m_NumberOfIndices;
+	ChunkMeshInfo.m_pMaterial = pApplication->m_Resources.Get(pApplication->m_GroundMaterial);
+
+	CreateMesh(ChunkMeshInfo, &_rChunk.m_pMesh);
+	pApplication->m_DepthPrepass.CreateDepthMesh(ChunkMeshInfo, pApplication->m_Resources.Get(pApplication->m_GroundDepthMaterial), &_rChunk.m_pDepthMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::ReleaseTerrainMesh(STerrainChunk& _rChunk, void*)
+{
+	ReleaseMesh(_rChunk.m_pMesh);
+	ReleaseMesh(_rChunk.m_pDepthMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::StepCamera(SCameraState& _rState, float _StepTime, void* _pUserData)
+{
+	// Runs on the simulation thread, so it only reads the directions of the keys
+	CApplication* pApplication = static_cast<CApplication*>(_pUserData);
+
+	float Distance = pApplication->m_Speed * _StepTime;
+
+	_rState.m_Angle += pApplication->m_AngleDirection * Distance;
+	_rState.m_Radius += pApplication->m_RadiusDirection * Distance;
+	_rState.m_Height += pApplication->m_HeightDirection * Distance;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::BuildFrameData(int _IndexOfFrame, void* _pUserData)
+{
+	CApplication* pApplication = static_cast<CApplication*>(_pUserData);
+
+	pApplication->BuildFrame(pApplication->m_Frames[_IndexOfFrame]);
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnFrame()
+{
+	unsigned long long NumberOfAllocations = GetNumberOfAllocations();
+
+	// Wait until the frame is built, it was started one or more frames ago
+	int IndexOfFrame = m_FramePipeline.BeginFrame();
+
+	if (IndexOfFrame < 0) return true;
+
+	const SFrame& rFrame = m_Frames[IndexOfFrame];
+
+	// The constants of all draws below use the camera of this frame
+	m_pFrameCamera = &rFrame.m_Camera;
+
+	SetAlphaBlending(true);
 
-		float pos7[3] = { -1.0f, 0.0f, -1.0f };
-		DrawObject(m_pMesh, pos7);
+	// The pre-pass turns blending on for its depth pass and back to this state for the opaque materials
+	m_DepthPrepass.SetOpaqueBlending(true);
 
+	// -----------------------------------------------------------------------------
+	// The ground and the walls are opaque, so they are rendered through the depth
+	// pre-pass. Each of them is shaded only once per pixel if the pre-pass is on.
+	// -----------------------------------------------------------------------------
+	m_DepthPrepass.Begin(rFrame.m_Camera.m_ViewProjectionMatrix, rFrame.m_Camera.m_ProjectionMatrix);
+
+	if (m_HasTerrain)
+	{
+		// Picks up the chunks built since the last frame and selects the level of detail for this camera
+		m_Terrain.Update(rFrame.m_Camera);
+
+		for (int IndexOfChunk = 0; IndexOfChunk < m_Terrain.GetNumberOfSelectedChunks(); ++IndexOfChunk)
+		{
+			const STerrainChunk& rChunk = m_Terrain.GetSelectedChunk(IndexOfChunk);
+
+			SOpaqueDraw ChunkDraw = { rChunk.m_pMesh, rChunk.m_pDepthMesh, { rChunk.m_WSCenter[0], rChunk.m_WSCenter[1], rChunk.m_WSCenter[2] }, rChunk.m_Radius, &UploadGroundConstants, this };
+
+			m_DepthPrepass.AddOpaque(ChunkDraw);
+		}
 	}
+	else
+	{
+		SOpaqueDraw GroundDraw = { m_Resources.Get(m_GroundMesh), m_Resources.Get(m_GroundDepthMesh), { 0.0f, -1.0f, 0.0f }, 5.66f, &UploadGroundConstants, this };
 
+		m_DepthPrepass.AddOpaque(GroundDraw);
+	}
 
+	m_NumberOfWallDrawCalls = 0;
 
-	// Rotation of the camera around the midpoint 0,0,0 with the offset of the angle 
-	m_eyePosX = radius * cos(m_angle);
-	m_eyePosZ = radius * sin(m_angle);
+	if (m_IsBatching)
+	{
+		// -----------------------------------------------------------------------------
+		// YoshiX draws complete meshes only, so a batch is drawn once if one of its
+		// ranges is visible. The draws of one batch follow each other.
+		// -----------------------------------------------------------------------------
+		int IndexOfLastBatch = -1;
+
+		for (int IndexOfDraw = 0; IndexOfDraw < rFrame.m_NumberOfWallDraws; ++IndexOfDraw)
+		{
+			int IndexOfBatch = rFrame.m_pWallDraws[IndexOfDraw].m_IndexOfBatch;
+
+			if (IndexOfBatch == IndexOfLastBatch) continue;
+
+			const SStaticBatch& rBatch = m_StaticWalls.GetBatch(IndexOfBatch);
 
+			SOpaqueDraw BatchDraw = { m_Resources.Get(m_WallBatchMeshes[IndexOfBatch]), m_Resources.Get(m_WallBatchDepthMeshes[IndexOfBatch]), { rBatch.m_WSCenter[0], rBatch.m_WSCenter[1], rBatch.m_WSCenter[2] }, rBatch.m_Radius, &UploadBatchConstants, this };
 
+			m_DepthPrepass.AddOpaque(BatchDraw);
+
+			IndexOfLastBatch = IndexOfBatch;
+
+			++m_NumberOfWallDrawCalls;
+		}
+	}
+	else
+	{
+		// create some objects at different positions
+		for (SWallDraw& rWallDraw : m_WallDraws)
+		{
+			SOpaqueDraw WallDraw = { m_Resources.Get(m_MeshWall), m_Resources.Get(m_DepthMeshWall), { rWallDraw.m_Position[0], rWallDraw.m_Position[1], rWallDraw.m_Position[2] }, billboard_scene::s_BillboardRadius, &UploadWallConstants, &rWallDraw };
+
+			m_DepthPrepass.AddOpaque(WallDraw);
+
+			++m_NumberOfWallDrawCalls;
+		}
+	}
+
+	m_DepthPrepass.Execute();
+
+	// The visible trees, culled and sorted back to front by the build thread
+	for (int IndexOfTree = 0; IndexOfTree < rFrame.m_NumberOfTrees; ++IndexOfTree)
+	{
+		float TreePosition[3] =
+		{
+			rFrame.m_pTreePositions[IndexOfTree * 3 + 0],
+			rFrame.m_pTreePositions[IndexOfTree * 3 + 1],
+			rFrame.m_pTreePositions[IndexOfTree * 3 + 2],
+		};
+
+		DrawObject(m_Resources.Get(m_Mesh), TreePosition);
+	}
+
+	m_LastFrameArena.m_UsedSize = rFrame.m_Arena.GetUsedSize();
+	m_LastFrameArena.m_Capacity = rFrame.m_Arena.GetCapacity();
+	m_LastFrameArena.m_PeakSize = rFrame.m_Arena.GetPeakSize();
+	m_LastFrameArena.m_NumberOfFailedAllocations = rFrame.m_Arena.GetNumberOfFailedAllocations();
+
+	// The slot may be built again from here on
+	m_FramePipeline.EndFrame();
+
+	m_NumberOfFrameAllocations = GetNumberOfAllocations() - NumberOfAllocations;
+
+	if (m_HotReload.OnFrameEnd())
+	{
+		SHotReloadStatistics Statistics = m_HotReload.GetStatistics();
+
+		LOG(Assets, Info, "Hot reload: {} objects rebuilt in {} ms, visible {} ms after the change",
+			Statistics.m_NumberOfRebuiltObjects, Statistics.m_LastRebuildTime, Statistics.m_LastReloadLatency);
+	}
 
 	return true;
 }
@@ -698,40 +1420,158 @@ bool CApplication::InternOnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _Is
 	// Movement of the camera position
 	if (_Key == 'D' && _IsKeyDown)
 	{
-		m_angle += m_Step;
-		std::cout << "The camera moves to the left" << std::endl;
+		m_AngleDirection = 1;
+		LOG(Camera, Info, "The camera moves to the left");
 
 	}
 	if (_Key == 'A' && _IsKeyDown)
 	{
-		m_angle -= m_Step;
-		std::cout << "The camera moves to the right" << std::endl;
+		m_AngleDirection = -1;
+		LOG(Camera, Info, "The camera moves to the right");
 
 	}
 	if (_Key == 'W' && _IsKeyDown)
 	{
-		radius -= m_Step;
-		std::cout << "The camera comes near" << std::endl;
+		m_RadiusDirection = -1;
+		LOG(Camera, Info, "The camera comes near");
 
 
 	}
 	if (_Key == 'S' && _IsKeyDown)
 	{
-		radius += m_Step;
-		std::cout << "The camera goes far" << std::endl;
+		m_RadiusDirection = 1;
+		LOG(Camera, Info, "The camera goes far");
 
 
 	}
 	if (_Key == 38 && _IsKeyDown)
 	{
-		m_eyePosY += m_Step;
-		std::cout << "The camera goes up" << std::endl;
+		m_HeightDirection = 1;
+		LOG(Camera, Info, "The camera goes up");
 
 	}
 	if (_Key == 40 && _IsKeyDown)
 	{
-		m_eyePosY -= m_Step;
-		std::cout << "The camera goes down" << std::endl;
+		m_HeightDirection = -1;
+		LOG(Camera, Info, "The camera goes down");
+	}
+	// Stop the movement when the key is released
+	if (!_IsKeyDown)
+	{
+		if (_Key == 'D' || _Key == 'A') m_AngleDirection = 0;
+		if (_Key == 'W' || _Key == 'S') m_RadiusDirection = 0;
+		if (_Key == 38 || _Key == 40) m_HeightDirection = 0;
+	}
+	// Print the rates of the camera simulation and the frames and how much they overlap
+	if (_Key == 'T' && _IsKeyDown)
+	{
+		SFixedStepStatistics Statistics = m_CameraLoop.GetStatistics();
+
+		LOG(Statistics, Info, "Fixed step loop: {} steps/s, {} frames/s, {} skipped steps, {}% of the step time overlapped with frames",
+			1000.0 * Statistics.m_NumberOfSteps / Statistics.m_ElapsedTime,
+			1000.0 * Statistics.m_NumberOfFrames / Statistics.m_ElapsedTime, Statistics.m_NumberOfSkippedSteps,
+			Statistics.m_StepTime > 0.0 ? 100.0 * Statistics.m_OverlapTime / Statistics.m_StepTime : 0.0);
+	}
+	// Toggle the depth pre-pass and print the statistics of the mode we leave
+	if (_Key == 'P' && _IsKeyDown)
+	{
+		SDepthPrepassStatistics Statistics;
+
+		m_DepthPrepass.GetStatistics(Statistics);
+
+		LOG(Statistics, Info, "Depth pre-pass {}: {} frames, {} ms/frame, {} rasterized / {} shaded pixels per frame (estimated)",
+			m_DepthPrepass.IsEnabled() ? "on" : "off", Statistics.m_NumberOfFrames, Statistics.m_AverageFrameTime,
+			Statistics.m_AverageRasterizedPixels, Statistics.m_AverageShadedPixels);
+
+		m_DepthPrepass.SetEnabled(!m_DepthPrepass.IsEnabled());
+	}
+	// Print the rejection statistics of the software depth buffer of the last built
+	// frame, the build thread is stopped while the statistics are read
+	if (_Key == 'O' && _IsKeyDown)
+	{
+		m_FramePipeline.Stop();
+
+		const SDepthRasterizerStatistics& rStatistics = m_DepthRasterizer.GetStatistics();
+
+		LOG(Statistics, Info, "Depth rasterizer ({}): {} triangles, {} rejected triangles, {} rejected tiles, {} tile rejected fragments, {} early-Z rejected fragments, {} of {} trees culled",
+			m_IsReversedZ ? "reversed Z" : "standard Z", rStatistics.m_NumberOfTriangles,
+			rStatistics.m_NumberOfRejectedTriangles, rStatistics.m_NumberOfRejectedTiles,
+			rStatistics.m_NumberOfTileRejectedFragments, rStatistics.m_NumberOfEarlyRejectedFragments,
+			rStatistics.m_NumberOfCulledObjects, rStatistics.m_NumberOfTestedObjects);
+
+		m_FramePipeline.Start(m_NumberOfFramesInFlight, &BuildFrameData, this);
+	}
+	// Switch between standard and reversed depth of the software depth buffer
+	if (_Key == 'R' && _IsKeyDown)
+	{
+		m_IsReversedZ = !m_IsReversedZ;
+
+		m_FramePipeline.Stop();
+
+		m_DepthRasterizer.SetDepthRange(billboard_scene::s_Near, billboard_scene::s_Far, m_IsReversedZ ? SDepthMode::ReversedZ : SDepthMode::Standard);
+
+		m_FramePipeline.Start(m_NumberOfFramesInFlight, &BuildFrameData, this);
+
+		LOG(Statistics, Info, "Reversed Z {}", m_IsReversedZ ? "on" : "off");
+	}
+	// Print the statistics of the hot reload of shaders and textures
+	if (_Key == 'H' && _IsKeyDown)
+	{
+		SHotReloadStatistics Statistics = m_HotReload.GetStatistics();
+
+		LOG(Statistics, Info, "Hot reload: {} reloaded files, {} failed, {} unchanged, last latency {} ms",
+			Statistics.m_NumberOfReloads, Statistics.m_NumberOfFailedReloads, Statistics.m_NumberOfIgnoredChanges,
+			Statistics.m_LastReloadLatency);
+	}
+	// Print the heap allocations and the frame arena usage of the last frame
+	if (_Key == 'L' && _IsKeyDown)
+	{
+		LOG(Statistics, Info, "Last frame: {} heap allocations, {} of {} arena bytes used (peak {}, {} failed allocations)",
+			m_NumberOfFrameAllocations, m_LastFrameArena.m_UsedSize, m_LastFrameArena.m_Capacity, m_LastFrameArena.m_PeakSize,
+			m_LastFrameArena.m_NumberOfFailedAllocations);
+	}
+	// Print the throughput and the latency of the frame pipeline
+	if (_Key == 'G' && _IsKeyDown)
+	{
+		SFramePipelineStatistics Statistics = m_FramePipeline.GetStatistics();
+
+		int NumberOfFrames = Statistics.m_NumberOfFrames > 0 ? Statistics.m_NumberOfFrames : 1;
+
+		LOG(Statistics, Info, "Frame pipeline ({} frames in flight): {} frames/s, {} ms build, {} ms render wait, {} ms latency per frame",
+			Statistics.m_NumberOfFramesInFlight, 1000.0 * Statistics.m_NumberOfFrames / Statistics.m_ElapsedTime,
+			Statistics.m_BuildTime / NumberOfFrames, Statistics.m_RenderWaitTime / NumberOfFrames,
+			Statistics.m_Latency / NumberOfFrames);
+	}
+	// Print the resident memory and the build latency of the terrain chunks
+	if (_Key == 'M' && _IsKeyDown)
+	{
+		STerrainStatistics Statistics;
+
+		m_Terrain.GetStatistics(Statistics);
+
+		LOG(Statistics, Info, "Terrain: {} tiles ({} KB), {} chunks ({} KB), {} drawn, {} building, {} built in {} ms each, latency {} ms (max {} ms)",
+			Statistics.m_NumberOfResidentTiles, Statistics.m_TileBytes / 1024, Statistics.m_NumberOfResidentChunks,
+			Statistics.m_ChunkBytes / 1024, Statistics.m_NumberOfSelectedChunks, Statistics.m_NumberOfPendingChunks,
+			Statistics.m_NumberOfBuiltChunks, Statistics.m_AverageBuildTime, Statistics.m_AverageLatency,
+			Statistics.m_MaximumLatency);
+	}
+	// Toggle the static batching of the walls and print the draw calls of the last frame
+	if (_Key == 'B' && _IsKeyDown)
+	{
+		LOG(Statistics, Info, "Static batching {}: {} draw calls for {} walls in {} batches",
+			m_IsBatching ? "on" : "off", m_NumberOfWallDrawCalls, m_StaticWalls.GetNumberOfInstances(),
+			m_StaticWalls.GetNumberOfBatches());
+
+		m_IsBatching = !m_IsBatching;
+	}
+	// Change the number of frames in flight between 1 (serial) and 3
+	if (_Key == 'F' && _IsKeyDown)
+	{
+		m_NumberOfFramesInFlight = m_NumberOfFramesInFlight % 3 + 1;
+
+		m_FramePipeline.Start(m_NumberOfFramesInFlight, &BuildFrameData, this);
+
+		LOG(Statistics, Info, "Frames in flight: {}", m_NumberOfFramesInFlight);
 	}
 	return true;
 }
@@ -744,28 +1584,38 @@ void main()
 {
 
 
-	std::cout << HEADER << '\n';
+	LOG(Console, Info, "{}", HEADER.c_str());
 
-	std::cout << '\n';
+	LOG(Console, Info, "");
 	Print(CENTRE, "\\----------- Billboard - Bilal Alnaani ---------/", LINE_LENGTH);
-	std::cout << '\n';
+	LOG(Console, Info, "");
 	Print(CENTRE, "\\----------------------------------------------/", LINE_LENGTH);
-	std::cout << '\n';
+	LOG(Console, Info, "");
 	Print(CENTRE, "\\-----------------Controls--------------------/", LINE_LENGTH);
-	std::cout << '\n';
+	LOG(Console, Info, "");
 	Print(CENTRE, "\\--------------------------------------------------------------/", LINE_LENGTH);
-	std::cout << '\n';
+	LOG(Console, Info, "");
 	Print(CENTRE, "\\------------------Move Camera left:  A----------------------/", LINE_LENGTH);
 	Print(CENTRE, "\\-----------------Move Camera right: D---------------------/", LINE_LENGTH);
 	Print(CENTRE, "\\----------------Move Camera forward: W------------------/", LINE_LENGTH);
 	Print(CENTRE, "\\---------------Move Camera backward: S----------------/", LINE_LENGTH);
 	Print(CENTRE, "\\------------Move Camera up: Arrowkey Up ------------/", LINE_LENGTH);
 	Print(CENTRE, "\\---------Move Camera down: Arrowkey Down----------/", LINE_LENGTH);
+	Print(CENTRE, "\\-------------Toggle depth pre-pass: P-------------/", LINE_LENGTH);
+	Print(CENTRE, "\\-----------Print culling statistics: O-----------/", LINE_LENGTH);
+	Print(CENTRE, "\\--------------Toggle reversed Z: R---------------/", LINE_LENGTH);
+	Print(CENTRE, "\\-----------Print frame allocations: L------------/", LINE_LENGTH);
+	Print(CENTRE, "\\---------Print hot reload statistics: H----------/", LINE_LENGTH);
+	Print(CENTRE, "\\--------Print fixed step statistics: T-----------/", LINE_LENGTH);
+	Print(CENTRE, "\\-------Change frames in flight (1 to 3): F-------/", LINE_LENGTH);
+	Print(CENTRE, "\\-------Print frame pipeline statistics: G--------/", LINE_LENGTH);
+	Print(CENTRE, "\\-----------Print terrain statistics: M-----------/", LINE_LENGTH);
+	Print(CENTRE, "\\------------Toggle static batching: B------------/", LINE_LENGTH);
 	Print(CENTRE, "\\------------------------------------------------/", LINE_LENGTH);
-	std::cout << '\n';
+	LOG(Console, Info, "");
 
 
-	std::cout << HEADER << '\n';
+	LOG(Console, Info, "{}", HEADER.c_str());
 
 	CApplication Application;
 
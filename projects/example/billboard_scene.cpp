@@ -0,0 +1,75 @@
+#include "billboard_scene.h"
+
+#include <math.h>
+
+namespace billboard_scene
+{
+    const float s_WallPositions[s_NumberOfWalls][3] =
+    {
+        { -2.0f, 0.0f, 3.0f },
+        {  0.0f, 0.0f, 3.0f },
+        {  2.0f, 0.0f, 3.0f },
+    };
+
+    const float s_TreePositions[s_NumberOfTrees][3] =
+    {
+        { -2.0f, 0.0f,  1.0f },
+        {  0.0f, 0.0f,  1.0f },
+        {  2.0f, 0.0f,  1.0f },
+        { -1.0f, 0.0f, -1.0f },
+        {  1.0f, 0.0f, -1.0f },
+    };
+
+    const float s_GroundCorners[4][3] =
+    {
+        { -4.0f, -1.0f, -4.0f },
+        {  4.0f, -1.0f, -4.0f },
+        {  4.0f, -1.0f,  4.0f },
+        { -4.0f, -1.0f,  4.0f },
+    };
+
+    const int s_QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    // -----------------------------------------------------------------------------
+
+    void GetEyePosition(float _Angle, float _Radius, float _Height, float* _pEye)
+    {
+        _pEye[0] = _Radius * cosf(_Angle);
+        _pEye[1] = _Height;
+        _pEye[2] = _Radius * sinf(_Angle);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetBillboardCorners(const float* _pPosition, const float* _pEye, float (*_pCorners)[3], float* _pNormal)
+    {
+        float ZBasis[3] = { _pPosition[0] - _pEye[0], 0.0f, _pPosition[2] - _pEye[2] };
+        float Length    = sqrtf(ZBasis[0] * ZBasis[0] + ZBasis[2] * ZBasis[2]);
+
+        if (Length > 0.0f)
+        {
+            ZBasis[0] /= Length;
+            ZBasis[2] /= Length;
+        }
+
+        // -----------------------------------------------------------------------------
+        // x = cross(y, z) with y = (0, 1, 0)
+        // -----------------------------------------------------------------------------
+        float XBasis[3] = { ZBasis[2], 0.0f, -ZBasis[0] };
+
+        float Offsets[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+        for (int IndexOfCorner = 0; IndexOfCorner < 4; ++ IndexOfCorner)
+        {
+            _pCorners[IndexOfCorner][0] = _pPosition[0] + Offsets[IndexOfCorner][0] * XBasis[0];
+            _pCorners[IndexOfCorner][1] = _pPosition[1] + Offsets[IndexOfCorner][1];
+            _pCorners[IndexOfCorner][2] = _pPosition[2] + Offsets[IndexOfCorner][0] * XBasis[2];
+        }
+
+        if (_pNormal == nullptr) return;
+
+        _pNormal[0] = -ZBasis[0];
+        _pNormal[1] =  0.0f;
+        _pNormal[2] = -ZBasis[2];
+    }
+} // namespace billboard_scene
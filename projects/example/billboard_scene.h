@@ -0,0 +1,41 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// The scene of 'billboard.cpp': a ground quad, three walls, and five trees in
+// front of them, seen by a camera circling around the midpoint. The example
+// builds its objects and its camera from these values, the regression tool
+// renders the same scene, so a change of the scene cannot slip past the golden
+// images.
+// -----------------------------------------------------------------------------
+namespace billboard_scene
+{
+    const int   s_NumberOfWalls   = 3;
+    const int   s_NumberOfTrees   = 5;
+
+    const float s_BillboardRadius = 1.42f;                              // Bounding sphere of a billboard quad with the extents -1 to 1.
+
+    const float s_FieldOfViewY    = 60.0f;                              // Vertical view angle of the camera in degrees.
+    const float s_Near            = 0.1f;
+    const float s_Far             = 100.0f;
+
+    const float s_CameraAngle     = 4.7f;                               // Start position of the camera on its circle.
+    const float s_CameraRadius    = 8.0f;
+    const float s_CameraHeight    = 0.0f;
+
+    extern const float s_WallPositions[s_NumberOfWalls][3];
+    extern const float s_TreePositions[s_NumberOfTrees][3];
+    extern const float s_GroundCorners[4][3];                           // Counter-clockwise seen from above, at the height -1.
+    extern const int   s_QuadIndices[6];                                // The two triangles of the ground and of a billboard.
+
+    // -----------------------------------------------------------------------------
+    // The eye of the camera on its circle around the midpoint 0,0,0.
+    // -----------------------------------------------------------------------------
+    void GetEyePosition(float _Angle, float _Radius, float _Height, float* _pEye);
+
+    // -----------------------------------------------------------------------------
+    // The corners of a billboard turned to the eye around the y-axis, with the
+    // same rotation as the vertex shader of 'billboard.fx'. The normal points to
+    // the eye, it may be nullptr.
+    // -----------------------------------------------------------------------------
+    void GetBillboardCorners(const float* _pPosition, const float* _pEye, float (*_pCorners)[3], float* _pNormal);
+} // namespace billboard_scene
@@ -1,6 +1,8 @@
 
 #include "yoshix.h"
 
+#include "camera.h"
+
 #include <math.h>
 
 using namespace gfx;
@@ -63,8 +65,7 @@ public:
 private:
 
 	float   m_FieldOfViewY;             // Vertical view angle of the camera
-	float   m_ViewMatrix[16];           // The view matrix to transform a mesh from world space into view space.
-	float   m_ProjectionMatrix[16];     // The projection matrix to transform a mesh from view space into clip space.
+	CCamera m_Camera;                   // Caches the view and projection matrices, which only change with the window size here.
 	
 	BHandle m_pVertexConstantBuffer;    // A pointer to a YoshiX constant buffer, which defines global data for a vertex shader.
 	BHandle m_pPixelConstantBuffer;
@@ -326,10 +327,10 @@ bool CApplication::InternOnResize(int _Width, int _Height)
 	// camera has the shape of a pyramid with the eye position at the top of the
 	// pyramid. The horizontal view angle is defined by the vertical view angle
 	// and the ratio between window width and window height. Note that we do not
-	// set the projection matrix to YoshiX. Instead we store the projection matrix
-	// as a member and upload it in the 'InternOnFrame' method in a constant buffer.
+	// set the projection matrix to YoshiX. Instead the camera keeps the projection
+	// matrix and it is uploaded in the 'InternOnFrame' method in a constant buffer.
 	// -----------------------------------------------------------------------------
-	GetProjectionMatrix(m_FieldOfViewY, static_cast<float>(_Width) / static_cast<float>(_Height), 0.1f, 100.0f, m_ProjectionMatrix);
+	m_Camera.SetPerspective(m_FieldOfViewY, static_cast<float>(_Width) / static_cast<float>(_Height), 0.1f, 100.0f);
 
 	return true;
 }
@@ -343,16 +344,16 @@ bool CApplication::InternOnUpdate()
 	float Up [3];
 
 	// -----------------------------------------------------------------------------
-	// Define position and orientation of the camera in the world. The result is
-	// stored in the 'm_ViewMatrix' matrix and uploaded in the 'InternOnFrame'
-	// method.
+	// Define position and orientation of the camera in the world. The camera
+	// computes the view matrix only if the values changed, the result is uploaded
+	// in the 'InternOnFrame' method.
 	// -----------------------------------------------------------------------------
 
 	Eye[0] =  0.0f; At[0] = 0.0f; Up[0] = 0.0f;
 	Eye[1] =  0.0f; At[1] = 0.0f; Up[1] = 1.0f;
 	Eye[2] = -8.0f; At[2] = 0.0f; Up[2] = 0.0f;
 
-	GetViewMatrix(Eye, At, Up, m_ViewMatrix);
+	m_Camera.SetLookAt(Eye, At, Up);
 
 	return true;
 }
@@ -367,13 +368,15 @@ bool CApplication::InternOnFrame()
 	// -----------------------------------------------------------------------------
 	SVertexBuffer VertexBuffer;
 
+	const SCameraSnapshot& rCamera = m_Camera.GetSnapshot();
+
 	GetIdentityMatrix(VertexBuffer.m_WorldMatrix);
 
-	MulMatrix(m_ViewMatrix, m_ProjectionMatrix, VertexBuffer.m_ViewProjectionMatrix);
+	for (int Index = 0; Index < 16; ++Index) VertexBuffer.m_ViewProjectionMatrix[Index] = rCamera.m_ViewProjectionMatrix[Index];
 
-    VertexBuffer.m_WSEyePosition[0]   =  0.0f;
-    VertexBuffer.m_WSEyePosition[1]	  =  0.0f;
-    VertexBuffer.m_WSEyePosition[2]	  = -8.0f;
+    VertexBuffer.m_WSEyePosition[0]   = rCamera.m_EyePosition[0];
+    VertexBuffer.m_WSEyePosition[1]	  = rCamera.m_EyePosition[1];
+    VertexBuffer.m_WSEyePosition[2]	  = rCamera.m_EyePosition[2];
 
     VertexBuffer.m_WSLightPosition[0] =   5.0f;
     VertexBuffer.m_WSLightPosition[1] =   5.0f;
@@ -0,0 +1,218 @@
+
+#include "camera.h"
+
+#include "yoshix.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+    bool IsEqual(const float* _pLeft, const float* _pRight)
+    {
+        return _pLeft[0] == _pRight[0] && _pLeft[1] == _pRight[1] && _pLeft[2] == _pRight[2];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void Copy(const float* _pSource, float* _pDestination)
+    {
+        _pDestination[0] = _pSource[0];
+        _pDestination[1] = _pSource[1];
+        _pDestination[2] = _pSource[2];
+    }
+} // namespace
+
+CCamera::CCamera()
+    : m_FieldOfViewY     (60.0f)
+    , m_AspectRatio      (1.0f)
+    , m_IsViewDirty      (true)
+    , m_IsProjectionDirty(true)
+{
+    const float Eye[3] = { 0.0f, 0.0f, -1.0f };
+    const float At [3] = { 0.0f, 0.0f,  0.0f };
+    const float Up [3] = { 0.0f, 1.0f,  0.0f };
+
+    Copy(Eye, m_Eye);
+    Copy(At , m_At);
+    Copy(Up , m_Up);
+
+    memset(&m_Snapshot, 0, sizeof(m_Snapshot));
+
+    m_Snapshot.m_Near = 0.1f;
+    m_Snapshot.m_Far  = 100.0f;
+}
+
+// -----------------------------------------------------------------------------
+
+void CCamera::SetLookAt(const float* _pEye, const float* _pAt, const float* _pUp)
+{
+    if (IsEqual(_pEye, m_Eye) && IsEqual(_pAt, m_At) && IsEqual(_pUp, m_Up)) return;
+
+    Copy(_pEye, m_Eye);
+    Copy(_pAt , m_At);
+    Copy(_pUp , m_Up);
+
+    m_IsViewDirty = true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CCamera::SetPerspective(float _FieldOfViewY, float _AspectRatio, float _Near, float _Far)
+{
+    if (_FieldOfViewY == m_FieldOfViewY && _AspectRatio == m_AspectRatio && _Near == m_Snapshot.m_Near && _Far == m_Snapshot.m_Far) return;
+
+    m_FieldOfViewY    = _FieldOfViewY;
+    m_AspectRatio     = _AspectRatio;
+    m_Snapshot.m_Near = _Near;
+    m_Snapshot.m_Far  = _Far;
+
+    m_IsProjectionDirty = true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CCamera::IsDirty() const
+{
+    return m_IsViewDirty || m_IsProjectionDirty;
+}
+
+// -----------------------------------------------------------------------------
+
+const SCameraSnapshot& CCamera::GetSnapshot()
+{
+    if (IsDirty() == false) return m_Snapshot;
+
+    if (m_IsViewDirty)
+    {
+        gfx::GetViewMatrix(m_Eye, m_At, m_Up, m_Snapshot.m_ViewMatrix);
+
+        GetInverseMatrix(m_Snapshot.m_ViewMatrix, m_Snapshot.m_InverseViewMatrix);
+
+        Copy(m_Eye, m_Snapshot.m_EyePosition);
+    }
+
+    if (m_IsProjectionDirty)
+    {
+        gfx::GetProjectionMatrix(m_FieldOfViewY, m_AspectRatio, m_Snapshot.m_Near, m_Snapshot.m_Far, m_Snapshot.m_ProjectionMatrix);
+
+        GetInverseMatrix(m_Snapshot.m_ProjectionMatrix, m_Snapshot.m_InverseProjectionMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The inverse of the product is inverted directly, which is cheaper than the
+    // product of the inverses and does not add up their rounding errors.
+    // -----------------------------------------------------------------------------
+    gfx::MulMatrix(m_Snapshot.m_ViewMatrix, m_Snapshot.m_ProjectionMatrix, m_Snapshot.m_ViewProjectionMatrix);
+
+    GetInverseMatrix(m_Snapshot.m_ViewProjectionMatrix, m_Snapshot.m_InverseViewProjectionMatrix);
+
+    GetFrustumPlanes(m_Snapshot.m_ViewProjectionMatrix, m_Snapshot.m_FrustumPlanes);
+
+    m_IsViewDirty       = false;
+    m_IsProjectionDirty = false;
+
+    ++ m_Snapshot.m_Version;
+
+    return m_Snapshot;
+}
+
+// -----------------------------------------------------------------------------
+
+void GetFrustumPlanes(const float* _pViewProjectionMatrix, float (*_pPlanes)[4])
+{
+    // -----------------------------------------------------------------------------
+    // With row vectors the clip coordinates are the dot products of the position
+    // with the columns of the matrix. The frustum planes are w + x, w - x, w + y,
+    // w - y, z, and w - z, normalized so the distance can be compared with the
+    // radius directly.
+    // -----------------------------------------------------------------------------
+    const float* M = _pViewProjectionMatrix;
+
+    for (int Component = 0; Component < 4; ++ Component)
+    {
+        float X = M[Component * 4 + 0];
+        float Y = M[Component * 4 + 1];
+        float Z = M[Component * 4 + 2];
+        float W = M[Component * 4 + 3];
+
+        _pPlanes[0][Component] = W + X;
+        _pPlanes[1][Component] = W - X;
+        _pPlanes[2][Component] = W + Y;
+        _pPlanes[3][Component] = W - Y;
+        _pPlanes[4][Component] = Z;
+        _pPlanes[5][Component] = W - Z;
+    }
+
+    for (int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+    {
+        float* pPlane = _pPlanes[IndexOfPlane];
+
+        float Length = sqrtf(pPlane[0] * pPlane[0] + pPlane[1] * pPlane[1] + pPlane[2] * pPlane[2]);
+
+        if (Length > 0.0f)
+        {
+            pPlane[0] /= Length;
+            pPlane[1] /= Length;
+            pPlane[2] /= Length;
+            pPlane[3] /= Length;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool GetInverseMatrix(const float* _pMatrix, float* _pResultMatrix)
+{
+    // -----------------------------------------------------------------------------
+    // Cofactors from the 2x2 determinants of the upper and lower two rows. The
+    // matrix is copied, so the result may be the matrix itself.
+    // -----------------------------------------------------------------------------
+    float M[16];
+
+    memcpy(M, _pMatrix, sizeof(M));
+
+    float S0 = M[0] * M[5]  - M[4]  * M[1];
+    float S1 = M[0] * M[6]  - M[4]  * M[2];
+    float S2 = M[0] * M[7]  - M[4]  * M[3];
+    float S3 = M[1] * M[6]  - M[5]  * M[2];
+    float S4 = M[1] * M[7]  - M[5]  * M[3];
+    float S5 = M[2] * M[7]  - M[6]  * M[3];
+
+    float C5 = M[10] * M[15] - M[14] * M[11];
+    float C4 = M[9]  * M[15] - M[13] * M[11];
+    float C3 = M[9]  * M[14] - M[13] * M[10];
+    float C2 = M[8]  * M[15] - M[12] * M[11];
+    float C1 = M[8]  * M[14] - M[12] * M[10];
+    float C0 = M[8]  * M[13] - M[12] * M[9];
+
+    float Determinant = S0 * C5 - S1 * C4 + S2 * C3 + S3 * C2 - S4 * C1 + S5 * C0;
+
+    if (Determinant == 0.0f) return false;
+
+    float Scale = 1.0f / Determinant;
+
+    float* R = _pResultMatrix;
+
+    R[0]  = ( M[5]  * C5 - M[6]  * C4 + M[7]  * C3) * Scale;
+    R[1]  = (-M[1]  * C5 + M[2]  * C4 - M[3]  * C3) * Scale;
+    R[2]  = ( M[13] * S5 - M[14] * S4 + M[15] * S3) * Scale;
+    R[3]  = (-M[9]  * S5 + M[10] * S4 - M[11] * S3) * Scale;
+
+    R[4]  = (-M[4]  * C5 + M[6]  * C2 - M[7]  * C1) * Scale;
+    R[5]  = ( M[0]  * C5 - M[2]  * C2 + M[3]  * C1) * Scale;
+    R[6]  = (-M[12] * S5 + M[14] * S2 - M[15] * S1) * Scale;
+    R[7]  = ( M[8]  * S5 - M[10] * S2 + M[11] * S1) * Scale;
+
+    R[8]  = ( M[4]  * C4 - M[5]  * C2 + M[7]  * C0) * Scale;
+    R[9]  = (-M[0]  * C4 + M[1]  * C2 - M[3]  * C0) * Scale;
+    R[10] = ( M[12] * S4 - M[13] * S2 + M[15] * S0) * Scale;
+    R[11] = (-M[8]  * S4 + M[9]  * S2 - M[11] * S0) * Scale;
+
+    R[12] = (-M[4]  * C3 + M[5]  * C1 - M[6]  * C0) * Scale;
+    R[13] = ( M[0]  * C3 - M[1]  * C1 + M[2]  * C0) * Scale;
+    R[14] = (-M[12] * S3 + M[13] * S1 - M[14] * S0) * Scale;
+    R[15] = ( M[8]  * S3 - M[9]  * S1 + M[10] * S0) * Scale;
+
+    return true;
+}
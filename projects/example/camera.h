@@ -0,0 +1,71 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// The matrices of a camera as seen by one frame. They are row vector matrices
+// like the ones of YoshiX. The frustum planes (x, y, z, d) are normalized and
+// point inside, so a sphere is outside if 'dot(center, plane) + d < -radius'
+// for one of them.
+// -----------------------------------------------------------------------------
+struct SCameraSnapshot
+{
+    float        m_ViewMatrix[16];
+    float        m_ProjectionMatrix[16];
+    float        m_ViewProjectionMatrix[16];
+    float        m_InverseViewMatrix[16];
+    float        m_InverseProjectionMatrix[16];
+    float        m_InverseViewProjectionMatrix[16];
+    float        m_FrustumPlanes[6][4];                                 // Left, right, bottom, top, near, and far.
+    float        m_EyePosition[3];
+    float        m_Near;                                                // Near distance of the view frustum.
+    float        m_Far;                                                 // Far distance of the view frustum.
+    unsigned int m_Version;                                             // Changes whenever a matrix changes, 0 before the first update.
+};
+
+// -----------------------------------------------------------------------------
+// A perspective camera which caches its matrices. Setting the same values again
+// changes nothing, so an example can set its camera every frame. The matrices
+// which depend on changed values are computed again when the next snapshot is
+// taken. A camera which did not move costs no matrix product at all, one which
+// moved costs the product of the view projection matrix.
+//
+// The draw code of a frame works on a copy of the snapshot, so the camera may
+// change on another thread, e.g. while the next frame is built.
+// -----------------------------------------------------------------------------
+class CCamera
+{
+    public:
+
+        CCamera();
+
+    public:
+
+        void SetLookAt(const float* _pEye, const float* _pAt, const float* _pUp);
+        void SetPerspective(float _FieldOfViewY, float _AspectRatio, float _Near, float _Far);
+
+        bool IsDirty() const;
+
+        const SCameraSnapshot& GetSnapshot();                           // Updates the changed matrices first.
+
+    private:
+
+        float           m_Eye[3];
+        float           m_At[3];
+        float           m_Up[3];
+        float           m_FieldOfViewY;                                 // Vertical view angle in degrees.
+        float           m_AspectRatio;                                  // Width divided by height.
+        bool            m_IsViewDirty;
+        bool            m_IsProjectionDirty;
+        SCameraSnapshot m_Snapshot;
+};
+
+// -----------------------------------------------------------------------------
+// The frustum planes of a view projection matrix in the layout of the snapshot.
+// Used by the scene store for callers which do not have a camera.
+// -----------------------------------------------------------------------------
+void GetFrustumPlanes(const float* _pViewProjectionMatrix, float (*_pPlanes)[4]);
+
+// -----------------------------------------------------------------------------
+// Inverts a 4x4 matrix. Returns false and leaves the result untouched if the
+// matrix is singular.
+// -----------------------------------------------------------------------------
+bool GetInverseMatrix(const float* _pMatrix, float* _pResultMatrix);
@@ -0,0 +1,348 @@
+
+#include "depth_prepass.h"
+
+#include <algorithm>
+#include <math.h>
+
+using namespace gfx;
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Edge length of one cell of the coverage grid in pixels.
+    // -----------------------------------------------------------------------------
+    const int s_CellSize = 8;
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CDepthPrepass::CDepthPrepass()
+    : m_IsEnabled            (true)
+    , m_IsOpaqueBlending     (false)
+    , m_pDepthVertexShader   (nullptr)
+    , m_pDepthPixelShader    (nullptr)
+    , m_Width                (1)
+    , m_Height               (1)
+    , m_TotalRasterizedPixels(0.0)
+    , m_TotalShadedPixels    (0.0)
+{
+    GetIdentityMatrix(m_ViewProjectionMatrix);
+    GetIdentityMatrix(m_ProjectionMatrix);
+
+    SetViewport(m_Width, m_Height);
+}
+
+// -----------------------------------------------------------------------------
+
+CDepthPrepass::~CDepthPrepass()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::CreateShader()
+{
+    CreateVertexShader("..\\data\\shader\\depth_prepass.fx", "VSDepthShader", &m_pDepthVertexShader);
+    CreatePixelShader ("..\\data\\shader\\depth_prepass.fx", "PSDepthShader", &m_pDepthPixelShader);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::ReleaseShader()
+{
+    ReleaseVertexShader(m_pDepthVertexShader);
+    ReleasePixelShader (m_pDepthPixelShader);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::GetDepthMaterialInfo(const SMaterialInfo& _rMaterialInfo, BHandle _pDepthVertexShader, SMaterialInfo& _rDepthMaterialInfo) const
+{
+    // -----------------------------------------------------------------------------
+    // The depth material keeps the complete input layout of the original material,
+    // because the layout defines the stride of the vertices. The depth vertex
+    // shader only consumes the position. Textures and pixel constant buffers are
+    // dropped, the depth pixel shader does not write any color. If no special depth
+    // vertex shader is passed the generic one is used, which expects the view
+    // projection and the world matrix at the beginning of the first vertex
+    // constant buffer, e.g. as in 'textured.fx'.
+    // -----------------------------------------------------------------------------
+    _rDepthMaterialInfo = _rMaterialInfo;
+
+    _rDepthMaterialInfo.m_NumberOfTextures             = 0;
+    _rDepthMaterialInfo.m_NumberOfPixelConstantBuffers = 0;
+    _rDepthMaterialInfo.m_pVertexShader                = _pDepthVertexShader != nullptr ? _pDepthVertexShader : m_pDepthVertexShader;
+    _rDepthMaterialInfo.m_pPixelShader                 = m_pDepthPixelShader;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::CreateDepthMaterial(const SMaterialInfo& _rMaterialInfo, BHandle _pDepthVertexShader, BHandle* _ppDepthMaterial)
+{
+    SMaterialInfo DepthMaterialInfo;
+
+    GetDepthMaterialInfo(_rMaterialInfo, _pDepthVertexShader, DepthMaterialInfo);
+
+    CreateMaterial(DepthMaterialInfo, _ppDepthMaterial);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::CreateDepthMesh(const SMeshInfo& _rMeshInfo, BHandle _pDepthMaterial, BHandle* _ppDepthMesh)
+{
+    SMeshInfo DepthMeshInfo = _rMeshInfo;
+
+    DepthMeshInfo.m_pMaterial = _pDepthMaterial;
+
+    CreateMesh(DepthMeshInfo, _ppDepthMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::SetEnabled(bool _Flag)
+{
+    if (_Flag != m_IsEnabled)
+    {
+        m_IsEnabled = _Flag;
+
+        ResetStatistics();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CDepthPrepass::IsEnabled() const
+{
+    return m_IsEnabled;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::SetOpaqueBlending(bool _Flag)
+{
+    m_IsOpaqueBlending = _Flag;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::SetViewport(int _Width, int _Height)
+{
+    m_Width  = std::max(_Width , 1);
+    m_Height = std::max(_Height, 1);
+
+    int NumberOfCellsX = (m_Width  + s_CellSize - 1) / s_CellSize;
+    int NumberOfCellsY = (m_Height + s_CellSize - 1) / s_CellSize;
+
+    m_CellDepths.resize(NumberOfCellsX * NumberOfCellsY);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::Begin(const float* _pViewProjectionMatrix, const float* _pProjectionMatrix)
+{
+    std::copy(_pViewProjectionMatrix, _pViewProjectionMatrix + 16, m_ViewProjectionMatrix);
+    std::copy(_pProjectionMatrix    , _pProjectionMatrix     + 16, m_ProjectionMatrix);
+
+    m_Draws.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::AddOpaque(const SOpaqueDraw& _rDraw)
+{
+    m_Draws.push_back(_rDraw);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::Execute()
+{
+    int NumberOfDraws = static_cast<int>(m_Draws.size());
+
+    m_ProjectedDraws.resize(NumberOfDraws);
+    m_Order         .resize(NumberOfDraws);
+
+    for (int IndexOfDraw = 0; IndexOfDraw < NumberOfDraws; ++ IndexOfDraw)
+    {
+        ProjectDraw(m_Draws[IndexOfDraw], m_ProjectedDraws[IndexOfDraw]);
+
+        m_Order[IndexOfDraw] = IndexOfDraw;
+    }
+
+    EstimateCoverage();
+
+    m_FrameStatistics.OnFrame();
+
+    if (m_IsEnabled == false)
+    {
+        // -----------------------------------------------------------------------------
+        // Without pre-pass the draws are rendered in submission order as before.
+        // -----------------------------------------------------------------------------
+        for (SOpaqueDraw& rDraw : m_Draws)
+        {
+            if (rDraw.m_pUploadConstants != nullptr) rDraw.m_pUploadConstants(rDraw.m_pUserData);
+
+            DrawMesh(rDraw.m_pMesh);
+        }
+
+        return;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Sort front to back, so the depth pass itself has as few overdraw as possible.
+    // -----------------------------------------------------------------------------
+    std::sort(m_Order.begin(), m_Order.end(), [this](int _Left, int _Right)
+    {
+        return m_ProjectedDraws[_Left].m_Depth < m_ProjectedDraws[_Right].m_Depth;
+    });
+
+    // -----------------------------------------------------------------------------
+    // Fill the depth buffer with the position-only depth materials. The color
+    // target stays bound, so the depth pixel shader returns a transparent color
+    // and blending is turned on, which keeps the color target as it is.
+    // -----------------------------------------------------------------------------
+    SetDepthTest(SDepthTest::Lesser);
+    SetAlphaBlending(true);
+
+    for (int IndexOfDraw : m_Order)
+    {
+        SOpaqueDraw& rDraw = m_Draws[IndexOfDraw];
+
+        if (rDraw.m_pUploadConstants != nullptr) rDraw.m_pUploadConstants(rDraw.m_pUserData);
+
+        DrawMesh(rDraw.m_pDepthMesh);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Run the expensive materials. Only the pixels which won the depth pass have
+    // an equal depth, so each visible pixel is shaded exactly once.
+    // -----------------------------------------------------------------------------
+    SetDepthTest(SDepthTest::Equal);
+    SetAlphaBlending(m_IsOpaqueBlending);
+
+    for (int IndexOfDraw : m_Order)
+    {
+        SOpaqueDraw& rDraw = m_Draws[IndexOfDraw];
+
+        if (rDraw.m_pUploadConstants != nullptr) rDraw.m_pUploadConstants(rDraw.m_pUserData);
+
+        DrawMesh(rDraw.m_pMesh);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Set the depth test to its default again, e.g. for transparent objects.
+    // -----------------------------------------------------------------------------
+    SetDepthTest(SDepthTest::Lesser);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::GetStatistics(SDepthPrepassStatistics& _rStatistics) const
+{
+    int NumberOfFrames = m_FrameStatistics.GetNumberOfFrames();
+
+    _rStatistics.m_NumberOfFrames          = NumberOfFrames;
+    _rStatistics.m_AverageFrameTime        = m_FrameStatistics.GetAverageFrameTime();
+    _rStatistics.m_AverageRasterizedPixels = NumberOfFrames > 0 ? m_TotalRasterizedPixels / NumberOfFrames : 0.0;
+    _rStatistics.m_AverageShadedPixels     = NumberOfFrames > 0 ? m_TotalShadedPixels     / NumberOfFrames : 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::ResetStatistics()
+{
+    m_FrameStatistics.Reset();
+
+    m_TotalRasterizedPixels = 0.0;
+    m_TotalShadedPixels     = 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::ProjectDraw(const SOpaqueDraw& _rDraw, SProjectedDraw& _rProjectedDraw) const
+{
+    const float* pMatrix = m_ViewProjectionMatrix;
+    const float* pCenter = _rDraw.m_WSCenter;
+
+    // -----------------------------------------------------------------------------
+    // YoshiX uses row vectors, so the clip space position is 'center * matrix'. The
+    // w component of the clip space position is the view space depth.
+    // -----------------------------------------------------------------------------
+    float CSX = pCenter[0] * pMatrix[0] + pCenter[1] * pMatrix[4] + pCenter[2] * pMatrix[ 8] + pMatrix[12];
+    float CSY = pCenter[0] * pMatrix[1] + pCenter[1] * pMatrix[5] + pCenter[2] * pMatrix[ 9] + pMatrix[13];
+    float CSW = pCenter[0] * pMatrix[3] + pCenter[1] * pMatrix[7] + pCenter[2] * pMatrix[11] + pMatrix[15];
+
+    int NumberOfCellsX = (m_Width  + s_CellSize - 1) / s_CellSize;
+    int NumberOfCellsY = (m_Height + s_CellSize - 1) / s_CellSize;
+
+    _rProjectedDraw.m_Depth     = CSW;
+    _rProjectedDraw.m_NearDepth = CSW - _rDraw.m_Radius;
+
+    if (_rProjectedDraw.m_NearDepth <= 0.0f)
+    {
+        // -----------------------------------------------------------------------------
+        // The sphere intersects the eye plane, so conservatively cover everything.
+        // -----------------------------------------------------------------------------
+        _rProjectedDraw.m_NearDepth    = 0.0f;
+        _rProjectedDraw.m_Rectangle[0] = 0;
+        _rProjectedDraw.m_Rectangle[1] = 0;
+        _rProjectedDraw.m_Rectangle[2] = NumberOfCellsX - 1;
+        _rProjectedDraw.m_Rectangle[3] = NumberOfCellsY - 1;
+
+        return;
+    }
+
+    float NDCX    = CSX / CSW;
+    float NDCY    = CSY / CSW;
+    float RadiusX = _rDraw.m_Radius * m_ProjectionMatrix[0] / _rProjectedDraw.m_NearDepth;
+    float RadiusY = _rDraw.m_Radius * m_ProjectionMatrix[5] / _rProjectedDraw.m_NearDepth;
+
+    float MinX = ((NDCX - RadiusX) * 0.5f + 0.5f) * m_Width;
+    float MaxX = ((NDCX + RadiusX) * 0.5f + 0.5f) * m_Width;
+    float MinY = (0.5f - (NDCY + RadiusY) * 0.5f) * m_Height;
+    float MaxY = (0.5f - (NDCY - RadiusY) * 0.5f) * m_Height;
+
+    _rProjectedDraw.m_Rectangle[0] = std::max(static_cast<int>(floorf(MinX / s_CellSize)), 0);
+    _rProjectedDraw.m_Rectangle[1] = std::max(static_cast<int>(floorf(MinY / s_CellSize)), 0);
+    _rProjectedDraw.m_Rectangle[2] = std::min(static_cast<int>(floorf(MaxX / s_CellSize)), NumberOfCellsX - 1);
+    _rProjectedDraw.m_Rectangle[3] = std::min(static_cast<int>(floorf(MaxY / s_CellSize)), NumberOfCellsY - 1);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthPrepass::EstimateCoverage()
+{
+    int   NumberOfCellsX   = (m_Width + s_CellSize - 1) / s_CellSize;
+    float PixelsPerCell    = static_cast<float>(s_CellSize * s_CellSize);
+    int   RasterizedCells  = 0;
+    int   ShadedCells      = 0;
+
+    std::fill(m_CellDepths.begin(), m_CellDepths.end(), HUGE_VALF);
+
+    // -----------------------------------------------------------------------------
+    // Without pre-pass a cell is shaded whenever it passes the depth test at the
+    // time it is drawn. With pre-pass only the nearest draw of a cell is shaded.
+    // -----------------------------------------------------------------------------
+    for (const SProjectedDraw& rDraw : m_ProjectedDraws)
+    {
+        for (int Y = rDraw.m_Rectangle[1]; Y <= rDraw.m_Rectangle[3]; ++ Y)
+        {
+            for (int X = rDraw.m_Rectangle[0]; X <= rDraw.m_Rectangle[2]; ++ X)
+            {
+                float& rCellDepth = m_CellDepths[Y * NumberOfCellsX + X];
+
+                ++ RasterizedCells;
+
+                if (rDraw.m_NearDepth < rCellDepth)
+                {
+                    if (m_IsEnabled == false || rCellDepth == HUGE_VALF) ++ ShadedCells;
+
+                    rCellDepth = rDraw.m_NearDepth;
+                }
+            }
+        }
+    }
+
+    m_TotalRasterizedPixels += RasterizedCells * PixelsPerCell;
+    m_TotalShadedPixels     += ShadedCells     * PixelsPerCell;
+}
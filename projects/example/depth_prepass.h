@@ -0,0 +1,118 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include "frame_statistics.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Callback which uploads the constant buffers of one opaque draw. It is called
+// right before the depth mesh and again before the mesh with the expensive
+// material is drawn, so both passes see exactly the same transformation.
+// -----------------------------------------------------------------------------
+typedef void (*FUploadConstants)(void* _pUserData);
+
+// -----------------------------------------------------------------------------
+
+struct SOpaqueDraw
+{
+    gfx::BHandle     m_pMesh;                                           // The mesh with the expensive material.
+    gfx::BHandle     m_pDepthMesh;                                      // The same geometry using the generated depth material.
+    float            m_WSCenter[3];                                     // World space center of a sphere bounding the mesh.
+    float            m_Radius;                                          // Radius of the bounding sphere.
+    FUploadConstants m_pUploadConstants;                                // Uploads the constant buffers of this draw, can be null.
+    void*            m_pUserData;                                       // Passed to the upload callback.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SDepthPrepassStatistics
+{
+    int    m_NumberOfFrames;                                            // The number of frames rendered in the current mode.
+    double m_AverageFrameTime;                                          // Average time between two frames in milliseconds.
+    double m_AverageRasterizedPixels;                                   // Estimated pixels covered by all opaque draws per frame.
+    double m_AverageShadedPixels;                                       // Estimated pixels running the expensive pixel shader per frame.
+};
+
+// -----------------------------------------------------------------------------
+// Renders the opaque draws of a scene with an optional depth pre-pass. If the
+// pre-pass is enabled all opaque draws are sorted front to back and rendered
+// with a position-only depth material first. Afterwards the expensive materials
+// run with an equal depth test, so each visible pixel is shaded exactly once.
+// This is the technique of the GBuffer pass in 'post_effect.cpp' generalized
+// for arbitrary materials. The pre-pass can be toggled per scene, i.e. per
+// instance of this class.
+//
+// The number of shaded pixels cannot be queried from YoshiX. Instead each draw
+// is projected as bounding rectangle onto a coarse grid of depth cells and the
+// depth test is simulated for both modes.
+// -----------------------------------------------------------------------------
+class CDepthPrepass
+{
+    public:
+
+        CDepthPrepass();
+        ~CDepthPrepass();
+
+    public:
+
+        void CreateShader();
+        void ReleaseShader();
+
+        void GetDepthMaterialInfo(const gfx::SMaterialInfo& _rMaterialInfo, gfx::BHandle _pDepthVertexShader, gfx::SMaterialInfo& _rDepthMaterialInfo) const;
+        void CreateDepthMaterial(const gfx::SMaterialInfo& _rMaterialInfo, gfx::BHandle _pDepthVertexShader, gfx::BHandle* _ppDepthMaterial);
+        void CreateDepthMesh(const gfx::SMeshInfo& _rMeshInfo, gfx::BHandle _pDepthMaterial, gfx::BHandle* _ppDepthMesh);
+
+    public:
+
+        void SetEnabled(bool _Flag);
+        bool IsEnabled() const;
+
+        void SetOpaqueBlending(bool _Flag);                             // The blend state of the expensive materials, YoshiX cannot be asked for it.
+
+        void SetViewport(int _Width, int _Height);
+
+        void Begin(const float* _pViewProjectionMatrix, const float* _pProjectionMatrix);
+        void AddOpaque(const SOpaqueDraw& _rDraw);
+        void Execute();
+
+        void GetStatistics(SDepthPrepassStatistics& _rStatistics) const;
+        void ResetStatistics();
+
+    private:
+
+        struct SProjectedDraw
+        {
+            float m_Depth;                                              // View space depth of the bounding sphere center, used for sorting.
+            int   m_Rectangle[4];                                       // Covered cells on the coverage grid as min x, min y, max x, max y.
+            float m_NearDepth;                                          // View space depth of the nearest point of the bounding sphere.
+        };
+
+    private:
+
+        void ProjectDraw(const SOpaqueDraw& _rDraw, SProjectedDraw& _rProjectedDraw) const;
+        void EstimateCoverage();
+
+    private:
+
+        bool                        m_IsEnabled;                        // True if the opaque draws are rendered with depth pre-pass.
+        bool                        m_IsOpaqueBlending;                 // True if alpha blending is on for the expensive materials.
+
+        gfx::BHandle                m_pDepthVertexShader;               // Generic position-only vertex shader expecting view projection and world matrix in slot 0.
+        gfx::BHandle                m_pDepthPixelShader;                // Pixel shader returning a transparent color, so blending keeps the color target.
+
+        int                         m_Width;                            // Width of the viewport in pixels.
+        int                         m_Height;                           // Height of the viewport in pixels.
+        float                       m_ViewProjectionMatrix[16];         // The view projection matrix of the current frame.
+        float                       m_ProjectionMatrix[16];             // The projection matrix of the current frame.
+
+        std::vector<SOpaqueDraw>    m_Draws;                            // The opaque draws of the current frame in submission order.
+        std::vector<SProjectedDraw> m_ProjectedDraws;                   // Sort key and screen rectangle of each draw.
+        std::vector<int>            m_Order;                            // Indices into the draws sorted front to back.
+        std::vector<float>          m_CellDepths;                       // The simulated depth buffer of the coverage grid.
+
+        CFrameStatistics            m_FrameStatistics;                  // Time between two frames in the current mode.
+        double                      m_TotalRasterizedPixels;            // Accumulated rasterized pixels since the last reset.
+        double                      m_TotalShadedPixels;                // Accumulated shaded pixels since the last reset.
+};
@@ -0,0 +1,470 @@
+
+#include "depth_rasterizer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+using namespace gfx;
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // A vertex in clip space. Only x, y and w are needed, because the depth is
+    // computed from the view space depth w, which equals the clip space w.
+    // -----------------------------------------------------------------------------
+    struct SClipVertex
+    {
+        float m_X;
+        float m_Y;
+        float m_W;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    void TransformPosition(const float* _pPosition, const float* _pMatrix, SClipVertex& _rResult)
+    {
+        _rResult.m_X = _pPosition[0] * _pMatrix[0] + _pPosition[1] * _pMatrix[4] + _pPosition[2] * _pMatrix[ 8] + _pMatrix[12];
+        _rResult.m_Y = _pPosition[0] * _pMatrix[1] + _pPosition[1] * _pMatrix[5] + _pPosition[2] * _pMatrix[ 9] + _pMatrix[13];
+        _rResult.m_W = _pPosition[0] * _pMatrix[3] + _pPosition[1] * _pMatrix[7] + _pPosition[2] * _pMatrix[11] + _pMatrix[15];
+    }
+
+    // -----------------------------------------------------------------------------
+    // Clips a triangle against the near plane 'w >= near'. The result is a convex
+    // polygon with up to four vertices.
+    // -----------------------------------------------------------------------------
+    int ClipNear(const SClipVertex* _pTriangle, float _Near, SClipVertex* _pPolygon)
+    {
+        int NumberOfVertices = 0;
+
+        for (int IndexOfVertex = 0; IndexOfVertex < 3; ++ IndexOfVertex)
+        {
+            const SClipVertex& rCurrent = _pTriangle[IndexOfVertex];
+            const SClipVertex& rNext    = _pTriangle[(IndexOfVertex + 1) % 3];
+
+            bool IsCurrentInside = rCurrent.m_W >= _Near;
+            bool IsNextInside    = rNext   .m_W >= _Near;
+
+            if (IsCurrentInside)
+            {
+                _pPolygon[NumberOfVertices ++] = rCurrent;
+            }
+
+            if (IsCurrentInside != IsNextInside)
+            {
+                float T = (_Near - rCurrent.m_W) / (rNext.m_W - rCurrent.m_W);
+
+                _pPolygon[NumberOfVertices].m_X = rCurrent.m_X + (rNext.m_X - rCurrent.m_X) * T;
+                _pPolygon[NumberOfVertices].m_Y = rCurrent.m_Y + (rNext.m_Y - rCurrent.m_Y) * T;
+                _pPolygon[NumberOfVertices].m_W = _Near;
+
+                ++ NumberOfVertices;
+            }
+        }
+
+        return NumberOfVertices;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Projects a sphere on one axis of the screen. '_Axis' is the view space x or
+    // y of the center and '_Depth' its view space depth. The extents are the
+    // slopes of the two lines from the eye which touch the circle of the sphere
+    // in the plane of the axis and the view direction, so they stay tight and
+    // conservative for spheres far off the view axis. The sphere has to be in
+    // front of the eye.
+    // -----------------------------------------------------------------------------
+    void GetProjectedExtents(float _Axis, float _Depth, float _Radius, float& _rMinimum, float& _rMaximum)
+    {
+        float Tangent = sqrtf(_Axis * _Axis + _Depth * _Depth - _Radius * _Radius);
+
+        _rMinimum = (_Axis * Tangent - _Depth * _Radius) / (_Depth * Tangent + _Axis * _Radius);
+        _rMaximum = (_Axis * Tangent + _Depth * _Radius) / (_Depth * Tangent - _Axis * _Radius);
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CDepthRasterizer::CDepthRasterizer()
+    : m_Width         (0)
+    , m_Height        (0)
+    , m_NumberOfTilesX(0)
+    , m_NumberOfTilesY(0)
+    , m_Near          (0.1f)
+    , m_Far           (100.0f)
+    , m_DepthMode     (SDepthMode::Standard)
+    , m_DepthScale    (0.0f)
+    , m_DepthBias     (0.0f)
+{
+    memset(&m_Statistics, 0, sizeof(m_Statistics));
+
+    SetDepthRange(m_Near, m_Far, m_DepthMode);
+    SetViewport(1, 1);
+}
+
+// -----------------------------------------------------------------------------
+
+CDepthRasterizer::~CDepthRasterizer()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthRasterizer::SetViewport(int _Width, int _Height)
+{
+    m_Width          = std::max(_Width , 1);
+    m_Height         = std::max(_Height, 1);
+    m_NumberOfTilesX = (m_Width  + s_TileSize - 1) / s_TileSize;
+    m_NumberOfTilesY = (m_Height + s_TileSize - 1) / s_TileSize;
+
+    m_Depths      .resize(m_Width * m_Height);
+    m_TileNearest .resize(m_NumberOfTilesX * m_NumberOfTilesY);
+    m_TileFarthest.resize(m_NumberOfTilesX * m_NumberOfTilesY);
+
+    BeginFrame();
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthRasterizer::SetDepthRange(float _Near, float _Far, SDepthMode::EMode _Mode)
+{
+    m_Near      = _Near;
+    m_Far       = _Far;
+    m_DepthMode = _Mode;
+
+    // -----------------------------------------------------------------------------
+    // The perspective depth is an affine function of 1 / w. With reversed Z the
+    // near plane maps to 1 and the far plane to 0. Together with a float buffer
+    // this cancels the precision loss of the 1 / w distribution, which is huge
+    // for a near / far ratio of 0.1 / 100.
+    // -----------------------------------------------------------------------------
+    if (m_DepthMode == SDepthMode::ReversedZ)
+    {
+        m_DepthScale =  (m_Far * m_Near) / (m_Far - m_Near);
+        m_DepthBias  = -m_Near / (m_Far - m_Near);
+    }
+    else
+    {
+        m_DepthScale = -(m_Far * m_Near) / (m_Far - m_Near);
+        m_DepthBias  =  m_Far / (m_Far - m_Near);
+    }
+
+    BeginFrame();
+}
+
+// -----------------------------------------------------------------------------
+
+SDepthMode::EMode CDepthRasterizer::GetDepthMode() const
+{
+    return m_DepthMode;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthRasterizer::BeginFrame()
+{
+    float ClearDepth = GetClearDepth();
+
+    std::fill(m_Depths      .begin(), m_Depths      .end(), ClearDepth);
+    std::fill(m_TileNearest .begin(), m_TileNearest .end(), ClearDepth);
+    std::fill(m_TileFarthest.begin(), m_TileFarthest.end(), ClearDepth);
+
+    memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthRasterizer::DrawTriangles(const float* _pVertices, int _VertexStride, const int* _pIndices, int _NumberOfIndices, const float* _pWorldViewProjectionMatrix, const SRasterState& _rState)
+{
+    SClipVertex   Triangle[3];
+    SClipVertex   Polygon[4];
+    SScreenVertex ScreenPolygon[4];
+
+    for (int IndexOfIndex = 0; IndexOfIndex + 2 < _NumberOfIndices; IndexOfIndex += 3)
+    {
+        for (int IndexOfVertex = 0; IndexOfVertex < 3; ++ IndexOfVertex)
+        {
+            TransformPosition(_pVertices + _pIndices[IndexOfIndex + IndexOfVertex] * _VertexStride, _pWorldViewProjectionMatrix, Triangle[IndexOfVertex]);
+        }
+
+        int NumberOfVertices = ClipNear(Triangle, m_Near, Polygon);
+
+        for (int IndexOfVertex = 0; IndexOfVertex < NumberOfVertices; ++ IndexOfVertex)
+        {
+            const SClipVertex& rVertex = Polygon[IndexOfVertex];
+
+            ScreenPolygon[IndexOfVertex].m_X     = (rVertex.m_X / rVertex.m_W * 0.5f + 0.5f) * m_Width;
+            ScreenPolygon[IndexOfVertex].m_Y     = (0.5f - rVertex.m_Y / rVertex.m_W * 0.5f) * m_Height;
+            ScreenPolygon[IndexOfVertex].m_Depth = GetDepthFromViewDepth(rVertex.m_W);
+        }
+
+        for (int IndexOfVertex = 2; IndexOfVertex < NumberOfVertices; ++ IndexOfVertex)
+        {
+            RasterizeTriangle(ScreenPolygon[0], ScreenPolygon[IndexOfVertex - 1], ScreenPolygon[IndexOfVertex], _rState);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CDepthRasterizer::IsSphereVisible(const float* _pWSCenter, float _Radius, const float* _pViewProjectionMatrix, const float* _pProjectionMatrix)
+{
+    SClipVertex Center;
+
+    TransformPosition(_pWSCenter, _pViewProjectionMatrix, Center);
+
+    ++ m_Statistics.m_NumberOfTestedObjects;
+
+    float NearestViewDepth = Center.m_W - _Radius;
+
+    if (NearestViewDepth <= m_Near) return true;
+
+    // -----------------------------------------------------------------------------
+    // Project the sphere conservatively as rectangle. The view space x and y of
+    // the center are taken back out of the clip space position with the scale of
+    // the projection. The sphere is visible if its nearest depth is in front of
+    // the farthest depth of any covered tile.
+    // -----------------------------------------------------------------------------
+    float MinSlopeX;
+    float MaxSlopeX;
+    float MinSlopeY;
+    float MaxSlopeY;
+
+    GetProjectedExtents(Center.m_X / _pProjectionMatrix[0], Center.m_W, _Radius, MinSlopeX, MaxSlopeX);
+    GetProjectedExtents(Center.m_Y / _pProjectionMatrix[5], Center.m_W, _Radius, MinSlopeY, MaxSlopeY);
+
+    float MinNDCX = MinSlopeX * _pProjectionMatrix[0];
+    float MaxNDCX = MaxSlopeX * _pProjectionMatrix[0];
+    float MinNDCY = MinSlopeY * _pProjectionMatrix[5];
+    float MaxNDCY = MaxSlopeY * _pProjectionMatrix[5];
+
+    int MinTileX = std::max(static_cast<int>(floorf((MinNDCX * 0.5f + 0.5f) * m_Width  / s_TileSize)), 0);
+    int MaxTileX = std::min(static_cast<int>(floorf((MaxNDCX * 0.5f + 0.5f) * m_Width  / s_TileSize)), m_NumberOfTilesX - 1);
+    int MinTileY = std::max(static_cast<int>(floorf((0.5f - MaxNDCY * 0.5f) * m_Height / s_TileSize)), 0);
+    int MaxTileY = std::min(static_cast<int>(floorf((0.5f - MinNDCY * 0.5f) * m_Height / s_TileSize)), m_NumberOfTilesY - 1);
+
+    if (MinTileX > MaxTileX || MinTileY > MaxTileY) return false;
+
+    float NearestDepth = GetDepthFromViewDepth(NearestViewDepth);
+
+    for (int TileY = MinTileY; TileY <= MaxTileY; ++ TileY)
+    {
+        for (int TileX = MinTileX; TileX <= MaxTileX; ++ TileX)
+        {
+            if (IsNearer(NearestDepth, m_TileFarthest[TileY * m_NumberOfTilesX + TileX])) return true;
+        }
+    }
+
+    ++ m_Statistics.m_NumberOfCulledObjects;
+
+    m_Statistics.m_NumberOfTileRejectedFragments += static_cast<long long>(MaxTileX - MinTileX + 1) * (MaxTileY - MinTileY + 1) * s_TileSize * s_TileSize;
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+float CDepthRasterizer::GetDepth(int _X, int _Y) const
+{
+    return m_Depths[_Y * m_Width + _X];
+}
+
+// -----------------------------------------------------------------------------
+
+float CDepthRasterizer::GetClearDepth() const
+{
+    return m_DepthMode == SDepthMode::ReversedZ ? 0.0f : 1.0f;
+}
+
+// -----------------------------------------------------------------------------
+
+const SDepthRasterizerStatistics& CDepthRasterizer::GetStatistics() const
+{
+    return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+float CDepthRasterizer::GetDepthFromViewDepth(float _ViewDepth) const
+{
+    return m_DepthScale / _ViewDepth + m_DepthBias;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CDepthRasterizer::IsNearer(float _Depth, float _StoredDepth) const
+{
+    return m_DepthMode == SDepthMode::ReversedZ ? _Depth > _StoredDepth : _Depth < _StoredDepth;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthRasterizer::RasterizeTriangle(const SScreenVertex& _rV0, const SScreenVertex& _rV1, const SScreenVertex& _rV2, const SRasterState& _rState)
+{
+    ++ m_Statistics.m_NumberOfTriangles;
+
+    float Area = (_rV1.m_X - _rV0.m_X) * (_rV2.m_Y - _rV0.m_Y) - (_rV1.m_Y - _rV0.m_Y) * (_rV2.m_X - _rV0.m_X);
+
+    if (Area == 0.0f) return;
+
+    // -----------------------------------------------------------------------------
+    // Bounding box of the triangle clamped to the viewport.
+    // -----------------------------------------------------------------------------
+    int MinX = std::max(static_cast<int>(floorf(std::min(std::min(_rV0.m_X, _rV1.m_X), _rV2.m_X))), 0);
+    int MinY = std::max(static_cast<int>(floorf(std::min(std::min(_rV0.m_Y, _rV1.m_Y), _rV2.m_Y))), 0);
+    int MaxX = std::min(static_cast<int>(ceilf (std::max(std::max(_rV0.m_X, _rV1.m_X), _rV2.m_X))), m_Width  - 1);
+    int MaxY = std::min(static_cast<int>(ceilf (std::max(std::max(_rV0.m_Y, _rV1.m_Y), _rV2.m_Y))), m_Height - 1);
+
+    if (MinX > MaxX || MinY > MaxY) return;
+
+    // -----------------------------------------------------------------------------
+    // The depth range of the triangle. With the nearest and farthest depth whole
+    // tiles can be rejected or accepted before any fragment is generated. This is
+    // only valid if the shader does not modify the depth.
+    // -----------------------------------------------------------------------------
+    float Nearest  = _rV0.m_Depth;
+    float Farthest = _rV0.m_Depth;
+
+    if (IsNearer(_rV1.m_Depth, Nearest )) Nearest  = _rV1.m_Depth;
+    if (IsNearer(_rV2.m_Depth, Nearest )) Nearest  = _rV2.m_Depth;
+    if (IsNearer(Farthest, _rV1.m_Depth)) Farthest = _rV1.m_Depth;
+    if (IsNearer(Farthest, _rV2.m_Depth)) Farthest = _rV2.m_Depth;
+
+    bool IsEarlyZ       = _rState.m_DepthTest != SDepthTest::Off && _rState.m_ShaderWritesDepth == false;
+    bool IsTriangleUsed = false;
+
+    float InverseArea = 1.0f / Area;
+
+    for (int TileY = MinY / s_TileSize; TileY <= MaxY / s_TileSize; ++ TileY)
+    {
+        for (int TileX = MinX / s_TileSize; TileX <= MaxX / s_TileSize; ++ TileX)
+        {
+            int   IndexOfTile  = TileY * m_NumberOfTilesX + TileX;
+            int   TileMinX     = std::max(TileX * s_TileSize, MinX);
+            int   TileMinY     = std::max(TileY * s_TileSize, MinY);
+            int   TileMaxX     = std::min(TileX * s_TileSize + s_TileSize - 1, MaxX);
+            int   TileMaxY     = std::min(TileY * s_TileSize + s_TileSize - 1, MaxY);
+            bool  IsAccepted   = false;
+
+            if (IsEarlyZ)
+            {
+                float TileNearest  = m_TileNearest [IndexOfTile];
+                float TileFarthest = m_TileFarthest[IndexOfTile];
+
+                bool IsRejected = false;
+
+                if (_rState.m_DepthTest == SDepthTest::Lesser)
+                {
+                    IsRejected = IsNearer(Nearest, TileFarthest) == false;
+                    IsAccepted = IsNearer(Farthest, TileNearest);
+                }
+                else
+                {
+                    IsRejected = IsNearer(TileFarthest, Nearest) || IsNearer(Farthest, TileNearest);
+                }
+
+                if (IsRejected)
+                {
+                    ++ m_Statistics.m_NumberOfRejectedTiles;
+
+                    m_Statistics.m_NumberOfTileRejectedFragments += (TileMaxX - TileMinX + 1) * (TileMaxY - TileMinY + 1);
+
+                    continue;
+                }
+
+                if (IsAccepted) ++ m_Statistics.m_NumberOfAcceptedTiles;
+            }
+
+            IsTriangleUsed = true;
+
+            bool IsTileWritten = false;
+
+            for (int Y = TileMinY; Y <= TileMaxY; ++ Y)
+            {
+                float PY = static_cast<float>(Y) + 0.5f;
+
+                for (int X = TileMinX; X <= TileMaxX; ++ X)
+                {
+                    float PX = static_cast<float>(X) + 0.5f;
+
+                    // -----------------------------------------------------------------------------
+                    // Barycentric coordinates via edge functions. Dividing by the
+                    // signed area makes the test independent of the winding.
+                    // -----------------------------------------------------------------------------
+                    float B0 = ((_rV1.m_X - PX) * (_rV2.m_Y - PY) - (_rV1.m_Y - PY) * (_rV2.m_X - PX)) * InverseArea;
+                    float B1 = ((_rV2.m_X - PX) * (_rV0.m_Y - PY) - (_rV2.m_Y - PY) * (_rV0.m_X - PX)) * InverseArea;
+                    float B2 = 1.0f - B0 - B1;
+
+                    if (B0 < 0.0f || B1 < 0.0f || B2 < 0.0f) continue;
+
+                    float  Depth       = B0 * _rV0.m_Depth + B1 * _rV1.m_Depth + B2 * _rV2.m_Depth;
+                    float& rStored     = m_Depths[Y * m_Width + X];
+
+                    if (IsEarlyZ && IsAccepted == false)
+                    {
+                        bool IsPassed = _rState.m_DepthTest == SDepthTest::Lesser ? IsNearer(Depth, rStored) : Depth == rStored;
+
+                        if (IsPassed == false)
+                        {
+                            ++ m_Statistics.m_NumberOfEarlyRejectedFragments;
+
+                            continue;
+                        }
+                    }
+
+                    if (_rState.m_pShadeFragment != nullptr)
+                    {
+                        ++ m_Statistics.m_NumberOfShadedFragments;
+
+                        Depth = _rState.m_pShadeFragment(X, Y, Depth, _rState.m_pUserData);
+                    }
+
+                    if (IsEarlyZ == false && _rState.m_DepthTest != SDepthTest::Off)
+                    {
+                        bool IsPassed = _rState.m_DepthTest == SDepthTest::Lesser ? IsNearer(Depth, rStored) : Depth == rStored;
+
+                        if (IsPassed == false)
+                        {
+                            ++ m_Statistics.m_NumberOfLateRejectedFragments;
+
+                            continue;
+                        }
+                    }
+
+                    rStored       = Depth;
+                    IsTileWritten = true;
+                }
+            }
+
+            if (IsTileWritten) UpdateTile(TileX, TileY);
+        }
+    }
+
+    if (IsTriangleUsed == false) ++ m_Statistics.m_NumberOfRejectedTriangles;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDepthRasterizer::UpdateTile(int _TileX, int _TileY)
+{
+    int MinX = _TileX * s_TileSize;
+    int MinY = _TileY * s_TileSize;
+    int MaxX = std::min(MinX + s_TileSize, m_Width);
+    int MaxY = std::min(MinY + s_TileSize, m_Height);
+
+    float Nearest  = m_Depths[MinY * m_Width + MinX];
+    float Farthest = Nearest;
+
+    for (int Y = MinY; Y < MaxY; ++ Y)
+    {
+        for (int X = MinX; X < MaxX; ++ X)
+        {
+            float Depth = m_Depths[Y * m_Width + X];
+
+            if (IsNearer(Depth, Nearest )) Nearest  = Depth;
+            if (IsNearer(Farthest, Depth)) Farthest = Depth;
+        }
+    }
+
+    m_TileNearest [_TileY * m_NumberOfTilesX + _TileX] = Nearest;
+    m_TileFarthest[_TileY * m_NumberOfTilesX + _TileX] = Farthest;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Called for each fragment passing the rasterization. Returns the depth of the
+// fragment, which is the passed depth unless the shader modifies it.
+// -----------------------------------------------------------------------------
+typedef float (*FShadeFragment)(int _X, int _Y, float _Depth, void* _pUserData);
+
+// -----------------------------------------------------------------------------
+
+struct SDepthMode
+{
+    enum EMode
+    {
+        Standard,                                                       ///< Near plane maps to 0 and far plane to 1, the buffer is cleared with 1.
+        ReversedZ,                                                      ///< Near plane maps to 1 and far plane to 0, the buffer is cleared with 0. Distributes the float precision much better over the view frustum.
+    };
+};
+
+// -----------------------------------------------------------------------------
+
+struct SRasterState
+{
+    gfx::SDepthTest::ETest m_DepthTest;                                 // The depth test, which has the semantic of the YoshiX depth test.
+    bool                   m_ShaderWritesDepth;                         // If false the depth test runs before the shader (early-Z), else after it.
+    FShadeFragment         m_pShadeFragment;                            // The fragment shader, can be null to only fill the depth buffer.
+    void*                  m_pUserData;                                 // Passed to the fragment shader.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SDepthRasterizerStatistics
+{
+    int       m_NumberOfTriangles;                                      // Triangles passed to the rasterizer.
+    int       m_NumberOfRejectedTriangles;                              // Triangles rejected completely by the tile depth ranges.
+    int       m_NumberOfRejectedTiles;                                  // Tiles skipped without touching a single pixel.
+    int       m_NumberOfAcceptedTiles;                                  // Tiles which passed completely, so no per pixel depth compare was needed.
+    long long m_NumberOfTileRejectedFragments;                          // Pixels of the triangle bounds skipped by tile and triangle rejection (upper bound of the fragments).
+    long long m_NumberOfEarlyRejectedFragments;                         // Fragments rejected by early-Z before the shader ran.
+    long long m_NumberOfLateRejectedFragments;                          // Fragments shaded but rejected afterwards, because the shader writes depth.
+    long long m_NumberOfShadedFragments;                                // Fragments the shader ran for.
+    int       m_NumberOfTestedObjects;                                  // Objects tested with 'IsSphereVisible'.
+    int       m_NumberOfCulledObjects;                                  // Objects which were completely hidden.
+};
+
+// -----------------------------------------------------------------------------
+// A software depth rasterizer with a hierarchical depth test. The viewport is
+// split into tiles of 8x8 pixels and each tile tracks the nearest and farthest
+// depth it contains. Before any pixel of a triangle is touched the depth range
+// of the triangle is compared to the range of each covered tile. Whole tiles
+// and triangles are rejected conservatively, tiles completely in front of the
+// stored depths are accepted without per pixel compare. If the shader does not
+// modify the depth the per pixel test happens before shading (early-Z).
+//
+// The rasterizer works on the same row vector matrices as YoshiX. It is used
+// to cull objects hidden behind occluders before they are submitted to the GPU.
+// -----------------------------------------------------------------------------
+class CDepthRasterizer
+{
+    public:
+
+        static const int s_TileSize = 8;
+
+    public:
+
+        CDepthRasterizer();
+        ~CDepthRasterizer();
+
+    public:
+
+        void SetViewport(int _Width, int _Height);
+        void SetDepthRange(float _Near, float _Far, SDepthMode::EMode _Mode);
+
+        SDepthMode::EMode GetDepthMode() const;
+
+        void BeginFrame();
+
+        void DrawTriangles(const float* _pVertices, int _VertexStride, const int* _pIndices, int _NumberOfIndices, const float* _pWorldViewProjectionMatrix, const SRasterState& _rState);
+
+        bool IsSphereVisible(const float* _pWSCenter, float _Radius, const float* _pViewProjectionMatrix, const float* _pProjectionMatrix);
+
+        float GetDepth(int _X, int _Y) const;
+        float GetClearDepth() const;
+
+        const SDepthRasterizerStatistics& GetStatistics() const;
+
+    private:
+
+        struct SScreenVertex
+        {
+            float m_X;                                                  // Screen space position in pixels.
+            float m_Y;
+            float m_Depth;                                              // Depth buffer value of the vertex.
+        };
+
+    private:
+
+        float GetDepthFromViewDepth(float _ViewDepth) const;
+        bool  IsNearer(float _Depth, float _StoredDepth) const;
+
+        void  RasterizeTriangle(const SScreenVertex& _rV0, const SScreenVertex& _rV1, const SScreenVertex& _rV2, const SRasterState& _rState);
+        void  UpdateTile(int _TileX, int _TileY);
+
+    private:
+
+        int                        m_Width;                             // Width of the viewport in pixels.
+        int                        m_Height;                            // Height of the viewport in pixels.
+        int                        m_NumberOfTilesX;                    // Number of tiles in horizontal direction.
+        int                        m_NumberOfTilesY;                    // Number of tiles in vertical direction.
+
+        float                      m_Near;                              // Near distance of the view frustum.
+        float                      m_Far;                               // Far distance of the view frustum.
+        SDepthMode::EMode          m_DepthMode;                         // Standard or reversed depth.
+        float                      m_DepthScale;                        // The depth is 'm_DepthScale / w + m_DepthBias' for view space depth w.
+        float                      m_DepthBias;
+
+        std::vector<float>         m_Depths;                            // The depth buffer, row by row.
+        std::vector<float>         m_TileNearest;                       // Nearest depth of each tile.
+        std::vector<float>         m_TileFarthest;                      // Farthest depth of each tile.
+
+        SDepthRasterizerStatistics m_Statistics;                        // Statistics of the current frame.
+};
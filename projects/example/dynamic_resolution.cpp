@@ -0,0 +1,161 @@
+#include "dynamic_resolution.h"
+
+#include <algorithm>
+#include <math.h>
+
+CDynamicResolution::CDynamicResolution()
+{
+    m_Settings.m_FrameTimeBudget  = 16.6f;
+    m_Settings.m_MinimumScale     = 0.5f;
+    m_Settings.m_MaximumScale     = 1.0f;
+    m_Settings.m_ScaleStep        = 1.0f / 32.0f;
+    m_Settings.m_Smoothing        = 0.25f;
+    m_Settings.m_ProportionalGain = 0.3f;
+    m_Settings.m_IntegralGain     = 0.08f;
+    m_Settings.m_DerivativeGain   = 0.05f;
+    m_Settings.m_Tolerance        = 0.05f;
+
+    Reset();
+    ResetStatistics();
+}
+
+// -----------------------------------------------------------------------------
+
+void CDynamicResolution::SetSettings(const SDynamicResolutionSettings& _rSettings)
+{
+    m_Settings = _rSettings;
+
+    Reset();
+}
+
+// -----------------------------------------------------------------------------
+
+void CDynamicResolution::SetBudget(float _FrameTimeBudget)
+{
+    // -----------------------------------------------------------------------------
+    // The controller continues from the current scale, only the errors of the
+    // old budget are dropped.
+    // -----------------------------------------------------------------------------
+    m_Settings.m_FrameTimeBudget = _FrameTimeBudget;
+
+    m_Errors[0] = 0.0;
+    m_Errors[1] = 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDynamicResolution::Reset()
+{
+    m_SmoothedFrameTime = 0.0;
+    m_Errors[0]         = 0.0;
+    m_Errors[1]         = 0.0;
+    m_Fraction          = m_Settings.m_MaximumScale * m_Settings.m_MaximumScale;
+    m_Scale             = m_Settings.m_MaximumScale;
+    m_LastChange        = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+const SDynamicResolutionSettings& CDynamicResolution::GetSettings() const
+{
+    return m_Settings;
+}
+
+// -----------------------------------------------------------------------------
+
+float CDynamicResolution::Update(double _FrameTime)
+{
+    // -----------------------------------------------------------------------------
+    // Adherence is measured on the real frame time, the controller works on
+    // the smoothed one, so single spikes do not throw the scale around.
+    // -----------------------------------------------------------------------------
+    m_Statistics.m_NumberOfFrames   += 1;
+    m_Statistics.m_TotalFrameTime   += _FrameTime;
+    m_Statistics.m_TotalScale       += m_Scale;
+    m_Statistics.m_MaximumFrameTime  = std::max(m_Statistics.m_MaximumFrameTime, _FrameTime);
+    m_Statistics.m_MinimumScale      = std::min(m_Statistics.m_MinimumScale, m_Scale);
+
+    if (_FrameTime <= m_Settings.m_FrameTimeBudget * (1.0 + m_Settings.m_Tolerance)) m_Statistics.m_NumberOfFramesInBudget += 1;
+
+    if (m_SmoothedFrameTime == 0.0)
+    {
+        m_SmoothedFrameTime = _FrameTime;
+    }
+    else
+    {
+        m_SmoothedFrameTime += (_FrameTime - m_SmoothedFrameTime) * m_Settings.m_Smoothing;
+    }
+
+    double Error = (m_Settings.m_FrameTimeBudget - m_SmoothedFrameTime) / m_Settings.m_FrameTimeBudget;
+
+    double Change = m_Settings.m_ProportionalGain * (Error - m_Errors[0])
+                  + m_Settings.m_IntegralGain     *  Error
+                  + m_Settings.m_DerivativeGain   * (Error - 2.0 * m_Errors[0] + m_Errors[1]);
+
+    m_Errors[1] = m_Errors[0];
+    m_Errors[0] = Error;
+
+    double MinimumFraction = m_Settings.m_MinimumScale * m_Settings.m_MinimumScale;
+    double MaximumFraction = m_Settings.m_MaximumScale * m_Settings.m_MaximumScale;
+
+    m_Fraction = std::min(std::max(m_Fraction + Change, MinimumFraction), MaximumFraction);
+
+    // -----------------------------------------------------------------------------
+    // Round the scale to the step, a scale which stays put changes no pixel.
+    // -----------------------------------------------------------------------------
+    float Scale = static_cast<float>(sqrt(m_Fraction));
+
+    if (m_Settings.m_ScaleStep > 0.0f) Scale = floorf(Scale / m_Settings.m_ScaleStep + 0.5f) * m_Settings.m_ScaleStep;
+
+    Scale = std::min(std::max(Scale, m_Settings.m_MinimumScale), m_Settings.m_MaximumScale);
+
+    if (Scale != m_Scale)
+    {
+        int Direction = Scale > m_Scale ? 1 : -1;
+
+        m_Statistics.m_NumberOfScaleChanges += 1;
+
+        if (Direction == -m_LastChange) m_Statistics.m_NumberOfReversals += 1;
+
+        m_LastChange = Direction;
+        m_Scale      = Scale;
+    }
+
+    return m_Scale;
+}
+
+// -----------------------------------------------------------------------------
+
+float CDynamicResolution::GetScale() const
+{
+    return m_Scale;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDynamicResolution::GetScaledSize(int _Width, int _Height, int& _rScaledWidth, int& _rScaledHeight) const
+{
+    _rScaledWidth  = std::max(static_cast<int>(_Width  * m_Scale + 0.5f), 1);
+    _rScaledHeight = std::max(static_cast<int>(_Height * m_Scale + 0.5f), 1);
+}
+
+// -----------------------------------------------------------------------------
+
+void CDynamicResolution::GetStatistics(SDynamicResolutionStatistics& _rStatistics) const
+{
+    _rStatistics = m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void CDynamicResolution::ResetStatistics()
+{
+    m_Statistics.m_NumberOfFrames         = 0;
+    m_Statistics.m_NumberOfFramesInBudget = 0;
+    m_Statistics.m_NumberOfScaleChanges   = 0;
+    m_Statistics.m_NumberOfReversals      = 0;
+    m_Statistics.m_TotalFrameTime         = 0.0;
+    m_Statistics.m_MaximumFrameTime       = 0.0;
+    m_Statistics.m_TotalScale             = 0.0;
+    m_Statistics.m_MinimumScale           = m_Settings.m_MaximumScale;
+}
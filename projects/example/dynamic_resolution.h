@@ -0,0 +1,87 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// The gains act on the relative error of the frame time, (budget - time) /
+// budget, and change the fraction of the pixels which are rendered, i.e. the
+// square of the scale.
+// -----------------------------------------------------------------------------
+struct SDynamicResolutionSettings
+{
+    float m_FrameTimeBudget;                                            // Milliseconds per frame the controller aims for.
+    float m_MinimumScale;                                               // Smallest scale of width and height.
+    float m_MaximumScale;                                               // Largest scale, usually 1.
+    float m_ScaleStep;                                                  // The scale is rounded to multiples of it, so it does not change for noise.
+    float m_Smoothing;                                                  // Weight of the new frame time in the smoothed one, 1 uses the frame time as it is.
+    float m_ProportionalGain;
+    float m_IntegralGain;
+    float m_DerivativeGain;
+    float m_Tolerance;                                                  // A frame up to budget * (1 + tolerance) counts as in budget.
+};
+
+// -----------------------------------------------------------------------------
+// Sums since the statistics were reset.
+// -----------------------------------------------------------------------------
+struct SDynamicResolutionStatistics
+{
+    int    m_NumberOfFrames;
+    int    m_NumberOfFramesInBudget;
+    int    m_NumberOfScaleChanges;
+    int    m_NumberOfReversals;                                         // Changes against the direction of the previous change, a measure for oscillation.
+    double m_TotalFrameTime;                                            // Milliseconds.
+    double m_MaximumFrameTime;
+    double m_TotalScale;
+    float  m_MinimumScale;
+};
+
+// -----------------------------------------------------------------------------
+// Scales the resolution the scene is rendered at, so the frame time stays
+// within a budget. A PID controller turns the smoothed frame time into the
+// fraction of pixels for the next frame. It works in the velocity form, each
+// frame changes the fraction by
+//
+//     Kp * (e - e') + Ki * e + Kd * (e - 2 * e' + e'')
+//
+// with the errors e, e', and e'' of the last three frames. The fraction itself
+// is the integral of the controller, so there is no integral which winds up
+// while the scale is clamped. The cost of a frame grows with its pixels, so
+// working on the fraction instead of the scale keeps the gains independent of
+// the current scale.
+// -----------------------------------------------------------------------------
+class CDynamicResolution
+{
+    public:
+
+        CDynamicResolution();
+
+    public:
+
+        void SetSettings(const SDynamicResolutionSettings& _rSettings);
+        void SetBudget(float _FrameTimeBudget);
+        void Reset();                                                   // Back to the maximum scale, the statistics are kept.
+
+        const SDynamicResolutionSettings& GetSettings() const;
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Takes the time of the last frame in milliseconds and returns the scale
+        // of width and height for the next one.
+        // -----------------------------------------------------------------------------
+        float Update(double _FrameTime);
+
+        float GetScale() const;
+        void  GetScaledSize(int _Width, int _Height, int& _rScaledWidth, int& _rScaledHeight) const;
+
+        void GetStatistics(SDynamicResolutionStatistics& _rStatistics) const;
+        void ResetStatistics();
+
+    private:
+
+        SDynamicResolutionSettings   m_Settings;
+        double                       m_SmoothedFrameTime;               // 0 before the first frame.
+        double                       m_Errors[2];                       // Of the last and the second last frame.
+        double                       m_Fraction;                        // Fraction of the pixels, not rounded.
+        float                        m_Scale;                           // Rounded to the scale step.
+        int                          m_LastChange;                      // Sign of the last change of the scale.
+        SDynamicResolutionStatistics m_Statistics;
+};
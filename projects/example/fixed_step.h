@@ -0,0 +1,234 @@
+#pragma once
+
+#include "frame_statistics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+
+struct SFixedStepStatistics
+{
+    int    m_NumberOfSteps;                                             // Simulation steps since the start.
+    int    m_NumberOfSkippedSteps;                                      // Steps dropped because the simulation fell too far behind.
+    int    m_NumberOfFrames;                                            // Frames since the start.
+    double m_StepTime;                                                  // Time spent in the step function in milliseconds.
+    double m_FrameTime;                                                 // Time spent between 'BeginFrame' and 'EndFrame' in milliseconds.
+    double m_OverlapTime;                                               // Step time while a frame was rendered at the same time in milliseconds.
+    double m_ElapsedTime;                                               // Time since the start in milliseconds.
+};
+
+// -----------------------------------------------------------------------------
+// Runs the simulation at a fixed rate on its own thread, independent of the
+// frame rate. The step function gets a copy of the last state and advances it
+// by exactly one step. The render thread takes the last two states in
+// 'BeginFrame' and blends them with the returned factor, so it shows the state
+// of one step ago, but moves smoothly at any frame rate. Both threads only
+// share the two states, which are copied under a lock, so the state should be
+// small, e.g. camera and animation parameters, not the whole scene.
+//
+// The overlap time is the part of the step time during which the render thread
+// was inside a frame, i.e. the work done in parallel instead of in sequence.
+// -----------------------------------------------------------------------------
+template<typename TState>
+class TFixedStepLoop
+{
+    public:
+
+        typedef void (*FStep)(TState& _rState, float _StepTime, void* _pUserData);
+
+    public:
+
+        TFixedStepLoop()
+            : m_StepTime      (0.0)
+            , m_pStep         (nullptr)
+            , m_pUserData     (nullptr)
+            , m_CurrentTime   (0.0)
+            , m_Statistics    ()
+            , m_IsRunning     (false)
+            , m_IsRendering   (false)
+            , m_FrameStartTime(0.0)
+            , m_FrameEndTime  (0.0)
+        {
+        }
+
+        ~TFixedStepLoop()
+        {
+            Stop();
+        }
+
+        TFixedStepLoop(const TFixedStepLoop&) = delete;
+        TFixedStepLoop& operator = (const TFixedStepLoop&) = delete;
+
+    public:
+
+        void Start(const TState& _rState, float _StepsPerSecond, FStep _pStep, void* _pUserData)
+        {
+            Stop();
+
+            m_Previous    = _rState;
+            m_Current     = _rState;
+            m_StepTime    = 1000.0 / _StepsPerSecond;
+            m_pStep       = _pStep;
+            m_pUserData   = _pUserData;
+            m_Statistics  = SFixedStepStatistics();
+
+            m_Clock.Start();
+
+            m_CurrentTime = 0.0;
+            m_IsRunning   = true;
+            m_Thread      = std::thread(&TFixedStepLoop::Run, this);
+        }
+
+        void Stop()
+        {
+            if (m_Thread.joinable() == false) return;
+
+            m_IsRunning = false;
+
+            m_Thread.join();
+        }
+
+        // -----------------------------------------------------------------------------
+        // Copies the last two states and returns the blend factor between them.
+        // -----------------------------------------------------------------------------
+        float BeginFrame(TState& _rPrevious, TState& _rCurrent)
+        {
+            double Time = m_Clock.GetElapsedMilliseconds();
+
+            m_FrameStartTime = Time;
+            m_IsRendering    = true;
+
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+
+            _rPrevious = m_Previous;
+            _rCurrent  = m_Current;
+
+            if (m_StepTime <= 0.0) return 1.0f;
+
+            return static_cast<float>(std::min(std::max((Time - m_CurrentTime) / m_StepTime, 0.0), 1.0));
+        }
+
+        void EndFrame()
+        {
+            double Time = m_Clock.GetElapsedMilliseconds();
+
+            m_FrameEndTime = Time;
+            m_IsRendering  = false;
+
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+
+            m_Statistics.m_NumberOfFrames += 1;
+            m_Statistics.m_FrameTime      += Time - m_FrameStartTime;
+        }
+
+        SFixedStepStatistics GetStatistics() const
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+
+            SFixedStepStatistics Statistics = m_Statistics;
+
+            Statistics.m_ElapsedTime = m_Clock.GetElapsedMilliseconds();
+
+            return Statistics;
+        }
+
+    private:
+
+        static const int s_MaximumLag = 8;                              // Steps the simulation may fall behind before steps are dropped.
+
+    private:
+
+        TState               m_Previous;                                // The state before the last step.
+        TState               m_Current;                                 // The state after the last step.
+        double               m_StepTime;                                // Milliseconds per step.
+        FStep                m_pStep;
+        void*                m_pUserData;
+        double               m_CurrentTime;                             // The scheduled time of the current state.
+        SFixedStepStatistics m_Statistics;
+
+        mutable std::mutex   m_Mutex;                                   // Guards the states and the statistics.
+        std::thread          m_Thread;
+        std::atomic<bool>    m_IsRunning;
+        std::atomic<bool>    m_IsRendering;                             // True between 'BeginFrame' and 'EndFrame'.
+        std::atomic<double>  m_FrameStartTime;
+        std::atomic<double>  m_FrameEndTime;
+        CStopwatch           m_Clock;                                   // Time base of all time stamps.
+
+    private:
+
+        void Run()
+        {
+            TState State        = m_Current;
+            double NextStepTime = m_CurrentTime + m_StepTime;
+
+            while (m_IsRunning)
+            {
+                double Time = m_Clock.GetElapsedMilliseconds();
+
+                // -----------------------------------------------------------------------------
+                // Sleep until the next step is due. Sleeping is coarse on some systems, so
+                // the last millisecond is spent yielding.
+                // -----------------------------------------------------------------------------
+                if (Time < NextStepTime)
+                {
+                    if (NextStepTime - Time > 1.5)
+                    {
+                        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>((NextStepTime - Time - 1.0) * 1000.0)));
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    continue;
+                }
+
+                int NumberOfSkippedSteps = 0;
+
+                if (Time - NextStepTime > s_MaximumLag * m_StepTime)
+                {
+                    NumberOfSkippedSteps = static_cast<int>((Time - NextStepTime) / m_StepTime);
+
+                    NextStepTime += NumberOfSkippedSteps * m_StepTime;
+                }
+
+                m_pStep(State, static_cast<float>(m_StepTime / 1000.0), m_pUserData);
+
+                double EndTime = m_Clock.GetElapsedMilliseconds();
+
+                // -----------------------------------------------------------------------------
+                // The part of the step during which a frame was in flight, either the
+                // current frame or the one which ended during the step.
+                // -----------------------------------------------------------------------------
+                double FrameStartTime = m_FrameStartTime;
+                double FrameEndTime   = m_FrameEndTime;
+                double OverlapTime    = 0.0;
+
+                if (m_IsRendering)
+                {
+                    OverlapTime = EndTime - std::max(Time, FrameStartTime);
+                }
+                else if (FrameEndTime > Time && FrameStartTime <= FrameEndTime)
+                {
+                    OverlapTime = FrameEndTime - std::max(Time, FrameStartTime);
+                }
+
+                std::lock_guard<std::mutex> Lock(m_Mutex);
+
+                m_Previous    = m_Current;
+                m_Current     = State;
+                m_CurrentTime = NextStepTime;
+
+                m_Statistics.m_NumberOfSteps        += 1;
+                m_Statistics.m_NumberOfSkippedSteps += NumberOfSkippedSteps;
+                m_Statistics.m_StepTime             += EndTime - Time;
+                m_Statistics.m_OverlapTime          += std::max(OverlapTime, 0.0);
+
+                NextStepTime += m_StepTime;
+            }
+        }
+};
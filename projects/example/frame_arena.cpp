@@ -0,0 +1,84 @@
+
+#include "frame_arena.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+
+CFrameArena::CFrameArena(size_t _Capacity)
+    : m_pMemory                  (static_cast<char*>(malloc(_Capacity)))
+    , m_Capacity                 (m_pMemory != nullptr ? _Capacity : 0)
+    , m_Offset                   (0)
+    , m_PeakSize                 (0)
+    , m_NumberOfFailedAllocations(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CFrameArena::~CFrameArena()
+{
+    free(m_pMemory);
+}
+
+// -----------------------------------------------------------------------------
+
+void* CFrameArena::Allocate(size_t _NumberOfBytes, size_t _Alignment)
+{
+    assert(_Alignment != 0 && (_Alignment & (_Alignment - 1)) == 0);
+
+    // -----------------------------------------------------------------------------
+    // Align the address, not the offset, malloc only guarantees 16 bytes.
+    // -----------------------------------------------------------------------------
+    size_t Address = reinterpret_cast<size_t>(m_pMemory) + m_Offset;
+    size_t Offset  = m_Offset + ((_Alignment - Address % _Alignment) % _Alignment);
+
+    if (Offset > m_Capacity || _NumberOfBytes > m_Capacity - Offset)
+    {
+        ++ m_NumberOfFailedAllocations;
+
+        return nullptr;
+    }
+
+    m_Offset = Offset + _NumberOfBytes;
+
+    if (m_Offset > m_PeakSize) m_PeakSize = m_Offset;
+
+    return m_pMemory + Offset;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFrameArena::Reset()
+{
+    m_Offset = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CFrameArena::GetCapacity() const
+{
+    return m_Capacity;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CFrameArena::GetUsedSize() const
+{
+    return m_Offset;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CFrameArena::GetPeakSize() const
+{
+    return m_PeakSize;
+}
+
+// -----------------------------------------------------------------------------
+
+int CFrameArena::GetNumberOfFailedAllocations() const
+{
+    return m_NumberOfFailedAllocations;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+// Linear allocator for data which lives exactly one frame, e.g. the visible
+// objects and the draw list. Allocating only moves an offset, 'Reset' at the
+// start of the frame frees everything at once. The memory is allocated once in
+// the constructor; if a frame needs more, the allocation fails with nullptr
+// and is counted, so the capacity can be raised instead of silently falling
+// back to the heap.
+// -----------------------------------------------------------------------------
+class CFrameArena
+{
+    public:
+
+        explicit CFrameArena(size_t _Capacity);
+        ~CFrameArena();
+
+        CFrameArena(const CFrameArena&) = delete;
+        CFrameArena& operator = (const CFrameArena&) = delete;
+
+    public:
+
+        void* Allocate(size_t _NumberOfBytes, size_t _Alignment = 16);
+
+        template<typename T>
+        T* AllocateArray(size_t _NumberOfElements)
+        {
+            return static_cast<T*>(Allocate(_NumberOfElements * sizeof(T), alignof(T) > 16 ? alignof(T) : 16));
+        }
+
+        void Reset();
+
+        size_t GetCapacity() const;
+        size_t GetUsedSize() const;
+        size_t GetPeakSize() const;                                     // Largest used size of all frames.
+        int    GetNumberOfFailedAllocations() const;
+
+    private:
+
+        char*  m_pMemory;
+        size_t m_Capacity;
+        size_t m_Offset;
+        size_t m_PeakSize;
+        int    m_NumberOfFailedAllocations;
+};
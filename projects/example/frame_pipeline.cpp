@@ -0,0 +1,255 @@
+
+#include "frame_pipeline.h"
+
+#include <assert.h>
+
+CFence::CFence()
+    : m_Value      (0)
+    , m_IsCancelled(false)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CFence::Reset()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_Value       = 0;
+    m_IsCancelled = false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFence::Signal(unsigned long long _Value)
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        assert(_Value >= m_Value);
+
+        m_Value = _Value;
+    }
+
+    m_Condition.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CFence::Wait(unsigned long long _Value)
+{
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    m_Condition.wait(Lock, [&]() { return m_Value >= _Value || m_IsCancelled; });
+
+    return m_IsCancelled == false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFence::Cancel()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        m_IsCancelled = true;
+    }
+
+    m_Condition.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CFence::GetValue() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    return m_Value;
+}
+
+// -----------------------------------------------------------------------------
+
+CFramePipeline::CFramePipeline()
+    : m_NumberOfFramesInFlight(1)
+    , m_pBuild                (nullptr)
+    , m_pUserData             (nullptr)
+    , m_IsRunning             (false)
+    , m_IndexOfFrame          (0)
+    , m_Statistics            ()
+{
+    for (double& rTime : m_BuildStartTimes) rTime = 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+CFramePipeline::~CFramePipeline()
+{
+    Stop();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CFramePipeline::Start(int _NumberOfFramesInFlight, FBuild _pBuild, void* _pUserData)
+{
+    Stop();
+
+    if (_NumberOfFramesInFlight < 1 || _NumberOfFramesInFlight > s_MaximumNumberOfFramesInFlight || _pBuild == nullptr) return false;
+
+    m_NumberOfFramesInFlight = _NumberOfFramesInFlight;
+    m_pBuild                 = _pBuild;
+    m_pUserData              = _pUserData;
+    m_IndexOfFrame           = 0;
+
+    m_BuiltFence   .Reset();
+    m_RenderedFence.Reset();
+
+    m_Statistics = SFramePipelineStatistics();
+
+    m_Statistics.m_NumberOfFramesInFlight = _NumberOfFramesInFlight;
+
+    m_Clock.Start();
+
+    m_IsRunning = true;
+
+    if (m_NumberOfFramesInFlight > 1)
+    {
+        m_Thread = std::thread(&CFramePipeline::Run, this);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFramePipeline::Stop()
+{
+    if (m_IsRunning == false) return;
+
+    m_BuiltFence   .Cancel();
+    m_RenderedFence.Cancel();
+
+    if (m_Thread.joinable()) m_Thread.join();
+
+    m_IsRunning = false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CFramePipeline::IsRunning() const
+{
+    return m_IsRunning;
+}
+
+// -----------------------------------------------------------------------------
+
+int CFramePipeline::GetNumberOfFramesInFlight() const
+{
+    return m_NumberOfFramesInFlight;
+}
+
+// -----------------------------------------------------------------------------
+
+int CFramePipeline::BeginFrame()
+{
+    if (m_IsRunning == false) return -1;
+
+    int IndexOfSlot = static_cast<int>(m_IndexOfFrame % m_NumberOfFramesInFlight);
+
+    double Time = m_Clock.GetElapsedMilliseconds();
+
+    if (m_NumberOfFramesInFlight == 1)
+    {
+        m_BuildStartTimes[IndexOfSlot] = Time;
+
+        m_pBuild(IndexOfSlot, m_pUserData);
+
+        AddBuildTimes(0.0, m_Clock.GetElapsedMilliseconds() - Time);
+
+        return IndexOfSlot;
+    }
+
+    if (m_BuiltFence.Wait(m_IndexOfFrame + 1) == false) return -1;
+
+    double WaitTime = m_Clock.GetElapsedMilliseconds() - Time;
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_Statistics.m_RenderWaitTime += WaitTime;
+
+    return IndexOfSlot;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFramePipeline::EndFrame()
+{
+    if (m_IsRunning == false) return;
+
+    int IndexOfSlot = static_cast<int>(m_IndexOfFrame % m_NumberOfFramesInFlight);
+
+    double Latency = m_Clock.GetElapsedMilliseconds() - m_BuildStartTimes[IndexOfSlot];
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        m_Statistics.m_NumberOfFrames += 1;
+        m_Statistics.m_Latency        += Latency;
+    }
+
+    m_IndexOfFrame += 1;
+
+    m_RenderedFence.Signal(m_IndexOfFrame);
+}
+
+// -----------------------------------------------------------------------------
+
+SFramePipelineStatistics CFramePipeline::GetStatistics() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    SFramePipelineStatistics Statistics = m_Statistics;
+
+    Statistics.m_ElapsedTime = m_Clock.GetElapsedMilliseconds();
+
+    return Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFramePipeline::Run()
+{
+    for (unsigned long long IndexOfFrame = 0; ; ++ IndexOfFrame)
+    {
+        int IndexOfSlot = static_cast<int>(IndexOfFrame % m_NumberOfFramesInFlight);
+
+        double Time = m_Clock.GetElapsedMilliseconds();
+
+        // -----------------------------------------------------------------------------
+        // The slot is free once the frame which used it before was rendered.
+        // -----------------------------------------------------------------------------
+        if (IndexOfFrame >= static_cast<unsigned long long>(m_NumberOfFramesInFlight))
+        {
+            if (m_RenderedFence.Wait(IndexOfFrame - m_NumberOfFramesInFlight + 1) == false) return;
+        }
+
+        double StartTime = m_Clock.GetElapsedMilliseconds();
+
+        m_pBuild(IndexOfSlot, m_pUserData);
+
+        m_BuildStartTimes[IndexOfSlot] = StartTime;
+
+        AddBuildTimes(StartTime - Time, m_Clock.GetElapsedMilliseconds() - StartTime);
+
+        m_BuiltFence.Signal(IndexOfFrame + 1);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CFramePipeline::AddBuildTimes(double _WaitTime, double _BuildTime)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_Statistics.m_BuildWaitTime += _WaitTime;
+    m_Statistics.m_BuildTime     += _BuildTime;
+}
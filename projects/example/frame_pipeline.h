@@ -0,0 +1,123 @@
+#pragma once
+
+#include "frame_statistics.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+// A counter one thread signals and other threads wait for, like a GPU fence.
+// The value only grows until 'Reset'. 'Cancel' wakes all waiting threads, e.g.
+// to stop a thread which waits for a frame which will never come.
+// -----------------------------------------------------------------------------
+class CFence
+{
+    public:
+
+        CFence();
+
+        CFence(const CFence&) = delete;
+        CFence& operator = (const CFence&) = delete;
+
+    public:
+
+        void Reset();
+        void Signal(unsigned long long _Value);
+        bool Wait(unsigned long long _Value);                           // False if the fence was cancelled.
+        void Cancel();
+
+        unsigned long long GetValue() const;
+
+    private:
+
+        mutable std::mutex      m_Mutex;
+        std::condition_variable m_Condition;
+        unsigned long long      m_Value;
+        bool                    m_IsCancelled;
+};
+
+// -----------------------------------------------------------------------------
+
+struct SFramePipelineStatistics
+{
+    int    m_NumberOfFramesInFlight;
+    int    m_NumberOfFrames;                                            // Frames rendered since the start.
+    double m_BuildTime;                                                 // Time spent building frames in milliseconds.
+    double m_RenderWaitTime;                                            // Time the render thread waited for a built frame in milliseconds.
+    double m_BuildWaitTime;                                             // Time the build thread waited for a free slot in milliseconds.
+    double m_Latency;                                                   // Sum of the times from the start of the build to the end of the frame in milliseconds.
+    double m_ElapsedTime;                                               // Time since the start in milliseconds.
+};
+
+// -----------------------------------------------------------------------------
+// Builds the next frames on a worker thread while the render thread submits
+// the current one. The data of a frame, e.g. culled and sorted draw lists and
+// constants, is kept in one of N slots owned by the caller; the build function
+// fills the slot it is given and must not touch anything the render thread
+// uses. Two fences keep the threads apart: the render thread waits until the
+// slot of its frame is built, the build thread waits until the frame which
+// used the slot before was rendered. So the build thread runs at most N - 1
+// frames ahead, which adds up to N - 1 frames of latency.
+//
+// With one frame in flight no thread is started and 'BeginFrame' builds the
+// frame itself, which is the serial loop as reference. Everything the build
+// function reads from outside, e.g. the projection matrix, may only be changed
+// while the pipeline is stopped.
+// -----------------------------------------------------------------------------
+class CFramePipeline
+{
+    public:
+
+        static const int s_MaximumNumberOfFramesInFlight = 4;
+
+        typedef void (*FBuild)(int _IndexOfSlot, void* _pUserData);
+
+    public:
+
+        CFramePipeline();
+        ~CFramePipeline();
+
+        CFramePipeline(const CFramePipeline&) = delete;
+        CFramePipeline& operator = (const CFramePipeline&) = delete;
+
+    public:
+
+        bool Start(int _NumberOfFramesInFlight, FBuild _pBuild, void* _pUserData);
+        void Stop();
+
+        bool IsRunning() const;
+        int  GetNumberOfFramesInFlight() const;
+
+        // -----------------------------------------------------------------------------
+        // Call both on the render thread. 'BeginFrame' returns the slot of the frame
+        // to render, or -1 if the pipeline is stopped. The slot is handed back to
+        // the build thread by 'EndFrame'.
+        // -----------------------------------------------------------------------------
+        int  BeginFrame();
+        void EndFrame();
+
+        SFramePipelineStatistics GetStatistics() const;
+
+    private:
+
+        int                      m_NumberOfFramesInFlight;
+        FBuild                   m_pBuild;
+        void*                    m_pUserData;
+        bool                     m_IsRunning;
+        unsigned long long       m_IndexOfFrame;                        // The frame the render thread renders next.
+
+        CFence                   m_BuiltFence;                          // Number of frames built.
+        CFence                   m_RenderedFence;                       // Number of frames rendered, the slot of a rendered frame is free.
+        double                   m_BuildStartTimes[s_MaximumNumberOfFramesInFlight];    // Written before the built fence is signalled.
+
+        mutable std::mutex       m_Mutex;                               // Guards the statistics.
+        SFramePipelineStatistics m_Statistics;
+        std::thread              m_Thread;
+        CStopwatch               m_Clock;                               // Time base of all time stamps.
+
+    private:
+
+        void Run();
+        void AddBuildTimes(double _WaitTime, double _BuildTime);
+};
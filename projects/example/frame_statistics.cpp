@@ -0,0 +1,71 @@
+
+#include "frame_statistics.h"
+
+CStopwatch::CStopwatch()
+    : m_StartTime(std::chrono::high_resolution_clock::now())
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CStopwatch::Start()
+{
+    m_StartTime = std::chrono::high_resolution_clock::now();
+}
+
+// -----------------------------------------------------------------------------
+
+double CStopwatch::GetElapsedMilliseconds() const
+{
+    std::chrono::duration<double, std::milli> Elapsed = std::chrono::high_resolution_clock::now() - m_StartTime;
+
+    return Elapsed.count();
+}
+
+// -----------------------------------------------------------------------------
+
+CFrameStatistics::CFrameStatistics()
+    : m_IsRunning     (false)
+    , m_NumberOfFrames(0)
+    , m_TotalFrameTime(0.0)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CFrameStatistics::Reset()
+{
+    m_IsRunning      = false;
+    m_NumberOfFrames = 0;
+    m_TotalFrameTime = 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFrameStatistics::OnFrame()
+{
+    if (m_IsRunning)
+    {
+        m_TotalFrameTime += m_Stopwatch.GetElapsedMilliseconds();
+
+        ++ m_NumberOfFrames;
+    }
+
+    m_IsRunning = true;
+
+    m_Stopwatch.Start();
+}
+
+// -----------------------------------------------------------------------------
+
+int CFrameStatistics::GetNumberOfFrames() const
+{
+    return m_NumberOfFrames;
+}
+
+// -----------------------------------------------------------------------------
+
+double CFrameStatistics::GetAverageFrameTime() const
+{
+    return m_NumberOfFrames > 0 ? m_TotalFrameTime / static_cast<double>(m_NumberOfFrames) : 0.0;
+}
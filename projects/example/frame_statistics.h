@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+
+// -----------------------------------------------------------------------------
+// A simple stopwatch based on the high resolution clock of the standard library.
+// -----------------------------------------------------------------------------
+class CStopwatch
+{
+    public:
+
+        CStopwatch();
+
+    public:
+
+        void   Start();
+        double GetElapsedMilliseconds() const;
+
+    private:
+
+        std::chrono::high_resolution_clock::time_point m_StartTime;     // The point in time the stopwatch was started.
+};
+
+// -----------------------------------------------------------------------------
+// Accumulates the time between two consecutive frames. Call 'OnFrame' exactly
+// once per frame, the first call only starts the measurement.
+// -----------------------------------------------------------------------------
+class CFrameStatistics
+{
+    public:
+
+        CFrameStatistics();
+
+    public:
+
+        void   Reset();
+        void   OnFrame();
+
+        int    GetNumberOfFrames() const;
+        double GetAverageFrameTime() const;                             // The average time of one frame in milliseconds.
+
+    private:
+
+        CStopwatch m_Stopwatch;                                         // Measures the time since the last frame.
+        bool       m_IsRunning;                                         // False until the first frame was seen after a reset.
+        int        m_NumberOfFrames;                                    // The number of measured frames since the last reset.
+        double     m_TotalFrameTime;                                    // The sum of all measured frame times in milliseconds.
+};
@@ -0,0 +1,227 @@
+
+#include "gbuffer_layout.h"
+
+#include <math.h>
+
+namespace
+{
+    const int s_DepthBytes  = 4;                                        // D24S8 or D32.
+    const int s_TargetBytes = 4;                                        // Four 8 bit channels.
+
+    // -----------------------------------------------------------------------------
+
+    float GetSign(float _Value)
+    {
+        return _Value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float Saturate(float _Value)
+    {
+        return _Value < 0.0f ? 0.0f : (_Value > 1.0f ? 1.0f : _Value);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Quantizes a value from 0 to 1 like a UNORM channel of the given bit count.
+    // -----------------------------------------------------------------------------
+    unsigned int Quantize(float _Value, unsigned int _Maximum)
+    {
+        return static_cast<unsigned int>(Saturate(_Value) * static_cast<float>(_Maximum) + 0.5f);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The channels are packed like a R8G8B8A8 texel, R in the lowest byte.
+    // -----------------------------------------------------------------------------
+    unsigned int PackChannels(unsigned int _R, unsigned int _G, unsigned int _B, unsigned int _A)
+    {
+        return _R | (_G << 8) | (_B << 16) | (_A << 24);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetChannel(unsigned int _Packed, int _Channel)
+    {
+        return (_Packed >> (_Channel * 8)) & 0xFF;
+    }
+} // namespace
+
+void GetGBufferCost(SGBufferLayout::ELayout _Layout, SNormalEncoding::EEncoding _Encoding, int _Width, int _Height, SGBufferCost& _rCost)
+{
+    int NormalBytes;
+
+    switch (_Encoding)
+    {
+        case SNormalEncoding::OctahedralRG8:  NormalBytes = 2; break;
+        case SNormalEncoding::OctahedralRG16: NormalBytes = 4; break;
+        default:                              NormalBytes = 4; break;       // There is no 24 bit format.
+    }
+
+    _rCost.m_NumberOfColorTargets   = 2;
+    _rCost.m_BytesPerPixel          = s_DepthBytes + NormalBytes + s_TargetBytes;
+    _rCost.m_AllocatedBytesPerPixel = s_DepthBytes + s_TargetBytes + s_TargetBytes;
+    _rCost.m_PostBytesPerSample     = s_DepthBytes + NormalBytes;
+
+    if (_Layout == SGBufferLayout::Standard)
+    {
+        // -----------------------------------------------------------------------------
+        // The first pass writes depth and normal, the second pass tests against the
+        // depth with 'Equal' and writes the color.
+        // -----------------------------------------------------------------------------
+        _rCost.m_NumberOfColorTargets   = 1;
+        _rCost.m_NumberOfGeometryPasses = 2;
+        _rCost.m_GeometryBytesPerPixel  = (s_DepthBytes + NormalBytes) + (s_DepthBytes + s_TargetBytes);
+    }
+    else
+    {
+        _rCost.m_NumberOfGeometryPasses = 1;
+        _rCost.m_GeometryBytesPerPixel  = s_DepthBytes + NormalBytes + s_TargetBytes;
+    }
+
+    _rCost.m_Memory = static_cast<long long>(_Width) * _Height * _rCost.m_AllocatedBytesPerPixel;
+}
+
+// -----------------------------------------------------------------------------
+
+void EncodeOctahedral(const float* _pNormal, float* _pEncoded)
+{
+    // -----------------------------------------------------------------------------
+    // Project the normal onto the octahedron |x| + |y| + |z| = 1 and fold the
+    // lower half over the diagonals into the outer triangles of the square.
+    // -----------------------------------------------------------------------------
+    float Length = fabsf(_pNormal[0]) + fabsf(_pNormal[1]) + fabsf(_pNormal[2]);
+
+    float X = _pNormal[0] / Length;
+    float Y = _pNormal[1] / Length;
+
+    if (_pNormal[2] < 0.0f)
+    {
+        float FoldedX = (1.0f - fabsf(Y)) * GetSign(X);
+        float FoldedY = (1.0f - fabsf(X)) * GetSign(Y);
+
+        X = FoldedX;
+        Y = FoldedY;
+    }
+
+    _pEncoded[0] = X * 0.5f + 0.5f;
+    _pEncoded[1] = Y * 0.5f + 0.5f;
+}
+
+// -----------------------------------------------------------------------------
+
+void DecodeOctahedral(const float* _pEncoded, float* _pNormal)
+{
+    float X = _pEncoded[0] * 2.0f - 1.0f;
+    float Y = _pEncoded[1] * 2.0f - 1.0f;
+    float Z = 1.0f - fabsf(X) - fabsf(Y);
+
+    if (Z < 0.0f)
+    {
+        float UnfoldedX = (1.0f - fabsf(Y)) * GetSign(X);
+        float UnfoldedY = (1.0f - fabsf(X)) * GetSign(Y);
+
+        X = UnfoldedX;
+        Y = UnfoldedY;
+    }
+
+    float Length = sqrtf(X * X + Y * Y + Z * Z);
+
+    _pNormal[0] = X / Length;
+    _pNormal[1] = Y / Length;
+    _pNormal[2] = Z / Length;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned int PackNormal(const float* _pNormal, SNormalEncoding::EEncoding _Encoding)
+{
+    float Encoded[2];
+
+    switch (_Encoding)
+    {
+        case SNormalEncoding::OctahedralRG8:
+        {
+            EncodeOctahedral(_pNormal, Encoded);
+
+            return PackChannels(Quantize(Encoded[0], 255), Quantize(Encoded[1], 255), 0, 0);
+        }
+
+        case SNormalEncoding::OctahedralRG16:
+        {
+            EncodeOctahedral(_pNormal, Encoded);
+
+            unsigned int X = Quantize(Encoded[0], 65535);
+            unsigned int Y = Quantize(Encoded[1], 65535);
+
+            return PackChannels(X >> 8, Y >> 8, X & 0xFF, Y & 0xFF);
+        }
+
+        default:
+        {
+            return PackChannels(Quantize(_pNormal[0] * 0.5f + 0.5f, 255), Quantize(_pNormal[1] * 0.5f + 0.5f, 255), Quantize(_pNormal[2] * 0.5f + 0.5f, 255), 0);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void UnpackNormal(unsigned int _Packed, SNormalEncoding::EEncoding _Encoding, float* _pNormal)
+{
+    float Encoded[2];
+
+    switch (_Encoding)
+    {
+        case SNormalEncoding::OctahedralRG8:
+        {
+            Encoded[0] = static_cast<float>(GetChannel(_Packed, 0)) / 255.0f;
+            Encoded[1] = static_cast<float>(GetChannel(_Packed, 1)) / 255.0f;
+
+            DecodeOctahedral(Encoded, _pNormal);
+
+            break;
+        }
+
+        case SNormalEncoding::OctahedralRG16:
+        {
+            Encoded[0] = static_cast<float>((GetChannel(_Packed, 0) << 8) | GetChannel(_Packed, 2)) / 65535.0f;
+            Encoded[1] = static_cast<float>((GetChannel(_Packed, 1) << 8) | GetChannel(_Packed, 3)) / 65535.0f;
+
+            DecodeOctahedral(Encoded, _pNormal);
+
+            break;
+        }
+
+        default:
+        {
+            float X = static_cast<float>(GetChannel(_Packed, 0)) / 255.0f * 2.0f - 1.0f;
+            float Y = static_cast<float>(GetChannel(_Packed, 1)) / 255.0f * 2.0f - 1.0f;
+            float Z = static_cast<float>(GetChannel(_Packed, 2)) / 255.0f * 2.0f - 1.0f;
+
+            float Length = sqrtf(X * X + Y * Y + Z * Z);
+
+            _pNormal[0] = X / Length;
+            _pNormal[1] = Y / Length;
+            _pNormal[2] = Z / Length;
+
+            break;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned int PackMaterialColor(const float* _pColor, int _Material)
+{
+    return PackChannels(Quantize(_pColor[0], 255), Quantize(_pColor[1], 255), Quantize(_pColor[2], 255), static_cast<unsigned int>(_Material) & 0xFF);
+}
+
+// -----------------------------------------------------------------------------
+
+void UnpackMaterialColor(unsigned int _Packed, float* _pColor, int& _rMaterial)
+{
+    _pColor[0] = static_cast<float>(GetChannel(_Packed, 0)) / 255.0f;
+    _pColor[1] = static_cast<float>(GetChannel(_Packed, 1)) / 255.0f;
+    _pColor[2] = static_cast<float>(GetChannel(_Packed, 2)) / 255.0f;
+
+    _rMaterial = static_cast<int>(GetChannel(_Packed, 3));
+}
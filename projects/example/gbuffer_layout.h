@@ -0,0 +1,56 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+
+struct SGBufferLayout
+{
+    enum ELayout
+    {
+        Standard,                                                       ///< Normal target with xyz in three channels, color written in a second geometry pass.
+        Compact,                                                        ///< Material color and octahedral normal written together in one geometry pass.
+    };
+};
+
+// -----------------------------------------------------------------------------
+
+struct SNormalEncoding
+{
+    enum EEncoding
+    {
+        Float3,                                                         ///< x, y, and z mapped to 0 to 1 in RGB, alpha unused.
+        OctahedralRG8,                                                  ///< Octahedral projection, 8 bits per component in RG.
+        OctahedralRG16,                                                 ///< Octahedral projection, 16 bits per component spread over RG (high) and BA (low).
+    };
+};
+
+// -----------------------------------------------------------------------------
+// Memory and bandwidth of a GBuffer layout. 'Bytes' counts the size of the
+// formats the layout needs, 'Allocated' what YoshiX actually allocates, which
+// creates every color target with four 8 bit channels and a 32 bit depth.
+// -----------------------------------------------------------------------------
+struct SGBufferCost
+{
+    int       m_NumberOfColorTargets;                                   // Color targets bound while filling the GBuffer.
+    int       m_NumberOfGeometryPasses;                                 // Times the scene geometry is rendered to fill the GBuffer.
+    int       m_BytesPerPixel;                                          // Depth, normal, and color per pixel in the formats of the layout.
+    int       m_AllocatedBytesPerPixel;                                 // Depth, normal, and color per pixel as allocated by YoshiX.
+    int       m_GeometryBytesPerPixel;                                  // Bytes written and read per covered pixel while filling the GBuffer.
+    int       m_PostBytesPerSample;                                     // Bytes of depth and normal read per GBuffer sample of a post effect.
+    long long m_Memory;                                                 // Allocated bytes for the given resolution.
+};
+
+// -----------------------------------------------------------------------------
+// Helpers shared by the CPU side and 'gbuffer.fx'. The linear depth is not
+// stored at all, the post effects reconstruct it from the hardware depth and
+// the near and far distance.
+// -----------------------------------------------------------------------------
+void GetGBufferCost(SGBufferLayout::ELayout _Layout, SNormalEncoding::EEncoding _Encoding, int _Width, int _Height, SGBufferCost& _rCost);
+
+void EncodeOctahedral(const float* _pNormal, float* _pEncoded);
+void DecodeOctahedral(const float* _pEncoded, float* _pNormal);
+
+unsigned int PackNormal(const float* _pNormal, SNormalEncoding::EEncoding _Encoding);
+void         UnpackNormal(unsigned int _Packed, SNormalEncoding::EEncoding _Encoding, float* _pNormal);
+
+unsigned int PackMaterialColor(const float* _pColor, int _Material);
+void         UnpackMaterialColor(unsigned int _Packed, float* _pColor, int& _rMaterial);
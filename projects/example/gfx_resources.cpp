@@ -0,0 +1,267 @@
+
+#include "gfx_resources.h"
+
+using namespace gfx;
+
+// -----------------------------------------------------------------------------
+
+CGfxResources::CGfxResources(int _CapacityPerType)
+    : m_Textures       (_CapacityPerType)
+    , m_ConstantBuffers(_CapacityPerType)
+    , m_VertexShaders  (_CapacityPerType)
+    , m_PixelShaders   (_CapacityPerType)
+    , m_Materials      (_CapacityPerType)
+    , m_Meshes         (_CapacityPerType)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CGfxResources::~CGfxResources()
+{
+    assert(GetNumberOfObjects() == 0 && "YoshiX objects were not released");
+}
+
+// -----------------------------------------------------------------------------
+
+STextureHandle CGfxResources::CreateTexture(const char* _pPath)
+{
+    BHandle pTexture = nullptr;
+
+    gfx::CreateTexture(_pPath, &pTexture);
+
+    return m_Textures.Allocate(pTexture);
+}
+
+// -----------------------------------------------------------------------------
+
+SConstantBufferHandle CGfxResources::CreateConstantBuffer(int _NumberOfBytes)
+{
+    BHandle pBuffer = nullptr;
+
+    gfx::CreateConstantBuffer(_NumberOfBytes, &pBuffer);
+
+    return m_ConstantBuffers.Allocate(pBuffer);
+}
+
+// -----------------------------------------------------------------------------
+
+SVertexShaderHandle CGfxResources::CreateVertexShader(const char* _pPath, const char* _pFunction)
+{
+    BHandle pShader = nullptr;
+
+    gfx::CreateVertexShader(_pPath, _pFunction, &pShader);
+
+    return m_VertexShaders.Allocate(pShader);
+}
+
+// -----------------------------------------------------------------------------
+
+SPixelShaderHandle CGfxResources::CreatePixelShader(const char* _pPath, const char* _pFunction)
+{
+    BHandle pShader = nullptr;
+
+    gfx::CreatePixelShader(_pPath, _pFunction, &pShader);
+
+    return m_PixelShaders.Allocate(pShader);
+}
+
+// -----------------------------------------------------------------------------
+
+SMaterialHandle CGfxResources::CreateMaterial(const SMaterialInfo& _rMaterialInfo)
+{
+    BHandle pMaterial = nullptr;
+
+    gfx::CreateMaterial(_rMaterialInfo, &pMaterial);
+
+    return m_Materials.Allocate(pMaterial);
+}
+
+// -----------------------------------------------------------------------------
+
+SMeshHandle CGfxResources::CreateMesh(const SMeshInfo& _rMeshInfo)
+{
+    BHandle pMesh = nullptr;
+
+    gfx::CreateMesh(_rMeshInfo, &pMesh);
+
+    return m_Meshes.Allocate(pMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CGfxResources::Release(STextureHandle _Handle)
+{
+    BHandle pTexture = m_Textures.Free(_Handle);
+
+    if (pTexture != nullptr) gfx::ReleaseTexture(pTexture);
+}
+
+// -----------------------------------------------------------------------------
+
+void CGfxResources::Release(SConstantBufferHandle _Handle)
+{
+    BHandle pBuffer = m_ConstantBuffers.Free(_Handle);
+
+    if (pBuffer != nullptr) gfx::ReleaseConstantBuffer(pBuffer);
+}
+
+// -----------------------------------------------------------------------------
+
+void CGfxResources::Release(SVertexShaderHandle _Handle)
+{
+    BHandle pShader = m_VertexShaders.Free(_Handle);
+
+    if (pShader != nullptr) gfx::ReleaseVertexShader(pShader);
+}
+
+// -----------------------------------------------------------------------------
+
+void CGfxResources::Release(SPixelShaderHandle _Handle)
+{
+    BHandle pShader = m_PixelShaders.Free(_Handle);
+
+    if (pShader != nullptr) gfx::ReleasePixelShader(pShader);
+}
+
+// -----------------------------------------------------------------------------
+
+void CGfxResources::Release(SMaterialHandle _Handle)
+{
+    BHandle pMaterial = m_Materials.Free(_Handle);
+
+    if (pMaterial != nullptr) gfx::ReleaseMaterial(pMaterial);
+}
+
+// -----------------------------------------------------------------------------
+
+void CGfxResources::Release(SMeshHandle _Handle)
+{
+    BHandle pMesh = m_Meshes.Free(_Handle);
+
+    if (pMesh != nullptr) gfx::ReleaseMesh(pMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CGfxResources::Get(STextureHandle _Handle) const
+{
+    return m_Textures.Get(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CGfxResources::Get(SConstantBufferHandle _Handle) const
+{
+    return m_ConstantBuffers.Get(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CGfxResources::Get(SVertexShaderHandle _Handle) const
+{
+    return m_VertexShaders.Get(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CGfxResources::Get(SPixelShaderHandle _Handle) const
+{
+    return m_PixelShaders.Get(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CGfxResources::Get(SMaterialHandle _Handle) const
+{
+    return m_Materials.Get(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CGfxResources::Get(SMeshHandle _Handle) const
+{
+    return m_Meshes.Get(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle* CGfxResources::GetAddress(STextureHandle _Handle)
+{
+    return m_Textures.GetAddress(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle* CGfxResources::GetAddress(SVertexShaderHandle _Handle)
+{
+    return m_VertexShaders.GetAddress(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle* CGfxResources::GetAddress(SPixelShaderHandle _Handle)
+{
+    return m_PixelShaders.GetAddress(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle* CGfxResources::GetAddress(SMaterialHandle _Handle)
+{
+    return m_Materials.GetAddress(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle* CGfxResources::GetAddress(SMeshHandle _Handle)
+{
+    return m_Meshes.GetAddress(_Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+int CGfxResources::ReleaseAll()
+{
+    int NumberOfObjects = GetNumberOfObjects();
+
+    ReleasePool(m_Meshes);
+    ReleasePool(m_Materials);
+    ReleasePool(m_VertexShaders);
+    ReleasePool(m_PixelShaders);
+    ReleasePool(m_ConstantBuffers);
+    ReleasePool(m_Textures);
+
+    return NumberOfObjects;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename TTag>
+void CGfxResources::ReleasePool(CHandlePool<TTag, BHandle>& _rPool)
+{
+    // -----------------------------------------------------------------------------
+    // Collect the handles first, releasing changes the pool while iterating.
+    // -----------------------------------------------------------------------------
+    std::vector<THandle<TTag>> Handles;
+
+    _rPool.ForEach([&](THandle<TTag> _Handle, BHandle) { Handles.push_back(_Handle); });
+
+    for (THandle<TTag> Handle : Handles) Release(Handle);
+}
+
+// -----------------------------------------------------------------------------
+
+int CGfxResources::GetNumberOfObjects() const
+{
+    return m_Textures.GetNumberOfUsedSlots() + m_ConstantBuffers.GetNumberOfUsedSlots() + m_VertexShaders.GetNumberOfUsedSlots()
+         + m_PixelShaders.GetNumberOfUsedSlots() + m_Materials.GetNumberOfUsedSlots() + m_Meshes.GetNumberOfUsedSlots();
+}
+
+// -----------------------------------------------------------------------------
+
+int CGfxResources::GetNumberOfStaleUses() const
+{
+    return m_Textures.GetNumberOfStaleUses() + m_ConstantBuffers.GetNumberOfStaleUses() + m_VertexShaders.GetNumberOfStaleUses()
+         + m_PixelShaders.GetNumberOfStaleUses() + m_Materials.GetNumberOfStaleUses() + m_Meshes.GetNumberOfStaleUses();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include "handle_pool.h"
+
+// -----------------------------------------------------------------------------
+// Typed handles of the YoshiX objects.
+// -----------------------------------------------------------------------------
+struct STextureTag;
+struct SConstantBufferTag;
+struct SVertexShaderTag;
+struct SPixelShaderTag;
+struct SMaterialTag;
+struct SMeshTag;
+
+typedef THandle<STextureTag>        STextureHandle;
+typedef THandle<SConstantBufferTag> SConstantBufferHandle;
+typedef THandle<SVertexShaderTag>   SVertexShaderHandle;
+typedef THandle<SPixelShaderTag>    SPixelShaderHandle;
+typedef THandle<SMaterialTag>       SMaterialHandle;
+typedef THandle<SMeshTag>           SMeshHandle;
+
+// -----------------------------------------------------------------------------
+// Owns the YoshiX objects of an application in one fixed size pool per type.
+// The create functions forward to YoshiX and return a handle, 'Get' returns
+// the YoshiX handle to pass to the other YoshiX functions. Using a handle
+// after its object was released is detected and yields nullptr. The pools are
+// allocated once in the constructor, so recreating objects on resize or
+// reload does not allocate on the application side.
+// -----------------------------------------------------------------------------
+class CGfxResources
+{
+    public:
+
+        explicit CGfxResources(int _CapacityPerType = 256);
+        ~CGfxResources();
+
+    public:
+
+        STextureHandle        CreateTexture(const char* _pPath);
+        SConstantBufferHandle CreateConstantBuffer(int _NumberOfBytes);
+        SVertexShaderHandle   CreateVertexShader(const char* _pPath, const char* _pFunction);
+        SPixelShaderHandle    CreatePixelShader(const char* _pPath, const char* _pFunction);
+        SMaterialHandle       CreateMaterial(const gfx::SMaterialInfo& _rMaterialInfo);
+        SMeshHandle           CreateMesh(const gfx::SMeshInfo& _rMeshInfo);
+
+        void Release(STextureHandle _Handle);
+        void Release(SConstantBufferHandle _Handle);
+        void Release(SVertexShaderHandle _Handle);
+        void Release(SPixelShaderHandle _Handle);
+        void Release(SMaterialHandle _Handle);
+        void Release(SMeshHandle _Handle);
+
+        gfx::BHandle Get(STextureHandle _Handle) const;
+        gfx::BHandle Get(SConstantBufferHandle _Handle) const;
+        gfx::BHandle Get(SVertexShaderHandle _Handle) const;
+        gfx::BHandle Get(SPixelShaderHandle _Handle) const;
+        gfx::BHandle Get(SMaterialHandle _Handle) const;
+        gfx::BHandle Get(SMeshHandle _Handle) const;
+
+        // -----------------------------------------------------------------------------
+        // The address of the YoshiX handle in its pool, for code which replaces the
+        // object in place like the hot reload. It is valid until the release.
+        // -----------------------------------------------------------------------------
+        gfx::BHandle* GetAddress(STextureHandle _Handle);
+        gfx::BHandle* GetAddress(SVertexShaderHandle _Handle);
+        gfx::BHandle* GetAddress(SPixelShaderHandle _Handle);
+        gfx::BHandle* GetAddress(SMaterialHandle _Handle);
+        gfx::BHandle* GetAddress(SMeshHandle _Handle);
+
+        // -----------------------------------------------------------------------------
+        // Releases all objects still alive in the order meshes, materials, shaders,
+        // constant buffers, textures and returns their number, i.e. the leaks.
+        // -----------------------------------------------------------------------------
+        int  ReleaseAll();
+
+        int  GetNumberOfObjects() const;
+        int  GetNumberOfStaleUses() const;
+
+    private:
+
+        template<typename TTag>
+        void ReleasePool(CHandlePool<TTag, gfx::BHandle>& _rPool);
+
+    private:
+
+        CHandlePool<STextureTag       , gfx::BHandle> m_Textures;
+        CHandlePool<SConstantBufferTag, gfx::BHandle> m_ConstantBuffers;
+        CHandlePool<SVertexShaderTag  , gfx::BHandle> m_VertexShaders;
+        CHandlePool<SPixelShaderTag   , gfx::BHandle> m_PixelShaders;
+        CHandlePool<SMaterialTag      , gfx::BHandle> m_Materials;
+        CHandlePool<SMeshTag          , gfx::BHandle> m_Meshes;
+};
@@ -0,0 +1,384 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "golden_image.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // CRC of the PNG chunks and Adler checksum of the zlib stream.
+    // -----------------------------------------------------------------------------
+    unsigned int GetCrc(const unsigned char* _pData, size_t _NumberOfBytes, unsigned int _Crc)
+    {
+        static unsigned int s_Table[256];
+        static bool         s_IsTableReady = false;
+
+        if (s_IsTableReady == false)
+        {
+            for (unsigned int Index = 0; Index < 256; ++ Index)
+            {
+                unsigned int Value = Index;
+
+                for (int Bit = 0; Bit < 8; ++ Bit) Value = (Value & 1) != 0 ? 0xEDB88320u ^ (Value >> 1) : Value >> 1;
+
+                s_Table[Index] = Value;
+            }
+
+            s_IsTableReady = true;
+        }
+
+        for (size_t Index = 0; Index < _NumberOfBytes; ++ Index) _Crc = s_Table[(_Crc ^ _pData[Index]) & 0xFF] ^ (_Crc >> 8);
+
+        return _Crc;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetAdler(const std::vector<unsigned char>& _rData)
+    {
+        unsigned int A = 1;
+        unsigned int B = 0;
+
+        for (unsigned char Byte : _rData)
+        {
+            A = (A + Byte) % 65521u;
+            B = (B + A   ) % 65521u;
+        }
+
+        return (B << 16) | A;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void AppendBigEndian(std::vector<unsigned char>& _rData, unsigned int _Value)
+    {
+        _rData.push_back(static_cast<unsigned char>(_Value >> 24));
+        _rData.push_back(static_cast<unsigned char>(_Value >> 16));
+        _rData.push_back(static_cast<unsigned char>(_Value >>  8));
+        _rData.push_back(static_cast<unsigned char>(_Value      ));
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool WriteChunk(FILE* _pFile, const char* _pType, const std::vector<unsigned char>& _rData)
+    {
+        std::vector<unsigned char> Length;
+
+        AppendBigEndian(Length, static_cast<unsigned int>(_rData.size()));
+
+        unsigned int Crc = GetCrc(reinterpret_cast<const unsigned char*>(_pType), 4, 0xFFFFFFFFu);
+
+        Crc = GetCrc(_rData.data(), _rData.size(), Crc) ^ 0xFFFFFFFFu;
+
+        std::vector<unsigned char> Trailer;
+
+        AppendBigEndian(Trailer, Crc);
+
+        bool IsWritten = fwrite(Length.data(), 1, 4, _pFile) == 4 && fwrite(_pType, 1, 4, _pFile) == 4;
+
+        if (_rData.empty() == false) IsWritten = IsWritten && fwrite(_rData.data(), 1, _rData.size(), _pFile) == _rData.size();
+
+        return IsWritten && fwrite(Trailer.data(), 1, 4, _pFile) == 4;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Linear RGB to CIE L*a*b* with the D65 white point of sRGB.
+    // -----------------------------------------------------------------------------
+    float GetLabComponent(float _Value)
+    {
+        return _Value > 0.008856f ? powf(_Value, 1.0f / 3.0f) : 7.787f * _Value + 16.0f / 116.0f;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetLab(const float* _pColor, float* _pLab)
+    {
+        float R = std::max(_pColor[0], 0.0f);
+        float G = std::max(_pColor[1], 0.0f);
+        float B = std::max(_pColor[2], 0.0f);
+
+        float X = GetLabComponent((0.4124f * R + 0.3576f * G + 0.1805f * B) / 0.9505f);
+        float Y = GetLabComponent( 0.2126f * R + 0.7152f * G + 0.0722f * B);
+        float Z = GetLabComponent((0.0193f * R + 0.1192f * G + 0.9505f * B) / 1.0890f);
+
+        _pLab[0] = 116.0f * Y - 16.0f;
+        _pLab[1] = 500.0f * (X - Y);
+        _pLab[2] = 200.0f * (Y - Z);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Copies the compared channels, blurred if the tolerance asks for it.
+    // -----------------------------------------------------------------------------
+    void GetComparedImage(const filter::SImage& _rSource, int _NumberOfChannels, int _BlurRadius, filter::CImage& _rImage)
+    {
+        _rImage.Resize(_rSource.m_Width, _rSource.m_Height, _NumberOfChannels);
+
+        filter::SImage Image = _rImage.GetView();
+
+        int NumberOfPixels = _rSource.m_Width * _rSource.m_Height;
+
+        for (int IndexOfPixel = 0; IndexOfPixel < NumberOfPixels; ++ IndexOfPixel)
+        {
+            const float* pSource      = _rSource.m_pPixels + static_cast<size_t>(IndexOfPixel) * _rSource.m_NumberOfChannels;
+            float*       pDestination = Image.m_pPixels + static_cast<size_t>(IndexOfPixel) * _NumberOfChannels;
+
+            for (int IndexOfChannel = 0; IndexOfChannel < _NumberOfChannels; ++ IndexOfChannel) pDestination[IndexOfChannel] = pSource[IndexOfChannel];
+        }
+
+        if (_BlurRadius > 0) filter::BoxBlur(Image, Image, _BlurRadius);
+    }
+} // namespace
+
+bool WritePfm(const char* _pPath, const filter::SImage& _rImage)
+{
+    if (_rImage.m_NumberOfChannels != 1 && _rImage.m_NumberOfChannels < 3) return false;
+
+    FILE* pFile = fopen(_pPath, "wb");
+
+    if (pFile == nullptr) return false;
+
+    int NumberOfChannels = _rImage.m_NumberOfChannels == 1 ? 1 : 3;
+
+    fprintf(pFile, "%s\n%d %d\n-1.0\n", NumberOfChannels == 1 ? "Pf" : "PF", _rImage.m_Width, _rImage.m_Height);
+
+    // -----------------------------------------------------------------------------
+    // The rows of a PFM file go from bottom to top, the floats are little endian
+    // as the negative scale says.
+    // -----------------------------------------------------------------------------
+    std::vector<float> Row(static_cast<size_t>(_rImage.m_Width) * NumberOfChannels);
+
+    bool IsWritten = true;
+
+    for (int Y = _rImage.m_Height - 1; Y >= 0 && IsWritten; -- Y)
+    {
+        const float* pPixel = _rImage.m_pPixels + static_cast<size_t>(Y) * _rImage.m_Width * _rImage.m_NumberOfChannels;
+
+        for (int X = 0; X < _rImage.m_Width; ++ X, pPixel += _rImage.m_NumberOfChannels)
+        {
+            for (int IndexOfChannel = 0; IndexOfChannel < NumberOfChannels; ++ IndexOfChannel) Row[X * NumberOfChannels + IndexOfChannel] = pPixel[IndexOfChannel];
+        }
+
+        IsWritten = fwrite(Row.data(), sizeof(float), Row.size(), pFile) == Row.size();
+    }
+
+    return fclose(pFile) == 0 && IsWritten;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ReadPfm(const char* _pPath, filter::CImage& _rImage)
+{
+    FILE* pFile = fopen(_pPath, "rb");
+
+    if (pFile == nullptr) return false;
+
+    char  Type[3] = {};
+    int   Width   = 0;
+    int   Height  = 0;
+    float Scale   = 0.0f;
+
+    bool IsRead = fscanf(pFile, "%2s %d %d %f", Type, &Width, &Height, &Scale) == 4 && fgetc(pFile) != EOF;
+
+    int NumberOfChannels = strcmp(Type, "Pf") == 0 ? 1 : strcmp(Type, "PF") == 0 ? 3 : 0;
+
+    if (IsRead == false || NumberOfChannels == 0 || Width <= 0 || Height <= 0)
+    {
+        fclose(pFile);
+
+        return false;
+    }
+
+    _rImage.Resize(Width, Height, NumberOfChannels);
+
+    filter::SImage Image = _rImage.GetView();
+
+    size_t RowLength = static_cast<size_t>(Width) * NumberOfChannels;
+
+    for (int Y = Height - 1; Y >= 0 && IsRead; -- Y)
+    {
+        IsRead = fread(Image.m_pPixels + Y * RowLength, sizeof(float), RowLength, pFile) == RowLength;
+    }
+
+    fclose(pFile);
+
+    // -----------------------------------------------------------------------------
+    // A positive scale marks big endian floats.
+    // -----------------------------------------------------------------------------
+    if (IsRead && Scale > 0.0f)
+    {
+        unsigned char* pBytes = reinterpret_cast<unsigned char*>(Image.m_pPixels);
+
+        for (size_t Index = 0; Index < RowLength * Height; ++ Index, pBytes += 4)
+        {
+            std::swap(pBytes[0], pBytes[3]);
+            std::swap(pBytes[1], pBytes[2]);
+        }
+    }
+
+    return IsRead;
+}
+
+// -----------------------------------------------------------------------------
+
+bool WritePng(const char* _pPath, const filter::SImage& _rImage)
+{
+    int NumberOfChannels = _rImage.m_NumberOfChannels;
+
+    if (NumberOfChannels != 1 && NumberOfChannels != 3 && NumberOfChannels != 4) return false;
+
+    // -----------------------------------------------------------------------------
+    // The rows with a leading filter byte of 0 (none).
+    // -----------------------------------------------------------------------------
+    size_t RowLength = static_cast<size_t>(_rImage.m_Width) * NumberOfChannels;
+
+    std::vector<unsigned char> Rows;
+
+    Rows.reserve((RowLength + 1) * _rImage.m_Height);
+
+    for (int Y = 0; Y < _rImage.m_Height; ++ Y)
+    {
+        const float* pChannel = _rImage.m_pPixels + Y * RowLength;
+
+        Rows.push_back(0);
+
+        for (size_t Index = 0; Index < RowLength; ++ Index)
+        {
+            Rows.push_back(static_cast<unsigned char>(std::min(std::max(pChannel[Index], 0.0f), 1.0f) * 255.0f + 0.5f));
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // A zlib stream of stored deflate blocks. The files are larger than
+    // compressed ones, but they are only written for inspection.
+    // -----------------------------------------------------------------------------
+    std::vector<unsigned char> Data = { 0x78, 0x01 };
+
+    size_t First = 0;
+
+    do
+    {
+        size_t Count = std::min<size_t>(Rows.size() - First, 65535);
+
+        Data.push_back(First + Count == Rows.size() ? 1 : 0);
+        Data.push_back(static_cast<unsigned char>( Count        & 0xFF));
+        Data.push_back(static_cast<unsigned char>((Count  >> 8) & 0xFF));
+        Data.push_back(static_cast<unsigned char>(~Count        & 0xFF));
+        Data.push_back(static_cast<unsigned char>((~Count >> 8) & 0xFF));
+
+        Data.insert(Data.end(), Rows.begin() + First, Rows.begin() + First + Count);
+
+        First += Count;
+    }
+    while (First < Rows.size());
+
+    AppendBigEndian(Data, GetAdler(Rows));
+
+    std::vector<unsigned char> Header;
+
+    AppendBigEndian(Header, static_cast<unsigned int>(_rImage.m_Width));
+    AppendBigEndian(Header, static_cast<unsigned int>(_rImage.m_Height));
+
+    Header.push_back(8);
+    Header.push_back(NumberOfChannels == 1 ? 0 : NumberOfChannels == 3 ? 2 : 6);
+    Header.push_back(0);
+    Header.push_back(0);
+    Header.push_back(0);
+
+    FILE* pFile = fopen(_pPath, "wb");
+
+    if (pFile == nullptr) return false;
+
+    const unsigned char Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    bool IsWritten = fwrite(Signature, 1, 8, pFile) == 8;
+
+    IsWritten = IsWritten && WriteChunk(pFile, "IHDR", Header);
+    IsWritten = IsWritten && WriteChunk(pFile, "IDAT", Data);
+    IsWritten = IsWritten && WriteChunk(pFile, "IEND", std::vector<unsigned char>());
+
+    return fclose(pFile) == 0 && IsWritten;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CompareImages(const filter::SImage& _rImage, const filter::SImage& _rGolden, const SImageTolerance& _rTolerance, SImageDifference& _rDifference, filter::SImage* _pDifferenceImage)
+{
+    _rDifference.m_NumberOfPixels          = _rGolden.m_Width * _rGolden.m_Height;
+    _rDifference.m_NumberOfDifferentPixels = _rDifference.m_NumberOfPixels;
+    _rDifference.m_MaximumDifference       = 0.0f;
+    _rDifference.m_MeanDifference          = 0.0f;
+
+    bool IsDepthImage  = _rImage .m_NumberOfChannels == 1;
+    bool IsDepthGolden = _rGolden.m_NumberOfChannels == 1;
+
+    if (_rImage.m_Width != _rGolden.m_Width || _rImage.m_Height != _rGolden.m_Height || IsDepthImage != IsDepthGolden) return false;
+
+    if (IsDepthImage == false && (_rImage.m_NumberOfChannels < 3 || _rGolden.m_NumberOfChannels < 3)) return false;
+
+    int NumberOfChannels = IsDepthImage ? 1 : 3;
+
+    filter::CImage Image;
+    filter::CImage Golden;
+
+    GetComparedImage(_rImage , NumberOfChannels, _rTolerance.m_BlurRadius, Image);
+    GetComparedImage(_rGolden, NumberOfChannels, _rTolerance.m_BlurRadius, Golden);
+
+    const float* pImage  = Image .GetView().m_pPixels;
+    const float* pGolden = Golden.GetView().m_pPixels;
+
+    bool   IsPerceptual = _rTolerance.m_Metric == SImageMetric::Perceptual && NumberOfChannels == 3;
+    double Sum          = 0.0;
+
+    _rDifference.m_NumberOfDifferentPixels = 0;
+
+    for (int IndexOfPixel = 0; IndexOfPixel < _rDifference.m_NumberOfPixels; ++ IndexOfPixel, pImage += NumberOfChannels, pGolden += NumberOfChannels)
+    {
+        float Difference = 0.0f;
+
+        if (IsPerceptual)
+        {
+            float ImageLab [3];
+            float GoldenLab[3];
+
+            GetLab(pImage , ImageLab);
+            GetLab(pGolden, GoldenLab);
+
+            float DL = ImageLab[0] - GoldenLab[0];
+            float DA = ImageLab[1] - GoldenLab[1];
+            float DB = ImageLab[2] - GoldenLab[2];
+
+            Difference = sqrtf(DL * DL + DA * DA + DB * DB);
+        }
+        else
+        {
+            for (int IndexOfChannel = 0; IndexOfChannel < NumberOfChannels; ++ IndexOfChannel)
+            {
+                Difference = std::max(Difference, fabsf(pImage[IndexOfChannel] - pGolden[IndexOfChannel]));
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+        // NaNs never compare equal, so they count as different.
+        // -----------------------------------------------------------------------------
+        if (Difference > _rTolerance.m_PixelTolerance || Difference != Difference) ++ _rDifference.m_NumberOfDifferentPixels;
+
+        _rDifference.m_MaximumDifference = std::max(_rDifference.m_MaximumDifference, Difference);
+
+        Sum += Difference;
+
+        if (_pDifferenceImage != nullptr && _pDifferenceImage->m_Width == _rGolden.m_Width && _pDifferenceImage->m_Height == _rGolden.m_Height && _pDifferenceImage->m_NumberOfChannels == 1)
+        {
+            _pDifferenceImage->m_pPixels[IndexOfPixel] = _rTolerance.m_PixelTolerance > 0.0f ? Difference / _rTolerance.m_PixelTolerance : (Difference > 0.0f ? 1.0f : 0.0f);
+        }
+    }
+
+    if (_rDifference.m_NumberOfPixels > 0) _rDifference.m_MeanDifference = static_cast<float>(Sum / _rDifference.m_NumberOfPixels);
+
+    return _rDifference.m_NumberOfDifferentPixels <= _rTolerance.m_FractionOfPixels * _rDifference.m_NumberOfPixels;
+}
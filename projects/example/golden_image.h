@@ -0,0 +1,58 @@
+#pragma once
+
+#include "image_filter.h"
+
+// -----------------------------------------------------------------------------
+
+struct SImageMetric
+{
+    enum EMetric
+    {
+        Perceptual,                                                     ///< Color images: distance of the pixels in CIE L*a*b* (delta E 1976), 2.3 is about the smallest visible difference.
+        Absolute,                                                       ///< Depth, normals, masks: largest absolute difference of the channels.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// How much an image may differ from its golden image. Both images are blurred
+// with a small box first, so an edge moving by less than a pixel after a change
+// of the rasterization does not fail the comparison, while a missing object or
+// a wrong color does. A few pixels may exceed the tolerance for the same reason.
+// -----------------------------------------------------------------------------
+struct SImageTolerance
+{
+    SImageMetric::EMetric m_Metric;
+    float                 m_PixelTolerance;                             // Largest difference of a pixel which is not counted.
+    float                 m_FractionOfPixels;                           // Fraction of the pixels which may exceed the tolerance.
+    int                   m_BlurRadius;                                 // Radius of the box blur applied to both images, 0 compares them as they are.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SImageDifference
+{
+    int   m_NumberOfPixels;                                             // Pixels compared.
+    int   m_NumberOfDifferentPixels;                                    // Pixels exceeding the tolerance.
+    float m_MaximumDifference;                                          // Largest difference of all pixels in the unit of the metric.
+    float m_MeanDifference;                                             // Mean difference of all pixels in the unit of the metric.
+};
+
+// -----------------------------------------------------------------------------
+// Golden images are stored as portable float maps (PFM), so depth and HDR
+// colors keep their full precision: 1 channel images as grayscale, 3 and 4
+// channel images as RGB, the alpha channel is not stored. Reading returns one
+// or three channels. PNG files are written for looking at the images only, the
+// channels are clamped to 0 to 1 and stored with 8 bits.
+// -----------------------------------------------------------------------------
+bool WritePfm(const char* _pPath, const filter::SImage& _rImage);
+bool ReadPfm(const char* _pPath, filter::CImage& _rImage);
+bool WritePng(const char* _pPath, const filter::SImage& _rImage);
+
+// -----------------------------------------------------------------------------
+// Compares the first three channels of color images or the single channel of
+// depth images. Returns true if the images have the same size and differ less
+// than the tolerance allows. If a difference image is passed, it has to be of
+// the same size with one channel and receives the difference of each pixel
+// divided by the tolerance, so pixels at or above 1 exceed it.
+// -----------------------------------------------------------------------------
+bool CompareImages(const filter::SImage& _rImage, const filter::SImage& _rGolden, const SImageTolerance& _rTolerance, SImageDifference& _rDifference, filter::SImage* _pDifferenceImage);
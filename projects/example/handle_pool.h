@@ -0,0 +1,201 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// A 32 bit handle: the lower bits are the index of the slot in its pool, the
+// upper bits the generation of the slot. The generation is increased when the
+// slot is freed, so a handle to a released object is detected instead of
+// silently addressing the next object in the same slot. The tag type only
+// makes handles of different pools incompatible, e.g. a texture handle cannot
+// be passed where a mesh handle is expected. The value 0 is never used.
+// -----------------------------------------------------------------------------
+template<typename TTag>
+struct THandle
+{
+    static const unsigned int s_NumberOfIndexBits = 20;
+    static const unsigned int s_IndexMask         = (1u << s_NumberOfIndexBits) - 1;
+    static const unsigned int s_MaxGeneration     = (1u << (32 - s_NumberOfIndexBits)) - 1;
+
+    unsigned int m_Value;
+
+    bool IsValid() const
+    {
+        return m_Value != 0;
+    }
+
+    unsigned int GetIndex() const
+    {
+        return m_Value & s_IndexMask;
+    }
+
+    unsigned int GetGeneration() const
+    {
+        return m_Value >> s_NumberOfIndexBits;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Fixed capacity pool of values addressed by handles. All memory is allocated
+// in the constructor, allocating and freeing slots only moves them between the
+// used slots and the free list.
+// -----------------------------------------------------------------------------
+template<typename TTag, typename TValue>
+class CHandlePool
+{
+    public:
+
+        typedef THandle<TTag> SHandle;
+
+    public:
+
+        explicit CHandlePool(int _Capacity)
+            : m_Values           (_Capacity)
+            , m_Generations      (_Capacity, 1)
+            , m_NextFree         (_Capacity)
+            , m_FirstFree        (_Capacity > 0 ? 0 : -1)
+            , m_NumberOfUsedSlots(0)
+            , m_NumberOfStaleUses(0)
+        {
+            assert(static_cast<unsigned int>(_Capacity) <= SHandle::s_IndexMask + 1);
+
+            for (int IndexOfSlot = 0; IndexOfSlot < _Capacity; ++ IndexOfSlot)
+            {
+                m_NextFree[IndexOfSlot] = IndexOfSlot + 1 < _Capacity ? IndexOfSlot + 1 : -1;
+            }
+        }
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Returns an invalid handle if the pool is full.
+        // -----------------------------------------------------------------------------
+        SHandle Allocate(const TValue& _rValue)
+        {
+            SHandle Handle = { 0 };
+
+            if (m_FirstFree < 0) return Handle;
+
+            int IndexOfSlot = m_FirstFree;
+
+            m_FirstFree             = m_NextFree[IndexOfSlot];
+            m_NextFree[IndexOfSlot] = -2;
+            m_Values  [IndexOfSlot] = _rValue;
+
+            ++ m_NumberOfUsedSlots;
+
+            Handle.m_Value = (m_Generations[IndexOfSlot] << SHandle::s_NumberOfIndexBits) | static_cast<unsigned int>(IndexOfSlot);
+
+            return Handle;
+        }
+
+        // -----------------------------------------------------------------------------
+        // Frees the slot and returns its value, or a default value for stale and
+        // invalid handles.
+        // -----------------------------------------------------------------------------
+        TValue Free(SHandle _Handle)
+        {
+            if (IsAlive(_Handle) == false)
+            {
+                if (_Handle.IsValid()) ++ m_NumberOfStaleUses;
+
+                return TValue();
+            }
+
+            int IndexOfSlot = static_cast<int>(_Handle.GetIndex());
+
+            TValue Value = m_Values[IndexOfSlot];
+
+            m_Values[IndexOfSlot] = TValue();
+
+            // -----------------------------------------------------------------------------
+            // Generation 0 would make the handle of index 0 look invalid.
+            // -----------------------------------------------------------------------------
+            m_Generations[IndexOfSlot] = m_Generations[IndexOfSlot] == SHandle::s_MaxGeneration ? 1 : m_Generations[IndexOfSlot] + 1;
+
+            m_NextFree[IndexOfSlot] = m_FirstFree;
+            m_FirstFree             = IndexOfSlot;
+
+            -- m_NumberOfUsedSlots;
+
+            return Value;
+        }
+
+        bool IsAlive(SHandle _Handle) const
+        {
+            unsigned int IndexOfSlot = _Handle.GetIndex();
+
+            return _Handle.IsValid() && IndexOfSlot < m_Values.size() && m_NextFree[IndexOfSlot] == -2 && m_Generations[IndexOfSlot] == _Handle.GetGeneration();
+        }
+
+        // -----------------------------------------------------------------------------
+        // Returns the value, or a default value if the handle is stale. Stale uses
+        // are counted and assert in debug builds.
+        // -----------------------------------------------------------------------------
+        TValue Get(SHandle _Handle) const
+        {
+            if (IsAlive(_Handle) == false)
+            {
+                assert(_Handle.IsValid() == false && "stale handle");
+
+                if (_Handle.IsValid()) ++ m_NumberOfStaleUses;
+
+                return TValue();
+            }
+
+            return m_Values[_Handle.GetIndex()];
+        }
+
+        // -----------------------------------------------------------------------------
+        // Returns the address of the value, or nullptr if the handle is stale. The
+        // address stays the same until the slot is freed, the pool never grows.
+        // -----------------------------------------------------------------------------
+        TValue* GetAddress(SHandle _Handle)
+        {
+            if (IsAlive(_Handle) == false) return nullptr;
+
+            return &m_Values[_Handle.GetIndex()];
+        }
+
+        int GetCapacity() const
+        {
+            return static_cast<int>(m_Values.size());
+        }
+
+        int GetNumberOfUsedSlots() const
+        {
+            return m_NumberOfUsedSlots;
+        }
+
+        int GetNumberOfStaleUses() const
+        {
+            return m_NumberOfStaleUses;
+        }
+
+        // -----------------------------------------------------------------------------
+        // Calls the function for the handle and value of each used slot.
+        // -----------------------------------------------------------------------------
+        template<typename TFunction>
+        void ForEach(const TFunction& _rFunction) const
+        {
+            for (size_t IndexOfSlot = 0; IndexOfSlot < m_Values.size(); ++ IndexOfSlot)
+            {
+                if (m_NextFree[IndexOfSlot] != -2) continue;
+
+                SHandle Handle = { (m_Generations[IndexOfSlot] << SHandle::s_NumberOfIndexBits) | static_cast<unsigned int>(IndexOfSlot) };
+
+                _rFunction(Handle, m_Values[IndexOfSlot]);
+            }
+        }
+
+    private:
+
+        std::vector<TValue>       m_Values;
+        std::vector<unsigned int> m_Generations;
+        std::vector<int>          m_NextFree;                           // Next free slot, -1 at the end of the list, -2 for used slots.
+        int                       m_FirstFree;
+        int                       m_NumberOfUsedSlots;
+        mutable int               m_NumberOfStaleUses;                  // Accesses with handles of freed slots.
+};
@@ -0,0 +1,726 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "hot_reload.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace gfx;
+
+namespace
+{
+    const double s_QuietTime    = 50.0;                                 // Milliseconds without notification before a changed file is read.
+    const int    s_PollInterval = 20;                                   // Milliseconds the watcher thread waits for notifications.
+
+    // -----------------------------------------------------------------------------
+    // Lower case with forward slashes, so the paths of YoshiX and the names of the
+    // notifications can be compared.
+    // -----------------------------------------------------------------------------
+    std::string Normalize(const char* _pPath)
+    {
+        std::string Path(_pPath);
+
+        for (char& rCharacter : Path)
+        {
+            rCharacter = rCharacter == '\\' ? '/' : static_cast<char>(tolower(static_cast<unsigned char>(rCharacter)));
+        }
+
+        while (Path.size() > 1 && Path.back() == '/') Path.pop_back();
+
+        return Path;
+    }
+
+    // -----------------------------------------------------------------------------
+    // FNV-1a of the whole file, 0 if it cannot be read, e.g. because the editor
+    // still holds it open.
+    // -----------------------------------------------------------------------------
+    unsigned long long GetFileHash(const char* _pPath)
+    {
+        FILE* pFile = fopen(_pPath, "rb");
+
+        if (pFile == nullptr) return 0;
+
+        unsigned long long Hash = 14695981039346656037ull;
+
+        unsigned char Buffer[16384];
+
+        for (size_t NumberOfBytes; (NumberOfBytes = fread(Buffer, 1, sizeof(Buffer), pFile)) > 0; )
+        {
+            for (size_t Index = 0; Index < NumberOfBytes; ++ Index)
+            {
+                Hash = (Hash ^ Buffer[Index]) * 1099511628211ull;
+            }
+        }
+
+        fclose(pFile);
+
+        return Hash != 0 ? Hash : 1;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The number of floats of one vertex, i.e. the stride YoshiX derives from the
+    // input layout. All element types are 32 bit with 1 to 4 components.
+    // -----------------------------------------------------------------------------
+    int GetNumberOfFloatsPerVertex(const SMaterialInfo& _rMaterialInfo)
+    {
+        int NumberOfFloats = 0;
+
+        for (int IndexOfElement = 0; IndexOfElement < _rMaterialInfo.m_NumberOfInputElements; ++ IndexOfElement)
+        {
+            NumberOfFloats += static_cast<int>(_rMaterialInfo.m_InputElements[IndexOfElement].m_Type) % 4 + 1;
+        }
+
+        return NumberOfFloats;
+    }
+} // namespace
+
+CHotReload::CHotReload()
+    : m_IsRunning (false)
+    , m_pDirectory(nullptr)
+    , m_Descriptor(-1)
+    , m_ChangeTime(-1.0)
+    , m_Statistics()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CHotReload::~CHotReload()
+{
+    Stop();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CHotReload::Start(const char* _pDirectory)
+{
+    Stop();
+
+    m_Directory = Normalize(_pDirectory);
+
+#if defined(_WIN32)
+    HANDLE Directory = CreateFileA(_pDirectory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+
+    if (Directory == INVALID_HANDLE_VALUE) return false;
+
+    m_pDirectory = Directory;
+#else
+    m_Descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (m_Descriptor < 0) return false;
+
+    // -----------------------------------------------------------------------------
+    // inotify does not watch subdirectories, so every directory of the tree gets
+    // its own watch.
+    // -----------------------------------------------------------------------------
+    std::vector<std::string> Directories(1, std::string());
+
+    for (size_t IndexOfDirectory = 0; IndexOfDirectory < Directories.size(); ++ IndexOfDirectory)
+    {
+        std::string Path = std::string(_pDirectory) + "/" + Directories[IndexOfDirectory];
+
+        int Watch = inotify_add_watch(m_Descriptor, Path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY);
+
+        if (Watch < 0) continue;
+
+        SWatch NewWatch = { Watch, Normalize(Directories[IndexOfDirectory].c_str()) };
+
+        if (NewWatch.m_Directory.empty() == false) NewWatch.m_Directory += '/';
+
+        m_Watches.push_back(NewWatch);
+
+        DIR* pDirectory = opendir(Path.c_str());
+
+        if (pDirectory == nullptr) continue;
+
+        for (dirent* pEntry; (pEntry = readdir(pDirectory)) != nullptr; )
+        {
+            if (pEntry->d_type == DT_DIR && pEntry->d_name[0] != '.')
+            {
+                Directories.push_back(Directories[IndexOfDirectory] + pEntry->d_name + "/");
+            }
+        }
+
+        closedir(pDirectory);
+    }
+
+    if (m_Watches.empty())
+    {
+        close(m_Descriptor);
+
+        m_Descriptor = -1;
+
+        return false;
+    }
+#endif
+
+    m_IsRunning = true;
+
+    m_Thread = std::thread(&CHotReload::Watch, this);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::Stop()
+{
+    if (m_Thread.joinable())
+    {
+        m_IsRunning = false;
+
+        m_Thread.join();
+    }
+
+#if defined(_WIN32)
+    if (m_pDirectory != nullptr) CloseHandle(m_pDirectory);
+#else
+    if (m_Descriptor >= 0) close(m_Descriptor);
+#endif
+
+    m_pDirectory = nullptr;
+    m_Descriptor = -1;
+
+    m_Watches.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::AddTexture(const char* _pPath, BHandle* _ppTexture)
+{
+    SSource Source = { SType::Texture, AddFile(_pPath), std::string(), _ppTexture };
+
+    m_Sources.push_back(Source);
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::AddVertexShader(const char* _pPath, const char* _pFunction, BHandle* _ppShader)
+{
+    SSource Source = { SType::VertexShader, AddFile(_pPath), _pFunction, _ppShader };
+
+    m_Sources.push_back(Source);
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::AddPixelShader(const char* _pPath, const char* _pFunction, BHandle* _ppShader)
+{
+    SSource Source = { SType::PixelShader, AddFile(_pPath), _pFunction, _ppShader };
+
+    m_Sources.push_back(Source);
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::AddMaterial(const SMaterialInfo& _rMaterialInfo, BHandle* _ppMaterial)
+{
+    SMaterial Material = { _rMaterialInfo, _ppMaterial };
+
+    m_Materials.push_back(Material);
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::AddMesh(const SMeshInfo& _rMeshInfo, BHandle* _ppMesh)
+{
+    auto MaterialIterator = std::find_if(m_Materials.begin(), m_Materials.end(), [&](const SMaterial& _rMaterial)
+    {
+        return *_rMaterial.m_ppMaterial == _rMeshInfo.m_pMaterial;
+    });
+
+    assert(MaterialIterator != m_Materials.end() && "the material of the mesh has to be registered first");
+
+    if (MaterialIterator == m_Materials.end()) return;
+
+    size_t NumberOfFloats = static_cast<size_t>(_rMeshInfo.m_NumberOfVertices) * GetNumberOfFloatsPerVertex(MaterialIterator->m_Info);
+
+    SMesh Mesh;
+
+    Mesh.m_Info     = _rMeshInfo;
+    Mesh.m_Vertices.assign(_rMeshInfo.m_pVertices, _rMeshInfo.m_pVertices + NumberOfFloats);
+    Mesh.m_Indices .assign(_rMeshInfo.m_pIndices , _rMeshInfo.m_pIndices  + _rMeshInfo.m_NumberOfIndices);
+    Mesh.m_ppMesh   = _ppMesh;
+
+    m_Meshes.push_back(Mesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::Clear()
+{
+    // -----------------------------------------------------------------------------
+    // The files stay known to the watcher thread, their hashes are still valid
+    // when the objects are registered again.
+    // -----------------------------------------------------------------------------
+    m_Sources  .clear();
+    m_Materials.clear();
+    m_Meshes   .clear();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CHotReload::Update()
+{
+    m_PendingChanges.clear();
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        m_PendingChanges.swap(m_Changes);
+    }
+
+    if (m_PendingChanges.empty()) return false;
+
+    CStopwatch Stopwatch;
+
+    m_OldObjects.clear();
+    m_NewObjects.clear();
+
+    // -----------------------------------------------------------------------------
+    // Create the new objects of the changed files. The old ones are still in use
+    // until everything was created.
+    // -----------------------------------------------------------------------------
+    std::vector<int>           IndicesOfSources;
+    std::vector<int>           IndicesOfMaterials;
+    std::vector<SMaterialInfo> MaterialInfos;
+    std::vector<int>           IndicesOfMeshes;
+
+    bool   IsComplete = true;
+    double ChangeTime = m_PendingChanges[0].m_Time;
+
+    for (const SChange& rChange : m_PendingChanges)
+    {
+        ChangeTime = std::min(ChangeTime, rChange.m_Time);
+
+        for (int IndexOfSource = 0; IndexOfSource < static_cast<int>(m_Sources.size()) && IsComplete; ++ IndexOfSource)
+        {
+            if (m_Sources[IndexOfSource].m_IndexOfFile != rChange.m_IndexOfFile) continue;
+
+            BHandle pObject = CreateSource(m_Sources[IndexOfSource]);
+
+            if (pObject == nullptr)
+            {
+                IsComplete = false;
+
+                break;
+            }
+
+            IndicesOfSources.push_back(IndexOfSource);
+
+            m_OldObjects.push_back(*m_Sources[IndexOfSource].m_ppObject);
+            m_NewObjects.push_back(pObject);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The materials which use one of the new objects, then the meshes which use
+    // one of the new materials.
+    // -----------------------------------------------------------------------------
+    for (int IndexOfMaterial = 0; IndexOfMaterial < static_cast<int>(m_Materials.size()) && IsComplete; ++ IndexOfMaterial)
+    {
+        SMaterialInfo MaterialInfo = m_Materials[IndexOfMaterial].m_Info;
+
+        bool IsChanged = false;
+
+        for (int IndexOfTexture = 0; IndexOfTexture < MaterialInfo.m_NumberOfTextures; ++ IndexOfTexture)
+        {
+            IsChanged |= ReplaceHandle(MaterialInfo.m_pTextures[IndexOfTexture]);
+        }
+
+        IsChanged |= ReplaceHandle(MaterialInfo.m_pVertexShader);
+        IsChanged |= ReplaceHandle(MaterialInfo.m_pPixelShader);
+
+        if (IsChanged == false) continue;
+
+        BHandle pMaterial = nullptr;
+
+        CreateMaterial(MaterialInfo, &pMaterial);
+
+        if (pMaterial == nullptr)
+        {
+            IsComplete = false;
+
+            break;
+        }
+
+        IndicesOfMaterials.push_back(IndexOfMaterial);
+        MaterialInfos     .push_back(MaterialInfo);
+
+        m_OldObjects.push_back(*m_Materials[IndexOfMaterial].m_ppMaterial);
+        m_NewObjects.push_back(pMaterial);
+    }
+
+    for (int IndexOfMesh = 0; IndexOfMesh < static_cast<int>(m_Meshes.size()) && IsComplete; ++ IndexOfMesh)
+    {
+        SMesh& rMesh = m_Meshes[IndexOfMesh];
+
+        SMeshInfo MeshInfo = rMesh.m_Info;
+
+        if (ReplaceHandle(MeshInfo.m_pMaterial) == false) continue;
+
+        MeshInfo.m_pVertices = rMesh.m_Vertices.data();
+        MeshInfo.m_pIndices  = rMesh.m_Indices .data();
+
+        BHandle pMesh = nullptr;
+
+        CreateMesh(MeshInfo, &pMesh);
+
+        if (pMesh == nullptr)
+        {
+            IsComplete = false;
+
+            break;
+        }
+
+        IndicesOfMeshes.push_back(IndexOfMesh);
+
+        m_OldObjects.push_back(*rMesh.m_ppMesh);
+        m_NewObjects.push_back(pMesh);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Either swap everything or release everything new, so the frame never sees
+    // a mix of old and new objects. The objects are in the order sources,
+    // materials, meshes in both lists.
+    // -----------------------------------------------------------------------------
+    size_t IndexOfFirstMaterial = IndicesOfSources.size();
+    size_t IndexOfFirstMesh     = IndexOfFirstMaterial + IndicesOfMaterials.size();
+
+    std::vector<BHandle>& rReleasedObjects = IsComplete ? m_OldObjects : m_NewObjects;
+
+    if (IsComplete)
+    {
+        for (size_t Index = 0; Index < IndicesOfSources.size(); ++ Index)
+        {
+            *m_Sources[IndicesOfSources[Index]].m_ppObject = m_NewObjects[Index];
+        }
+
+        for (size_t Index = 0; Index < IndicesOfMaterials.size(); ++ Index)
+        {
+            SMaterial& rMaterial = m_Materials[IndicesOfMaterials[Index]];
+
+            rMaterial.m_Info        = MaterialInfos[Index];
+            *rMaterial.m_ppMaterial = m_NewObjects[IndexOfFirstMaterial + Index];
+        }
+
+        for (size_t Index = 0; Index < IndicesOfMeshes.size(); ++ Index)
+        {
+            SMesh& rMesh = m_Meshes[IndicesOfMeshes[Index]];
+
+            ReplaceHandle(rMesh.m_Info.m_pMaterial);
+
+            *rMesh.m_ppMesh = m_NewObjects[IndexOfFirstMesh + Index];
+        }
+    }
+
+    for (size_t Index = rReleasedObjects.size(); Index > IndexOfFirstMesh; -- Index)
+    {
+        ReleaseMesh(rReleasedObjects[Index - 1]);
+    }
+
+    for (size_t Index = IndexOfFirstMesh; Index > IndexOfFirstMaterial; -- Index)
+    {
+        ReleaseMaterial(rReleasedObjects[Index - 1]);
+    }
+
+    for (size_t Index = 0; Index < IndicesOfSources.size(); ++ Index)
+    {
+        switch (m_Sources[IndicesOfSources[Index]].m_Type)
+        {
+            case SType::Texture:      ReleaseTexture     (rReleasedObjects[Index]); break;
+            case SType::VertexShader: ReleaseVertexShader(rReleasedObjects[Index]); break;
+            case SType::PixelShader:  ReleasePixelShader (rReleasedObjects[Index]); break;
+        }
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    if (IsComplete == false)
+    {
+        m_Statistics.m_NumberOfFailedReloads += static_cast<int>(m_PendingChanges.size());
+
+        return false;
+    }
+
+    m_ChangeTime = ChangeTime;
+
+    m_Statistics.m_NumberOfReloads        += static_cast<int>(m_PendingChanges.size());
+    m_Statistics.m_NumberOfRebuiltObjects  = static_cast<int>(m_NewObjects.size());
+    m_Statistics.m_LastRebuildTime         = Stopwatch.GetElapsedMilliseconds();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CHotReload::OnFrameEnd()
+{
+    if (m_ChangeTime < 0.0) return false;
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_Statistics.m_LastReloadLatency = m_Clock.GetElapsedMilliseconds() - m_ChangeTime;
+
+    m_ChangeTime = -1.0;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+SHotReloadStatistics CHotReload::GetStatistics() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+int CHotReload::AddFile(const char* _pPath)
+{
+    std::string Name = Normalize(_pPath);
+
+    if (Name.compare(0, m_Directory.size() + 1, m_Directory + "/") == 0) Name.erase(0, m_Directory.size() + 1);
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        for (size_t IndexOfFile = 0; IndexOfFile < m_Files.size(); ++ IndexOfFile)
+        {
+            if (m_Files[IndexOfFile].m_Name == Name) return static_cast<int>(IndexOfFile);
+        }
+    }
+
+    SFile File = { _pPath, Name, GetFileHash(_pPath), -1.0, -1.0 };
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_Files.push_back(File);
+
+    return static_cast<int>(m_Files.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::Watch()
+{
+#if defined(_WIN32)
+    // -----------------------------------------------------------------------------
+    // One asynchronous read of the change notifications of the whole directory
+    // tree is pending all the time. The wait times out regularly to check the
+    // quiet files and whether the thread has to stop.
+    // -----------------------------------------------------------------------------
+    DWORD      Buffer[16384];
+    OVERLAPPED Overlapped = {};
+
+    Overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+    DWORD Filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+
+    bool IsPending = ReadDirectoryChangesW(m_pDirectory, Buffer, sizeof(Buffer), TRUE, Filter, nullptr, &Overlapped, nullptr) != FALSE;
+
+    while (m_IsRunning && IsPending)
+    {
+        if (WaitForSingleObject(Overlapped.hEvent, s_PollInterval) == WAIT_OBJECT_0)
+        {
+            DWORD NumberOfBytes = 0;
+
+            if (GetOverlappedResult(m_pDirectory, &Overlapped, &NumberOfBytes, FALSE) != FALSE && NumberOfBytes > 0)
+            {
+                const char* pEntry = reinterpret_cast<const char*>(Buffer);
+
+                for (;;)
+                {
+                    const FILE_NOTIFY_INFORMATION* pInformation = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(pEntry);
+
+                    char Name[MAX_PATH * 4];
+
+                    int Length = WideCharToMultiByte(CP_UTF8, 0, pInformation->FileName, static_cast<int>(pInformation->FileNameLength / sizeof(WCHAR)), Name, sizeof(Name) - 1, nullptr, nullptr);
+
+                    Name[std::max(Length, 0)] = '\0';
+
+                    OnNotification(Normalize(Name));
+
+                    if (pInformation->NextEntryOffset == 0) break;
+
+                    pEntry += pInformation->NextEntryOffset;
+                }
+            }
+
+            ResetEvent(Overlapped.hEvent);
+
+            IsPending = ReadDirectoryChangesW(m_pDirectory, Buffer, sizeof(Buffer), TRUE, Filter, nullptr, &Overlapped, nullptr) != FALSE;
+        }
+
+        CheckFiles();
+    }
+
+    if (IsPending)
+    {
+        DWORD NumberOfBytes = 0;
+
+        CancelIoEx(m_pDirectory, &Overlapped);
+        GetOverlappedResult(m_pDirectory, &Overlapped, &NumberOfBytes, TRUE);
+    }
+
+    CloseHandle(Overlapped.hEvent);
+#else
+    alignas(inotify_event) char Buffer[16384];
+
+    pollfd Descriptor = { m_Descriptor, POLLIN, 0 };
+
+    while (m_IsRunning)
+    {
+        if (poll(&Descriptor, 1, s_PollInterval) > 0)
+        {
+            ssize_t NumberOfBytes;
+
+            while ((NumberOfBytes = read(m_Descriptor, Buffer, sizeof(Buffer))) > 0)
+            {
+                for (const char* pEntry = Buffer; pEntry < Buffer + NumberOfBytes; )
+                {
+                    const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(pEntry);
+
+                    if (pEvent->len > 0)
+                    {
+                        for (const SWatch& rWatch : m_Watches)
+                        {
+                            if (rWatch.m_Descriptor == pEvent->wd) OnNotification(rWatch.m_Directory + Normalize(pEvent->name));
+                        }
+                    }
+
+                    pEntry += sizeof(inotify_event) + pEvent->len;
+                }
+            }
+        }
+
+        CheckFiles();
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::OnNotification(std::string _Name)
+{
+    double Time = m_Clock.GetElapsedMilliseconds();
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    for (SFile& rFile : m_Files)
+    {
+        if (rFile.m_Name != _Name) continue;
+
+        if (rFile.m_FirstChangeTime < 0.0) rFile.m_FirstChangeTime = Time;
+
+        rFile.m_LastChangeTime = Time;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CHotReload::CheckFiles()
+{
+    // -----------------------------------------------------------------------------
+    // Editors often write a file in several steps. A file is read once it was
+    // quiet for a moment, outside of the lock, so 'Update' never waits for the
+    // file system.
+    // -----------------------------------------------------------------------------
+    double Time = m_Clock.GetElapsedMilliseconds();
+
+    std::vector<int>         IndicesOfFiles;
+    std::vector<std::string> Paths;
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        for (size_t IndexOfFile = 0; IndexOfFile < m_Files.size(); ++ IndexOfFile)
+        {
+            const SFile& rFile = m_Files[IndexOfFile];
+
+            if (rFile.m_FirstChangeTime >= 0.0 && Time - rFile.m_LastChangeTime >= s_QuietTime)
+            {
+                IndicesOfFiles.push_back(static_cast<int>(IndexOfFile));
+                Paths         .push_back(rFile.m_Path);
+            }
+        }
+    }
+
+    for (size_t Index = 0; Index < IndicesOfFiles.size(); ++ Index)
+    {
+        unsigned long long Hash = GetFileHash(Paths[Index].c_str());
+
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        SFile& rFile = m_Files[IndicesOfFiles[Index]];
+
+        if (Hash == 0) continue;
+
+        if (Hash == rFile.m_Hash)
+        {
+            ++ m_Statistics.m_NumberOfIgnoredChanges;
+        }
+        else
+        {
+            SChange Change = { IndicesOfFiles[Index], rFile.m_FirstChangeTime };
+
+            m_Changes.push_back(Change);
+
+            rFile.m_Hash = Hash;
+        }
+
+        rFile.m_FirstChangeTime = -1.0;
+        rFile.m_LastChangeTime  = -1.0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CHotReload::ReplaceHandle(BHandle& _rpObject) const
+{
+    for (size_t Index = 0; Index < m_OldObjects.size(); ++ Index)
+    {
+        if (m_OldObjects[Index] == _rpObject && _rpObject != nullptr)
+        {
+            _rpObject = m_NewObjects[Index];
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CHotReload::CreateSource(const SSource& _rSource) const
+{
+    const std::string& rPath = m_Files[_rSource.m_IndexOfFile].m_Path;
+
+    BHandle pObject = nullptr;
+
+    switch (_rSource.m_Type)
+    {
+        case SType::Texture:      CreateTexture     (rPath.c_str(), &pObject); break;
+        case SType::VertexShader: CreateVertexShader(rPath.c_str(), _rSource.m_Function.c_str(), &pObject); break;
+        case SType::PixelShader:  CreatePixelShader (rPath.c_str(), _rSource.m_Function.c_str(), &pObject); break;
+    }
+
+    return pObject;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include "frame_statistics.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+struct SHotReloadStatistics
+{
+    int    m_NumberOfReloads;                                           // Changed files whose objects were swapped.
+    int    m_NumberOfFailedReloads;                                     // Changed files whose objects could not be created, the old ones are kept.
+    int    m_NumberOfIgnoredChanges;                                    // Notifications without a change of the content, e.g. a save without edits.
+    int    m_NumberOfRebuiltObjects;                                    // Textures, shaders, materials, and meshes created by the last reload.
+    double m_LastRebuildTime;                                           // Time to create and swap the objects of the last reload in milliseconds.
+    double m_LastReloadLatency;                                         // Time from the change notification to the end of the first frame with the new objects in milliseconds.
+};
+
+// -----------------------------------------------------------------------------
+// Watches the data directory and rebuilds the YoshiX objects of changed shader
+// and texture files while the application runs. The objects are registered
+// with the address of the member which holds their handle. A background thread
+// waits for change notifications of the file system, waits until the file was
+// not touched for a short time, and compares a hash of the content, so saving
+// without changes does not rebuild anything.
+//
+// YoshiX objects cannot be changed after creation, so 'Update' creates new
+// objects on the render thread between two frames: the changed textures and
+// shaders first, then the materials which use them, then the meshes which use
+// these materials. Only if all of them were created, the handles in the
+// registered members are replaced at once and the old objects are released.
+// If a shader does not compile the old objects stay in use.
+// -----------------------------------------------------------------------------
+class CHotReload
+{
+    public:
+
+        CHotReload();
+        ~CHotReload();
+
+        CHotReload(const CHotReload&) = delete;
+        CHotReload& operator = (const CHotReload&) = delete;
+
+    public:
+
+        bool Start(const char* _pDirectory);
+        void Stop();
+
+        // -----------------------------------------------------------------------------
+        // Register objects after creating them. Materials have to be registered
+        // before the meshes which use them. The vertices and indices of meshes are
+        // copied, because YoshiX needs them again to create the mesh.
+        // -----------------------------------------------------------------------------
+        void AddTexture(const char* _pPath, gfx::BHandle* _ppTexture);
+        void AddVertexShader(const char* _pPath, const char* _pFunction, gfx::BHandle* _ppShader);
+        void AddPixelShader(const char* _pPath, const char* _pFunction, gfx::BHandle* _ppShader);
+        void AddMaterial(const gfx::SMaterialInfo& _rMaterialInfo, gfx::BHandle* _ppMaterial);
+        void AddMesh(const gfx::SMeshInfo& _rMeshInfo, gfx::BHandle* _ppMesh);
+        void Clear();
+
+        // -----------------------------------------------------------------------------
+        // Call 'Update' on the render thread before the frame, e.g. in 'OnUpdate'.
+        // It returns true if handles were replaced. Call 'OnFrameEnd' at the end of
+        // each frame to measure the latency.
+        // -----------------------------------------------------------------------------
+        bool Update();
+        bool OnFrameEnd();                                              // True if the latency of a reload was measured in this frame.
+
+        SHotReloadStatistics GetStatistics() const;
+
+    private:
+
+        struct SType
+        {
+            enum EType
+            {
+                Texture,                                                ///< The object is a texture.
+                VertexShader,                                           ///< The object is a vertex shader.
+                PixelShader,                                            ///< The object is a pixel shader.
+            };
+        };
+
+        struct SFile
+        {
+            std::string        m_Path;                                  // The path as passed to YoshiX.
+            std::string        m_Name;                                  // Normalized path relative to the watched directory.
+            unsigned long long m_Hash;                                  // Hash of the content of the last load.
+            double             m_FirstChangeTime;                       // Time of the first notification since the last load, negative if none is pending.
+            double             m_LastChangeTime;                        // Time of the last notification, the file is read once it is quiet.
+        };
+
+        struct SSource
+        {
+            SType::EType  m_Type;
+            int           m_IndexOfFile;
+            std::string   m_Function;                                   // Shader function, empty for textures.
+            gfx::BHandle* m_ppObject;
+        };
+
+        struct SMaterial
+        {
+            gfx::SMaterialInfo m_Info;
+            gfx::BHandle*      m_ppMaterial;
+        };
+
+        struct SMesh
+        {
+            gfx::SMeshInfo     m_Info;
+            std::vector<float> m_Vertices;
+            std::vector<int>   m_Indices;
+            gfx::BHandle*      m_ppMesh;
+        };
+
+        struct SWatch
+        {
+            int         m_Descriptor;
+            std::string m_Directory;                                    // Relative to the watched directory, empty or ending with a slash.
+        };
+
+        struct SChange
+        {
+            int    m_IndexOfFile;
+            double m_Time;                                              // Time of the first notification.
+        };
+
+    private:
+
+        std::vector<SSource>      m_Sources;
+        std::vector<SMaterial>    m_Materials;
+        std::vector<SMesh>        m_Meshes;
+
+        mutable std::mutex        m_Mutex;                              // Guards the files and the changes shared with the watcher thread.
+        std::vector<SFile>        m_Files;
+        std::vector<SChange>      m_Changes;                            // Changed files found by the watcher thread, consumed by 'Update'.
+        std::vector<SChange>      m_PendingChanges;                     // Used by 'Update' only.
+        std::vector<gfx::BHandle> m_OldObjects;                         // Objects replaced by the current reload ...
+        std::vector<gfx::BHandle> m_NewObjects;                         // ... and their replacements.
+
+        std::string               m_Directory;                          // Normalized path of the watched directory.
+        std::thread               m_Thread;
+        std::atomic<bool>         m_IsRunning;
+        void*                     m_pDirectory;                         // Handle of the watched directory on Windows.
+        int                       m_Descriptor;                         // The inotify instance on other systems ...
+        std::vector<SWatch>       m_Watches;                            // ... and its watches, one per directory.
+        CStopwatch                m_Clock;                              // Time base of all time stamps.
+
+        double                    m_ChangeTime;                         // Time of the change whose latency is measured, negative if none.
+        SHotReloadStatistics      m_Statistics;
+
+    private:
+
+        int  AddFile(const char* _pPath);
+        void Watch();
+        void OnNotification(std::string _Name);
+        void CheckFiles();
+        bool ReplaceHandle(gfx::BHandle& _rpObject) const;
+
+        gfx::BHandle CreateSource(const SSource& _rSource) const;
+};
@@ -0,0 +1,686 @@
+
+#include "image_filter.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <math.h>
+#include <thread>
+
+#if defined(_MSC_VER) || defined(__AVX2__)
+#define FILTER_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Number of floats one column strip covers. 64 floats are four cache lines per
+    // row, so the running sums of a strip stay in the first level cache.
+    // -----------------------------------------------------------------------------
+    const int s_StripWidth = 64;
+
+    // -----------------------------------------------------------------------------
+    // Edge length of the square blocks of the transposition in pixels.
+    // -----------------------------------------------------------------------------
+    const int s_BlockSize  = 32;
+
+    int  s_NumberOfThreads = 0;
+    bool s_IsSimdEnabled   = true;
+
+    // -----------------------------------------------------------------------------
+
+    bool DetectSimdSupport()
+    {
+#if defined(FILTER_AVX2) && defined(_MSC_VER)
+        int Info[4];
+
+        __cpuid(Info, 1);
+
+        bool IsOSXSaveSupported = (Info[2] & (1 << 27)) != 0;
+        bool IsAvxSupported     = (Info[2] & (1 << 28)) != 0;
+
+        if (IsOSXSaveSupported == false || IsAvxSupported == false) return false;
+
+        if ((_xgetbv(0) & 6) != 6) return false;
+
+        __cpuidex(Info, 7, 0);
+
+        return (Info[1] & (1 << 5)) != 0;
+#elif defined(FILTER_AVX2)
+        return __builtin_cpu_supports("avx2") != 0;
+#else
+        return false;
+#endif
+    }
+
+    const bool s_IsSimdSupported = DetectSimdSupport();
+
+#if defined(FILTER_AVX2)
+    // -----------------------------------------------------------------------------
+
+    bool UseSimd()
+    {
+        return s_IsSimdEnabled && s_IsSimdSupported;
+    }
+#endif
+
+    // -----------------------------------------------------------------------------
+    // Calls the function for all indices in [0, count) as jobs of the shared job
+    // system. The batches are contiguous, so neighboring strips stay together,
+    // and about four per thread, so idle threads have something to steal.
+    // -----------------------------------------------------------------------------
+    template<typename TFunction>
+    void ParallelFor(int _Count, const TFunction& _rFunction)
+    {
+        int NumberOfThreads = std::min(filter::GetNumberOfThreads(), _Count);
+
+        if (NumberOfThreads <= 1)
+        {
+            for (int Index = 0; Index < _Count; ++ Index) _rFunction(Index);
+
+            return;
+        }
+
+        GetJobSystem().ParallelFor(_Count, std::max(_Count / (NumberOfThreads * 4), 1), _rFunction);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int GetRowLength(const filter::SImage& _rImage)
+    {
+        return _rImage.m_Width * _rImage.m_NumberOfChannels;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Sliding window box filter down the columns of one strip. Each float column
+    // is independent, so the inner loop works on eight columns at once.
+    // -----------------------------------------------------------------------------
+    void BoxBlurStrip(const filter::SImage& _rSource, filter::SImage& _rDestination, int _First, int _Count, int _Radius)
+    {
+        int          Height = _rSource.m_Height;
+        int          Stride = GetRowLength(_rSource);
+        float        Scale  = 1.0f / static_cast<float>(2 * _Radius + 1);
+        const float* pSource = _rSource.m_pPixels + _First;
+        float*       pDestination = _rDestination.m_pPixels + _First;
+
+        float Sums[s_StripWidth];
+
+        for (int Index = 0; Index < _Count; ++ Index)
+        {
+            Sums[Index] = static_cast<float>(_Radius + 1) * pSource[Index];
+
+            for (int Offset = 1; Offset <= _Radius; ++ Offset)
+            {
+                Sums[Index] += pSource[std::min(Offset, Height - 1) * Stride + Index];
+            }
+        }
+
+        for (int Y = 0; Y < Height; ++ Y)
+        {
+            const float* pAdd = pSource + std::min(Y + _Radius + 1, Height - 1) * Stride;
+            const float* pSub = pSource + std::max(Y - _Radius, 0) * Stride;
+            float*       pOut = pDestination + Y * Stride;
+
+            int Index = 0;
+
+#if defined(FILTER_AVX2)
+            if (UseSimd())
+            {
+                __m256 ScaleVector = _mm256_set1_ps(Scale);
+
+                for (; Index + 8 <= _Count; Index += 8)
+                {
+                    __m256 Sum = _mm256_loadu_ps(Sums + Index);
+
+                    _mm256_storeu_ps(pOut + Index, _mm256_mul_ps(Sum, ScaleVector));
+
+                    Sum = _mm256_add_ps(Sum, _mm256_loadu_ps(pAdd + Index));
+                    Sum = _mm256_sub_ps(Sum, _mm256_loadu_ps(pSub + Index));
+
+                    _mm256_storeu_ps(Sums + Index, Sum);
+                }
+            }
+#endif
+
+            for (; Index < _Count; ++ Index)
+            {
+                pOut[Index]  = Sums[Index] * Scale;
+                Sums[Index] += pAdd[Index] - pSub[Index];
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void BoxBlurVertical(const filter::SImage& _rSource, filter::SImage& _rDestination, int _Radius)
+    {
+        int RowLength        = GetRowLength(_rSource);
+        int NumberOfStrips   = (RowLength + s_StripWidth - 1) / s_StripWidth;
+
+        ParallelFor(NumberOfStrips, [&](int _IndexOfStrip)
+        {
+            int First = _IndexOfStrip * s_StripWidth;
+
+            BoxBlurStrip(_rSource, _rDestination, First, std::min(s_StripWidth, RowLength - First), _Radius);
+        });
+    }
+
+    // -----------------------------------------------------------------------------
+    // Coefficients of the recursive Gaussian by Young and van Vliet.
+    // -----------------------------------------------------------------------------
+    struct SRecursiveCoefficients
+    {
+        float m_B;
+        float m_B1;
+        float m_B2;
+        float m_B3;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    SRecursiveCoefficients GetRecursiveCoefficients(float _Sigma)
+    {
+        float Sigma = std::max(_Sigma, 0.5f);
+        float Q     = Sigma >= 2.5f ? 0.98711f * Sigma - 0.96330f : 3.97156f - 4.14554f * sqrtf(1.0f - 0.26891f * Sigma);
+        float Q2    = Q  * Q;
+        float Q3    = Q2 * Q;
+
+        float B0 = 1.57825f + 2.44413f * Q + 1.4281f * Q2 + 0.422205f * Q3;
+        float B1 = 2.44413f * Q + 2.85619f * Q2 + 1.26661f * Q3;
+        float B2 = -(1.4281f * Q2 + 1.26661f * Q3);
+        float B3 = 0.422205f * Q3;
+
+        SRecursiveCoefficients Coefficients;
+
+        Coefficients.m_B1 = B1 / B0;
+        Coefficients.m_B2 = B2 / B0;
+        Coefficients.m_B3 = B3 / B0;
+        Coefficients.m_B  = 1.0f - (Coefficients.m_B1 + Coefficients.m_B2 + Coefficients.m_B3);
+
+        return Coefficients;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Causal and anti-causal pass down the columns of one strip. The filter state
+    // is initialized with the border value, which is the steady state response.
+    // -----------------------------------------------------------------------------
+    void RecursiveGaussianStrip(const filter::SImage& _rSource, filter::SImage& _rDestination, int _First, int _Count, const SRecursiveCoefficients& _rCoefficients)
+    {
+        int          Height       = _rSource.m_Height;
+        int          Stride       = GetRowLength(_rSource);
+        const float* pSource      = _rSource.m_pPixels + _First;
+        float*       pDestination = _rDestination.m_pPixels + _First;
+
+        const float B  = _rCoefficients.m_B;
+        const float B1 = _rCoefficients.m_B1;
+        const float B2 = _rCoefficients.m_B2;
+        const float B3 = _rCoefficients.m_B3;
+
+        int Index = 0;
+
+#if defined(FILTER_AVX2)
+        if (UseSimd())
+        {
+            __m256 VB  = _mm256_set1_ps(B);
+            __m256 VB1 = _mm256_set1_ps(B1);
+            __m256 VB2 = _mm256_set1_ps(B2);
+            __m256 VB3 = _mm256_set1_ps(B3);
+
+            for (; Index + 8 <= _Count; Index += 8)
+            {
+                __m256 W1 = _mm256_loadu_ps(pSource + Index);
+                __m256 W2 = W1;
+                __m256 W3 = W1;
+
+                for (int Y = 0; Y < Height; ++ Y)
+                {
+                    __m256 W = _mm256_mul_ps(VB, _mm256_loadu_ps(pSource + Y * Stride + Index));
+
+                    W = _mm256_add_ps(W, _mm256_mul_ps(VB1, W1));
+                    W = _mm256_add_ps(W, _mm256_mul_ps(VB2, W2));
+                    W = _mm256_add_ps(W, _mm256_mul_ps(VB3, W3));
+
+                    _mm256_storeu_ps(pDestination + Y * Stride + Index, W);
+
+                    W3 = W2; W2 = W1; W1 = W;
+                }
+
+                W1 = _mm256_loadu_ps(pDestination + (Height - 1) * Stride + Index);
+                W2 = W1;
+                W3 = W1;
+
+                for (int Y = Height - 1; Y >= 0; -- Y)
+                {
+                    __m256 W = _mm256_mul_ps(VB, _mm256_loadu_ps(pDestination + Y * Stride + Index));
+
+                    W = _mm256_add_ps(W, _mm256_mul_ps(VB1, W1));
+                    W = _mm256_add_ps(W, _mm256_mul_ps(VB2, W2));
+                    W = _mm256_add_ps(W, _mm256_mul_ps(VB3, W3));
+
+                    _mm256_storeu_ps(pDestination + Y * Stride + Index, W);
+
+                    W3 = W2; W2 = W1; W1 = W;
+                }
+            }
+        }
+#endif
+
+        for (; Index < _Count; ++ Index)
+        {
+            float W1 = pSource[Index];
+            float W2 = W1;
+            float W3 = W1;
+
+            for (int Y = 0; Y < Height; ++ Y)
+            {
+                float W = B * pSource[Y * Stride + Index] + B1 * W1 + B2 * W2 + B3 * W3;
+
+                pDestination[Y * Stride + Index] = W;
+
+                W3 = W2; W2 = W1; W1 = W;
+            }
+
+            W1 = pDestination[(Height - 1) * Stride + Index];
+            W2 = W1;
+            W3 = W1;
+
+            for (int Y = Height - 1; Y >= 0; -- Y)
+            {
+                float W = B * pDestination[Y * Stride + Index] + B1 * W1 + B2 * W2 + B3 * W3;
+
+                pDestination[Y * Stride + Index] = W;
+
+                W3 = W2; W2 = W1; W1 = W;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void RecursiveGaussianVertical(const filter::SImage& _rSource, filter::SImage& _rDestination, float _Sigma)
+    {
+        SRecursiveCoefficients Coefficients = GetRecursiveCoefficients(_Sigma);
+
+        int RowLength      = GetRowLength(_rSource);
+        int NumberOfStrips = (RowLength + s_StripWidth - 1) / s_StripWidth;
+
+        ParallelFor(NumberOfStrips, [&](int _IndexOfStrip)
+        {
+            int First = _IndexOfStrip * s_StripWidth;
+
+            RecursiveGaussianStrip(_rSource, _rDestination, First, std::min(s_StripWidth, RowLength - First), Coefficients);
+        });
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetLuminance(const float* _pPixel)
+    {
+        return 0.2126f * _pPixel[0] + 0.7152f * _pPixel[1] + 0.0722f * _pPixel[2];
+    }
+} // namespace
+
+namespace filter
+{
+    CImage::CImage()
+        : m_Width           (0)
+        , m_Height          (0)
+        , m_NumberOfChannels(0)
+    {
+    }
+
+    // -----------------------------------------------------------------------------
+
+    CImage::CImage(int _Width, int _Height, int _NumberOfChannels)
+        : m_Width           (0)
+        , m_Height          (0)
+        , m_NumberOfChannels(0)
+    {
+        Resize(_Width, _Height, _NumberOfChannels);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CImage::Resize(int _Width, int _Height, int _NumberOfChannels)
+    {
+        m_Width            = _Width;
+        m_Height           = _Height;
+        m_NumberOfChannels = _NumberOfChannels;
+
+        m_Pixels.resize(static_cast<size_t>(_Width) * _Height * _NumberOfChannels);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SImage CImage::GetView()
+    {
+        SImage Image = { m_Pixels.data(), m_Width, m_Height, m_NumberOfChannels };
+
+        return Image;
+    }
+} // namespace filter
+
+namespace filter
+{
+    void SetNumberOfThreads(int _NumberOfThreads)
+    {
+        s_NumberOfThreads = _NumberOfThreads;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int GetNumberOfThreads()
+    {
+        if (s_NumberOfThreads > 0) return s_NumberOfThreads;
+
+        return std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetSimdEnabled(bool _Flag)
+    {
+        s_IsSimdEnabled = _Flag;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsSimdEnabled()
+    {
+        return s_IsSimdEnabled;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsSimdSupported()
+    {
+        return s_IsSimdSupported;
+    }
+} // namespace filter
+
+namespace filter
+{
+    void Transpose(const SImage& _rSource, SImage& _rDestination)
+    {
+        int Width            = _rSource.m_Width;
+        int Height           = _rSource.m_Height;
+        int NumberOfChannels = _rSource.m_NumberOfChannels;
+        int NumberOfBlocksY  = (Height + s_BlockSize - 1) / s_BlockSize;
+
+        // -----------------------------------------------------------------------------
+        // Blocks of 32x32 pixels are copied at once, so both the read rows and the
+        // written rows of a block stay in the cache.
+        // -----------------------------------------------------------------------------
+        ParallelFor(NumberOfBlocksY, [&](int _IndexOfBlockY)
+        {
+            int MinY = _IndexOfBlockY * s_BlockSize;
+            int MaxY = std::min(MinY + s_BlockSize, Height);
+
+            for (int MinX = 0; MinX < Width; MinX += s_BlockSize)
+            {
+                int MaxX = std::min(MinX + s_BlockSize, Width);
+
+                for (int Y = MinY; Y < MaxY; ++ Y)
+                {
+                    const float* pSource = _rSource.m_pPixels + (static_cast<size_t>(Y) * Width + MinX) * NumberOfChannels;
+
+                    for (int X = MinX; X < MaxX; ++ X)
+                    {
+                        float* pDestination = _rDestination.m_pPixels + (static_cast<size_t>(X) * Height + Y) * NumberOfChannels;
+
+                        for (int Channel = 0; Channel < NumberOfChannels; ++ Channel)
+                        {
+                            pDestination[Channel] = *pSource ++;
+                        }
+                    }
+                }
+            }
+        });
+
+        _rDestination.m_Width  = Height;
+        _rDestination.m_Height = Width;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void BoxBlur(const SImage& _rSource, SImage& _rDestination, int _Radius)
+    {
+        // -----------------------------------------------------------------------------
+        // The vertical pass vectorizes over the columns. The horizontal pass is the
+        // vertical pass of the transposed image.
+        // -----------------------------------------------------------------------------
+        CImage FirstTemporary (_rSource.m_Width, _rSource.m_Height, _rSource.m_NumberOfChannels);
+        CImage SecondTemporary(_rSource.m_Height, _rSource.m_Width, _rSource.m_NumberOfChannels);
+
+        SImage First  = FirstTemporary .GetView();
+        SImage Second = SecondTemporary.GetView();
+
+        BoxBlurVertical(_rSource, First, _Radius);
+        Transpose      (First, Second);
+        First.m_Width  = _rSource.m_Height;
+        First.m_Height = _rSource.m_Width;
+        BoxBlurVertical(Second, First, _Radius);
+        Transpose      (First, _rDestination);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void RecursiveGaussianBlur(const SImage& _rSource, SImage& _rDestination, float _Sigma)
+    {
+        CImage FirstTemporary (_rSource.m_Width, _rSource.m_Height, _rSource.m_NumberOfChannels);
+        CImage SecondTemporary(_rSource.m_Height, _rSource.m_Width, _rSource.m_NumberOfChannels);
+
+        SImage First  = FirstTemporary .GetView();
+        SImage Second = SecondTemporary.GetView();
+
+        RecursiveGaussianVertical(_rSource, First, _Sigma);
+        Transpose                (First, Second);
+        RecursiveGaussianVertical(Second, Second, _Sigma);
+        Transpose                (Second, _rDestination);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void Bloom(const SImage& _rSource, SImage& _rDestination, float _Threshold, float _Sigma, float _Intensity)
+    {
+        int Width  = _rSource.m_Width;
+        int Height = _rSource.m_Height;
+
+        CImage BrightTemporary(Width, Height, 4);
+
+        SImage Bright = BrightTemporary.GetView();
+
+        // -----------------------------------------------------------------------------
+        // Keep the part of each pixel above the luminance threshold.
+        // -----------------------------------------------------------------------------
+        ParallelFor(Height, [&](int _Y)
+        {
+            const float* pSource = _rSource.m_pPixels + static_cast<size_t>(_Y) * Width * 4;
+            float*       pBright = Bright   .m_pPixels + static_cast<size_t>(_Y) * Width * 4;
+
+            for (int X = 0; X < Width; ++ X, pSource += 4, pBright += 4)
+            {
+                float Luminance = GetLuminance(pSource);
+                float Factor    = Luminance > _Threshold ? (Luminance - _Threshold) / Luminance : 0.0f;
+
+                pBright[0] = pSource[0] * Factor;
+                pBright[1] = pSource[1] * Factor;
+                pBright[2] = pSource[2] * Factor;
+                pBright[3] = 0.0f;
+            }
+        });
+
+        RecursiveGaussianBlur(Bright, Bright, _Sigma);
+
+        // -----------------------------------------------------------------------------
+        // Add the blurred bright parts. The alpha of the bright image is zero, so the
+        // alpha of the source is kept.
+        // -----------------------------------------------------------------------------
+        ParallelFor(Height, [&](int _Y)
+        {
+            size_t       Offset       = static_cast<size_t>(_Y) * Width * 4;
+            const float* pSource      = _rSource    .m_pPixels + Offset;
+            const float* pBright      = Bright      .m_pPixels + Offset;
+            float*       pDestination = _rDestination.m_pPixels + Offset;
+
+            int Index = 0;
+
+#if defined(FILTER_AVX2)
+            if (UseSimd())
+            {
+                __m256 Intensity = _mm256_set1_ps(_Intensity);
+
+                for (; Index + 8 <= Width * 4; Index += 8)
+                {
+                    __m256 Result = _mm256_add_ps(_mm256_loadu_ps(pSource + Index), _mm256_mul_ps(Intensity, _mm256_loadu_ps(pBright + Index)));
+
+                    _mm256_storeu_ps(pDestination + Index, Result);
+                }
+            }
+#endif
+
+            for (; Index < Width * 4; ++ Index)
+            {
+                pDestination[Index] = pSource[Index] + _Intensity * pBright[Index];
+            }
+        });
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void DetectEdges(const SImage& _rSource, SImage& _rDestination)
+    {
+        int Width  = _rSource.m_Width;
+        int Height = _rSource.m_Height;
+
+        CImage LuminanceTemporary;
+
+        SImage Luminance = _rSource;
+
+        if (_rSource.m_NumberOfChannels != 1)
+        {
+            LuminanceTemporary.Resize(Width, Height, 1);
+
+            Luminance = LuminanceTemporary.GetView();
+
+            ParallelFor(Height, [&](int _Y)
+            {
+                const float* pSource    = _rSource.m_pPixels + static_cast<size_t>(_Y) * Width * _rSource.m_NumberOfChannels;
+                float*       pLuminance = Luminance.m_pPixels + static_cast<size_t>(_Y) * Width;
+
+                for (int X = 0; X < Width; ++ X, pSource += _rSource.m_NumberOfChannels)
+                {
+                    pLuminance[X] = GetLuminance(pSource);
+                }
+            });
+        }
+
+        // -----------------------------------------------------------------------------
+        // Sobel operator with clamped borders. The interior of each row is computed
+        // for eight pixels at once.
+        // -----------------------------------------------------------------------------
+        ParallelFor(Height, [&](int _Y)
+        {
+            const float* pAbove = Luminance.m_pPixels + static_cast<size_t>(std::max(_Y - 1, 0))          * Width;
+            const float* pRow   = Luminance.m_pPixels + static_cast<size_t>(_Y)                           * Width;
+            const float* pBelow = Luminance.m_pPixels + static_cast<size_t>(std::min(_Y + 1, Height - 1)) * Width;
+            float*       pOut   = _rDestination.m_pPixels + static_cast<size_t>(_Y) * Width;
+
+            auto GetEdge = [&](int _X)
+            {
+                int Left  = std::max(_X - 1, 0);
+                int Right = std::min(_X + 1, Width - 1);
+
+                float GX = (pAbove[Right] + 2.0f * pRow[Right] + pBelow[Right]) - (pAbove[Left] + 2.0f * pRow[Left] + pBelow[Left]);
+                float GY = (pBelow[Left] + 2.0f * pBelow[_X] + pBelow[Right]) - (pAbove[Left] + 2.0f * pAbove[_X] + pAbove[Right]);
+
+                return sqrtf(GX * GX + GY * GY);
+            };
+
+            int X = 0;
+
+            if (Width > 0) pOut[X ++] = GetEdge(0);
+
+#if defined(FILTER_AVX2)
+            if (UseSimd())
+            {
+                __m256 Two = _mm256_set1_ps(2.0f);
+
+                for (; X + 8 < Width; X += 8)
+                {
+                    __m256 AboveLeft  = _mm256_loadu_ps(pAbove + X - 1);
+                    __m256 Above      = _mm256_loadu_ps(pAbove + X);
+                    __m256 AboveRight = _mm256_loadu_ps(pAbove + X + 1);
+                    __m256 Left       = _mm256_loadu_ps(pRow   + X - 1);
+                    __m256 Right      = _mm256_loadu_ps(pRow   + X + 1);
+                    __m256 BelowLeft  = _mm256_loadu_ps(pBelow + X - 1);
+                    __m256 Below      = _mm256_loadu_ps(pBelow + X);
+                    __m256 BelowRight = _mm256_loadu_ps(pBelow + X + 1);
+
+                    __m256 GX = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(AboveRight, BelowRight), _mm256_mul_ps(Two, Right)),
+                                              _mm256_add_ps(_mm256_add_ps(AboveLeft , BelowLeft ), _mm256_mul_ps(Two, Left )));
+                    __m256 GY = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(BelowLeft, BelowRight), _mm256_mul_ps(Two, Below)),
+                                              _mm256_add_ps(_mm256_add_ps(AboveLeft, AboveRight), _mm256_mul_ps(Two, Above)));
+
+                    _mm256_storeu_ps(pOut + X, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(GX, GX), _mm256_mul_ps(GY, GY))));
+                }
+            }
+#endif
+
+            for (; X < Width; ++ X) pOut[X] = GetEdge(X);
+        });
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ToneMap(const SImage& _rSource, SImage& _rDestination, float _Exposure)
+    {
+        int Width  = _rSource.m_Width;
+        int Height = _rSource.m_Height;
+
+        ParallelFor(Height, [&](int _Y)
+        {
+            size_t       Offset       = static_cast<size_t>(_Y) * Width * 4;
+            const float* pSource      = _rSource    .m_pPixels + Offset;
+            float*       pDestination = _rDestination.m_pPixels + Offset;
+
+            int Index = 0;
+
+#if defined(FILTER_AVX2)
+            if (UseSimd())
+            {
+                __m256 Exposure = _mm256_set1_ps(_Exposure);
+                __m256 One      = _mm256_set1_ps(1.0f);
+
+                for (; Index + 8 <= Width * 4; Index += 8)
+                {
+                    __m256 Color  = _mm256_loadu_ps(pSource + Index);
+                    __m256 Scaled = _mm256_mul_ps(Color, Exposure);
+                    __m256 Mapped = _mm256_div_ps(Scaled, _mm256_add_ps(One, Scaled));
+
+                    // -----------------------------------------------------------------------------
+                    // Two RGBA pixels per register, keep the alpha lanes 3 and 7.
+                    // -----------------------------------------------------------------------------
+                    _mm256_storeu_ps(pDestination + Index, _mm256_blend_ps(Mapped, Color, 0x88));
+                }
+            }
+#endif
+
+            for (; Index < Width * 4; Index += 4)
+            {
+                for (int Channel = 0; Channel < 3; ++ Channel)
+                {
+                    float Scaled = pSource[Index + Channel] * _Exposure;
+
+                    pDestination[Index + Channel] = Scaled / (1.0f + Scaled);
+                }
+
+                pDestination[Index + 3] = pSource[Index + 3];
+            }
+        });
+    }
+} // namespace filter
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+
+namespace filter
+{
+    // -----------------------------------------------------------------------------
+    // A view on an image with float channels stored interleaved and row by row.
+    // Color targets use four channels (RGBA), depth uses one channel.
+    // -----------------------------------------------------------------------------
+    struct SImage
+    {
+        float* m_pPixels;                                               ///< Pointer to the first channel of the upper left pixel.
+        int    m_Width;                                                 ///< Width of the image in pixels.
+        int    m_Height;                                                ///< Height of the image in pixels.
+        int    m_NumberOfChannels;                                      ///< The number of floats per pixel.
+    };
+
+    // -----------------------------------------------------------------------------
+    // Owns the memory of an image.
+    // -----------------------------------------------------------------------------
+    class CImage
+    {
+        public:
+
+            CImage();
+            CImage(int _Width, int _Height, int _NumberOfChannels);
+
+        public:
+
+            void   Resize(int _Width, int _Height, int _NumberOfChannels);
+
+            SImage GetView();
+
+        private:
+
+            std::vector<float> m_Pixels;                                // The channels of all pixels.
+            int                m_Width;                                 // Width of the image in pixels.
+            int                m_Height;                                // Height of the image in pixels.
+            int                m_NumberOfChannels;                      // The number of floats per pixel.
+    };
+} // namespace filter
+
+namespace filter
+{
+    // -----------------------------------------------------------------------------
+    // Global settings. The filters split their work in row and column strips and
+    // run them as jobs of the shared job system, with one thread they run on the
+    // calling thread only. The AVX2 inner loops are only used if the CPU supports
+    // them.
+    // -----------------------------------------------------------------------------
+    void SetNumberOfThreads(int _NumberOfThreads);
+    int  GetNumberOfThreads();
+
+    void SetSimdEnabled(bool _Flag);
+    bool IsSimdEnabled();
+    bool IsSimdSupported();
+} // namespace filter
+
+namespace filter
+{
+    // -----------------------------------------------------------------------------
+    // Separable blurs. The box blur uses a sliding window, so its cost does not
+    // depend on the radius. The recursive Gaussian uses the third order IIR
+    // approximation of Young and van Vliet, so its cost does not depend on sigma.
+    // Source and destination have to be of the same size and may be identical.
+    // -----------------------------------------------------------------------------
+    void BoxBlur(const SImage& _rSource, SImage& _rDestination, int _Radius);
+    void RecursiveGaussianBlur(const SImage& _rSource, SImage& _rDestination, float _Sigma);
+
+    // -----------------------------------------------------------------------------
+    // Adds a blurred copy of all pixels brighter than the threshold to the image.
+    // Works on four channel images.
+    // -----------------------------------------------------------------------------
+    void Bloom(const SImage& _rSource, SImage& _rDestination, float _Threshold, float _Sigma, float _Intensity);
+
+    // -----------------------------------------------------------------------------
+    // Sobel edge detection. The destination has one channel, the source has one
+    // channel (e.g. depth) or four channels, in which case the luminance is used.
+    // -----------------------------------------------------------------------------
+    void DetectEdges(const SImage& _rSource, SImage& _rDestination);
+
+    // -----------------------------------------------------------------------------
+    // Reinhard tone mapping of the color channels of a four channel image. The
+    // alpha channel is kept.
+    // -----------------------------------------------------------------------------
+    void ToneMap(const SImage& _rSource, SImage& _rDestination, float _Exposure);
+
+    // -----------------------------------------------------------------------------
+    // Swaps rows and columns. Used internally for the horizontal blur passes.
+    // -----------------------------------------------------------------------------
+    void Transpose(const SImage& _rSource, SImage& _rDestination);
+} // namespace filter
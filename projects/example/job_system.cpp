@@ -0,0 +1,473 @@
+
+#include "job_system.h"
+
+#include <algorithm>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // The deque of Chase and Lev with a fixed capacity. Only the owner pushes and
+    // pops at the bottom, any thread steals at the top. The loads and stores of
+    // the two indices are sequentially consistent instead of relaxed with
+    // explicit fences, which costs a little on the owner side but is easier to
+    // check and works with the thread sanitizer.
+    // -----------------------------------------------------------------------------
+    class CWorkStealingDeque
+    {
+        public:
+
+            CWorkStealingDeque()
+                : m_Top   (0)
+                , m_Bottom(0)
+            {
+                for (std::atomic<SJob*>& rpJob : m_Jobs) rpJob.store(nullptr, std::memory_order_relaxed);
+            }
+
+        public:
+
+            bool Push(SJob* _pJob)
+            {
+                long long Bottom = m_Bottom.load(std::memory_order_relaxed);
+                long long Top    = m_Top   .load(std::memory_order_acquire);
+
+                if (Bottom - Top >= s_Capacity) return false;
+
+                m_Jobs[Bottom & (s_Capacity - 1)].store(_pJob, std::memory_order_relaxed);
+
+                m_Bottom.store(Bottom + 1);
+
+                return true;
+            }
+
+            SJob* Pop()
+            {
+                long long Bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+
+                m_Bottom.store(Bottom);
+
+                long long Top = m_Top.load();
+
+                if (Top > Bottom)
+                {
+                    m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+
+                    return nullptr;
+                }
+
+                SJob* pJob = m_Jobs[Bottom & (s_Capacity - 1)].load(std::memory_order_relaxed);
+
+                // -----------------------------------------------------------------------------
+                // The last job: the owner races with the thieves for it.
+                // -----------------------------------------------------------------------------
+                if (Top == Bottom)
+                {
+                    if (m_Top.compare_exchange_strong(Top, Top + 1) == false) pJob = nullptr;
+
+                    m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+                }
+
+                return pJob;
+            }
+
+            SJob* Steal()
+            {
+                long long Top    = m_Top   .load();
+                long long Bottom = m_Bottom.load();
+
+                if (Top >= Bottom) return nullptr;
+
+                SJob* pJob = m_Jobs[Top & (s_Capacity - 1)].load(std::memory_order_relaxed);
+
+                if (m_Top.compare_exchange_strong(Top, Top + 1) == false) return nullptr;
+
+                return pJob;
+            }
+
+            bool IsEmpty() const
+            {
+                return m_Top.load() >= m_Bottom.load();
+            }
+
+        private:
+
+            static const long long s_Capacity = 1024;                   // A power of two.
+
+        private:
+
+            alignas(64) std::atomic<long long> m_Top;                   // Next job to steal.
+            alignas(64) std::atomic<long long> m_Bottom;                // Next free place of the owner.
+            std::atomic<SJob*>                 m_Jobs[s_Capacity];
+    };
+
+    // -----------------------------------------------------------------------------
+
+    const size_t s_QueueCapacity = 1024;
+
+    // -----------------------------------------------------------------------------
+    // The worker of the current thread. It is kept untyped, because the worker
+    // type is private to the job system.
+    // -----------------------------------------------------------------------------
+    thread_local void* t_pCurrentWorker = nullptr;
+} // namespace
+
+struct CJobSystem::SWorker
+{
+    CWorkStealingDeque m_Deque;
+    CJobSystem*        m_pJobSystem;
+    int                m_IndexOfWorker;
+    unsigned int       m_RandomState;                                   // Picks the first victim to steal from.
+};
+
+// -----------------------------------------------------------------------------
+
+CJobSystem::CJobSystem(int _NumberOfWorkers)
+    : m_QueueHead              (0)
+    , m_QueueSize              (0)
+    , m_NumberOfSleepingWorkers(0)
+    , m_IsRunning              (true)
+    , m_NumberOfJobs           (0)
+    , m_NumberOfStolenJobs     (0)
+    , m_NumberOfInlineJobs     (0)
+{
+    if (_NumberOfWorkers < 0) _NumberOfWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+
+    m_Queue.resize(s_QueueCapacity, nullptr);
+
+    for (int IndexOfWorker = 0; IndexOfWorker < _NumberOfWorkers; ++ IndexOfWorker)
+    {
+        SWorker* pWorker = new SWorker();
+
+        pWorker->m_pJobSystem    = this;
+        pWorker->m_IndexOfWorker = IndexOfWorker;
+        pWorker->m_RandomState   = 4711u + IndexOfWorker * 7919u;
+
+        m_Workers.push_back(pWorker);
+    }
+
+    // -----------------------------------------------------------------------------
+    // All workers exist before the first thread starts stealing from them.
+    // -----------------------------------------------------------------------------
+    for (SWorker* pWorker : m_Workers)
+    {
+        m_Threads.emplace_back(&CJobSystem::RunWorker, this, pWorker);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+CJobSystem::~CJobSystem()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_SleepMutex);
+
+        m_IsRunning = false;
+    }
+
+    m_SleepCondition.notify_all();
+
+    for (std::thread& rThread : m_Threads) rThread.join();
+
+    for (SWorker* pWorker : m_Workers) delete pWorker;
+}
+
+// -----------------------------------------------------------------------------
+
+int CJobSystem::GetNumberOfWorkers() const
+{
+    return static_cast<int>(m_Workers.size());
+}
+
+// -----------------------------------------------------------------------------
+
+int CJobSystem::GetNumberOfThreads() const
+{
+    return GetNumberOfWorkers() + 1;
+}
+
+// -----------------------------------------------------------------------------
+
+void CJobSystem::Run(SJob* _pJob)
+{
+    // -----------------------------------------------------------------------------
+    // Count the job and, if it is the first one of its counter, the continuation
+    // of the counter, which is pending from now on.
+    // -----------------------------------------------------------------------------
+    for (SJob* pJob = _pJob; pJob != nullptr && pJob->m_pCounter != nullptr; )
+    {
+        CJobCounter* pCounter = pJob->m_pCounter;
+
+        if (pCounter->m_Count.fetch_add(1, std::memory_order_relaxed) != 0) break;
+
+        pJob = pCounter->m_pContinuation;
+    }
+
+    Schedule(_pJob);
+}
+
+// -----------------------------------------------------------------------------
+
+void CJobSystem::Run(SJob* _pJobs, int _NumberOfJobs)
+{
+    for (int IndexOfJob = 0; IndexOfJob < _NumberOfJobs; ++ IndexOfJob) Run(&_pJobs[IndexOfJob]);
+}
+
+// -----------------------------------------------------------------------------
+
+void CJobSystem::Wait(const CJobCounter& _rCounter)
+{
+    SWorker* pWorker = GetCurrentWorker();
+
+    while (_rCounter.IsDone() == false)
+    {
+        SJob* pJob = FindJob(pWorker);
+
+        if (pJob != nullptr)
+        {
+            Execute(pJob);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+SJobSystemStatistics CJobSystem::GetStatistics() const
+{
+    SJobSystemStatistics Statistics;
+
+    Statistics.m_NumberOfJobs       = m_NumberOfJobs      .load(std::memory_order_relaxed);
+    Statistics.m_NumberOfStolenJobs = m_NumberOfStolenJobs.load(std::memory_order_relaxed);
+    Statistics.m_NumberOfInlineJobs = m_NumberOfInlineJobs.load(std::memory_order_relaxed);
+
+    return Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+CJobSystem::SWorker* CJobSystem::GetCurrentWorker() const
+{
+    SWorker* pWorker = static_cast<SWorker*>(t_pCurrentWorker);
+
+    return pWorker != nullptr && pWorker->m_pJobSystem == this ? pWorker : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+SJob* CJobSystem::FindJob(SWorker* _pWorker)
+{
+    // -----------------------------------------------------------------------------
+    // The newest job of the own deque first, it is still in the cache. Then the
+    // queue of the other threads, then the oldest jobs of the other workers,
+    // which are the largest ones of a split range.
+    // -----------------------------------------------------------------------------
+    if (_pWorker != nullptr)
+    {
+        SJob* pJob = _pWorker->m_Deque.Pop();
+
+        if (pJob != nullptr) return pJob;
+    }
+
+    SJob* pJob = PopQueue();
+
+    if (pJob != nullptr) return pJob;
+
+    int NumberOfWorkers = GetNumberOfWorkers();
+
+    if (NumberOfWorkers == 0) return nullptr;
+
+    static thread_local unsigned int s_RandomState = 12345u;
+
+    unsigned int& rState = _pWorker != nullptr ? _pWorker->m_RandomState : s_RandomState;
+
+    rState = rState * 1664525u + 1013904223u;
+
+    int FirstVictim = static_cast<int>((rState >> 8) % static_cast<unsigned int>(NumberOfWorkers));
+
+    for (int Offset = 0; Offset < NumberOfWorkers; ++ Offset)
+    {
+        SWorker* pVictim = m_Workers[(FirstVictim + Offset) % NumberOfWorkers];
+
+        if (pVictim == _pWorker) continue;
+
+        pJob = pVictim->m_Deque.Steal();
+
+        if (pJob != nullptr)
+        {
+            m_NumberOfStolenJobs.fetch_add(1, std::memory_order_relaxed);
+
+            return pJob;
+        }
+    }
+
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void CJobSystem::Schedule(SJob* _pJob)
+{
+    // -----------------------------------------------------------------------------
+    // Workers push to their own deque, other threads to the shared queue. If it
+    // is full the job is executed right away, which is slower but correct.
+    // -----------------------------------------------------------------------------
+    SWorker* pWorker = GetCurrentWorker();
+
+    bool IsQueued = pWorker != nullptr ? pWorker->m_Deque.Push(_pJob) : PushQueue(_pJob);
+
+    if (IsQueued == false)
+    {
+        m_NumberOfInlineJobs.fetch_add(1, std::memory_order_relaxed);
+
+        Execute(_pJob);
+
+        return;
+    }
+
+    WakeWorkers();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CJobSystem::PushQueue(SJob* _pJob)
+{
+    std::lock_guard<std::mutex> Lock(m_QueueMutex);
+
+    size_t Size = m_QueueSize.load(std::memory_order_relaxed);
+
+    if (Size == m_Queue.size()) return false;
+
+    m_Queue[(m_QueueHead + Size) % m_Queue.size()] = _pJob;
+
+    m_QueueSize.store(Size + 1);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+SJob* CJobSystem::PopQueue()
+{
+    if (m_QueueSize.load() == 0) return nullptr;
+
+    std::lock_guard<std::mutex> Lock(m_QueueMutex);
+
+    size_t Size = m_QueueSize.load(std::memory_order_relaxed);
+
+    if (Size == 0) return nullptr;
+
+    SJob* pJob = m_Queue[m_QueueHead];
+
+    m_QueueHead = (m_QueueHead + 1) % m_Queue.size();
+
+    m_QueueSize.store(Size - 1);
+
+    return pJob;
+}
+
+// -----------------------------------------------------------------------------
+
+void CJobSystem::Execute(SJob* _pJob)
+{
+    CJobCounter* pCounter = _pJob->m_pCounter;
+
+    _pJob->m_pFunction(_pJob->m_pData);
+
+    m_NumberOfJobs.fetch_add(1, std::memory_order_relaxed);
+
+    if (pCounter == nullptr) return;
+
+    // -----------------------------------------------------------------------------
+    // The counter may be gone as soon as it is done, so the continuation is
+    // read before. It was counted when the counter got its first job.
+    // -----------------------------------------------------------------------------
+    SJob* pContinuation = pCounter->m_pContinuation;
+
+    if (pCounter->m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1 && pContinuation != nullptr) Schedule(pContinuation);
+}
+
+// -----------------------------------------------------------------------------
+
+void CJobSystem::WakeWorkers()
+{
+    // -----------------------------------------------------------------------------
+    // A worker counts itself as sleeping before it checks the queues for the
+    // last time, and the job was queued before this check, so either the worker
+    // sees the job or this thread sees the sleeping worker.
+    // -----------------------------------------------------------------------------
+    if (m_NumberOfSleepingWorkers.load() == 0) return;
+
+    {
+        std::lock_guard<std::mutex> Lock(m_SleepMutex);
+    }
+
+    m_SleepCondition.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+
+void CJobSystem::RunWorker(SWorker* _pWorker)
+{
+    t_pCurrentWorker = _pWorker;
+
+    int NumberOfIdleLoops = 0;
+
+    while (m_IsRunning)
+    {
+        SJob* pJob = FindJob(_pWorker);
+
+        if (pJob != nullptr)
+        {
+            Execute(pJob);
+
+            NumberOfIdleLoops = 0;
+
+            continue;
+        }
+
+        // -----------------------------------------------------------------------------
+        // Spin a little, jobs often come in bursts, then sleep until a job is run.
+        // -----------------------------------------------------------------------------
+        if (++ NumberOfIdleLoops < 64)
+        {
+            std::this_thread::yield();
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> Lock(m_SleepMutex);
+
+        m_NumberOfSleepingWorkers.fetch_add(1);
+
+        auto HasWork = [&]()
+        {
+            if (m_IsRunning == false || m_QueueSize.load() != 0) return true;
+
+            for (SWorker* pWorker : m_Workers)
+            {
+                if (pWorker->m_Deque.IsEmpty() == false) return true;
+            }
+
+            return false;
+        };
+
+        m_SleepCondition.wait(Lock, HasWork);
+
+        m_NumberOfSleepingWorkers.fetch_sub(1);
+
+        NumberOfIdleLoops = 0;
+    }
+
+    t_pCurrentWorker = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+CJobSystem& GetJobSystem()
+{
+    static CJobSystem s_JobSystem;
+
+    return s_JobSystem;
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CJobCounter;
+
+// -----------------------------------------------------------------------------
+// A job is a function with a pointer to its data. The caller owns the job and
+// its data and keeps both alive until the counter of the job says it is done,
+// so running jobs does not allocate.
+// -----------------------------------------------------------------------------
+typedef void (*FJob)(void* _pData);
+
+struct SJob
+{
+    FJob         m_pFunction;
+    void*        m_pData;
+    CJobCounter* m_pCounter;                                            // Counts the job until it is done, may be nullptr.
+};
+
+// -----------------------------------------------------------------------------
+// Counts the jobs which are not done yet. When the count drops to zero the
+// continuation is run, if there is one, so a job which depends on others is
+// started by the last of them instead of a thread waiting for them.
+// -----------------------------------------------------------------------------
+class CJobCounter
+{
+    public:
+
+        explicit CJobCounter(SJob* _pContinuation = nullptr)
+            : m_Count        (0)
+            , m_pContinuation(_pContinuation)
+        {
+        }
+
+        CJobCounter(const CJobCounter&) = delete;
+        CJobCounter& operator = (const CJobCounter&) = delete;
+
+    public:
+
+        bool IsDone() const
+        {
+            return m_Count.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+
+        friend class CJobSystem;
+
+        std::atomic<int> m_Count;
+        SJob*            m_pContinuation;
+};
+
+// -----------------------------------------------------------------------------
+
+struct SJobSystemStatistics
+{
+    unsigned long long m_NumberOfJobs;                                  // Jobs executed since the start.
+    unsigned long long m_NumberOfStolenJobs;                            // Jobs taken from the deque of another worker.
+    unsigned long long m_NumberOfInlineJobs;                            // Jobs executed by 'Run' itself because the queue was full.
+};
+
+// -----------------------------------------------------------------------------
+// Work stealing scheduler. Each worker thread owns a Chase-Lev deque: it pushes
+// and pops jobs at the bottom without locks, and idle workers steal the oldest
+// jobs from the top of other deques. Threads which are not workers, e.g. the
+// render thread, put their jobs into a shared queue and steal like workers.
+//
+// 'Wait' does not block: the waiting thread executes other jobs until the
+// counter is done. So jobs may start jobs and wait for them, which is how
+// 'ParallelFor' splits its range: each job pushes the upper half of its range
+// and continues with the lower half, and idle threads steal the large halves.
+// -----------------------------------------------------------------------------
+class CJobSystem
+{
+    public:
+
+        explicit CJobSystem(int _NumberOfWorkers = -1);                 // -1 starts one worker per core less the calling thread.
+        ~CJobSystem();
+
+        CJobSystem(const CJobSystem&) = delete;
+        CJobSystem& operator = (const CJobSystem&) = delete;
+
+    public:
+
+        int  GetNumberOfWorkers() const;
+        int  GetNumberOfThreads() const;                                // The workers and the calling thread.
+
+        void Run(SJob* _pJob);
+        void Run(SJob* _pJobs, int _NumberOfJobs);
+        void Wait(const CJobCounter& _rCounter);
+
+        SJobSystemStatistics GetStatistics() const;
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Calls the function for all indices in [0, count) and returns when all
+        // calls are done. Ranges of at most the batch size are not split further.
+        // -----------------------------------------------------------------------------
+        template<typename TFunction>
+        void ParallelFor(int _Count, int _BatchSize, const TFunction& _rFunction)
+        {
+            SRange<TFunction> Range = { this, &_rFunction, 0, _Count, _BatchSize > 0 ? _BatchSize : 1 };
+
+            RunRange<TFunction>(&Range);
+        }
+
+    private:
+
+        struct SWorker;
+
+        template<typename TFunction>
+        struct SRange
+        {
+            CJobSystem*      m_pJobSystem;
+            const TFunction* m_pFunction;
+            int              m_First;
+            int              m_Last;
+            int              m_BatchSize;
+        };
+
+    private:
+
+        template<typename TFunction>
+        static void RunRange(void* _pData)
+        {
+            const SRange<TFunction>& rRange = *static_cast<const SRange<TFunction>*>(_pData);
+
+            if (rRange.m_Last - rRange.m_First <= rRange.m_BatchSize)
+            {
+                for (int Index = rRange.m_First; Index < rRange.m_Last; ++ Index) (*rRange.m_pFunction)(Index);
+
+                return;
+            }
+
+            int Middle = rRange.m_First + (rRange.m_Last - rRange.m_First) / 2;
+
+            SRange<TFunction> Lower = { rRange.m_pJobSystem, rRange.m_pFunction, rRange.m_First, Middle, rRange.m_BatchSize };
+            SRange<TFunction> Upper = { rRange.m_pJobSystem, rRange.m_pFunction, Middle, rRange.m_Last, rRange.m_BatchSize };
+
+            CJobCounter Counter;
+
+            SJob Job = { &RunRange<TFunction>, &Upper, &Counter };
+
+            rRange.m_pJobSystem->Run(&Job);
+
+            RunRange<TFunction>(&Lower);
+
+            rRange.m_pJobSystem->Wait(Counter);
+        }
+
+    private:
+
+        std::vector<SWorker*>           m_Workers;
+        std::vector<std::thread>        m_Threads;
+
+        std::mutex                      m_QueueMutex;                   // Guards the queue of the threads which are not workers.
+        std::vector<SJob*>              m_Queue;                        // Ring buffer with a fixed capacity.
+        size_t                          m_QueueHead;
+        std::atomic<size_t>             m_QueueSize;
+
+        std::mutex                      m_SleepMutex;
+        std::condition_variable         m_SleepCondition;
+        std::atomic<int>                m_NumberOfSleepingWorkers;
+        std::atomic<bool>               m_IsRunning;
+
+        std::atomic<unsigned long long> m_NumberOfJobs;
+        std::atomic<unsigned long long> m_NumberOfStolenJobs;
+        std::atomic<unsigned long long> m_NumberOfInlineJobs;
+
+    private:
+
+        SWorker* GetCurrentWorker() const;
+        SJob*    FindJob(SWorker* _pWorker);
+        void     Schedule(SJob* _pJob);
+        bool     PushQueue(SJob* _pJob);
+        SJob*    PopQueue();
+        void     Execute(SJob* _pJob);
+        void     WakeWorkers();
+        void     RunWorker(SWorker* _pWorker);
+};
+
+// -----------------------------------------------------------------------------
+// The job system shared by the modules of the examples. It is started on the
+// first call with one worker per core less the calling thread.
+// -----------------------------------------------------------------------------
+CJobSystem& GetJobSystem();
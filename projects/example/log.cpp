@@ -0,0 +1,327 @@
+#include "log.h"
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace
+{
+    const size_t s_MaximumTextSize = 64 * 1024;                         // Written without a flush when the writer falls behind.
+} // namespace
+
+CLog::CLog(std::ostream& _rStream, int _Capacity)
+    : m_pRecords               (nullptr)
+    , m_Mask                   (0)
+    , m_Tail                   (0)
+    , m_Head                   (0)
+    , m_NumberOfFlushedSlots   (0)
+    , m_rStream                (_rStream)
+    , m_IsRunning              (true)
+    , m_NumberOfMessages       (0)
+    , m_NumberOfDroppedMessages(0)
+    , m_MaximumQueueSize       (0)
+{
+    size_t Capacity = 2;
+
+    while (Capacity < static_cast<size_t>(_Capacity)) Capacity *= 2;
+
+    m_pRecords = new SRecord[Capacity];
+    m_Mask     = Capacity - 1;
+
+    for (size_t IndexOfRecord = 0; IndexOfRecord < Capacity; ++ IndexOfRecord)
+    {
+        m_pRecords[IndexOfRecord].m_Sequence.store(IndexOfRecord, std::memory_order_relaxed);
+    }
+
+    m_Text.reserve(s_MaximumTextSize + 1024);
+
+    m_Thread = std::thread(&CLog::Run, this);
+}
+
+// -----------------------------------------------------------------------------
+
+CLog::~CLog()
+{
+    m_IsRunning.store(false);
+
+    m_WakeUp.notify_one();
+
+    m_Thread.join();
+
+    delete [] m_pRecords;
+}
+
+// -----------------------------------------------------------------------------
+
+void CLog::Flush()
+{
+    size_t Tail = m_Tail.load();
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    m_WakeUp.notify_one();
+
+    m_Flushed.wait(Lock, [&] { return m_NumberOfFlushedSlots.load() >= Tail; });
+}
+
+// -----------------------------------------------------------------------------
+
+void CLog::GetStatistics(SLogStatistics& _rStatistics) const
+{
+    _rStatistics.m_NumberOfMessages        = m_NumberOfMessages       .load(std::memory_order_relaxed);
+    _rStatistics.m_NumberOfDroppedMessages = m_NumberOfDroppedMessages.load(std::memory_order_relaxed);
+    _rStatistics.m_MaximumQueueSize        = m_MaximumQueueSize       .load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+void CLog::ResetStatistics()
+{
+    m_NumberOfMessages       .store(0, std::memory_order_relaxed);
+    m_NumberOfDroppedMessages.store(0, std::memory_order_relaxed);
+    m_MaximumQueueSize       .store(0, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+CLog::SRecord* CLog::Reserve()
+{
+    size_t Position = m_Tail.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        SRecord& rRecord = m_pRecords[Position & m_Mask];
+
+        size_t Sequence = rRecord.m_Sequence.load(std::memory_order_acquire);
+
+        intptr_t Difference = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position);
+
+        // -----------------------------------------------------------------------------
+        // The sequence equals the position if the slot is free for this round,
+        // it is smaller if the writer has not read the slot of the last round
+        // yet, i.e. the queue is full, and larger if another producer took the
+        // slot in between.
+        // -----------------------------------------------------------------------------
+        if (Difference == 0)
+        {
+            if (m_Tail.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+            {
+                int Size = static_cast<int>(Position + 1 - m_Head.load(std::memory_order_relaxed));
+
+                int MaximumSize = m_MaximumQueueSize.load(std::memory_order_relaxed);
+
+                while (Size > MaximumSize && !m_MaximumQueueSize.compare_exchange_weak(MaximumSize, Size, std::memory_order_relaxed))
+                {
+                }
+
+                return &rRecord;
+            }
+        }
+        else if (Difference < 0)
+        {
+            m_NumberOfDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+
+            return nullptr;
+        }
+        else
+        {
+            Position = m_Tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CLog::Commit(SRecord* _pRecord)
+{
+    size_t Sequence = _pRecord->m_Sequence.load(std::memory_order_relaxed);
+
+    _pRecord->m_Sequence.store(Sequence + 1, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+
+void CLog::Run()
+{
+    for (;;)
+    {
+        bool IsRunning = m_IsRunning.load();
+
+        if (WriteRecords()) continue;
+
+        if (!IsRunning) break;
+
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+
+        m_WakeUp.wait_for(Lock, std::chrono::milliseconds(1));
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CLog::WriteRecords()
+{
+    size_t Head = m_Head.load(std::memory_order_relaxed);
+
+    bool HasRecords = false;
+
+    for (;;)
+    {
+        SRecord& rRecord = m_pRecords[Head & m_Mask];
+
+        if (rRecord.m_Sequence.load(std::memory_order_acquire) != Head + 1) break;
+
+        Format(rRecord);
+
+        // -----------------------------------------------------------------------------
+        // The slot is free again for the next round of the producers.
+        // -----------------------------------------------------------------------------
+        rRecord.m_Sequence.store(Head + m_Mask + 1, std::memory_order_release);
+
+        Head += 1;
+
+        m_Head.store(Head, std::memory_order_relaxed);
+
+        m_NumberOfMessages.fetch_add(1, std::memory_order_relaxed);
+
+        HasRecords = true;
+
+        if (m_Text.size() >= s_MaximumTextSize) WriteText();
+    }
+
+    // -----------------------------------------------------------------------------
+    // The queue is empty, now the stream is flushed, once for all messages
+    // since the last flush.
+    // -----------------------------------------------------------------------------
+    if (!m_Text.empty())
+    {
+        WriteText();
+
+        m_rStream.flush();
+    }
+
+    if (m_NumberOfFlushedSlots.load(std::memory_order_relaxed) != Head)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+
+            m_NumberOfFlushedSlots.store(Head);
+        }
+
+        m_Flushed.notify_all();
+    }
+
+    return HasRecords;
+}
+
+// -----------------------------------------------------------------------------
+
+void CLog::Format(const SRecord& _rRecord)
+{
+    const char* pFormat = _rRecord.m_pFormat;
+
+    int IndexOfArgument = 0;
+
+    while (*pFormat != '\0')
+    {
+        if (pFormat[0] != '{' || pFormat[1] != '}' || IndexOfArgument >= _rRecord.m_NumberOfArguments)
+        {
+            m_Text += *pFormat;
+
+            pFormat += 1;
+
+            continue;
+        }
+
+        unsigned long long Bits = _rRecord.m_Arguments[IndexOfArgument];
+
+        char Buffer[32];
+
+        switch (_rRecord.m_Types[IndexOfArgument])
+        {
+            case SType::Bool:
+            {
+                m_Text += Bits != 0 ? "true" : "false";
+
+                break;
+            }
+
+            case SType::Char:
+            {
+                m_Text += static_cast<char>(Bits);
+
+                break;
+            }
+
+            case SType::Integer:
+            {
+                long long Value;
+
+                memcpy(&Value, &Bits, sizeof(Value));
+
+                snprintf(Buffer, sizeof(Buffer), "%lld", Value);
+
+                m_Text += Buffer;
+
+                break;
+            }
+
+            case SType::Unsigned:
+            {
+                snprintf(Buffer, sizeof(Buffer), "%llu", Bits);
+
+                m_Text += Buffer;
+
+                break;
+            }
+
+            case SType::Float:
+            {
+                double Value;
+
+                memcpy(&Value, &Bits, sizeof(Value));
+
+                snprintf(Buffer, sizeof(Buffer), "%g", Value);
+
+                m_Text += Buffer;
+
+                break;
+            }
+
+            case SType::String:
+            {
+                const char* pValue;
+
+                memcpy(&pValue, &Bits, sizeof(pValue));
+
+                m_Text += pValue != nullptr ? pValue : "(null)";
+
+                break;
+            }
+        }
+
+        IndexOfArgument += 1;
+
+        pFormat += 2;
+    }
+
+    m_Text += '\n';
+}
+
+// -----------------------------------------------------------------------------
+
+void CLog::WriteText()
+{
+    m_rStream.write(m_Text.data(), static_cast<std::streamsize>(m_Text.size()));
+
+    m_Text.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+CLog& GetLog()
+{
+    static CLog s_Log;
+
+    return s_Log;
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+struct SLogLevel
+{
+    enum ELevel
+    {
+        Debug,
+        Info,
+        Warning,
+        Error,
+        Off,                                                            // As minimum level it removes all messages of a category.
+    };
+};
+
+struct SLogCategory
+{
+    enum ECategory
+    {
+        Console,                                                        // The text printed at the start.
+        Camera,
+        Assets,                                                         // Loading and reloading of shaders, textures and meshes.
+        Statistics,                                                     // The statistics printed on key presses.
+        Benchmark,
+        NumberOfCategories,
+    };
+};
+
+// -----------------------------------------------------------------------------
+// The lowest level of each category which is compiled in. Messages below it
+// are removed by the compiler together with their arguments, so they cost
+// nothing, not even a test at run time. Debug messages only exist in debug
+// builds.
+// -----------------------------------------------------------------------------
+#ifdef NDEBUG
+constexpr int g_MinimumLogLevels[SLogCategory::NumberOfCategories] = { SLogLevel::Info , SLogLevel::Info , SLogLevel::Info , SLogLevel::Info , SLogLevel::Info  };
+#else
+constexpr int g_MinimumLogLevels[SLogCategory::NumberOfCategories] = { SLogLevel::Debug, SLogLevel::Debug, SLogLevel::Debug, SLogLevel::Debug, SLogLevel::Info  };
+#endif
+
+template<int TCategory, int TLevel>
+struct TLogFilter
+{
+    static const bool s_IsEnabled = TLevel >= g_MinimumLogLevels[TCategory];
+};
+
+// -----------------------------------------------------------------------------
+// Writes a message if its level passes the filter of its category. The filter
+// is a constant, so the compiler drops the whole statement for a disabled one.
+// The format uses '{}' for each argument, e.g.
+//
+//     LOG(Camera, Info, "The camera moves to {} at {} m/s", "the left", Speed);
+// -----------------------------------------------------------------------------
+#define LOG(_Category, _Level, ...)                                                                          \
+    do                                                                                                       \
+    {                                                                                                        \
+        if (TLogFilter<SLogCategory::_Category, SLogLevel::_Level>::s_IsEnabled) GetLog().Write(__VA_ARGS__); \
+    }                                                                                                        \
+    while (false)
+
+// -----------------------------------------------------------------------------
+
+struct SLogStatistics
+{
+    unsigned long long m_NumberOfMessages;                              // Messages written by the writer thread.
+    unsigned long long m_NumberOfDroppedMessages;                       // Messages lost because the queue was full.
+    int                m_MaximumQueueSize;                              // Most messages waiting at once.
+};
+
+// -----------------------------------------------------------------------------
+// Logging which does not block the calling thread. 'Write' only copies the
+// pointer to the format and the arguments into a slot of a ring buffer, the
+// formatting and the output happen on a writer thread, which flushes the
+// stream only when the queue runs empty. So a message costs the caller about
+// as much as a few stores, instead of the formatting and the system call of
+// 'std::endl'. The caller never waits for the writer, not even to wake it up:
+// an idle writer looks for new messages once per millisecond.
+//
+// The ring buffer is the bounded queue of Vyukov: each slot has a sequence
+// number which tells whether it may be written or read. Producers reserve a
+// slot by a compare and swap of the tail, so any number of threads may write
+// without a lock. There is only one consumer, the writer thread, which reads
+// the head without atomic operations. When the queue is full the message is
+// dropped and counted instead of waiting for the writer.
+//
+// The arguments are copied as they are, so they have to be trivially copyable
+// and at most 8 bytes: numbers, characters, booleans and strings as 'const
+// char*'. The strings are formatted later, they have to outlive the call, e.g.
+// string literals. The format has to be a literal for the same reason.
+// -----------------------------------------------------------------------------
+class CLog
+{
+    public:
+
+        static const int s_MaximumNumberOfArguments = 12;
+
+    public:
+
+        explicit CLog(std::ostream& _rStream = std::cout, int _Capacity = 4096);      // The capacity is rounded up to a power of two.
+        ~CLog();
+
+        CLog(const CLog&) = delete;
+        CLog& operator = (const CLog&) = delete;
+
+    public:
+
+        template<typename... TArguments>
+        void Write(const char* _pFormat, TArguments... _Arguments)
+        {
+            static_assert(sizeof...(TArguments) <= s_MaximumNumberOfArguments, "Too many arguments for one log message.");
+
+            SRecord* pRecord = Reserve();
+
+            if (pRecord == nullptr) return;
+
+            pRecord->m_pFormat           = _pFormat;
+            pRecord->m_NumberOfArguments = static_cast<unsigned char>(sizeof...(TArguments));
+
+            Store(pRecord, 0, _Arguments...);
+
+            Commit(pRecord);
+        }
+
+        // -----------------------------------------------------------------------------
+        // Waits until all messages written before are in the stream and the
+        // stream is flushed.
+        // -----------------------------------------------------------------------------
+        void Flush();
+
+        void GetStatistics(SLogStatistics& _rStatistics) const;
+        void ResetStatistics();
+
+    private:
+
+        struct SType
+        {
+            enum EType
+            {
+                Bool,
+                Char,
+                Integer,                                                // Any signed integer or enum, stored as 'long long'.
+                Unsigned,                                               // Any unsigned integer, stored as 'unsigned long long'.
+                Float,                                                  // 'float' and 'double', stored as 'double'.
+                String,
+            };
+        };
+
+        struct SRecord
+        {
+            std::atomic<size_t> m_Sequence;
+            const char*         m_pFormat;
+            unsigned char       m_NumberOfArguments;
+            unsigned char       m_Types[s_MaximumNumberOfArguments];
+            unsigned long long  m_Arguments[s_MaximumNumberOfArguments];
+        };
+
+    private:
+
+        SRecord*                        m_pRecords;
+        size_t                          m_Mask;                         // Capacity - 1.
+        std::atomic<size_t>             m_Tail;                         // Next slot a producer reserves.
+        std::atomic<size_t>             m_Head;                         // Next slot the writer reads, only changed by the writer.
+        std::atomic<size_t>             m_NumberOfFlushedSlots;         // Slots before it are in the stream and flushed.
+
+        std::ostream&                   m_rStream;
+        std::string                     m_Text;                         // Formatted messages not written to the stream yet.
+        std::thread                     m_Thread;
+        std::atomic<bool>               m_IsRunning;
+
+        std::mutex                      m_Mutex;                        // Only used to sleep and to wait for a flush.
+        std::condition_variable         m_WakeUp;
+        std::condition_variable         m_Flushed;
+
+        std::atomic<unsigned long long> m_NumberOfMessages;
+        std::atomic<unsigned long long> m_NumberOfDroppedMessages;
+        std::atomic<int>                m_MaximumQueueSize;
+
+    private:
+
+        SRecord* Reserve();
+        void     Commit(SRecord* _pRecord);
+
+        void Run();
+        bool WriteRecords();
+        void Format(const SRecord& _rRecord);
+        void WriteText();
+
+    private:
+
+        static void Store(SRecord*, int)
+        {
+        }
+
+        template<typename TArgument, typename... TArguments>
+        static void Store(SRecord* _pRecord, int _IndexOfArgument, TArgument _Argument, TArguments... _Arguments)
+        {
+            static_assert(std::is_trivially_copyable<TArgument>::value, "Log arguments are copied as they are, they have to be trivially copyable.");
+            static_assert(sizeof(TArgument) <= sizeof(unsigned long long), "Log arguments may have at most 8 bytes.");
+
+            unsigned long long Bits = 0;
+
+            typedef typename std::conditional<std::is_enum<TArgument>::value, long long, typename std::decay<TArgument>::type>::type TValue;
+
+            TValue Value = static_cast<TValue>(_Argument);
+
+            _pRecord->m_Types[_IndexOfArgument] = static_cast<unsigned char>(Convert(Value, Bits));
+
+            _pRecord->m_Arguments[_IndexOfArgument] = Bits;
+
+            Store(_pRecord, _IndexOfArgument + 1, _Arguments...);
+        }
+
+        // -----------------------------------------------------------------------------
+        // Widens the argument to one of the stored types and returns the type.
+        // -----------------------------------------------------------------------------
+        static int Convert(bool _Value, unsigned long long& _rBits)
+        {
+            _rBits = _Value ? 1 : 0;
+
+            return SType::Bool;
+        }
+
+        static int Convert(char _Value, unsigned long long& _rBits)
+        {
+            _rBits = static_cast<unsigned char>(_Value);
+
+            return SType::Char;
+        }
+
+        static int Convert(const char* _pValue, unsigned long long& _rBits)
+        {
+            memcpy(&_rBits, &_pValue, sizeof(_pValue));
+
+            return SType::String;
+        }
+
+        static int Convert(char* _pValue, unsigned long long& _rBits)
+        {
+            return Convert(static_cast<const char*>(_pValue), _rBits);
+        }
+
+        static int Convert(double _Value, unsigned long long& _rBits)
+        {
+            memcpy(&_rBits, &_Value, sizeof(_Value));
+
+            return SType::Float;
+        }
+
+        static int Convert(float _Value, unsigned long long& _rBits)
+        {
+            return Convert(static_cast<double>(_Value), _rBits);
+        }
+
+        template<typename TInteger>
+        static int Convert(TInteger _Value, unsigned long long& _rBits)
+        {
+            static_assert(std::is_integral<TInteger>::value, "Log arguments have to be numbers, characters, booleans or strings.");
+
+            if (std::is_signed<TInteger>::value)
+            {
+                long long Value = static_cast<long long>(_Value);
+
+                memcpy(&_rBits, &Value, sizeof(Value));
+
+                return SType::Integer;
+            }
+
+            _rBits = static_cast<unsigned long long>(_Value);
+
+            return SType::Unsigned;
+        }
+};
+
+// -----------------------------------------------------------------------------
+// The log of the program, writing to 'std::cout'. It is created on the first
+// use, all output to 'std::cout' should go through it from then on, otherwise
+// the order of the output is lost.
+// -----------------------------------------------------------------------------
+CLog& GetLog();
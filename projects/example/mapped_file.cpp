@@ -0,0 +1,133 @@
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CMappedFile::CMappedFile()
+    : m_pData   (nullptr)
+    , m_Size    (0)
+    , m_pFile   (nullptr)
+    , m_pMapping(nullptr)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CMappedFile::~CMappedFile()
+{
+    Close();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMappedFile::Open(const char* _pPath)
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE File = CreateFileA(_pPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (File == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER Size;
+
+    if (GetFileSizeEx(File, &Size) == FALSE || Size.QuadPart == 0)
+    {
+        CloseHandle(File);
+
+        return false;
+    }
+
+    HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (Mapping == nullptr)
+    {
+        CloseHandle(File);
+
+        return false;
+    }
+
+    m_pFile    = File;
+    m_pMapping = Mapping;
+    m_pData    = static_cast<const char*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+    m_Size     = static_cast<size_t>(Size.QuadPart);
+#else
+    int File = open(_pPath, O_RDONLY);
+
+    if (File < 0) return false;
+
+    struct stat Status;
+
+    if (fstat(File, &Status) != 0 || Status.st_size == 0)
+    {
+        close(File);
+
+        return false;
+    }
+
+    void* pData = mmap(nullptr, static_cast<size_t>(Status.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+
+    close(File);
+
+    if (pData == MAP_FAILED) return false;
+
+    m_pData = static_cast<const char*>(pData);
+    m_Size  = static_cast<size_t>(Status.st_size);
+#endif
+
+    if (m_pData == nullptr)
+    {
+        Close();
+
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMappedFile::Close()
+{
+#if defined(_WIN32)
+    if (m_pData    != nullptr) UnmapViewOfFile(m_pData);
+    if (m_pMapping != nullptr) CloseHandle(m_pMapping);
+    if (m_pFile    != nullptr) CloseHandle(m_pFile);
+#else
+    if (m_pData    != nullptr) munmap(const_cast<char*>(m_pData), m_Size);
+#endif
+
+    m_pData    = nullptr;
+    m_Size     = 0;
+    m_pFile    = nullptr;
+    m_pMapping = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMappedFile::IsOpen() const
+{
+    return m_pData != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+const char* CMappedFile::GetData() const
+{
+    return m_pData;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CMappedFile::GetSize() const
+{
+    return m_Size;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+// Read only mapping of a whole file. Nothing is read until the pages are
+// touched, so large files cost address space, but only the parts which are
+// used cost memory and time.
+// -----------------------------------------------------------------------------
+class CMappedFile
+{
+    public:
+
+        CMappedFile();
+        ~CMappedFile();
+
+    private:
+
+        CMappedFile(const CMappedFile&);
+        CMappedFile& operator = (const CMappedFile&);
+
+    public:
+
+        bool Open(const char* _pPath);                                  // False if the file does not exist or is empty.
+        void Close();
+
+        bool IsOpen() const;
+
+        const char* GetData() const;
+        size_t      GetSize() const;
+
+    private:
+
+        const char* m_pData;                                            // Start of the mapped file.
+        size_t      m_Size;                                             // Size of the mapped file in bytes.
+        void*       m_pFile;                                            // Handle of the opened file.
+        void*       m_pMapping;                                         // Handle of the file mapping.
+};
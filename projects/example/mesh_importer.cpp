@@ -0,0 +1,1613 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "mesh_importer.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace
+{
+    int s_NumberOfThreads = 0;
+
+    // -----------------------------------------------------------------------------
+    // Calls the function for all indices in [0, count) as jobs of the shared job
+    // system. The callers split their work into about one piece per thread, so
+    // each index is a job of its own.
+    // -----------------------------------------------------------------------------
+    template<typename TFunction>
+    void ParallelFor(int _Count, const TFunction& _rFunction)
+    {
+        int NumberOfThreads = std::min(GetNumberOfImportThreads(), _Count);
+
+        if (NumberOfThreads <= 1)
+        {
+            for (int Index = 0; Index < _Count; ++ Index) _rFunction(Index);
+
+            return;
+        }
+
+        GetJobSystem().ParallelFor(_Count, 1, _rFunction);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Splits [0, count) into one contiguous range per thread.
+    // -----------------------------------------------------------------------------
+    template<typename TFunction>
+    void ParallelForRange(int _Count, const TFunction& _rFunction)
+    {
+        int NumberOfRanges = std::max(std::min(GetNumberOfImportThreads(), _Count / 4096), 1);
+
+        ParallelFor(NumberOfRanges, [&](int _IndexOfRange)
+        {
+            int First = static_cast<int>(static_cast<long long>(_Count) *  _IndexOfRange      / NumberOfRanges);
+            int Last  = static_cast<int>(static_cast<long long>(_Count) * (_IndexOfRange + 1) / NumberOfRanges);
+
+            _rFunction(First, Last);
+        });
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool ReadFile(const char* _pPath, std::vector<char>& _rData)
+    {
+        FILE* pFile = fopen(_pPath, "rb");
+
+        if (pFile == nullptr) return false;
+
+        fseek(pFile, 0, SEEK_END);
+
+        long Size = ftell(pFile);
+
+        fseek(pFile, 0, SEEK_SET);
+
+        // -----------------------------------------------------------------------------
+        // The terminating zero lets the parsers run over the end of the last line.
+        // -----------------------------------------------------------------------------
+        _rData.resize(static_cast<size_t>(Size) + 1);
+
+        size_t NumberOfBytes = Size > 0 ? fread(_rData.data(), 1, static_cast<size_t>(Size), pFile) : 0;
+
+        fclose(pFile);
+
+        _rData[NumberOfBytes] = '\0';
+
+        _rData.resize(NumberOfBytes + 1);
+
+        return NumberOfBytes == static_cast<size_t>(Size);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    std::string GetDirectory(const char* _pPath)
+    {
+        std::string Path(_pPath);
+
+        size_t Slash = Path.find_last_of("/\\");
+
+        return Slash == std::string::npos ? std::string() : Path.substr(0, Slash + 1);
+    }
+} // namespace
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Small vector helpers for the normal and tangent calculation.
+    // -----------------------------------------------------------------------------
+    void Subtract(const float* _pA, const float* _pB, float* _pResult)
+    {
+        _pResult[0] = _pA[0] - _pB[0];
+        _pResult[1] = _pA[1] - _pB[1];
+        _pResult[2] = _pA[2] - _pB[2];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void Cross(const float* _pA, const float* _pB, float* _pResult)
+    {
+        _pResult[0] = _pA[1] * _pB[2] - _pA[2] * _pB[1];
+        _pResult[1] = _pA[2] * _pB[0] - _pA[0] * _pB[2];
+        _pResult[2] = _pA[0] * _pB[1] - _pA[1] * _pB[0];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float Dot(const float* _pA, const float* _pB)
+    {
+        return _pA[0] * _pB[0] + _pA[1] * _pB[1] + _pA[2] * _pB[2];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool Normalize(float* _pVector)
+    {
+        float Length = sqrtf(Dot(_pVector, _pVector));
+
+        if (Length <= 1.0e-20f) return false;
+
+        _pVector[0] /= Length;
+        _pVector[1] /= Length;
+        _pVector[2] /= Length;
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The angle between two edges leaving a corner.
+    // -----------------------------------------------------------------------------
+    float GetAngle(const float* _pCorner, const float* _pNext, const float* _pPrevious)
+    {
+        float First [3];
+        float Second[3];
+
+        Subtract(_pNext    , _pCorner, First);
+        Subtract(_pPrevious, _pCorner, Second);
+
+        if (Normalize(First) == false || Normalize(Second) == false) return 0.0f;
+
+        return acosf(std::max(-1.0f, std::min(1.0f, Dot(First, Second))));
+    }
+
+    // -----------------------------------------------------------------------------
+    // Builds any tangent perpendicular to the normal.
+    // -----------------------------------------------------------------------------
+    void GetAnyTangent(const float* _pNormal, float* _pTangent)
+    {
+        float Axis[3] = { 1.0f, 0.0f, 0.0f };
+
+        if (fabsf(_pNormal[0]) > 0.9f)
+        {
+            Axis[0] = 0.0f;
+            Axis[1] = 1.0f;
+        }
+
+        float Projection = Dot(Axis, _pNormal);
+
+        _pTangent[0] = Axis[0] - _pNormal[0] * Projection;
+        _pTangent[1] = Axis[1] - _pNormal[1] * Projection;
+        _pTangent[2] = Axis[2] - _pNormal[2] * Projection;
+
+        Normalize(_pTangent);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Angle weighted vertex normals for the vertices flagged as missing.
+    // -----------------------------------------------------------------------------
+    void CalculateNormals(const std::vector<float>& _rPositions, const std::vector<int>& _rIndices, const std::vector<char>& _rIsMissing, std::vector<float>& _rNormals)
+    {
+        std::vector<float> Sums(_rPositions.size(), 0.0f);
+
+        for (size_t IndexOfIndex = 0; IndexOfIndex + 2 < _rIndices.size(); IndexOfIndex += 3)
+        {
+            const int* pTriangle = &_rIndices[IndexOfIndex];
+
+            float Edge1 [3];
+            float Edge2 [3];
+            float Normal[3];
+
+            Subtract(&_rPositions[pTriangle[1] * 3], &_rPositions[pTriangle[0] * 3], Edge1);
+            Subtract(&_rPositions[pTriangle[2] * 3], &_rPositions[pTriangle[0] * 3], Edge2);
+            Cross   (Edge1, Edge2, Normal);
+
+            if (Normalize(Normal) == false) continue;
+
+            for (int Corner = 0; Corner < 3; ++ Corner)
+            {
+                int Vertex = pTriangle[Corner];
+
+                float Angle = GetAngle(&_rPositions[Vertex * 3], &_rPositions[pTriangle[(Corner + 1) % 3] * 3], &_rPositions[pTriangle[(Corner + 2) % 3] * 3]);
+
+                Sums[Vertex * 3 + 0] += Normal[0] * Angle;
+                Sums[Vertex * 3 + 1] += Normal[1] * Angle;
+                Sums[Vertex * 3 + 2] += Normal[2] * Angle;
+            }
+        }
+
+        for (size_t IndexOfVertex = 0; IndexOfVertex < _rIsMissing.size(); ++ IndexOfVertex)
+        {
+            if (_rIsMissing[IndexOfVertex] == 0) continue;
+
+            float* pNormal = &_rNormals[IndexOfVertex * 3];
+
+            pNormal[0] = Sums[IndexOfVertex * 3 + 0];
+            pNormal[1] = Sums[IndexOfVertex * 3 + 1];
+            pNormal[2] = Sums[IndexOfVertex * 3 + 2];
+
+            if (Normalize(pNormal) == false)
+            {
+                pNormal[0] = 0.0f;
+                pNormal[1] = 1.0f;
+                pNormal[2] = 0.0f;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Creates the interleaved vertices of the requested layout.
+    // -----------------------------------------------------------------------------
+    void BuildMesh(std::vector<float>& _rPositions, std::vector<float>& _rNormals, std::vector<float>& _rTexCoords, std::vector<int>& _rIndices, SVertexLayout::ELayout _Layout, SImportedMesh& _rMesh)
+    {
+        std::vector<float> Tangents;
+        std::vector<float> Binormals;
+
+        if (_Layout == SVertexLayout::NormalMapping)
+        {
+            CalculateTangents(_rPositions, _rNormals, _rTexCoords, _rIndices, Tangents, Binormals);
+        }
+
+        int NumberOfVertices = static_cast<int>(_rPositions.size() / 3);
+        int Stride           = _Layout == SVertexLayout::NormalMapping ? 14 : 8;
+
+        _rMesh.m_NumberOfFloatsPerVertex = Stride;
+        _rMesh.m_Vertices.resize(static_cast<size_t>(NumberOfVertices) * Stride);
+        _rMesh.m_Indices.swap(_rIndices);
+
+        ParallelForRange(NumberOfVertices, [&](int _First, int _Last)
+        {
+            for (int IndexOfVertex = _First; IndexOfVertex < _Last; ++ IndexOfVertex)
+            {
+                float* pVertex = &_rMesh.m_Vertices[static_cast<size_t>(IndexOfVertex) * Stride];
+
+                memcpy(pVertex, &_rPositions[IndexOfVertex * 3], 3 * sizeof(float));
+
+                if (_Layout == SVertexLayout::NormalMapping)
+                {
+                    memcpy(pVertex +  3, &Tangents  [IndexOfVertex * 3], 3 * sizeof(float));
+                    memcpy(pVertex +  6, &Binormals [IndexOfVertex * 3], 3 * sizeof(float));
+                    memcpy(pVertex +  9, &_rNormals [IndexOfVertex * 3], 3 * sizeof(float));
+                    memcpy(pVertex + 12, &_rTexCoords[IndexOfVertex * 2], 2 * sizeof(float));
+                }
+                else
+                {
+                    memcpy(pVertex + 3, &_rNormals  [IndexOfVertex * 3], 3 * sizeof(float));
+                    memcpy(pVertex + 6, &_rTexCoords[IndexOfVertex * 2], 2 * sizeof(float));
+                }
+            }
+        });
+    }
+} // namespace
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Number parsing without locale lookups, which makes up most of the time of
+    // reading an OBJ file.
+    // -----------------------------------------------------------------------------
+    const char* SkipSpaces(const char* _pText)
+    {
+        while (*_pText == ' ' || *_pText == '\t') ++ _pText;
+
+        return _pText;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    const char* SkipLine(const char* _pText, const char* _pEnd)
+    {
+        while (_pText < _pEnd && *_pText != '\n') ++ _pText;
+
+        return _pText < _pEnd ? _pText + 1 : _pEnd;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    const char* ParseFloat(const char* _pText, float& _rValue)
+    {
+        static const double s_Powers[] = { 1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17, 1.0e18 };
+
+        const char* pText = SkipSpaces(_pText);
+
+        bool IsNegative = *pText == '-';
+
+        if (*pText == '-' || *pText == '+') ++ pText;
+
+        const char*        pDigits          = pText;
+        unsigned long long Mantissa         = 0;
+        int                NumberOfDigits   = 0;
+        int                Exponent         = 0;
+
+        for (; *pText >= '0' && *pText <= '9'; ++ pText)
+        {
+            if (NumberOfDigits < 18) { Mantissa = Mantissa * 10 + (*pText - '0'); ++ NumberOfDigits; } else { ++ Exponent; }
+        }
+
+        if (*pText == '.')
+        {
+            for (++ pText; *pText >= '0' && *pText <= '9'; ++ pText)
+            {
+                if (NumberOfDigits < 18) { Mantissa = Mantissa * 10 + (*pText - '0'); ++ NumberOfDigits; -- Exponent; }
+            }
+        }
+
+        if (pText == pDigits || (pText == pDigits + 1 && *pDigits == '.'))
+        {
+            _rValue = 0.0f;
+
+            return _pText;
+        }
+
+        if (*pText == 'e' || *pText == 'E')
+        {
+            char* pEnd;
+
+            Exponent += static_cast<int>(strtol(pText + 1, &pEnd, 10));
+
+            pText = pEnd;
+        }
+
+        double Value = static_cast<double>(Mantissa);
+
+        if      (Exponent < 0 && Exponent >= -18) Value /= s_Powers[-Exponent];
+        else if (Exponent > 0 && Exponent <=  18) Value *= s_Powers[ Exponent];
+        else if (Exponent != 0)                   Value *= pow(10.0, Exponent);
+
+        _rValue = static_cast<float>(IsNegative ? -Value : Value);
+
+        return pText;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    const char* ParseInt(const char* _pText, int& _rValue)
+    {
+        const char* pText = _pText;
+
+        bool IsNegative = *pText == '-';
+
+        if (*pText == '-' || *pText == '+') ++ pText;
+
+        int Value = 0;
+
+        for (; *pText >= '0' && *pText <= '9'; ++ pText) Value = Value * 10 + (*pText - '0');
+
+        _rValue = IsNegative ? -Value : Value;
+
+        return pText;
+    }
+} // namespace
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // One face corner of an OBJ file. Relative (negative) indices can only be
+    // resolved after all chunks are parsed, so they are stored relative to the
+    // start of their chunk and flagged.
+    // -----------------------------------------------------------------------------
+    struct SObjCorner
+    {
+        int           m_Indices[3];                                     // Position, texture coordinate, and normal index, -1 if missing.
+        unsigned char m_RelativeMask;                                   // Bit n is set if index n is relative to the chunk.
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct SObjChunk
+    {
+        const char*             m_pBegin;
+        const char*             m_pEnd;
+        std::vector<float>      m_Positions;
+        std::vector<float>      m_TexCoords;
+        std::vector<float>      m_Normals;
+        std::vector<SObjCorner> m_Corners;                              // Three corners per triangle.
+        std::string             m_MaterialName;
+        bool                    m_IsValid;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    const char* ParseObjCorner(const char* _pText, const SObjChunk& _rChunk, SObjCorner& _rCorner)
+    {
+        int Counts[3] =
+        {
+            static_cast<int>(_rChunk.m_Positions.size() / 3),
+            static_cast<int>(_rChunk.m_TexCoords.size() / 2),
+            static_cast<int>(_rChunk.m_Normals  .size() / 3),
+        };
+
+        _rCorner.m_Indices[0]   = -1;
+        _rCorner.m_Indices[1]   = -1;
+        _rCorner.m_Indices[2]   = -1;
+        _rCorner.m_RelativeMask = 0;
+
+        const char* pText = _pText;
+
+        for (int Element = 0; Element < 3; ++ Element)
+        {
+            if (Element > 0)
+            {
+                if (*pText != '/') break;
+
+                ++ pText;
+            }
+
+            int Value = 0;
+
+            pText = ParseInt(pText, Value);
+
+            if (Value > 0)
+            {
+                _rCorner.m_Indices[Element] = Value - 1;
+            }
+            else if (Value < 0)
+            {
+                _rCorner.m_Indices[Element]  = Counts[Element] + Value;
+                _rCorner.m_RelativeMask     |= 1 << Element;
+            }
+        }
+
+        return pText;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ParseObjChunk(SObjChunk& _rChunk)
+    {
+        std::vector<SObjCorner> Polygon;
+
+        _rChunk.m_IsValid = true;
+
+        for (const char* pLine = _rChunk.m_pBegin; pLine < _rChunk.m_pEnd; pLine = SkipLine(pLine, _rChunk.m_pEnd))
+        {
+            const char* pText = SkipSpaces(pLine);
+
+            if (pText[0] == 'v' && (pText[1] == ' ' || pText[1] == '\t'))
+            {
+                float Position[3];
+
+                pText = ParseFloat(pText + 2, Position[0]);
+                pText = ParseFloat(pText    , Position[1]);
+                pText = ParseFloat(pText    , Position[2]);
+
+                _rChunk.m_Positions.insert(_rChunk.m_Positions.end(), Position, Position + 3);
+            }
+            else if (pText[0] == 'v' && pText[1] == 't')
+            {
+                float TexCoord[2];
+
+                pText = ParseFloat(pText + 2, TexCoord[0]);
+                pText = ParseFloat(pText    , TexCoord[1]);
+
+                _rChunk.m_TexCoords.insert(_rChunk.m_TexCoords.end(), TexCoord, TexCoord + 2);
+            }
+            else if (pText[0] == 'v' && pText[1] == 'n')
+            {
+                float Normal[3];
+
+                pText = ParseFloat(pText + 2, Normal[0]);
+                pText = ParseFloat(pText    , Normal[1]);
+                pText = ParseFloat(pText    , Normal[2]);
+
+                _rChunk.m_Normals.insert(_rChunk.m_Normals.end(), Normal, Normal + 3);
+            }
+            else if (pText[0] == 'f' && (pText[1] == ' ' || pText[1] == '\t'))
+            {
+                Polygon.clear();
+
+                for (pText = SkipSpaces(pText + 2); *pText != '\n' && *pText != '\r' && *pText != '\0' && pText < _rChunk.m_pEnd; pText = SkipSpaces(pText))
+                {
+                    SObjCorner Corner;
+
+                    const char* pNext = ParseObjCorner(pText, _rChunk, Corner);
+
+                    if (pNext == pText || (Corner.m_Indices[0] == -1 && (Corner.m_RelativeMask & 1) == 0))
+                    {
+                        _rChunk.m_IsValid = false;
+
+                        return;
+                    }
+
+                    Polygon.push_back(Corner);
+
+                    pText = pNext;
+                }
+
+                // -----------------------------------------------------------------------------
+                // Triangulate the polygon as fan around its first corner.
+                // -----------------------------------------------------------------------------
+                for (size_t IndexOfCorner = 2; IndexOfCorner < Polygon.size(); ++ IndexOfCorner)
+                {
+                    _rChunk.m_Corners.push_back(Polygon[0]);
+                    _rChunk.m_Corners.push_back(Polygon[IndexOfCorner - 1]);
+                    _rChunk.m_Corners.push_back(Polygon[IndexOfCorner]);
+                }
+            }
+            else if (strncmp(pText, "usemtl", 6) == 0 && _rChunk.m_MaterialName.empty())
+            {
+                const char* pName = SkipSpaces(pText + 6);
+                const char* pLast = pName;
+
+                while (pLast < _rChunk.m_pEnd && *pLast != '\r' && *pLast != '\n' && *pLast != '\0') ++ pLast;
+
+                _rChunk.m_MaterialName.assign(pName, pLast);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Open addressing hash map from a corner (position, texture coordinate, and
+    // normal index) to the index of its vertex.
+    // -----------------------------------------------------------------------------
+    class CVertexMap
+    {
+        public:
+
+            explicit CVertexMap(size_t _ExpectedNumberOfVertices)
+                : m_Mask(0)
+                , m_NumberOfKeys(0)
+            {
+                Rehash(_ExpectedNumberOfVertices * 2);
+            }
+
+        public:
+
+            // -----------------------------------------------------------------------------
+            // Returns the index of the vertex and true if the corner was inserted.
+            // -----------------------------------------------------------------------------
+            bool Insert(const int* _pKey, int& _rIndex)
+            {
+                if ((m_NumberOfKeys + 1) * 2 > m_Slots.size()) Rehash(m_Slots.size() * 2);
+
+                for (size_t Slot = GetHash(_pKey) & m_Mask; ; Slot = (Slot + 1) & m_Mask)
+                {
+                    int Index = m_Slots[Slot];
+
+                    if (Index < 0)
+                    {
+                        _rIndex       = static_cast<int>(m_NumberOfKeys ++);
+                        m_Slots[Slot] = _rIndex;
+
+                        m_Keys.insert(m_Keys.end(), _pKey, _pKey + 3);
+
+                        return true;
+                    }
+
+                    const int* pKey = &m_Keys[static_cast<size_t>(Index) * 3];
+
+                    if (pKey[0] == _pKey[0] && pKey[1] == _pKey[1] && pKey[2] == _pKey[2])
+                    {
+                        _rIndex = Index;
+
+                        return false;
+                    }
+                }
+            }
+
+            const std::vector<int>& GetKeys() const
+            {
+                return m_Keys;
+            }
+
+        private:
+
+            static size_t GetHash(const int* _pKey)
+            {
+                unsigned long long Hash = static_cast<unsigned int>(_pKey[0]) * 0x9E3779B97F4A7C15ull;
+
+                Hash ^= static_cast<unsigned int>(_pKey[1]) * 0xC2B2AE3D27D4EB4Full + (Hash >> 29);
+                Hash ^= static_cast<unsigned int>(_pKey[2]) * 0x165667B19E3779F9ull + (Hash >> 32);
+
+                return static_cast<size_t>(Hash ^ (Hash >> 31));
+            }
+
+            void Rehash(size_t _MinimumNumberOfSlots)
+            {
+                size_t NumberOfSlots = 16;
+
+                while (NumberOfSlots < _MinimumNumberOfSlots) NumberOfSlots *= 2;
+
+                m_Slots.assign(NumberOfSlots, -1);
+
+                m_Mask = NumberOfSlots - 1;
+
+                for (size_t Index = 0; Index < m_NumberOfKeys; ++ Index)
+                {
+                    size_t Slot = GetHash(&m_Keys[Index * 3]) & m_Mask;
+
+                    while (m_Slots[Slot] >= 0) Slot = (Slot + 1) & m_Mask;
+
+                    m_Slots[Slot] = static_cast<int>(Index);
+                }
+            }
+
+        private:
+
+            std::vector<int> m_Slots;                                   // Index of the vertex or -1 for empty slots.
+            std::vector<int> m_Keys;                                    // Three indices per vertex.
+            size_t           m_Mask;                                    // Number of slots minus one.
+            size_t           m_NumberOfKeys;
+    };
+} // namespace
+
+void SetNumberOfImportThreads(int _NumberOfThreads)
+{
+    s_NumberOfThreads = _NumberOfThreads;
+}
+
+// -----------------------------------------------------------------------------
+
+int GetNumberOfImportThreads()
+{
+    if (s_NumberOfThreads > 0) return s_NumberOfThreads;
+
+    return std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+}
+
+// -----------------------------------------------------------------------------
+
+bool ImportObj(const char* _pPath, SImportedMesh& _rMesh, SVertexLayout::ELayout _Layout)
+{
+    std::vector<char> Text;
+
+    if (ReadFile(_pPath, Text) == false) return false;
+
+    _rMesh.m_Vertices.clear();
+    _rMesh.m_Indices .clear();
+    _rMesh.m_MaterialName.clear();
+    _rMesh.m_NumberOfBytes = static_cast<long long>(Text.size() - 1);
+
+    // -----------------------------------------------------------------------------
+    // Split the text at line boundaries and parse the chunks in parallel.
+    // -----------------------------------------------------------------------------
+    const char* pBegin = Text.data();
+    const char* pEnd   = Text.data() + Text.size() - 1;
+
+    int NumberOfChunks = std::max(std::min(GetNumberOfImportThreads(), static_cast<int>((pEnd - pBegin) / (64 * 1024))), 1);
+
+    std::vector<SObjChunk> Chunks(NumberOfChunks);
+
+    for (int IndexOfChunk = 0; IndexOfChunk < NumberOfChunks; ++ IndexOfChunk)
+    {
+        const char* pSplit = pBegin + (pEnd - pBegin) * (IndexOfChunk + 1) / NumberOfChunks;
+
+        Chunks[IndexOfChunk].m_pBegin = IndexOfChunk == 0 ? pBegin : Chunks[IndexOfChunk - 1].m_pEnd;
+        Chunks[IndexOfChunk].m_pEnd   = IndexOfChunk + 1 == NumberOfChunks ? pEnd : SkipLine(std::max(pSplit, Chunks[IndexOfChunk].m_pBegin), pEnd);
+    }
+
+    ParallelFor(NumberOfChunks, [&](int _IndexOfChunk)
+    {
+        ParseObjChunk(Chunks[_IndexOfChunk]);
+    });
+
+    // -----------------------------------------------------------------------------
+    // Concatenate the attributes and resolve the relative indices.
+    // -----------------------------------------------------------------------------
+    std::vector<int> Offsets(NumberOfChunks * 3);
+
+    int Counts[3] = { 0, 0, 0 };
+
+    size_t NumberOfCorners = 0;
+
+    for (int IndexOfChunk = 0; IndexOfChunk < NumberOfChunks; ++ IndexOfChunk)
+    {
+        const SObjChunk& rChunk = Chunks[IndexOfChunk];
+
+        if (rChunk.m_IsValid == false) return false;
+
+        Offsets[IndexOfChunk * 3 + 0] = Counts[0]; Counts[0] += static_cast<int>(rChunk.m_Positions.size() / 3);
+        Offsets[IndexOfChunk * 3 + 1] = Counts[1]; Counts[1] += static_cast<int>(rChunk.m_TexCoords.size() / 2);
+        Offsets[IndexOfChunk * 3 + 2] = Counts[2]; Counts[2] += static_cast<int>(rChunk.m_Normals  .size() / 3);
+
+        NumberOfCorners += rChunk.m_Corners.size();
+
+        if (_rMesh.m_MaterialName.empty()) _rMesh.m_MaterialName = rChunk.m_MaterialName;
+    }
+
+    std::vector<float> Positions(static_cast<size_t>(Counts[0]) * 3);
+    std::vector<float> TexCoords(static_cast<size_t>(Counts[1]) * 2);
+    std::vector<float> Normals  (static_cast<size_t>(Counts[2]) * 3);
+
+    // -----------------------------------------------------------------------------
+    // Several jobs may find an invalid index at the same time.
+    // -----------------------------------------------------------------------------
+    std::atomic<bool> IsValid(true);
+
+    ParallelFor(NumberOfChunks, [&](int _IndexOfChunk)
+    {
+        SObjChunk& rChunk = Chunks[_IndexOfChunk];
+
+        std::copy(rChunk.m_Positions.begin(), rChunk.m_Positions.end(), Positions.begin() + Offsets[_IndexOfChunk * 3 + 0] * 3);
+        std::copy(rChunk.m_TexCoords.begin(), rChunk.m_TexCoords.end(), TexCoords.begin() + Offsets[_IndexOfChunk * 3 + 1] * 2);
+        std::copy(rChunk.m_Normals  .begin(), rChunk.m_Normals  .end(), Normals  .begin() + Offsets[_IndexOfChunk * 3 + 2] * 3);
+
+        for (SObjCorner& rCorner : rChunk.m_Corners)
+        {
+            for (int Element = 0; Element < 3; ++ Element)
+            {
+                if ((rCorner.m_RelativeMask & (1 << Element)) != 0) rCorner.m_Indices[Element] += Offsets[_IndexOfChunk * 3 + Element];
+
+                if (rCorner.m_Indices[Element] >= Counts[Element] || (rCorner.m_Indices[Element] < 0 && (Element == 0 || (rCorner.m_RelativeMask & (1 << Element)) != 0)))
+                {
+                    IsValid.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+    });
+
+    if (IsValid.load() == false) return false;
+
+    // -----------------------------------------------------------------------------
+    // Deduplicate the corners. The vertices keep the order of their first use.
+    // -----------------------------------------------------------------------------
+    CVertexMap VertexMap(static_cast<size_t>(Counts[0]));
+
+    std::vector<int> Indices;
+
+    Indices.reserve(NumberOfCorners);
+
+    for (const SObjChunk& rChunk : Chunks)
+    {
+        for (const SObjCorner& rCorner : rChunk.m_Corners)
+        {
+            int Index;
+
+            VertexMap.Insert(rCorner.m_Indices, Index);
+
+            Indices.push_back(Index);
+        }
+    }
+
+    Chunks.clear();
+
+    const std::vector<int>& rKeys = VertexMap.GetKeys();
+
+    int NumberOfVertices = static_cast<int>(rKeys.size() / 3);
+
+    std::vector<float> VertexPositions(static_cast<size_t>(NumberOfVertices) * 3);
+    std::vector<float> VertexNormals  (static_cast<size_t>(NumberOfVertices) * 3);
+    std::vector<float> VertexTexCoords(static_cast<size_t>(NumberOfVertices) * 2);
+    std::vector<char>  IsNormalMissing(static_cast<size_t>(NumberOfVertices));
+
+    std::atomic<bool> HasMissingNormals(false);
+
+    ParallelForRange(NumberOfVertices, [&](int _First, int _Last)
+    {
+        bool IsMissing = false;
+
+        for (int IndexOfVertex = _First; IndexOfVertex < _Last; ++ IndexOfVertex)
+        {
+            const int* pKey = &rKeys[IndexOfVertex * 3];
+
+            memcpy(&VertexPositions[IndexOfVertex * 3], &Positions[pKey[0] * 3], 3 * sizeof(float));
+
+            // -----------------------------------------------------------------------------
+            // OBJ texture coordinates start at the bottom, Direct3D ones at the top.
+            // -----------------------------------------------------------------------------
+            VertexTexCoords[IndexOfVertex * 2 + 0] = pKey[1] >= 0 ?        TexCoords[pKey[1] * 2 + 0] : 0.0f;
+            VertexTexCoords[IndexOfVertex * 2 + 1] = pKey[1] >= 0 ? 1.0f - TexCoords[pKey[1] * 2 + 1] : 0.0f;
+
+            if (pKey[2] >= 0)
+            {
+                memcpy(&VertexNormals[IndexOfVertex * 3], &Normals[pKey[2] * 3], 3 * sizeof(float));
+            }
+            else
+            {
+                IsNormalMissing[IndexOfVertex] = 1;
+
+                IsMissing = true;
+            }
+        }
+
+        if (IsMissing) HasMissingNormals.store(true, std::memory_order_relaxed);
+    });
+
+    if (HasMissingNormals.load())
+    {
+        CalculateNormals(VertexPositions, Indices, IsNormalMissing, VertexNormals);
+    }
+
+    BuildMesh(VertexPositions, VertexNormals, VertexTexCoords, Indices, _Layout, _rMesh);
+
+    return true;
+}
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // A minimal JSON document model, just enough for the glTF structure.
+    // -----------------------------------------------------------------------------
+    struct SJsonValue
+    {
+        enum EType
+        {
+            Null,
+            Boolean,
+            Number,
+            String,
+            Array,
+            Object,
+        };
+
+        EType                    m_Type;
+        double                   m_Number;
+        std::string              m_String;
+        std::vector<SJsonValue>  m_Elements;                            // Elements of an array or values of an object.
+        std::vector<std::string> m_Keys;                                // Keys of an object.
+
+        SJsonValue()
+            : m_Type  (Null)
+            , m_Number(0.0)
+        {
+        }
+
+        const SJsonValue* Find(const char* _pKey) const
+        {
+            for (size_t IndexOfKey = 0; IndexOfKey < m_Keys.size(); ++ IndexOfKey)
+            {
+                if (m_Keys[IndexOfKey] == _pKey) return &m_Elements[IndexOfKey];
+            }
+
+            return nullptr;
+        }
+
+        double GetNumber(const char* _pKey, double _Default) const
+        {
+            const SJsonValue* pValue = Find(_pKey);
+
+            return pValue != nullptr && pValue->m_Type == Number ? pValue->m_Number : _Default;
+        }
+
+        const SJsonValue* GetElement(const char* _pArray, int _Index) const
+        {
+            const SJsonValue* pArray = Find(_pArray);
+
+            if (pArray == nullptr || pArray->m_Type != Array || _Index < 0 || _Index >= static_cast<int>(pArray->m_Elements.size())) return nullptr;
+
+            return &pArray->m_Elements[_Index];
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+
+    class CJsonParser
+    {
+        public:
+
+            CJsonParser(const char* _pBegin, const char* _pEnd)
+                : m_pText(_pBegin)
+                , m_pEnd (_pEnd)
+            {
+            }
+
+        public:
+
+            bool Parse(SJsonValue& _rValue)
+            {
+                SkipWhitespace();
+
+                if (m_pText >= m_pEnd) return false;
+
+                switch (*m_pText)
+                {
+                    case '{': return ParseObject(_rValue);
+                    case '[': return ParseArray(_rValue);
+                    case '"': _rValue.m_Type = SJsonValue::String; return ParseString(_rValue.m_String);
+                    case 't': _rValue.m_Type = SJsonValue::Boolean; _rValue.m_Number = 1.0; return ParseWord("true");
+                    case 'f': _rValue.m_Type = SJsonValue::Boolean; _rValue.m_Number = 0.0; return ParseWord("false");
+                    case 'n': _rValue.m_Type = SJsonValue::Null; return ParseWord("null");
+                    default:
+                    {
+                        char* pEnd;
+
+                        _rValue.m_Type   = SJsonValue::Number;
+                        _rValue.m_Number = strtod(m_pText, &pEnd);
+
+                        if (pEnd == m_pText) return false;
+
+                        m_pText = pEnd;
+
+                        return true;
+                    }
+                }
+            }
+
+        private:
+
+            void SkipWhitespace()
+            {
+                while (m_pText < m_pEnd && (*m_pText == ' ' || *m_pText == '\t' || *m_pText == '\r' || *m_pText == '\n')) ++ m_pText;
+            }
+
+            bool Expect(char _Character)
+            {
+                SkipWhitespace();
+
+                if (m_pText >= m_pEnd || *m_pText != _Character) return false;
+
+                ++ m_pText;
+
+                return true;
+            }
+
+            bool ParseWord(const char* _pWord)
+            {
+                size_t Length = strlen(_pWord);
+
+                if (static_cast<size_t>(m_pEnd - m_pText) < Length || strncmp(m_pText, _pWord, Length) != 0) return false;
+
+                m_pText += Length;
+
+                return true;
+            }
+
+            bool ParseString(std::string& _rString)
+            {
+                if (Expect('"') == false) return false;
+
+                _rString.clear();
+
+                while (m_pText < m_pEnd && *m_pText != '"')
+                {
+                    if (*m_pText == '\\' && m_pText + 1 < m_pEnd)
+                    {
+                        ++ m_pText;
+
+                        switch (*m_pText)
+                        {
+                            case 'n': _rString += '\n'; break;
+                            case 't': _rString += '\t'; break;
+                            case 'r': _rString += '\r'; break;
+                            case 'b': _rString += '\b'; break;
+                            case 'f': _rString += '\f'; break;
+                            case 'u': _rString += '?'; m_pText += std::min<size_t>(4, static_cast<size_t>(m_pEnd - m_pText - 1)); break;
+                            default:  _rString += *m_pText; break;
+                        }
+                    }
+                    else
+                    {
+                        _rString += *m_pText;
+                    }
+
+                    ++ m_pText;
+                }
+
+                return Expect('"');
+            }
+
+            bool ParseArray(SJsonValue& _rValue)
+            {
+                _rValue.m_Type = SJsonValue::Array;
+
+                if (Expect('[') == false) return false;
+
+                if (Expect(']')) return true;
+
+                do
+                {
+                    _rValue.m_Elements.push_back(SJsonValue());
+
+                    if (Parse(_rValue.m_Elements.back()) == false) return false;
+                }
+                while (Expect(','));
+
+                return Expect(']');
+            }
+
+            bool ParseObject(SJsonValue& _rValue)
+            {
+                _rValue.m_Type = SJsonValue::Object;
+
+                if (Expect('{') == false) return false;
+
+                if (Expect('}')) return true;
+
+                do
+                {
+                    _rValue.m_Keys    .push_back(std::string());
+                    _rValue.m_Elements.push_back(SJsonValue());
+
+                    SkipWhitespace();
+
+                    if (ParseString(_rValue.m_Keys.back()) == false || Expect(':') == false || Parse(_rValue.m_Elements.back()) == false) return false;
+                }
+                while (Expect(','));
+
+                return Expect('}');
+            }
+
+        private:
+
+            const char* m_pText;
+            const char* m_pEnd;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    bool DecodeBase64(const char* _pText, size_t _Length, std::vector<char>& _rData)
+    {
+        static const char* s_pAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        unsigned int Bits          = 0;
+        int          NumberOfBits  = 0;
+
+        _rData.clear();
+        _rData.reserve(_Length * 3 / 4);
+
+        for (size_t IndexOfCharacter = 0; IndexOfCharacter < _Length && _pText[IndexOfCharacter] != '='; ++ IndexOfCharacter)
+        {
+            const char* pFound = strchr(s_pAlphabet, _pText[IndexOfCharacter]);
+
+            if (pFound == nullptr || *pFound == '\0') return false;
+
+            Bits          = (Bits << 6) | static_cast<unsigned int>(pFound - s_pAlphabet);
+            NumberOfBits += 6;
+
+            if (NumberOfBits >= 8)
+            {
+                NumberOfBits -= 8;
+
+                _rData.push_back(static_cast<char>((Bits >> NumberOfBits) & 0xFF));
+            }
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Reads a count, byte offset, or byte stride of an accessor or buffer view.
+    // The file is not trusted: a value which is not a whole number, negative, or
+    // above the maximum fails, so it can be cast and multiplied in 64 bits
+    // without wrapping. glTF limits offsets to 32 bits and strides to 252 bytes.
+    // -----------------------------------------------------------------------------
+    const double s_MaximumCount      = 2147483647.0;
+    const double s_MaximumByteOffset = 4294967295.0;
+    const double s_MaximumByteStride = 252.0;
+
+    bool GetUnsigned(const SJsonValue& _rValue, const char* _pKey, double _Maximum, unsigned long long& _rResult)
+    {
+        double Value = _rValue.GetNumber(_pKey, 0.0);
+
+        if (!(Value >= 0.0 && Value <= _Maximum) || floor(Value) != Value) return false;
+
+        _rResult = static_cast<unsigned long long>(Value);
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Reads an accessor as floats. Normalized integer components are mapped to
+    // 0 to 1 like the glTF specification demands.
+    // -----------------------------------------------------------------------------
+    bool ReadAccessor(const SJsonValue& _rDocument, const std::vector<std::vector<char> >& _rBuffers, int _IndexOfAccessor, int _NumberOfComponents, std::vector<float>& _rValues)
+    {
+        const SJsonValue* pAccessor = _rDocument.GetElement("accessors", _IndexOfAccessor);
+
+        if (pAccessor == nullptr) return false;
+
+        const SJsonValue* pView = _rDocument.GetElement("bufferViews", static_cast<int>(pAccessor->GetNumber("bufferView", -1.0)));
+
+        if (pView == nullptr) return false;
+
+        int  BufferIndex   = static_cast<int>(pView->GetNumber("buffer", -1.0));
+        int  ComponentType = static_cast<int>(pAccessor->GetNumber("componentType", 0.0));
+        bool IsNormalized  = pAccessor->Find("normalized") != nullptr && pAccessor->Find("normalized")->m_Number != 0.0;
+
+        unsigned long long Count;
+        unsigned long long ViewOffset;
+        unsigned long long AccessorOffset;
+        unsigned long long Stride;
+
+        if (GetUnsigned(*pAccessor, "count"     , s_MaximumCount     , Count         ) == false) return false;
+        if (GetUnsigned(*pView    , "byteOffset", s_MaximumByteOffset, ViewOffset    ) == false) return false;
+        if (GetUnsigned(*pAccessor, "byteOffset", s_MaximumByteOffset, AccessorOffset) == false) return false;
+        if (GetUnsigned(*pView    , "byteStride", s_MaximumByteStride, Stride        ) == false) return false;
+
+        int ComponentSize;
+
+        switch (ComponentType)
+        {
+            case 5120: case 5121: ComponentSize = 1; break;
+            case 5122: case 5123: ComponentSize = 2; break;
+            case 5125: case 5126: ComponentSize = 4; break;
+            default: return false;
+        }
+
+        unsigned long long Offset      = ViewOffset + AccessorOffset;
+        unsigned long long ElementSize = static_cast<unsigned long long>(ComponentSize) * _NumberOfComponents;
+
+        // Elements may not overlap, so the buffer bounds the count as well
+        if (Stride == 0) Stride = ElementSize;
+
+        if (Stride < ElementSize) return false;
+
+        if (BufferIndex < 0 || BufferIndex >= static_cast<int>(_rBuffers.size())) return false;
+
+        const std::vector<char>& rBuffer = _rBuffers[BufferIndex];
+
+        if (Count > 0 && Offset + Stride * (Count - 1) + ElementSize > rBuffer.size()) return false;
+
+        _rValues.resize(static_cast<size_t>(Count) * _NumberOfComponents);
+
+        for (int IndexOfElement = 0; IndexOfElement < static_cast<int>(Count); ++ IndexOfElement)
+        {
+            const char* pElement = &rBuffer[static_cast<size_t>(Offset + Stride * IndexOfElement)];
+
+            for (int Component = 0; Component < _NumberOfComponents; ++ Component)
+            {
+                const char* pValue = pElement + Component * ComponentSize;
+
+                float Value;
+
+                switch (ComponentType)
+                {
+                    case 5120: { signed char    Raw; memcpy(&Raw, pValue, 1); Value = IsNormalized ? std::max(Raw / 127.0f  , -1.0f) : Raw; break; }
+                    case 5121: { unsigned char  Raw; memcpy(&Raw, pValue, 1); Value = IsNormalized ? Raw / 255.0f                     : Raw; break; }
+                    case 5122: { short          Raw; memcpy(&Raw, pValue, 2); Value = IsNormalized ? std::max(Raw / 32767.0f, -1.0f) : Raw; break; }
+                    case 5123: { unsigned short Raw; memcpy(&Raw, pValue, 2); Value = IsNormalized ? Raw / 65535.0f                   : Raw; break; }
+                    case 5125: { unsigned int   Raw; memcpy(&Raw, pValue, 4); Value = static_cast<float>(Raw);                               break; }
+                    default:   { memcpy(&Value, pValue, 4);                                                                                    break; }
+                }
+
+                _rValues[static_cast<size_t>(IndexOfElement) * _NumberOfComponents + Component] = Value;
+            }
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool ReadIndices(const SJsonValue& _rDocument, const std::vector<std::vector<char> >& _rBuffers, int _IndexOfAccessor, std::vector<int>& _rIndices)
+    {
+        const SJsonValue* pAccessor = _rDocument.GetElement("accessors", _IndexOfAccessor);
+
+        if (pAccessor == nullptr) return false;
+
+        const SJsonValue* pView = _rDocument.GetElement("bufferViews", static_cast<int>(pAccessor->GetNumber("bufferView", -1.0)));
+
+        if (pView == nullptr) return false;
+
+        int    BufferIndex   = static_cast<int>(pView->GetNumber("buffer", -1.0));
+        int    ComponentType = static_cast<int>(pAccessor->GetNumber("componentType", 0.0));
+        size_t Size          = ComponentType == 5121 ? 1 : (ComponentType == 5123 ? 2 : 4);
+
+        unsigned long long Count;
+        unsigned long long ViewOffset;
+        unsigned long long AccessorOffset;
+
+        if (GetUnsigned(*pAccessor, "count"     , s_MaximumCount     , Count         ) == false) return false;
+        if (GetUnsigned(*pView    , "byteOffset", s_MaximumByteOffset, ViewOffset    ) == false) return false;
+        if (GetUnsigned(*pAccessor, "byteOffset", s_MaximumByteOffset, AccessorOffset) == false) return false;
+
+        if (BufferIndex < 0 || BufferIndex >= static_cast<int>(_rBuffers.size()) || (ComponentType != 5121 && ComponentType != 5123 && ComponentType != 5125)) return false;
+
+        const std::vector<char>& rBuffer = _rBuffers[BufferIndex];
+
+        unsigned long long Offset = ViewOffset + AccessorOffset;
+
+        if (Offset + Size * Count > rBuffer.size()) return false;
+
+        _rIndices.resize(static_cast<size_t>(Count));
+
+        for (int IndexOfIndex = 0; IndexOfIndex < static_cast<int>(Count); ++ IndexOfIndex)
+        {
+            const char* pValue = &rBuffer[static_cast<size_t>(Offset + Size * IndexOfIndex)];
+
+            switch (ComponentType)
+            {
+                case 5121: { unsigned char  Raw; memcpy(&Raw, pValue, 1); _rIndices[IndexOfIndex] = Raw; break; }
+                case 5123: { unsigned short Raw; memcpy(&Raw, pValue, 2); _rIndices[IndexOfIndex] = Raw; break; }
+                default:   { unsigned int   Raw; memcpy(&Raw, pValue, 4); _rIndices[IndexOfIndex] = static_cast<int>(Raw); break; }
+            }
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    struct SGltfPrimitive
+    {
+        const SJsonValue*  m_pPrimitive;
+        std::vector<float> m_Positions;
+        std::vector<float> m_Normals;
+        std::vector<float> m_TexCoords;
+        std::vector<int>   m_Indices;
+        bool               m_HasNormals;
+        bool               m_IsValid;
+    };
+} // namespace
+
+bool ImportGltf(const char* _pPath, SImportedMesh& _rMesh, SVertexLayout::ELayout _Layout)
+{
+    std::vector<char> File;
+
+    if (ReadFile(_pPath, File) == false) return false;
+
+    _rMesh.m_Vertices.clear();
+    _rMesh.m_Indices .clear();
+    _rMesh.m_MaterialName.clear();
+    _rMesh.m_NumberOfBytes = static_cast<long long>(File.size() - 1);
+
+    // -----------------------------------------------------------------------------
+    // A binary file has a JSON chunk and an optional binary chunk after the header.
+    // -----------------------------------------------------------------------------
+    const char* pJson    = File.data();
+    const char* pJsonEnd = File.data() + File.size() - 1;
+
+    std::vector<std::vector<char> > Buffers;
+    std::vector<char>               BinaryChunk;
+
+    unsigned int Header[5] = {};
+
+    if (File.size() > sizeof(Header)) memcpy(Header, File.data(), sizeof(Header));
+
+    bool IsBinary = Header[0] == 0x46546C67;
+
+    if (IsBinary)
+    {
+        if (Header[1] != 2 || Header[4] != 0x4E4F534A || 20 + static_cast<size_t>(Header[3]) > File.size() - 1) return false;
+
+        pJson    = File.data() + 20;
+        pJsonEnd = pJson + Header[3];
+
+        size_t BinaryOffset = 20 + static_cast<size_t>(Header[3]);
+
+        if (BinaryOffset + 8 <= File.size() - 1)
+        {
+            unsigned int ChunkHeader[2];
+
+            memcpy(ChunkHeader, File.data() + BinaryOffset, sizeof(ChunkHeader));
+
+            if (ChunkHeader[1] == 0x004E4942 && BinaryOffset + 8 + ChunkHeader[0] <= File.size() - 1)
+            {
+                BinaryChunk.assign(File.data() + BinaryOffset + 8, File.data() + BinaryOffset + 8 + ChunkHeader[0]);
+            }
+        }
+    }
+
+    SJsonValue Document;
+
+    CJsonParser Parser(pJson, pJsonEnd);
+
+    if (Parser.Parse(Document) == false || Document.m_Type != SJsonValue::Object) return false;
+
+    // -----------------------------------------------------------------------------
+    // Load the buffers from the binary chunk, data URIs, or files next to the
+    // glTF file.
+    // -----------------------------------------------------------------------------
+    const SJsonValue* pBuffers = Document.Find("buffers");
+
+    if (pBuffers != nullptr)
+    {
+        for (const SJsonValue& rBuffer : pBuffers->m_Elements)
+        {
+            Buffers.push_back(std::vector<char>());
+
+            const SJsonValue* pUri = rBuffer.Find("uri");
+
+            if (pUri == nullptr)
+            {
+                Buffers.back().swap(BinaryChunk);
+            }
+            else if (pUri->m_String.compare(0, 5, "data:") == 0)
+            {
+                size_t Comma = pUri->m_String.find(',');
+
+                if (Comma == std::string::npos || DecodeBase64(pUri->m_String.c_str() + Comma + 1, pUri->m_String.size() - Comma - 1, Buffers.back()) == false) return false;
+            }
+            else
+            {
+                std::string Path = GetDirectory(_pPath) + pUri->m_String;
+
+                if (ReadFile(Path.c_str(), Buffers.back()) == false) return false;
+
+                Buffers.back().pop_back();
+
+                _rMesh.m_NumberOfBytes += static_cast<long long>(Buffers.back().size());
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Convert all triangle primitives in parallel, then concatenate them.
+    // -----------------------------------------------------------------------------
+    std::vector<SGltfPrimitive> Primitives;
+
+    const SJsonValue* pMeshes = Document.Find("meshes");
+
+    if (pMeshes != nullptr)
+    {
+        for (const SJsonValue& rMesh : pMeshes->m_Elements)
+        {
+            const SJsonValue* pPrimitives = rMesh.Find("primitives");
+
+            if (pPrimitives == nullptr) continue;
+
+            for (const SJsonValue& rPrimitive : pPrimitives->m_Elements)
+            {
+                if (rPrimitive.GetNumber("mode", 4.0) != 4.0) continue;
+
+                SGltfPrimitive Primitive;
+
+                Primitive.m_pPrimitive = &rPrimitive;
+                Primitive.m_HasNormals = false;
+                Primitive.m_IsValid    = false;
+
+                Primitives.push_back(Primitive);
+            }
+        }
+    }
+
+    ParallelFor(static_cast<int>(Primitives.size()), [&](int _IndexOfPrimitive)
+    {
+        SGltfPrimitive& rPrimitive = Primitives[_IndexOfPrimitive];
+
+        const SJsonValue* pAttributes = rPrimitive.m_pPrimitive->Find("attributes");
+
+        if (pAttributes == nullptr) return;
+
+        int IndexOfPosition = static_cast<int>(pAttributes->GetNumber("POSITION"  , -1.0));
+        int IndexOfNormal   = static_cast<int>(pAttributes->GetNumber("NORMAL"    , -1.0));
+        int IndexOfTexCoord = static_cast<int>(pAttributes->GetNumber("TEXCOORD_0", -1.0));
+        int IndexOfIndices  = static_cast<int>(rPrimitive.m_pPrimitive->GetNumber("indices", -1.0));
+
+        if (ReadAccessor(Document, Buffers, IndexOfPosition, 3, rPrimitive.m_Positions) == false) return;
+
+        size_t NumberOfVertices = rPrimitive.m_Positions.size() / 3;
+
+        rPrimitive.m_HasNormals = IndexOfNormal >= 0 && ReadAccessor(Document, Buffers, IndexOfNormal, 3, rPrimitive.m_Normals) && rPrimitive.m_Normals.size() == NumberOfVertices * 3;
+
+        if (rPrimitive.m_HasNormals == false) rPrimitive.m_Normals.assign(NumberOfVertices * 3, 0.0f);
+
+        if (IndexOfTexCoord < 0 || ReadAccessor(Document, Buffers, IndexOfTexCoord, 2, rPrimitive.m_TexCoords) == false || rPrimitive.m_TexCoords.size() != NumberOfVertices * 2)
+        {
+            rPrimitive.m_TexCoords.assign(NumberOfVertices * 2, 0.0f);
+        }
+
+        if (IndexOfIndices >= 0)
+        {
+            if (ReadIndices(Document, Buffers, IndexOfIndices, rPrimitive.m_Indices) == false) return;
+        }
+        else
+        {
+            rPrimitive.m_Indices.resize(NumberOfVertices);
+
+            for (size_t Index = 0; Index < NumberOfVertices; ++ Index) rPrimitive.m_Indices[Index] = static_cast<int>(Index);
+        }
+
+        rPrimitive.m_Indices.resize(rPrimitive.m_Indices.size() / 3 * 3);
+
+        for (int Index : rPrimitive.m_Indices)
+        {
+            if (Index < 0 || static_cast<size_t>(Index) >= NumberOfVertices) return;
+        }
+
+        rPrimitive.m_IsValid = true;
+    });
+
+    std::vector<float> Positions;
+    std::vector<float> Normals;
+    std::vector<float> TexCoords;
+    std::vector<int>   Indices;
+    std::vector<char>  IsNormalMissing;
+
+    bool HasMissingNormals = false;
+
+    for (const SGltfPrimitive& rPrimitive : Primitives)
+    {
+        if (rPrimitive.m_IsValid == false) return false;
+
+        int Offset = static_cast<int>(Positions.size() / 3);
+
+        Positions.insert(Positions.end(), rPrimitive.m_Positions.begin(), rPrimitive.m_Positions.end());
+        Normals  .insert(Normals  .end(), rPrimitive.m_Normals  .begin(), rPrimitive.m_Normals  .end());
+        TexCoords.insert(TexCoords.end(), rPrimitive.m_TexCoords.begin(), rPrimitive.m_TexCoords.end());
+
+        IsNormalMissing.resize(Positions.size() / 3, rPrimitive.m_HasNormals ? 0 : 1);
+
+        HasMissingNormals = HasMissingNormals || rPrimitive.m_HasNormals == false;
+
+        for (int Index : rPrimitive.m_Indices) Indices.push_back(Offset + Index);
+    }
+
+    Primitives.clear();
+
+    if (HasMissingNormals)
+    {
+        CalculateNormals(Positions, Indices, IsNormalMissing, Normals);
+    }
+
+    BuildMesh(Positions, Normals, TexCoords, Indices, _Layout, _rMesh);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ImportMesh(const char* _pPath, SImportedMesh& _rMesh, SVertexLayout::ELayout _Layout)
+{
+    std::string Path(_pPath);
+
+    size_t Dot = Path.find_last_of('.');
+
+    std::string Extension = Dot == std::string::npos ? std::string() : Path.substr(Dot + 1);
+
+    if (Extension == "obj" || Extension == "OBJ") return ImportObj(_pPath, _rMesh, _Layout);
+
+    if (Extension == "gltf" || Extension == "glb" || Extension == "GLTF" || Extension == "GLB") return ImportGltf(_pPath, _rMesh, _Layout);
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CalculateTangents(std::vector<float>& _rPositions, std::vector<float>& _rNormals, std::vector<float>& _rTexCoords, std::vector<int>& _rIndices, std::vector<float>& _rTangents, std::vector<float>& _rBinormals)
+{
+    int NumberOfVertices  = static_cast<int>(_rPositions.size() / 3);
+    int NumberOfTriangles = static_cast<int>(_rIndices.size() / 3);
+
+    // -----------------------------------------------------------------------------
+    // The tangent of each corner: the direction of increasing u of its triangle,
+    // normalized, flipped for mirrored triangles, projected into the tangent
+    // plane of the vertex normal, and weighted by the corner angle. A triangle
+    // with mirrored texture coordinates has negative orientation, one with
+    // collapsed texture coordinates has none. It adds nothing to the tangents
+    // and does not split its vertices.
+    // -----------------------------------------------------------------------------
+    std::vector<float> CornerTangents(_rIndices.size() * 3, 0.0f);
+    std::vector<char>  Orientations(NumberOfTriangles, -1);             // 0 preserving, 1 mirrored, -1 collapsed.
+
+    ParallelForRange(NumberOfTriangles, [&](int _First, int _Last)
+    {
+        for (int IndexOfTriangle = _First; IndexOfTriangle < _Last; ++ IndexOfTriangle)
+        {
+            const int* pTriangle = &_rIndices[IndexOfTriangle * 3];
+
+            const float* pP0 = &_rPositions[pTriangle[0] * 3];
+            const float* pT0 = &_rTexCoords[pTriangle[0] * 2];
+            const float* pT1 = &_rTexCoords[pTriangle[1] * 2];
+            const float* pT2 = &_rTexCoords[pTriangle[2] * 2];
+
+            float Edge1[3];
+            float Edge2[3];
+
+            Subtract(&_rPositions[pTriangle[1] * 3], pP0, Edge1);
+            Subtract(&_rPositions[pTriangle[2] * 3], pP0, Edge2);
+
+            float S1 = pT1[0] - pT0[0];
+            float T1 = pT1[1] - pT0[1];
+            float S2 = pT2[0] - pT0[0];
+            float T2 = pT2[1] - pT0[1];
+
+            float SignedArea = S1 * T2 - T1 * S2;
+
+            if (fabsf(SignedArea) <= 1.0e-20f) continue;
+
+            Orientations[IndexOfTriangle] = SignedArea > 0.0f ? 0 : 1;
+
+            float Sign = SignedArea > 0.0f ? 1.0f : -1.0f;
+
+            float Tangent[3] =
+            {
+                (T2 * Edge1[0] - T1 * Edge2[0]) * Sign,
+                (T2 * Edge1[1] - T1 * Edge2[1]) * Sign,
+                (T2 * Edge1[2] - T1 * Edge2[2]) * Sign,
+            };
+
+            if (Normalize(Tangent) == false) continue;
+
+            for (int Corner = 0; Corner < 3; ++ Corner)
+            {
+                int          Vertex  = pTriangle[Corner];
+                const float* pNormal = &_rNormals[Vertex * 3];
+
+                float Projection = Dot(Tangent, pNormal);
+
+                float Projected[3] =
+                {
+                    Tangent[0] - pNormal[0] * Projection,
+                    Tangent[1] - pNormal[1] * Projection,
+                    Tangent[2] - pNormal[2] * Projection,
+                };
+
+                if (Normalize(Projected) == false) continue;
+
+                float Angle = GetAngle(&_rPositions[Vertex * 3], &_rPositions[pTriangle[(Corner + 1) % 3] * 3], &_rPositions[pTriangle[(Corner + 2) % 3] * 3]);
+
+                float* pCornerTangent = &CornerTangents[(IndexOfTriangle * 3 + Corner) * 3];
+
+                pCornerTangent[0] = Projected[0] * Angle;
+                pCornerTangent[1] = Projected[1] * Angle;
+                pCornerTangent[2] = Projected[2] * Angle;
+            }
+        }
+    });
+
+    // -----------------------------------------------------------------------------
+    // Sum the corners per vertex and orientation. Vertices used by triangles of
+    // both orientations get a second vertex for the mirrored triangles.
+    // -----------------------------------------------------------------------------
+    std::vector<float> Sums(static_cast<size_t>(NumberOfVertices) * 6, 0.0f);
+    std::vector<char>  UsedOrientations(NumberOfVertices, 0);
+
+    for (int IndexOfCorner = 0; IndexOfCorner < NumberOfTriangles * 3; ++ IndexOfCorner)
+    {
+        int Vertex      = _rIndices[IndexOfCorner];
+        int Orientation = Orientations[IndexOfCorner / 3];
+
+        if (Orientation < 0) continue;
+
+        float* pSum = &Sums[(static_cast<size_t>(Vertex) * 2 + Orientation) * 3];
+
+        pSum[0] += CornerTangents[IndexOfCorner * 3 + 0];
+        pSum[1] += CornerTangents[IndexOfCorner * 3 + 1];
+        pSum[2] += CornerTangents[IndexOfCorner * 3 + 2];
+
+        UsedOrientations[Vertex] |= 1 << Orientation;
+    }
+
+    std::vector<int>  Mirrors(NumberOfVertices, -1);
+    std::vector<char> VertexIsPreserving(NumberOfVertices, 1);
+
+    for (int Vertex = 0; Vertex < NumberOfVertices; ++ Vertex)
+    {
+        if (UsedOrientations[Vertex] == 3)
+        {
+            Mirrors[Vertex] = static_cast<int>(_rPositions.size() / 3);
+
+            _rPositions.insert(_rPositions.end(), _rPositions.begin() + Vertex * 3, _rPositions.begin() + Vertex * 3 + 3);
+            _rNormals  .insert(_rNormals  .end(), _rNormals  .begin() + Vertex * 3, _rNormals  .begin() + Vertex * 3 + 3);
+            _rTexCoords.insert(_rTexCoords.end(), _rTexCoords.begin() + Vertex * 2, _rTexCoords.begin() + Vertex * 2 + 2);
+
+            VertexIsPreserving.push_back(0);
+        }
+        else if (UsedOrientations[Vertex] == 2)
+        {
+            VertexIsPreserving[Vertex] = 0;
+        }
+    }
+
+    for (int IndexOfCorner = 0; IndexOfCorner < NumberOfTriangles * 3; ++ IndexOfCorner)
+    {
+        int Vertex = _rIndices[IndexOfCorner];
+
+        if (Mirrors[Vertex] >= 0 && Orientations[IndexOfCorner / 3] == 1) _rIndices[IndexOfCorner] = Mirrors[Vertex];
+    }
+
+    // -----------------------------------------------------------------------------
+    // Tangent and binormal per vertex. MikkTSpace defines the bitangent as
+    // sign * cross(normal, tangent), the binormal is its negation.
+    // -----------------------------------------------------------------------------
+    int NumberOfAllVertices = static_cast<int>(_rPositions.size() / 3);
+
+    _rTangents .resize(static_cast<size_t>(NumberOfAllVertices) * 3);
+    _rBinormals.resize(static_cast<size_t>(NumberOfAllVertices) * 3);
+
+    ParallelForRange(NumberOfVertices, [&](int _First, int _Last)
+    {
+        for (int Vertex = _First; Vertex < _Last; ++ Vertex)
+        {
+            for (int Orientation = 0; Orientation < 2; ++ Orientation)
+            {
+                if ((UsedOrientations[Vertex] & (1 << Orientation)) == 0 && !(Orientation == 0 && UsedOrientations[Vertex] == 0)) continue;
+
+                int Target = Vertex;
+
+                if (Orientation == 1 && Mirrors[Vertex] >= 0) Target = Mirrors[Vertex];
+
+                const float* pNormal   = &_rNormals[Target * 3];
+                float*       pTangent  = &_rTangents [Target * 3];
+                float*       pBinormal = &_rBinormals[Target * 3];
+
+                memcpy(pTangent, &Sums[(static_cast<size_t>(Vertex) * 2 + Orientation) * 3], 3 * sizeof(float));
+
+                if (Normalize(pTangent) == false) GetAnyTangent(pNormal, pTangent);
+
+                float Sign = VertexIsPreserving[Target] != 0 ? 1.0f : -1.0f;
+
+                Cross(pNormal, pTangent, pBinormal);
+
+                pBinormal[0] *= -Sign;
+                pBinormal[1] *= -Sign;
+                pBinormal[2] *= -Sign;
+            }
+        }
+    });
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+struct SVertexLayout
+{
+    enum ELayout
+    {
+        PositionNormalTexCoord,                                         ///< 8 floats: POSITION, NORMAL, TEXCOORD.
+        NormalMapping,                                                  ///< 14 floats: POSITION, TANGENT, BINORMAL, NORMAL, TEXCOORD like 'billboard.cpp'.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// An imported mesh with interleaved float vertices in the requested layout and
+// three int indices per triangle, ready for 'SMeshInfo'.
+// -----------------------------------------------------------------------------
+struct SImportedMesh
+{
+    std::vector<float> m_Vertices;                                      // Interleaved vertices.
+    std::vector<int>   m_Indices;                                       // Three indices per triangle.
+    int                m_NumberOfFloatsPerVertex;                       // Floats of one vertex in 'm_Vertices'.
+    std::string        m_MaterialName;                                  // The first material referenced by the file, may be empty.
+    long long          m_NumberOfBytes;                                 // Size of the imported files, for throughput measurements.
+};
+
+// -----------------------------------------------------------------------------
+// Importer settings. The OBJ text is split into one chunk per thread at line
+// boundaries and the chunks are parsed in parallel.
+// -----------------------------------------------------------------------------
+void SetNumberOfImportThreads(int _NumberOfThreads);
+int  GetNumberOfImportThreads();
+
+// -----------------------------------------------------------------------------
+// Reads a Wavefront OBJ file. Polygons are triangulated as fans, corners with
+// the same position, texture coordinate, and normal index share one vertex.
+// Missing normals are calculated from the faces.
+// -----------------------------------------------------------------------------
+bool ImportObj(const char* _pPath, SImportedMesh& _rMesh, SVertexLayout::ELayout _Layout = SVertexLayout::PositionNormalTexCoord);
+
+// -----------------------------------------------------------------------------
+// Reads a glTF 2.0 file (.gltf with external or embedded base64 buffers, or
+// .glb). The triangle primitives of all meshes are merged into one mesh, node
+// transformations are not applied.
+// -----------------------------------------------------------------------------
+bool ImportGltf(const char* _pPath, SImportedMesh& _rMesh, SVertexLayout::ELayout _Layout = SVertexLayout::PositionNormalTexCoord);
+
+// -----------------------------------------------------------------------------
+// Chooses the importer by the file extension.
+// -----------------------------------------------------------------------------
+bool ImportMesh(const char* _pPath, SImportedMesh& _rMesh, SVertexLayout::ELayout _Layout = SVertexLayout::PositionNormalTexCoord);
+
+// -----------------------------------------------------------------------------
+// Calculates tangents and binormals the way MikkTSpace does: per triangle
+// from the texture coordinate derivatives, projected into the tangent plane,
+// weighted by the corner angle, and with vertices split where triangles of
+// different handedness meet. The binormal points to decreasing v, like the
+// hand-entered quads, i.e. it is the negated MikkTSpace bitangent.
+// Positions, normals, and texture coordinates are given per vertex, vertices
+// may be appended, and the indices are updated accordingly.
+// -----------------------------------------------------------------------------
+void CalculateTangents(std::vector<float>& _rPositions, std::vector<float>& _rNormals, std::vector<float>& _rTexCoords, std::vector<int>& _rIndices, std::vector<float>& _rTangents, std::vector<float>& _rBinormals);
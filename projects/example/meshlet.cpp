@@ -0,0 +1,436 @@
+
+#include "meshlet.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+namespace
+{
+    float GetLength(const float* _pVector)
+    {
+        return sqrtf(_pVector[0] * _pVector[0] + _pVector[1] * _pVector[1] + _pVector[2] * _pVector[2]);
+    }
+} // namespace
+
+CMeshletMesh::CMeshletMesh()
+    : m_NumberOfTriangles(0)
+    , m_HasShortIndices  (true)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CMeshletMesh::~CMeshletMesh()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CMeshletMesh::Build(const float* _pVertices, int _VertexStride, int _NumberOfVertices, const int* _pIndices, int _NumberOfIndices)
+{
+    Clear();
+
+    m_HasShortIndices = _NumberOfVertices <= 65536;
+
+    int NumberOfTriangles = _NumberOfIndices / 3;
+
+    // -----------------------------------------------------------------------------
+    // The triangles of each vertex, so a meshlet finds the triangles next to it.
+    // -----------------------------------------------------------------------------
+    std::vector<int> FirstTriangles(_NumberOfVertices + 1, 0);
+    std::vector<int> VertexTriangles(NumberOfTriangles * 3);
+
+    for (int Index = 0; Index < NumberOfTriangles * 3; ++ Index) ++ FirstTriangles[_pIndices[Index] + 1];
+
+    for (int IndexOfVertex = 0; IndexOfVertex < _NumberOfVertices; ++ IndexOfVertex) FirstTriangles[IndexOfVertex + 1] += FirstTriangles[IndexOfVertex];
+
+    std::vector<int> Cursors(FirstTriangles.begin(), FirstTriangles.end() - 1);
+
+    for (int Index = 0; Index < NumberOfTriangles * 3; ++ Index) VertexTriangles[Cursors[_pIndices[Index]] ++] = Index / 3;
+
+    // -----------------------------------------------------------------------------
+    // Grow each meshlet from a seed triangle. The next triangle is the neighbor
+    // adding the fewest new vertices, so the meshlet fills up its vertices with
+    // as many triangles as possible. Without neighbors left the meshlet is done
+    // and the next unused triangle in index order becomes the new seed.
+    // -----------------------------------------------------------------------------
+    std::vector<unsigned char> IsUsed(NumberOfTriangles, 0);
+    std::vector<int>           LocalIndices(_NumberOfVertices, -1);
+    std::vector<int>           MeshletVertices;
+    std::vector<unsigned char> MeshletTriangles;
+    std::vector<int>           Candidates;
+
+    MeshletVertices .reserve(s_MaximumNumberOfVertices);
+    MeshletTriangles.reserve(s_MaximumNumberOfTriangles * 3);
+
+    int Seed = 0;
+
+    for (;;)
+    {
+        int BestTriangle            = -1;
+        int BestNumberOfNewVertices = 4;
+
+        for (size_t IndexOfCandidate = 0; IndexOfCandidate < Candidates.size(); )
+        {
+            int Triangle = Candidates[IndexOfCandidate];
+
+            if (IsUsed[Triangle])
+            {
+                Candidates[IndexOfCandidate] = Candidates.back();
+
+                Candidates.pop_back();
+
+                continue;
+            }
+
+            const int* pTriangle = &_pIndices[Triangle * 3];
+
+            int NumberOfNewVertices = (LocalIndices[pTriangle[0]] < 0 ? 1 : 0) + (LocalIndices[pTriangle[1]] < 0 ? 1 : 0) + (LocalIndices[pTriangle[2]] < 0 ? 1 : 0);
+
+            if (NumberOfNewVertices < BestNumberOfNewVertices && static_cast<int>(MeshletVertices.size()) + NumberOfNewVertices <= s_MaximumNumberOfVertices)
+            {
+                BestTriangle            = Triangle;
+                BestNumberOfNewVertices = NumberOfNewVertices;
+
+                if (NumberOfNewVertices == 0) break;
+            }
+
+            ++ IndexOfCandidate;
+        }
+
+        if (BestTriangle < 0)
+        {
+            if (MeshletTriangles.empty() == false)
+            {
+                AddMeshlet(_pVertices, _VertexStride, MeshletVertices, MeshletTriangles);
+
+                for (int IndexOfVertex : MeshletVertices) LocalIndices[IndexOfVertex] = -1;
+
+                MeshletVertices .clear();
+                MeshletTriangles.clear();
+                Candidates      .clear();
+
+                continue;
+            }
+
+            while (Seed < NumberOfTriangles && IsUsed[Seed]) ++ Seed;
+
+            if (Seed == NumberOfTriangles) break;
+
+            BestTriangle = Seed;
+        }
+
+        IsUsed[BestTriangle] = 1;
+
+        for (int Corner = 0; Corner < 3; ++ Corner)
+        {
+            int IndexOfVertex = _pIndices[BestTriangle * 3 + Corner];
+
+            if (LocalIndices[IndexOfVertex] < 0)
+            {
+                LocalIndices[IndexOfVertex] = static_cast<int>(MeshletVertices.size());
+
+                MeshletVertices.push_back(IndexOfVertex);
+
+                for (int Index = FirstTriangles[IndexOfVertex]; Index < FirstTriangles[IndexOfVertex + 1]; ++ Index)
+                {
+                    if (IsUsed[VertexTriangles[Index]] == 0) Candidates.push_back(VertexTriangles[Index]);
+                }
+            }
+
+            MeshletTriangles.push_back(static_cast<unsigned char>(LocalIndices[IndexOfVertex]));
+        }
+
+        // A full meshlet is finished by the next iteration, which finds no candidate
+        if (static_cast<int>(MeshletTriangles.size()) == s_MaximumNumberOfTriangles * 3) Candidates.clear();
+    }
+
+    m_NumberOfTriangles = NumberOfTriangles;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMeshletMesh::Clear()
+{
+    m_Meshlets          .clear();
+    m_ShortVertexIndices.clear();
+    m_VertexIndices     .clear();
+    m_TriangleIndices   .clear();
+
+    m_NumberOfTriangles = 0;
+    m_HasShortIndices   = true;
+}
+
+// -----------------------------------------------------------------------------
+
+int CMeshletMesh::GetNumberOfMeshlets() const
+{
+    return static_cast<int>(m_Meshlets.size());
+}
+
+// -----------------------------------------------------------------------------
+
+const SMeshlet& CMeshletMesh::GetMeshlet(int _IndexOfMeshlet) const
+{
+    return m_Meshlets[_IndexOfMeshlet];
+}
+
+// -----------------------------------------------------------------------------
+
+int CMeshletMesh::GetNumberOfTriangles() const
+{
+    return m_NumberOfTriangles;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMeshletMesh::HasShortIndices() const
+{
+    return m_HasShortIndices;
+}
+
+// -----------------------------------------------------------------------------
+
+int CMeshletMesh::GetVertexIndex(const SMeshlet& _rMeshlet, int _LocalIndex) const
+{
+    if (m_HasShortIndices) return m_ShortVertexIndices[_rMeshlet.m_FirstVertex + _LocalIndex];
+
+    return static_cast<int>(m_VertexIndices[_rMeshlet.m_FirstVertex + _LocalIndex]);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CMeshletMesh::GetIndexMemory() const
+{
+    return m_Meshlets.size() * sizeof(SMeshlet) + m_ShortVertexIndices.size() * sizeof(unsigned short) + m_VertexIndices.size() * sizeof(unsigned int) + m_TriangleIndices.size();
+}
+
+// -----------------------------------------------------------------------------
+
+int CMeshletMesh::Cull(const float (*_pFrustumPlanes)[4], const float* _pEyePosition, int* _pVisible, SMeshletStatistics* _pStatistics) const
+{
+    SMeshletStatistics Statistics = {};
+
+    int NumberOfVisible = 0;
+
+    for (int IndexOfMeshlet = 0; IndexOfMeshlet < GetNumberOfMeshlets(); ++ IndexOfMeshlet)
+    {
+        const SMeshlet& rMeshlet = m_Meshlets[IndexOfMeshlet];
+
+        const float* pCenter = rMeshlet.m_Center;
+
+        Statistics.m_NumberOfTriangles += rMeshlet.m_NumberOfTriangles;
+
+        bool IsInside = true;
+
+        for (int IndexOfPlane = 0; IndexOfPlane < 6 && IsInside; ++ IndexOfPlane)
+        {
+            const float* pPlane = _pFrustumPlanes[IndexOfPlane];
+
+            IsInside = pPlane[0] * pCenter[0] + pPlane[1] * pCenter[1] + pPlane[2] * pCenter[2] + pPlane[3] >= -rMeshlet.m_Radius;
+        }
+
+        if (IsInside == false)
+        {
+            ++ Statistics.m_NumberOfFrustumCulledMeshlets;
+
+            Statistics.m_NumberOfFrustumRejectedTriangles += rMeshlet.m_NumberOfTriangles;
+
+            continue;
+        }
+
+        // -----------------------------------------------------------------------------
+        // All triangles face away from the eye if the eye is outside the cone of
+        // the normals mirrored at the sphere. The test is conservative for every
+        // point of the sphere, the cutoff of 1 never culls.
+        // -----------------------------------------------------------------------------
+        float Direction[3] = { pCenter[0] - _pEyePosition[0], pCenter[1] - _pEyePosition[1], pCenter[2] - _pEyePosition[2] };
+
+        float Dot = Direction[0] * rMeshlet.m_ConeAxis[0] + Direction[1] * rMeshlet.m_ConeAxis[1] + Direction[2] * rMeshlet.m_ConeAxis[2];
+
+        if (Dot >= rMeshlet.m_ConeCutoff * GetLength(Direction) + rMeshlet.m_Radius)
+        {
+            ++ Statistics.m_NumberOfConeCulledMeshlets;
+
+            Statistics.m_NumberOfConeRejectedTriangles += rMeshlet.m_NumberOfTriangles;
+
+            continue;
+        }
+
+        _pVisible[NumberOfVisible ++] = IndexOfMeshlet;
+    }
+
+    if (_pStatistics != nullptr)
+    {
+        _pStatistics->m_NumberOfMeshlets                 += GetNumberOfMeshlets();
+        _pStatistics->m_NumberOfFrustumCulledMeshlets    += Statistics.m_NumberOfFrustumCulledMeshlets;
+        _pStatistics->m_NumberOfConeCulledMeshlets       += Statistics.m_NumberOfConeCulledMeshlets;
+        _pStatistics->m_NumberOfTriangles                += Statistics.m_NumberOfTriangles;
+        _pStatistics->m_NumberOfFrustumRejectedTriangles += Statistics.m_NumberOfFrustumRejectedTriangles;
+        _pStatistics->m_NumberOfConeRejectedTriangles    += Statistics.m_NumberOfConeRejectedTriangles;
+    }
+
+    return NumberOfVisible;
+}
+
+// -----------------------------------------------------------------------------
+
+int CMeshletMesh::GetIndices(const int* _pMeshlets, int _NumberOfMeshlets, int* _pIndices) const
+{
+    int NumberOfIndices = 0;
+
+    for (int Index = 0; Index < _NumberOfMeshlets; ++ Index)
+    {
+        const SMeshlet& rMeshlet = m_Meshlets[_pMeshlets[Index]];
+
+        const unsigned char* pLocalIndices = &m_TriangleIndices[rMeshlet.m_FirstTriangle * 3];
+
+        for (int IndexOfIndex = 0; IndexOfIndex < rMeshlet.m_NumberOfTriangles * 3; ++ IndexOfIndex)
+        {
+            _pIndices[NumberOfIndices ++] = GetVertexIndex(rMeshlet, pLocalIndices[IndexOfIndex]);
+        }
+    }
+
+    return NumberOfIndices;
+}
+
+// -----------------------------------------------------------------------------
+
+int CMeshletMesh::GetIndices(const int* _pMeshlets, int _NumberOfMeshlets, unsigned short* _pIndices) const
+{
+    assert(m_HasShortIndices);
+
+    int NumberOfIndices = 0;
+
+    for (int Index = 0; Index < _NumberOfMeshlets; ++ Index)
+    {
+        const SMeshlet& rMeshlet = m_Meshlets[_pMeshlets[Index]];
+
+        const unsigned char*  pLocalIndices  = &m_TriangleIndices[rMeshlet.m_FirstTriangle * 3];
+        const unsigned short* pVertexIndices = &m_ShortVertexIndices[rMeshlet.m_FirstVertex];
+
+        for (int IndexOfIndex = 0; IndexOfIndex < rMeshlet.m_NumberOfTriangles * 3; ++ IndexOfIndex)
+        {
+            _pIndices[NumberOfIndices ++] = pVertexIndices[pLocalIndices[IndexOfIndex]];
+        }
+    }
+
+    return NumberOfIndices;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMeshletMesh::AddMeshlet(const float* _pVertices, int _VertexStride, const std::vector<int>& _rVertices, const std::vector<unsigned char>& _rTriangles)
+{
+    SMeshlet Meshlet;
+
+    Meshlet.m_FirstVertex       = static_cast<unsigned int>(m_HasShortIndices ? m_ShortVertexIndices.size() : m_VertexIndices.size());
+    Meshlet.m_FirstTriangle     = static_cast<unsigned int>(m_TriangleIndices.size() / 3);
+    Meshlet.m_NumberOfVertices  = static_cast<unsigned char>(_rVertices.size());
+    Meshlet.m_NumberOfTriangles = static_cast<unsigned char>(_rTriangles.size() / 3);
+
+    for (int IndexOfVertex : _rVertices)
+    {
+        if (m_HasShortIndices)
+        {
+            m_ShortVertexIndices.push_back(static_cast<unsigned short>(IndexOfVertex));
+        }
+        else
+        {
+            m_VertexIndices.push_back(static_cast<unsigned int>(IndexOfVertex));
+        }
+    }
+
+    m_TriangleIndices.insert(m_TriangleIndices.end(), _rTriangles.begin(), _rTriangles.end());
+
+    // -----------------------------------------------------------------------------
+    // The sphere is centered on the box of the vertices.
+    // -----------------------------------------------------------------------------
+    float Min[3] = {  3.402823466e+38f,  3.402823466e+38f,  3.402823466e+38f };
+    float Max[3] = { -3.402823466e+38f, -3.402823466e+38f, -3.402823466e+38f };
+
+    for (int IndexOfVertex : _rVertices)
+    {
+        const float* pPosition = &_pVertices[static_cast<size_t>(IndexOfVertex) * _VertexStride];
+
+        for (int Axis = 0; Axis < 3; ++ Axis)
+        {
+            Min[Axis] = std::min(Min[Axis], pPosition[Axis]);
+            Max[Axis] = std::max(Max[Axis], pPosition[Axis]);
+        }
+    }
+
+    for (int Axis = 0; Axis < 3; ++ Axis) Meshlet.m_Center[Axis] = (Min[Axis] + Max[Axis]) * 0.5f;
+
+    Meshlet.m_Radius = 0.0f;
+
+    for (int IndexOfVertex : _rVertices)
+    {
+        const float* pPosition = &_pVertices[static_cast<size_t>(IndexOfVertex) * _VertexStride];
+
+        float Offset[3] = { pPosition[0] - Meshlet.m_Center[0], pPosition[1] - Meshlet.m_Center[1], pPosition[2] - Meshlet.m_Center[2] };
+
+        Meshlet.m_Radius = std::max(Meshlet.m_Radius, GetLength(Offset));
+    }
+
+    // -----------------------------------------------------------------------------
+    // The cone axis is the average of the unit normals. The spread is given by
+    // the normal with the largest angle to the axis. Cones wider than about 84
+    // degrees cull almost nothing, so they are disabled.
+    // -----------------------------------------------------------------------------
+    std::vector<float> Normals;
+
+    Normals.reserve(_rTriangles.size());
+
+    float Axis[3] = { 0.0f, 0.0f, 0.0f };
+
+    for (size_t IndexOfIndex = 0; IndexOfIndex < _rTriangles.size(); IndexOfIndex += 3)
+    {
+        const float* pA = &_pVertices[static_cast<size_t>(_rVertices[_rTriangles[IndexOfIndex + 0]]) * _VertexStride];
+        const float* pB = &_pVertices[static_cast<size_t>(_rVertices[_rTriangles[IndexOfIndex + 1]]) * _VertexStride];
+        const float* pC = &_pVertices[static_cast<size_t>(_rVertices[_rTriangles[IndexOfIndex + 2]]) * _VertexStride];
+
+        float AC[3] = { pC[0] - pA[0], pC[1] - pA[1], pC[2] - pA[2] };
+        float AB[3] = { pB[0] - pA[0], pB[1] - pA[1], pB[2] - pA[2] };
+
+        float Normal[3] =
+        {
+            AC[1] * AB[2] - AC[2] * AB[1],
+            AC[2] * AB[0] - AC[0] * AB[2],
+            AC[0] * AB[1] - AC[1] * AB[0],
+        };
+
+        float Length = GetLength(Normal);
+
+        // Degenerate triangles are never visible, so they do not widen the cone
+        if (Length == 0.0f) continue;
+
+        for (int Component = 0; Component < 3; ++ Component)
+        {
+            Normals.push_back(Normal[Component] / Length);
+
+            Axis[Component] += Normal[Component] / Length;
+        }
+    }
+
+    float AxisLength = GetLength(Axis);
+
+    float MinimumDot = 1.0f;
+
+    if (AxisLength > 0.0f)
+    {
+        for (int Component = 0; Component < 3; ++ Component) Axis[Component] /= AxisLength;
+
+        for (size_t Index = 0; Index < Normals.size(); Index += 3)
+        {
+            MinimumDot = std::min(MinimumDot, Normals[Index] * Axis[0] + Normals[Index + 1] * Axis[1] + Normals[Index + 2] * Axis[2]);
+        }
+    }
+
+    for (int Component = 0; Component < 3; ++ Component) Meshlet.m_ConeAxis[Component] = Axis[Component];
+
+    Meshlet.m_ConeCutoff = AxisLength > 0.0f && MinimumDot > 0.1f ? sqrtf(1.0f - MinimumDot * MinimumDot) : 1.0f;
+
+    m_Meshlets.push_back(Meshlet);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// A cluster of up to 64 vertices and 124 triangles of a mesh. The triangles
+// address the vertices of the meshlet with 8 bit local indices, the vertices
+// address the vertices of the mesh. The bounding sphere and the normal cone
+// are in the space of the mesh.
+// -----------------------------------------------------------------------------
+struct SMeshlet
+{
+    unsigned int  m_FirstVertex;                                        // First vertex reference of the meshlet.
+    unsigned int  m_FirstTriangle;                                      // First triangle of the meshlet, three local indices each.
+    unsigned char m_NumberOfVertices;
+    unsigned char m_NumberOfTriangles;
+    float         m_Center[3];
+    float         m_Radius;
+    float         m_ConeAxis[3];                                        // Average normal of the triangles.
+    float         m_ConeCutoff;                                         // Sine of the spread of the normals, 1 if the cone cannot cull.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SMeshletStatistics
+{
+    int m_NumberOfMeshlets;                                             // Meshlets tested.
+    int m_NumberOfFrustumCulledMeshlets;
+    int m_NumberOfConeCulledMeshlets;                                   // Meshlets facing away from the eye.
+    int m_NumberOfTriangles;                                            // Triangles of all tested meshlets.
+    int m_NumberOfFrustumRejectedTriangles;
+    int m_NumberOfConeRejectedTriangles;
+};
+
+// -----------------------------------------------------------------------------
+// A mesh split into meshlets at build time. Each meshlet grows from a seed
+// triangle over the triangles sharing its vertices, so it stays compact and
+// its normals point in similar directions. 'Cull' tests the meshlets against
+// the frustum and their normal cone, 'GetIndices' writes the indices of the
+// visible ones into one list for the draw. So far only the meshlet benchmark
+// uses it, the billboards, walls, and terrain chunks of the example are too
+// small to gain from it.
+//
+// Front faces are counter-clockwise seen from the front like in the examples,
+// so the outward normal of a triangle 'a b c' in the left-handed space of
+// YoshiX is 'cross(c - a, b - a)'.
+//
+// Meshes with up to 65536 vertices keep their vertex references in 16 bits and
+// can emit 16 bit index lists. YoshiX meshes only take 32 bit indices, the 16
+// bit lists are meant for packages and renderers which can use them.
+// -----------------------------------------------------------------------------
+class CMeshletMesh
+{
+    public:
+
+        static const int s_MaximumNumberOfVertices  = 64;
+        static const int s_MaximumNumberOfTriangles = 124;
+
+    public:
+
+        CMeshletMesh();
+        ~CMeshletMesh();
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // The vertex stride is counted in floats, the position is the first three
+        // floats of a vertex like in 'CDepthRasterizer::DrawTriangles'.
+        // -----------------------------------------------------------------------------
+        void Build(const float* _pVertices, int _VertexStride, int _NumberOfVertices, const int* _pIndices, int _NumberOfIndices);
+        void Clear();
+
+        int             GetNumberOfMeshlets() const;
+        const SMeshlet& GetMeshlet(int _IndexOfMeshlet) const;
+        int             GetNumberOfTriangles() const;
+
+        bool            HasShortIndices() const;                        // True if the mesh has at most 65536 vertices.
+        int             GetVertexIndex(const SMeshlet& _rMeshlet, int _LocalIndex) const;
+        size_t          GetIndexMemory() const;                         // Bytes of meshlets, vertex references, and local indices.
+
+        // -----------------------------------------------------------------------------
+        // Writes the indices of the meshlets which are not culled to an array with
+        // room for all meshlets and returns their number. Planes and eye are in the
+        // space of the mesh, e.g. the planes of the world view projection matrix.
+        // The statistics are added up, they can be null.
+        // -----------------------------------------------------------------------------
+        int Cull(const float (*_pFrustumPlanes)[4], const float* _pEyePosition, int* _pVisible, SMeshletStatistics* _pStatistics) const;
+
+        // -----------------------------------------------------------------------------
+        // Writes the triangles of the given meshlets as flat index list and returns
+        // the number of indices. The 16 bit version requires 'HasShortIndices'.
+        // -----------------------------------------------------------------------------
+        int GetIndices(const int* _pMeshlets, int _NumberOfMeshlets, int* _pIndices) const;
+        int GetIndices(const int* _pMeshlets, int _NumberOfMeshlets, unsigned short* _pIndices) const;
+
+    private:
+
+        void AddMeshlet(const float* _pVertices, int _VertexStride, const std::vector<int>& _rVertices, const std::vector<unsigned char>& _rTriangles);
+
+    private:
+
+        std::vector<SMeshlet>       m_Meshlets;
+        std::vector<unsigned short> m_ShortVertexIndices;               // Vertex references of meshes with up to 65536 vertices.
+        std::vector<unsigned int>   m_VertexIndices;                    // Vertex references of larger meshes.
+        std::vector<unsigned char>  m_TriangleIndices;                  // Three local indices per triangle.
+        int                         m_NumberOfTriangles;
+        bool                        m_HasShortIndices;
+};
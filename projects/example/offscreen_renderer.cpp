@@ -0,0 +1,133 @@
+
+#include "offscreen_renderer.h"
+
+#include <stddef.h>
+
+COffscreenRenderer::COffscreenRenderer()
+    : m_Width  (0)
+    , m_Height (0)
+    , m_pColor (nullptr)
+    , m_pNormal(nullptr)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void COffscreenRenderer::SetViewport(int _Width, int _Height)
+{
+    m_Width  = _Width;
+    m_Height = _Height;
+
+    m_DepthRasterizer.SetViewport(_Width, _Height);
+
+    m_ColorTarget .Resize(_Width, _Height, 4);
+    m_NormalTarget.Resize(_Width, _Height, 4);
+    m_DepthTarget .Resize(_Width, _Height, 1);
+}
+
+// -----------------------------------------------------------------------------
+
+void COffscreenRenderer::SetDepthRange(float _Near, float _Far, SDepthMode::EMode _Mode)
+{
+    m_DepthRasterizer.SetDepthRange(_Near, _Far, _Mode);
+}
+
+// -----------------------------------------------------------------------------
+
+void COffscreenRenderer::BeginFrame(const float* _pClearColor)
+{
+    m_DepthRasterizer.BeginFrame();
+
+    float* pColor  = m_ColorTarget .GetView().m_pPixels;
+    float* pNormal = m_NormalTarget.GetView().m_pPixels;
+
+    for (int IndexOfPixel = 0; IndexOfPixel < m_Width * m_Height; ++ IndexOfPixel, pColor += 4, pNormal += 4)
+    {
+        for (int IndexOfChannel = 0; IndexOfChannel < 4; ++ IndexOfChannel)
+        {
+            pColor [IndexOfChannel] = _pClearColor[IndexOfChannel];
+            pNormal[IndexOfChannel] = 0.0f;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void COffscreenRenderer::EndFrame()
+{
+    float* pDepth = m_DepthTarget.GetView().m_pPixels;
+
+    for (int Y = 0; Y < m_Height; ++ Y)
+    {
+        for (int X = 0; X < m_Width; ++ X) *pDepth++ = m_DepthRasterizer.GetDepth(X, Y);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void COffscreenRenderer::DrawTriangles(const float* _pVertices, int _VertexStride, const int* _pIndices, int _NumberOfIndices, const float* _pWorldViewProjectionMatrix, const float* _pColor, const float* _pNormal)
+{
+    // -----------------------------------------------------------------------------
+    // The shader does not change the depth, so the rasterizer tests the depth
+    // before the shader runs and the shader only sees visible fragments.
+    // -----------------------------------------------------------------------------
+    SRasterState State = { gfx::SDepthTest::Lesser, false, &COffscreenRenderer::ShadeFragment, this };
+
+    m_pColor  = _pColor;
+    m_pNormal = _pNormal;
+
+    m_DepthRasterizer.DrawTriangles(_pVertices, _VertexStride, _pIndices, _NumberOfIndices, _pWorldViewProjectionMatrix, State);
+}
+
+// -----------------------------------------------------------------------------
+
+CDepthRasterizer& COffscreenRenderer::GetDepthRasterizer()
+{
+    return m_DepthRasterizer;
+}
+
+// -----------------------------------------------------------------------------
+
+filter::SImage COffscreenRenderer::GetColorTarget()
+{
+    return m_ColorTarget.GetView();
+}
+
+// -----------------------------------------------------------------------------
+
+filter::SImage COffscreenRenderer::GetNormalTarget()
+{
+    return m_NormalTarget.GetView();
+}
+
+// -----------------------------------------------------------------------------
+
+filter::SImage COffscreenRenderer::GetDepthTarget()
+{
+    return m_DepthTarget.GetView();
+}
+
+// -----------------------------------------------------------------------------
+
+float COffscreenRenderer::ShadeFragment(int _X, int _Y, float _Depth, void* _pUserData)
+{
+    COffscreenRenderer& rRenderer = *static_cast<COffscreenRenderer*>(_pUserData);
+
+    size_t IndexOfPixel = static_cast<size_t>(_Y) * rRenderer.m_Width + _X;
+
+    float* pColor  = rRenderer.m_ColorTarget .GetView().m_pPixels + IndexOfPixel * 4;
+    float* pNormal = rRenderer.m_NormalTarget.GetView().m_pPixels + IndexOfPixel * 4;
+
+    float Alpha = rRenderer.m_pColor[3];
+
+    for (int IndexOfChannel = 0; IndexOfChannel < 3; ++ IndexOfChannel)
+    {
+        pColor [IndexOfChannel] = rRenderer.m_pColor[IndexOfChannel] * Alpha + pColor[IndexOfChannel] * (1.0f - Alpha);
+        pNormal[IndexOfChannel] = rRenderer.m_pNormal[IndexOfChannel];
+    }
+
+    pColor [3] = Alpha + pColor[3] * (1.0f - Alpha);
+    pNormal[3] = 1.0f;
+
+    return _Depth;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "depth_rasterizer.h"
+#include "image_filter.h"
+
+// -----------------------------------------------------------------------------
+// Renders flat shaded triangles on the CPU into a color, a normal, and a depth
+// image, so a scene can be rendered without a window and without a GPU. The
+// software depth rasterizer does the rasterization and the depth test, its
+// fragment shader writes the color and the normal of the draw.
+//
+// YoshiX cannot read its render targets back, so the regression tool renders
+// the scenes of the examples with this renderer and compares the images to
+// golden images. The images are in the same layout as the render targets:
+// linear colors with four channels, the normal in world space in the first
+// three channels of the normal image, and the hardware depth.
+// -----------------------------------------------------------------------------
+class COffscreenRenderer
+{
+    public:
+
+        COffscreenRenderer();
+
+    public:
+
+        void SetViewport(int _Width, int _Height);
+        void SetDepthRange(float _Near, float _Far, SDepthMode::EMode _Mode);
+
+        void BeginFrame(const float* _pClearColor);
+        void EndFrame();
+
+        // -----------------------------------------------------------------------------
+        // The color is RGBA, colors with an alpha below 1 are blended over the
+        // color target like with alpha blending on the GPU, so they have to be
+        // drawn back to front.
+        // -----------------------------------------------------------------------------
+        void DrawTriangles(const float* _pVertices, int _VertexStride, const int* _pIndices, int _NumberOfIndices, const float* _pWorldViewProjectionMatrix, const float* _pColor, const float* _pNormal);
+
+        CDepthRasterizer& GetDepthRasterizer();                        // For occlusion tests against the drawn triangles.
+
+        filter::SImage GetColorTarget();
+        filter::SImage GetNormalTarget();
+        filter::SImage GetDepthTarget();                                // Valid after 'EndFrame'.
+
+    private:
+
+        static float ShadeFragment(int _X, int _Y, float _Depth, void* _pUserData);
+
+    private:
+
+        CDepthRasterizer m_DepthRasterizer;
+        filter::CImage   m_ColorTarget;
+        filter::CImage   m_NormalTarget;
+        filter::CImage   m_DepthTarget;
+        int              m_Width;                                       // Width of the viewport in pixels.
+        int              m_Height;                                      // Height of the viewport in pixels.
+        const float*     m_pColor;                                      // Color of the current draw.
+        const float*     m_pNormal;                                     // Normal of the current draw.
+};
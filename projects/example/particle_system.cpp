@@ -0,0 +1,636 @@
+#include "particle_system.h"
+
+#include "camera.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#if defined(_MSC_VER) || defined(__SSE2__)
+#define PARTICLE_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace gfx;
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Particles per job. Large enough that a job costs more than stealing it,
+    // small enough that a million particles keep all cores busy.
+    // -----------------------------------------------------------------------------
+    const int s_BlockSize = 16384;
+
+    // -----------------------------------------------------------------------------
+    // Bits of the sort key per radix pass, three passes sort 32 bit keys.
+    // -----------------------------------------------------------------------------
+    const int s_RadixBits   = 11;
+    const int s_RadixSize   = 1 << s_RadixBits;
+    const int s_RadixPasses = 3;
+
+    // -----------------------------------------------------------------------------
+
+    float GetRandomFloat(unsigned int& _rState)
+    {
+        _rState = _rState * 1664525u + 1013904223u;
+
+        return static_cast<float>(_rState >> 8) / 16777216.0f;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Maps the float to an unsigned key with the same order, negative floats have
+    // their bits inverted, positive ones their sign bit set. The key is inverted
+    // again, so the farthest particle comes first.
+    // -----------------------------------------------------------------------------
+    unsigned int GetBackToFrontKey(float _Depth)
+    {
+        unsigned int Bits;
+
+        memcpy(&Bits, &_Depth, sizeof(Bits));
+
+        unsigned int Mask = (Bits & 0x80000000u) != 0 ? 0xFFFFFFFFu : 0x80000000u;
+
+        return ~(Bits ^ Mask);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template<typename TFunction>
+    void ForEachBlock(int _Count, CJobSystem& _rJobSystem, const TFunction& _rFunction)
+    {
+        int NumberOfBlocks = (_Count + s_BlockSize - 1) / s_BlockSize;
+
+        if (NumberOfBlocks <= 1)
+        {
+            _rFunction(0, _Count);
+
+            return;
+        }
+
+        _rJobSystem.ParallelFor(NumberOfBlocks, 1, [&](int _IndexOfBlock)
+        {
+            int First = _IndexOfBlock * s_BlockSize;
+
+            _rFunction(First, std::min(First + s_BlockSize, _Count));
+        });
+    }
+} // namespace
+
+CParticleEmitter::CParticleEmitter()
+    : m_MaximumNumberOfParticles (0)
+    , m_NumberOfParticles        (0)
+    , m_EmissionCarry            (0.0f)
+    , m_RandomState              (1)
+    , m_NumberOfExpandedParticles(0)
+{
+    SParticleEmitterSettings Settings = { { 0.0f, 0.0f, 0.0f }, 0.1f, { 0.0f, 1.0f, 0.0f }, 0.5f, 9.81f, 1.0f, 2.0f, 0.05f, 0.1f, 100.0f, SParticleFacing::Camera };
+
+    m_Settings = Settings;
+}
+
+// -----------------------------------------------------------------------------
+
+CParticleEmitter::~CParticleEmitter()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::SetSettings(const SParticleEmitterSettings& _rSettings)
+{
+    m_Settings = _rSettings;
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::SetMaximumNumberOfParticles(int _NumberOfParticles)
+{
+    // -----------------------------------------------------------------------------
+    // All arrays get their final size here, so neither the update nor the
+    // expansion allocates. The indices of the quads never change.
+    // -----------------------------------------------------------------------------
+    size_t Size = static_cast<size_t>(_NumberOfParticles);
+
+    m_MaximumNumberOfParticles = _NumberOfParticles;
+    m_NumberOfParticles        = std::min(m_NumberOfParticles, _NumberOfParticles);
+
+    m_PositionsX      .resize(Size);
+    m_PositionsY      .resize(Size);
+    m_PositionsZ      .resize(Size);
+    m_VelocitiesX     .resize(Size);
+    m_VelocitiesY     .resize(Size);
+    m_VelocitiesZ     .resize(Size);
+    m_Ages            .resize(Size);
+    m_InverseLifetimes.resize(Size);
+
+    m_SortKeys         .resize(Size);
+    m_SortScratchKeys  .resize(Size);
+    m_Order            .resize(Size);
+    m_SortScratchOrder .resize(Size);
+    m_SortScratchValues.resize(Size);
+    m_Histograms       .resize(s_RadixPasses * s_RadixSize);
+
+    m_Vertices.resize(Size * 4 * s_NumberOfFloatsPerVertex);
+    m_Indices .resize(Size * 6);
+
+    for (int IndexOfParticle = 0; IndexOfParticle < _NumberOfParticles; ++ IndexOfParticle)
+    {
+        int* pIndices = &m_Indices[static_cast<size_t>(IndexOfParticle) * 6];
+        int  First    = IndexOfParticle * 4;
+
+        pIndices[0] = First + 0;
+        pIndices[1] = First + 1;
+        pIndices[2] = First + 2;
+        pIndices[3] = First + 0;
+        pIndices[4] = First + 2;
+        pIndices[5] = First + 3;
+    }
+
+    m_NumberOfExpandedParticles = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Clear()
+{
+    m_NumberOfParticles         = 0;
+    m_EmissionCarry             = 0.0f;
+    m_NumberOfExpandedParticles = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int CParticleEmitter::GetNumberOfParticles() const
+{
+    return m_NumberOfParticles;
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Update(float _StepTime)
+{
+    IntegrateRange(_StepTime, 0, m_NumberOfParticles);
+
+    Kill();
+    Emit(_StepTime);
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Update(float _StepTime, CJobSystem& _rJobSystem)
+{
+    ForEachBlock(m_NumberOfParticles, _rJobSystem, [&](int _First, int _Last)
+    {
+        IntegrateRange(_StepTime, _First, _Last);
+    });
+
+    Kill();
+    Emit(_StepTime);
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Sort(const SCameraSnapshot& _rCamera)
+{
+    GetSortKeysRange(_rCamera, 0, m_NumberOfParticles);
+
+    RadixSort();
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Sort(const SCameraSnapshot& _rCamera, CJobSystem& _rJobSystem)
+{
+    ForEachBlock(m_NumberOfParticles, _rJobSystem, [&](int _First, int _Last)
+    {
+        GetSortKeysRange(_rCamera, _First, _Last);
+    });
+
+    RadixSort();
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Expand(const SCameraSnapshot& _rCamera)
+{
+    m_NumberOfExpandedParticles = m_NumberOfParticles;
+
+    ExpandRange(_rCamera, 0, m_NumberOfParticles);
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Expand(const SCameraSnapshot& _rCamera, CJobSystem& _rJobSystem)
+{
+    m_NumberOfExpandedParticles = m_NumberOfParticles;
+
+    ForEachBlock(m_NumberOfParticles, _rJobSystem, [&](int _First, int _Last)
+    {
+        ExpandRange(_rCamera, _First, _Last);
+    });
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::GetMeshInfo(BHandle _pMaterial, SMeshInfo& _rMeshInfo)
+{
+    _rMeshInfo.m_pVertices        = m_Vertices.data();
+    _rMeshInfo.m_NumberOfVertices = m_NumberOfExpandedParticles * 4;
+    _rMeshInfo.m_pIndices         = m_Indices.data();
+    _rMeshInfo.m_NumberOfIndices  = m_NumberOfExpandedParticles * 6;
+    _rMeshInfo.m_pMaterial        = _pMaterial;
+}
+
+// -----------------------------------------------------------------------------
+
+const float* CParticleEmitter::GetPositionsX() const
+{
+    return m_PositionsX.data();
+}
+
+// -----------------------------------------------------------------------------
+
+const float* CParticleEmitter::GetPositionsY() const
+{
+    return m_PositionsY.data();
+}
+
+// -----------------------------------------------------------------------------
+
+const float* CParticleEmitter::GetPositionsZ() const
+{
+    return m_PositionsZ.data();
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Kill()
+{
+    // -----------------------------------------------------------------------------
+    // Move the last particle into the place of a dead one and test the moved one
+    // again. The order of the particles does not matter, they are sorted anyway.
+    // -----------------------------------------------------------------------------
+    int IndexOfParticle = 0;
+
+    while (IndexOfParticle < m_NumberOfParticles)
+    {
+        if (m_Ages[IndexOfParticle] * m_InverseLifetimes[IndexOfParticle] < 1.0f)
+        {
+            ++ IndexOfParticle;
+
+            continue;
+        }
+
+        int IndexOfLast = -- m_NumberOfParticles;
+
+        m_PositionsX      [IndexOfParticle] = m_PositionsX      [IndexOfLast];
+        m_PositionsY      [IndexOfParticle] = m_PositionsY      [IndexOfLast];
+        m_PositionsZ      [IndexOfParticle] = m_PositionsZ      [IndexOfLast];
+        m_VelocitiesX     [IndexOfParticle] = m_VelocitiesX     [IndexOfLast];
+        m_VelocitiesY     [IndexOfParticle] = m_VelocitiesY     [IndexOfLast];
+        m_VelocitiesZ     [IndexOfParticle] = m_VelocitiesZ     [IndexOfLast];
+        m_Ages            [IndexOfParticle] = m_Ages            [IndexOfLast];
+        m_InverseLifetimes[IndexOfParticle] = m_InverseLifetimes[IndexOfLast];
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Emit(float _StepTime)
+{
+    float Count = m_Settings.m_EmissionRate * _StepTime + m_EmissionCarry;
+
+    int NumberOfNewParticles = static_cast<int>(Count);
+
+    m_EmissionCarry = Count - static_cast<float>(NumberOfNewParticles);
+
+    NumberOfNewParticles = std::min(NumberOfNewParticles, m_MaximumNumberOfParticles - m_NumberOfParticles);
+
+    for (int IndexOfNewParticle = 0; IndexOfNewParticle < NumberOfNewParticles; ++ IndexOfNewParticle)
+    {
+        int IndexOfParticle = m_NumberOfParticles ++;
+
+        // A random point in the unit sphere, about half of the points in the cube are inside
+        float Offset[3];
+
+        do
+        {
+            Offset[0] = GetRandomFloat(m_RandomState) * 2.0f - 1.0f;
+            Offset[1] = GetRandomFloat(m_RandomState) * 2.0f - 1.0f;
+            Offset[2] = GetRandomFloat(m_RandomState) * 2.0f - 1.0f;
+        }
+        while (Offset[0] * Offset[0] + Offset[1] * Offset[1] + Offset[2] * Offset[2] > 1.0f);
+
+        float Lifetime = m_Settings.m_MinimumLifetime + (m_Settings.m_MaximumLifetime - m_Settings.m_MinimumLifetime) * GetRandomFloat(m_RandomState);
+
+        m_PositionsX      [IndexOfParticle] = m_Settings.m_Position[0] + Offset[0] * m_Settings.m_Radius;
+        m_PositionsY      [IndexOfParticle] = m_Settings.m_Position[1] + Offset[1] * m_Settings.m_Radius;
+        m_PositionsZ      [IndexOfParticle] = m_Settings.m_Position[2] + Offset[2] * m_Settings.m_Radius;
+        m_VelocitiesX     [IndexOfParticle] = m_Settings.m_Velocity[0] + (GetRandomFloat(m_RandomState) * 2.0f - 1.0f) * m_Settings.m_VelocitySpread;
+        m_VelocitiesY     [IndexOfParticle] = m_Settings.m_Velocity[1] + (GetRandomFloat(m_RandomState) * 2.0f - 1.0f) * m_Settings.m_VelocitySpread;
+        m_VelocitiesZ     [IndexOfParticle] = m_Settings.m_Velocity[2] + (GetRandomFloat(m_RandomState) * 2.0f - 1.0f) * m_Settings.m_VelocitySpread;
+        m_Ages            [IndexOfParticle] = 0.0f;
+        m_InverseLifetimes[IndexOfParticle] = Lifetime > 0.0f ? 1.0f / Lifetime : 3.402823466e+38f;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::IntegrateRange(float _StepTime, int _First, int _Last)
+{
+    // -----------------------------------------------------------------------------
+    // Semi-implicit Euler: the gravity changes the velocity first, the new
+    // velocity moves the particle.
+    // -----------------------------------------------------------------------------
+    float* pPositionsX  = m_PositionsX .data();
+    float* pPositionsY  = m_PositionsY .data();
+    float* pPositionsZ  = m_PositionsZ .data();
+    float* pVelocitiesX = m_VelocitiesX.data();
+    float* pVelocitiesY = m_VelocitiesY.data();
+    float* pVelocitiesZ = m_VelocitiesZ.data();
+    float* pAges        = m_Ages       .data();
+
+    float VelocityChange = m_Settings.m_Gravity * _StepTime;
+
+    int Index = _First;
+
+#if defined(PARTICLE_SSE)
+    __m128 StepTime        = _mm_set1_ps(_StepTime);
+    __m128 VelocityChangeY = _mm_set1_ps(VelocityChange);
+
+    for (; Index + 4 <= _Last; Index += 4)
+    {
+        __m128 VelocityY = _mm_sub_ps(_mm_loadu_ps(pVelocitiesY + Index), VelocityChangeY);
+
+        _mm_storeu_ps(pVelocitiesY + Index, VelocityY);
+
+        _mm_storeu_ps(pPositionsX + Index, _mm_add_ps(_mm_loadu_ps(pPositionsX + Index), _mm_mul_ps(_mm_loadu_ps(pVelocitiesX + Index), StepTime)));
+        _mm_storeu_ps(pPositionsY + Index, _mm_add_ps(_mm_loadu_ps(pPositionsY + Index), _mm_mul_ps(VelocityY, StepTime)));
+        _mm_storeu_ps(pPositionsZ + Index, _mm_add_ps(_mm_loadu_ps(pPositionsZ + Index), _mm_mul_ps(_mm_loadu_ps(pVelocitiesZ + Index), StepTime)));
+        _mm_storeu_ps(pAges       + Index, _mm_add_ps(_mm_loadu_ps(pAges + Index), StepTime));
+    }
+#endif
+
+    for (; Index < _Last; ++ Index)
+    {
+        pVelocitiesY[Index] -= VelocityChange;
+
+        pPositionsX[Index] += pVelocitiesX[Index] * _StepTime;
+        pPositionsY[Index] += pVelocitiesY[Index] * _StepTime;
+        pPositionsZ[Index] += pVelocitiesZ[Index] * _StepTime;
+        pAges      [Index] += _StepTime;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::GetSortKeysRange(const SCameraSnapshot& _rCamera, int _First, int _Last)
+{
+    // -----------------------------------------------------------------------------
+    // The depth is the distance along the view direction, the third row of the
+    // inverse view matrix. The offset to the eye is folded into one constant.
+    // -----------------------------------------------------------------------------
+    const float* pForward = &_rCamera.m_InverseViewMatrix[8];
+
+    float Offset = -(pForward[0] * _rCamera.m_EyePosition[0] + pForward[1] * _rCamera.m_EyePosition[1] + pForward[2] * _rCamera.m_EyePosition[2]);
+
+    const float*  pPositionsX = m_PositionsX.data();
+    const float*  pPositionsY = m_PositionsY.data();
+    const float*  pPositionsZ = m_PositionsZ.data();
+    unsigned int* pKeys       = m_SortKeys  .data();
+
+    int Index = _First;
+
+#if defined(PARTICLE_SSE)
+    __m128  ForwardX = _mm_set1_ps(pForward[0]);
+    __m128  ForwardY = _mm_set1_ps(pForward[1]);
+    __m128  ForwardZ = _mm_set1_ps(pForward[2]);
+    __m128  Offsets  = _mm_set1_ps(Offset);
+    __m128i SignBit  = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    __m128i AllBits  = _mm_set1_epi32(-1);
+
+    for (; Index + 4 <= _Last; Index += 4)
+    {
+        __m128 Depth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pPositionsX + Index), ForwardX), _mm_mul_ps(_mm_loadu_ps(pPositionsY + Index), ForwardY)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pPositionsZ + Index), ForwardZ), Offsets));
+
+        // Same as 'GetBackToFrontKey': all bits or only the sign bit are flipped, then all of them
+        __m128i Bits = _mm_castps_si128(Depth);
+        __m128i Mask = _mm_or_si128(_mm_srai_epi32(Bits, 31), SignBit);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pKeys + Index), _mm_xor_si128(_mm_xor_si128(Bits, Mask), AllBits));
+    }
+#endif
+
+    for (; Index < _Last; ++ Index)
+    {
+        float Depth = pPositionsX[Index] * pForward[0] + pPositionsY[Index] * pForward[1] + pPositionsZ[Index] * pForward[2] + Offset;
+
+        pKeys[Index] = GetBackToFrontKey(Depth);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::RadixSort()
+{
+    // -----------------------------------------------------------------------------
+    // Least significant digit first. The histograms of all passes are counted in
+    // one run over the keys, each pass then scatters keys and indices into the
+    // scratch arrays and the arrays are swapped.
+    // -----------------------------------------------------------------------------
+    int NumberOfParticles = m_NumberOfParticles;
+
+    m_Histograms.assign(s_RadixPasses * s_RadixSize, 0);
+
+    for (int Index = 0; Index < NumberOfParticles; ++ Index)
+    {
+        unsigned int Key = m_SortKeys[Index];
+
+        m_Order[Index] = Index;
+
+        for (int Pass = 0; Pass < s_RadixPasses; ++ Pass)
+        {
+            ++ m_Histograms[Pass * s_RadixSize + ((Key >> (Pass * s_RadixBits)) & (s_RadixSize - 1))];
+        }
+    }
+
+    for (int Pass = 0; Pass < s_RadixPasses; ++ Pass)
+    {
+        int* pHistogram = &m_Histograms[Pass * s_RadixSize];
+        int  Sum        = 0;
+
+        for (int Digit = 0; Digit < s_RadixSize; ++ Digit)
+        {
+            int Count = pHistogram[Digit];
+
+            pHistogram[Digit] = Sum;
+
+            Sum += Count;
+        }
+
+        int Shift = Pass * s_RadixBits;
+
+        for (int Index = 0; Index < NumberOfParticles; ++ Index)
+        {
+            unsigned int Key   = m_SortKeys[Index];
+            int          Place = pHistogram[(Key >> Shift) & (s_RadixSize - 1)] ++;
+
+            m_SortScratchKeys [Place] = Key;
+            m_SortScratchOrder[Place] = m_Order[Index];
+        }
+
+        m_SortKeys.swap(m_SortScratchKeys);
+        m_Order   .swap(m_SortScratchOrder);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The particles themselves are moved into the new order, so the expansion
+    // reads them one after the other. From one frame to the next the order
+    // hardly changes, so these reads are nearly sequential as well.
+    // -----------------------------------------------------------------------------
+    Reorder(m_PositionsX);
+    Reorder(m_PositionsY);
+    Reorder(m_PositionsZ);
+    Reorder(m_VelocitiesX);
+    Reorder(m_VelocitiesY);
+    Reorder(m_VelocitiesZ);
+    Reorder(m_Ages);
+    Reorder(m_InverseLifetimes);
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::Reorder(std::vector<float>& _rValues)
+{
+    for (int Index = 0; Index < m_NumberOfParticles; ++ Index)
+    {
+        m_SortScratchValues[Index] = _rValues[m_Order[Index]];
+    }
+
+    _rValues.swap(m_SortScratchValues);
+}
+
+// -----------------------------------------------------------------------------
+
+void CParticleEmitter::ExpandRange(const SCameraSnapshot& _rCamera, int _First, int _Last)
+{
+    // -----------------------------------------------------------------------------
+    // The corners are the same as in 'GetBillboardCorners' of the example: the
+    // quad spans from -1 to 1 along its x and y axis. Facing the camera these
+    // are the first two rows of the inverse view matrix. Turned around y only,
+    // x is perpendicular to the direction from the eye in the ground plane,
+    // which differs per particle like the rotation in 'billboard.fx'.
+    // -----------------------------------------------------------------------------
+    static const float s_Corners[4][4] =
+    {
+        { -1.0f, -1.0f, 0.0f, 1.0f },
+        {  1.0f, -1.0f, 1.0f, 1.0f },
+        {  1.0f,  1.0f, 1.0f, 0.0f },
+        { -1.0f,  1.0f, 0.0f, 0.0f },
+    };
+
+    const float* pRight = &_rCamera.m_InverseViewMatrix[0];
+    const float* pUp    = &_rCamera.m_InverseViewMatrix[4];
+    const float* pEye   = _rCamera.m_EyePosition;
+
+    bool IsYawFacing = m_Settings.m_Facing == SParticleFacing::Yaw;
+
+    float SizeChange = m_Settings.m_EndSize - m_Settings.m_StartSize;
+
+    for (int First = _First; First < _Last; First += 4)
+    {
+        int Count = std::min(_Last - First, 4);
+
+        // Four particles at once, missing ones at the end repeat the last
+        alignas(16) float PositionsX[4];
+        alignas(16) float PositionsY[4];
+        alignas(16) float PositionsZ[4];
+        alignas(16) float Progress  [4];
+        alignas(16) float Sizes     [4];
+        alignas(16) float RightsX   [4];
+        alignas(16) float RightsZ   [4];
+
+        for (int Lane = 0; Lane < 4; ++ Lane)
+        {
+            int IndexOfParticle = First + std::min(Lane, Count - 1);
+
+            PositionsX[Lane] = m_PositionsX[IndexOfParticle];
+            PositionsY[Lane] = m_PositionsY[IndexOfParticle];
+            PositionsZ[Lane] = m_PositionsZ[IndexOfParticle];
+            Progress  [Lane] = m_Ages[IndexOfParticle] * m_InverseLifetimes[IndexOfParticle];
+        }
+
+#if defined(PARTICLE_SSE)
+        __m128 Size = _mm_add_ps(_mm_set1_ps(m_Settings.m_StartSize), _mm_mul_ps(_mm_set1_ps(SizeChange), _mm_min_ps(_mm_load_ps(Progress), _mm_set1_ps(1.0f))));
+
+        _mm_store_ps(Sizes, Size);
+
+        if (IsYawFacing)
+        {
+            __m128 DirectionX = _mm_sub_ps(_mm_load_ps(PositionsX), _mm_set1_ps(pEye[0]));
+            __m128 DirectionZ = _mm_sub_ps(_mm_load_ps(PositionsZ), _mm_set1_ps(pEye[2]));
+            __m128 Length     = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(DirectionX, DirectionX), _mm_mul_ps(DirectionZ, DirectionZ)));
+
+            // A particle right above or below the eye keeps an unnormalized zero vector
+            __m128 Scale = _mm_and_ps(_mm_div_ps(Size, Length), _mm_cmpgt_ps(Length, _mm_setzero_ps()));
+
+            // x = cross(y, z) with y = (0, 1, 0)
+            _mm_store_ps(RightsX, _mm_mul_ps(DirectionZ, Scale));
+            _mm_store_ps(RightsZ, _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(DirectionX, Scale)));
+        }
+#else
+        for (int Lane = 0; Lane < 4; ++ Lane)
+        {
+            Sizes[Lane] = m_Settings.m_StartSize + SizeChange * std::min(Progress[Lane], 1.0f);
+
+            if (IsYawFacing)
+            {
+                float DirectionX = PositionsX[Lane] - pEye[0];
+                float DirectionZ = PositionsZ[Lane] - pEye[2];
+                float Length     = sqrtf(DirectionX * DirectionX + DirectionZ * DirectionZ);
+                float Scale      = Length > 0.0f ? Sizes[Lane] / Length : 0.0f;
+
+                RightsX[Lane] =  DirectionZ * Scale;
+                RightsZ[Lane] = -DirectionX * Scale;
+            }
+        }
+#endif
+
+        for (int Lane = 0; Lane < Count; ++ Lane)
+        {
+            float Right[3];
+            float Up   [3];
+
+            if (IsYawFacing)
+            {
+                Right[0] = RightsX[Lane]; Right[1] = 0.0f;        Right[2] = RightsZ[Lane];
+                Up   [0] = 0.0f;          Up   [1] = Sizes[Lane]; Up   [2] = 0.0f;
+            }
+            else
+            {
+                for (int Axis = 0; Axis < 3; ++ Axis)
+                {
+                    Right[Axis] = pRight[Axis] * Sizes[Lane];
+                    Up   [Axis] = pUp   [Axis] * Sizes[Lane];
+                }
+            }
+
+            float* pVertex = &m_Vertices[static_cast<size_t>(First + Lane) * 4 * s_NumberOfFloatsPerVertex];
+
+            for (int IndexOfCorner = 0; IndexOfCorner < 4; ++ IndexOfCorner)
+            {
+                const float* pCorner = s_Corners[IndexOfCorner];
+
+                pVertex[0] = PositionsX[Lane] + pCorner[0] * Right[0] + pCorner[1] * Up[0];
+                pVertex[1] = PositionsY[Lane] + pCorner[0] * Right[1] + pCorner[1] * Up[1];
+                pVertex[2] = PositionsZ[Lane] + pCorner[0] * Right[2] + pCorner[1] * Up[2];
+                pVertex[3] = pCorner[2];
+                pVertex[4] = pCorner[3];
+
+                pVertex += s_NumberOfFloatsPerVertex;
+            }
+        }
+    }
+}
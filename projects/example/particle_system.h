@@ -0,0 +1,142 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include <vector>
+
+class  CJobSystem;
+struct SCameraSnapshot;
+
+// -----------------------------------------------------------------------------
+
+struct SParticleFacing
+{
+    enum EFacing
+    {
+        Camera,                                                         ///< Parallel to the image plane, e.g. smoke and sparks.
+        Yaw,                                                            ///< Turned around the y axis only like the billboards in 'billboard.fx', e.g. leaves and grass.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// The particles are emitted at random positions in a sphere around the
+// position of the emitter with the velocity plus a random part in each
+// direction. They fall with the gravity and grow from the start to the end
+// size during their lifetime.
+// -----------------------------------------------------------------------------
+struct SParticleEmitterSettings
+{
+    float                    m_Position[3];
+    float                    m_Radius;
+    float                    m_Velocity[3];
+    float                    m_VelocitySpread;                          // Largest random part of the velocity in each direction.
+    float                    m_Gravity;                                 // Acceleration along -y in units per second squared.
+    float                    m_MinimumLifetime;                         // Seconds.
+    float                    m_MaximumLifetime;
+    float                    m_StartSize;                               // Half the edge length of the quad.
+    float                    m_EndSize;
+    float                    m_EmissionRate;                            // Particles per second.
+    SParticleFacing::EFacing m_Facing;
+};
+
+// -----------------------------------------------------------------------------
+// One emitter of a CPU particle system. The particles are kept in separate
+// dense arrays per attribute, so the update integrates four particles at once
+// with SSE and blocks of particles run as jobs. Dead particles are replaced by
+// the last living one, so the arrays never have holes.
+//
+// Each frame the living particles are sorted back to front for blending and
+// expanded into camera facing quads with position and texture coordinates in
+// world space, the vertex layout of 'textured.fx' with the identity as world
+// matrix. YoshiX meshes cannot be changed after they were created, so all
+// quads of the emitter go into one mesh, see 'GetMeshInfo', which is drawn
+// with a single call.
+// -----------------------------------------------------------------------------
+class CParticleEmitter
+{
+    public:
+
+        static const int s_NumberOfFloatsPerVertex = 5;
+
+    public:
+
+        CParticleEmitter();
+        ~CParticleEmitter();
+
+    public:
+
+        void SetSettings(const SParticleEmitterSettings& _rSettings);
+        void SetMaximumNumberOfParticles(int _NumberOfParticles);      // Emission stops while the emitter is full.
+        void Clear();
+
+        int  GetNumberOfParticles() const;
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Moves the particles one step forward, removes those which reached their
+        // lifetime, and emits the new ones of the step. The second version
+        // integrates blocks of particles as jobs.
+        // -----------------------------------------------------------------------------
+        void Update(float _StepTime);
+        void Update(float _StepTime, CJobSystem& _rJobSystem);
+
+        // -----------------------------------------------------------------------------
+        // Sorts the particles back to front along the view direction of the camera
+        // with a radix sort of their depths and moves them into this order.
+        // -----------------------------------------------------------------------------
+        void Sort(const SCameraSnapshot& _rCamera);
+        void Sort(const SCameraSnapshot& _rCamera, CJobSystem& _rJobSystem);
+
+        // -----------------------------------------------------------------------------
+        // Writes four vertices per particle in the order of the arrays, which is
+        // back to front after 'Sort'. The second version expands blocks of
+        // particles as jobs.
+        // -----------------------------------------------------------------------------
+        void Expand(const SCameraSnapshot& _rCamera);
+        void Expand(const SCameraSnapshot& _rCamera, CJobSystem& _rJobSystem);
+
+        void GetMeshInfo(gfx::BHandle _pMaterial, gfx::SMeshInfo& _rMeshInfo);
+
+        const float* GetPositionsX() const;
+        const float* GetPositionsY() const;
+        const float* GetPositionsZ() const;
+
+    private:
+
+        SParticleEmitterSettings  m_Settings;
+        int                       m_MaximumNumberOfParticles;
+        int                       m_NumberOfParticles;
+        float                     m_EmissionCarry;                      // Fraction of a particle left over from the last steps.
+        unsigned int              m_RandomState;
+
+        std::vector<float>        m_PositionsX;                         // Dense, one entry per particle.
+        std::vector<float>        m_PositionsY;
+        std::vector<float>        m_PositionsZ;
+        std::vector<float>        m_VelocitiesX;
+        std::vector<float>        m_VelocitiesY;
+        std::vector<float>        m_VelocitiesZ;
+        std::vector<float>        m_Ages;
+        std::vector<float>        m_InverseLifetimes;                   // The age times the inverse lifetime is the progress from 0 to 1.
+
+        std::vector<unsigned int> m_SortKeys;
+        std::vector<unsigned int> m_SortScratchKeys;
+        std::vector<int>          m_Order;                              // Indices of the particles back to front.
+        std::vector<int>          m_SortScratchOrder;
+        std::vector<float>        m_SortScratchValues;
+        std::vector<int>          m_Histograms;                         // One per radix pass.
+
+        std::vector<float>        m_Vertices;
+        std::vector<int>          m_Indices;
+        int                       m_NumberOfExpandedParticles;
+
+    private:
+
+        void Kill();
+        void Emit(float _StepTime);
+        void IntegrateRange(float _StepTime, int _First, int _Last);
+        void GetSortKeysRange(const SCameraSnapshot& _rCamera, int _First, int _Last);
+        void RadixSort();
+        void Reorder(std::vector<float>& _rValues);
+        void ExpandRange(const SCameraSnapshot& _rCamera, int _First, int _Last);
+};
@@ -1,6 +1,17 @@
 
 #include "yoshix.h"
 
+#include "camera.h"
+#include "dynamic_resolution.h"
+#include "fixed_step.h"
+#include "frame_statistics.h"
+#include "gbuffer_layout.h"
+#include "log.h"
+#include "post_effect_scene.h"
+#include "post_processing.h"
+#include "transform_hierarchy.h"
+
+#include <algorithm>
 #include <math.h>
 
 using namespace gfx;
@@ -16,7 +27,7 @@ struct SVertexBuffer
 
 struct SPixelBuffer
 {
-    float m_NearFar[4];                     // Near and far distance of the view frustum, the other two components are wasted.
+    float m_NearFar[4];                     // Near and far distance of the view frustum, the normal encoding, and the material index.
 };
 
 // -----------------------------------------------------------------------------
@@ -34,10 +45,14 @@ class CApplication : public IApplication
         float   m_Far;                      // Far distance of the view frustum-
         float   m_FieldOfViewY;             // Vertical view angle of the camera
 
-        float   m_AngleY;                   // The rotation angle of the mesh around the y-axis.
+        float   m_AngleY;                   // The rotation angle of the mesh around the y-axis, blended from the animation.
 
-        float   m_ViewMatrix[16];           // The view matrix to transform a mesh from world space into view space.
-        float   m_ProjectionMatrix[16];     // The projection matrix to transform a mesh from view space into clip space.
+        TFixedStepLoop<float> m_Animation;  // Advances the angle at a fixed rate, independent of the frame rate.
+
+        CTransformHierarchy m_Transforms;   // The world matrices of the scene.
+        int     m_IndexOfCubeNode;          // The node of the cube in the transform hierarchy.
+
+        CCamera m_Camera;                   // Caches the view and projection matrices, which only change with the window size here.
 
         BHandle m_pDepthTarget;             // The depth render target of the GBuffer.
         BHandle m_pNormalTarget;            // The normal render target of the GBuffer.
@@ -52,6 +67,16 @@ class CApplication : public IApplication
         BHandle m_pGBufferMaterial;         // A material which uses the GBuffer vertex and pixel shader to fill the GBuffer.
         BHandle m_pGBufferMesh;             // The cube with GBuffer material.
 
+        BHandle m_pCompactVertexShader;     // A vertex shader to write the compact GBuffer.
+        BHandle m_pCompactPixelShader;      // A pixel shader to write material color and octahedral normal at once.
+        BHandle m_pCompactMaterial;         // A material which uses the compact GBuffer shaders.
+        BHandle m_pCompactMesh;             // The cube with compact GBuffer material.
+
+        SGBufferLayout::ELayout    m_GBufferLayout;     // The layout of the GBuffer.
+        SNormalEncoding::EEncoding m_NormalEncoding;    // The normal encoding of the compact GBuffer.
+        int     m_Width;                    // Width of the render targets in pixels.
+        int     m_Height;                   // Height of the render targets in pixels.
+
         BHandle m_pTexture;                 // A texture to cover the cube.
         BHandle m_pVertexShader;            // A vertex shader to draw the textured cube.
         BHandle m_pPixelShader;             // A pixel shader to draw the textured cube.
@@ -63,6 +88,15 @@ class CApplication : public IApplication
         BHandle m_pPostMaterial;            // A material using the post effect shader.
         BHandle m_pPostMesh;                // A single quad.
 
+        CPostProcessing m_PostProcessing;   // Edge detection, fog, and ambient occlusion at reduced resolution.
+        bool    m_IsPostProcessingEnabled;  // True if the post processing chain replaces the monolithic post shader.
+
+        CDynamicResolution m_DynamicResolution; // Scales the part of the targets the scene is rendered to, so the frame time stays in the budget.
+        bool    m_IsDynamicResolutionEnabled;   // True if the scene is rendered at the scale of the controller.
+        bool    m_HasFrameTime;             // False for the first frame after dynamic resolution was switched on.
+        int     m_IndexOfBudget;            // One of the budgets 'B' cycles through.
+        CStopwatch m_FrameStopwatch;        // Measures the time between two frames for the controller.
+
     private:
 
         virtual bool InternOnCreateTextures();
@@ -76,17 +110,23 @@ class CApplication : public IApplication
         virtual bool InternOnCreateMeshes();
         virtual bool InternOnReleaseMeshes();
         virtual bool InternOnResize(int _Width, int _Height);
+        virtual bool InternOnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown);
         virtual bool InternOnUpdate();
         virtual bool InternOnFrame();
+
+    private:
+
+        static void StepAnimation(float& _rAngleY, float _StepTime, void* _pUserData);
 };
 
 // -----------------------------------------------------------------------------
 
 CApplication::CApplication()
-    : m_Near                 (0.1f)
-    , m_Far                  (20.0f)
-    , m_FieldOfViewY         (60.0f)
+    : m_Near                 (post_effect_scene::s_Near)
+    , m_Far                  (post_effect_scene::s_Far)
+    , m_FieldOfViewY         (post_effect_scene::s_FieldOfViewY)
     , m_AngleY               (0.0f)
+    , m_IndexOfCubeNode      (-1)
     , m_pDepthTarget         (nullptr)
     , m_pNormalTarget        (nullptr)
     , m_pColorTarget         (nullptr)
@@ -96,6 +136,14 @@ CApplication::CApplication()
     , m_pGBufferPixelShader  (nullptr)
     , m_pGBufferMaterial     (nullptr)
     , m_pGBufferMesh         (nullptr)
+    , m_pCompactVertexShader (nullptr)
+    , m_pCompactPixelShader  (nullptr)
+    , m_pCompactMaterial     (nullptr)
+    , m_pCompactMesh         (nullptr)
+    , m_GBufferLayout        (SGBufferLayout::Standard)
+    , m_NormalEncoding       (SNormalEncoding::Float3)
+    , m_Width                (1)
+    , m_Height               (1)
     , m_pPostVertexShader    (nullptr)
     , m_pPostPixelShader     (nullptr)
     , m_pPostMaterial        (nullptr)
@@ -105,7 +153,20 @@ CApplication::CApplication()
     , m_pPixelShader         (nullptr)
     , m_pMaterial            (nullptr)
     , m_pMesh                (nullptr)
+    , m_IsPostProcessingEnabled(true)
+    , m_IsDynamicResolutionEnabled(false)
+    , m_HasFrameTime         (false)
+    , m_IndexOfBudget        (0)
 {
+    m_PostProcessing.AddEffect("PSEdgeDetection"   , SPostResolution::Half);
+    m_PostProcessing.AddEffect("PSFog"             , SPostResolution::Quarter);
+    m_PostProcessing.AddEffect("PSAmbientOcclusion", SPostResolution::Half);
+
+    STransform CubeTransform = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+
+    m_IndexOfCubeNode = m_Transforms.AddNode(-1, CubeTransform);
+
+    m_Animation.Start(m_AngleY, 60.0f, &StepAnimation, nullptr);
 }
 
 // -----------------------------------------------------------------------------
@@ -129,6 +190,8 @@ bool CApplication::InternOnCreateTextures()
 
     CreateTexture("..\\data\\images\\cube.dds", &m_pTexture);
 
+    m_PostProcessing.CreateTextures();
+
     return true;
 }
 
@@ -141,6 +204,8 @@ bool CApplication::InternOnReleaseTextures()
     ReleaseTexture(m_pColorTarget);
     ReleaseTexture(m_pTexture);
 
+    m_PostProcessing.ReleaseTextures();
+
     return true;
 }
 
@@ -151,6 +216,8 @@ bool CApplication::InternOnCreateConstantBuffers()
     CreateConstantBuffer(sizeof(SVertexBuffer), &m_pVertexConstantBuffer);
     CreateConstantBuffer(sizeof(SPixelBuffer ), &m_pPixelConstantBuffer);
 
+    m_PostProcessing.CreateConstantBuffers();
+
     return true;
 }
 
@@ -161,6 +228,8 @@ bool CApplication::InternOnReleaseConstantBuffers()
     ReleaseConstantBuffer(m_pVertexConstantBuffer);
     ReleaseConstantBuffer(m_pPixelConstantBuffer);
 
+    m_PostProcessing.ReleaseConstantBuffers();
+
     return true;
 }
 
@@ -174,6 +243,10 @@ bool CApplication::InternOnCreateShader()
     CreatePixelShader ("..\\data\\shader\\post_effect.fx", "PSShader"       , &m_pPixelShader);
     CreateVertexShader("..\\data\\shader\\post_effect.fx", "VSPostShader"   , &m_pPostVertexShader);
     CreatePixelShader ("..\\data\\shader\\post_effect.fx", "PSPostShader"   , &m_pPostPixelShader);
+    CreateVertexShader("..\\data\\shader\\gbuffer.fx"    , "VSGBufferShader", &m_pCompactVertexShader);
+    CreatePixelShader ("..\\data\\shader\\gbuffer.fx"    , "PSGBufferShader", &m_pCompactPixelShader);
+
+    m_PostProcessing.CreateShader();
 
     return true;
 }
@@ -188,6 +261,10 @@ bool CApplication::InternOnReleaseShader()
     ReleasePixelShader (m_pPixelShader);
     ReleaseVertexShader(m_pPostVertexShader);
     ReleasePixelShader (m_pPostPixelShader);
+    ReleaseVertexShader(m_pCompactVertexShader);
+    ReleasePixelShader (m_pCompactPixelShader);
+
+    m_PostProcessing.ReleaseShader();
 
     return true;
 }
@@ -239,6 +316,18 @@ bool CApplication::InternOnCreateMaterials()
 
     CreateMaterial(MaterialInfo, &m_pMaterial);
 
+    // -----------------------------------------------------------------------------
+    // Material to render the cube into the compact GBuffer. It writes the color of
+    // the standard material and the normal in one pass, the pixel buffer passes
+    // the normal encoding and the material index.
+    // -----------------------------------------------------------------------------
+    MaterialInfo.m_NumberOfPixelConstantBuffers  = 1;
+    MaterialInfo.m_pPixelConstantBuffers[0]      = m_pPixelConstantBuffer;
+    MaterialInfo.m_pVertexShader                 = m_pCompactVertexShader;
+    MaterialInfo.m_pPixelShader                  = m_pCompactPixelShader;
+
+    CreateMaterial(MaterialInfo, &m_pCompactMaterial);
+
     // -----------------------------------------------------------------------------
     // Material to render the post effect. Note that this material has the three
     // render targets as texture input. The pixel shader of the post effect is able
@@ -261,6 +350,11 @@ bool CApplication::InternOnCreateMaterials()
 
     CreateMaterial(MaterialInfo, &m_pPostMaterial);
 
+    // -----------------------------------------------------------------------------
+    // The post processing chain uses the same GBuffer and color target.
+    // -----------------------------------------------------------------------------
+    m_PostProcessing.CreateMaterials(m_pDepthTarget, m_pColorTarget, m_pNormalTarget);
+
     return true;
 }
 
@@ -271,6 +365,9 @@ bool CApplication::InternOnReleaseMaterials()
     ReleaseMaterial(m_pGBufferMaterial);
     ReleaseMaterial(m_pMaterial);
     ReleaseMaterial(m_pPostMaterial);
+    ReleaseMaterial(m_pCompactMaterial);
+
+    m_PostProcessing.ReleaseMaterials();
 
     return true;
 }
@@ -281,9 +378,9 @@ bool CApplication::InternOnCreateMeshes()
 {
     // -----------------------------------------------------------------------------
     // The cube as interleaved array with position, normal, and texture coordinates.
+    // The positions and normals are the ones of the regression tool, the texture
+    // coordinates pick the faces of the cube texture.
     // -----------------------------------------------------------------------------
-    const float HalfEdgeLength = 2.0f;
-
     float U[] =
     {
         0.0f / 4.0f,
@@ -301,39 +398,29 @@ bool CApplication::InternOnCreateMeshes()
         0.0f / 3.0f,
     };
 
-    float CubeVertices[][8] =
+    int CubeTexCoords[post_effect_scene::s_NumberOfVertices][2] =
     {
-        { -HalfEdgeLength, -HalfEdgeLength, -HalfEdgeLength,  0.0f,  0.0f, -1.0f, U[1], V[1], },
-        {  HalfEdgeLength, -HalfEdgeLength, -HalfEdgeLength,  0.0f,  0.0f, -1.0f, U[2], V[1], },
-        {  HalfEdgeLength,  HalfEdgeLength, -HalfEdgeLength,  0.0f,  0.0f, -1.0f, U[2], V[2], },
-        { -HalfEdgeLength,  HalfEdgeLength, -HalfEdgeLength,  0.0f,  0.0f, -1.0f, U[1], V[2], },
-                                                                                                        
-        {  HalfEdgeLength, -HalfEdgeLength, -HalfEdgeLength,  1.0f,  0.0f,  0.0f, U[2], V[1], },
-        {  HalfEdgeLength, -HalfEdgeLength,  HalfEdgeLength,  1.0f,  0.0f,  0.0f, U[3], V[1], },
-        {  HalfEdgeLength,  HalfEdgeLength,  HalfEdgeLength,  1.0f,  0.0f,  0.0f, U[3], V[2], },
-        {  HalfEdgeLength,  HalfEdgeLength, -HalfEdgeLength,  1.0f,  0.0f,  0.0f, U[2], V[2], },
-                                                                                                        
-        {  HalfEdgeLength, -HalfEdgeLength,  HalfEdgeLength,  0.0f,  0.0f,  1.0f, U[3], V[1], },
-        { -HalfEdgeLength, -HalfEdgeLength,  HalfEdgeLength,  0.0f,  0.0f,  1.0f, U[4], V[1], },
-        { -HalfEdgeLength,  HalfEdgeLength,  HalfEdgeLength,  0.0f,  0.0f,  1.0f, U[4], V[2], },
-        {  HalfEdgeLength,  HalfEdgeLength,  HalfEdgeLength,  0.0f,  0.0f,  1.0f, U[3], V[2], },
-                                                                                                       
-        { -HalfEdgeLength, -HalfEdgeLength,  HalfEdgeLength, -1.0f,  0.0f,  0.0f, U[0], V[1], },
-        { -HalfEdgeLength, -HalfEdgeLength, -HalfEdgeLength, -1.0f,  0.0f,  0.0f, U[1], V[1], },
-        { -HalfEdgeLength,  HalfEdgeLength, -HalfEdgeLength, -1.0f,  0.0f,  0.0f, U[1], V[2], },
-        { -HalfEdgeLength,  HalfEdgeLength,  HalfEdgeLength, -1.0f,  0.0f,  0.0f, U[0], V[2], },
-                                                                                                       
-        { -HalfEdgeLength,  HalfEdgeLength, -HalfEdgeLength,  0.0f,  1.0f,  0.0f, U[1], V[2], },
-        {  HalfEdgeLength,  HalfEdgeLength, -HalfEdgeLength,  0.0f,  1.0f,  0.0f, U[2], V[2], },
-        {  HalfEdgeLength,  HalfEdgeLength,  HalfEdgeLength,  0.0f,  1.0f,  0.0f, U[2], V[3], },
-        { -HalfEdgeLength,  HalfEdgeLength,  HalfEdgeLength,  0.0f,  1.0f,  0.0f, U[1], V[3], },
-                                                                                                        
-        { -HalfEdgeLength, -HalfEdgeLength,  HalfEdgeLength,  0.0f, -1.0f,  0.0f, U[1], V[0], },
-        {  HalfEdgeLength, -HalfEdgeLength,  HalfEdgeLength,  0.0f, -1.0f,  0.0f, U[2], V[0], },
-        {  HalfEdgeLength, -HalfEdgeLength, -HalfEdgeLength,  0.0f, -1.0f,  0.0f, U[2], V[1], },
-        { -HalfEdgeLength, -HalfEdgeLength, -HalfEdgeLength,  0.0f, -1.0f,  0.0f, U[1], V[1], },
+        { 1, 1, }, { 2, 1, }, { 2, 2, }, { 1, 2, },
+        { 2, 1, }, { 3, 1, }, { 3, 2, }, { 2, 2, },
+        { 3, 1, }, { 4, 1, }, { 4, 2, }, { 3, 2, },
+        { 0, 1, }, { 1, 1, }, { 1, 2, }, { 0, 2, },
+        { 1, 2, }, { 2, 2, }, { 2, 3, }, { 1, 3, },
+        { 1, 0, }, { 2, 0, }, { 2, 1, }, { 1, 1, },
     };
 
+    float CubeVertices[post_effect_scene::s_NumberOfVertices][8];
+
+    for (int IndexOfVertex = 0; IndexOfVertex < post_effect_scene::s_NumberOfVertices; ++ IndexOfVertex)
+    {
+        for (int IndexOfFloat = 0; IndexOfFloat < post_effect_scene::s_VertexStride; ++ IndexOfFloat)
+        {
+            CubeVertices[IndexOfVertex][IndexOfFloat] = post_effect_scene::s_CubeVertices[IndexOfVertex][IndexOfFloat];
+        }
+
+        CubeVertices[IndexOfVertex][6] = U[CubeTexCoords[IndexOfVertex][0]];
+        CubeVertices[IndexOfVertex][7] = V[CubeTexCoords[IndexOfVertex][1]];
+    }
+
     int CubeIndices[][3] =
     {
         {  0,  1,  2, },
@@ -395,6 +482,14 @@ bool CApplication::InternOnCreateMeshes()
 
     CreateMesh(MeshInfo, &m_pMesh);
 
+    MeshInfo.m_pVertices        = &CubeVertices[0][0];
+    MeshInfo.m_NumberOfVertices = 24;
+    MeshInfo.m_pIndices         = &CubeIndices[0][0];
+    MeshInfo.m_NumberOfIndices  = 36;
+    MeshInfo.m_pMaterial        = m_pCompactMaterial;
+
+    CreateMesh(MeshInfo, &m_pCompactMesh);
+
     // -----------------------------------------------------------------------------
     // The quad mesh with the post effect material.
     // -----------------------------------------------------------------------------
@@ -406,6 +501,8 @@ bool CApplication::InternOnCreateMeshes()
 
     CreateMesh(MeshInfo, &m_pPostMesh);
 
+    m_PostProcessing.CreateMeshes();
+
     return true;
 }
 
@@ -416,6 +513,9 @@ bool CApplication::InternOnReleaseMeshes()
     ReleaseMesh(m_pGBufferMesh);
     ReleaseMesh(m_pMesh);
     ReleaseMesh(m_pPostMesh);
+    ReleaseMesh(m_pCompactMesh);
+
+    m_PostProcessing.ReleaseMeshes();
 
     return true;
 }
@@ -424,7 +524,126 @@ bool CApplication::InternOnReleaseMeshes()
 
 bool CApplication::InternOnResize(int _Width, int _Height)
 {
-    GetProjectionMatrix(m_FieldOfViewY, static_cast<float>(_Width) / static_cast<float>(_Height), m_Near, m_Far, m_ProjectionMatrix);
+    m_Camera.SetPerspective(m_FieldOfViewY, static_cast<float>(_Width) / static_cast<float>(_Height), m_Near, m_Far);
+
+    m_Width  = _Width;
+    m_Height = _Height;
+
+    m_PostProcessing.SetViewport(_Width, _Height);
+    m_PostProcessing.SetNearFar(m_Near, m_Far);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool)
+{
+    if (_IsKeyDown == false) return true;
+
+    // -----------------------------------------------------------------------------
+    // 'H' switches between the post processing chain and the monolithic post
+    // shader, '1' to '3' cycle the resolution of the effects, and 'C' prints the
+    // shaded pixels of each effect compared to full resolution. 'G' cycles the
+    // GBuffer layout and 'M' prints memory and bandwidth of all layouts. 'D'
+    // switches dynamic resolution on and off, 'B' cycles its frame time budget.
+    // -----------------------------------------------------------------------------
+    if (_Key == 'H')
+    {
+        m_IsPostProcessingEnabled = !m_IsPostProcessingEnabled;
+    }
+
+    if (_Key >= '1' && _Key < '1' + static_cast<unsigned int>(m_PostProcessing.GetNumberOfEffects()))
+    {
+        int IndexOfEffect = _Key - '1';
+
+        SPostResolution::EResolution Resolution = m_PostProcessing.GetResolution(IndexOfEffect);
+
+        switch (Resolution)
+        {
+            case SPostResolution::Full: Resolution = SPostResolution::Half;    break;
+            case SPostResolution::Half: Resolution = SPostResolution::Quarter; break;
+            default:                    Resolution = SPostResolution::Full;    break;
+        }
+
+        m_PostProcessing.SetResolution(IndexOfEffect, Resolution);
+    }
+
+    if (_Key == 'C')
+    {
+        for (int IndexOfEffect = 0; IndexOfEffect < m_PostProcessing.GetNumberOfEffects(); ++ IndexOfEffect)
+        {
+            SPostEffectCost Cost;
+
+            m_PostProcessing.GetCost(IndexOfEffect, Cost);
+
+            LOG(Statistics, Info, "{}: {} shaded pixels, {} at full resolution ({}%)",
+                Cost.m_pShaderName, Cost.m_ShadedPixels, Cost.m_FullResolutionPixels, 100.0 * Cost.m_ShadedPixels / Cost.m_FullResolutionPixels);
+        }
+    }
+
+    if (_Key == 'G')
+    {
+        if (m_GBufferLayout == SGBufferLayout::Standard)
+        {
+            m_GBufferLayout  = SGBufferLayout::Compact;
+            m_NormalEncoding = SNormalEncoding::OctahedralRG16;
+        }
+        else if (m_NormalEncoding == SNormalEncoding::OctahedralRG16)
+        {
+            m_NormalEncoding = SNormalEncoding::OctahedralRG8;
+        }
+        else
+        {
+            m_GBufferLayout  = SGBufferLayout::Standard;
+            m_NormalEncoding = SNormalEncoding::Float3;
+        }
+    }
+
+    if (_Key == 'D')
+    {
+        m_IsDynamicResolutionEnabled = !m_IsDynamicResolutionEnabled;
+        m_HasFrameTime               = false;
+
+        m_DynamicResolution.Reset();
+        m_DynamicResolution.ResetStatistics();
+    }
+
+    if (_Key == 'B')
+    {
+        const float Budgets[] = { 16.6f, 8.3f, 33.3f };
+
+        m_IndexOfBudget = (m_IndexOfBudget + 1) % 3;
+
+        m_DynamicResolution.SetBudget(Budgets[m_IndexOfBudget]);
+        m_DynamicResolution.ResetStatistics();
+
+        LOG(Statistics, Info, "Dynamic resolution budget: {} ms", Budgets[m_IndexOfBudget]);
+    }
+
+    if (_Key == 'M')
+    {
+        const char* pNames[] = { "standard xyz", "compact RG16", "compact RG8" };
+
+        SGBufferLayout::ELayout    Layouts  [] = { SGBufferLayout::Standard, SGBufferLayout::Compact, SGBufferLayout::Compact };
+        SNormalEncoding::EEncoding Encodings[] = { SNormalEncoding::Float3, SNormalEncoding::OctahedralRG16, SNormalEncoding::OctahedralRG8 };
+
+        SGBufferCost Standard;
+
+        GetGBufferCost(SGBufferLayout::Standard, SNormalEncoding::Float3, m_Width, m_Height, Standard);
+
+        for (int IndexOfLayout = 0; IndexOfLayout < 3; ++ IndexOfLayout)
+        {
+            SGBufferCost Cost;
+
+            GetGBufferCost(Layouts[IndexOfLayout], Encodings[IndexOfLayout], m_Width, m_Height, Cost);
+
+            LOG(Statistics, Info, "{}: {} geometry passes, {} bytes per pixel ({} allocated, {} KB), {} bytes per pixel to fill ({}%), {} bytes per post effect sample ({}%)",
+                pNames[IndexOfLayout], Cost.m_NumberOfGeometryPasses, Cost.m_BytesPerPixel, Cost.m_AllocatedBytesPerPixel, Cost.m_Memory / 1024,
+                Cost.m_GeometryBytesPerPixel, 100.0 * Cost.m_GeometryBytesPerPixel / Standard.m_GeometryBytesPerPixel,
+                Cost.m_PostBytesPerSample, 100.0 * Cost.m_PostBytesPerSample / Standard.m_PostBytesPerSample);
+        }
+    }
 
     return true;
 }
@@ -433,15 +652,29 @@ bool CApplication::InternOnResize(int _Width, int _Height)
 
 bool CApplication::InternOnUpdate()
 {
-    float Eye[3];
-    float At [3];
-    float Up [3];
+    m_Camera.SetLookAt(post_effect_scene::s_Eye, post_effect_scene::s_At, post_effect_scene::s_Up);
 
-    Eye[0] =  0.0f; At[0] = 0.0f; Up[0] = 0.0f;
-    Eye[1] =  4.0f; At[1] = 0.0f; Up[1] = 1.0f;
-    Eye[2] = -8.0f; At[2] = 0.0f; Up[2] = 0.0f;
+    // -----------------------------------------------------------------------------
+    // Blend the last two angles of the animation. The angle wraps at 360 degrees,
+    // so the blend must not run backwards over the whole circle.
+    // -----------------------------------------------------------------------------
+    float PreviousAngleY;
+    float CurrentAngleY;
+
+    float Blend = m_Animation.BeginFrame(PreviousAngleY, CurrentAngleY);
+
+    if (CurrentAngleY < PreviousAngleY) CurrentAngleY += 360.0f;
+
+    m_AngleY = ::fmodf(PreviousAngleY + (CurrentAngleY - PreviousAngleY) * Blend, 360.0f);
+
+    // -----------------------------------------------------------------------------
+    // Rotate the cube around the y-axis and update the world matrices.
+    // -----------------------------------------------------------------------------
+    float AxisY[3] = { 0.0f, 1.0f, 0.0f };
+    float Rotation[4];
 
-    GetViewMatrix(Eye, At, Up, m_ViewMatrix);
+    m_Transforms.SetLocalRotation(m_IndexOfCubeNode, GetRotationQuaternion(AxisY, m_AngleY, Rotation));
+    m_Transforms.Update();
 
     return true;
 }
@@ -453,13 +686,84 @@ bool CApplication::InternOnFrame()
     float ClearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f, };
 
     // -----------------------------------------------------------------------------
-    // Upload the matrices to the vertex shader.
+    // Dynamic resolution. The controller gets the time since the last frame,
+    // which contains the wait for the GPU in the present of the last frame, and
+    // returns the scale of the scene. YoshiX creates all targets with the size
+    // of the window, so the scene is rendered into the upper left part of the
+    // targets only, like the reduced post effects. The post processing chain
+    // upsamples it to the frame buffer, the monolithic post shader expects the
+    // whole targets, so dynamic resolution needs the chain.
+    // -----------------------------------------------------------------------------
+    double FrameTime = m_FrameStopwatch.GetElapsedMilliseconds();
+
+    m_FrameStopwatch.Start();
+
+    int SceneWidth  = m_Width;
+    int SceneHeight = m_Height;
+
+    if (m_IsDynamicResolutionEnabled && m_IsPostProcessingEnabled)
+    {
+        if (m_HasFrameTime)
+        {
+            m_DynamicResolution.Update(FrameTime);
+
+            // -----------------------------------------------------------------------------
+            // Log the adherence to the budget about every two seconds. The message is
+            // only queued here, the log thread formats and writes it.
+            // -----------------------------------------------------------------------------
+            SDynamicResolutionStatistics Statistics;
+
+            m_DynamicResolution.GetStatistics(Statistics);
+
+            if (Statistics.m_NumberOfFrames >= 120)
+            {
+                LOG(Statistics, Info, "Dynamic resolution: {}% of the frames in the budget of {} ms, {} ms average, {} ms maximum, scale {} average and {} minimum, {} changes ({} reversed)",
+                    100.0 * Statistics.m_NumberOfFramesInBudget / Statistics.m_NumberOfFrames, m_DynamicResolution.GetSettings().m_FrameTimeBudget,
+                    Statistics.m_TotalFrameTime / Statistics.m_NumberOfFrames, Statistics.m_MaximumFrameTime,
+                    Statistics.m_TotalScale / Statistics.m_NumberOfFrames, Statistics.m_MinimumScale,
+                    Statistics.m_NumberOfScaleChanges, Statistics.m_NumberOfReversals);
+
+                m_DynamicResolution.ResetStatistics();
+            }
+        }
+
+        m_HasFrameTime = true;
+
+        m_DynamicResolution.GetScaledSize(m_Width, m_Height, SceneWidth, SceneHeight);
+    }
+
+    m_PostProcessing.SetSceneSize(SceneWidth, SceneHeight);
+
+    // -----------------------------------------------------------------------------
+    // Upload the matrices to the vertex shader. A reduced scene is scaled in
+    // clip space and moved to the upper left corner.
     // -----------------------------------------------------------------------------
     SVertexBuffer VertexBuffer;
 
-    MulMatrix(m_ViewMatrix, m_ProjectionMatrix, VertexBuffer.m_ViewProjectionMatrix);
+    const SCameraSnapshot& rCamera = m_Camera.GetSnapshot();
+
+    if (SceneWidth < m_Width || SceneHeight < m_Height)
+    {
+        float ScaleX = static_cast<float>(SceneWidth ) / static_cast<float>(m_Width );
+        float ScaleY = static_cast<float>(SceneHeight) / static_cast<float>(m_Height);
+
+        float SceneMatrix[16];
+
+        GetIdentityMatrix(SceneMatrix);
+
+        SceneMatrix[ 0] = ScaleX;
+        SceneMatrix[ 5] = ScaleY;
+        SceneMatrix[12] = ScaleX - 1.0f;
+        SceneMatrix[13] = 1.0f - ScaleY;
+
+        MulMatrix(rCamera.m_ViewProjectionMatrix, SceneMatrix, VertexBuffer.m_ViewProjectionMatrix);
+    }
+    else
+    {
+        std::copy(rCamera.m_ViewProjectionMatrix, rCamera.m_ViewProjectionMatrix + 16, VertexBuffer.m_ViewProjectionMatrix);
+    }
 
-    GetRotationYMatrix(m_AngleY, VertexBuffer.m_WorldMatrix);
+    std::copy(m_Transforms.GetWorldMatrix(m_IndexOfCubeNode), m_Transforms.GetWorldMatrix(m_IndexOfCubeNode) + 16, VertexBuffer.m_WorldMatrix);
 
     GetScreenMatrix(VertexBuffer.m_ScreenMatrix);
 
@@ -472,37 +776,65 @@ bool CApplication::InternOnFrame()
 
     PixelBuffer.m_NearFar[0] = m_Near;
     PixelBuffer.m_NearFar[1] = m_Far;
-    PixelBuffer.m_NearFar[2] = 0.0f;
-    PixelBuffer.m_NearFar[3] = 0.0f;
+    PixelBuffer.m_NearFar[2] = static_cast<float>(m_NormalEncoding);
+    PixelBuffer.m_NearFar[3] = 1.0f;
 
     UploadConstantBuffer(&PixelBuffer, m_pPixelConstantBuffer);
 
     // -----------------------------------------------------------------------------
-    // Activate the GBuffer and render depth and normals of the cube to it.
+    // The monolithic post shader expects the standard layout, so the compact
+    // layout is only used together with the post processing chain.
     // -----------------------------------------------------------------------------
-    SetRenderTargets(&m_pNormalTarget, 1, m_pDepthTarget);
+    bool IsCompact = m_IsPostProcessingEnabled && m_GBufferLayout == SGBufferLayout::Compact;
 
-    ClearDepthTarget(m_pDepthTarget, 1.0f);
-    ClearColorTarget(m_pNormalTarget, ClearColor);
+    m_PostProcessing.SetNormalEncoding(IsCompact ? m_NormalEncoding : SNormalEncoding::Float3);
 
-    DrawMesh(m_pGBufferMesh);
+    if (IsCompact)
+    {
+        // -----------------------------------------------------------------------------
+        // Render material color and octahedral normal of the cube in one pass. The
+        // color target holds the color and the material index in alpha, so the
+        // second geometry pass with the 'Equal' depth test is not necessary.
+        // -----------------------------------------------------------------------------
+        BHandle Targets[] = { m_pColorTarget, m_pNormalTarget };
+
+        SetRenderTargets(Targets, 2, m_pDepthTarget);
+
+        ClearDepthTarget(m_pDepthTarget, 1.0f);
+        ClearColorTarget(m_pColorTarget, ClearColor);
+        ClearColorTarget(m_pNormalTarget, ClearColor);
+
+        DrawMesh(m_pCompactMesh);
+    }
+    else
+    {
+        // -----------------------------------------------------------------------------
+        // Activate the GBuffer and render depth and normals of the cube to it.
+        // -----------------------------------------------------------------------------
+        SetRenderTargets(&m_pNormalTarget, 1, m_pDepthTarget);
 
-    // -----------------------------------------------------------------------------
-    // Draw the cube with standard materials into the color target. Note that we set
-    // the depth buffer of the GBuffer as depth buffer, which is already filled with
-    // the depth values of the GBuffer pass. So each pixel of the scene which is
-    // more or equal distant than the pixel in the depth buffer is discarded. For
-    // that reason we switch the depth test to equal, so at least the pixel with an
-    // equal distance pass the test. These are exactly the same pixels which won in
-    // the GBuffer pass.
-    // -----------------------------------------------------------------------------
-    SetRenderTargets(&m_pColorTarget, 1, m_pDepthTarget);
-    
-    ClearColorTarget(m_pColorTarget, ClearColor);
+        ClearDepthTarget(m_pDepthTarget, 1.0f);
+        ClearColorTarget(m_pNormalTarget, ClearColor);
+
+        DrawMesh(m_pGBufferMesh);
+
+        // -----------------------------------------------------------------------------
+        // Draw the cube with standard materials into the color target. Note that we set
+        // the depth buffer of the GBuffer as depth buffer, which is already filled with
+        // the depth values of the GBuffer pass. So each pixel of the scene which is
+        // more or equal distant than the pixel in the depth buffer is discarded. For
+        // that reason we switch the depth test to equal, so at least the pixel with an
+        // equal distance pass the test. These are exactly the same pixels which won in
+        // the GBuffer pass.
+        // -----------------------------------------------------------------------------
+        SetRenderTargets(&m_pColorTarget, 1, m_pDepthTarget);
+
+        ClearColorTarget(m_pColorTarget, ClearColor);
 
-    SetDepthTest(SDepthTest::Equal);
+        SetDepthTest(SDepthTest::Equal);
 
-    DrawMesh(m_pMesh);
+        DrawMesh(m_pMesh);
+    }
 
     // -----------------------------------------------------------------------------
     // We now set the default frame and depth buffer, because the default frame
@@ -514,24 +846,43 @@ bool CApplication::InternOnFrame()
     // off the depth test, because we want to calculate each pixel of the screen
     // under all circumstances.
     // -----------------------------------------------------------------------------
-    ResetRenderTargets();
+    if (m_IsPostProcessingEnabled)
+    {
+        m_PostProcessing.Execute();
+    }
+    else
+    {
+        ResetRenderTargets();
 
-    SetDepthTest(SDepthTest::Off);
+        SetDepthTest(SDepthTest::Off);
 
-    DrawMesh(m_pPostMesh);
+        DrawMesh(m_pPostMesh);
 
-    // -----------------------------------------------------------------------------
-    // We are done with the post effect so set the depth test to its default again.
-    // -----------------------------------------------------------------------------
-    SetDepthTest(SDepthTest::Lesser);
+        // -----------------------------------------------------------------------------
+        // We are done with the post effect so set the depth test to its default again.
+        // -----------------------------------------------------------------------------
+        SetDepthTest(SDepthTest::Lesser);
+    }
 
-    m_AngleY = ::fmodf(m_AngleY + 0.003f, 360.0f);
+    m_Animation.EndFrame();
 
     return true;
 }
 
 // -----------------------------------------------------------------------------
 
+void CApplication::StepAnimation(float& _rAngleY, float _StepTime, void* _pUserData)
+{
+    (void)_pUserData;
+
+    // -----------------------------------------------------------------------------
+    // The same speed as the former 0.003 degrees per frame at 60 frames per second.
+    // -----------------------------------------------------------------------------
+    _rAngleY = ::fmodf(_rAngleY + 0.18f * _StepTime, 360.0f);
+}
+
+// -----------------------------------------------------------------------------
+
 void main()
 {
     CApplication Application;
@@ -0,0 +1,46 @@
+#include "post_effect_scene.h"
+
+namespace post_effect_scene
+{
+    namespace
+    {
+        const float H = s_HalfEdgeLength;
+    } // namespace
+
+    const float s_CubeVertices[s_NumberOfVertices][s_VertexStride] =
+    {
+        { -H, -H, -H,  0.0f,  0.0f, -1.0f, },
+        {  H, -H, -H,  0.0f,  0.0f, -1.0f, },
+        {  H,  H, -H,  0.0f,  0.0f, -1.0f, },
+        { -H,  H, -H,  0.0f,  0.0f, -1.0f, },
+
+        {  H, -H, -H,  1.0f,  0.0f,  0.0f, },
+        {  H, -H,  H,  1.0f,  0.0f,  0.0f, },
+        {  H,  H,  H,  1.0f,  0.0f,  0.0f, },
+        {  H,  H, -H,  1.0f,  0.0f,  0.0f, },
+
+        {  H, -H,  H,  0.0f,  0.0f,  1.0f, },
+        { -H, -H,  H,  0.0f,  0.0f,  1.0f, },
+        { -H,  H,  H,  0.0f,  0.0f,  1.0f, },
+        {  H,  H,  H,  0.0f,  0.0f,  1.0f, },
+
+        { -H, -H,  H, -1.0f,  0.0f,  0.0f, },
+        { -H, -H, -H, -1.0f,  0.0f,  0.0f, },
+        { -H,  H, -H, -1.0f,  0.0f,  0.0f, },
+        { -H,  H,  H, -1.0f,  0.0f,  0.0f, },
+
+        { -H,  H, -H,  0.0f,  1.0f,  0.0f, },
+        {  H,  H, -H,  0.0f,  1.0f,  0.0f, },
+        {  H,  H,  H,  0.0f,  1.0f,  0.0f, },
+        { -H,  H,  H,  0.0f,  1.0f,  0.0f, },
+
+        { -H, -H,  H,  0.0f, -1.0f,  0.0f, },
+        {  H, -H,  H,  0.0f, -1.0f,  0.0f, },
+        {  H, -H, -H,  0.0f, -1.0f,  0.0f, },
+        { -H, -H, -H,  0.0f, -1.0f,  0.0f, },
+    };
+
+    const float s_Eye[3] = { 0.0f, 4.0f, -8.0f };
+    const float s_At [3] = { 0.0f, 0.0f,  0.0f };
+    const float s_Up [3] = { 0.0f, 1.0f,  0.0f };
+} // namespace post_effect_scene
@@ -0,0 +1,29 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// The scene of 'post_effect.cpp': a cube rotating around the y-axis, seen from
+// a fixed camera. The example builds its mesh and its camera from these
+// values, the regression tool renders the same scene.
+// -----------------------------------------------------------------------------
+namespace post_effect_scene
+{
+    const int   s_NumberOfFaces     = 6;
+    const int   s_NumberOfVertices  = 24;                               // Four per face, so each face has its own normal.
+    const int   s_VertexStride      = 6;                                // Position and normal.
+
+    const float s_HalfEdgeLength    = 2.0f;
+
+    const float s_FieldOfViewY      = 60.0f;                            // Vertical view angle of the camera in degrees.
+    const float s_Near              = 0.1f;
+    const float s_Far               = 20.0f;
+
+    // -----------------------------------------------------------------------------
+    // The corners of each face are counter-clockwise seen from the outside, so a
+    // face is the triangles 0 1 2 and 0 2 3 of its four vertices.
+    // -----------------------------------------------------------------------------
+    extern const float s_CubeVertices[s_NumberOfVertices][s_VertexStride];
+
+    extern const float s_Eye[3];
+    extern const float s_At[3];
+    extern const float s_Up[3];
+} // namespace post_effect_scene
@@ -0,0 +1,436 @@
+
+#include "post_processing.h"
+
+#include <algorithm>
+
+using namespace gfx;
+
+namespace
+{
+    struct SPostVertexBuffer
+    {
+        float m_ScreenMatrix[16];                                       // Projects a rectangular mesh onto a complete render target.
+        float m_Scale[4];                                               // Scale of the quad in x and y, the other two components are wasted.
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct SPostPixelBuffer
+    {
+        float m_NearFar[4];                                             // Near and far distance of the view frustum, the other two components are wasted.
+        float m_TargetSize[4];                                          // Width, height, and their reciprocals of the full resolution targets.
+        float m_Scale[4];                                               // Resolution scale of the current effect, and width and height of the scene in pixels.
+    };
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CPostProcessing::CPostProcessing()
+    : m_Width                (1)
+    , m_Height               (1)
+    , m_SceneWidth           (1)
+    , m_SceneHeight          (1)
+    , m_Near                 (0.1f)
+    , m_Far                  (100.0f)
+    , m_NormalEncoding       (SNormalEncoding::Float3)
+    , m_pColorTarget         (nullptr)
+    , m_pEffectTarget        (nullptr)
+    , m_pPingPongTarget      (nullptr)
+    , m_pVertexConstantBuffer(nullptr)
+    , m_pPixelConstantBuffer (nullptr)
+    , m_pVertexShader        (nullptr)
+    , m_pCompositePixelShader(nullptr)
+    , m_pUpsamplePixelShader (nullptr)
+    , m_pUpsampleMaterial    (nullptr)
+    , m_pUpsampleMesh        (nullptr)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CPostProcessing::~CPostProcessing()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::AddEffect(const char* _pShaderName, SPostResolution::EResolution _Resolution)
+{
+    SEffect Effect = { _pShaderName, _Resolution, nullptr, nullptr, nullptr, nullptr, nullptr };
+
+    m_Effects.push_back(Effect);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::SetResolution(int _IndexOfEffect, SPostResolution::EResolution _Resolution)
+{
+    // -----------------------------------------------------------------------------
+    // The quad is scaled in the vertex shader, so the resolution can be changed
+    // at any time without recreating meshes or targets.
+    // -----------------------------------------------------------------------------
+    m_Effects[_IndexOfEffect].m_Resolution = _Resolution;
+}
+
+// -----------------------------------------------------------------------------
+
+int CPostProcessing::GetNumberOfEffects() const
+{
+    return static_cast<int>(m_Effects.size());
+}
+
+// -----------------------------------------------------------------------------
+
+SPostResolution::EResolution CPostProcessing::GetResolution(int _IndexOfEffect) const
+{
+    return m_Effects[_IndexOfEffect].m_Resolution;
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::SetViewport(int _Width, int _Height)
+{
+    m_Width  = _Width  > 0 ? _Width  : 1;
+    m_Height = _Height > 0 ? _Height : 1;
+
+    m_SceneWidth  = m_Width;
+    m_SceneHeight = m_Height;
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::SetNearFar(float _Near, float _Far)
+{
+    m_Near = _Near;
+    m_Far  = _Far;
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::SetNormalEncoding(SNormalEncoding::EEncoding _Encoding)
+{
+    m_NormalEncoding = _Encoding;
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::SetSceneSize(int _Width, int _Height)
+{
+    m_SceneWidth  = std::min(std::max(_Width , 1), m_Width );
+    m_SceneHeight = std::min(std::max(_Height, 1), m_Height);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::CreateTextures()
+{
+    CreateColorTarget(&m_pEffectTarget);
+    CreateColorTarget(&m_pPingPongTarget);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::ReleaseTextures()
+{
+    ReleaseTexture(m_pEffectTarget);
+    ReleaseTexture(m_pPingPongTarget);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::CreateConstantBuffers()
+{
+    CreateConstantBuffer(sizeof(SPostVertexBuffer), &m_pVertexConstantBuffer);
+    CreateConstantBuffer(sizeof(SPostPixelBuffer ), &m_pPixelConstantBuffer);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::ReleaseConstantBuffers()
+{
+    ReleaseConstantBuffer(m_pVertexConstantBuffer);
+    ReleaseConstantBuffer(m_pPixelConstantBuffer);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::CreateShader()
+{
+    CreateVertexShader("..\\data\\shader\\post_process.fx", "VSPostShader"     , &m_pVertexShader);
+    CreatePixelShader ("..\\data\\shader\\post_process.fx", "PSCompositeShader", &m_pCompositePixelShader);
+    CreatePixelShader ("..\\data\\shader\\post_process.fx", "PSUpsampleShader" , &m_pUpsamplePixelShader);
+
+    for (SEffect& rEffect : m_Effects)
+    {
+        CreatePixelShader("..\\data\\shader\\post_process.fx", rEffect.m_pShaderName, &rEffect.m_pPixelShader);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::ReleaseShader()
+{
+    ReleaseVertexShader(m_pVertexShader);
+    ReleasePixelShader (m_pCompositePixelShader);
+    ReleasePixelShader (m_pUpsamplePixelShader);
+
+    for (SEffect& rEffect : m_Effects)
+    {
+        ReleasePixelShader(rEffect.m_pPixelShader);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::CreateMaterials(BHandle _pDepthTarget, BHandle _pColorTarget, BHandle _pNormalTarget)
+{
+    SMaterialInfo MaterialInfo;
+
+    m_pColorTarget = _pColorTarget;
+
+    MaterialInfo.m_NumberOfVertexConstantBuffers = 1;
+    MaterialInfo.m_pVertexConstantBuffers[0]     = m_pVertexConstantBuffer;
+    MaterialInfo.m_NumberOfPixelConstantBuffers  = 1;
+    MaterialInfo.m_pPixelConstantBuffers[0]      = m_pPixelConstantBuffer;
+    MaterialInfo.m_pVertexShader                 = m_pVertexShader;
+    MaterialInfo.m_NumberOfInputElements         = 1;
+    MaterialInfo.m_InputElements[0].m_pName      = "POSITION";
+    MaterialInfo.m_InputElements[0].m_Type       = SInputElement::Float3;
+
+    for (int IndexOfEffect = 0; IndexOfEffect < GetNumberOfEffects(); ++ IndexOfEffect)
+    {
+        SEffect& rEffect = m_Effects[IndexOfEffect];
+
+        // -----------------------------------------------------------------------------
+        // The effects alternate between the scene color target and the ping pong
+        // target, so the color input of an effect depends on its position.
+        // -----------------------------------------------------------------------------
+        BHandle pColorInput = (IndexOfEffect % 2) == 0 ? _pColorTarget : m_pPingPongTarget;
+
+        MaterialInfo.m_NumberOfTextures = 3;
+        MaterialInfo.m_pTextures[0]     = _pDepthTarget;
+        MaterialInfo.m_pTextures[1]     = pColorInput;
+        MaterialInfo.m_pTextures[2]     = _pNormalTarget;
+        MaterialInfo.m_pPixelShader     = rEffect.m_pPixelShader;
+
+        CreateMaterial(MaterialInfo, &rEffect.m_pMaterial);
+
+        MaterialInfo.m_NumberOfTextures = 4;
+        MaterialInfo.m_pTextures[3]     = m_pEffectTarget;
+        MaterialInfo.m_pPixelShader     = m_pCompositePixelShader;
+
+        CreateMaterial(MaterialInfo, &rEffect.m_pCompositeMaterial);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The upsampling reads the color output of the last effect.
+    // -----------------------------------------------------------------------------
+    int NumberOfEffects = GetNumberOfEffects();
+
+    BHandle pColorOutput = (NumberOfEffects % 2) == 1 ? m_pPingPongTarget : _pColorTarget;
+
+    MaterialInfo.m_NumberOfTextures = 3;
+    MaterialInfo.m_pTextures[0]     = _pDepthTarget;
+    MaterialInfo.m_pTextures[1]     = pColorOutput;
+    MaterialInfo.m_pTextures[2]     = _pNormalTarget;
+    MaterialInfo.m_pPixelShader     = m_pUpsamplePixelShader;
+
+    CreateMaterial(MaterialInfo, &m_pUpsampleMaterial);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::ReleaseMaterials()
+{
+    for (SEffect& rEffect : m_Effects)
+    {
+        ReleaseMaterial(rEffect.m_pMaterial);
+        ReleaseMaterial(rEffect.m_pCompositeMaterial);
+    }
+
+    ReleaseMaterial(m_pUpsampleMaterial);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::CreateMeshes()
+{
+    float QuadVertices[][3] =
+    {
+        { 0.0f, 1.0f, 0.0f, },
+        { 1.0f, 1.0f, 0.0f, },
+        { 1.0f, 0.0f, 0.0f, },
+        { 0.0f, 0.0f, 0.0f, },
+    };
+
+    int QuadIndices[][3] =
+    {
+        { 0, 1, 2, },
+        { 0, 2, 3, },
+    };
+
+    SMeshInfo MeshInfo;
+
+    MeshInfo.m_pVertices        = &QuadVertices[0][0];
+    MeshInfo.m_NumberOfVertices = 4;
+    MeshInfo.m_pIndices         = &QuadIndices[0][0];
+    MeshInfo.m_NumberOfIndices  = 6;
+
+    for (SEffect& rEffect : m_Effects)
+    {
+        MeshInfo.m_pMaterial = rEffect.m_pMaterial;
+
+        CreateMesh(MeshInfo, &rEffect.m_pMesh);
+
+        MeshInfo.m_pMaterial = rEffect.m_pCompositeMaterial;
+
+        CreateMesh(MeshInfo, &rEffect.m_pCompositeMesh);
+    }
+
+    MeshInfo.m_pMaterial = m_pUpsampleMaterial;
+
+    CreateMesh(MeshInfo, &m_pUpsampleMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::ReleaseMeshes()
+{
+    for (SEffect& rEffect : m_Effects)
+    {
+        ReleaseMesh(rEffect.m_pMesh);
+        ReleaseMesh(rEffect.m_pCompositeMesh);
+    }
+
+    ReleaseMesh(m_pUpsampleMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::Execute()
+{
+    // -----------------------------------------------------------------------------
+    // Post effects calculate each pixel under all circumstances, so the depth test
+    // is switched off. The final effect renders into the frame buffer, unless the
+    // scene has a reduced size, then the upsampling does.
+    // -----------------------------------------------------------------------------
+    SetDepthTest(SDepthTest::Off);
+
+    bool IsSceneReduced = m_SceneWidth < m_Width || m_SceneHeight < m_Height;
+
+    float SceneScaleX = static_cast<float>(m_SceneWidth ) / static_cast<float>(m_Width );
+    float SceneScaleY = static_cast<float>(m_SceneHeight) / static_cast<float>(m_Height);
+
+    for (int IndexOfEffect = 0; IndexOfEffect < GetNumberOfEffects(); ++ IndexOfEffect)
+    {
+        SEffect& rEffect = m_Effects[IndexOfEffect];
+
+        float Scale = GetScale(rEffect.m_Resolution);
+
+        // -----------------------------------------------------------------------------
+        // Calculate the effect term at the reduced resolution.
+        // -----------------------------------------------------------------------------
+        SetRenderTargets(&m_pEffectTarget, 1, nullptr);
+
+        UploadConstants(Scale * SceneScaleX, Scale * SceneScaleY, Scale);
+
+        DrawMesh(rEffect.m_pMesh);
+
+        // -----------------------------------------------------------------------------
+        // Upsample the term and blend it over the color input at the resolution of
+        // the scene.
+        // -----------------------------------------------------------------------------
+        if (IndexOfEffect + 1 == GetNumberOfEffects() && IsSceneReduced == false)
+        {
+            ResetRenderTargets();
+        }
+        else
+        {
+            BHandle pColorOutput = (IndexOfEffect % 2) == 0 ? m_pPingPongTarget : m_pColorTarget;
+
+            SetRenderTargets(&pColorOutput, 1, nullptr);
+        }
+
+        UploadConstants(SceneScaleX, SceneScaleY, Scale);
+
+        DrawMesh(rEffect.m_pCompositeMesh);
+    }
+
+    if (IsSceneReduced)
+    {
+        ResetRenderTargets();
+
+        UploadConstants(1.0f, 1.0f, 1.0f);
+
+        DrawMesh(m_pUpsampleMesh);
+    }
+
+    SetDepthTest(SDepthTest::Lesser);
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::GetCost(int _IndexOfEffect, SPostEffectCost& _rCost) const
+{
+    const SEffect& rEffect = m_Effects[_IndexOfEffect];
+
+    long long NumberOfPixels = static_cast<long long>(m_Width) * m_Height;
+    long long ScenePixels    = static_cast<long long>(m_SceneWidth) * m_SceneHeight;
+
+    float Scale = GetScale(rEffect.m_Resolution);
+
+    // -----------------------------------------------------------------------------
+    // The effect pass shades the scaled part of the scene, the composite pass
+    // always shades the whole scene.
+    // -----------------------------------------------------------------------------
+    _rCost.m_pShaderName          = rEffect.m_pShaderName;
+    _rCost.m_ShadedPixels         = static_cast<long long>(ScenePixels * Scale * Scale) + ScenePixels;
+    _rCost.m_FullResolutionPixels = NumberOfPixels + NumberOfPixels;
+}
+
+// -----------------------------------------------------------------------------
+
+float CPostProcessing::GetScale(SPostResolution::EResolution _Resolution) const
+{
+    switch (_Resolution)
+    {
+        case SPostResolution::Half:    return 0.5f;
+        case SPostResolution::Quarter: return 0.25f;
+        default:                       return 1.0f;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CPostProcessing::UploadConstants(float _QuadScaleX, float _QuadScaleY, float _EffectScale)
+{
+    SPostVertexBuffer VertexBuffer;
+
+    GetScreenMatrix(VertexBuffer.m_ScreenMatrix);
+
+    VertexBuffer.m_Scale[0] = _QuadScaleX;
+    VertexBuffer.m_Scale[1] = _QuadScaleY;
+    VertexBuffer.m_Scale[2] = 0.0f;
+    VertexBuffer.m_Scale[3] = 0.0f;
+
+    UploadConstantBuffer(&VertexBuffer, m_pVertexConstantBuffer);
+
+    SPostPixelBuffer PixelBuffer;
+
+    PixelBuffer.m_NearFar[0]    = m_Near;
+    PixelBuffer.m_NearFar[1]    = m_Far;
+    PixelBuffer.m_NearFar[2]    = static_cast<float>(m_NormalEncoding);
+    PixelBuffer.m_NearFar[3]    = 0.0f;
+
+    PixelBuffer.m_TargetSize[0] = static_cast<float>(m_Width);
+    PixelBuffer.m_TargetSize[1] = static_cast<float>(m_Height);
+    PixelBuffer.m_TargetSize[2] = 1.0f / static_cast<float>(m_Width);
+    PixelBuffer.m_TargetSize[3] = 1.0f / static_cast<float>(m_Height);
+
+    PixelBuffer.m_Scale[0]      = _EffectScale;
+    PixelBuffer.m_Scale[1]      = static_cast<float>(m_SceneWidth);
+    PixelBuffer.m_Scale[2]      = static_cast<float>(m_SceneHeight);
+    PixelBuffer.m_Scale[3]      = 0.0f;
+
+    UploadConstantBuffer(&PixelBuffer, m_pPixelConstantBuffer);
+}
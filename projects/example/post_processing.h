@@ -0,0 +1,128 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include "gbuffer_layout.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+struct SPostResolution
+{
+    enum EResolution
+    {
+        Full,                                                           ///< The effect is calculated for each pixel of the render target.
+        Half,                                                           ///< The effect is calculated for a quarter of the pixels (half width and half height).
+        Quarter,                                                        ///< The effect is calculated for a sixteenth of the pixels (quarter width and quarter height).
+    };
+};
+
+// -----------------------------------------------------------------------------
+
+struct SPostEffectCost
+{
+    const char* m_pShaderName;                                          // The pixel shader of the effect.
+    long long   m_ShadedPixels;                                         // Pixels shaded per frame by the effect and its upsampling.
+    long long   m_FullResolutionPixels;                                 // Pixels shaded per frame if the effect ran at full resolution.
+};
+
+// -----------------------------------------------------------------------------
+// A chain of post effects working on the GBuffer of 'post_effect.cpp'. Each
+// effect is a pixel shader in 'post_process.fx' writing a term as color and
+// blend weight, which is blended over the scene color afterwards. Effects can
+// run at full, half, or quarter resolution. YoshiX creates all render targets
+// with the size of the window, so a reduced effect is rendered into the upper
+// left part of the shared effect target only. The term is then upsampled with
+// a bilateral filter weighting the low resolution samples by their depth and
+// normal similarity to the full resolution GBuffer pixel, which prevents the
+// effect from bleeding over silhouettes.
+//
+// With dynamic resolution the scene itself only covers the upper left part of
+// the GBuffer and color target, see 'SetSceneSize'. The whole chain then runs
+// on that part and a last pass upsamples the result bilinearly to the frame
+// buffer.
+// -----------------------------------------------------------------------------
+class CPostProcessing
+{
+    public:
+
+        CPostProcessing();
+        ~CPostProcessing();
+
+    public:
+
+        void AddEffect(const char* _pShaderName, SPostResolution::EResolution _Resolution);
+        void SetResolution(int _IndexOfEffect, SPostResolution::EResolution _Resolution);
+
+        int                          GetNumberOfEffects() const;
+        SPostResolution::EResolution GetResolution(int _IndexOfEffect) const;
+
+        void SetViewport(int _Width, int _Height);
+        void SetNearFar(float _Near, float _Far);
+        void SetNormalEncoding(SNormalEncoding::EEncoding _Encoding);
+        void SetSceneSize(int _Width, int _Height);                     // Part of the targets the scene was rendered to, the viewport by default.
+
+    public:
+
+        void CreateTextures();
+        void ReleaseTextures();
+        void CreateConstantBuffers();
+        void ReleaseConstantBuffers();
+        void CreateShader();
+        void ReleaseShader();
+        void CreateMaterials(gfx::BHandle _pDepthTarget, gfx::BHandle _pColorTarget, gfx::BHandle _pNormalTarget);
+        void ReleaseMaterials();
+        void CreateMeshes();
+        void ReleaseMeshes();
+
+    public:
+
+        void Execute();
+
+        void GetCost(int _IndexOfEffect, SPostEffectCost& _rCost) const;
+
+    private:
+
+        struct SEffect
+        {
+            const char*                  m_pShaderName;                 // Name of the pixel shader in 'post_process.fx'.
+            SPostResolution::EResolution m_Resolution;                  // The resolution the effect runs at.
+            gfx::BHandle                 m_pPixelShader;                // The pixel shader calculating the effect term.
+            gfx::BHandle                 m_pMaterial;                   // Effect material with depth, color, and normal as input.
+            gfx::BHandle                 m_pMesh;                       // Full screen quad with the effect material.
+            gfx::BHandle                 m_pCompositeMaterial;          // Upsampling material blending the term over the color input.
+            gfx::BHandle                 m_pCompositeMesh;              // Full screen quad with the composite material.
+        };
+
+    private:
+
+        float GetScale(SPostResolution::EResolution _Resolution) const;
+
+        void  UploadConstants(float _QuadScaleX, float _QuadScaleY, float _EffectScale);
+
+    private:
+
+        std::vector<SEffect> m_Effects;                                 // The effects in the order they are applied.
+
+        int                  m_Width;                                   // Width of the render targets in pixels.
+        int                  m_Height;                                  // Height of the render targets in pixels.
+        int                  m_SceneWidth;                              // Width of the part of the targets holding the scene.
+        int                  m_SceneHeight;                             // Height of the part of the targets holding the scene.
+        float                m_Near;                                    // Near distance of the view frustum.
+        float                m_Far;                                     // Far distance of the view frustum.
+        SNormalEncoding::EEncoding m_NormalEncoding;                    // How the normals are stored in the normal target of the GBuffer.
+
+        gfx::BHandle         m_pColorTarget;                            // The scene color target passed on material creation.
+        gfx::BHandle         m_pEffectTarget;                           // Receives the term of one effect, maybe in its upper left part only.
+        gfx::BHandle         m_pPingPongTarget;                         // Second color target, effects alternate between it and the scene color target.
+
+        gfx::BHandle         m_pVertexConstantBuffer;                   // Screen matrix and scale of the quad.
+        gfx::BHandle         m_pPixelConstantBuffer;                    // Near and far distance, target size, and resolution scale.
+
+        gfx::BHandle         m_pVertexShader;                           // Projects the scaled quad onto the render target.
+        gfx::BHandle         m_pCompositePixelShader;                   // Bilateral upsampling and blending of the effect term.
+        gfx::BHandle         m_pUpsamplePixelShader;                    // Bilinear upsampling of a reduced scene to the frame buffer.
+        gfx::BHandle         m_pUpsampleMaterial;                       // Reads the color output of the last effect.
+        gfx::BHandle         m_pUpsampleMesh;                           // Full screen quad with the upsampling material.
+};
@@ -0,0 +1,439 @@
+
+#include "scene_store.h"
+
+#include "camera.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+using namespace gfx;
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Maps a non negative float to an integer with the same order.
+    // -----------------------------------------------------------------------------
+    unsigned int GetOrderedBits(float _Value)
+    {
+        unsigned int Bits;
+
+        _Value = std::max(_Value, 0.0f);
+
+        memcpy(&Bits, &_Value, sizeof(Bits));
+
+        return Bits;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CSceneStore::CSceneStore()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CSceneStore::~CSceneStore()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::Reserve(int _NumberOfEntities)
+{
+    m_PositionsX       .reserve(_NumberOfEntities);
+    m_PositionsY       .reserve(_NumberOfEntities);
+    m_PositionsZ       .reserve(_NumberOfEntities);
+    m_Radii            .reserve(_NumberOfEntities);
+    m_pMeshes          .reserve(_NumberOfEntities);
+    m_SortGroups       .reserve(_NumberOfEntities);
+    m_Slots            .reserve(_NumberOfEntities);
+    m_IndicesOfEntities.reserve(_NumberOfEntities);
+    m_Generations      .reserve(_NumberOfEntities);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::Clear()
+{
+    // -----------------------------------------------------------------------------
+    // Free all slots, but keep the generations, so old handles stay invalid.
+    // -----------------------------------------------------------------------------
+    while (m_Slots.empty() == false)
+    {
+        Destroy(GetEntity(static_cast<int>(m_Slots.size()) - 1));
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+SEntity CSceneStore::Create(BHandle _pMesh, int _SortGroup, const float* _pPosition, float _Radius)
+{
+    unsigned int Slot;
+
+    if (m_FreeSlots.empty())
+    {
+        Slot = static_cast<unsigned int>(m_Generations.size());
+
+        m_Generations      .push_back(1);
+        m_IndicesOfEntities.push_back(-1);
+    }
+    else
+    {
+        Slot = m_FreeSlots.back();
+
+        m_FreeSlots.pop_back();
+    }
+
+    m_IndicesOfEntities[Slot] = static_cast<int>(m_Slots.size());
+
+    m_PositionsX.push_back(_pPosition[0]);
+    m_PositionsY.push_back(_pPosition[1]);
+    m_PositionsZ.push_back(_pPosition[2]);
+    m_Radii     .push_back(_Radius);
+    m_pMeshes   .push_back(_pMesh);
+    m_SortGroups.push_back(_SortGroup);
+    m_Slots     .push_back(Slot);
+
+    SEntity Entity = { Slot, m_Generations[Slot] };
+
+    return Entity;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::Destroy(SEntity _Entity)
+{
+    int IndexOfEntity = GetIndexOfEntity(_Entity);
+
+    if (IndexOfEntity < 0) return;
+
+    // -----------------------------------------------------------------------------
+    // Move the last entity into the hole to keep the arrays dense.
+    // -----------------------------------------------------------------------------
+    int IndexOfLast = static_cast<int>(m_Slots.size()) - 1;
+
+    if (IndexOfEntity != IndexOfLast)
+    {
+        m_PositionsX[IndexOfEntity] = m_PositionsX[IndexOfLast];
+        m_PositionsY[IndexOfEntity] = m_PositionsY[IndexOfLast];
+        m_PositionsZ[IndexOfEntity] = m_PositionsZ[IndexOfLast];
+        m_Radii     [IndexOfEntity] = m_Radii     [IndexOfLast];
+        m_pMeshes   [IndexOfEntity] = m_pMeshes   [IndexOfLast];
+        m_SortGroups[IndexOfEntity] = m_SortGroups[IndexOfLast];
+        m_Slots     [IndexOfEntity] = m_Slots     [IndexOfLast];
+
+        m_IndicesOfEntities[m_Slots[IndexOfEntity]] = IndexOfEntity;
+    }
+
+    m_PositionsX.pop_back();
+    m_PositionsY.pop_back();
+    m_PositionsZ.pop_back();
+    m_Radii     .pop_back();
+    m_pMeshes   .pop_back();
+    m_SortGroups.pop_back();
+    m_Slots     .pop_back();
+
+    m_IndicesOfEntities[_Entity.m_Index] = -1;
+
+    // -----------------------------------------------------------------------------
+    // Skip generation 0 on overflow, it marks invalid handles.
+    // -----------------------------------------------------------------------------
+    if (++ m_Generations[_Entity.m_Index] == 0) m_Generations[_Entity.m_Index] = 1;
+
+    m_FreeSlots.push_back(_Entity.m_Index);
+}
+
+// -----------------------------------------------------------------------------
+
+bool CSceneStore::IsAlive(SEntity _Entity) const
+{
+    return GetIndexOfEntity(_Entity) >= 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int CSceneStore::GetNumberOfEntities() const
+{
+    return static_cast<int>(m_Slots.size());
+}
+
+// -----------------------------------------------------------------------------
+
+int CSceneStore::GetIndexOfEntity(SEntity _Entity) const
+{
+    if (_Entity.m_Index >= m_Generations.size() || m_Generations[_Entity.m_Index] != _Entity.m_Generation) return -1;
+
+    return m_IndicesOfEntities[_Entity.m_Index];
+}
+
+// -----------------------------------------------------------------------------
+
+SEntity CSceneStore::GetEntity(int _IndexOfEntity) const
+{
+    assert(_IndexOfEntity >= 0 && _IndexOfEntity < GetNumberOfEntities());
+
+    unsigned int Slot = m_Slots[_IndexOfEntity];
+
+    SEntity Entity = { Slot, m_Generations[Slot] };
+
+    return Entity;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::SetPosition(SEntity _Entity, const float* _pPosition)
+{
+    int IndexOfEntity = GetIndexOfEntity(_Entity);
+
+    if (IndexOfEntity < 0) return;
+
+    m_PositionsX[IndexOfEntity] = _pPosition[0];
+    m_PositionsY[IndexOfEntity] = _pPosition[1];
+    m_PositionsZ[IndexOfEntity] = _pPosition[2];
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::GetPosition(SEntity _Entity, float* _pPosition) const
+{
+    int IndexOfEntity = GetIndexOfEntity(_Entity);
+
+    if (IndexOfEntity < 0) return;
+
+    _pPosition[0] = m_PositionsX[IndexOfEntity];
+    _pPosition[1] = m_PositionsY[IndexOfEntity];
+    _pPosition[2] = m_PositionsZ[IndexOfEntity];
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::SetRadius(SEntity _Entity, float _Radius)
+{
+    int IndexOfEntity = GetIndexOfEntity(_Entity);
+
+    if (IndexOfEntity >= 0) m_Radii[IndexOfEntity] = _Radius;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::SetMesh(SEntity _Entity, BHandle _pMesh)
+{
+    int IndexOfEntity = GetIndexOfEntity(_Entity);
+
+    if (IndexOfEntity >= 0) m_pMeshes[IndexOfEntity] = _pMesh;
+}
+
+// -----------------------------------------------------------------------------
+
+float* CSceneStore::GetPositionsX()
+{
+    return m_PositionsX.data();
+}
+
+// -----------------------------------------------------------------------------
+
+float* CSceneStore::GetPositionsY()
+{
+    return m_PositionsY.data();
+}
+
+// -----------------------------------------------------------------------------
+
+float* CSceneStore::GetPositionsZ()
+{
+    return m_PositionsZ.data();
+}
+
+// -----------------------------------------------------------------------------
+
+const float* CSceneStore::GetRadii() const
+{
+    return m_Radii.data();
+}
+
+// -----------------------------------------------------------------------------
+
+const BHandle* CSceneStore::GetMeshes() const
+{
+    return m_pMeshes.data();
+}
+
+// -----------------------------------------------------------------------------
+
+const int* CSceneStore::GetSortGroups() const
+{
+    return m_SortGroups.data();
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::Cull(const float* _pViewProjectionMatrix, std::vector<int>& _rVisible) const
+{
+    size_t First = _rVisible.size();
+
+    _rVisible.resize(First + GetNumberOfEntities());
+
+    int NumberOfVisible = Cull(_pViewProjectionMatrix, _rVisible.data() + First);
+
+    _rVisible.resize(First + NumberOfVisible);
+}
+
+// -----------------------------------------------------------------------------
+
+int CSceneStore::Cull(const float* _pViewProjectionMatrix, int* _pVisible) const
+{
+    float Planes[6][4];
+
+    GetFrustumPlanes(_pViewProjectionMatrix, Planes);
+
+    return CullRange(Planes, 0, GetNumberOfEntities(), _pVisible);
+}
+
+// -----------------------------------------------------------------------------
+
+int CSceneStore::Cull(const float (*_pFrustumPlanes)[4], int* _pVisible) const
+{
+    return CullRange(_pFrustumPlanes, 0, GetNumberOfEntities(), _pVisible);
+}
+
+// -----------------------------------------------------------------------------
+
+int CSceneStore::Cull(const float* _pViewProjectionMatrix, int* _pVisible, CJobSystem& _rJobSystem) const
+{
+    float Planes[6][4];
+
+    GetFrustumPlanes(_pViewProjectionMatrix, Planes);
+
+    // -----------------------------------------------------------------------------
+    // Each block writes its visible indices to its own part of the output, which
+    // starts at the first index of the block. Afterwards the parts are moved
+    // together in order. The number of blocks is limited, so their counts fit on
+    // the stack.
+    // -----------------------------------------------------------------------------
+    const int MaximumNumberOfBlocks = 64;
+
+    int NumberOfEntities = GetNumberOfEntities();
+    int BlockSize        = std::max((NumberOfEntities + MaximumNumberOfBlocks - 1) / MaximumNumberOfBlocks, 4096);
+    int NumberOfBlocks   = (NumberOfEntities + BlockSize - 1) / BlockSize;
+
+    if (NumberOfBlocks <= 1) return CullRange(Planes, 0, NumberOfEntities, _pVisible);
+
+    int NumberOfVisibleOfBlocks[MaximumNumberOfBlocks];
+
+    _rJobSystem.ParallelFor(NumberOfBlocks, 1, [&](int _IndexOfBlock)
+    {
+        int First = _IndexOfBlock * BlockSize;
+        int Last  = std::min(First + BlockSize, NumberOfEntities);
+
+        NumberOfVisibleOfBlocks[_IndexOfBlock] = CullRange(Planes, First, Last, _pVisible + First);
+    });
+
+    int NumberOfVisible = NumberOfVisibleOfBlocks[0];
+
+    for (int IndexOfBlock = 1; IndexOfBlock < NumberOfBlocks; ++ IndexOfBlock)
+    {
+        memmove(_pVisible + NumberOfVisible, _pVisible + IndexOfBlock * BlockSize, NumberOfVisibleOfBlocks[IndexOfBlock] * sizeof(int));
+
+        NumberOfVisible += NumberOfVisibleOfBlocks[IndexOfBlock];
+    }
+
+    return NumberOfVisible;
+}
+
+// -----------------------------------------------------------------------------
+
+int CSceneStore::CullRange(const float (*_pPlanes)[4], int _First, int _Last, int* _pVisible) const
+{
+    const float* pX      = m_PositionsX.data();
+    const float* pY      = m_PositionsY.data();
+    const float* pZ      = m_PositionsZ.data();
+    const float* pRadius = m_Radii.data();
+
+    // -----------------------------------------------------------------------------
+    // The tests of a block run without branches, so the compiler vectorizes the
+    // inner loop. Only the compaction of the visible indices branches.
+    // -----------------------------------------------------------------------------
+    const int BlockSize = 256;
+
+    float Distances[BlockSize];
+
+    int NumberOfVisible = 0;
+
+    for (int First = _First; First < _Last; First += BlockSize)
+    {
+        int Count = std::min(BlockSize, _Last - First);
+
+        for (int Index = 0; Index < Count; ++ Index)
+        {
+            Distances[Index] = pRadius[First + Index];
+        }
+
+        for (int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+        {
+            float A = _pPlanes[IndexOfPlane][0];
+            float B = _pPlanes[IndexOfPlane][1];
+            float C = _pPlanes[IndexOfPlane][2];
+            float D = _pPlanes[IndexOfPlane][3];
+
+            for (int Index = 0; Index < Count; ++ Index)
+            {
+                float Distance = A * pX[First + Index] + B * pY[First + Index] + C * pZ[First + Index] + D + pRadius[First + Index];
+
+                Distances[Index] = std::min(Distances[Index], Distance);
+            }
+        }
+
+        for (int Index = 0; Index < Count; ++ Index)
+        {
+            if (Distances[Index] >= 0.0f) _pVisible[NumberOfVisible ++] = First + Index;
+        }
+    }
+
+    return NumberOfVisible;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::Sort(const std::vector<int>& _rVisible, const float* _pEyePosition, SSortOrder::EOrder _Order, std::vector<SSceneDraw>& _rDraws) const
+{
+    size_t First = _rDraws.size();
+
+    _rDraws.resize(First + _rVisible.size());
+
+    Sort(_rVisible.data(), static_cast<int>(_rVisible.size()), _pEyePosition, _Order, _rDraws.data() + First);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSceneStore::Sort(const int* _pVisible, int _NumberOfVisible, const float* _pEyePosition, SSortOrder::EOrder _Order, SSceneDraw* _pDraws) const
+{
+    // -----------------------------------------------------------------------------
+    // The key holds the sort group in the upper 32 bits and the squared distance
+    // in the lower ones. The bits of a non negative float sort like the float.
+    // -----------------------------------------------------------------------------
+    for (int IndexOfVisible = 0; IndexOfVisible < _NumberOfVisible; ++ IndexOfVisible)
+    {
+        int IndexOfEntity = _pVisible[IndexOfVisible];
+
+        float DeltaX = m_PositionsX[IndexOfEntity] - _pEyePosition[0];
+        float DeltaY = m_PositionsY[IndexOfEntity] - _pEyePosition[1];
+        float DeltaZ = m_PositionsZ[IndexOfEntity] - _pEyePosition[2];
+
+        unsigned long long Distance = GetOrderedBits(DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ);
+        unsigned long long Group    = static_cast<unsigned int>(m_SortGroups[IndexOfEntity]);
+
+        SSceneDraw& rDraw = _pDraws[IndexOfVisible];
+
+        rDraw.m_Key           = _Order == SSortOrder::FrontToBack ? (Group << 32) | Distance : 0xFFFFFFFFull - Distance;
+        rDraw.m_IndexOfEntity = IndexOfEntity;
+    }
+
+    std::sort(_pDraws, _pDraws + _NumberOfVisible, [](const SSceneDraw& _rLeft, const SSceneDraw& _rRight)
+    {
+        return _rLeft.m_Key < _rRight.m_Key;
+    });
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include <vector>
+
+class CJobSystem;
+
+// -----------------------------------------------------------------------------
+// Stable handle of an entity. The index addresses a slot of the store, the
+// generation is increased each time the slot is freed, so handles of destroyed
+// entities are detected even if the slot is reused. Generation 0 is never
+// used, a zero initialized handle is invalid.
+// -----------------------------------------------------------------------------
+struct SEntity
+{
+    unsigned int m_Index;
+    unsigned int m_Generation;
+};
+
+// -----------------------------------------------------------------------------
+
+struct SSortOrder
+{
+    enum EOrder
+    {
+        FrontToBack,                                                    ///< Opaque objects, nearest first within each sort group.
+        BackToFront,                                                    ///< Blended objects, farthest first, sort groups are ignored.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// One entry of the sorted draw list. The key is only used for sorting.
+// -----------------------------------------------------------------------------
+struct SSceneDraw
+{
+    unsigned long long m_Key;
+    int                m_IndexOfEntity;                                 // Dense index of the entity, valid until the next 'Destroy'.
+};
+
+// -----------------------------------------------------------------------------
+// Data oriented store for the objects of a scene. Positions, bounding radii,
+// meshes, and sort groups (e.g. the material) are kept in separate dense
+// arrays without holes, so the systems below run over contiguous memory.
+// Destroying an entity moves the last one into its place, therefore dense
+// indices change and only handles are stable.
+// -----------------------------------------------------------------------------
+class CSceneStore
+{
+    public:
+
+        CSceneStore();
+        ~CSceneStore();
+
+    public:
+
+        void    Reserve(int _NumberOfEntities);
+        void    Clear();
+
+        SEntity Create(gfx::BHandle _pMesh, int _SortGroup, const float* _pPosition, float _Radius);
+        void    Destroy(SEntity _Entity);
+
+        bool    IsAlive(SEntity _Entity) const;
+        int     GetNumberOfEntities() const;
+
+        int     GetIndexOfEntity(SEntity _Entity) const;                // Dense index or -1 if the entity is not alive.
+        SEntity GetEntity(int _IndexOfEntity) const;
+
+    public:
+
+        void    SetPosition(SEntity _Entity, const float* _pPosition);
+        void    GetPosition(SEntity _Entity, float* _pPosition) const;
+        void    SetRadius(SEntity _Entity, float _Radius);
+        void    SetMesh(SEntity _Entity, gfx::BHandle _pMesh);
+
+        // -----------------------------------------------------------------------------
+        // The dense arrays for systems, indexed by the dense index.
+        // -----------------------------------------------------------------------------
+        float*              GetPositionsX();
+        float*              GetPositionsY();
+        float*              GetPositionsZ();
+        const float*        GetRadii() const;
+        const gfx::BHandle* GetMeshes() const;
+        const int*          GetSortGroups() const;
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Tests the bounding spheres against the six planes of the view frustum
+        // and appends the dense indices of the visible entities. The second version
+        // writes them to an array with room for all entities and returns their number.
+        // The third version culls blocks of entities as jobs and returns the same
+        // indices in the same order. The last one takes the frustum planes of a
+        // camera snapshot instead of the matrix.
+        // -----------------------------------------------------------------------------
+        void Cull(const float* _pViewProjectionMatrix, std::vector<int>& _rVisible) const;
+        int  Cull(const float* _pViewProjectionMatrix, int* _pVisible) const;
+        int  Cull(const float* _pViewProjectionMatrix, int* _pVisible, CJobSystem& _rJobSystem) const;
+        int  Cull(const float (*_pFrustumPlanes)[4], int* _pVisible) const;
+
+        // -----------------------------------------------------------------------------
+        // Sorts the visible entities by sort group and distance to the eye.
+        // -----------------------------------------------------------------------------
+        void Sort(const std::vector<int>& _rVisible, const float* _pEyePosition, SSortOrder::EOrder _Order, std::vector<SSceneDraw>& _rDraws) const;
+        void Sort(const int* _pVisible, int _NumberOfVisible, const float* _pEyePosition, SSortOrder::EOrder _Order, SSceneDraw* _pDraws) const;
+
+    private:
+
+        std::vector<float>        m_PositionsX;                         // Dense, one entry per entity.
+        std::vector<float>        m_PositionsY;
+        std::vector<float>        m_PositionsZ;
+        std::vector<float>        m_Radii;
+        std::vector<gfx::BHandle> m_pMeshes;
+        std::vector<int>          m_SortGroups;
+        std::vector<unsigned int> m_Slots;                              // Dense index to slot.
+
+        std::vector<int>          m_IndicesOfEntities;                  // Slot to dense index, -1 for free slots.
+        std::vector<unsigned int> m_Generations;                        // Current generation of each slot.
+        std::vector<unsigned int> m_FreeSlots;
+
+    private:
+
+        int  CullRange(const float (*_pPlanes)[4], int _First, int _Last, int* _pVisible) const;
+};
@@ -0,0 +1,456 @@
+
+#include "static_batch.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <math.h>
+#include <numeric>
+
+using namespace gfx;
+
+namespace
+{
+    void TransformPoint(const float* _pPoint, const float* _pMatrix, float* _pResult)
+    {
+        const float* M = _pMatrix;
+
+        float X = _pPoint[0];
+        float Y = _pPoint[1];
+        float Z = _pPoint[2];
+
+        _pResult[0] = X * M[0] + Y * M[4] + Z * M[ 8] + M[12];
+        _pResult[1] = X * M[1] + Y * M[5] + Z * M[ 9] + M[13];
+        _pResult[2] = X * M[2] + Y * M[6] + Z * M[10] + M[14];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void TransformDirection(const float* _pDirection, const float* _pMatrix, float* _pResult)
+    {
+        const float* M = _pMatrix;
+
+        float X = _pDirection[0] * M[0] + _pDirection[1] * M[4] + _pDirection[2] * M[ 8];
+        float Y = _pDirection[0] * M[1] + _pDirection[1] * M[5] + _pDirection[2] * M[ 9];
+        float Z = _pDirection[0] * M[2] + _pDirection[1] * M[6] + _pDirection[2] * M[10];
+
+        float Length = sqrtf(X * X + Y * Y + Z * Z);
+
+        float Scale = Length > 0.0f ? 1.0f / Length : 0.0f;
+
+        _pResult[0] = X * Scale;
+        _pResult[1] = Y * Scale;
+        _pResult[2] = Z * Scale;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Returns the smallest signed distance of the sphere to the six planes, i.e.
+    // a value below -radius if the sphere is outside and one of at least the
+    // radius if it is completely inside.
+    // -----------------------------------------------------------------------------
+    float GetDistance(const float (*_pPlanes)[4], const float* _pCenter)
+    {
+        float Distance = 3.402823466e+38f;
+
+        for (int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+        {
+            const float* pPlane = _pPlanes[IndexOfPlane];
+
+            Distance = std::min(Distance, pPlane[0] * _pCenter[0] + pPlane[1] * _pCenter[1] + pPlane[2] * _pCenter[2] + pPlane[3]);
+        }
+
+        return Distance;
+    }
+} // namespace
+
+CStaticBatcher::CStaticBatcher()
+    : m_CellSize               (0.0f)
+    , m_MaximumNumberOfVertices(65536)
+{
+    m_Layout.m_NumberOfFloats     = 3;
+    m_Layout.m_OffsetOfPosition   = 0;
+    m_Layout.m_NumberOfDirections = 0;
+    m_Layout.m_HasOrigin          = false;
+    m_Layout.m_HasAtlasRect       = false;
+}
+
+// -----------------------------------------------------------------------------
+
+CStaticBatcher::~CStaticBatcher()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CStaticBatcher::SetLayout(const SStaticVertexLayout& _rLayout)
+{
+    assert(_rLayout.m_NumberOfDirections <= 4);
+
+    m_Layout = _rLayout;
+}
+
+// -----------------------------------------------------------------------------
+
+void CStaticBatcher::SetCellSize(float _CellSize)
+{
+    m_CellSize = _CellSize;
+}
+
+// -----------------------------------------------------------------------------
+
+void CStaticBatcher::SetMaximumNumberOfVertices(int _NumberOfVertices)
+{
+    m_MaximumNumberOfVertices = _NumberOfVertices;
+}
+
+// -----------------------------------------------------------------------------
+
+int CStaticBatcher::AddInstance(BHandle _pMaterial, const SStaticMesh& _rMesh, const float* _pWorldMatrix)
+{
+    static const float s_FullRect[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    return AddInstance(_pMaterial, _rMesh, _pWorldMatrix, s_FullRect);
+}
+
+// -----------------------------------------------------------------------------
+
+int CStaticBatcher::AddInstance(BHandle _pMaterial, const SStaticMesh& _rMesh, const float* _pWorldMatrix, const float* _pAtlasRect)
+{
+    SInstance Instance;
+
+    Instance.m_pMaterial = _pMaterial;
+    Instance.m_Mesh      = _rMesh;
+
+    std::copy(_pWorldMatrix, _pWorldMatrix + 16, Instance.m_WorldMatrix);
+    std::copy(_pAtlasRect  , _pAtlasRect   +  4, Instance.m_AtlasRect  );
+
+    m_Instances.push_back(Instance);
+
+    return static_cast<int>(m_Instances.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+void CStaticBatcher::Build()
+{
+    m_Batches.clear();
+    m_Ranges .clear();
+
+    // -----------------------------------------------------------------------------
+    // Without a cell size the whole scene is one cell. The cell is the one of the
+    // origin of the instance, so an instance belongs to exactly one cell.
+    // -----------------------------------------------------------------------------
+    for (SInstance& rInstance : m_Instances)
+    {
+        for (int Axis = 0; Axis < 3; ++ Axis)
+        {
+            rInstance.m_Cell[Axis] = m_CellSize > 0.0f ? static_cast<int>(floorf(rInstance.m_WorldMatrix[12 + Axis] / m_CellSize)) : 0;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Sort the instances by material and cell. The sort is stable, so the ranges
+    // of a batch are in the order in which the instances were added. The handles
+    // are unrelated pointers, only 'std::less' orders them totally.
+    // -----------------------------------------------------------------------------
+    std::vector<int> Order(m_Instances.size());
+
+    std::iota(Order.begin(), Order.end(), 0);
+
+    std::stable_sort(Order.begin(), Order.end(), [&](int _Left, int _Right)
+    {
+        const SInstance& rLeft  = m_Instances[_Left];
+        const SInstance& rRight = m_Instances[_Right];
+
+        if (rLeft.m_pMaterial != rRight.m_pMaterial) return std::less<BHandle>()(rLeft.m_pMaterial, rRight.m_pMaterial);
+
+        return std::lexicographical_compare(rLeft.m_Cell, rLeft.m_Cell + 3, rRight.m_Cell, rRight.m_Cell + 3);
+    });
+
+    const SInstance* pPrevious = nullptr;
+
+    for (int IndexOfInstance : Order)
+    {
+        const SInstance& rInstance = m_Instances[IndexOfInstance];
+
+        bool IsNewBatch = pPrevious == nullptr || rInstance.m_pMaterial != pPrevious->m_pMaterial || std::equal(rInstance.m_Cell, rInstance.m_Cell + 3, pPrevious->m_Cell) == false;
+
+        if (IsNewBatch == false)
+        {
+            const SStaticBatch& rBatch = m_Batches.back();
+
+            int NumberOfVertices = static_cast<int>(rBatch.m_Vertices.size()) / GetNumberOfFloats();
+
+            IsNewBatch = NumberOfVertices + rInstance.m_Mesh.m_NumberOfVertices > m_MaximumNumberOfVertices;
+        }
+
+        if (IsNewBatch)
+        {
+            SStaticBatch Batch;
+
+            Batch.m_pMaterial      = rInstance.m_pMaterial;
+            Batch.m_FirstRange     = static_cast<int>(m_Ranges.size());
+            Batch.m_NumberOfRanges = 0;
+            Batch.m_WSCenter[0]    = 0.0f;
+            Batch.m_WSCenter[1]    = 0.0f;
+            Batch.m_WSCenter[2]    = 0.0f;
+            Batch.m_Radius         = 0.0f;
+
+            m_Batches.push_back(std::move(Batch));
+        }
+
+        AddToBatch(rInstance, IndexOfInstance, m_Batches.back());
+
+        pPrevious = &rInstance;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The sphere of a batch is centered on the box around the spheres of its
+    // instances, which is tight enough for instances spread over a cell.
+    // -----------------------------------------------------------------------------
+    for (SStaticBatch& rBatch : m_Batches)
+    {
+        float Min[3] = {  3.402823466e+38f,  3.402823466e+38f,  3.402823466e+38f };
+        float Max[3] = { -3.402823466e+38f, -3.402823466e+38f, -3.402823466e+38f };
+
+        for (int IndexOfRange = rBatch.m_FirstRange; IndexOfRange < rBatch.m_FirstRange + rBatch.m_NumberOfRanges; ++ IndexOfRange)
+        {
+            const SStaticRange& rRange = m_Ranges[IndexOfRange];
+
+            for (int Axis = 0; Axis < 3; ++ Axis)
+            {
+                Min[Axis] = std::min(Min[Axis], rRange.m_WSCenter[Axis] - rRange.m_Radius);
+                Max[Axis] = std::max(Max[Axis], rRange.m_WSCenter[Axis] + rRange.m_Radius);
+            }
+        }
+
+        for (int Axis = 0; Axis < 3; ++ Axis) rBatch.m_WSCenter[Axis] = (Min[Axis] + Max[Axis]) * 0.5f;
+
+        for (int IndexOfRange = rBatch.m_FirstRange; IndexOfRange < rBatch.m_FirstRange + rBatch.m_NumberOfRanges; ++ IndexOfRange)
+        {
+            const SStaticRange& rRange = m_Ranges[IndexOfRange];
+
+            float X = rRange.m_WSCenter[0] - rBatch.m_WSCenter[0];
+            float Y = rRange.m_WSCenter[1] - rBatch.m_WSCenter[1];
+            float Z = rRange.m_WSCenter[2] - rBatch.m_WSCenter[2];
+
+            rBatch.m_Radius = std::max(rBatch.m_Radius, sqrtf(X * X + Y * Y + Z * Z) + rRange.m_Radius);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CStaticBatcher::Clear()
+{
+    m_Instances.clear();
+    m_Batches  .clear();
+    m_Ranges   .clear();
+}
+
+// -----------------------------------------------------------------------------
+
+int CStaticBatcher::GetNumberOfInstances() const
+{
+    return static_cast<int>(m_Instances.size());
+}
+
+// -----------------------------------------------------------------------------
+
+int CStaticBatcher::GetNumberOfBatches() const
+{
+    return static_cast<int>(m_Batches.size());
+}
+
+// -----------------------------------------------------------------------------
+
+const SStaticBatch& CStaticBatcher::GetBatch(int _IndexOfBatch) const
+{
+    return m_Batches[_IndexOfBatch];
+}
+
+// -----------------------------------------------------------------------------
+
+const SStaticRange& CStaticBatcher::GetRange(int _IndexOfRange) const
+{
+    return m_Ranges[_IndexOfRange];
+}
+
+// -----------------------------------------------------------------------------
+
+int CStaticBatcher::GetNumberOfFloats() const
+{
+    return m_Layout.m_NumberOfFloats + (m_Layout.m_HasOrigin ? 3 : 0) + (m_Layout.m_HasAtlasRect ? 4 : 0);
+}
+
+// -----------------------------------------------------------------------------
+
+void CStaticBatcher::GetMeshInfo(int _IndexOfBatch, BHandle _pMaterial, SMeshInfo& _rMeshInfo)
+{
+    SStaticBatch& rBatch = m_Batches[_IndexOfBatch];
+
+    _rMeshInfo.m_pVertices        = rBatch.m_Vertices.data();
+    _rMeshInfo.m_NumberOfVertices = static_cast<int>(rBatch.m_Vertices.size()) / GetNumberOfFloats();
+    _rMeshInfo.m_pIndices         = rBatch.m_Indices.data();
+    _rMeshInfo.m_NumberOfIndices  = static_cast<int>(rBatch.m_Indices.size());
+    _rMeshInfo.m_pMaterial        = _pMaterial;
+}
+
+// -----------------------------------------------------------------------------
+
+int CStaticBatcher::Cull(const float (*_pFrustumPlanes)[4], SStaticDraw* _pDraws) const
+{
+    int NumberOfDraws = 0;
+
+    for (int IndexOfBatch = 0; IndexOfBatch < GetNumberOfBatches(); ++ IndexOfBatch)
+    {
+        const SStaticBatch& rBatch = m_Batches[IndexOfBatch];
+
+        float Distance = GetDistance(_pFrustumPlanes, rBatch.m_WSCenter);
+
+        if (Distance < -rBatch.m_Radius) continue;
+
+        // -----------------------------------------------------------------------------
+        // A batch completely inside the frustum is drawn as a whole, the ranges of
+        // a batch crossing a plane are tested one by one.
+        // -----------------------------------------------------------------------------
+        if (Distance >= rBatch.m_Radius)
+        {
+            SStaticDraw& rDraw = _pDraws[NumberOfDraws ++];
+
+            rDraw.m_IndexOfBatch    = IndexOfBatch;
+            rDraw.m_FirstIndex      = 0;
+            rDraw.m_NumberOfIndices = static_cast<int>(rBatch.m_Indices.size());
+
+            continue;
+        }
+
+        int NumberOfBatchDraws = 0;
+
+        for (int IndexOfRange = rBatch.m_FirstRange; IndexOfRange < rBatch.m_FirstRange + rBatch.m_NumberOfRanges; ++ IndexOfRange)
+        {
+            const SStaticRange& rRange = m_Ranges[IndexOfRange];
+
+            if (GetDistance(_pFrustumPlanes, rRange.m_WSCenter) < -rRange.m_Radius) continue;
+
+            if (NumberOfBatchDraws > 0)
+            {
+                SStaticDraw& rLastDraw = _pDraws[NumberOfDraws - 1];
+
+                if (rLastDraw.m_FirstIndex + rLastDraw.m_NumberOfIndices == rRange.m_FirstIndex)
+                {
+                    rLastDraw.m_NumberOfIndices += rRange.m_NumberOfIndices;
+
+                    continue;
+                }
+            }
+
+            SStaticDraw& rDraw = _pDraws[NumberOfDraws ++];
+
+            rDraw.m_IndexOfBatch    = IndexOfBatch;
+            rDraw.m_FirstIndex      = rRange.m_FirstIndex;
+            rDraw.m_NumberOfIndices = rRange.m_NumberOfIndices;
+
+            ++ NumberOfBatchDraws;
+        }
+    }
+
+    return NumberOfDraws;
+}
+
+// -----------------------------------------------------------------------------
+
+void CStaticBatcher::AddToBatch(const SInstance& _rInstance, int _IndexOfInstance, SStaticBatch& _rBatch)
+{
+    const SStaticMesh& rMesh = _rInstance.m_Mesh;
+
+    const float* pOrigin = &_rInstance.m_WorldMatrix[12];
+
+    int NumberOfFloats = GetNumberOfFloats();
+    int FirstVertex    = static_cast<int>(_rBatch.m_Vertices.size()) / NumberOfFloats;
+
+    SStaticRange Range;
+
+    Range.m_IndexOfInstance = _IndexOfInstance;
+    Range.m_FirstIndex      = static_cast<int>(_rBatch.m_Indices.size());
+    Range.m_NumberOfIndices = rMesh.m_NumberOfIndices;
+
+    // -----------------------------------------------------------------------------
+    // Copy the vertices and transform the position and the directions in place.
+    // -----------------------------------------------------------------------------
+    float Min[3] = {  3.402823466e+38f,  3.402823466e+38f,  3.402823466e+38f };
+    float Max[3] = { -3.402823466e+38f, -3.402823466e+38f, -3.402823466e+38f };
+
+    _rBatch.m_Vertices.resize(_rBatch.m_Vertices.size() + static_cast<size_t>(rMesh.m_NumberOfVertices) * NumberOfFloats);
+
+    float* pVertex = _rBatch.m_Vertices.data() + static_cast<size_t>(FirstVertex) * NumberOfFloats;
+
+    for (int IndexOfVertex = 0; IndexOfVertex < rMesh.m_NumberOfVertices; ++ IndexOfVertex, pVertex += NumberOfFloats)
+    {
+        const float* pSource = rMesh.m_pVertices + static_cast<size_t>(IndexOfVertex) * m_Layout.m_NumberOfFloats;
+
+        std::copy(pSource, pSource + m_Layout.m_NumberOfFloats, pVertex);
+
+        float* pPosition = pVertex + m_Layout.m_OffsetOfPosition;
+
+        TransformPoint(pSource + m_Layout.m_OffsetOfPosition, _rInstance.m_WorldMatrix, pPosition);
+
+        for (int IndexOfDirection = 0; IndexOfDirection < m_Layout.m_NumberOfDirections; ++ IndexOfDirection)
+        {
+            int Offset = m_Layout.m_OffsetsOfDirections[IndexOfDirection];
+
+            TransformDirection(pSource + Offset, _rInstance.m_WorldMatrix, pVertex + Offset);
+        }
+
+        if (m_Layout.m_HasOrigin)
+        {
+            std::copy(pOrigin, pOrigin + 3, pVertex + m_Layout.m_NumberOfFloats);
+        }
+
+        if (m_Layout.m_HasAtlasRect)
+        {
+            std::copy(_rInstance.m_AtlasRect, _rInstance.m_AtlasRect + 4, pVertex + m_Layout.m_NumberOfFloats + (m_Layout.m_HasOrigin ? 3 : 0));
+        }
+
+        for (int Axis = 0; Axis < 3; ++ Axis)
+        {
+            Min[Axis] = std::min(Min[Axis], pPosition[Axis]);
+            Max[Axis] = std::max(Max[Axis], pPosition[Axis]);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Vertices turning around the origin in the vertex shader stay within their
+    // distance to the origin, so the sphere is centered on it. Otherwise it is
+    // centered on the box of the transformed positions.
+    // -----------------------------------------------------------------------------
+    for (int Axis = 0; Axis < 3; ++ Axis)
+    {
+        Range.m_WSCenter[Axis] = m_Layout.m_HasOrigin ? pOrigin[Axis] : (Min[Axis] + Max[Axis]) * 0.5f;
+    }
+
+    Range.m_Radius = 0.0f;
+
+    pVertex = _rBatch.m_Vertices.data() + static_cast<size_t>(FirstVertex) * NumberOfFloats + m_Layout.m_OffsetOfPosition;
+
+    for (int IndexOfVertex = 0; IndexOfVertex < rMesh.m_NumberOfVertices; ++ IndexOfVertex, pVertex += NumberOfFloats)
+    {
+        float X = pVertex[0] - Range.m_WSCenter[0];
+        float Y = pVertex[1] - Range.m_WSCenter[1];
+        float Z = pVertex[2] - Range.m_WSCenter[2];
+
+        Range.m_Radius = std::max(Range.m_Radius, sqrtf(X * X + Y * Y + Z * Z));
+    }
+
+    // -----------------------------------------------------------------------------
+    // The indices are moved behind the vertices of the instances before.
+    // -----------------------------------------------------------------------------
+    for (int IndexOfIndex = 0; IndexOfIndex < rMesh.m_NumberOfIndices; ++ IndexOfIndex)
+    {
+        _rBatch.m_Indices.push_back(rMesh.m_pIndices[IndexOfIndex] + FirstVertex);
+    }
+
+    m_Ranges.push_back(Range);
+
+    ++ _rBatch.m_NumberOfRanges;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Vertex layout of the meshes of a batcher, counted in floats. The position is
+// transformed as point, the directions (normal, tangent, ...) without the
+// translation and normalized again. All other floats are copied unchanged.
+// -----------------------------------------------------------------------------
+struct SStaticVertexLayout
+{
+    int  m_NumberOfFloats;                                              // Floats per vertex of the source meshes.
+    int  m_OffsetOfPosition;
+    int  m_NumberOfDirections;
+    int  m_OffsetsOfDirections[4];
+    bool m_HasOrigin;                                                   // Appends the origin of the instance as three floats to each vertex, e.g. for billboards turning around it.
+    bool m_HasAtlasRect;                                                // Appends the atlas rect of the instance as four floats after the origin, see 'SAtlasRect::m_UVRect'.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SStaticMesh
+{
+    const float* m_pVertices;
+    int          m_NumberOfVertices;
+    const int*   m_pIndices;
+    int          m_NumberOfIndices;
+};
+
+// -----------------------------------------------------------------------------
+// The indices of one instance inside the index buffer of its batch and the
+// sphere bounding the instance in world space.
+// -----------------------------------------------------------------------------
+struct SStaticRange
+{
+    int   m_IndexOfInstance;
+    int   m_FirstIndex;
+    int   m_NumberOfIndices;
+    float m_WSCenter[3];
+    float m_Radius;
+};
+
+// -----------------------------------------------------------------------------
+// The pre-transformed instances of one material in one cell of the scene. The
+// ranges of the instances follow each other without gaps in the index buffer.
+// -----------------------------------------------------------------------------
+struct SStaticBatch
+{
+    gfx::BHandle       m_pMaterial;
+    std::vector<float> m_Vertices;
+    std::vector<int>   m_Indices;
+    int                m_FirstRange;
+    int                m_NumberOfRanges;
+    float              m_WSCenter[3];                                   // Sphere bounding all instances of the batch.
+    float              m_Radius;
+};
+
+// -----------------------------------------------------------------------------
+// One draw of the culling result, a part of the index buffer of a batch. The
+// visible ranges which follow each other are merged into one draw.
+// -----------------------------------------------------------------------------
+struct SStaticDraw
+{
+    int m_IndexOfBatch;
+    int m_FirstIndex;
+    int m_NumberOfIndices;
+};
+
+// -----------------------------------------------------------------------------
+// Static batching. The static instances of a scene are added once while the
+// scene is built. 'Build' transforms their vertices into world space and
+// merges the instances sharing a material into one vertex and index buffer,
+// so all of them cost a single draw, one constant upload, and one material
+// switch per frame instead of one per instance.
+//
+// The scene is divided into cells, instances in different cells never share a
+// batch, and a batch is limited in size. Each instance keeps its range in the
+// index buffer, so culling still works per instance: batches completely inside
+// the frustum are one draw, the ranges of the others are tested one by one.
+// YoshiX can only draw complete meshes, so the examples draw a batch if one of
+// its ranges is visible; the ranges are what a renderer with indexed draws of
+// a part of a buffer would submit.
+// -----------------------------------------------------------------------------
+class CStaticBatcher
+{
+    public:
+
+        CStaticBatcher();
+        ~CStaticBatcher();
+
+    public:
+
+        void SetLayout(const SStaticVertexLayout& _rLayout);
+        void SetCellSize(float _CellSize);                              // Edge length of the cells in world units.
+        void SetMaximumNumberOfVertices(int _NumberOfVertices);         // Per batch, larger instances get a batch of their own.
+
+        // -----------------------------------------------------------------------------
+        // Returns the index of the instance. The mesh is only referenced, it has to
+        // stay valid until 'Build'.
+        // -----------------------------------------------------------------------------
+        int  AddInstance(gfx::BHandle _pMaterial, const SStaticMesh& _rMesh, const float* _pWorldMatrix);
+        int  AddInstance(gfx::BHandle _pMaterial, const SStaticMesh& _rMesh, const float* _pWorldMatrix, const float* _pAtlasRect);
+        void Build();
+        void Clear();
+
+    public:
+
+        int                 GetNumberOfInstances() const;
+        int                 GetNumberOfBatches() const;
+        const SStaticBatch& GetBatch(int _IndexOfBatch) const;
+        const SStaticRange& GetRange(int _IndexOfRange) const;
+        int                 GetNumberOfFloats() const;                  // Floats per vertex of the batches.
+
+        // -----------------------------------------------------------------------------
+        // The mesh info of a batch for 'CreateMesh'. The vertices and indices are
+        // owned by the batcher and stay valid until the next 'Build' or 'Clear'.
+        // -----------------------------------------------------------------------------
+        void GetMeshInfo(int _IndexOfBatch, gfx::BHandle _pMaterial, gfx::SMeshInfo& _rMeshInfo);
+
+        // -----------------------------------------------------------------------------
+        // Writes the draws of the visible instances to an array with room for one
+        // draw per instance and returns their number. The planes are the ones of a
+        // camera snapshot.
+        // -----------------------------------------------------------------------------
+        int Cull(const float (*_pFrustumPlanes)[4], SStaticDraw* _pDraws) const;
+
+    private:
+
+        struct SInstance
+        {
+            gfx::BHandle m_pMaterial;
+            SStaticMesh  m_Mesh;
+            float        m_WorldMatrix[16];
+            float        m_AtlasRect[4];
+            int          m_Cell[3];                                     // The cell of the origin of the instance.
+        };
+
+    private:
+
+        void AddToBatch(const SInstance& _rInstance, int _IndexOfInstance, SStaticBatch& _rBatch);
+
+    private:
+
+        SStaticVertexLayout       m_Layout;
+        float                     m_CellSize;
+        int                       m_MaximumNumberOfVertices;
+        std::vector<SInstance>    m_Instances;
+        std::vector<SStaticBatch> m_Batches;
+        std::vector<SStaticRange> m_Ranges;                             // The ranges of all batches, ordered by batch.
+};
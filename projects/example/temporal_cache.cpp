@@ -0,0 +1,394 @@
+#include "temporal_cache.h"
+
+#include "camera.h"
+#include "frame_statistics.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace
+{
+    const int s_RowsPerJob = 8;
+
+    // -----------------------------------------------------------------------------
+    // Moves a pixel center with its depth into the world. Returns false for
+    // depths behind the eye.
+    // -----------------------------------------------------------------------------
+    bool GetWorldPosition(const float* _pInverseViewProjectionMatrix, float _X, float _Y, float _Depth, int _Width, int _Height, float* _pPosition)
+    {
+        float NDC[4] = { _X / _Width * 2.0f - 1.0f, 1.0f - _Y / _Height * 2.0f, _Depth, 1.0f };
+
+        float Position[4];
+
+        for (int IndexOfColumn = 0; IndexOfColumn < 4; ++ IndexOfColumn)
+        {
+            Position[IndexOfColumn] = NDC[0] * _pInverseViewProjectionMatrix[ 0 + IndexOfColumn]
+                                    + NDC[1] * _pInverseViewProjectionMatrix[ 4 + IndexOfColumn]
+                                    + NDC[2] * _pInverseViewProjectionMatrix[ 8 + IndexOfColumn]
+                                    + NDC[3] * _pInverseViewProjectionMatrix[12 + IndexOfColumn];
+        }
+
+        if (Position[3] == 0.0f) return false;
+
+        _pPosition[0] = Position[0] / Position[3];
+        _pPosition[1] = Position[1] / Position[3];
+        _pPosition[2] = Position[2] / Position[3];
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetDistance(const float* _pA, const float* _pB)
+    {
+        float Delta[3] = { _pA[0] - _pB[0], _pA[1] - _pB[1], _pA[2] - _pB[2] };
+
+        return sqrtf(Delta[0] * Delta[0] + Delta[1] * Delta[1] + Delta[2] * Delta[2]);
+    }
+} // namespace
+
+CTemporalCache::CTemporalCache()
+    : m_Width         (0)
+    , m_Height        (0)
+    , m_IsValid       (false)
+    , m_IndexOfCurrent(0)
+{
+    m_Settings.m_ClearDepth        = 1.0f;
+    m_Settings.m_PositionTolerance = 0.02f;
+    m_Settings.m_NormalTolerance   = 0.95f;
+    m_Settings.m_MaximumAge        = 16;
+
+    ResetStatistics();
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::SetSettings(const STemporalCacheSettings& _rSettings)
+{
+    m_Settings = _rSettings;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::SetViewport(int _Width, int _Height)
+{
+    m_Width  = _Width;
+    m_Height = _Height;
+
+    for (int IndexOfFrame = 0; IndexOfFrame < 2; ++ IndexOfFrame)
+    {
+        m_Colors [IndexOfFrame].Resize(_Width, _Height, 4);
+        m_Depths [IndexOfFrame].Resize(_Width, _Height, 1);
+        m_Normals[IndexOfFrame].Resize(_Width, _Height, 4);
+
+        m_Ages[IndexOfFrame].assign(static_cast<size_t>(_Width) * _Height, 0);
+    }
+
+    m_States   .resize(static_cast<size_t>(_Width) * _Height);
+    m_RowCounts.resize(_Height);
+
+    m_IsValid = false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::Invalidate()
+{
+    m_IsValid = false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::Resolve(const SCameraSnapshot& _rCamera, const filter::SImage& _rDepthTarget, const filter::SImage& _rNormalTarget, FShadePixel _pShadePixel, void* _pUserData)
+{
+    BeginResolve(_rDepthTarget, _rNormalTarget);
+
+    for (int Y = 0; Y < m_Height; ++ Y) ReprojectRow(_rCamera, Y);
+    for (int Y = 0; Y < m_Height; ++ Y) ShadeRow(Y, _pShadePixel, _pUserData);
+
+    EndResolve(_rCamera);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::Resolve(const SCameraSnapshot& _rCamera, const filter::SImage& _rDepthTarget, const filter::SImage& _rNormalTarget, FShadePixel _pShadePixel, void* _pUserData, CJobSystem& _rJobSystem)
+{
+    BeginResolve(_rDepthTarget, _rNormalTarget);
+
+    _rJobSystem.ParallelFor(m_Height, s_RowsPerJob, [&](int _Y)
+    {
+        ReprojectRow(_rCamera, _Y);
+    });
+
+    _rJobSystem.ParallelFor(m_Height, s_RowsPerJob, [&](int _Y)
+    {
+        ShadeRow(_Y, _pShadePixel, _pUserData);
+    });
+
+    EndResolve(_rCamera);
+}
+
+// -----------------------------------------------------------------------------
+
+filter::SImage CTemporalCache::GetColorTarget()
+{
+    return m_Colors[m_IndexOfCurrent].GetView();
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::GetStatistics(STemporalCacheStatistics& _rStatistics) const
+{
+    _rStatistics = m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::ResetStatistics()
+{
+    memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::BeginResolve(const filter::SImage& _rDepthTarget, const filter::SImage& _rNormalTarget)
+{
+    assert(_rDepthTarget .m_Width == m_Width && _rDepthTarget .m_Height == m_Height && _rDepthTarget .m_NumberOfChannels == 1);
+    assert(_rNormalTarget.m_Width == m_Width && _rNormalTarget.m_Height == m_Height && _rNormalTarget.m_NumberOfChannels >= 3);
+
+    // -----------------------------------------------------------------------------
+    // The targets of the caller are overwritten by the next frame, so the cache
+    // keeps its own copy of depth and normal.
+    // -----------------------------------------------------------------------------
+    m_IndexOfCurrent = 1 - m_IndexOfCurrent;
+
+    float* pDepths  = m_Depths [m_IndexOfCurrent].GetView().m_pPixels;
+    float* pNormals = m_Normals[m_IndexOfCurrent].GetView().m_pPixels;
+
+    size_t NumberOfPixels = static_cast<size_t>(m_Width) * m_Height;
+
+    std::copy(_rDepthTarget.m_pPixels, _rDepthTarget.m_pPixels + NumberOfPixels, pDepths);
+
+    for (size_t IndexOfPixel = 0; IndexOfPixel < NumberOfPixels; ++ IndexOfPixel)
+    {
+        const float* pNormal = _rNormalTarget.m_pPixels + IndexOfPixel * _rNormalTarget.m_NumberOfChannels;
+
+        pNormals[IndexOfPixel * 4 + 0] = pNormal[0];
+        pNormals[IndexOfPixel * 4 + 1] = pNormal[1];
+        pNormals[IndexOfPixel * 4 + 2] = pNormal[2];
+        pNormals[IndexOfPixel * 4 + 3] = 0.0f;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::ReprojectRow(const SCameraSnapshot& _rCamera, int _Y)
+{
+    CStopwatch Stopwatch;
+
+    int IndexOfPreviousFrame = 1 - m_IndexOfCurrent;
+
+    size_t FirstPixel = static_cast<size_t>(_Y) * m_Width;
+
+    const float*         pDepths          = m_Depths [m_IndexOfCurrent].GetView().m_pPixels + FirstPixel;
+    const float*         pNormals         = m_Normals[m_IndexOfCurrent].GetView().m_pPixels + FirstPixel * 4;
+    float*               pColors          = m_Colors [m_IndexOfCurrent].GetView().m_pPixels + FirstPixel * 4;
+    unsigned char*       pAges            = m_Ages   [m_IndexOfCurrent].data()              + FirstPixel;
+    unsigned char*       pStates          = m_States.data()                                  + FirstPixel;
+
+    const float*         pPreviousDepths  = m_Depths [IndexOfPreviousFrame].GetView().m_pPixels;
+    const float*         pPreviousNormals = m_Normals[IndexOfPreviousFrame].GetView().m_pPixels;
+    const float*         pPreviousColors  = m_Colors [IndexOfPreviousFrame].GetView().m_pPixels;
+    const unsigned char* pPreviousAges    = m_Ages   [IndexOfPreviousFrame].data();
+
+    const float* pMatrix = m_PreviousViewProjectionMatrix;
+
+    int MaximumAge = m_Settings.m_MaximumAge > 0 ? std::min(m_Settings.m_MaximumAge, 255) : 255;
+
+    SRowCounts Counts = { 0, 0, 0, 0.0, 0.0 };
+
+    for (int X = 0; X < m_Width; ++ X)
+    {
+        float Depth = pDepths[X];
+
+        pAges[X] = 0;
+
+        if (Depth == m_Settings.m_ClearDepth)
+        {
+            pStates[X] = SPixelState::Background;
+
+            continue;
+        }
+
+        if (m_IsValid == false)
+        {
+            pStates[X] = SPixelState::Invalidated;
+
+            ++ Counts.m_NumberOfInvalidatedPixels;
+
+            continue;
+        }
+
+        // -----------------------------------------------------------------------------
+        // Project the surface of the pixel into the previous frame and take the
+        // pixel it falls into. A surface behind the previous eye or outside of
+        // the previous viewport was not visible.
+        // -----------------------------------------------------------------------------
+        float Position[3];
+
+        bool IsVisible = GetWorldPosition(_rCamera.m_InverseViewProjectionMatrix, X + 0.5f, _Y + 0.5f, Depth, m_Width, m_Height, Position);
+
+        float ClipX = Position[0] * pMatrix[0] + Position[1] * pMatrix[4] + Position[2] * pMatrix[ 8] + pMatrix[12];
+        float ClipY = Position[0] * pMatrix[1] + Position[1] * pMatrix[5] + Position[2] * pMatrix[ 9] + pMatrix[13];
+        float ClipW = Position[0] * pMatrix[3] + Position[1] * pMatrix[7] + Position[2] * pMatrix[11] + pMatrix[15];
+
+        int PreviousX = -1;
+        int PreviousY = -1;
+
+        if (IsVisible && ClipW > 0.0f)
+        {
+            PreviousX = static_cast<int>(floorf((ClipX / ClipW * 0.5f + 0.5f) * m_Width ));
+            PreviousY = static_cast<int>(floorf((0.5f - ClipY / ClipW * 0.5f) * m_Height));
+        }
+
+        if (PreviousX < 0 || PreviousX >= m_Width || PreviousY < 0 || PreviousY >= m_Height)
+        {
+            pStates[X] = SPixelState::Disoccluded;
+
+            ++ Counts.m_NumberOfDisoccludedPixels;
+
+            continue;
+        }
+
+        // -----------------------------------------------------------------------------
+        // The cached pixel shows the same surface if its own world position is
+        // close to the one of the current pixel. The tolerance grows with the
+        // distance to the eye like the footprint of a pixel.
+        // -----------------------------------------------------------------------------
+        size_t IndexOfPrevious = static_cast<size_t>(PreviousY) * m_Width + PreviousX;
+
+        float PreviousDepth = pPreviousDepths[IndexOfPrevious];
+
+        float PreviousPosition[3];
+
+        bool IsSameSurface = PreviousDepth != m_Settings.m_ClearDepth
+                          && GetWorldPosition(m_PreviousInverseViewProjectionMatrix, PreviousX + 0.5f, PreviousY + 0.5f, PreviousDepth, m_Width, m_Height, PreviousPosition)
+                          && GetDistance(Position, PreviousPosition) <= m_Settings.m_PositionTolerance * GetDistance(Position, _rCamera.m_EyePosition);
+
+        if (IsSameSurface == false)
+        {
+            pStates[X] = SPixelState::Disoccluded;
+
+            ++ Counts.m_NumberOfDisoccludedPixels;
+
+            continue;
+        }
+
+        const float* pNormal         = pNormals         + X * 4;
+        const float* pPreviousNormal = pPreviousNormals + IndexOfPrevious * 4;
+
+        float Cosine = pNormal[0] * pPreviousNormal[0] + pNormal[1] * pPreviousNormal[1] + pNormal[2] * pPreviousNormal[2];
+
+        if (Cosine < m_Settings.m_NormalTolerance || pPreviousAges[IndexOfPrevious] >= MaximumAge)
+        {
+            pStates[X] = SPixelState::Invalidated;
+
+            ++ Counts.m_NumberOfInvalidatedPixels;
+
+            continue;
+        }
+
+        std::copy(pPreviousColors + IndexOfPrevious * 4, pPreviousColors + IndexOfPrevious * 4 + 4, pColors + X * 4);
+
+        pAges  [X] = static_cast<unsigned char>(std::min(pPreviousAges[IndexOfPrevious] + 1, 255));
+        pStates[X] = SPixelState::Reused;
+
+        ++ Counts.m_NumberOfReusedPixels;
+    }
+
+    Counts.m_ReprojectionTime = Stopwatch.GetElapsedMilliseconds();
+
+    m_RowCounts[_Y] = Counts;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::ShadeRow(int _Y, FShadePixel _pShadePixel, void* _pUserData)
+{
+    size_t FirstPixel = static_cast<size_t>(_Y) * m_Width;
+
+    const float*         pDepths  = m_Depths [m_IndexOfCurrent].GetView().m_pPixels + FirstPixel;
+    const float*         pNormals = m_Normals[m_IndexOfCurrent].GetView().m_pPixels + FirstPixel * 4;
+    float*               pColors  = m_Colors [m_IndexOfCurrent].GetView().m_pPixels + FirstPixel * 4;
+    const unsigned char* pStates  = m_States.data()                                  + FirstPixel;
+
+    // -----------------------------------------------------------------------------
+    // The pixels with geometry are timed on their own, the background is much
+    // cheaper and would make the reused pixels look cheaper than they are.
+    // -----------------------------------------------------------------------------
+    CStopwatch Stopwatch;
+
+    for (int X = 0; X < m_Width; ++ X)
+    {
+        if (pStates[X] == SPixelState::Reused || pStates[X] == SPixelState::Background) continue;
+
+        _pShadePixel(X, _Y, pDepths[X], pNormals + X * 4, pColors + X * 4, _pUserData);
+    }
+
+    m_RowCounts[_Y].m_ShadingTime = Stopwatch.GetElapsedMilliseconds();
+
+    for (int X = 0; X < m_Width; ++ X)
+    {
+        if (pStates[X] != SPixelState::Background) continue;
+
+        _pShadePixel(X, _Y, pDepths[X], pNormals + X * 4, pColors + X * 4, _pUserData);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CTemporalCache::EndResolve(const SCameraSnapshot& _rCamera)
+{
+    SRowCounts Counts = { 0, 0, 0, 0.0, 0.0 };
+
+    for (const SRowCounts& rRow : m_RowCounts)
+    {
+        Counts.m_NumberOfReusedPixels      += rRow.m_NumberOfReusedPixels;
+        Counts.m_NumberOfDisoccludedPixels += rRow.m_NumberOfDisoccludedPixels;
+        Counts.m_NumberOfInvalidatedPixels += rRow.m_NumberOfInvalidatedPixels;
+        Counts.m_ReprojectionTime          += rRow.m_ReprojectionTime;
+        Counts.m_ShadingTime               += rRow.m_ShadingTime;
+    }
+
+    long long NumberOfPixels = Counts.m_NumberOfReusedPixels + Counts.m_NumberOfDisoccludedPixels + Counts.m_NumberOfInvalidatedPixels;
+
+    m_Statistics.m_NumberOfFrames            += 1;
+    m_Statistics.m_NumberOfPixels            += NumberOfPixels;
+    m_Statistics.m_NumberOfReusedPixels      += Counts.m_NumberOfReusedPixels;
+    m_Statistics.m_NumberOfDisoccludedPixels += Counts.m_NumberOfDisoccludedPixels;
+    m_Statistics.m_NumberOfInvalidatedPixels += Counts.m_NumberOfInvalidatedPixels;
+    m_Statistics.m_ReprojectionTime          += Counts.m_ReprojectionTime;
+    m_Statistics.m_ShadingTime               += Counts.m_ShadingTime;
+
+    // -----------------------------------------------------------------------------
+    // The reused pixels would have cost as much as the shaded ones on average,
+    // so far. A frame reusing all pixels has no shading time of its own.
+    // -----------------------------------------------------------------------------
+    long long ShadedPixels = m_Statistics.m_NumberOfPixels - m_Statistics.m_NumberOfReusedPixels;
+
+    if (ShadedPixels > 0)
+    {
+        m_Statistics.m_SavedTime += Counts.m_NumberOfReusedPixels * m_Statistics.m_ShadingTime / ShadedPixels;
+    }
+
+    m_Statistics.m_SavedTime -= Counts.m_ReprojectionTime;
+
+    std::copy(_rCamera.m_ViewProjectionMatrix       , _rCamera.m_ViewProjectionMatrix        + 16, m_PreviousViewProjectionMatrix);
+    std::copy(_rCamera.m_InverseViewProjectionMatrix, _rCamera.m_InverseViewProjectionMatrix + 16, m_PreviousInverseViewProjectionMatrix);
+
+    m_IsValid = true;
+}
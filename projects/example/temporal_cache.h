@@ -0,0 +1,136 @@
+#pragma once
+
+#include "image_filter.h"
+
+#include <vector>
+
+class  CJobSystem;
+struct SCameraSnapshot;
+
+// -----------------------------------------------------------------------------
+// Called for each pixel which cannot reuse the shading of the previous frame.
+// Writes the four channels of the color, the normal is the one of the normal
+// target in world space.
+// -----------------------------------------------------------------------------
+typedef void (*FShadePixel)(int _X, int _Y, float _Depth, const float* _pNormal, float* _pColor, void* _pUserData);
+
+// -----------------------------------------------------------------------------
+
+struct STemporalCacheSettings
+{
+    float m_ClearDepth;                                                 // Depth of pixels without geometry, they are always shaded.
+    float m_PositionTolerance;                                          // Largest distance of the reprojected position relative to its distance to the eye.
+    float m_NormalTolerance;                                            // Smallest cosine between the current and the cached normal.
+    int   m_MaximumAge;                                                 // Frames a shading is reused at most, 0 reuses forever.
+};
+
+// -----------------------------------------------------------------------------
+// Sums since the statistics were reset. Pixels without geometry are never
+// reused and not counted. The times are summed over the rows, so with jobs
+// they are the time of all threads together.
+// -----------------------------------------------------------------------------
+struct STemporalCacheStatistics
+{
+    int       m_NumberOfFrames;
+    long long m_NumberOfPixels;                                         // Pixels with geometry.
+    long long m_NumberOfReusedPixels;
+    long long m_NumberOfDisoccludedPixels;                              // Outside of the previous frame or hidden in it.
+    long long m_NumberOfInvalidatedPixels;                              // Changed normal, too old, or after 'Invalidate'.
+    double    m_ReprojectionTime;                                       // Milliseconds.
+    double    m_ShadingTime;                                            // Milliseconds for the shaded pixels with geometry.
+    double    m_SavedTime;                                              // Milliseconds the reused pixels would have needed to shade, less the reprojection.
+};
+
+// -----------------------------------------------------------------------------
+// Reuses the shading of the previous frame for pixels which still show the
+// same surface. The cache keeps the color, depth, and normal of the previous
+// frame and the camera it was rendered with. Each pixel of the current frame
+// is moved back into the world with its depth and the inverse view projection
+// matrix, then projected into the previous frame. The closest cached pixel is
+// reused if its own world position is close enough and the normals agree.
+// Pixels which were outside of the previous frame or hidden behind another
+// surface (disoccluded), whose normal changed, or which were reused too often
+// are shaded again.
+//
+// YoshiX cannot read its render targets back, so the cache works on CPU
+// images like the ones of the offscreen renderer. The depth is the hardware
+// depth of the camera, the normal image has the normal in its first three
+// channels.
+// -----------------------------------------------------------------------------
+class CTemporalCache
+{
+    public:
+
+        CTemporalCache();
+
+    public:
+
+        void SetSettings(const STemporalCacheSettings& _rSettings);
+        void SetViewport(int _Width, int _Height);                      // Invalidates the cache.
+
+        void Invalidate();                                              // Shades all pixels of the next frame, e.g. after the lights changed.
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Fills the color target of the cache for the current frame and keeps
+        // it for the next one. The second version reprojects and shades rows
+        // as jobs, the callback has to be thread safe then.
+        // -----------------------------------------------------------------------------
+        void Resolve(const SCameraSnapshot& _rCamera, const filter::SImage& _rDepthTarget, const filter::SImage& _rNormalTarget, FShadePixel _pShadePixel, void* _pUserData);
+        void Resolve(const SCameraSnapshot& _rCamera, const filter::SImage& _rDepthTarget, const filter::SImage& _rNormalTarget, FShadePixel _pShadePixel, void* _pUserData, CJobSystem& _rJobSystem);
+
+        filter::SImage GetColorTarget();                                // The color of the last resolved frame.
+
+        void GetStatistics(STemporalCacheStatistics& _rStatistics) const;
+        void ResetStatistics();
+
+    private:
+
+        struct SPixelState
+        {
+            enum EPixelState
+            {
+                Background,                                             ///< No geometry, shaded.
+                Reused,                                                 ///< Color copied from the previous frame.
+                Disoccluded,                                            ///< Not visible in the previous frame, shaded.
+                Invalidated,                                            ///< Visible but not reusable, shaded.
+            };
+        };
+
+        struct SRowCounts
+        {
+            int    m_NumberOfReusedPixels;
+            int    m_NumberOfDisoccludedPixels;
+            int    m_NumberOfInvalidatedPixels;
+            double m_ReprojectionTime;
+            double m_ShadingTime;
+        };
+
+    private:
+
+        STemporalCacheSettings     m_Settings;
+        int                        m_Width;
+        int                        m_Height;
+        bool                       m_IsValid;                           // The previous frame can be reused.
+
+        filter::CImage             m_Colors[2];                         // Current and previous frame, swapped after each resolve.
+        filter::CImage             m_Depths[2];
+        filter::CImage             m_Normals[2];
+        std::vector<unsigned char> m_Ages[2];                           // Frames the shading of a pixel was reused.
+        int                        m_IndexOfCurrent;
+        float                      m_PreviousViewProjectionMatrix[16];
+        float                      m_PreviousInverseViewProjectionMatrix[16];
+
+        std::vector<unsigned char> m_States;                            // 'SPixelState::EPixelState' of each pixel of the current frame.
+        std::vector<SRowCounts>    m_RowCounts;
+
+        STemporalCacheStatistics   m_Statistics;
+
+    private:
+
+        void BeginResolve(const filter::SImage& _rDepthTarget, const filter::SImage& _rNormalTarget);
+        void ReprojectRow(const SCameraSnapshot& _rCamera, int _Y);
+        void ShadeRow(int _Y, FShadePixel _pShadePixel, void* _pUserData);
+        void EndResolve(const SCameraSnapshot& _rCamera);
+};
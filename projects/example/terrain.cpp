@@ -0,0 +1,1031 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "terrain.h"
+
+#include "camera.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Height inside of a quad a, b, c, d with the corners at (0, 0), (1, 0),
+    // (1, 1), and (0, 1) split along a - c like the triangles of the chunks.
+    // -----------------------------------------------------------------------------
+    float Interpolate(float _A, float _B, float _C, float _D, float _U, float _V)
+    {
+        if (_U >= _V) return _A + _U * (_B - _A) + _V * (_C - _B);
+
+        return _A + _V * (_D - _A) + _U * (_C - _D);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetDistance(const float* _pPoint, const float* _pMinimum, const float* _pMaximum)
+    {
+        float Distance = 0.0f;
+
+        for (int Axis = 0; Axis < 3; ++ Axis)
+        {
+            float Delta = std::max(std::max(_pMinimum[Axis] - _pPoint[Axis], _pPoint[Axis] - _pMaximum[Axis]), 0.0f);
+
+            Distance += Delta * Delta;
+        }
+
+        return sqrtf(Distance);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Index of the grid vertex at a position on the border of a chunk. The
+    // border starts at x, z = 0, 0 and runs counterclockwise seen from above.
+    // -----------------------------------------------------------------------------
+    int GetBorderVertex(int _ChunkSize, int _IndexOfBorder)
+    {
+        int Offset = _IndexOfBorder % _ChunkSize;
+
+        switch (_IndexOfBorder / _ChunkSize)
+        {
+            case 0:  return Offset;
+            case 1:  return Offset * (_ChunkSize + 1) + _ChunkSize;
+            case 2:  return _ChunkSize * (_ChunkSize + 1) + _ChunkSize - Offset;
+            default: return (_ChunkSize - Offset) * (_ChunkSize + 1);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetLatticeValue(int _X, int _Z, unsigned int _Seed)
+    {
+        unsigned int Hash = static_cast<unsigned int>(_X) * 73856093u ^ static_cast<unsigned int>(_Z) * 19349663u ^ _Seed * 83492791u;
+
+        Hash ^= Hash >> 13;
+        Hash *= 0x5BD1E995u;
+        Hash ^= Hash >> 15;
+
+        return static_cast<float>(Hash & 0xFFFF) / 65535.0f;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsBoxVisible(const float (*_pPlanes)[4], const float* _pMinimum, const float* _pMaximum)
+    {
+        for (int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+        {
+            const float* pPlane = _pPlanes[IndexOfPlane];
+
+            // The corner furthest along the normal of the plane
+            float Distance = pPlane[3];
+
+            for (int Axis = 0; Axis < 3; ++ Axis) Distance += pPlane[Axis] * (pPlane[Axis] >= 0.0f ? _pMaximum[Axis] : _pMinimum[Axis]);
+
+            if (Distance < 0.0f) return false;
+        }
+
+        return true;
+    }
+} // namespace
+
+bool WriteTerrainFile(const char* _pPath, const STerrainHeader& _rHeader, const unsigned short* _pSamples)
+{
+    FILE* pFile = fopen(_pPath, "wb");
+
+    if (pFile == nullptr) return false;
+
+    STerrainHeader Header = _rHeader;
+
+    Header.m_Magic   = STerrainHeader::s_Magic;
+    Header.m_Version = STerrainHeader::s_Version;
+
+    bool IsWritten = fwrite(&Header, sizeof(Header), 1, pFile) == 1;
+
+    int TileSize = Header.m_TileSize;
+    int Width    = Header.m_NumberOfTilesX * (TileSize - 1) + 1;
+
+    for (int TileZ = 0; TileZ < Header.m_NumberOfTilesZ && IsWritten; ++ TileZ)
+    {
+        for (int TileX = 0; TileX < Header.m_NumberOfTilesX && IsWritten; ++ TileX)
+        {
+            for (int Z = 0; Z < TileSize && IsWritten; ++ Z)
+            {
+                const unsigned short* pRow = _pSamples + static_cast<size_t>(TileZ * (TileSize - 1) + Z) * Width + TileX * (TileSize - 1);
+
+                IsWritten = fwrite(pRow, sizeof(unsigned short), TileSize, pFile) == static_cast<size_t>(TileSize);
+            }
+        }
+    }
+
+    return fclose(pFile) == 0 && IsWritten;
+}
+
+// -----------------------------------------------------------------------------
+
+void GenerateTerrainSamples(int _Width, int _Depth, unsigned int _Seed, std::vector<unsigned short>& _rSamples)
+{
+    _rSamples.resize(static_cast<size_t>(_Width) * _Depth);
+
+    // The first octave has hills of 256 samples, each further one half the size and amplitude
+    const int s_NumberOfOctaves = 6;
+
+    for (int Z = 0; Z < _Depth; ++ Z)
+    {
+        for (int X = 0; X < _Width; ++ X)
+        {
+            float Height    = 0.0f;
+            float Amplitude = 0.5f;
+            int   Size      = 256;
+
+            for (int IndexOfOctave = 0; IndexOfOctave < s_NumberOfOctaves; ++ IndexOfOctave)
+            {
+                int   CellX = X / Size;
+                int   CellZ = Z / Size;
+                float U     = static_cast<float>(X - CellX * Size) / Size;
+                float V     = static_cast<float>(Z - CellZ * Size) / Size;
+
+                // Smooth step, so the slopes are continuous between the cells
+                U = U * U * (3.0f - 2.0f * U);
+                V = V * V * (3.0f - 2.0f * V);
+
+                float A = GetLatticeValue(CellX    , CellZ    , _Seed + IndexOfOctave);
+                float B = GetLatticeValue(CellX + 1, CellZ    , _Seed + IndexOfOctave);
+                float C = GetLatticeValue(CellX    , CellZ + 1, _Seed + IndexOfOctave);
+                float D = GetLatticeValue(CellX + 1, CellZ + 1, _Seed + IndexOfOctave);
+
+                Height += Amplitude * (A + (B - A) * U + (C - A) * V + (A - B - C + D) * U * V);
+
+                Amplitude *= 0.5f;
+                Size       = std::max(Size / 2, 1);
+            }
+
+            _rSamples[static_cast<size_t>(Z) * _Width + X] = static_cast<unsigned short>(std::min(Height, 1.0f) * 65535.0f);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+CTerrain::CTerrain()
+    : m_pJobSystem         (nullptr)
+    , m_pCreateMesh        (nullptr)
+    , m_pReleaseMesh       (nullptr)
+    , m_pUserData          (nullptr)
+    , m_ViewportHeight     (600)
+    , m_pSamples           (nullptr)
+    , m_NumberOfLevels     (0)
+    , m_NumberOfNodes      (0)
+    , m_pTiles             (nullptr)
+    , m_Frame              (0)
+    , m_NumberOfRequests   (0)
+    , m_NumberOfBuiltChunks(0)
+    , m_BuildTime          (0.0)
+    , m_Latency            (0.0)
+    , m_MaximumLatency     (0.0)
+{
+    STerrainSettings Settings = { 32, 2.0f, 1000.0f, 1.0f, 8.0f, 8, 120 };
+
+    m_Settings = Settings;
+
+    m_Origin[0] = 0.0f;
+    m_Origin[1] = 0.0f;
+    m_Origin[2] = 0.0f;
+}
+
+// -----------------------------------------------------------------------------
+
+CTerrain::~CTerrain()
+{
+    Close();
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::SetSettings(const STerrainSettings& _rSettings)
+{
+    m_Settings = _rSettings;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::SetJobSystem(CJobSystem* _pJobSystem)
+{
+    m_pJobSystem = _pJobSystem;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::SetCallbacks(FTerrainChunkCallback _pCreateMesh, FTerrainChunkCallback _pReleaseMesh, void* _pUserData)
+{
+    m_pCreateMesh  = _pCreateMesh;
+    m_pReleaseMesh = _pReleaseMesh;
+    m_pUserData    = _pUserData;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::SetOrigin(const float* _pOrigin)
+{
+    m_Origin[0] = _pOrigin[0];
+    m_Origin[1] = _pOrigin[1];
+    m_Origin[2] = _pOrigin[2];
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::SetViewport(int _Width, int _Height)
+{
+    (void) _Width;
+
+    m_ViewportHeight = _Height;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTerrain::Open(const char* _pPath)
+{
+    Close();
+
+    if (m_File.Open(_pPath) == false) return false;
+
+    if (m_File.GetSize() < sizeof(STerrainHeader))
+    {
+        Close();
+
+        return false;
+    }
+
+    m_Header = *reinterpret_cast<const STerrainHeader*>(m_File.GetData());
+
+    // -----------------------------------------------------------------------------
+    // The quads of a tile are halved from level to level until a chunk covers
+    // as many quads as it has, so the tile size minus one has to be a power of
+    // two and at least the size of a chunk. The sizes come from the file, so
+    // they are bounded before anything is computed from them, and the size of
+    // the samples is computed in 64 bits, which cannot wrap on 32 bit targets.
+    // -----------------------------------------------------------------------------
+    bool IsValid = m_Header.m_Magic == STerrainHeader::s_Magic && m_Header.m_Version == STerrainHeader::s_Version;
+
+    IsValid = IsValid && m_Header.m_TileSize > 1 && m_Header.m_TileSize <= STerrainHeader::s_MaximumTileSize;
+    IsValid = IsValid && m_Header.m_NumberOfTilesX > 0 && m_Header.m_NumberOfTilesX <= STerrainHeader::s_MaximumNumberOfTiles;
+    IsValid = IsValid && m_Header.m_NumberOfTilesZ > 0 && m_Header.m_NumberOfTilesZ <= STerrainHeader::s_MaximumNumberOfTiles;
+
+    int NumberOfQuads = IsValid ? m_Header.m_TileSize - 1 : 0;
+
+    IsValid = IsValid && (NumberOfQuads & (NumberOfQuads - 1)) == 0;
+    IsValid = IsValid && m_Settings.m_ChunkSize > 0 && (m_Settings.m_ChunkSize & (m_Settings.m_ChunkSize - 1)) == 0;
+
+    unsigned long long TileBytes   = static_cast<unsigned long long>(m_Header.m_TileSize) * m_Header.m_TileSize * sizeof(unsigned short);
+    unsigned long long SampleBytes = TileBytes * m_Header.m_NumberOfTilesX * m_Header.m_NumberOfTilesZ;
+
+    IsValid = IsValid && m_File.GetSize() >= sizeof(STerrainHeader) + SampleBytes;
+
+    if (IsValid == false)
+    {
+        Close();
+
+        return false;
+    }
+
+    m_Settings.m_ChunkSize = std::min(m_Settings.m_ChunkSize, NumberOfQuads);
+
+    m_pSamples       = reinterpret_cast<const unsigned short*>(m_File.GetData() + sizeof(STerrainHeader));
+    m_NumberOfLevels = 1;
+    m_NumberOfNodes  = 1;
+
+    for (int Quads = m_Settings.m_ChunkSize; Quads < NumberOfQuads; Quads *= 2)
+    {
+        m_NumberOfNodes += 1 << (2 * m_NumberOfLevels);
+
+        ++ m_NumberOfLevels;
+    }
+
+    int NumberOfTiles = m_Header.m_NumberOfTilesX * m_Header.m_NumberOfTilesZ;
+
+    m_pTiles = new STile[NumberOfTiles];
+
+    for (int IndexOfTile = 0; IndexOfTile < NumberOfTiles; ++ IndexOfTile)
+    {
+        STile& rTile = m_pTiles[IndexOfTile];
+
+        rTile.m_IndexOfTile           = IndexOfTile;
+        rTile.m_IsResident            = false;
+        rTile.m_NumberOfPendingChunks = 0;
+        rTile.m_pChunks               = nullptr;
+        rTile.m_pTerrain              = this;
+
+        rTile.m_IsLoaded.store(false, std::memory_order_relaxed);
+    }
+
+    m_Frame = 0;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::Close()
+{
+    if (m_pTiles != nullptr)
+    {
+        // The jobs write into the tiles and chunks
+        GetCurrentJobSystem().Wait(m_PendingJobs);
+
+        ReleaseChunks();
+
+        int NumberOfTiles = m_Header.m_NumberOfTilesX * m_Header.m_NumberOfTilesZ;
+
+        for (int IndexOfTile = 0; IndexOfTile < NumberOfTiles; ++ IndexOfTile)
+        {
+            if (m_pTiles[IndexOfTile].m_IsResident) EvictTile(m_pTiles[IndexOfTile]);
+        }
+
+        delete[] m_pTiles;
+    }
+
+    m_File.Close();
+
+    m_pTiles         = nullptr;
+    m_pSamples       = nullptr;
+    m_NumberOfLevels = 0;
+    m_NumberOfNodes  = 0;
+
+    m_SelectedChunks.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::ReleaseChunks()
+{
+    if (m_pTiles == nullptr) return;
+
+    GetCurrentJobSystem().Wait(m_PendingJobs);
+
+    int NumberOfTiles = m_Header.m_NumberOfTilesX * m_Header.m_NumberOfTilesZ;
+
+    for (int IndexOfTile = 0; IndexOfTile < NumberOfTiles; ++ IndexOfTile)
+    {
+        STile& rTile = m_pTiles[IndexOfTile];
+
+        if (rTile.m_pChunks == nullptr) continue;
+
+        for (int IndexOfNode = 0; IndexOfNode < m_NumberOfNodes; ++ IndexOfNode) ReleaseChunk(rTile.m_pChunks[IndexOfNode]);
+
+        rTile.m_NumberOfPendingChunks = 0;
+    }
+
+    m_SelectedChunks.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTerrain::IsOpen() const
+{
+    return m_pTiles != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+float CTerrain::GetHeight(float _X, float _Z) const
+{
+    if (m_pTiles == nullptr) return m_Origin[1];
+
+    // -----------------------------------------------------------------------------
+    // Position in samples of the whole terrain, clamped to the last quad, so
+    // the neighbours of the sample are always inside of the same tile.
+    // -----------------------------------------------------------------------------
+    int NumberOfQuads = m_Header.m_TileSize - 1;
+    int Width         = m_Header.m_NumberOfTilesX * NumberOfQuads + 1;
+    int Depth         = m_Header.m_NumberOfTilesZ * NumberOfQuads + 1;
+
+    float X = std::min(std::max((_X - m_Origin[0]) / m_Header.m_SampleSpacing + 0.5f * (Width - 1), 0.0f), static_cast<float>(Width - 1));
+    float Z = std::min(std::max((_Z - m_Origin[2]) / m_Header.m_SampleSpacing + 0.5f * (Depth - 1), 0.0f), static_cast<float>(Depth - 1));
+
+    int SampleX = std::min(static_cast<int>(X), Width - 2);
+    int SampleZ = std::min(static_cast<int>(Z), Depth - 2);
+    int TileX   = SampleX / NumberOfQuads;
+    int TileZ   = SampleZ / NumberOfQuads;
+
+    const STile& rTile = m_pTiles[TileZ * m_Header.m_NumberOfTilesX + TileX];
+
+    int LocalX = SampleX - TileX * NumberOfQuads;
+    int LocalZ = SampleZ - TileZ * NumberOfQuads;
+
+    float A = GetSampleHeight(rTile, LocalX    , LocalZ    );
+    float B = GetSampleHeight(rTile, LocalX + 1, LocalZ    );
+    float C = GetSampleHeight(rTile, LocalX + 1, LocalZ + 1);
+    float D = GetSampleHeight(rTile, LocalX    , LocalZ + 1);
+
+    return m_Origin[1] + Interpolate(A, B, C, D, X - SampleX, Z - SampleZ);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::Update(const SCameraSnapshot& _rCamera)
+{
+    if (m_pTiles == nullptr) return;
+
+    ++ m_Frame;
+
+    m_NumberOfRequests = 0;
+
+    m_SelectedChunks.clear();
+
+    int   NumberOfTiles = m_Header.m_NumberOfTilesX * m_Header.m_NumberOfTilesZ;
+    float TileExtent    = (m_Header.m_TileSize - 1) * m_Header.m_SampleSpacing;
+    float FirstTileX    = m_Origin[0] - 0.5f * m_Header.m_NumberOfTilesX * TileExtent;
+    float FirstTileZ    = m_Origin[2] - 0.5f * m_Header.m_NumberOfTilesZ * TileExtent;
+
+    for (int IndexOfTile = 0; IndexOfTile < NumberOfTiles; ++ IndexOfTile)
+    {
+        STile& rTile = m_pTiles[IndexOfTile];
+
+        // -----------------------------------------------------------------------------
+        // Create the meshes of the chunks the jobs finished since the last update.
+        // -----------------------------------------------------------------------------
+        if (rTile.m_NumberOfPendingChunks > 0)
+        {
+            for (int IndexOfNode = 0; IndexOfNode < m_NumberOfNodes; ++ IndexOfNode)
+            {
+                STerrainChunk& rChunk = rTile.m_pChunks[IndexOfNode];
+
+                if (rChunk.m_State == STerrainChunk::SState::Building && rChunk.m_IsBuilt.load(std::memory_order_acquire)) CreateMesh(rTile, rChunk);
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+        // Tiles are loaded inside of the streaming distance and evicted a bit
+        // further away, so a camera moving along the border does not load and
+        // evict the same tile again and again.
+        // -----------------------------------------------------------------------------
+        float Minimum[2] = { FirstTileX + (IndexOfTile % m_Header.m_NumberOfTilesX) * TileExtent, FirstTileZ + (IndexOfTile / m_Header.m_NumberOfTilesX) * TileExtent };
+
+        float DeltaX   = std::max(std::max(Minimum[0] - _rCamera.m_EyePosition[0], _rCamera.m_EyePosition[0] - Minimum[0] - TileExtent), 0.0f);
+        float DeltaZ   = std::max(std::max(Minimum[1] - _rCamera.m_EyePosition[2], _rCamera.m_EyePosition[2] - Minimum[1] - TileExtent), 0.0f);
+        float Distance = sqrtf(DeltaX * DeltaX + DeltaZ * DeltaZ);
+
+        if (rTile.m_IsResident == false)
+        {
+            if (Distance > m_Settings.m_StreamingDistance) continue;
+
+            rTile.m_IsResident = true;
+            rTile.m_Job        = { &LoadTileJob, &rTile, &m_PendingJobs };
+
+            Run(rTile.m_Job);
+
+            continue;
+        }
+
+        if (rTile.m_IsLoaded.load(std::memory_order_acquire) == false) continue;
+
+        if (Distance > 1.25f * m_Settings.m_StreamingDistance && rTile.m_NumberOfPendingChunks == 0)
+        {
+            EvictTile(rTile);
+
+            continue;
+        }
+
+        Select(rTile, _rCamera, 0, 0, 0);
+
+        // -----------------------------------------------------------------------------
+        // The root stays while the tile is resident, so turning the camera back
+        // to a tile never shows a hole. Other chunks go if they were not used.
+        // -----------------------------------------------------------------------------
+        rTile.m_pChunks[0].m_LastUsedFrame = m_Frame;
+
+        Request(rTile, 0);
+
+        for (int IndexOfNode = 1; IndexOfNode < m_NumberOfNodes; ++ IndexOfNode)
+        {
+            STerrainChunk& rChunk = rTile.m_pChunks[IndexOfNode];
+
+            if (rChunk.m_State == STerrainChunk::SState::Ready && m_Frame - rChunk.m_LastUsedFrame > m_Settings.m_NumberOfIdleFrames) ReleaseChunk(rChunk);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int CTerrain::GetNumberOfSelectedChunks() const
+{
+    return static_cast<int>(m_SelectedChunks.size());
+}
+
+// -----------------------------------------------------------------------------
+
+const STerrainChunk& CTerrain::GetSelectedChunk(int _Index) const
+{
+    return *m_SelectedChunks[_Index];
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::GetStatistics(STerrainStatistics& _rStatistics) const
+{
+    _rStatistics.m_NumberOfResidentTiles  = 0;
+    _rStatistics.m_NumberOfResidentChunks = 0;
+    _rStatistics.m_NumberOfSelectedChunks = static_cast<int>(m_SelectedChunks.size());
+    _rStatistics.m_NumberOfPendingChunks  = 0;
+    _rStatistics.m_TileBytes              = 0;
+    _rStatistics.m_ChunkBytes             = 0;
+    _rStatistics.m_NumberOfBuiltChunks    = m_NumberOfBuiltChunks;
+    _rStatistics.m_AverageBuildTime       = m_NumberOfBuiltChunks > 0 ? m_BuildTime / m_NumberOfBuiltChunks : 0.0;
+    _rStatistics.m_AverageLatency         = m_NumberOfBuiltChunks > 0 ? m_Latency   / m_NumberOfBuiltChunks : 0.0;
+    _rStatistics.m_MaximumLatency         = m_MaximumLatency;
+
+    if (m_pTiles == nullptr) return;
+
+    size_t TileBytes = static_cast<size_t>(m_Header.m_TileSize) * m_Header.m_TileSize * sizeof(unsigned short) + m_NumberOfNodes * (3 * sizeof(float) + sizeof(STerrainChunk));
+
+    int NumberOfTiles = m_Header.m_NumberOfTilesX * m_Header.m_NumberOfTilesZ;
+
+    for (int IndexOfTile = 0; IndexOfTile < NumberOfTiles; ++ IndexOfTile)
+    {
+        const STile& rTile = m_pTiles[IndexOfTile];
+
+        if (rTile.m_IsResident == false) continue;
+
+        ++ _rStatistics.m_NumberOfResidentTiles;
+
+        _rStatistics.m_TileBytes             += TileBytes;
+        _rStatistics.m_NumberOfPendingChunks += rTile.m_NumberOfPendingChunks;
+
+        if (rTile.m_IsLoaded.load(std::memory_order_acquire) == false) continue;
+
+        for (int IndexOfNode = 0; IndexOfNode < m_NumberOfNodes; ++ IndexOfNode)
+        {
+            const STerrainChunk& rChunk = rTile.m_pChunks[IndexOfNode];
+
+            if (rChunk.m_State != STerrainChunk::SState::Ready) continue;
+
+            ++ _rStatistics.m_NumberOfResidentChunks;
+
+            _rStatistics.m_ChunkBytes += (rChunk.m_NumberOfVertices * 5 + rChunk.m_NumberOfIndices) * sizeof(float);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::ResetStatistics()
+{
+    m_NumberOfBuiltChunks = 0;
+    m_BuildTime           = 0.0;
+    m_Latency             = 0.0;
+    m_MaximumLatency      = 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+CJobSystem& CTerrain::GetCurrentJobSystem() const
+{
+    return m_pJobSystem != nullptr ? *m_pJobSystem : GetJobSystem();
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::Run(SJob& _rJob)
+{
+    CJobSystem& rJobSystem = GetCurrentJobSystem();
+
+    // -----------------------------------------------------------------------------
+    // Without workers the job would only run when somebody waits, so it is
+    // executed right away. It does not need the counter then.
+    // -----------------------------------------------------------------------------
+    if (rJobSystem.GetNumberOfWorkers() == 0)
+    {
+        _rJob.m_pFunction(_rJob.m_pData);
+
+        return;
+    }
+
+    rJobSystem.Run(&_rJob);
+}
+
+// -----------------------------------------------------------------------------
+
+int CTerrain::GetIndexOfNode(int _Level, int _X, int _Z) const
+{
+    // The nodes of the levels above, 1 + 4 + 16 + ...
+    int FirstNode = ((1 << (2 * _Level)) - 1) / 3;
+
+    return FirstNode + (_Z << _Level) + _X;
+}
+
+// -----------------------------------------------------------------------------
+
+float CTerrain::GetSampleHeight(const STile& _rTile, int _X, int _Z) const
+{
+    const unsigned short* pTile = m_pSamples + static_cast<size_t>(_rTile.m_IndexOfTile) * m_Header.m_TileSize * m_Header.m_TileSize;
+
+    return m_Header.m_HeightOffset + m_Header.m_HeightScale * pTile[_Z * m_Header.m_TileSize + _X];
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::GetNodeBounds(const STile& _rTile, int _IndexOfNode, float* _pMinimum, float* _pMaximum) const
+{
+    const STerrainChunk& rChunk = _rTile.m_pChunks[_IndexOfNode];
+
+    int   NumberOfQuads = m_Header.m_TileSize - 1;
+    int   NodeQuads     = NumberOfQuads >> rChunk.m_Level;
+    int   TileX         = _rTile.m_IndexOfTile % m_Header.m_NumberOfTilesX;
+    int   TileZ         = _rTile.m_IndexOfTile / m_Header.m_NumberOfTilesX;
+    float Spacing       = m_Header.m_SampleSpacing;
+
+    _pMinimum[0] = m_Origin[0] + (TileX * NumberOfQuads + rChunk.m_X * NodeQuads - 0.5f * m_Header.m_NumberOfTilesX * NumberOfQuads) * Spacing;
+    _pMinimum[1] = m_Origin[1] + _rTile.m_MinimumHeights[_IndexOfNode] - _rTile.m_Errors[_IndexOfNode] - m_Settings.m_SkirtDepth;
+    _pMinimum[2] = m_Origin[2] + (TileZ * NumberOfQuads + rChunk.m_Z * NodeQuads - 0.5f * m_Header.m_NumberOfTilesZ * NumberOfQuads) * Spacing;
+
+    _pMaximum[0] = _pMinimum[0] + NodeQuads * Spacing;
+    _pMaximum[1] = m_Origin[1] + _rTile.m_MaximumHeights[_IndexOfNode];
+    _pMaximum[2] = _pMinimum[2] + NodeQuads * Spacing;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::LoadTile(STile& _rTile)
+{
+    _rTile.m_Errors        .assign(m_NumberOfNodes, 0.0f);
+    _rTile.m_MinimumHeights.assign(m_NumberOfNodes, 0.0f);
+    _rTile.m_MaximumHeights.assign(m_NumberOfNodes, 0.0f);
+
+    _rTile.m_pChunks = new STerrainChunk[m_NumberOfNodes];
+
+    // -----------------------------------------------------------------------------
+    // The error of a node is the largest difference between a sample and the
+    // triangles of the node over it. Reading the samples is what brings the
+    // tile from the mapped file into memory.
+    // -----------------------------------------------------------------------------
+    int ChunkSize     = m_Settings.m_ChunkSize;
+    int NumberOfQuads = m_Header.m_TileSize - 1;
+
+    for (int Level = 0; Level < m_NumberOfLevels; ++ Level)
+    {
+        int NumberOfNodes = 1 << Level;
+        int Stride        = (NumberOfQuads >> Level) / ChunkSize;
+
+        for (int NodeZ = 0; NodeZ < NumberOfNodes; ++ NodeZ)
+        {
+            for (int NodeX = 0; NodeX < NumberOfNodes; ++ NodeX)
+            {
+                int IndexOfNode = GetIndexOfNode(Level, NodeX, NodeZ);
+
+                STerrainChunk& rChunk = _rTile.m_pChunks[IndexOfNode];
+
+                rChunk.m_pMesh            = nullptr;
+                rChunk.m_pDepthMesh       = nullptr;
+                rChunk.m_Level            = Level;
+                rChunk.m_pTerrain         = this;
+                rChunk.m_IndexOfTile      = _rTile.m_IndexOfTile;
+                rChunk.m_X                = NodeX;
+                rChunk.m_Z                = NodeZ;
+                rChunk.m_State            = STerrainChunk::SState::Empty;
+                rChunk.m_LastUsedFrame    = 0;
+                rChunk.m_NumberOfVertices = 0;
+                rChunk.m_NumberOfIndices  = 0;
+                rChunk.m_BuildTime        = 0.0;
+
+                rChunk.m_IsBuilt.store(false, std::memory_order_relaxed);
+
+                float Error   = 0.0f;
+                float Minimum =  3.402823466e+38f;
+                float Maximum = -3.402823466e+38f;
+
+                int FirstX = NodeX * ChunkSize * Stride;
+                int FirstZ = NodeZ * ChunkSize * Stride;
+
+                for (int CellZ = 0; CellZ < ChunkSize; ++ CellZ)
+                {
+                    for (int CellX = 0; CellX < ChunkSize; ++ CellX)
+                    {
+                        int X = FirstX + CellX * Stride;
+                        int Z = FirstZ + CellZ * Stride;
+
+                        float A = GetSampleHeight(_rTile, X         , Z         );
+                        float B = GetSampleHeight(_rTile, X + Stride, Z         );
+                        float C = GetSampleHeight(_rTile, X + Stride, Z + Stride);
+                        float D = GetSampleHeight(_rTile, X         , Z + Stride);
+
+                        for (int V = 0; V <= Stride; ++ V)
+                        {
+                            for (int U = 0; U <= Stride; ++ U)
+                            {
+                                float Height = GetSampleHeight(_rTile, X + U, Z + V);
+
+                                Error   = std::max(Error, fabsf(Height - Interpolate(A, B, C, D, static_cast<float>(U) / Stride, static_cast<float>(V) / Stride)));
+                                Minimum = std::min(Minimum, Height);
+                                Maximum = std::max(Maximum, Height);
+                            }
+                        }
+                    }
+                }
+
+                _rTile.m_Errors        [IndexOfNode] = Error;
+                _rTile.m_MinimumHeights[IndexOfNode] = Minimum;
+                _rTile.m_MaximumHeights[IndexOfNode] = Maximum;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // A parent is never more exact than its children, otherwise a refined area
+    // could show a larger error than the coarse one.
+    // -----------------------------------------------------------------------------
+    for (int Level = m_NumberOfLevels - 2; Level >= 0; -- Level)
+    {
+        int NumberOfNodes = 1 << Level;
+
+        for (int NodeZ = 0; NodeZ < NumberOfNodes; ++ NodeZ)
+        {
+            for (int NodeX = 0; NodeX < NumberOfNodes; ++ NodeX)
+            {
+                float& rError = _rTile.m_Errors[GetIndexOfNode(Level, NodeX, NodeZ)];
+
+                for (int IndexOfChild = 0; IndexOfChild < 4; ++ IndexOfChild)
+                {
+                    rError = std::max(rError, _rTile.m_Errors[GetIndexOfNode(Level + 1, NodeX * 2 + (IndexOfChild & 1), NodeZ * 2 + (IndexOfChild >> 1))]);
+                }
+            }
+        }
+    }
+
+    _rTile.m_IsLoaded.store(true, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::EvictTile(STile& _rTile)
+{
+    for (int IndexOfNode = 0; IndexOfNode < m_NumberOfNodes; ++ IndexOfNode) ReleaseChunk(_rTile.m_pChunks[IndexOfNode]);
+
+    delete[] _rTile.m_pChunks;
+
+    std::vector<float>().swap(_rTile.m_Errors);
+    std::vector<float>().swap(_rTile.m_MinimumHeights);
+    std::vector<float>().swap(_rTile.m_MaximumHeights);
+
+    _rTile.m_pChunks    = nullptr;
+    _rTile.m_IsResident = false;
+
+    _rTile.m_IsLoaded.store(false, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::BuildChunk(STerrainChunk& _rChunk)
+{
+    CStopwatch Stopwatch;
+
+    const STile& rTile = m_pTiles[_rChunk.m_IndexOfTile];
+
+    int IndexOfNode   = GetIndexOfNode(_rChunk.m_Level, _rChunk.m_X, _rChunk.m_Z);
+    int ChunkSize     = m_Settings.m_ChunkSize;
+    int NumberOfQuads = m_Header.m_TileSize - 1;
+    int Stride        = (NumberOfQuads >> _rChunk.m_Level) / ChunkSize;
+    int FirstX        = _rChunk.m_X * ChunkSize * Stride;
+    int FirstZ        = _rChunk.m_Z * ChunkSize * Stride;
+    int TileX         = _rChunk.m_IndexOfTile % m_Header.m_NumberOfTilesX;
+    int TileZ         = _rChunk.m_IndexOfTile / m_Header.m_NumberOfTilesX;
+
+    // Position of the first sample of the tile without the origin, which the texture coordinates are based on
+    float Spacing     = m_Header.m_SampleSpacing;
+    float TileOffsetX = (TileX * NumberOfQuads - 0.5f * m_Header.m_NumberOfTilesX * NumberOfQuads) * Spacing;
+    float TileOffsetZ = (TileZ * NumberOfQuads - 0.5f * m_Header.m_NumberOfTilesZ * NumberOfQuads) * Spacing;
+
+    int NumberOfGridVertices  = (ChunkSize + 1) * (ChunkSize + 1);
+    int NumberOfSkirtVertices = 4 * ChunkSize;
+
+    _rChunk.m_Vertices.resize((NumberOfGridVertices + NumberOfSkirtVertices) * 5);
+    _rChunk.m_Indices .resize((ChunkSize * ChunkSize + NumberOfSkirtVertices) * 6);
+
+    float* pVertex = _rChunk.m_Vertices.data();
+
+    for (int Z = 0; Z <= ChunkSize; ++ Z)
+    {
+        for (int X = 0; X <= ChunkSize; ++ X)
+        {
+            float PositionX = TileOffsetX + (FirstX + X * Stride) * Spacing;
+            float PositionZ = TileOffsetZ + (FirstZ + Z * Stride) * Spacing;
+
+            pVertex[0] = m_Origin[0] + PositionX;
+            pVertex[1] = m_Origin[1] + GetSampleHeight(rTile, FirstX + X * Stride, FirstZ + Z * Stride);
+            pVertex[2] = m_Origin[2] + PositionZ;
+            pVertex[3] =  PositionX / m_Settings.m_TextureSize;
+            pVertex[4] = -PositionZ / m_Settings.m_TextureSize;
+
+            pVertex += 5;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The quads are split along the same diagonal as the error was measured
+    // with, and wound like the ground quad of the example.
+    // -----------------------------------------------------------------------------
+    int* pIndex = _rChunk.m_Indices.data();
+
+    for (int Z = 0; Z < ChunkSize; ++ Z)
+    {
+        for (int X = 0; X < ChunkSize; ++ X)
+        {
+            int A = Z * (ChunkSize + 1) + X;
+            int B = A + 1;
+            int C = B + ChunkSize + 1;
+            int D = A + ChunkSize + 1;
+
+            pIndex[0] = A; pIndex[1] = B; pIndex[2] = C;
+            pIndex[3] = A; pIndex[4] = C; pIndex[5] = D;
+
+            pIndex += 6;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The skirt is a copy of the border moved down by more than the error of
+    // the chunk, so it covers the gap to any coarser or finer neighbour. The
+    // border is walked counterclockwise seen from above, so each skirt quad
+    // faces away from the chunk.
+    // -----------------------------------------------------------------------------
+    float SkirtDepth = rTile.m_Errors[IndexOfNode] + m_Settings.m_SkirtDepth;
+
+    for (int IndexOfBorder = 0; IndexOfBorder < NumberOfSkirtVertices; ++ IndexOfBorder)
+    {
+        int Top     = GetBorderVertex(ChunkSize, IndexOfBorder);
+        int NextTop = GetBorderVertex(ChunkSize, (IndexOfBorder + 1) % NumberOfSkirtVertices);
+
+        int Bottom     = NumberOfGridVertices + IndexOfBorder;
+        int NextBottom = NumberOfGridVertices + (IndexOfBorder + 1) % NumberOfSkirtVertices;
+
+        const float* pTop = &_rChunk.m_Vertices[Top * 5];
+
+        pVertex[0] = pTop[0];
+        pVertex[1] = pTop[1] - SkirtDepth;
+        pVertex[2] = pTop[2];
+        pVertex[3] = pTop[3];
+        pVertex[4] = pTop[4];
+
+        pVertex += 5;
+
+        pIndex[0] = Bottom; pIndex[1] = NextBottom; pIndex[2] = NextTop;
+        pIndex[3] = Bottom; pIndex[4] = NextTop;    pIndex[5] = Top;
+
+        pIndex += 6;
+    }
+
+    float Minimum[3];
+    float Maximum[3];
+
+    GetNodeBounds(rTile, IndexOfNode, Minimum, Maximum);
+
+    float Radius = 0.0f;
+
+    for (int Axis = 0; Axis < 3; ++ Axis)
+    {
+        _rChunk.m_WSCenter[Axis] = 0.5f * (Minimum[Axis] + Maximum[Axis]);
+
+        Radius += 0.25f * (Maximum[Axis] - Minimum[Axis]) * (Maximum[Axis] - Minimum[Axis]);
+    }
+
+    _rChunk.m_Radius           = sqrtf(Radius);
+    _rChunk.m_NumberOfVertices = NumberOfGridVertices + NumberOfSkirtVertices;
+    _rChunk.m_NumberOfIndices  = static_cast<int>(_rChunk.m_Indices.size());
+    _rChunk.m_BuildTime        = Stopwatch.GetElapsedMilliseconds();
+
+    _rChunk.m_IsBuilt.store(true, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::CreateMesh(STile& _rTile, STerrainChunk& _rChunk)
+{
+    if (m_pCreateMesh != nullptr) m_pCreateMesh(_rChunk, m_pUserData);
+
+    double Latency = _rChunk.m_Stopwatch.GetElapsedMilliseconds();
+
+    ++ m_NumberOfBuiltChunks;
+
+    m_BuildTime     += _rChunk.m_BuildTime;
+    m_Latency       += Latency;
+    m_MaximumLatency = std::max(m_MaximumLatency, Latency);
+
+    // The mesh has its own copy of the vertices
+    std::vector<float>().swap(_rChunk.m_Vertices);
+    std::vector<int>  ().swap(_rChunk.m_Indices);
+
+    _rChunk.m_State = STerrainChunk::SState::Ready;
+
+    -- _rTile.m_NumberOfPendingChunks;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::ReleaseChunk(STerrainChunk& _rChunk)
+{
+    if (_rChunk.m_State == STerrainChunk::SState::Ready && m_pReleaseMesh != nullptr) m_pReleaseMesh(_rChunk, m_pUserData);
+
+    // Only called when no job runs, so a building chunk is complete and just dropped
+    std::vector<float>().swap(_rChunk.m_Vertices);
+    std::vector<int>  ().swap(_rChunk.m_Indices);
+
+    _rChunk.m_pMesh      = nullptr;
+    _rChunk.m_pDepthMesh = nullptr;
+    _rChunk.m_State      = STerrainChunk::SState::Empty;
+
+    _rChunk.m_IsBuilt.store(false, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTerrain::Request(STile& _rTile, int _IndexOfNode)
+{
+    STerrainChunk& rChunk = _rTile.m_pChunks[_IndexOfNode];
+
+    rChunk.m_LastUsedFrame = m_Frame;
+
+    if (rChunk.m_State != STerrainChunk::SState::Empty) return rChunk.m_State == STerrainChunk::SState::Ready;
+
+    // The builds are spread over the updates, so moving fast does not stall a frame
+    if (m_NumberOfRequests >= m_Settings.m_MaximumNumberOfBuilds) return false;
+
+    ++ m_NumberOfRequests;
+    ++ _rTile.m_NumberOfPendingChunks;
+
+    rChunk.m_State = STerrainChunk::SState::Building;
+    rChunk.m_Job   = { &BuildChunkJob, &rChunk, &m_PendingJobs };
+
+    rChunk.m_Stopwatch.Start();
+
+    Run(rChunk.m_Job);
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::Select(STile& _rTile, const SCameraSnapshot& _rCamera, int _Level, int _X, int _Z)
+{
+    int IndexOfNode = GetIndexOfNode(_Level, _X, _Z);
+
+    STerrainChunk& rChunk = _rTile.m_pChunks[IndexOfNode];
+
+    rChunk.m_LastUsedFrame = m_Frame;
+
+    float Minimum[3];
+    float Maximum[3];
+
+    GetNodeBounds(_rTile, IndexOfNode, Minimum, Maximum);
+
+    if (IsBoxVisible(_rCamera.m_FrustumPlanes, Minimum, Maximum) == false) return;
+
+    // Only a root can be reached without being ready, the children are entered if all four are ready
+    if (Request(_rTile, IndexOfNode) == false) return;
+
+    if (_Level + 1 < m_NumberOfLevels)
+    {
+        // -----------------------------------------------------------------------------
+        // The error in pixels at the closest point of the node. The projection
+        // scales the height at distance 1 to half the viewport height.
+        // -----------------------------------------------------------------------------
+        float Distance    = std::max(GetDistance(_rCamera.m_EyePosition, Minimum, Maximum), 1.0e-4f);
+        float ScreenError = _rTile.m_Errors[IndexOfNode] * 0.5f * m_ViewportHeight * _rCamera.m_ProjectionMatrix[5] / Distance;
+
+        if (ScreenError > m_Settings.m_MaximumScreenError)
+        {
+            bool AreChildrenReady = true;
+
+            for (int IndexOfChild = 0; IndexOfChild < 4; ++ IndexOfChild)
+            {
+                int ChildX = _X * 2 + (IndexOfChild & 1);
+                int ChildZ = _Z * 2 + (IndexOfChild >> 1);
+
+                AreChildrenReady = Request(_rTile, GetIndexOfNode(_Level + 1, ChildX, ChildZ)) && AreChildrenReady;
+            }
+
+            if (AreChildrenReady)
+            {
+                for (int IndexOfChild = 0; IndexOfChild < 4; ++ IndexOfChild) Select(_rTile, _rCamera, _Level + 1, _X * 2 + (IndexOfChild & 1), _Z * 2 + (IndexOfChild >> 1));
+
+                return;
+            }
+        }
+    }
+
+    m_SelectedChunks.push_back(&rChunk);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::LoadTileJob(void* _pData)
+{
+    STile* pTile = static_cast<STile*>(_pData);
+
+    pTile->m_pTerrain->LoadTile(*pTile);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::BuildChunkJob(void* _pData)
+{
+    STerrainChunk* pChunk = static_cast<STerrainChunk*>(_pData);
+
+    pChunk->m_pTerrain->BuildChunk(*pChunk);
+}
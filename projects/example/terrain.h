@@ -0,0 +1,244 @@
+#pragma once
+
+#include "frame_statistics.h"
+#include "job_system.h"
+#include "mapped_file.h"
+#include "yoshix.h"
+
+#include <atomic>
+#include <vector>
+
+class  CTerrain;
+struct SCameraSnapshot;
+
+// -----------------------------------------------------------------------------
+// Layout of a terrain file. The header is followed by the tiles row by row,
+// each one a square of 16 bit height samples, also row by row. The tiles have
+// 2^n + 1 samples per side and neighbouring tiles share the samples of their
+// common edge, so each tile can be read and meshed on its own. The terrain is
+// centered around the origin, sample x, z of the whole terrain is at
+// ((x - (width - 1) / 2) * spacing, offset + sample * scale, (z - ...)).
+// -----------------------------------------------------------------------------
+struct STerrainHeader
+{
+    static const unsigned int s_Magic   = 0x4E525254;                   // "TRRN" in little endian.
+    static const unsigned int s_Version = 1;
+
+    // The header is read from a file, larger values are rejected as corrupt
+    static const int          s_MaximumTileSize      = 4097;
+    static const int          s_MaximumNumberOfTiles = 1024;            // Per side.
+
+    unsigned int m_Magic;                                               // Has to be 's_Magic'.
+    unsigned int m_Version;                                             // Has to be 's_Version'.
+    int          m_TileSize;                                            // Samples per side of a tile, 2^n + 1.
+    int          m_NumberOfTilesX;
+    int          m_NumberOfTilesZ;
+    float        m_SampleSpacing;                                       // Distance of two samples in units.
+    float        m_HeightScale;                                         // Units per step of a sample.
+    float        m_HeightOffset;                                        // Height of the sample 0.
+};
+
+// -----------------------------------------------------------------------------
+// Splits the samples of the whole terrain, (tiles x * (tile size - 1) + 1)
+// per row, into tiles and writes them after the header.
+// -----------------------------------------------------------------------------
+bool WriteTerrainFile(const char* _pPath, const STerrainHeader& _rHeader, const unsigned short* _pSamples);
+
+// -----------------------------------------------------------------------------
+// Fills the samples with a few octaves of value noise, e.g. for terrains
+// without a heightmap.
+// -----------------------------------------------------------------------------
+void GenerateTerrainSamples(int _Width, int _Depth, unsigned int _Seed, std::vector<unsigned short>& _rSamples);
+
+// -----------------------------------------------------------------------------
+
+struct STerrainSettings
+{
+    int   m_ChunkSize;                                                  // Quads per side of a chunk, a power of two.
+    float m_MaximumScreenError;                                         // Pixels a chunk may differ from the full resolution.
+    float m_StreamingDistance;                                          // Tiles closer to the camera than this are kept resident.
+    float m_SkirtDepth;                                                 // Added to the error of a chunk to get the depth of its skirt.
+    float m_TextureSize;                                                // Units covered by one repetition of the texture.
+    int   m_MaximumNumberOfBuilds;                                      // Chunks requested per update at most.
+    int   m_NumberOfIdleFrames;                                         // Updates a chunk stays resident without being used.
+};
+
+// -----------------------------------------------------------------------------
+
+struct STerrainStatistics
+{
+    int    m_NumberOfResidentTiles;
+    int    m_NumberOfResidentChunks;                                    // Chunks with a mesh.
+    int    m_NumberOfSelectedChunks;                                    // Chunks drawn after the last update.
+    int    m_NumberOfPendingChunks;                                     // Chunks which are built by a job right now.
+    size_t m_TileBytes;                                                 // Mapped samples and LOD data of the resident tiles.
+    size_t m_ChunkBytes;                                                // Vertices and indices of the resident chunks.
+    int    m_NumberOfBuiltChunks;                                       // Since the statistics were reset.
+    double m_AverageBuildTime;                                          // Milliseconds in the job per chunk.
+    double m_AverageLatency;                                            // Milliseconds from the request to the mesh.
+    double m_MaximumLatency;
+};
+
+// -----------------------------------------------------------------------------
+// One node of the quadtree of a tile. The vertices have position and texture
+// coordinates like 'textured.fx' and are only kept until the mesh is created.
+// -----------------------------------------------------------------------------
+struct STerrainChunk
+{
+    struct SState
+    {
+        enum EState
+        {
+            Empty,                                                      ///< No mesh and no job.
+            Building,                                                   ///< A job fills the vertices.
+            Ready,                                                      ///< The mesh is created.
+        };
+    };
+
+    gfx::BHandle       m_pMesh;                                         // Set by the create callback.
+    gfx::BHandle       m_pDepthMesh;
+    float              m_WSCenter[3];                                   // Sphere around the chunk and its skirt.
+    float              m_Radius;
+    int                m_Level;                                         // 0 is the root covering the whole tile.
+    std::vector<float> m_Vertices;                                      // Five floats per vertex.
+    std::vector<int>   m_Indices;
+
+    CTerrain*          m_pTerrain;                                      // The members below are used by the terrain only.
+    int                m_IndexOfTile;
+    int                m_X;                                             // Position of the node on its level.
+    int                m_Z;
+    SState::EState     m_State;
+    std::atomic<bool>  m_IsBuilt;                                       // Set by the job when the vertices are complete.
+    int                m_LastUsedFrame;
+    int                m_NumberOfVertices;                              // Kept for the statistics after the vertices are freed.
+    int                m_NumberOfIndices;
+    double             m_BuildTime;
+    CStopwatch         m_Stopwatch;                                     // Started with the request.
+    SJob               m_Job;
+};
+
+typedef void (*FTerrainChunkCallback)(STerrainChunk& _rChunk, void* _pUserData);
+
+// -----------------------------------------------------------------------------
+// Terrain of heightmap tiles which are mapped from a file and streamed around
+// the camera. Each tile is a quadtree of chunks with the same number of quads,
+// the root covers the whole tile with every n-th sample, the leaves use all
+// samples. The error of a chunk is the largest height difference to the full
+// resolution inside of it. A chunk is refined if its error projected onto the
+// screen is larger than the allowed number of pixels and all four children
+// are ready, otherwise it is drawn and the missing children are requested, so
+// the terrain never has holes while chunks are built. Neighbouring chunks of
+// different levels leave gaps along their common edge, which are hidden by a
+// skirt hanging down from the border of each chunk.
+//
+// Tiles are loaded and chunks are built as jobs. The results are picked up by
+// 'Update', which calls the callbacks on the calling thread, so the meshes are
+// created and released on the render thread. If the job system has no workers,
+// e.g. on a single core, the jobs run right away.
+// -----------------------------------------------------------------------------
+class CTerrain
+{
+    public:
+
+        CTerrain();
+        ~CTerrain();
+
+    private:
+
+        CTerrain(const CTerrain&);
+        CTerrain& operator = (const CTerrain&);
+
+    public:
+
+        void SetSettings(const STerrainSettings& _rSettings);          // Before 'Open'.
+        void SetJobSystem(CJobSystem* _pJobSystem);                     // nullptr uses the shared job system.
+        void SetCallbacks(FTerrainChunkCallback _pCreateMesh, FTerrainChunkCallback _pReleaseMesh, void* _pUserData);
+        void SetOrigin(const float* _pOrigin);                          // Before the first 'Update', the vertices contain it.
+        void SetViewport(int _Width, int _Height);
+
+        bool Open(const char* _pPath);
+        void Close();
+        void ReleaseChunks();                                           // Releases all meshes, they are built again when needed.
+
+        bool IsOpen() const;
+
+        float GetHeight(float _X, float _Z) const;                      // World space, the height of the closest edge outside of the terrain.
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Picks up the finished jobs, streams the tiles, selects the chunks for
+        // the camera, requests missing ones, and evicts those which were not used
+        // for a while.
+        // -----------------------------------------------------------------------------
+        void Update(const SCameraSnapshot& _rCamera);
+
+        int                  GetNumberOfSelectedChunks() const;
+        const STerrainChunk& GetSelectedChunk(int _Index) const;
+
+        void GetStatistics(STerrainStatistics& _rStatistics) const;
+        void ResetStatistics();
+
+    private:
+
+        struct STile
+        {
+            int                m_IndexOfTile;
+            bool               m_IsResident;                            // The LOD data is loaded or a job loads it.
+            std::atomic<bool>  m_IsLoaded;
+            int                m_NumberOfPendingChunks;
+            std::vector<float> m_Errors;                                // One per node, the nodes level by level.
+            std::vector<float> m_MinimumHeights;
+            std::vector<float> m_MaximumHeights;
+            STerrainChunk*     m_pChunks;                               // One per node.
+            CTerrain*          m_pTerrain;
+            SJob               m_Job;
+        };
+
+    private:
+
+        STerrainSettings      m_Settings;
+        CJobSystem*           m_pJobSystem;
+        FTerrainChunkCallback m_pCreateMesh;
+        FTerrainChunkCallback m_pReleaseMesh;
+        void*                 m_pUserData;
+        float                 m_Origin[3];
+        int                   m_ViewportHeight;
+
+        CMappedFile           m_File;
+        STerrainHeader        m_Header;
+        const unsigned short* m_pSamples;                               // The first tile in the mapped file.
+        int                   m_NumberOfLevels;
+        int                   m_NumberOfNodes;                          // Per tile.
+        STile*                m_pTiles;
+        CJobCounter           m_PendingJobs;
+
+        int                   m_Frame;
+        int                   m_NumberOfRequests;                       // Chunks requested in the current update.
+        std::vector<STerrainChunk*> m_SelectedChunks;
+
+        int                   m_NumberOfBuiltChunks;
+        double                m_BuildTime;
+        double                m_Latency;
+        double                m_MaximumLatency;
+
+    private:
+
+        CJobSystem& GetCurrentJobSystem() const;
+        void        Run(SJob& _rJob);
+
+        int   GetIndexOfNode(int _Level, int _X, int _Z) const;
+        float GetSampleHeight(const STile& _rTile, int _X, int _Z) const;
+        void  GetNodeBounds(const STile& _rTile, int _IndexOfNode, float* _pMinimum, float* _pMaximum) const;
+
+        void  LoadTile(STile& _rTile);
+        void  EvictTile(STile& _rTile);
+        void  BuildChunk(STerrainChunk& _rChunk);
+        void  CreateMesh(STile& _rTile, STerrainChunk& _rChunk);
+        void  ReleaseChunk(STerrainChunk& _rChunk);
+        bool  Request(STile& _rTile, int _IndexOfNode);
+        void  Select(STile& _rTile, const SCameraSnapshot& _rCamera, int _Level, int _X, int _Z);
+
+        static void LoadTileJob(void* _pData);
+        static void BuildChunkJob(void* _pData);
+};
@@ -0,0 +1,458 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <string.h>
+
+namespace
+{
+    int GetNextPowerOfTwo(int _Value)
+    {
+        int Result = 1;
+
+        while (Result < _Value) Result *= 2;
+
+        return Result;
+    }
+} // namespace
+
+CAtlasPacker::CAtlasPacker()
+{
+    m_Settings.m_MaximumSize       = 4096;
+    m_Settings.m_Padding           = 0;
+    m_Settings.m_NumberOfMipLevels = 1;
+}
+
+// -----------------------------------------------------------------------------
+
+CAtlasPacker::~CAtlasPacker()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CAtlasPacker::SetSettings(const SAtlasSettings& _rSettings)
+{
+    assert(_rSettings.m_NumberOfMipLevels >= 1 && _rSettings.m_MaximumSize % GetAlignedSize(1) == 0);
+
+    m_Settings = _rSettings;
+}
+
+// -----------------------------------------------------------------------------
+
+int CAtlasPacker::AddSprite(int _Width, int _Height)
+{
+    SAtlasRect Rect = {};
+
+    Rect.m_Width  = _Width;
+    Rect.m_Height = _Height;
+
+    m_Rects.push_back(Rect);
+
+    return static_cast<int>(m_Rects.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CAtlasPacker::Pack()
+{
+    m_Pages.clear();
+
+    int Padding = m_Settings.m_Padding;
+
+    for (SAtlasRect& rRect : m_Rects)
+    {
+        rRect.m_Cell[2] = GetAlignedSize(rRect.m_Width  + 2 * Padding);
+        rRect.m_Cell[3] = GetAlignedSize(rRect.m_Height + 2 * Padding);
+
+        if (rRect.m_Cell[2] > m_Settings.m_MaximumSize || rRect.m_Cell[3] > m_Settings.m_MaximumSize) return false;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Highest sprites first, the skyline stays flat when sprites of about the
+    // same height end up next to each other.
+    // -----------------------------------------------------------------------------
+    std::vector<int> Sprites(m_Rects.size());
+
+    std::iota(Sprites.begin(), Sprites.end(), 0);
+
+    std::sort(Sprites.begin(), Sprites.end(), [&](int _Left, int _Right)
+    {
+        const SAtlasRect& rLeft  = m_Rects[_Left];
+        const SAtlasRect& rRight = m_Rects[_Right];
+
+        return rLeft.m_Cell[3] > rRight.m_Cell[3] || (rLeft.m_Cell[3] == rRight.m_Cell[3] && rLeft.m_Cell[2] > rRight.m_Cell[2]);
+    });
+
+    // -----------------------------------------------------------------------------
+    // One page as small as possible, square or half as high as wide, at least
+    // as large as the largest sprite and the area of all sprites, else full
+    // pages.
+    // -----------------------------------------------------------------------------
+    long long Area        = 0;
+    int       MinimumSize = GetAlignedSize(1);
+
+    for (const SAtlasRect& rRect : m_Rects)
+    {
+        Area        += static_cast<long long>(rRect.m_Cell[2]) * rRect.m_Cell[3];
+        MinimumSize  = std::max(MinimumSize, std::max(rRect.m_Cell[2], rRect.m_Cell[3]));
+    }
+
+    for (int Size = GetNextPowerOfTwo(MinimumSize); Size <= m_Settings.m_MaximumSize && m_Pages.empty(); Size *= 2)
+    {
+        for (int Height = Size / 2; Height <= Size && m_Pages.empty(); Height *= 2)
+        {
+            if (Height < MinimumSize || static_cast<long long>(Size) * Height < Area) continue;
+
+            std::vector<int> Remaining = Sprites;
+
+            if (PackPage(Size, Height, Remaining, 0)) m_Pages.push_back({ Size, Height });
+        }
+    }
+
+    if (m_Pages.empty())
+    {
+        int Size = m_Settings.m_MaximumSize;
+
+        while (Sprites.empty() == false)
+        {
+            int IndexOfPage = static_cast<int>(m_Pages.size());
+
+            size_t NumberOfSprites = Sprites.size();
+
+            PackPage(Size, Size, Sprites, IndexOfPage);
+
+            if (Sprites.size() == NumberOfSprites) return false;
+
+            m_Pages.push_back({ Size, Size });
+        }
+
+        // The last page is cut down to the power of two of the rows it uses
+        int Height = 0;
+
+        for (const SAtlasRect& rRect : m_Rects)
+        {
+            if (rRect.m_Page == static_cast<int>(m_Pages.size()) - 1) Height = std::max(Height, rRect.m_Cell[1] + rRect.m_Cell[3]);
+        }
+
+        m_Pages.back().m_Height = std::max(GetNextPowerOfTwo(Height), GetAlignedSize(1));
+    }
+
+    // -----------------------------------------------------------------------------
+    // The sprite sits in the upper left of its cell after the padding.
+    // -----------------------------------------------------------------------------
+    for (SAtlasRect& rRect : m_Rects)
+    {
+        const SAtlasPage& rPage = m_Pages[rRect.m_Page];
+
+        rRect.m_X = rRect.m_Cell[0] + Padding;
+        rRect.m_Y = rRect.m_Cell[1] + Padding;
+
+        rRect.m_UVRect[0] = static_cast<float>(rRect.m_X     ) / static_cast<float>(rPage.m_Width );
+        rRect.m_UVRect[1] = static_cast<float>(rRect.m_Y     ) / static_cast<float>(rPage.m_Height);
+        rRect.m_UVRect[2] = static_cast<float>(rRect.m_Width ) / static_cast<float>(rPage.m_Width );
+        rRect.m_UVRect[3] = static_cast<float>(rRect.m_Height) / static_cast<float>(rPage.m_Height);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CAtlasPacker::Clear()
+{
+    m_Rects.clear();
+    m_Pages.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+int CAtlasPacker::GetNumberOfSprites() const
+{
+    return static_cast<int>(m_Rects.size());
+}
+
+// -----------------------------------------------------------------------------
+
+const SAtlasRect& CAtlasPacker::GetRect(int _IndexOfSprite) const
+{
+    return m_Rects[_IndexOfSprite];
+}
+
+// -----------------------------------------------------------------------------
+
+int CAtlasPacker::GetNumberOfPages() const
+{
+    return static_cast<int>(m_Pages.size());
+}
+
+// -----------------------------------------------------------------------------
+
+const SAtlasPage& CAtlasPacker::GetPage(int _IndexOfPage) const
+{
+    return m_Pages[_IndexOfPage];
+}
+
+// -----------------------------------------------------------------------------
+
+float CAtlasPacker::GetEfficiency() const
+{
+    double SpriteArea = 0.0;
+    double PageArea   = 0.0;
+
+    for (const SAtlasRect& rRect : m_Rects) SpriteArea += static_cast<double>(rRect.m_Width) * rRect.m_Height;
+    for (const SAtlasPage& rPage : m_Pages) PageArea   += static_cast<double>(rPage.m_Width) * rPage.m_Height;
+
+    return PageArea > 0.0 ? static_cast<float>(SpriteArea / PageArea) : 0.0f;
+}
+
+// -----------------------------------------------------------------------------
+// Places the sprites in the order of the list with the bottom-left rule: the
+// position whose top edge is lowest, on ties the one leaving the smaller gap
+// below the sprite. Placed sprites are removed from the list, returns true if
+// all of them were placed.
+// -----------------------------------------------------------------------------
+bool CAtlasPacker::PackPage(int _Width, int _Height, std::vector<int>& _rSprites, int _IndexOfPage)
+{
+    std::vector<SSkylineNode> Skyline = { { 0, 0, _Width } };
+
+    std::vector<int> Remaining;
+
+    for (int IndexOfSprite : _rSprites)
+    {
+        SAtlasRect& rRect = m_Rects[IndexOfSprite];
+
+        int Width  = rRect.m_Cell[2];
+        int Height = rRect.m_Cell[3];
+
+        size_t BestNode  = Skyline.size();
+        int    BestTop   = _Height + 1;
+        int    BestWaste = 0;
+        int    BestY     = 0;
+
+        for (size_t IndexOfNode = 0; IndexOfNode < Skyline.size(); ++ IndexOfNode)
+        {
+            if (Skyline[IndexOfNode].m_X + Width > _Width) break;
+
+            // The sprite rests on the highest node below its width
+            int Y     = 0;
+            int Waste = 0;
+
+            for (size_t Index = IndexOfNode, Left = Width; Left > 0; ++ Index)
+            {
+                const SSkylineNode& rNode = Skyline[Index];
+
+                Y    = std::max(Y, rNode.m_Y);
+                Left = Left > static_cast<size_t>(rNode.m_Width) ? Left - rNode.m_Width : 0;
+            }
+
+            if (Y + Height > _Height) continue;
+
+            for (size_t Index = IndexOfNode, Left = Width; Left > 0; ++ Index)
+            {
+                const SSkylineNode& rNode = Skyline[Index];
+
+                int Covered = static_cast<int>(std::min(Left, static_cast<size_t>(rNode.m_Width)));
+
+                Waste += (Y - rNode.m_Y) * Covered;
+                Left  -= Covered;
+            }
+
+            if (Y + Height < BestTop || (Y + Height == BestTop && Waste < BestWaste))
+            {
+                BestNode  = IndexOfNode;
+                BestTop   = Y + Height;
+                BestWaste = Waste;
+                BestY     = Y;
+            }
+        }
+
+        if (BestNode == Skyline.size())
+        {
+            Remaining.push_back(IndexOfSprite);
+
+            continue;
+        }
+
+        int X = Skyline[BestNode].m_X;
+
+        rRect.m_Page    = _IndexOfPage;
+        rRect.m_Cell[0] = X;
+        rRect.m_Cell[1] = BestY;
+
+        // -----------------------------------------------------------------------------
+        // The new node covers the width of the sprite, the nodes below it are
+        // removed or shortened, and neighbours of the same height merged.
+        // -----------------------------------------------------------------------------
+        Skyline.insert(Skyline.begin() + BestNode, { X, BestY + Height, Width });
+
+        for (size_t Index = BestNode + 1; Index < Skyline.size(); )
+        {
+            SSkylineNode& rNode = Skyline[Index];
+
+            int End = X + Width;
+
+            if (rNode.m_X >= End) break;
+
+            int Shrink = End - rNode.m_X;
+
+            if (Shrink < rNode.m_Width)
+            {
+                rNode.m_X     += Shrink;
+                rNode.m_Width -= Shrink;
+
+                break;
+            }
+
+            Skyline.erase(Skyline.begin() + Index);
+        }
+
+        for (size_t Index = 0; Index + 1 < Skyline.size(); )
+        {
+            if (Skyline[Index].m_Y == Skyline[Index + 1].m_Y)
+            {
+                Skyline[Index].m_Width += Skyline[Index + 1].m_Width;
+
+                Skyline.erase(Skyline.begin() + Index + 1);
+            }
+            else
+            {
+                ++ Index;
+            }
+        }
+    }
+
+    _rSprites.swap(Remaining);
+
+    return _rSprites.empty();
+}
+
+// -----------------------------------------------------------------------------
+
+int CAtlasPacker::GetAlignedSize(int _Size) const
+{
+    int Alignment = 1 << (m_Settings.m_NumberOfMipLevels - 1);
+
+    return (_Size + Alignment - 1) / Alignment * Alignment;
+}
+
+// -----------------------------------------------------------------------------
+
+void CopySprite(const STextureImage& _rSprite, const SAtlasRect& _rRect, STextureImage& _rPage)
+{
+    float ScaleX = static_cast<float>(_rSprite.m_Width ) / static_cast<float>(_rRect.m_Width );
+    float ScaleY = static_cast<float>(_rSprite.m_Height) / static_cast<float>(_rRect.m_Height);
+
+    int CellX = _rRect.m_Cell[0];
+    int CellY = _rRect.m_Cell[1];
+
+    for (int Y = CellY; Y < CellY + _rRect.m_Cell[3] && Y < _rPage.m_Height; ++ Y)
+    {
+        // The texel center in the sprite, outside of the sprite its edge is repeated
+        float SpriteY = std::min(std::max((static_cast<float>(Y - _rRect.m_Y) + 0.5f) * ScaleY - 0.5f, 0.0f), static_cast<float>(_rSprite.m_Height - 1));
+
+        int   Y0        = static_cast<int>(SpriteY);
+        int   Y1        = std::min(Y0 + 1, _rSprite.m_Height - 1);
+        float FractionY = SpriteY - static_cast<float>(Y0);
+
+        for (int X = CellX; X < CellX + _rRect.m_Cell[2] && X < _rPage.m_Width; ++ X)
+        {
+            float SpriteX = std::min(std::max((static_cast<float>(X - _rRect.m_X) + 0.5f) * ScaleX - 0.5f, 0.0f), static_cast<float>(_rSprite.m_Width - 1));
+
+            int   X0        = static_cast<int>(SpriteX);
+            int   X1        = std::min(X0 + 1, _rSprite.m_Width - 1);
+            float FractionX = SpriteX - static_cast<float>(X0);
+
+            const unsigned char* p00 = &_rSprite.m_Pixels[(static_cast<size_t>(Y0) * _rSprite.m_Width + X0) * 4];
+            const unsigned char* p01 = &_rSprite.m_Pixels[(static_cast<size_t>(Y0) * _rSprite.m_Width + X1) * 4];
+            const unsigned char* p10 = &_rSprite.m_Pixels[(static_cast<size_t>(Y1) * _rSprite.m_Width + X0) * 4];
+            const unsigned char* p11 = &_rSprite.m_Pixels[(static_cast<size_t>(Y1) * _rSprite.m_Width + X1) * 4];
+
+            unsigned char* pTarget = &_rPage.m_Pixels[(static_cast<size_t>(Y) * _rPage.m_Width + X) * 4];
+
+            for (int Channel = 0; Channel < 4; ++ Channel)
+            {
+                float Top    = p00[Channel] + (p01[Channel] - p00[Channel]) * FractionX;
+                float Bottom = p10[Channel] + (p11[Channel] - p10[Channel]) * FractionX;
+
+                pTarget[Channel] = static_cast<unsigned char>(Top + (Bottom - Top) * FractionY + 0.5f);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool WriteAtlasDescription(const char* _pPath, const std::vector<SAtlasSprite>& _rSprites)
+{
+    std::ofstream File(_pPath);
+
+    if (!File) return false;
+
+    File << std::fixed << std::setprecision(6);
+
+    for (const SAtlasSprite& rSprite : _rSprites)
+    {
+        File << rSprite.m_Path << " " << rSprite.m_Page << " " << rSprite.m_UVRect[0] << " " << rSprite.m_UVRect[1] << " " << rSprite.m_UVRect[2] << " " << rSprite.m_UVRect[3] << "\n";
+    }
+
+    return static_cast<bool>(File);
+}
+
+// -----------------------------------------------------------------------------
+
+bool ReadAtlasDescription(const char* _pPath, std::vector<SAtlasSprite>& _rSprites)
+{
+    _rSprites.clear();
+
+    std::ifstream File(_pPath);
+
+    if (!File) return false;
+
+    std::string Line;
+
+    while (std::getline(File, Line))
+    {
+        if (Line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::istringstream Stream(Line);
+
+        SAtlasSprite Sprite;
+
+        Stream >> Sprite.m_Path >> Sprite.m_Page >> Sprite.m_UVRect[0] >> Sprite.m_UVRect[1] >> Sprite.m_UVRect[2] >> Sprite.m_UVRect[3];
+
+        if (!Stream || Sprite.m_Page < 0)
+        {
+            _rSprites.clear();
+
+            return false;
+        }
+
+        _rSprites.push_back(Sprite);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+const SAtlasSprite* FindAtlasSprite(const std::vector<SAtlasSprite>& _rSprites, const char* _pFileName)
+{
+    size_t LengthOfName = strlen(_pFileName);
+
+    for (const SAtlasSprite& rSprite : _rSprites)
+    {
+        const std::string& rPath = rSprite.m_Path;
+
+        if (rPath.size() < LengthOfName || rPath.compare(rPath.size() - LengthOfName, LengthOfName, _pFileName) != 0) continue;
+
+        // The name has to start after a separator, so 'old_wall.dds' is not found as 'wall.dds'
+        if (rPath.size() == LengthOfName || rPath[rPath.size() - LengthOfName - 1] == '\\' || rPath[rPath.size() - LengthOfName - 1] == '/') return &rSprite;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "texture_file.h"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Each sprite is surrounded by padding texels repeating its edge, so the
+// bilinear filter never reads a neighbour. With more than one mip level the
+// sprites including their padding are aligned to blocks of 2^(levels - 1)
+// texels, so no texel of the smallest level mixes two sprites. A padding of
+// at least half the block size keeps the filter of that level inside.
+// -----------------------------------------------------------------------------
+struct SAtlasSettings
+{
+    int m_MaximumSize;                                                  // Width and height of a full page.
+    int m_Padding;                                                      // Texels on each side of a sprite.
+    int m_NumberOfMipLevels;                                            // Mip levels of the atlas textures.
+};
+
+// -----------------------------------------------------------------------------
+// The place of a sprite in the atlas. The UV rect maps the texture coordinates
+// of the sprite to the atlas: 'uv * size + offset'.
+// -----------------------------------------------------------------------------
+struct SAtlasRect
+{
+    int   m_Page;
+    int   m_X;                                                          // Upper left texel of the sprite without padding.
+    int   m_Y;
+    int   m_Width;
+    int   m_Height;
+    int   m_Cell[4];                                                    // X, y, width, and height of the sprite with padding and alignment.
+    float m_UVRect[4];                                                  // Offset u and v, size u and v.
+};
+
+// -----------------------------------------------------------------------------
+// One line of the description of an atlas, which the atlas tool writes next to
+// the pages. The sprite is found by the path of its color map, the path must
+// not contain white space.
+// -----------------------------------------------------------------------------
+struct SAtlasSprite
+{
+    std::string m_Path;                                                 // Color map the sprite was packed from.
+    int         m_Page;
+    float       m_UVRect[4];                                            // See 'SAtlasRect::m_UVRect'.
+};
+
+// -----------------------------------------------------------------------------
+
+struct SAtlasPage
+{
+    int m_Width;
+    int m_Height;
+};
+
+// -----------------------------------------------------------------------------
+// Packs the sprites of billboards into atlas pages with a skyline packer. The
+// sprites are placed from the highest to the lowest, each one at the lowest
+// position of the skyline where it fits, so the pages fill up row by row
+// without the bookkeeping of free rectangles. All sprites go into the
+// smallest power of two page they fit into, square or half as high as wide,
+// otherwise into pages of the maximum size, the last one cut down to the rows
+// it uses.
+//
+// The color and the normal map of a sprite share the rect, so both atlases of
+// a page are composed with the same rects, see 'CopySprite'.
+// -----------------------------------------------------------------------------
+class CAtlasPacker
+{
+    public:
+
+        CAtlasPacker();
+        ~CAtlasPacker();
+
+    public:
+
+        void SetSettings(const SAtlasSettings& _rSettings);
+
+        int  AddSprite(int _Width, int _Height);                        // Returns the index of the sprite.
+        bool Pack();                                                    // False if a sprite is larger than a page.
+        void Clear();
+
+    public:
+
+        int               GetNumberOfSprites() const;
+        const SAtlasRect& GetRect(int _IndexOfSprite) const;
+        int               GetNumberOfPages() const;
+        const SAtlasPage& GetPage(int _IndexOfPage) const;
+        float             GetEfficiency() const;                        // Texels of the sprites divided by the texels of the pages.
+
+    private:
+
+        struct SSkylineNode
+        {
+            int m_X;
+            int m_Y;                                                    // Height of the skyline from 'm_X' on.
+            int m_Width;
+        };
+
+    private:
+
+        bool PackPage(int _Width, int _Height, std::vector<int>& _rSprites, int _IndexOfPage);
+        int  GetAlignedSize(int _Size) const;
+
+    private:
+
+        SAtlasSettings          m_Settings;
+        std::vector<SAtlasRect> m_Rects;
+        std::vector<SAtlasPage> m_Pages;
+};
+
+// -----------------------------------------------------------------------------
+// Copies a sprite into its rect of an atlas page and fills the rest of the cell
+// with its edge texels. A sprite of another size than the rect, e.g. a normal
+// map with half the resolution of its color map, is filtered bilinearly.
+// -----------------------------------------------------------------------------
+void CopySprite(const STextureImage& _rSprite, const SAtlasRect& _rRect, STextureImage& _rPage);
+
+// -----------------------------------------------------------------------------
+// Writes and reads the description of an atlas, one sprite per line: its path,
+// its page, and its UV rect. Reading fails on a missing file or a broken line.
+// -----------------------------------------------------------------------------
+bool WriteAtlasDescription(const char* _pPath, const std::vector<SAtlasSprite>& _rSprites);
+bool ReadAtlasDescription(const char* _pPath, std::vector<SAtlasSprite>& _rSprites);
+
+// -----------------------------------------------------------------------------
+// Returns the sprite whose path ends with the given file name, e.g.
+// 'wall_color_map.dds', or null.
+// -----------------------------------------------------------------------------
+const SAtlasSprite* FindAtlasSprite(const std::vector<SAtlasSprite>& _rSprites, const char* _pFileName);
@@ -0,0 +1,661 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "texture_file.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Reads the bits of a deflate stream, least significant bit first. Reading
+    // past the end returns zeros and sets the error flag.
+    // -----------------------------------------------------------------------------
+    class CBitReader
+    {
+        public:
+
+            CBitReader(const unsigned char* _pData, size_t _NumberOfBytes)
+                : m_pData        (_pData)
+                , m_NumberOfBytes(_NumberOfBytes)
+                , m_Position     (0)
+                , m_Bits         (0)
+                , m_NumberOfBits (0)
+                , m_HasError     (false)
+            {
+            }
+
+        public:
+
+            unsigned int GetBits(int _NumberOfBits)
+            {
+                while (m_NumberOfBits < _NumberOfBits)
+                {
+                    if (m_Position < m_NumberOfBytes)
+                    {
+                        m_Bits |= static_cast<unsigned int>(m_pData[m_Position ++]) << m_NumberOfBits;
+                    }
+                    else
+                    {
+                        m_HasError = true;
+                    }
+
+                    m_NumberOfBits += 8;
+                }
+
+                unsigned int Value = m_Bits & ((1u << _NumberOfBits) - 1);
+
+                m_Bits         >>= _NumberOfBits;
+                m_NumberOfBits  -= _NumberOfBits;
+
+                return Value;
+            }
+
+            void SkipToByte()
+            {
+                m_Bits         = 0;
+                m_NumberOfBits = 0;
+            }
+
+            const unsigned char* GetBytes(size_t _NumberOfBytes)
+            {
+                if (m_Position + _NumberOfBytes > m_NumberOfBytes)
+                {
+                    m_HasError = true;
+
+                    return nullptr;
+                }
+
+                const unsigned char* pBytes = m_pData + m_Position;
+
+                m_Position += _NumberOfBytes;
+
+                return pBytes;
+            }
+
+            bool HasError() const
+            {
+                return m_HasError;
+            }
+
+        private:
+
+            const unsigned char* m_pData;
+            size_t               m_NumberOfBytes;
+            size_t               m_Position;                            // Next byte to load into the bit buffer.
+            unsigned int         m_Bits;                                // Loaded bits which are not read yet.
+            int                  m_NumberOfBits;
+            bool                 m_HasError;
+    };
+
+    // -----------------------------------------------------------------------------
+    // A canonical Huffman code given by the number of codes of each length and
+    // the symbols ordered by their codes.
+    // -----------------------------------------------------------------------------
+    struct SHuffmanCode
+    {
+        short m_Counts[16];
+        short m_Symbols[288];
+    };
+
+    // -----------------------------------------------------------------------------
+
+    bool BuildHuffmanCode(const unsigned char* _pLengths, int _NumberOfSymbols, SHuffmanCode& _rCode)
+    {
+        short Offsets[16];
+
+        memset(_rCode.m_Counts, 0, sizeof(_rCode.m_Counts));
+
+        for (int Symbol = 0; Symbol < _NumberOfSymbols; ++ Symbol) ++ _rCode.m_Counts[_pLengths[Symbol]];
+
+        // Oversubscribed codes are invalid, incomplete codes are allowed
+        int Left = 1;
+
+        for (int Length = 1; Length < 16; ++ Length)
+        {
+            Left = (Left << 1) - _rCode.m_Counts[Length];
+
+            if (Left < 0) return false;
+        }
+
+        Offsets[1] = 0;
+
+        for (int Length = 1; Length < 15; ++ Length) Offsets[Length + 1] = Offsets[Length] + _rCode.m_Counts[Length];
+
+        for (int Symbol = 0; Symbol < _NumberOfSymbols; ++ Symbol)
+        {
+            if (_pLengths[Symbol] != 0) _rCode.m_Symbols[Offsets[_pLengths[Symbol]] ++] = static_cast<short>(Symbol);
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int DecodeSymbol(CBitReader& _rReader, const SHuffmanCode& _rCode)
+    {
+        int Code  = 0;
+        int First = 0;
+        int Index = 0;
+
+        for (int Length = 1; Length < 16; ++ Length)
+        {
+            Code |= static_cast<int>(_rReader.GetBits(1));
+
+            int Count = _rCode.m_Counts[Length];
+
+            if (Code - Count < First) return _rCode.m_Symbols[Index + (Code - First)];
+
+            Index  += Count;
+            First  += Count;
+            First <<= 1;
+            Code  <<= 1;
+        }
+
+        return -1;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool InflateBlock(CBitReader& _rReader, const SHuffmanCode& _rLengthCode, const SHuffmanCode& _rDistanceCode, std::vector<unsigned char>& _rOutput)
+    {
+        static const short s_LengthBases    [29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const short s_LengthBits     [29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const short s_DistanceBases  [30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const short s_DistanceBits   [30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        for (;;)
+        {
+            int Symbol = DecodeSymbol(_rReader, _rLengthCode);
+
+            if (Symbol < 0 || _rReader.HasError()) return false;
+
+            if (Symbol < 256)
+            {
+                _rOutput.push_back(static_cast<unsigned char>(Symbol));
+            }
+            else if (Symbol == 256)
+            {
+                return true;
+            }
+            else
+            {
+                Symbol -= 257;
+
+                if (Symbol >= 29) return false;
+
+                int Length         = s_LengthBases[Symbol] + static_cast<int>(_rReader.GetBits(s_LengthBits[Symbol]));
+                int DistanceSymbol = DecodeSymbol(_rReader, _rDistanceCode);
+
+                if (DistanceSymbol < 0 || DistanceSymbol >= 30) return false;
+
+                size_t Distance = s_DistanceBases[DistanceSymbol] + _rReader.GetBits(s_DistanceBits[DistanceSymbol]);
+
+                if (Distance > _rOutput.size()) return false;
+
+                for (int Index = 0; Index < Length; ++ Index) _rOutput.push_back(_rOutput[_rOutput.size() - Distance]);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Decompresses a zlib stream (RFC 1950 and 1951). The checksum is not tested.
+    // -----------------------------------------------------------------------------
+    bool Inflate(const std::vector<unsigned char>& _rInput, std::vector<unsigned char>& _rOutput)
+    {
+        if (_rInput.size() < 2 || (_rInput[0] & 0x0F) != 8 || (_rInput[1] & 0x20) != 0) return false;
+
+        CBitReader Reader(_rInput.data() + 2, _rInput.size() - 2);
+
+        bool IsLastBlock = false;
+
+        while (IsLastBlock == false)
+        {
+            IsLastBlock = Reader.GetBits(1) != 0;
+
+            unsigned int Type = Reader.GetBits(2);
+
+            if (Type == 0)
+            {
+                Reader.SkipToByte();
+
+                const unsigned char* pHeader = Reader.GetBytes(4);
+
+                if (pHeader == nullptr) return false;
+
+                size_t Length = pHeader[0] | (pHeader[1] << 8);
+
+                if ((Length ^ (pHeader[2] | (pHeader[3] << 8))) != 0xFFFF) return false;
+
+                const unsigned char* pBytes = Reader.GetBytes(Length);
+
+                if (pBytes == nullptr) return false;
+
+                _rOutput.insert(_rOutput.end(), pBytes, pBytes + Length);
+            }
+            else if (Type == 1)
+            {
+                unsigned char Lengths[288 + 30];
+
+                memset(Lengths +   0, 8, 144);
+                memset(Lengths + 144, 9, 112);
+                memset(Lengths + 256, 7,  24);
+                memset(Lengths + 280, 8,   8);
+                memset(Lengths + 288, 5,  30);
+
+                SHuffmanCode LengthCode;
+                SHuffmanCode DistanceCode;
+
+                BuildHuffmanCode(Lengths, 288, LengthCode);
+                BuildHuffmanCode(Lengths + 288, 30, DistanceCode);
+
+                if (InflateBlock(Reader, LengthCode, DistanceCode, _rOutput) == false) return false;
+            }
+            else if (Type == 2)
+            {
+                static const unsigned char s_Order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+                int NumberOfLengthCodes   = static_cast<int>(Reader.GetBits(5)) + 257;
+                int NumberOfDistanceCodes = static_cast<int>(Reader.GetBits(5)) + 1;
+                int NumberOfCodeLengths   = static_cast<int>(Reader.GetBits(4)) + 4;
+
+                if (NumberOfLengthCodes > 286 || NumberOfDistanceCodes > 30) return false;
+
+                unsigned char Lengths[288 + 30] = {};
+
+                for (int Index = 0; Index < NumberOfCodeLengths; ++ Index) Lengths[s_Order[Index]] = static_cast<unsigned char>(Reader.GetBits(3));
+
+                SHuffmanCode LengthsCode;
+
+                if (BuildHuffmanCode(Lengths, 19, LengthsCode) == false) return false;
+
+                // The code lengths of both codes are one sequence with run lengths
+                int NumberOfLengths = NumberOfLengthCodes + NumberOfDistanceCodes;
+
+                memset(Lengths, 0, sizeof(Lengths));
+
+                for (int Index = 0; Index < NumberOfLengths; )
+                {
+                    int Symbol = DecodeSymbol(Reader, LengthsCode);
+
+                    if (Symbol < 0 || Reader.HasError()) return false;
+
+                    if (Symbol < 16)
+                    {
+                        Lengths[Index ++] = static_cast<unsigned char>(Symbol);
+
+                        continue;
+                    }
+
+                    unsigned char Length = 0;
+                    int           Repeat = 0;
+
+                    if (Symbol == 16)
+                    {
+                        if (Index == 0) return false;
+
+                        Length = Lengths[Index - 1];
+                        Repeat = 3 + static_cast<int>(Reader.GetBits(2));
+                    }
+                    else if (Symbol == 17)
+                    {
+                        Repeat = 3 + static_cast<int>(Reader.GetBits(3));
+                    }
+                    else
+                    {
+                        Repeat = 11 + static_cast<int>(Reader.GetBits(7));
+                    }
+
+                    if (Index + Repeat > NumberOfLengths) return false;
+
+                    for (; Repeat > 0; -- Repeat) Lengths[Index ++] = Length;
+                }
+
+                SHuffmanCode LengthCode;
+                SHuffmanCode DistanceCode;
+
+                if (BuildHuffmanCode(Lengths, NumberOfLengthCodes, LengthCode) == false) return false;
+                if (BuildHuffmanCode(Lengths + NumberOfLengthCodes, NumberOfDistanceCodes, DistanceCode) == false) return false;
+
+                if (InflateBlock(Reader, LengthCode, DistanceCode, _rOutput) == false) return false;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (Reader.HasError()) return false;
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetBigEndian(const unsigned char* _pData)
+    {
+        return (static_cast<unsigned int>(_pData[0]) << 24) | (_pData[1] << 16) | (_pData[2] << 8) | _pData[3];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned char GetPaethPredictor(int _Left, int _Up, int _UpLeft)
+    {
+        int Estimate = _Left + _Up - _UpLeft;
+        int Left     = abs(Estimate - _Left);
+        int Up       = abs(Estimate - _Up);
+        int UpLeft   = abs(Estimate - _UpLeft);
+
+        if (Left <= Up && Left <= UpLeft) return static_cast<unsigned char>(_Left);
+        if (Up <= UpLeft)                 return static_cast<unsigned char>(_Up);
+
+        return static_cast<unsigned char>(_UpLeft);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetLittleEndian(const unsigned char* _pData)
+    {
+        return (static_cast<unsigned int>(_pData[3]) << 24) | (_pData[2] << 16) | (_pData[1] << 8) | _pData[0];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetLittleEndian(unsigned char* _pData, unsigned int _Value)
+    {
+        _pData[0] = static_cast<unsigned char>(_Value      );
+        _pData[1] = static_cast<unsigned char>(_Value >>  8);
+        _pData[2] = static_cast<unsigned char>(_Value >> 16);
+        _pData[3] = static_cast<unsigned char>(_Value >> 24);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The channel of a texel selected by a bit mask of the DDS pixel format.
+    // -----------------------------------------------------------------------------
+    unsigned char GetChannel(unsigned int _Texel, unsigned int _Mask, unsigned char _Default)
+    {
+        if (_Mask == 0) return _Default;
+
+        int Shift = 0;
+
+        while ((_Mask & (1u << Shift)) == 0) ++ Shift;
+
+        unsigned int Maximum = _Mask >> Shift;
+
+        return static_cast<unsigned char>(((_Texel & _Mask) >> Shift) * 255 / Maximum);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool ReadFile(const char* _pPath, std::vector<unsigned char>& _rData)
+    {
+        FILE* pFile = fopen(_pPath, "rb");
+
+        if (pFile == nullptr) return false;
+
+        unsigned char Buffer[65536];
+        size_t        NumberOfBytes;
+
+        while ((NumberOfBytes = fread(Buffer, 1, sizeof(Buffer), pFile)) > 0) _rData.insert(_rData.end(), Buffer, Buffer + NumberOfBytes);
+
+        fclose(pFile);
+
+        return true;
+    }
+} // namespace
+
+bool ReadPng(const char* _pPath, STextureImage& _rImage)
+{
+    static const unsigned char s_Signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+    std::vector<unsigned char> File;
+
+    if (ReadFile(_pPath, File) == false || File.size() < 8 || memcmp(File.data(), s_Signature, 8) != 0) return false;
+
+    // -----------------------------------------------------------------------------
+    // Collect the header and the compressed data of all IDAT chunks.
+    // -----------------------------------------------------------------------------
+    std::vector<unsigned char> Compressed;
+
+    int Width     = 0;
+    int Height    = 0;
+    int ColorType = -1;
+
+    for (size_t Position = 8; Position + 12 <= File.size(); )
+    {
+        size_t               Length = GetBigEndian(&File[Position]);
+        const unsigned char* pType  = &File[Position + 4];
+        const unsigned char* pData  = &File[Position + 8];
+
+        if (Position + 12 + Length > File.size()) return false;
+
+        if (memcmp(pType, "IHDR", 4) == 0 && Length >= 13)
+        {
+            Width     = static_cast<int>(GetBigEndian(pData + 0));
+            Height    = static_cast<int>(GetBigEndian(pData + 4));
+            ColorType = pData[9];
+
+            // 8 bits per channel, no interlacing
+            if (pData[8] != 8 || pData[12] != 0) return false;
+        }
+        else if (memcmp(pType, "IDAT", 4) == 0)
+        {
+            Compressed.insert(Compressed.end(), pData, pData + Length);
+        }
+        else if (memcmp(pType, "IEND", 4) == 0)
+        {
+            break;
+        }
+
+        Position += 12 + Length;
+    }
+
+    int NumberOfChannels = ColorType == 0 ? 1 : ColorType == 2 ? 3 : ColorType == 4 ? 2 : ColorType == 6 ? 4 : 0;
+
+    if (NumberOfChannels == 0 || Width <= 0 || Height <= 0) return false;
+
+    size_t RowLength = static_cast<size_t>(Width) * NumberOfChannels;
+
+    std::vector<unsigned char> Rows;
+
+    Rows.reserve((RowLength + 1) * Height);
+
+    if (Inflate(Compressed, Rows) == false || Rows.size() < (RowLength + 1) * Height) return false;
+
+    // -----------------------------------------------------------------------------
+    // Undo the filter of each row in place and expand it to RGBA.
+    // -----------------------------------------------------------------------------
+    _rImage.m_Width  = Width;
+    _rImage.m_Height = Height;
+    _rImage.m_Pixels.assign(static_cast<size_t>(Width) * Height * 4, 255);
+
+    std::vector<unsigned char> Previous(RowLength, 0);
+
+    for (int Y = 0; Y < Height; ++ Y)
+    {
+        unsigned char  Filter = Rows[Y * (RowLength + 1)];
+        unsigned char* pRow   = &Rows[Y * (RowLength + 1) + 1];
+
+        for (size_t Index = 0; Index < RowLength; ++ Index)
+        {
+            int Left   = Index >= static_cast<size_t>(NumberOfChannels) ? pRow    [Index - NumberOfChannels] : 0;
+            int Up     = Previous[Index];
+            int UpLeft = Index >= static_cast<size_t>(NumberOfChannels) ? Previous[Index - NumberOfChannels] : 0;
+
+            switch (Filter)
+            {
+                case 0:                                                                                           break;
+                case 1: pRow[Index] = static_cast<unsigned char>(pRow[Index] + Left);                             break;
+                case 2: pRow[Index] = static_cast<unsigned char>(pRow[Index] + Up);                               break;
+                case 3: pRow[Index] = static_cast<unsigned char>(pRow[Index] + (Left + Up) / 2);                  break;
+                case 4: pRow[Index] = static_cast<unsigned char>(pRow[Index] + GetPaethPredictor(Left, Up, UpLeft)); break;
+                default: return false;
+            }
+        }
+
+        memcpy(Previous.data(), pRow, RowLength);
+
+        unsigned char* pPixel = &_rImage.m_Pixels[static_cast<size_t>(Y) * Width * 4];
+
+        for (int X = 0; X < Width; ++ X, pPixel += 4)
+        {
+            const unsigned char* pSource = pRow + X * NumberOfChannels;
+
+            // Gray and gray alpha have one color channel
+            pPixel[0] = pSource[0];
+            pPixel[1] = pSource[NumberOfChannels >= 3 ? 1 : 0];
+            pPixel[2] = pSource[NumberOfChannels >= 3 ? 2 : 0];
+
+            if (ColorType == 4 || ColorType == 6) pPixel[3] = pSource[NumberOfChannels - 1];
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// A DDS file is the magic number, a header of 124 bytes with the pixel format
+// at offset 72, and the mip levels from the largest to the smallest.
+// -----------------------------------------------------------------------------
+bool ReadDds(const char* _pPath, STextureImage& _rImage)
+{
+    std::vector<unsigned char> File;
+
+    if (ReadFile(_pPath, File) == false || File.size() < 128 || memcmp(File.data(), "DDS ", 4) != 0) return false;
+
+    const unsigned char* pHeader = &File[4];
+
+    int          Height       = static_cast<int>(GetLittleEndian(pHeader + 8));
+    int          Width        = static_cast<int>(GetLittleEndian(pHeader + 12));
+    unsigned int FormatFlags  = GetLittleEndian(pHeader + 76);
+    unsigned int BitCount     = GetLittleEndian(pHeader + 84);
+    unsigned int RedMask      = GetLittleEndian(pHeader + 88);
+    unsigned int GreenMask    = GetLittleEndian(pHeader + 92);
+    unsigned int BlueMask     = GetLittleEndian(pHeader + 96);
+    unsigned int AlphaMask    = GetLittleEndian(pHeader + 100);
+
+    // Uncompressed RGB with 32 bits, the alpha mask only counts with the alpha flag
+    if ((FormatFlags & 0x40) == 0 || BitCount != 32 || Width <= 0 || Height <= 0) return false;
+
+    if ((FormatFlags & 0x01) == 0) AlphaMask = 0;
+
+    if (File.size() < 128 + static_cast<size_t>(Width) * Height * 4) return false;
+
+    _rImage.m_Width  = Width;
+    _rImage.m_Height = Height;
+    _rImage.m_Pixels.resize(static_cast<size_t>(Width) * Height * 4);
+
+    for (size_t Index = 0; Index < static_cast<size_t>(Width) * Height; ++ Index)
+    {
+        unsigned int Texel = GetLittleEndian(&File[128 + Index * 4]);
+
+        _rImage.m_Pixels[Index * 4 + 0] = GetChannel(Texel, RedMask  , 0);
+        _rImage.m_Pixels[Index * 4 + 1] = GetChannel(Texel, GreenMask, 0);
+        _rImage.m_Pixels[Index * 4 + 2] = GetChannel(Texel, BlueMask , 0);
+        _rImage.m_Pixels[Index * 4 + 3] = GetChannel(Texel, AlphaMask, 255);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool WriteDds(const char* _pPath, const STextureImage& _rImage, int _NumberOfMipLevels)
+{
+    int NumberOfMipLevels = 1;
+
+    while ((_NumberOfMipLevels <= 0 || NumberOfMipLevels < _NumberOfMipLevels) && ((_rImage.m_Width >> NumberOfMipLevels) > 0 || (_rImage.m_Height >> NumberOfMipLevels) > 0)) ++ NumberOfMipLevels;
+
+    // -----------------------------------------------------------------------------
+    // The header of an A8R8G8B8 texture, which is stored as B, G, R, A bytes.
+    // -----------------------------------------------------------------------------
+    unsigned char Header[128] = {};
+
+    memcpy(Header, "DDS ", 4);
+
+    SetLittleEndian(Header +   4, 124);
+    SetLittleEndian(Header +   8, 0x1 | 0x2 | 0x4 | 0x8 | 0x1000 | (NumberOfMipLevels > 1 ? 0x20000 : 0));
+    SetLittleEndian(Header +  12, static_cast<unsigned int>(_rImage.m_Height));
+    SetLittleEndian(Header +  16, static_cast<unsigned int>(_rImage.m_Width));
+    SetLittleEndian(Header +  20, static_cast<unsigned int>(_rImage.m_Width) * 4);
+    SetLittleEndian(Header +  28, static_cast<unsigned int>(NumberOfMipLevels));
+    SetLittleEndian(Header +  76, 32);
+    SetLittleEndian(Header +  80, 0x41);
+    SetLittleEndian(Header +  88, 32);
+    SetLittleEndian(Header +  92, 0x00FF0000);
+    SetLittleEndian(Header +  96, 0x0000FF00);
+    SetLittleEndian(Header + 100, 0x000000FF);
+    SetLittleEndian(Header + 104, 0xFF000000);
+    SetLittleEndian(Header + 108, 0x1000 | (NumberOfMipLevels > 1 ? 0x400008 : 0));
+
+    FILE* pFile = fopen(_pPath, "wb");
+
+    if (pFile == nullptr) return false;
+
+    bool IsWritten = fwrite(Header, 1, sizeof(Header), pFile) == sizeof(Header);
+
+    STextureImage Level = _rImage;
+
+    for (int IndexOfLevel = 0; IndexOfLevel < NumberOfMipLevels && IsWritten; ++ IndexOfLevel)
+    {
+        std::vector<unsigned char> Texels(Level.m_Pixels.size());
+
+        for (size_t Index = 0; Index < Texels.size(); Index += 4)
+        {
+            Texels[Index + 0] = Level.m_Pixels[Index + 2];
+            Texels[Index + 1] = Level.m_Pixels[Index + 1];
+            Texels[Index + 2] = Level.m_Pixels[Index + 0];
+            Texels[Index + 3] = Level.m_Pixels[Index + 3];
+        }
+
+        IsWritten = fwrite(Texels.data(), 1, Texels.size(), pFile) == Texels.size();
+
+        // The next level, odd edges repeat their last texel
+        STextureImage Next;
+
+        Next.m_Width  = std::max(Level.m_Width  / 2, 1);
+        Next.m_Height = std::max(Level.m_Height / 2, 1);
+        Next.m_Pixels.resize(static_cast<size_t>(Next.m_Width) * Next.m_Height * 4);
+
+        for (int Y = 0; Y < Next.m_Height; ++ Y)
+        {
+            for (int X = 0; X < Next.m_Width; ++ X)
+            {
+                int X0 = std::min(X * 2, Level.m_Width  - 1);
+                int X1 = std::min(X * 2 + 1, Level.m_Width  - 1);
+                int Y0 = std::min(Y * 2, Level.m_Height - 1);
+                int Y1 = std::min(Y * 2 + 1, Level.m_Height - 1);
+
+                for (int Channel = 0; Channel < 4; ++ Channel)
+                {
+                    int Sum = Level.m_Pixels[(static_cast<size_t>(Y0) * Level.m_Width + X0) * 4 + Channel]
+                            + Level.m_Pixels[(static_cast<size_t>(Y0) * Level.m_Width + X1) * 4 + Channel]
+                            + Level.m_Pixels[(static_cast<size_t>(Y1) * Level.m_Width + X0) * 4 + Channel]
+                            + Level.m_Pixels[(static_cast<size_t>(Y1) * Level.m_Width + X1) * 4 + Channel];
+
+                    Next.m_Pixels[(static_cast<size_t>(Y) * Next.m_Width + X) * 4 + Channel] = static_cast<unsigned char>((Sum + 2) / 4);
+                }
+            }
+        }
+
+        Level = std::move(Next);
+    }
+
+    fclose(pFile);
+
+    return IsWritten;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ReadTexture(const char* _pPath, STextureImage& _rImage)
+{
+    size_t Length = strlen(_pPath);
+
+    if (Length >= 4 && (strcmp(_pPath + Length - 4, ".dds") == 0 || strcmp(_pPath + Length - 4, ".DDS") == 0)) return ReadDds(_pPath, _rImage);
+
+    return ReadPng(_pPath, _rImage);
+}
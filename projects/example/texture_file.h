@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// An image with 8 bit RGBA texels, row by row from the top.
+// -----------------------------------------------------------------------------
+struct STextureImage
+{
+    int                        m_Width;
+    int                        m_Height;
+    std::vector<unsigned char> m_Pixels;                                // Four bytes per texel in the order R, G, B, A.
+};
+
+// -----------------------------------------------------------------------------
+// Reads a non-interlaced PNG file with 8 bits per channel. Gray images are
+// expanded to RGB, images without alpha channel are opaque. Returns false for
+// other formats, e.g. palette images.
+// -----------------------------------------------------------------------------
+bool ReadPng(const char* _pPath, STextureImage& _rImage);
+
+// -----------------------------------------------------------------------------
+// Reads the first mip level of an uncompressed DDS file with 32 bits per texel
+// like the wall maps. Block compressed files return false.
+// -----------------------------------------------------------------------------
+bool ReadDds(const char* _pPath, STextureImage& _rImage);
+
+// -----------------------------------------------------------------------------
+// Writes an uncompressed DDS file with the given number of mip levels, each
+// one the 2x2 box filtered version of the one above. 0 writes the full chain.
+// -----------------------------------------------------------------------------
+bool WriteDds(const char* _pPath, const STextureImage& _rImage, int _NumberOfMipLevels);
+
+// -----------------------------------------------------------------------------
+// Reads a PNG or DDS file by its extension.
+// -----------------------------------------------------------------------------
+bool ReadTexture(const char* _pPath, STextureImage& _rImage);
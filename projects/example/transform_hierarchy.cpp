@@ -0,0 +1,518 @@
+
+#include "transform_hierarchy.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <math.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // The local matrix from scale, rotation, and translation for row vectors.
+    // -----------------------------------------------------------------------------
+    void GetLocalMatrix(const STransform& _rTransform, float* _pMatrix)
+    {
+        const float* pQ = _rTransform.m_Rotation;
+        const float* pS = _rTransform.m_Scale;
+        const float* pT = _rTransform.m_Translation;
+
+        float XX = pQ[0] * pQ[0]; float YY = pQ[1] * pQ[1]; float ZZ = pQ[2] * pQ[2];
+        float XY = pQ[0] * pQ[1]; float XZ = pQ[0] * pQ[2]; float YZ = pQ[1] * pQ[2];
+        float WX = pQ[3] * pQ[0]; float WY = pQ[3] * pQ[1]; float WZ = pQ[3] * pQ[2];
+
+        _pMatrix[ 0] = (1.0f - 2.0f * (YY + ZZ)) * pS[0];
+        _pMatrix[ 1] = (       2.0f * (XY + WZ)) * pS[0];
+        _pMatrix[ 2] = (       2.0f * (XZ - WY)) * pS[0];
+        _pMatrix[ 3] = 0.0f;
+
+        _pMatrix[ 4] = (       2.0f * (XY - WZ)) * pS[1];
+        _pMatrix[ 5] = (1.0f - 2.0f * (XX + ZZ)) * pS[1];
+        _pMatrix[ 6] = (       2.0f * (YZ + WX)) * pS[1];
+        _pMatrix[ 7] = 0.0f;
+
+        _pMatrix[ 8] = (       2.0f * (XZ + WY)) * pS[2];
+        _pMatrix[ 9] = (       2.0f * (YZ - WX)) * pS[2];
+        _pMatrix[10] = (1.0f - 2.0f * (XX + YY)) * pS[2];
+        _pMatrix[11] = 0.0f;
+
+        _pMatrix[12] = pT[0];
+        _pMatrix[13] = pT[1];
+        _pMatrix[14] = pT[2];
+        _pMatrix[15] = 1.0f;
+    }
+} // namespace
+
+float* MulMatrixSimd(const float* _pLeftMatrix, const float* _pRightMatrix, float* _pResultMatrix)
+{
+#if defined(TRANSFORM_SSE)
+    // -----------------------------------------------------------------------------
+    // Each row of the result is the left row weighting the four right rows.
+    // -----------------------------------------------------------------------------
+    __m128 Row0 = _mm_loadu_ps(_pRightMatrix +  0);
+    __m128 Row1 = _mm_loadu_ps(_pRightMatrix +  4);
+    __m128 Row2 = _mm_loadu_ps(_pRightMatrix +  8);
+    __m128 Row3 = _mm_loadu_ps(_pRightMatrix + 12);
+
+    for (int Row = 0; Row < 4; ++ Row)
+    {
+        const float* pLeft = _pLeftMatrix + Row * 4;
+
+        __m128 Result = _mm_mul_ps(_mm_set1_ps(pLeft[0]), Row0);
+
+        Result = _mm_add_ps(Result, _mm_mul_ps(_mm_set1_ps(pLeft[1]), Row1));
+        Result = _mm_add_ps(Result, _mm_mul_ps(_mm_set1_ps(pLeft[2]), Row2));
+        Result = _mm_add_ps(Result, _mm_mul_ps(_mm_set1_ps(pLeft[3]), Row3));
+
+        _mm_storeu_ps(_pResultMatrix + Row * 4, Result);
+    }
+#else
+    for (int Row = 0; Row < 4; ++ Row)
+    {
+        for (int Column = 0; Column < 4; ++ Column)
+        {
+            _pResultMatrix[Row * 4 + Column] = _pLeftMatrix[Row * 4 + 0] * _pRightMatrix[ 0 + Column]
+                                             + _pLeftMatrix[Row * 4 + 1] * _pRightMatrix[ 4 + Column]
+                                             + _pLeftMatrix[Row * 4 + 2] * _pRightMatrix[ 8 + Column]
+                                             + _pLeftMatrix[Row * 4 + 3] * _pRightMatrix[12 + Column];
+        }
+    }
+#endif
+
+    return _pResultMatrix;
+}
+
+// -----------------------------------------------------------------------------
+
+float* GetRotationQuaternion(const float* _pAxis, float _Degrees, float* _pResultQuaternion)
+{
+    float HalfAngle = _Degrees * 3.14159265358979f / 360.0f;
+    float Sine      = sinf(HalfAngle);
+
+    _pResultQuaternion[0] = _pAxis[0] * Sine;
+    _pResultQuaternion[1] = _pAxis[1] * Sine;
+    _pResultQuaternion[2] = _pAxis[2] * Sine;
+    _pResultQuaternion[3] = cosf(HalfAngle);
+
+    return _pResultQuaternion;
+}
+
+// -----------------------------------------------------------------------------
+
+CTransformHierarchy::CTransformHierarchy()
+    : m_NumberOfThreads(0)
+    , m_pJobSystem     (nullptr)
+    , m_IsOrderValid   (true)
+{
+    m_Statistics.m_NumberOfNodes        = 0;
+    m_Statistics.m_NumberOfUpdatedNodes = 0;
+    m_Statistics.m_NumberOfTasks        = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+CTransformHierarchy::~CTransformHierarchy()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::SetNumberOfThreads(int _NumberOfThreads)
+{
+    // -----------------------------------------------------------------------------
+    // The task split depends on the number of threads.
+    // -----------------------------------------------------------------------------
+    m_NumberOfThreads = _NumberOfThreads;
+    m_IsOrderValid    = false;
+}
+
+// -----------------------------------------------------------------------------
+
+int CTransformHierarchy::GetNumberOfThreads() const
+{
+    if (m_NumberOfThreads > 0) return m_NumberOfThreads;
+
+    return m_pJobSystem != nullptr ? m_pJobSystem->GetNumberOfThreads() : GetJobSystem().GetNumberOfThreads();
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::SetJobSystem(CJobSystem* _pJobSystem)
+{
+    // -----------------------------------------------------------------------------
+    // The task split depends on the number of threads.
+    // -----------------------------------------------------------------------------
+    m_pJobSystem   = _pJobSystem;
+    m_IsOrderValid = false;
+}
+
+// -----------------------------------------------------------------------------
+
+int CTransformHierarchy::AddNode(int _IndexOfParent, const STransform& _rLocalTransform)
+{
+    assert(_IndexOfParent < GetNumberOfNodes());
+
+    int IndexOfNode = GetNumberOfNodes();
+
+    m_LocalTransforms.push_back(_rLocalTransform);
+    m_Parents        .push_back(_IndexOfParent);
+    m_Flags          .push_back(0);
+    m_IsChanged      .push_back(0);
+    m_SubtreeSizes   .push_back(1);
+    m_WorldMatrices  .resize(m_WorldMatrices.size() + 16);
+
+    MarkDirty(IndexOfNode);
+
+    m_IsOrderValid = false;
+
+    return IndexOfNode;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::Clear()
+{
+    m_LocalTransforms.clear();
+    m_Parents        .clear();
+    m_WorldMatrices  .clear();
+    m_Flags          .clear();
+    m_IsChanged      .clear();
+    m_Order          .clear();
+    m_SubtreeSizes   .clear();
+    m_SerialPositions.clear();
+    m_Tasks          .clear();
+
+    m_IsOrderValid = true;
+}
+
+// -----------------------------------------------------------------------------
+
+int CTransformHierarchy::GetNumberOfNodes() const
+{
+    return static_cast<int>(m_Parents.size());
+}
+
+// -----------------------------------------------------------------------------
+
+int CTransformHierarchy::GetParent(int _IndexOfNode) const
+{
+    return m_Parents[_IndexOfNode];
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::SetLocalTransform(int _IndexOfNode, const STransform& _rLocalTransform)
+{
+    m_LocalTransforms[_IndexOfNode] = _rLocalTransform;
+
+    MarkDirty(_IndexOfNode);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::SetLocalTranslation(int _IndexOfNode, const float* _pTranslation)
+{
+    std::copy(_pTranslation, _pTranslation + 3, m_LocalTransforms[_IndexOfNode].m_Translation);
+
+    MarkDirty(_IndexOfNode);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::SetLocalRotation(int _IndexOfNode, const float* _pQuaternion)
+{
+    std::copy(_pQuaternion, _pQuaternion + 4, m_LocalTransforms[_IndexOfNode].m_Rotation);
+
+    MarkDirty(_IndexOfNode);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::SetLocalScale(int _IndexOfNode, const float* _pScale)
+{
+    std::copy(_pScale, _pScale + 3, m_LocalTransforms[_IndexOfNode].m_Scale);
+
+    MarkDirty(_IndexOfNode);
+}
+
+// -----------------------------------------------------------------------------
+
+const STransform& CTransformHierarchy::GetLocalTransform(int _IndexOfNode) const
+{
+    return m_LocalTransforms[_IndexOfNode];
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::Update()
+{
+    if (m_IsOrderValid == false) BuildOrder();
+
+    int UpdatedNodes = 0;
+
+    // -----------------------------------------------------------------------------
+    // The nodes above the tasks first, they are parents of the task roots.
+    // -----------------------------------------------------------------------------
+    for (int Position : m_SerialPositions)
+    {
+        if (UpdateNode(m_Order[Position])) ++ UpdatedNodes;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Each task is a job of the shared job system, idle threads steal the tasks
+    // of busy ones, so uneven subtrees are balanced.
+    // -----------------------------------------------------------------------------
+    int NumberOfTasks = static_cast<int>(m_Tasks.size());
+
+    if (GetNumberOfThreads() <= 1 || NumberOfTasks <= 1)
+    {
+        for (const STask& rTask : m_Tasks) UpdatedNodes += UpdateRange(rTask.m_First, rTask.m_Last);
+    }
+    else
+    {
+        std::atomic<int> TaskUpdatedNodes(0);
+
+        CJobSystem& rJobSystem = m_pJobSystem != nullptr ? *m_pJobSystem : GetJobSystem();
+
+        rJobSystem.ParallelFor(NumberOfTasks, 1, [&](int _IndexOfTask)
+        {
+            TaskUpdatedNodes.fetch_add(UpdateRange(m_Tasks[_IndexOfTask].m_First, m_Tasks[_IndexOfTask].m_Last), std::memory_order_relaxed);
+        });
+
+        UpdatedNodes += TaskUpdatedNodes.load();
+    }
+
+    m_Statistics.m_NumberOfNodes        = GetNumberOfNodes();
+    m_Statistics.m_NumberOfUpdatedNodes = UpdatedNodes;
+    m_Statistics.m_NumberOfTasks        = NumberOfTasks;
+}
+
+// -----------------------------------------------------------------------------
+
+const float* CTransformHierarchy::GetWorldMatrix(int _IndexOfNode) const
+{
+    return &m_WorldMatrices[static_cast<size_t>(_IndexOfNode) * 16];
+}
+
+// -----------------------------------------------------------------------------
+
+const STransformStatistics& CTransformHierarchy::GetStatistics() const
+{
+    return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::MarkDirty(int _IndexOfNode)
+{
+    m_Flags[_IndexOfNode] |= IsDirty;
+
+    // -----------------------------------------------------------------------------
+    // Stop at the first ancestor which already knows about a dirty descendant.
+    // -----------------------------------------------------------------------------
+    for (int Parent = m_Parents[_IndexOfNode]; Parent >= 0 && (m_Flags[Parent] & HasDirtyDescendant) == 0; Parent = m_Parents[Parent])
+    {
+        m_Flags[Parent] |= HasDirtyDescendant;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::BuildOrder()
+{
+    int NumberOfNodes = GetNumberOfNodes();
+
+    // -----------------------------------------------------------------------------
+    // Children lists as one array sorted by parent (counting sort), the roots
+    // are the children of the virtual node at index 'NumberOfNodes'.
+    // -----------------------------------------------------------------------------
+    std::vector<int> FirstChild(NumberOfNodes + 2, 0);
+    std::vector<int> Children(NumberOfNodes);
+
+    for (int Node = 0; Node < NumberOfNodes; ++ Node)
+    {
+        int Parent = m_Parents[Node] >= 0 ? m_Parents[Node] : NumberOfNodes;
+
+        ++ FirstChild[Parent + 1];
+    }
+
+    for (int Node = 0; Node <= NumberOfNodes; ++ Node) FirstChild[Node + 1] += FirstChild[Node];
+
+    std::vector<int> Fill(FirstChild.begin(), FirstChild.end() - 1);
+
+    for (int Node = 0; Node < NumberOfNodes; ++ Node)
+    {
+        int Parent = m_Parents[Node] >= 0 ? m_Parents[Node] : NumberOfNodes;
+
+        Children[Fill[Parent] ++] = Node;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Depth first order with an explicit stack. Children are pushed in reverse,
+    // so they keep their order of creation.
+    // -----------------------------------------------------------------------------
+    std::vector<int> Stack;
+
+    m_Order.clear();
+    m_Order.reserve(NumberOfNodes);
+
+    for (int IndexOfChild = FirstChild[NumberOfNodes + 1] - 1; IndexOfChild >= FirstChild[NumberOfNodes]; -- IndexOfChild)
+    {
+        Stack.push_back(Children[IndexOfChild]);
+    }
+
+    while (Stack.empty() == false)
+    {
+        int Node = Stack.back();
+
+        Stack.pop_back();
+
+        m_Order.push_back(Node);
+
+        for (int IndexOfChild = FirstChild[Node + 1] - 1; IndexOfChild >= FirstChild[Node]; -- IndexOfChild)
+        {
+            Stack.push_back(Children[IndexOfChild]);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Children come after their parents, so summing backwards gives the sizes.
+    // -----------------------------------------------------------------------------
+    std::fill(m_SubtreeSizes.begin(), m_SubtreeSizes.end(), 1);
+
+    for (int Position = NumberOfNodes - 1; Position >= 0; -- Position)
+    {
+        int Node = m_Order[Position];
+
+        if (m_Parents[Node] >= 0) m_SubtreeSizes[m_Parents[Node]] += m_SubtreeSizes[Node];
+    }
+
+    // -----------------------------------------------------------------------------
+    // A few tasks per thread balance subtrees of different size.
+    // -----------------------------------------------------------------------------
+    int MaximumTaskSize = std::max(NumberOfNodes / (GetNumberOfThreads() * 4), 256);
+
+    m_SerialPositions.clear();
+    m_Tasks          .clear();
+
+    for (int Position = 0; Position < NumberOfNodes; Position += m_SubtreeSizes[m_Order[Position]])
+    {
+        SplitTasks(Position, MaximumTaskSize);
+    }
+
+    m_IsOrderValid = true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTransformHierarchy::SplitTasks(int _Position, int _MaximumTaskSize)
+{
+    // -----------------------------------------------------------------------------
+    // Depth first with an explicit stack like 'BuildOrder', a chain of nodes
+    // would need a stack frame per level otherwise. The children of a position
+    // are pushed in reverse, so the serial positions and the tasks keep the
+    // order of 'm_Order'.
+    // -----------------------------------------------------------------------------
+    std::vector<int> Stack(1, _Position);
+
+    while (Stack.empty() == false)
+    {
+        int Position = Stack.back();
+        int Size     = m_SubtreeSizes[m_Order[Position]];
+
+        Stack.pop_back();
+
+        if (Size <= _MaximumTaskSize)
+        {
+            STask Task = { Position, Position + Size };
+
+            m_Tasks.push_back(Task);
+
+            continue;
+        }
+
+        // -----------------------------------------------------------------------------
+        // The root of a large subtree is updated serially, its children become tasks.
+        // -----------------------------------------------------------------------------
+        m_SerialPositions.push_back(Position);
+
+        size_t FirstChild = Stack.size();
+
+        for (int PositionOfChild = Position + 1; PositionOfChild < Position + Size; PositionOfChild += m_SubtreeSizes[m_Order[PositionOfChild]])
+        {
+            Stack.push_back(PositionOfChild);
+        }
+
+        std::reverse(Stack.begin() + FirstChild, Stack.end());
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTransformHierarchy::UpdateNode(int _IndexOfNode)
+{
+    int  Parent    = m_Parents[_IndexOfNode];
+    bool IsChanged = (m_Flags[_IndexOfNode] & IsDirty) != 0 || (Parent >= 0 && m_IsChanged[Parent] != 0);
+
+    m_IsChanged[_IndexOfNode] = IsChanged ? 1 : 0;
+    m_Flags    [_IndexOfNode] = 0;
+
+    if (IsChanged == false) return false;
+
+    float* pWorldMatrix = &m_WorldMatrices[static_cast<size_t>(_IndexOfNode) * 16];
+
+    if (Parent < 0)
+    {
+        GetLocalMatrix(m_LocalTransforms[_IndexOfNode], pWorldMatrix);
+    }
+    else
+    {
+        float LocalMatrix[16];
+
+        GetLocalMatrix(m_LocalTransforms[_IndexOfNode], LocalMatrix);
+
+        MulMatrixSimd(LocalMatrix, &m_WorldMatrices[static_cast<size_t>(Parent) * 16], pWorldMatrix);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+int CTransformHierarchy::UpdateRange(int _First, int _Last)
+{
+    int UpdatedNodes = 0;
+
+    for (int Position = _First; Position < _Last; )
+    {
+        int Node   = m_Order[Position];
+        int Parent = m_Parents[Node];
+
+        // -----------------------------------------------------------------------------
+        // Nothing changed in or above this subtree, so it can be skipped. The
+        // stale change flags inside are never read, because only the children of
+        // a visited node read its flag.
+        // -----------------------------------------------------------------------------
+        if (m_Flags[Node] == 0 && (Parent < 0 || m_IsChanged[Parent] == 0))
+        {
+            m_IsChanged[Node] = 0;
+
+            Position += m_SubtreeSizes[Node];
+
+            continue;
+        }
+
+        if (UpdateNode(Node)) ++ UpdatedNodes;
+
+        ++ Position;
+    }
+
+    return UpdatedNodes;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+
+class CJobSystem;
+
+// -----------------------------------------------------------------------------
+// Multiplies two 4x4 matrices like 'gfx::MulMatrix', with SSE where available.
+// The result must not overlap the inputs.
+// -----------------------------------------------------------------------------
+float* MulMatrixSimd(const float* _pLeftMatrix, const float* _pRightMatrix, float* _pResultMatrix);
+
+// -----------------------------------------------------------------------------
+// Rotation around the normalized axis as quaternion (x, y, z, w). The angle is
+// given in degrees like 'gfx::GetRotationYMatrix' and the resulting matrices
+// are the same.
+// -----------------------------------------------------------------------------
+float* GetRotationQuaternion(const float* _pAxis, float _Degrees, float* _pResultQuaternion);
+
+// -----------------------------------------------------------------------------
+// Local translation, rotation, and scale of a node. The local matrix is scale,
+// then rotation, then translation, the world matrix is local times the world
+// matrix of the parent.
+// -----------------------------------------------------------------------------
+struct STransform
+{
+    float m_Translation[3];
+    float m_Rotation[4];                                                // Quaternion (x, y, z, w).
+    float m_Scale[3];
+};
+
+// -----------------------------------------------------------------------------
+
+struct STransformStatistics
+{
+    int m_NumberOfNodes;
+    int m_NumberOfUpdatedNodes;                                         // Nodes whose world matrix was calculated by the last update.
+    int m_NumberOfTasks;                                                // Independent subtrees the last update was split into.
+};
+
+// -----------------------------------------------------------------------------
+// Parent child hierarchy of transformations. The nodes are kept in depth first
+// order, so every parent comes before its children and each subtree is one
+// contiguous range. 'Update' walks this order once: a node is calculated if it
+// was changed or its parent was, and subtrees without changes are skipped as a
+// whole. Subtrees which do not depend on each other are updated in parallel.
+// -----------------------------------------------------------------------------
+class CTransformHierarchy
+{
+    public:
+
+        CTransformHierarchy();
+        ~CTransformHierarchy();
+
+    public:
+
+        void SetNumberOfThreads(int _NumberOfThreads);                  // 0 uses all threads of the job system.
+        int  GetNumberOfThreads() const;
+
+        void SetJobSystem(CJobSystem* _pJobSystem);                     // nullptr uses the shared job system.
+
+    public:
+
+        // -----------------------------------------------------------------------------
+        // Adds a node below the parent, or a root for -1. The index of the new node
+        // is returned and stays valid until 'Clear' is called.
+        // -----------------------------------------------------------------------------
+        int  AddNode(int _IndexOfParent, const STransform& _rLocalTransform);
+        void Clear();
+
+        int  GetNumberOfNodes() const;
+        int  GetParent(int _IndexOfNode) const;
+
+        void SetLocalTransform(int _IndexOfNode, const STransform& _rLocalTransform);
+        void SetLocalTranslation(int _IndexOfNode, const float* _pTranslation);
+        void SetLocalRotation(int _IndexOfNode, const float* _pQuaternion);
+        void SetLocalScale(int _IndexOfNode, const float* _pScale);
+
+        const STransform& GetLocalTransform(int _IndexOfNode) const;
+
+    public:
+
+        void Update();
+
+        const float* GetWorldMatrix(int _IndexOfNode) const;           // Valid after the next 'Update'.
+
+        const STransformStatistics& GetStatistics() const;
+
+    private:
+
+        enum EFlag
+        {
+            IsDirty              = 1,                                   // The local transformation was changed.
+            HasDirtyDescendant   = 2,                                   // A node of the subtree below was changed.
+        };
+
+        struct STask
+        {
+            int m_First;                                                // Range in 'm_Order'.
+            int m_Last;
+        };
+
+    private:
+
+        void MarkDirty(int _IndexOfNode);
+        void BuildOrder();
+        void SplitTasks(int _Position, int _MaximumTaskSize);
+        bool UpdateNode(int _IndexOfNode);
+        int  UpdateRange(int _First, int _Last);
+
+    private:
+
+        int                     m_NumberOfThreads;
+        CJobSystem*             m_pJobSystem;
+        bool                    m_IsOrderValid;                         // False after nodes were added.
+
+        std::vector<STransform> m_LocalTransforms;                      // Indexed by node.
+        std::vector<int>        m_Parents;
+        std::vector<float>      m_WorldMatrices;                        // 16 floats per node.
+        std::vector<char>       m_Flags;
+        std::vector<char>       m_IsChanged;                            // True if the world matrix was changed by the running update.
+
+        std::vector<int>        m_Order;                                // Nodes in depth first order.
+        std::vector<int>        m_SubtreeSizes;                         // Indexed by node, including the node itself.
+        std::vector<int>        m_SerialPositions;                      // Positions in 'm_Order' above the tasks, updated first.
+        std::vector<STask>      m_Tasks;
+
+        STransformStatistics    m_Statistics;
+};
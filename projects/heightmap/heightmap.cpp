@@ -0,0 +1,112 @@
+
+#include "terrain.h"
+#include "texture_file.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Writes a terrain file for 'CTerrain':
+//
+//     heightmap <file> <tiles> <spacing> <height> [<png>]
+//
+// The terrain has <tiles> x <tiles> tiles of 257 x 257 samples, <spacing>
+// units between two samples, and heights from 0 to <height> units. The heights
+// are taken from the red channel of the PNG file, which is stretched over the
+// whole terrain, or generated from noise if there is none.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const int s_TileSize = 257;
+} // namespace
+
+int main(int _NumberOfArguments, char** _ppArguments)
+{
+    if (_NumberOfArguments != 5 && _NumberOfArguments != 6)
+    {
+        std::cout << "usage: heightmap <file> <tiles> <spacing> <height> [<png>]" << std::endl;
+
+        return 1;
+    }
+
+    int   NumberOfTiles = atoi(_ppArguments[2]);
+    float Spacing       = static_cast<float>(atof(_ppArguments[3]));
+    float Height        = static_cast<float>(atof(_ppArguments[4]));
+
+    if (NumberOfTiles <= 0 || Spacing <= 0.0f || Height <= 0.0f)
+    {
+        std::cout << "the tiles, the spacing, and the height have to be larger than 0" << std::endl;
+
+        return 1;
+    }
+
+    int Width = NumberOfTiles * (s_TileSize - 1) + 1;
+
+    std::vector<unsigned short> Samples;
+
+    if (_NumberOfArguments == 6)
+    {
+        STextureImage Image;
+
+        if (ReadPng(_ppArguments[5], Image) == false)
+        {
+            std::cout << _ppArguments[5] << ": not a readable PNG file" << std::endl;
+
+            return 1;
+        }
+
+        // -----------------------------------------------------------------------------
+        // The 8 bit texels are interpolated bilinearly into 16 bit samples, so a
+        // small image gives smooth slopes instead of terraces.
+        // -----------------------------------------------------------------------------
+        Samples.resize(static_cast<size_t>(Width) * Width);
+
+        for (int Z = 0; Z < Width; ++ Z)
+        {
+            for (int X = 0; X < Width; ++ X)
+            {
+                float U = static_cast<float>(X) / (Width - 1) * (Image.m_Width  - 1);
+                float V = static_cast<float>(Z) / (Width - 1) * (Image.m_Height - 1);
+
+                int TexelX = std::min(static_cast<int>(U), std::max(Image.m_Width  - 2, 0));
+                int TexelY = std::min(static_cast<int>(V), std::max(Image.m_Height - 2, 0));
+                int NextX  = std::min(TexelX + 1, Image.m_Width  - 1);
+                int NextY  = std::min(TexelY + 1, Image.m_Height - 1);
+
+                U -= TexelX;
+                V -= TexelY;
+
+                // The top row of the image is the far side of the terrain
+                float A = Image.m_Pixels[(static_cast<size_t>(Image.m_Height - 1 - TexelY) * Image.m_Width + TexelX) * 4];
+                float B = Image.m_Pixels[(static_cast<size_t>(Image.m_Height - 1 - TexelY) * Image.m_Width + NextX ) * 4];
+                float C = Image.m_Pixels[(static_cast<size_t>(Image.m_Height - 1 - NextY ) * Image.m_Width + TexelX) * 4];
+                float D = Image.m_Pixels[(static_cast<size_t>(Image.m_Height - 1 - NextY ) * Image.m_Width + NextX ) * 4];
+
+                float Value = A + (B - A) * U + (C - A) * V + (A - B - C + D) * U * V;
+
+                Samples[static_cast<size_t>(Z) * Width + X] = static_cast<unsigned short>(Value / 255.0f * 65535.0f);
+            }
+        }
+    }
+    else
+    {
+        GenerateTerrainSamples(Width, Width, 4711, Samples);
+    }
+
+    STerrainHeader Header = { 0, 0, s_TileSize, NumberOfTiles, NumberOfTiles, Spacing, Height / 65535.0f, 0.0f };
+
+    if (WriteTerrainFile(_ppArguments[1], Header, Samples.data()) == false)
+    {
+        std::cout << _ppArguments[1] << ": the terrain could not be written" << std::endl;
+
+        return 1;
+    }
+
+    std::cout << _ppArguments[1] << ": " << Width - 1 << " x " << Width - 1 << " quads in " << NumberOfTiles * NumberOfTiles << " tiles, "
+              << (Width - 1) * Spacing << " x " << (Width - 1) * Spacing << " units" << std::endl;
+
+    return 0;
+}
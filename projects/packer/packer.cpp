@@ -0,0 +1,365 @@
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "asset_package.h"
+#include "mesh_importer.h"
+
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Packs loose asset files into one binary package:
+//
+//     packer <package> <file> <file> ...
+//
+// .obj          A mesh named after the file. The first 'usemtl' selects the material.
+// .gltf .glb    A mesh named after the file, all triangle primitives merged. If
+//               the material of the mesh has a TANGENT input, tangents and
+//               binormals are generated.
+// .png .dds     A texture named after the file. The path is stored as given, so
+//               pass it relative to the binaries, e.g. ..\data\images\leaf.dds.
+// .mat          A material named after the file, one statement per line:
+//                   shader <effect file> <vertex shader> <pixel shader>
+//                   texture <texture name>
+//                   input <semantic> <type, e.g. Float3>
+// .inst         Instances, one per line: <mesh name> <x> <y> <z> or
+//               <mesh name> followed by the 16 floats of the world matrix.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    std::string GetExtension(const std::string& _rPath)
+    {
+        size_t Dot = _rPath.find_last_of('.');
+
+        return Dot == std::string::npos ? std::string() : _rPath.substr(Dot + 1);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    std::string GetName(const std::string& _rPath)
+    {
+        size_t Slash = _rPath.find_last_of("/\\");
+        size_t First = Slash == std::string::npos ? 0 : Slash + 1;
+        size_t Dot   = _rPath.find_last_of('.');
+
+        return _rPath.substr(First, Dot == std::string::npos || Dot < First ? std::string::npos : Dot - First);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool ReadFile(const std::string& _rPath, std::vector<char>& _rData)
+    {
+        FILE* pFile = fopen(_rPath.c_str(), "rb");
+
+        if (pFile == nullptr) return false;
+
+        fseek(pFile, 0, SEEK_END);
+
+        long Size = ftell(pFile);
+
+        fseek(pFile, 0, SEEK_SET);
+
+        _rData.resize(static_cast<size_t>(Size));
+
+        size_t NumberOfBytes = Size > 0 ? fread(_rData.data(), 1, _rData.size(), pFile) : 0;
+
+        fclose(pFile);
+
+        return NumberOfBytes == _rData.size();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int FindName(const std::vector<std::string>& _rNames, const std::string& _rName)
+    {
+        for (size_t IndexOfName = 0; IndexOfName < _rNames.size(); ++ IndexOfName)
+        {
+            if (_rNames[IndexOfName] == _rName) return static_cast<int>(IndexOfName);
+        }
+
+        return -1;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int GetInputType(const char* _pName)
+    {
+        const char* pTypes[] = { "SInt1", "SInt2", "SInt3", "SInt4", "UInt1", "UInt2", "UInt3", "UInt4", "Float1", "Float2", "Float3", "Float4" };
+
+        for (int IndexOfType = 0; IndexOfType < 12; ++ IndexOfType)
+        {
+            if (strcmp(pTypes[IndexOfType], _pName) == 0) return IndexOfType;
+        }
+
+        return -1;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool ReadMaterial(const std::string& _rPath, const std::vector<std::string>& _rTextureNames, SPackageMaterial& _rMaterial)
+    {
+        FILE* pFile = fopen(_rPath.c_str(), "r");
+
+        if (pFile == nullptr) return false;
+
+        memset(&_rMaterial, 0, sizeof(_rMaterial));
+
+        strncpy(_rMaterial.m_Name, GetName(_rPath).c_str(), sizeof(_rMaterial.m_Name) - 1);
+
+        char Line[256];
+        bool IsValid = true;
+
+        while (IsValid && fgets(Line, sizeof(Line), pFile) != nullptr)
+        {
+            char Keyword[16] = {};
+            char First  [64] = {};
+            char Second [32] = {};
+            char Third  [32] = {};
+
+            int NumberOfWords = sscanf(Line, "%15s %63s %31s %31s", Keyword, First, Second, Third);
+
+            if (NumberOfWords <= 0) continue;
+
+            if (strcmp(Keyword, "shader") == 0 && NumberOfWords == 4)
+            {
+                strncpy(_rMaterial.m_ShaderPath  , First , sizeof(_rMaterial.m_ShaderPath)   - 1);
+                strncpy(_rMaterial.m_VertexShader, Second, sizeof(_rMaterial.m_VertexShader) - 1);
+                strncpy(_rMaterial.m_PixelShader , Third , sizeof(_rMaterial.m_PixelShader)  - 1);
+            }
+            else if (strcmp(Keyword, "texture") == 0 && NumberOfWords == 2 && _rMaterial.m_NumberOfTextures < SPackageMaterial::s_MaxNumberOfTextures)
+            {
+                int IndexOfTexture = FindName(_rTextureNames, First);
+
+                if (IndexOfTexture < 0) std::cout << _rPath << ": unknown texture " << First << std::endl;
+
+                _rMaterial.m_IndicesOfTextures[_rMaterial.m_NumberOfTextures ++] = IndexOfTexture;
+
+                IsValid = IndexOfTexture >= 0;
+            }
+            else if (strcmp(Keyword, "input") == 0 && NumberOfWords == 3 && _rMaterial.m_NumberOfInputElements < SPackageMaterial::s_MaxNumberOfInputElements)
+            {
+                SPackageInputElement& rElement = _rMaterial.m_InputElements[_rMaterial.m_NumberOfInputElements ++];
+
+                strncpy(rElement.m_Name, First, sizeof(rElement.m_Name) - 1);
+
+                rElement.m_Type = GetInputType(Second);
+
+                IsValid = rElement.m_Type >= 0;
+            }
+            else
+            {
+                IsValid = false;
+            }
+        }
+
+        fclose(pFile);
+
+        return IsValid;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool ReadInstances(const std::string& _rPath, const std::vector<std::string>& _rMeshNames, CAssetPackageWriter& _rWriter)
+    {
+        FILE* pFile = fopen(_rPath.c_str(), "r");
+
+        if (pFile == nullptr) return false;
+
+        char Line[1024];
+        bool IsValid = true;
+
+        while (IsValid && fgets(Line, sizeof(Line), pFile) != nullptr)
+        {
+            char  Name[32] = {};
+            float Values[16];
+            int   Length   = 0;
+
+            if (sscanf(Line, "%31s%n", Name, &Length) != 1) continue;
+
+            int NumberOfValues = 0;
+
+            for (const char* pValue = Line + Length; NumberOfValues < 16; ++ NumberOfValues)
+            {
+                char* pEnd;
+
+                Values[NumberOfValues] = strtof(pValue, &pEnd);
+
+                if (pEnd == pValue) break;
+
+                pValue = pEnd;
+            }
+
+            int IndexOfMesh = FindName(_rMeshNames, Name);
+
+            if (IndexOfMesh < 0 || (NumberOfValues != 3 && NumberOfValues != 16))
+            {
+                IsValid = false;
+
+                break;
+            }
+
+            if (NumberOfValues == 3)
+            {
+                float Translation[16] =
+                {
+                    1.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f, 1.0f, 0.0f, 0.0f,
+                    0.0f, 0.0f, 1.0f, 0.0f,
+                    Values[0], Values[1], Values[2], 1.0f,
+                };
+
+                _rWriter.AddInstance(IndexOfMesh, Translation);
+            }
+            else
+            {
+                _rWriter.AddInstance(IndexOfMesh, Values);
+            }
+        }
+
+        fclose(pFile);
+
+        return IsValid;
+    }
+} // namespace
+
+int main(int _NumberOfArguments, char** _ppArguments)
+{
+    if (_NumberOfArguments < 3)
+    {
+        std::cout << "usage: packer <package> <file> <file> ..." << std::endl;
+
+        return 1;
+    }
+
+    std::vector<std::string> Paths(_ppArguments + 2, _ppArguments + _NumberOfArguments);
+
+    std::vector<std::string> TextureNames;
+    std::vector<std::string> MaterialNames;
+    std::vector<std::string> MeshNames;
+    std::vector<bool>        MaterialNeedsTangents;
+
+    CAssetPackageWriter Writer;
+
+    for (const std::string& rPath : Paths)
+    {
+        std::string Extension = GetExtension(rPath);
+
+        if (Extension != "obj" && Extension != "gltf" && Extension != "glb" && Extension != "png" && Extension != "dds" && Extension != "mat" && Extension != "inst")
+        {
+            std::cout << rPath << ": unsupported file type, skipped" << std::endl;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Textures are packed first, because materials refer to them by name. Then
+    // materials, which meshes refer to, then meshes and at last the instances.
+    // -----------------------------------------------------------------------------
+    for (const std::string& rPath : Paths)
+    {
+        std::string Extension = GetExtension(rPath);
+
+        if (Extension != "png" && Extension != "dds") continue;
+
+        std::vector<char> Data;
+
+        if (ReadFile(rPath, Data) == false)
+        {
+            std::cout << rPath << ": cannot read the file" << std::endl;
+
+            return 1;
+        }
+
+        SPackageTextureFormat::EFormat Format = Extension == "png" ? SPackageTextureFormat::PNG : SPackageTextureFormat::DDS;
+
+        Writer.AddTexture(GetName(rPath).c_str(), rPath.c_str(), Format, Data.data(), static_cast<int>(Data.size()));
+
+        TextureNames.push_back(GetName(rPath));
+    }
+
+    for (const std::string& rPath : Paths)
+    {
+        if (GetExtension(rPath) != "mat") continue;
+
+        SPackageMaterial Material;
+
+        if (ReadMaterial(rPath, TextureNames, Material) == false)
+        {
+            std::cout << rPath << ": invalid material" << std::endl;
+
+            return 1;
+        }
+
+        Writer.AddMaterial(Material);
+
+        MaterialNames.push_back(GetName(rPath));
+
+        bool NeedsTangents = false;
+
+        for (int IndexOfElement = 0; IndexOfElement < Material.m_NumberOfInputElements; ++ IndexOfElement)
+        {
+            NeedsTangents = NeedsTangents || strcmp(Material.m_InputElements[IndexOfElement].m_Name, "TANGENT") == 0;
+        }
+
+        MaterialNeedsTangents.push_back(NeedsTangents);
+    }
+
+    for (const std::string& rPath : Paths)
+    {
+        std::string Extension = GetExtension(rPath);
+
+        if (Extension != "obj" && Extension != "gltf" && Extension != "glb") continue;
+
+        SImportedMesh Mesh;
+
+        if (ImportMesh(rPath.c_str(), Mesh) == false)
+        {
+            std::cout << rPath << ": cannot import the mesh" << std::endl;
+
+            return 1;
+        }
+
+        int IndexOfMaterial = FindName(MaterialNames, Mesh.m_MaterialName);
+
+        // -----------------------------------------------------------------------------
+        // The material is only known after reading the file, import it again with
+        // tangents if the material asks for them.
+        // -----------------------------------------------------------------------------
+        if (IndexOfMaterial >= 0 && MaterialNeedsTangents[IndexOfMaterial])
+        {
+            ImportMesh(rPath.c_str(), Mesh, SVertexLayout::NormalMapping);
+        }
+
+        Writer.AddMesh(GetName(rPath).c_str(), Mesh.m_Vertices.data(), static_cast<int>(Mesh.m_Vertices.size()) / Mesh.m_NumberOfFloatsPerVertex, Mesh.m_NumberOfFloatsPerVertex, Mesh.m_Indices.data(), static_cast<int>(Mesh.m_Indices.size()), IndexOfMaterial);
+
+        MeshNames.push_back(GetName(rPath));
+
+        std::cout << rPath << ": " << Mesh.m_Vertices.size() / Mesh.m_NumberOfFloatsPerVertex << " vertices, " << Mesh.m_Indices.size() / 3 << " triangles" << std::endl;
+    }
+
+    for (const std::string& rPath : Paths)
+    {
+        if (GetExtension(rPath) != "inst") continue;
+
+        if (ReadInstances(rPath, MeshNames, Writer) == false)
+        {
+            std::cout << rPath << ": invalid instance list" << std::endl;
+
+            return 1;
+        }
+    }
+
+    if (Writer.Write(_ppArguments[1]) == false)
+    {
+        std::cout << _ppArguments[1] << ": cannot write the package" << std::endl;
+
+        return 1;
+    }
+
+    std::cout << _ppArguments[1] << ": " << MeshNames.size() << " meshes, " << TextureNames.size() << " textures, " << MaterialNames.size() << " materials" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,439 @@
+
+#include "yoshix.h"
+
+#include "billboard_scene.h"
+#include "camera.h"
+#include "depth_rasterizer.h"
+#include "golden_image.h"
+#include "image_filter.h"
+#include "offscreen_renderer.h"
+#include "post_effect_scene.h"
+#include "scene_store.h"
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace gfx;
+
+// -----------------------------------------------------------------------------
+// Renders the scenes of the examples without a window and compares the images
+// to golden images:
+//
+//     regression [--update] [--frames <n>] <golden directory> [<output directory>]
+//
+// Each scene is rendered for n frames (default 4) spread over one turn of its
+// animation. The objects and cameras come from 'billboard_scene.h' and
+// 'post_effect_scene.h', which the examples build their scenes from, so the
+// tool cannot drift from the examples. The frames are built with the CPU
+// modules the examples use for the camera, culling, sorting, occlusion,
+// transforms, and post effects, and drawn flat shaded by the offscreen
+// renderer in place of the GPU, so the shaders are not covered. The images are compared to '<golden directory>/<name>.pfm'. If an
+// output directory is given, the image, the golden image, and the difference
+// of every failed comparison are written there as PNG files.
+//
+// --update      Writes the golden images instead of comparing. Run it on a
+//               build whose images were checked to be correct.
+//
+// Besides the images the tool checks the occlusion culling of spheres near the
+// edge of the screen, where a projected rectangle easily comes out too small.
+//
+// Returns 0 if all images match their golden images and all checks pass.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const int s_Width  = 320;
+    const int s_Height = 240;
+
+    // -----------------------------------------------------------------------------
+
+    struct SOptions
+    {
+        std::string m_GoldenDirectory;
+        std::string m_OutputDirectory;                                  // Empty writes no images.
+        int         m_NumberOfFrames;
+        bool        m_IsUpdate;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct SResults
+    {
+        int m_NumberOfImages;
+        int m_NumberOfFailedImages;
+        int m_NumberOfChecks;
+        int m_NumberOfFailedChecks;
+    };
+
+    // -----------------------------------------------------------------------------
+    // Colors are compared perceptually, a just noticeable difference (delta E of
+    // 2.3) on more than 0.1% of the pixels fails. Depth and normals are compared
+    // by value.
+    // -----------------------------------------------------------------------------
+    const SImageTolerance s_ColorTolerance  = { SImageMetric::Perceptual, 2.3f   , 0.001f, 1 };
+    const SImageTolerance s_NormalTolerance = { SImageMetric::Absolute  , 0.05f  , 0.001f, 1 };
+    const SImageTolerance s_DepthTolerance  = { SImageMetric::Absolute  , 0.0001f, 0.001f, 1 };
+    const SImageTolerance s_EdgeTolerance   = { SImageMetric::Absolute  , 0.05f  , 0.001f, 1 };
+
+    // -----------------------------------------------------------------------------
+
+    std::string GetImageName(const char* _pScene, const char* _pTarget, int _IndexOfFrame)
+    {
+        return std::string(_pScene) + "_" + _pTarget + "_" + std::to_string(_IndexOfFrame);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CheckImage(const SOptions& _rOptions, const std::string& _rName, const filter::SImage& _rImage, const SImageTolerance& _rTolerance, SResults& _rResults)
+    {
+        std::string GoldenPath = _rOptions.m_GoldenDirectory + "/" + _rName + ".pfm";
+
+        ++ _rResults.m_NumberOfImages;
+
+        std::cout << std::left << std::setw(28) << _rName << std::right;
+
+        if (_rOptions.m_IsUpdate)
+        {
+            bool IsWritten = WritePfm(GoldenPath.c_str(), _rImage);
+
+            if (IsWritten == false) ++ _rResults.m_NumberOfFailedImages;
+
+            std::cout << (IsWritten ? "updated" : "cannot write ") << (IsWritten ? "" : GoldenPath) << std::endl;
+
+            return;
+        }
+
+        filter::CImage Golden;
+
+        if (ReadPfm(GoldenPath.c_str(), Golden) == false)
+        {
+            ++ _rResults.m_NumberOfFailedImages;
+
+            std::cout << "no golden image " << GoldenPath << std::endl;
+
+            return;
+        }
+
+        filter::CImage   Difference(_rImage.m_Width, _rImage.m_Height, 1);
+        filter::SImage   DifferenceView = Difference.GetView();
+        filter::SImage   GoldenView     = Golden.GetView();
+        SImageDifference Result;
+
+        bool IsEqual = CompareImages(_rImage, GoldenView, _rTolerance, Result, &DifferenceView);
+
+        if (IsEqual == false) ++ _rResults.m_NumberOfFailedImages;
+
+        std::cout << std::setw(8) << (IsEqual ? "ok" : "FAILED")
+                  << std::setw(12) << 100.0f * Result.m_NumberOfDifferentPixels / std::max(Result.m_NumberOfPixels, 1)
+                  << std::setw(12) << Result.m_MaximumDifference
+                  << std::setw(12) << Result.m_MeanDifference << std::endl;
+
+        if (IsEqual || _rOptions.m_OutputDirectory.empty()) return;
+
+        std::string Path = _rOptions.m_OutputDirectory + "/" + _rName;
+
+        WritePng((Path + ".png"           ).c_str(), _rImage);
+        WritePng((Path + "_golden.png"    ).c_str(), GoldenView);
+        WritePng((Path + "_difference.png").c_str(), DifferenceView);
+    }
+
+    void Check(const char* _pName, bool _IsPassed, SResults& _rResults)
+    {
+        ++ _rResults.m_NumberOfChecks;
+
+        if (_IsPassed == false) ++ _rResults.m_NumberOfFailedChecks;
+
+        std::cout << std::left << std::setw(28) << _pName << std::right << std::setw(8) << (_IsPassed ? "ok" : "FAILED") << std::endl;
+    }
+
+    // -----------------------------------------------------------------------------
+    // A sphere at the view space position 10, 0, 10 with radius 1 is seen with a
+    // field of view of 90 degrees on 256x256 pixels. Its left edge lies in the
+    // tile column 29 at pixel 239.05. The occluders in front of it cover every
+    // tile but this column, so the sphere is visible only through column 29. The
+    // occluders are drawn with the identity matrix, which puts the vertices in
+    // normalized device coordinates at the view space depth 1.
+    // -----------------------------------------------------------------------------
+    void CheckSphereCulling(SResults& _rResults)
+    {
+        const float Identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+        const float TileColumnLeft  = 29.0f * CDepthRasterizer::s_TileSize / 128.0f - 1.0f;
+        const float TileColumnRight = 30.0f * CDepthRasterizer::s_TileSize / 128.0f - 1.0f;
+
+        const float Occluders[8][3] =
+        {
+            { -1.0f          , -1.0f, 0.0f }, { TileColumnLeft , -1.0f, 0.0f }, { TileColumnLeft , 1.0f, 0.0f }, { -1.0f          , 1.0f, 0.0f },
+            { TileColumnRight, -1.0f, 0.0f }, { 1.0f           , -1.0f, 0.0f }, { 1.0f           , 1.0f, 0.0f }, { TileColumnRight, 1.0f, 0.0f },
+        };
+
+        const float FullOccluder[4][3] = { { -1.0f, -1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { -1.0f, 1.0f, 0.0f } };
+
+        const int QuadIndices[12] = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7 };
+
+        const float Center[3] = { 10.0f, 0.0f, 10.0f };
+
+        const SRasterState OccluderState = { SDepthTest::Lesser, false, nullptr, nullptr };
+
+        float ProjectionMatrix[16];
+
+        GetProjectionMatrix(90.0f, 1.0f, 0.1f, 100.0f, ProjectionMatrix);
+
+        CDepthRasterizer Rasterizer;
+
+        Rasterizer.SetViewport(256, 256);
+        Rasterizer.SetDepthRange(0.1f, 100.0f, SDepthMode::Standard);
+
+        Rasterizer.BeginFrame();
+        Rasterizer.DrawTriangles(&Occluders[0][0], 3, QuadIndices, 12, Identity, OccluderState);
+
+        Check("sphere_culling_edge", Rasterizer.IsSphereVisible(Center, 1.0f, ProjectionMatrix, ProjectionMatrix), _rResults);
+
+        Rasterizer.DrawTriangles(&FullOccluder[0][0], 3, QuadIndices, 6, Identity, OccluderState);
+
+        Check("sphere_culling_hidden", Rasterizer.IsSphereVisible(Center, 1.0f, ProjectionMatrix, ProjectionMatrix) == false, _rResults);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The scene of 'billboard.cpp' from 'billboard_scene.h'. The trees are
+    // culled, sorted, and tested against the walls like in 'BuildFrame', then
+    // blended from back to front.
+    // -----------------------------------------------------------------------------
+    void CheckBillboard(const SOptions& _rOptions, SResults& _rResults)
+    {
+        using namespace billboard_scene;
+
+        const float GroundColor[4] = { 0.3f, 0.45f, 0.2f, 1.0f };
+        const float WallColor  [4] = { 1.6f, 1.4f , 1.2f, 1.0f };
+        const float TreeColor  [4] = { 0.1f, 0.7f , 0.2f, 0.8f };
+        const float SkyColor   [4] = { 0.4f, 0.6f , 0.9f, 1.0f };
+
+        const float GroundNormal[3] = { 0.0f, 1.0f, 0.0f };
+
+        CSceneStore Trees;
+
+        for (int IndexOfTree = 0; IndexOfTree < s_NumberOfTrees; ++ IndexOfTree) Trees.Create(nullptr, 0, s_TreePositions[IndexOfTree], s_BillboardRadius);
+
+        CCamera Camera;
+
+        Camera.SetPerspective(s_FieldOfViewY, static_cast<float>(s_Width) / static_cast<float>(s_Height), s_Near, s_Far);
+
+        COffscreenRenderer Renderer;
+
+        Renderer.SetViewport(s_Width, s_Height);
+        Renderer.SetDepthRange(s_Near, s_Far, SDepthMode::Standard);
+
+        int        VisibleTrees[s_NumberOfTrees];
+        SSceneDraw TreeDraws[s_NumberOfTrees];
+
+        for (int IndexOfFrame = 0; IndexOfFrame < _rOptions.m_NumberOfFrames; ++ IndexOfFrame)
+        {
+            float Angle = s_CameraAngle + 6.2831853f * static_cast<float>(IndexOfFrame) / static_cast<float>(_rOptions.m_NumberOfFrames);
+
+            float Eye[3];
+            float At [3] = { 0.0f, 0.0f, 0.0f };
+            float Up [3] = { 0.0f, 1.0f, 0.0f };
+
+            GetEyePosition(Angle, s_CameraRadius, s_CameraHeight, Eye);
+
+            Camera.SetLookAt(Eye, At, Up);
+
+            const SCameraSnapshot& rCamera = Camera.GetSnapshot();
+
+            Renderer.BeginFrame(SkyColor);
+
+            Renderer.DrawTriangles(&s_GroundCorners[0][0], 3, s_QuadIndices, 6, rCamera.m_ViewProjectionMatrix, GroundColor, GroundNormal);
+
+            for (int IndexOfWall = 0; IndexOfWall < s_NumberOfWalls; ++ IndexOfWall)
+            {
+                float Corners[4][3];
+                float Normal[3];
+
+                GetBillboardCorners(s_WallPositions[IndexOfWall], rCamera.m_EyePosition, Corners, Normal);
+
+                Renderer.DrawTriangles(&Corners[0][0], 3, s_QuadIndices, 6, rCamera.m_ViewProjectionMatrix, WallColor, Normal);
+            }
+
+            int NumberOfVisibleTrees = Trees.Cull(rCamera.m_FrustumPlanes, VisibleTrees);
+
+            Trees.Sort(VisibleTrees, NumberOfVisibleTrees, rCamera.m_EyePosition, SSortOrder::BackToFront, TreeDraws);
+
+            for (int IndexOfDraw = 0; IndexOfDraw < NumberOfVisibleTrees; ++ IndexOfDraw)
+            {
+                int IndexOfTree = TreeDraws[IndexOfDraw].m_IndexOfEntity;
+
+                float Position[3] =
+                {
+                    Trees.GetPositionsX()[IndexOfTree],
+                    Trees.GetPositionsY()[IndexOfTree],
+                    Trees.GetPositionsZ()[IndexOfTree],
+                };
+
+                if (Renderer.GetDepthRasterizer().IsSphereVisible(Position, s_BillboardRadius, rCamera.m_ViewProjectionMatrix, rCamera.m_ProjectionMatrix) == false) continue;
+
+                float Corners[4][3];
+                float Normal[3];
+
+                GetBillboardCorners(Position, rCamera.m_EyePosition, Corners, Normal);
+
+                Renderer.DrawTriangles(&Corners[0][0], 3, s_QuadIndices, 6, rCamera.m_ViewProjectionMatrix, TreeColor, Normal);
+            }
+
+            Renderer.EndFrame();
+
+            CheckImage(_rOptions, GetImageName("billboard", "color", IndexOfFrame), Renderer.GetColorTarget(), s_ColorTolerance, _rResults);
+            CheckImage(_rOptions, GetImageName("billboard", "depth", IndexOfFrame), Renderer.GetDepthTarget(), s_DepthTolerance, _rResults);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The scene of 'post_effect.cpp' from 'post_effect_scene.h', the cube
+    // rotating around the y-axis with its world matrix from the transform hierarchy. The color, normal, and
+    // depth targets are checked like the GBuffer, then the bloomed and tone
+    // mapped color and the edges of the depth like the post effects.
+    // -----------------------------------------------------------------------------
+    void CheckPostEffect(const SOptions& _rOptions, SResults& _rResults)
+    {
+        using namespace post_effect_scene;
+
+        const float ClearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+        const float FaceColors[s_NumberOfFaces][4] =
+        {
+            { 1.0f, 0.2f, 0.2f, 1.0f },
+            { 0.2f, 1.0f, 0.2f, 1.0f },
+            { 0.2f, 0.2f, 1.0f, 1.0f },
+            { 1.0f, 1.0f, 0.2f, 1.0f },
+            { 2.0f, 2.0f, 2.0f, 1.0f },
+            { 0.2f, 1.0f, 1.0f, 1.0f },
+        };
+
+        const int QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+        CTransformHierarchy Transforms;
+
+        STransform CubeTransform = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+
+        int IndexOfCubeNode = Transforms.AddNode(-1, CubeTransform);
+
+        CCamera Camera;
+
+        Camera.SetPerspective(s_FieldOfViewY, static_cast<float>(s_Width) / static_cast<float>(s_Height), s_Near, s_Far);
+        Camera.SetLookAt(s_Eye, s_At, s_Up);
+
+        const SCameraSnapshot& rCamera = Camera.GetSnapshot();
+
+        COffscreenRenderer Renderer;
+
+        Renderer.SetViewport(s_Width, s_Height);
+        Renderer.SetDepthRange(s_Near, s_Far, SDepthMode::Standard);
+
+        filter::CImage Bloom(s_Width, s_Height, 4);
+        filter::CImage Edges(s_Width, s_Height, 1);
+
+        filter::SImage BloomView = Bloom.GetView();
+        filter::SImage EdgesView = Edges.GetView();
+
+        for (int IndexOfFrame = 0; IndexOfFrame < _rOptions.m_NumberOfFrames; ++ IndexOfFrame)
+        {
+            float AxisY[3] = { 0.0f, 1.0f, 0.0f };
+            float Rotation[4];
+
+            Transforms.SetLocalRotation(IndexOfCubeNode, GetRotationQuaternion(AxisY, 360.0f * IndexOfFrame / _rOptions.m_NumberOfFrames, Rotation));
+            Transforms.Update();
+
+            const float* pWorldMatrix = Transforms.GetWorldMatrix(IndexOfCubeNode);
+
+            float WorldViewProjectionMatrix[16];
+
+            MulMatrix(pWorldMatrix, rCamera.m_ViewProjectionMatrix, WorldViewProjectionMatrix);
+
+            Renderer.BeginFrame(ClearColor);
+
+            for (int IndexOfFace = 0; IndexOfFace < s_NumberOfFaces; ++ IndexOfFace)
+            {
+                const float* pFaceVertices = s_CubeVertices[IndexOfFace * 4];
+                const float* pFaceNormal   = pFaceVertices + 3;
+
+                // -----------------------------------------------------------------------------
+                // The normal is rotated with the upper 3x3 of the row vector matrix.
+                // -----------------------------------------------------------------------------
+                float Normal[3];
+
+                for (int Column = 0; Column < 3; ++ Column)
+                {
+                    Normal[Column] = pFaceNormal[0] * pWorldMatrix[Column] + pFaceNormal[1] * pWorldMatrix[4 + Column] + pFaceNormal[2] * pWorldMatrix[8 + Column];
+                }
+
+                Renderer.DrawTriangles(pFaceVertices, s_VertexStride, QuadIndices, 6, WorldViewProjectionMatrix, FaceColors[IndexOfFace], Normal);
+            }
+
+            Renderer.EndFrame();
+
+            filter::Bloom(Renderer.GetColorTarget(), BloomView, 1.0f, 4.0f, 0.5f);
+            filter::ToneMap(BloomView, BloomView, 1.0f);
+            filter::DetectEdges(Renderer.GetDepthTarget(), EdgesView);
+
+            CheckImage(_rOptions, GetImageName("post_effect", "color" , IndexOfFrame), Renderer.GetColorTarget() , s_ColorTolerance , _rResults);
+            CheckImage(_rOptions, GetImageName("post_effect", "normal", IndexOfFrame), Renderer.GetNormalTarget(), s_NormalTolerance, _rResults);
+            CheckImage(_rOptions, GetImageName("post_effect", "depth" , IndexOfFrame), Renderer.GetDepthTarget() , s_DepthTolerance , _rResults);
+            CheckImage(_rOptions, GetImageName("post_effect", "bloom" , IndexOfFrame), BloomView                 , s_ColorTolerance , _rResults);
+            CheckImage(_rOptions, GetImageName("post_effect", "edges" , IndexOfFrame), EdgesView                 , s_EdgeTolerance  , _rResults);
+        }
+    }
+} // namespace
+
+int main(int _NumberOfArguments, char** _ppArguments)
+{
+    SOptions Options = { "", "", 4, false };
+
+    for (int IndexOfArgument = 1; IndexOfArgument < _NumberOfArguments; ++ IndexOfArgument)
+    {
+        const char* pArgument = _ppArguments[IndexOfArgument];
+
+        if (strcmp(pArgument, "--update") == 0)
+        {
+            Options.m_IsUpdate = true;
+        }
+        else if (strcmp(pArgument, "--frames") == 0 && IndexOfArgument + 1 < _NumberOfArguments)
+        {
+            Options.m_NumberOfFrames = atoi(_ppArguments[++ IndexOfArgument]);
+        }
+        else if (Options.m_GoldenDirectory.empty())
+        {
+            Options.m_GoldenDirectory = pArgument;
+        }
+        else
+        {
+            Options.m_OutputDirectory = pArgument;
+        }
+    }
+
+    if (Options.m_GoldenDirectory.empty() || Options.m_NumberOfFrames < 1)
+    {
+        std::cout << "usage: regression [--update] [--frames <n>] <golden directory> [<output directory>]" << std::endl;
+
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(28) << "Image" << std::right << std::setw(8) << "Result" << std::setw(12) << "Pixels %" << std::setw(12) << "Maximum" << std::setw(12) << "Mean" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+
+    SResults Results = { 0, 0, 0, 0 };
+
+    CheckBillboard (Options, Results);
+    CheckPostEffect(Options, Results);
+
+    CheckSphereCulling(Results);
+
+    std::cout << Results.m_NumberOfImages - Results.m_NumberOfFailedImages << " of " << Results.m_NumberOfImages << " images " << (Options.m_IsUpdate ? "updated" : "match their golden images") << std::endl;
+    std::cout << Results.m_NumberOfChecks - Results.m_NumberOfFailedChecks << " of " << Results.m_NumberOfChecks << " checks pass" << std::endl;
+
+    return Results.m_NumberOfFailedImages == 0 && Results.m_NumberOfFailedChecks == 0 ? 0 : 1;
+}
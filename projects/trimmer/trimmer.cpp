@@ -0,0 +1,70 @@
+
+#include "alpha_trim.h"
+
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+// Prints the polygons around the visible texels of a PNG texture with 4 up to
+// 8 vertices, the area they cover, and their texture coordinates:
+//
+//     trimmer <png> [alpha threshold] [padding] [minimum number of texels]
+//
+// The defaults are the settings of the tree billboards in 'billboard.cpp':
+// texels with an alpha above 0 are visible, one texel of padding for the
+// bilinear filter, and groups of less than 16 texels are ignored.
+// -----------------------------------------------------------------------------
+
+int main(int _NumberOfArguments, char** _ppArguments)
+{
+    if (_NumberOfArguments < 2)
+    {
+        std::cout << "usage: trimmer <png> [alpha threshold] [padding] [minimum number of texels]" << std::endl;
+
+        return 1;
+    }
+
+    STrimSettings Settings = { 0, 1.0f, 16, 8 };
+
+    if (_NumberOfArguments > 2) Settings.m_AlphaThreshold        = atoi(_ppArguments[2]);
+    if (_NumberOfArguments > 3) Settings.m_Padding               = static_cast<float>(atof(_ppArguments[3]));
+    if (_NumberOfArguments > 4) Settings.m_MinimumNumberOfTexels = atoi(_ppArguments[4]);
+
+    SAlphaMask Mask;
+
+    if (ReadPngAlpha(_ppArguments[1], Mask) == false)
+    {
+        std::cout << _ppArguments[1] << ": not an 8 bit non-interlaced PNG file" << std::endl;
+
+        return 1;
+    }
+
+    size_t NumberOfVisibleTexels = 0;
+
+    for (unsigned char Alpha : Mask.m_Alpha) NumberOfVisibleTexels += Alpha > Settings.m_AlphaThreshold ? 1 : 0;
+
+    std::cout << _ppArguments[1] << ": " << Mask.m_Width << "x" << Mask.m_Height << " texels, " << std::fixed << std::setprecision(1)
+              << 100.0 * NumberOfVisibleTexels / Mask.m_Alpha.size() << "% visible" << std::endl;
+
+    for (int NumberOfVertices = 4; NumberOfVertices <= STrimmedPolygon::s_MaximumNumberOfVertices; ++ NumberOfVertices)
+    {
+        STrimmedPolygon Polygon;
+
+        Settings.m_MaximumNumberOfVertices = NumberOfVertices;
+
+        GetTrimmedPolygon(Mask, Settings, Polygon);
+
+        std::cout << std::endl;
+        std::cout << Polygon.m_NumberOfVertices << " vertices, " << std::setprecision(1) << 100.0f * Polygon.m_Area << "% of the quad" << std::endl;
+
+        std::cout << std::setprecision(4);
+
+        for (int IndexOfVertex = 0; IndexOfVertex < Polygon.m_NumberOfVertices; ++ IndexOfVertex)
+        {
+            std::cout << "    { " << Polygon.m_TexCoords[IndexOfVertex][0] << "f, " << Polygon.m_TexCoords[IndexOfVertex][1] << "f }," << std::endl;
+        }
+    }
+
+    return 0;
+}